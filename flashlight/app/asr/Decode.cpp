@@ -7,10 +7,12 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <fstream>
 #include <future>
 #include <iomanip>
 #include <mutex>
+#include <numeric>
 #include <string>
 #include <thread>
 #include <vector>
@@ -33,13 +35,14 @@
 #include "flashlight/pkg/runtime/plugin/ModulePlugin.h"
 #include "flashlight/pkg/speech/common/Defines.h"
 #include "flashlight/pkg/speech/common/Flags.h"
-#include "flashlight/pkg/speech/common/ProducerConsumerQueue.h"
+#include "flashlight/pkg/speech/common/LockFreeQueue.h"
 #include "flashlight/pkg/speech/criterion/criterion.h"
 #include "flashlight/pkg/speech/data/FeatureTransforms.h"
 #include "flashlight/pkg/speech/data/Utils.h"
 #include "flashlight/pkg/speech/decoder/ConvLmModule.h"
 #include "flashlight/pkg/speech/decoder/DecodeUtils.h"
 #include "flashlight/pkg/speech/decoder/Defines.h"
+#include "flashlight/pkg/speech/decoder/InferenceScheduler.h"
 #include "flashlight/pkg/speech/decoder/TranscriptionUtils.h"
 #include "flashlight/pkg/speech/runtime/runtime.h"
 
@@ -360,18 +363,81 @@ int main(int argc, char** argv) {
   LOG(INFO) << "[Dataset] Dataset loaded, with " << nSamples << " samples.";
 
   /* ===================== AM Forwarding ===================== */
-  using EmissionQueue = fl::lib::ProducerConsumerQueue<EmissionTargetPair>;
+  using EmissionQueue = fl::lib::LockFreeQueue<EmissionTargetPair>;
   EmissionQueue emissionQueue(FLAGS_emission_queue_size);
 
+  // With dynamic batching, samples are loaded by a separate thread and the AM
+  // forward threads run batches gathered by the scheduler
+  bool useBatching =
+      FLAGS_am_forward_batchsize > 1 && FLAGS_emission_dir.empty();
+  InferenceSchedulerOptions schedulerOptions;
+  schedulerOptions.maxBatchSize = std::max(FLAGS_am_forward_batchsize, 1);
+  schedulerOptions.maxBatchFrames = FLAGS_am_forward_batch_frames;
+  schedulerOptions.maxWaitMsec = FLAGS_am_forward_max_wait_ms;
+  schedulerOptions.bucketFrames = FLAGS_am_forward_bucket_frames;
+  schedulerOptions.maxPending = FLAGS_emission_queue_size;
+  InferenceScheduler scheduler(emissionQueue, schedulerOptions);
+
+  auto loadTarget = [&tokenDict, &wordDict, &isSeq2seqCrit](
+                        const std::vector<fl::Tensor>& sample) {
+    TargetUnit targetUnit;
+    auto tokenTarget = sample[kTargetIdx].toHostVector<int>();
+    auto wordTarget = sample[kWordIdx].toHostVector<int>();
+    // TODO: we will reform the dataset so that the loaded word
+    // targets are strings already
+    std::vector<std::string> wordTargetStr;
+    if (FLAGS_uselexicon) {
+      wordTargetStr = wrdIdx2Wrd(wordTarget, wordDict);
+    } else {
+      auto letterTarget = tknTarget2Ltr(
+          tokenTarget,
+          tokenDict,
+          FLAGS_criterion,
+          FLAGS_surround,
+          isSeq2seqCrit,
+          FLAGS_replabel,
+          FLAGS_usewordpiece,
+          FLAGS_wordseparator);
+      wordTargetStr = tkn2Wrd(letterTarget, FLAGS_wordseparator);
+    }
+
+    targetUnit.wordTargetStr = wordTargetStr;
+    targetUnit.tokenTarget = tokenTarget;
+    return targetUnit;
+  };
+
+  auto runLoader = [&nSamples, &ds, &scheduler, &loadTarget]() {
+    std::vector<int64_t> selectedIds(nSamples);
+    std::iota(selectedIds.begin(), selectedIds.end(), 0);
+    std::shared_ptr<fl::Dataset> localDs =
+        std::make_shared<fl::ResampleDataset>(ds, selectedIds);
+    localDs = std::make_shared<fl::PrefetchDataset>(
+        localDs, FLAGS_nthread, FLAGS_nthread);
+
+    try {
+      for (auto& sample : *localDs) {
+        scheduler.add(
+            {readSampleIds(sample[kSampleIdx]).front(),
+             sample[kInputIdx],
+             loadTarget(sample)});
+      }
+    } catch (...) {
+      // don't leave the AM forward threads waiting for samples
+      scheduler.finishAdding();
+      throw;
+    }
+    scheduler.finishAdding();
+  };
+
   auto runAmForward = [&network,
                        &usePlugin,
                        &criterion,
                        &nSamples,
                        &ds,
-                       &tokenDict,
-                       &wordDict,
                        &emissionQueue,
-                       &isSeq2seqCrit](int tid) {
+                       &useBatching,
+                       &scheduler,
+                       &loadTarget](int tid) {
     // Initialize AM
     fl::setDevice(tid);
     std::shared_ptr<fl::Module> localNetwork = network;
@@ -385,6 +451,21 @@ int main(int argc, char** argv) {
       localCriterion->eval();
     }
 
+    if (useBatching) {
+      scheduler.run([&localNetwork, &usePlugin](
+                        const fl::Variable& input,
+                        const fl::Tensor& inputSizes) {
+        if (usePlugin) {
+          return localNetwork->forward({input, fl::noGrad(inputSizes)})
+              .front();
+        }
+        return fl::pkg::runtime::forwardSequentialModuleWithPadMask(
+            input, localNetwork, inputSizes);
+      });
+      localNetwork.reset();
+      return;
+    }
+
     std::vector<int64_t> selectedIds;
     for (int64_t i = tid; i < nSamples; i += FLAGS_nthread_decoder_am_forward) {
       selectedIds.emplace_back(i);
@@ -398,29 +479,7 @@ int main(int argc, char** argv) {
       auto sampleId = readSampleIds(sample[kSampleIdx]).front();
 
       /* 2. Load Targets */
-      TargetUnit targetUnit;
-      auto tokenTarget = sample[kTargetIdx].toHostVector<int>();
-      auto wordTarget = sample[kWordIdx].toHostVector<int>();
-      // TODO: we will reform the dataset so that the loaded word
-      // targets are strings already
-      std::vector<std::string> wordTargetStr;
-      if (FLAGS_uselexicon) {
-        wordTargetStr = wrdIdx2Wrd(wordTarget, wordDict);
-      } else {
-        auto letterTarget = tknTarget2Ltr(
-            tokenTarget,
-            tokenDict,
-            FLAGS_criterion,
-            FLAGS_surround,
-            isSeq2seqCrit,
-            FLAGS_replabel,
-            FLAGS_usewordpiece,
-            FLAGS_wordseparator);
-        wordTargetStr = tkn2Wrd(letterTarget, FLAGS_wordseparator);
-      }
-
-      targetUnit.wordTargetStr = wordTargetStr;
-      targetUnit.tokenTarget = tokenTarget;
+      TargetUnit targetUnit = loadTarget(sample);
 
       /* 3. Load Emissions */
       EmissionUnit emissionUnit;
@@ -751,25 +810,60 @@ int main(int argc, char** argv) {
                << ") need to be positive ";
   }
 
-  auto startThreadsAndJoin = [&runAmForward, &runDecoder, &emissionQueue](
+  auto startThreadsAndJoin = [&runAmForward,
+                              &runLoader,
+                              &runDecoder,
+                              &emissionQueue,
+                              &useBatching](
                                  int nAmThreads, int nDecoderThreads) {
+    const int nLoaderThreads = useBatching ? 1 : 0;
     // TODO possibly try catch for futures to proper logging of all errors
     // https://github.com/facebookresearch/gtn/blob/master/gtn/parallel/parallel_map.h#L154
 
+    // Joins the AM forward threads, then the loader, and lets the decoders
+    // drain the emissions even if one of them failed; rethrows the first
+    // error. A failed forward thread cancels the scheduler, so the loader
+    // and the other forward threads stop too.
+    auto joinAmForward = [&emissionQueue](
+                             std::vector<std::future<void>>& amFuts,
+                             std::future<void>& loaderFut) {
+      std::exception_ptr error;
+      auto join = [&error](std::future<void>& fut) {
+        try {
+          fut.get();
+        } catch (...) {
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+      };
+      for (auto& fut : amFuts) {
+        join(fut);
+      }
+      if (loaderFut.valid()) {
+        join(loaderFut);
+      }
+      emissionQueue.finishAdding();
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    };
+
     // We have to run AM forwarding and decoding in sequential to avoid GPU
     // OOM with two large neural nets.
     if (FLAGS_lmtype == "convlm") {
       // 1. AM forwarding
       {
         std::vector<std::future<void>> futs(nAmThreads);
-        fl::ThreadPool threadPool(nAmThreads);
-        for (int i = 0; i < nAmThreads; i++) {
-          futs[i] = threadPool.enqueue(runAmForward, i);
+        fl::ThreadPool threadPool(nAmThreads + nLoaderThreads);
+        std::future<void> loaderFut;
+        if (useBatching) {
+          loaderFut = threadPool.enqueue(runLoader);
         }
         for (int i = 0; i < nAmThreads; i++) {
-          futs[i].get();
+          futs[i] = threadPool.enqueue(runAmForward, i);
         }
-        emissionQueue.finishAdding();
+        joinAmForward(futs, loaderFut);
       }
       // 2. Decoding
       {
@@ -785,23 +879,26 @@ int main(int argc, char** argv) {
     }
     // Non-convLM decoding. AM forwarding and decoding can be run in parallel.
     else {
-      std::vector<std::future<void>> futs(nAmThreads + nDecoderThreads);
-      fl::ThreadPool threadPool(nAmThreads + nDecoderThreads);
+      std::vector<std::future<void>> futs(nAmThreads);
+      std::vector<std::future<void>> decoderFuts(nDecoderThreads);
+      fl::ThreadPool threadPool(nAmThreads + nDecoderThreads + nLoaderThreads);
+      // Sample loading thread, with dynamic batching
+      std::future<void> loaderFut;
+      if (useBatching) {
+        loaderFut = threadPool.enqueue(runLoader);
+      }
       // AM forwarding threads
       for (int i = 0; i < nAmThreads; i++) {
         futs[i] = threadPool.enqueue(runAmForward, i);
       }
       // Decoding threads
       for (int i = 0; i < nDecoderThreads; i++) {
-        futs[i + nAmThreads] = threadPool.enqueue(runDecoder, i);
+        decoderFuts[i] = threadPool.enqueue(runDecoder, i);
       }
 
-      for (int i = 0; i < nAmThreads; i++) {
-        futs[i].get();
-      }
-      emissionQueue.finishAdding();
-      for (int i = nAmThreads; i < nAmThreads + nDecoderThreads; i++) {
-        futs[i].get();
+      joinAmForward(futs, loaderFut);
+      for (int i = 0; i < nDecoderThreads; i++) {
+        decoderFuts[i].get();
       }
     }
   };
@@ -810,6 +907,21 @@ int main(int argc, char** argv) {
   startThreadsAndJoin(FLAGS_nthread_decoder_am_forward, FLAGS_nthread_decoder);
   timer.stop();
 
+  if (useBatching) {
+    auto stats = scheduler.getStats();
+    LOG(INFO) << "[AM forward] " << stats.numSamples << " samples in "
+              << stats.numBatches << " batches (avg batch size "
+              << stats.avgBatchSize << ", padding "
+              << (stats.numPaddedFrames > 0
+                      ? 100. * (stats.numPaddedFrames - stats.numFrames) /
+                          stats.numPaddedFrames
+                      : 0.)
+              << "%) -- latency p50 " << stats.p50LatencyMsec << "ms, p99 "
+              << stats.p99LatencyMsec << "ms, throughput "
+              << stats.samplesPerSec << " samples/s, " << stats.framesPerSec
+              << " frames/s";
+  }
+
   /* Compute statistics */
   int totalTokens = 0, totalWords = 0, totalSamples = 0;
   for (int i = 0; i < FLAGS_nthread_decoder; i++) {
@@ -28,6 +28,7 @@
 #include "flashlight/lib/text/dictionary/Utils.h"
 #include "flashlight/pkg/runtime/Runtime.h"
 #include "flashlight/pkg/runtime/amp/DynamicScaler.h"
+#include "flashlight/pkg/runtime/common/AsyncCheckpointWriter.h"
 #include "flashlight/pkg/runtime/common/DistributedUtils.h"
 #include "flashlight/pkg/runtime/common/SequentialBuilder.h"
 #include "flashlight/pkg/runtime/common/Serializer.h"
@@ -48,6 +49,7 @@ using fl::lib::join;
 using fl::pkg::runtime::getCurrentDate;
 using fl::pkg::runtime::getCurrentTime;
 using fl::pkg::runtime::getRunFile;
+using fl::pkg::runtime::AsyncCheckpointWriter;
 using fl::pkg::runtime::Serializer;
 
 using namespace fl::pkg::speech;
@@ -219,17 +221,24 @@ int main(int argc, char** argv) {
   std::shared_ptr<fl::pkg::runtime::DynamicScaler> dynamicScaler;
   if (FLAGS_fl_amp_use_mixed_precision) {
     // Only set the optim mode to O1 if it was left empty
-    LOG(INFO) << "Mixed precision training enabled. Will perform loss scaling.";
     if (FLAGS_fl_optim_mode.empty()) {
       LOG(INFO) << "Mixed precision training enabled with no "
                    "optim mode specified - setting optim mode to O1.";
       fl::OptimMode::get().setOptimLevel(fl::OptimLevel::O1);
     }
 
-    dynamicScaler = std::make_shared<fl::pkg::runtime::DynamicScaler>(
-        FLAGS_fl_amp_scale_factor,
-        FLAGS_fl_amp_max_scale_factor,
-        FLAGS_fl_amp_scale_factor_update_interval);
+    if (fl::optimLevelRequiresLossScaling(
+            fl::OptimMode::get().getOptimLevel())) {
+      LOG(INFO)
+          << "Mixed precision training enabled. Will perform loss scaling.";
+      dynamicScaler = std::make_shared<fl::pkg::runtime::DynamicScaler>(
+          FLAGS_fl_amp_scale_factor,
+          FLAGS_fl_amp_max_scale_factor,
+          FLAGS_fl_amp_scale_factor_update_interval);
+    } else {
+      LOG(INFO) << "Mixed precision training enabled in bf16. "
+                   "Loss scaling is disabled.";
+    }
   }
 
   std::unordered_map<std::string, std::string> config = {
@@ -658,38 +667,22 @@ int main(int argc, char** argv) {
         }
       };
 
+  AsyncCheckpointWriter checkpointWriter;
   auto saveModels = [&](int iter, int totalUpdates) {
     if (isMaster) {
       // Save last epoch
       config[kEpoch] = std::to_string(iter);
       config[kUpdates] = std::to_string(totalUpdates);
 
-      std::string filename;
+      // All destinations share one snapshot, written in the background
+      std::vector<fs::path> filenames;
       if (FLAGS_itersave) {
-        filename =
-            getRunFile(format("model_iter_%03d.bin", iter), runIdx, runPath);
-        Serializer::save(
-            filename,
-            FL_APP_ASR_VERSION,
-            config,
-            network,
-            criterion,
-            dynamicScaler,
-            netoptim,
-            critoptim);
+        filenames.push_back(
+            getRunFile(format("model_iter_%03d.bin", iter), runIdx, runPath));
       }
 
       // save last model
-      filename = getRunFile("model_last.bin", runIdx, runPath);
-      Serializer::save(
-          filename,
-          FL_APP_ASR_VERSION,
-          config,
-          network,
-          criterion,
-          dynamicScaler,
-          netoptim,
-          critoptim);
+      filenames.push_back(getRunFile("model_last.bin", runIdx, runPath));
 
       // save if better than ever for one valid
       for (const auto& v : validminerrs) {
@@ -697,17 +690,8 @@ int main(int argc, char** argv) {
         if (verr < validminerrs[v.first]) {
           validminerrs[v.first] = verr;
           std::string cleaned_v = cleanFilepath(v.first);
-          std::string vfname =
-              getRunFile("model_" + cleaned_v + ".bin", runIdx, runPath);
-          Serializer::save(
-              vfname,
-              FL_APP_ASR_VERSION,
-              config,
-              network,
-              criterion,
-              dynamicScaler,
-              netoptim,
-              critoptim);
+          filenames.push_back(
+              getRunFile("model_" + cleaned_v + ".bin", runIdx, runPath));
         }
       }
 
@@ -717,19 +701,27 @@ int main(int argc, char** argv) {
         if (verr < validMinWerWithDecoder[v.first]) {
           validMinWerWithDecoder[v.first] = verr;
           std::string cleaned_v = cleanFilepath(v.first);
-          std::string vfname = getRunFile(
-              "model_" + cleaned_v + "_decoder.bin", runIdx, runPath);
-          Serializer::save(
-              vfname,
-              FL_APP_ASR_VERSION,
-              config,
-              network,
-              criterion,
-              dynamicScaler,
-              netoptim,
-              critoptim);
+          filenames.push_back(getRunFile(
+              "model_" + cleaned_v + "_decoder.bin", runIdx, runPath));
         }
       }
+
+      auto stall = checkpointWriter.save(
+          filenames,
+          FL_APP_ASR_VERSION,
+          config,
+          network,
+          criterion,
+          dynamicScaler,
+          netoptim,
+          critoptim);
+      if (!FLAGS_asyncsave) {
+        auto start = std::chrono::steady_clock::now();
+        checkpointWriter.wait();
+        stall += std::chrono::steady_clock::now() - start;
+      }
+      FL_LOG_MASTER(INFO) << "Checkpoint stall: " << stall.count() << "s";
+
       // print brief stats on memory allocation (so far)
       fl::detail::getMemMgrInfo("Memory Manager Stats", /* device id = */ 0);
     }
@@ -1260,6 +1252,7 @@ int main(int argc, char** argv) {
       true /* clampCrit */,
       FLAGS_iter);
 
+  checkpointWriter.wait();
   FL_LOG_MASTER(INFO) << "Finished training";
   return 0;
 }
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "flashlight/lib/text/String.h"
+#include "flashlight/pkg/speech/common/LockFreeQueue.h"
+#include "flashlight/pkg/speech/common/ProducerConsumerQueue.h"
+
+DEFINE_string(producers, "1,2,4,8", "Numbers of producer threads to run");
+DEFINE_string(consumers, "1,2,4,8", "Numbers of consumer threads to run");
+DEFINE_int32(num_elements, 1000000, "Number of elements passed in each run");
+DEFINE_int32(queue_size, 3000, "Maximum size of the queues");
+DEFINE_int32(
+    element_size,
+    0,
+    "Number of floats carried by each element, to emulate small emissions");
+DEFINE_int32(
+    get_batch,
+    1,
+    "Number of elements consumers pop at once from the lock-free queue");
+
+namespace {
+
+using Element = std::vector<float>;
+
+// Pops elements one at a time, or several at once when the queue supports it
+template <typename Queue>
+int64_t consume(Queue& queue) {
+  int64_t count = 0;
+  Element element;
+  while (queue.get(element)) {
+    ++count;
+  }
+  return count;
+}
+
+template <>
+int64_t consume(fl::lib::LockFreeQueue<Element>& queue) {
+  int64_t count = 0;
+  if (FLAGS_get_batch <= 1) {
+    Element element;
+    while (queue.get(element)) {
+      ++count;
+    }
+  } else {
+    std::vector<Element> elements;
+    while (size_t n = queue.get(elements, FLAGS_get_batch)) {
+      count += n;
+      elements.clear();
+    }
+  }
+  return count;
+}
+
+// Returns the throughput in million elements per second
+template <typename Queue>
+double runBenchmark(int nProducers, int nConsumers) {
+  Queue queue(FLAGS_queue_size);
+  std::vector<int64_t> consumed(nConsumers, 0);
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < nConsumers; ++i) {
+    consumers.emplace_back([&queue, &consumed, i]() {
+      consumed[i] = consume(queue);
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int i = 0; i < nProducers; ++i) {
+    producers.emplace_back([&queue, nProducers, i]() {
+      for (int j = i; j < FLAGS_num_elements; j += nProducers) {
+        queue.add(Element(FLAGS_element_size, j));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  queue.finishAdding();
+  int64_t total = 0;
+  for (int i = 0; i < nConsumers; ++i) {
+    consumers[i].join();
+    total += consumed[i];
+  }
+  double sec = std::chrono::duration<double>(
+                   std::chrono::high_resolution_clock::now() - start)
+                   .count();
+  if (total != FLAGS_num_elements) {
+    throw std::runtime_error("Elements were lost in the queue");
+  }
+  return FLAGS_num_elements / sec / 1e6;
+}
+
+std::vector<int> parseThreads(const std::string& threads) {
+  std::vector<int> result;
+  for (const auto& n : fl::lib::split(",", threads, true)) {
+    result.push_back(std::stoi(n));
+  }
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+
+  std::cout << "Throughput (M elements/sec) of " << FLAGS_num_elements
+            << " elements of " << FLAGS_element_size
+            << " floats, queue size " << FLAGS_queue_size << std::endl;
+  std::cout << std::setw(10) << "producers" << std::setw(10) << "consumers"
+            << std::setw(12) << "mutex" << std::setw(12) << "lock-free"
+            << std::setw(10) << "speedup" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  for (int nProducers : parseThreads(FLAGS_producers)) {
+    for (int nConsumers : parseThreads(FLAGS_consumers)) {
+      auto mutexQueue =
+          runBenchmark<fl::lib::ProducerConsumerQueue<Element>>(
+              nProducers, nConsumers);
+      auto lockFreeQueue = runBenchmark<fl::lib::LockFreeQueue<Element>>(
+          nProducers, nConsumers);
+      std::cout << std::setw(10) << nProducers << std::setw(10) << nConsumers
+                << std::setw(12) << mutexQueue << std::setw(12)
+                << lockFreeQueue << std::setw(10)
+                << lockFreeQueue / mutexQueue << std::endl;
+    }
+  }
+  return 0;
+}
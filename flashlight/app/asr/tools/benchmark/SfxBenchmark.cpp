@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "flashlight/lib/text/String.h"
+#include "flashlight/pkg/speech/augmentation/Convolution.h"
+#include "flashlight/pkg/speech/augmentation/SoundBank.h"
+#include "flashlight/pkg/speech/augmentation/SoundEffectConfig.h"
+
+DEFINE_string(config, "", "Path to a sound effect json config file");
+DEFINE_int32(num_samples, 200, "Number of samples augmented in each run");
+DEFINE_double(duration, 15, "Duration of the samples in sec");
+DEFINE_int32(sample_rate, 16000, "Sample rate of the audio");
+DEFINE_string(threads, "1,4,8", "Numbers of data loading threads to run");
+DEFINE_int32(
+    sound_bank_mb,
+    -1,
+    "Size of the sound bank in MB, 0 decodes the sound files at every use, "
+    "-1 for the FL_SFX_SOUND_BANK_MB environment variable or its default");
+DEFINE_string(
+    rir_ms,
+    "50,300,1000",
+    "Lengths in msec of the impulse responses of the convolution benchmark");
+
+namespace {
+
+using namespace ::fl::pkg::speech::sfx;
+using Clock = std::chrono::high_resolution_clock;
+
+double secSince(const Clock::time_point& start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::vector<float> randomSignal(size_t size, unsigned int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1, 1);
+  std::vector<float> signal(size);
+  for (auto& x : signal) {
+    x = dist(gen);
+  }
+  return signal;
+}
+
+// Returns the number of samples augmented per second
+double runSfx(
+    const std::vector<SoundEffectConfig>& config,
+    const std::vector<float>& signal,
+    int nThreads) {
+  auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      // one sound effect chain per data loading thread, as in the datasets
+      auto sfx = createSoundEffect(config, t);
+      for (int i = t; i < FLAGS_num_samples; i += nThreads) {
+        auto augmented = signal;
+        sfx->apply(augmented);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return FLAGS_num_samples / secSince(start);
+}
+
+std::vector<float> timeDomainConvolve(
+    const std::vector<float>& signal,
+    const std::vector<float>& kernel) {
+  std::vector<float> output(signal.size(), 0);
+  for (size_t k = 0; k < kernel.size(); ++k) {
+    for (size_t i = k; i < signal.size(); ++i) {
+      output[i] += signal[i - k] * kernel[k];
+    }
+  }
+  return output;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+
+  if (FLAGS_sound_bank_mb >= 0) {
+    // read by the first use of the global sound bank
+    setenv(
+        SoundBank::kMaxMbEnv, std::to_string(FLAGS_sound_bank_mb).c_str(), 1);
+  }
+  const auto signal =
+      randomSignal(FLAGS_duration * FLAGS_sample_rate, /* seed = */ 0);
+  std::cout << std::fixed << std::setprecision(2);
+
+  if (!FLAGS_config.empty()) {
+    auto config = readSoundEffectConfigFile(FLAGS_config);
+    std::cout << "Sound effects throughput on " << FLAGS_num_samples
+              << " samples of " << FLAGS_duration << " sec" << std::endl;
+    std::cout << std::setw(10) << "threads" << std::setw(14) << "samples/sec"
+              << std::setw(14) << "x realtime" << std::setw(10) << "hits"
+              << std::setw(10) << "misses" << std::endl;
+    for (const auto& n : fl::lib::split(",", FLAGS_threads, true)) {
+      const int nThreads = std::stoi(n);
+      auto bank = SoundBank::global();
+      const auto hits = bank->numHits(), misses = bank->numMisses();
+      const double samplesPerSec = runSfx(config, signal, nThreads);
+      std::cout << std::setw(10) << nThreads << std::setw(14) << samplesPerSec
+                << std::setw(14) << samplesPerSec * FLAGS_duration
+                << std::setw(10) << bank->numHits() - hits << std::setw(10)
+                << bank->numMisses() - misses << std::endl;
+    }
+  }
+
+  std::cout << "Convolution of " << FLAGS_duration << " sec of audio (msec)"
+            << std::endl;
+  std::cout << std::setw(10) << "rir ms" << std::setw(14) << "time domain"
+            << std::setw(14) << "fft" << std::setw(10) << "speedup"
+            << std::endl;
+  for (const auto& ms : fl::lib::split(",", FLAGS_rir_ms, true)) {
+    const auto rir = randomSignal(
+        std::stoi(ms) * FLAGS_sample_rate / 1000, /* seed = */ 1);
+    auto start = Clock::now();
+    timeDomainConvolve(signal, rir);
+    const double timeDomainMs = secSince(start) * 1000;
+    start = Clock::now();
+    fftConvolve(signal, rir);
+    const double fftMs = secSince(start) * 1000;
+    std::cout << std::setw(10) << ms << std::setw(14) << timeDomainMs
+              << std::setw(14) << fftMs << std::setw(10)
+              << timeDomainMs / fftMs << std::endl;
+  }
+  return 0;
+}
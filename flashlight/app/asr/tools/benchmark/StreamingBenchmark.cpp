@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "flashlight/fl/flashlight.h"
+#include "flashlight/pkg/runtime/common/SequentialBuilder.h"
+#include "flashlight/pkg/speech/common/Defines.h"
+#include "flashlight/pkg/speech/data/FeatureTransforms.h"
+#include "flashlight/pkg/speech/streaming/StreamingEncoder.h"
+#include "flashlight/pkg/speech/streaming/StreamingFeatures.h"
+
+DEFINE_string(arch, "", "path to architecture file");
+DEFINE_int32(in_features, 80, "Number of filterbanks (input features)");
+DEFINE_int32(out_channels, 28, "Number of output channels");
+DEFINE_int32(sample_rate, 16000, "Sample rate of the audio");
+DEFINE_double(duration, 15, "Duration of the audio in sec");
+DEFINE_int32(chunk_ms, 200, "Size of the audio chunks in msec");
+DEFINE_int32(localnrmlleftctx, 300, "Left context of the local normalization");
+DEFINE_int32(
+    max_attention_context,
+    -1,
+    "Number of previous frames transformer layers attend to, -1 for all");
+DEFINE_int32(num_iters, 5, "Number of iterations to run for benchmarking");
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+double msecSince(const Clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+double percentile(std::vector<double> values, double p) {
+  std::sort(values.begin(), values.end());
+  return values[std::min<size_t>(p * values.size(), values.size() - 1)];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  fl::init();
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+
+  std::cout << "Loading architecture file from " << FLAGS_arch << std::endl;
+  std::shared_ptr<fl::Module> network =
+      fl::pkg::runtime::buildSequentialModule(
+          FLAGS_arch, FLAGS_in_features, FLAGS_out_channels);
+  std::cout << network->prettyString() << std::endl;
+  fl::pkg::speech::StreamingEncoder encoder(
+      network, FLAGS_max_attention_context);
+
+  fl::lib::audio::FeatureParams featParams(
+      FLAGS_sample_rate,
+      25, // framesize
+      10, // framestride
+      FLAGS_in_features,
+      0, // lowfreqfilterbank
+      -1, // highfreqfilterbank
+      -1, // mfcccoeffs
+      fl::pkg::speech::kLifterParam,
+      0, // delta window
+      0 // delta-delta window
+  );
+  featParams.useEnergy = false;
+  featParams.usePower = false;
+  featParams.zeroMeanFrame = false;
+  fl::pkg::speech::StreamingFeatures features(
+      featParams,
+      fl::pkg::speech::FeatureType::MFSC,
+      {FLAGS_localnrmlleftctx, 0});
+
+  std::mt19937 gen(0);
+  std::normal_distribution<float> dist(0, 0.1);
+  std::vector<float> audio(FLAGS_duration * FLAGS_sample_rate);
+  for (auto& sample : audio) {
+    sample = dist(gen);
+  }
+  const size_t chunkSize = FLAGS_chunk_ms * FLAGS_sample_rate / 1000;
+
+  // Processes the whole audio chunk by chunk, returns the compute time of each
+  // chunk (including the flush at the end) in msec
+  auto runStreaming = [&]() {
+    std::vector<double> latencies;
+    for (size_t start = 0; start < audio.size(); start += chunkSize) {
+      std::vector<float> chunk(
+          audio.begin() + start,
+          audio.begin() + std::min(start + chunkSize, audio.size()));
+      auto begin = Clock::now();
+      auto feat = features.accept(chunk);
+      auto emissions = encoder.accept(feat);
+      fl::sync();
+      latencies.push_back(msecSince(begin));
+    }
+    auto begin = Clock::now();
+    encoder.accept(features.finish());
+    encoder.finish();
+    fl::sync();
+    latencies.push_back(msecSince(begin));
+    return latencies;
+  };
+
+  // warmup
+  runStreaming();
+  std::vector<double> latencies;
+  auto begin = Clock::now();
+  for (int i = 0; i < FLAGS_num_iters; ++i) {
+    auto iterLatencies = runStreaming();
+    latencies.insert(
+        latencies.end(), iterLatencies.begin(), iterLatencies.end());
+  }
+  double streamingMsec = msecSince(begin) / FLAGS_num_iters;
+
+  // Whole utterance, as in offline decoding
+  auto inputTransform = fl::pkg::speech::inputFeatures(
+      featParams,
+      fl::pkg::speech::FeatureType::MFSC,
+      {FLAGS_localnrmlleftctx, 0});
+  network->eval();
+  begin = Clock::now();
+  for (int i = 0; i < FLAGS_num_iters; ++i) {
+    auto input = inputTransform(
+        static_cast<void*>(audio.data()),
+        {1, static_cast<fl::Dim>(audio.size())},
+        fl::dtype::f32);
+    auto inputLen = fl::full({1}, input.dim(0));
+    fl::pkg::runtime::forwardSequentialModuleWithPadMask(
+        fl::input(input), network, inputLen);
+    fl::sync();
+  }
+  double offlineMsec = msecSince(begin) / FLAGS_num_iters;
+
+  double audioMsec = FLAGS_duration * 1000;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Chunk of " << FLAGS_chunk_ms << " msec, "
+            << latencies.size() / FLAGS_num_iters << " chunks" << std::endl;
+  std::cout << "Chunk latency (msec): p50 " << percentile(latencies, 0.5)
+            << ", p90 " << percentile(latencies, 0.9) << ", max "
+            << percentile(latencies, 1.) << std::endl;
+  std::cout << "Streaming RTF: " << streamingMsec / audioMsec << std::endl;
+  std::cout << "Offline RTF: " << offlineMsec / audioMsec << std::endl;
+  return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "flashlight/app/benchmark/Suite.h"
+#include "flashlight/fl/tensor/Compute.h"
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/Random.h"
+#include "flashlight/fl/tensor/TensorAdapter.h"
+#include "flashlight/fl/tensor/TensorBase.h"
+
+#if FL_USE_ARRAYFIRE && FL_ARRAYFIRE_USE_CPU
+#include "flashlight/fl/tensor/backend/af/ArrayFireTensor.h"
+#endif
+#if FL_USE_ONEDNN
+#include "flashlight/fl/tensor/backend/onednn/OneDnnTensor.h"
+#endif
+
+/**
+ * Per-op throughput of the CPU tensor backends
+ *
+ * Usage:
+ *
+ *  benchmark_backend_ops \
+ *   --filter="sort" \
+ *   --warmup=5 \
+ *   --repetitions=20
+ *
+ * -------------------------------
+ *
+ * Runs the same op cases with every CPU backend built in (ArrayFire CPU and
+ * OneDNN) and reports elements processed per second, and the speedup of each
+ * backend over ArrayFire where both are available.
+ */
+
+DEFINE_string(filter, ".*", "Regex selecting the ops to run");
+DEFINE_int32(warmup, 5, "Number of untimed runs of each op");
+DEFINE_int32(repetitions, 20, "Number of timed runs of each op");
+
+namespace {
+
+using fl::app::benchmark::BenchmarkCase;
+using fl::app::benchmark::BenchmarkStats;
+using fl::app::benchmark::BenchmarkSuite;
+
+constexpr int kRows = 1024;
+constexpr int kCols = 1024;
+
+// Time `op` on a (kRows, kCols) f32 input
+template <typename Op>
+BenchmarkCase unaryCase(Op op) {
+  return [op]() -> std::function<void()> {
+    auto input = fl::rand({kRows, kCols});
+    return [op, input]() {
+      auto out = op(input);
+      fl::eval(out);
+    };
+  };
+}
+
+BenchmarkSuite makeSuite() {
+  BenchmarkSuite suite;
+  suite.add("sin", unaryCase([](const fl::Tensor& a) { return fl::sin(a); }));
+  suite.add(
+      "floor", unaryCase([](const fl::Tensor& a) { return fl::floor(a); }));
+  suite.add(
+      "sigmoid",
+      unaryCase([](const fl::Tensor& a) { return fl::sigmoid(a); }));
+  suite.add(
+      "concatenate_axis1",
+      unaryCase(
+          [](const fl::Tensor& a) { return fl::concatenate({a, a}, 1); }));
+  suite.add(
+      "pad_symmetric",
+      unaryCase([](const fl::Tensor& a) {
+        return fl::pad(a, {{8, 8}, {8, 8}}, fl::PadType::Symmetric);
+      }));
+  suite.add(
+      "flip_axis0",
+      unaryCase([](const fl::Tensor& a) { return fl::flip(a, 0); }));
+  suite.add(
+      "roll_axis1",
+      unaryCase([](const fl::Tensor& a) { return fl::roll(a, 7, 1); }));
+  suite.add("tril", unaryCase([](const fl::Tensor& a) { return fl::tril(a); }));
+  suite.add(
+      "where",
+      unaryCase([](const fl::Tensor& a) { return fl::where(a > 0.5, a, -a); }));
+  suite.add(
+      "sort_axis0",
+      unaryCase([](const fl::Tensor& a) { return fl::sort(a, 0); }));
+  suite.add(
+      "argsort_axis1",
+      unaryCase([](const fl::Tensor& a) { return fl::argsort(a, 1); }));
+  suite.add("topk_16_axis0", unaryCase([](const fl::Tensor& a) {
+              fl::Tensor values, indices;
+              fl::topk(values, indices, a, 16, 0);
+              return values;
+            }));
+  suite.add(
+      "cumsum_axis1",
+      unaryCase([](const fl::Tensor& a) { return fl::cumsum(a, 1); }));
+  suite.add(
+      "argmax_axis0",
+      unaryCase([](const fl::Tensor& a) { return fl::argmax(a, 0); }));
+  suite.add(
+      "median_axis0",
+      unaryCase([](const fl::Tensor& a) { return fl::median(a, {0}); }));
+  suite.add(
+      "var_axis1",
+      unaryCase([](const fl::Tensor& a) { return fl::var(a, {1}); }));
+  suite.add("index_gather", []() -> std::function<void()> {
+    auto input = fl::rand({kRows, kCols});
+    auto idx = (fl::rand({kRows}) * (kRows - 1)).astype(fl::dtype::s32);
+    return [input, idx]() {
+      auto out = input(idx);
+      fl::eval(out);
+    };
+  });
+  return suite;
+}
+
+// Run the suite with T as the default tensor type
+template <typename T>
+std::vector<BenchmarkStats> runWithBackend(const BenchmarkSuite& suite) {
+  std::vector<BenchmarkStats> results;
+  fl::withTensorType<T>([&]() {
+    results = suite.run(FLAGS_filter, FLAGS_warmup, FLAGS_repetitions);
+  });
+  return results;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  fl::init();
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+
+  const auto suite = makeSuite();
+  // backend name -> op name -> stats
+  std::map<std::string, std::map<std::string, BenchmarkStats>> results;
+  const auto record = [&](const std::string& backend,
+                          const std::vector<BenchmarkStats>& stats) {
+    for (const auto& s : stats) {
+      results[backend][s.name] = s;
+    }
+  };
+#if FL_USE_ARRAYFIRE && FL_ARRAYFIRE_USE_CPU
+  record("ArrayFire", runWithBackend<fl::ArrayFireTensor>(suite));
+#endif
+#if FL_USE_ONEDNN
+  record("OneDnn", runWithBackend<fl::OneDnnTensor>(suite));
+#endif
+  if (results.empty()) {
+    std::cerr << "No CPU tensor backend to benchmark" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const double elements = static_cast<double>(kRows) * kCols;
+  const auto baseline = results.find("ArrayFire");
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::left << std::setw(20) << "op" << std::setw(12)
+            << "backend" << std::right << std::setw(12) << "mean(ms)"
+            << std::setw(12) << "Melem/s" << std::setw(12) << "vs AF"
+            << std::endl;
+  for (const auto& [backend, ops] : results) {
+    for (const auto& [name, stats] : ops) {
+      std::cout << std::left << std::setw(20) << name << std::setw(12)
+                << backend << std::right << std::setw(12) << stats.mean * 1000
+                << std::setw(12) << elements / stats.mean / 1e6;
+      if (baseline != results.end() && baseline->second.count(name)) {
+        std::cout << std::setw(11)
+                  << baseline->second.at(name).mean / stats.mean << "x";
+      }
+      std::cout << std::endl;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "flashlight/app/benchmark/Suite.h"
+#include "flashlight/app/benchmark/models/AsrTransformer.h"
+#include "flashlight/app/benchmark/models/LmTransformer.h"
+#include "flashlight/fl/flashlight.h"
+
+/**
+ * Per-request latency and allocations of model inference
+ *
+ * Usage:
+ *
+ *  benchmark_inference \
+ *   --filter="asr_transformer" \
+ *   --repetitions=20
+ *
+ * -------------------------------
+ *
+ * Runs single forward passes ("requests") of the benchmark models in eval
+ * mode, once building the autograd graph as usual and once under
+ * fl::InferenceModeGuard, and reports the latency of a request, the number of
+ * host heap allocations it makes and the speedup of inference mode.
+ */
+
+DEFINE_string(filter, ".*", "Regex selecting the cases to run");
+DEFINE_int32(warmup, 3, "Number of untimed requests of each case");
+DEFINE_int32(repetitions, 20, "Number of timed requests of each case");
+
+namespace {
+
+std::atomic<size_t> numAllocations{0};
+
+} // namespace
+
+// Count every heap allocation of the process
+void* operator new(std::size_t size) {
+  numAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /* size */) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+using fl::app::benchmark::BenchmarkStats;
+using fl::app::benchmark::BenchmarkSuite;
+
+struct Model {
+  std::shared_ptr<fl::Module> module;
+  std::vector<fl::Variable> inputs;
+};
+
+// A forward pass, evaluating its outputs
+void request(const Model& model, bool inferenceMode) {
+  std::optional<fl::InferenceModeGuard> guard;
+  if (inferenceMode) {
+    guard.emplace();
+  }
+  for (auto& output : model.module->forward(model.inputs)) {
+    output.eval();
+  }
+}
+
+// Model name -> model, created on first use
+std::map<std::string, std::function<Model()>> makeModels() {
+  std::map<std::string, std::function<Model()>> models;
+  models["mlp"] = []() {
+    auto mlp = std::make_shared<fl::Sequential>();
+    mlp->add(fl::Linear(512, 2048));
+    mlp->add(fl::ReLU());
+    mlp->add(fl::Dropout(0.1));
+    mlp->add(fl::Linear(2048, 2048));
+    mlp->add(fl::ReLU());
+    mlp->add(fl::Dropout(0.1));
+    mlp->add(fl::Linear(2048, 512));
+    return Model{mlp, {fl::noGrad(fl::rand({512, 16}))}};
+  };
+  models["asr_transformer"] = []() {
+    const int numFrames = 300, numFeatures = 80, numTarget = 30;
+    return Model{
+        std::make_shared<fl::app::benchmark::AsrTransformer>(
+            numFeatures, numTarget),
+        {fl::noGrad(fl::rand({numFrames, 1, numFeatures, 1})),
+         fl::noGrad(fl::full({1, 1}, numFrames))}};
+  };
+  models["lm_transformer"] = []() {
+    const int numTokens = 60000, numFrames = 128;
+    return Model{
+        std::make_shared<fl::app::benchmark::LmTransformer>(numTokens),
+        {fl::noGrad(
+            (fl::rand({numFrames, 1}) * 10000).astype(fl::dtype::s32))}};
+  };
+  return models;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  fl::init();
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+
+  BenchmarkSuite suite;
+  // case name -> host allocations per request
+  auto allocations = std::make_shared<std::map<std::string, double>>();
+  for (const auto& [name, makeModel] : makeModels()) {
+    auto model = std::make_shared<std::optional<Model>>();
+    for (bool inferenceMode : {false, true}) {
+      const auto caseName =
+          (inferenceMode ? "inference/" : "autograd/") + name;
+      suite.add(
+          caseName,
+          [=, makeModel = makeModel]() -> std::function<void()> {
+            if (!*model) {
+              *model = makeModel();
+              (*model)->module->eval();
+            }
+            // Count over the warmup requests, which aren't timed
+            const size_t before = numAllocations.load();
+            for (int i = 0; i < FLAGS_warmup; ++i) {
+              request(**model, inferenceMode);
+            }
+            (*allocations)[caseName] =
+                static_cast<double>(numAllocations.load() - before) /
+                std::max(FLAGS_warmup, 1);
+            return [model, inferenceMode]() {
+              request(**model, inferenceMode);
+            };
+          });
+    }
+  }
+
+  // case name without the mode prefix -> mode -> stats
+  std::map<std::string, std::map<std::string, BenchmarkStats>> results;
+  for (const auto& stats : suite.run(FLAGS_filter, 0, FLAGS_repetitions)) {
+    const auto slash = stats.name.find('/');
+    results[stats.name.substr(slash + 1)][stats.name.substr(0, slash)] = stats;
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::left << std::setw(20) << "model" << std::setw(12) << "mode"
+            << std::right << std::setw(12) << "mean(ms)" << std::setw(12)
+            << "median(ms)" << std::setw(14) << "allocs/req" << std::setw(12)
+            << "speedup" << std::endl;
+  for (const auto& [name, modes] : results) {
+    const auto baseline = modes.find("autograd");
+    for (const auto& [mode, stats] : modes) {
+      std::cout << std::left << std::setw(20) << name << std::setw(12) << mode
+                << std::right << std::setw(12) << stats.mean * 1000
+                << std::setw(12) << stats.median * 1000 << std::setw(14)
+                << std::setprecision(0) << (*allocations)[stats.name]
+                << std::setprecision(3);
+      if (baseline != modes.end()) {
+        std::cout << std::setw(11) << baseline->second.mean / stats.mean
+                  << "x";
+      }
+      std::cout << std::endl;
+    }
+  }
+  return EXIT_SUCCESS;
+}
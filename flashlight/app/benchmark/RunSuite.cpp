@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include <gflags/gflags.h>
+
+#include "flashlight/app/benchmark/Suite.h"
+#include "flashlight/app/benchmark/models/AsrTransformer.h"
+#include "flashlight/fl/contrib/modules/Conformer.h"
+#include "flashlight/fl/contrib/modules/Transformer.h"
+#include "flashlight/fl/flashlight.h"
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/pkg/speech/criterion/criterion.h"
+#include "flashlight/pkg/vision/models/Resnet.h"
+
+/**
+ * Benchmark suite for regression tracking
+ *
+ * Usage:
+ *
+ *  benchmark_suite \
+ *   --filter="^module/" \
+ *   --warmup=5 \
+ *   --repetitions=30 \
+ *   --output_json=current.json \
+ *   --baseline_json=baseline.json \
+ *   --regression_threshold=0.05
+ *
+ * -------------------------------
+ *
+ * Cases are grouped by name prefix: `op/` for single TensorBackend ops,
+ * `module/` for forward and backward of single modules and `model/` for full
+ * training steps of end-to-end models. `op/` and `module/` cases use small
+ * inputs and run in milliseconds on CPU. `model/` cases train the full-size
+ * models (ResNet-34 on a batch of 4 224x224 images, the ASR Transformer on 2
+ * utterances of 300 frames) and take seconds per step on CPU; select them
+ * out with `--filter` when iterating. Results can be saved as JSON and used as
+ * the baseline of a later run, which exits with a non-zero status if any case
+ * regressed.
+ */
+
+DEFINE_string(filter, ".*", "Regex selecting the benchmark cases to run");
+DEFINE_int32(warmup, 5, "Number of untimed runs of each case");
+DEFINE_int32(repetitions, 20, "Number of timed runs of each case");
+DEFINE_string(output_json, "", "Path to write results to, as JSON");
+DEFINE_string(
+    baseline_json,
+    "",
+    "Path to results of a previous run to compare against");
+DEFINE_double(
+    regression_threshold,
+    0.05,
+    "Relative slowdown of the mean over the baseline to report as regression");
+
+namespace {
+
+using fl::app::benchmark::BenchmarkCase;
+using fl::app::benchmark::BenchmarkSuite;
+
+// Forward and backward of a module with a gradient of ones
+BenchmarkCase moduleCase(
+    std::shared_ptr<fl::Module> module,
+    std::vector<fl::Variable> inputs) {
+  return [module, inputs]() -> std::function<void()> {
+    module->train();
+    return [module, inputs]() {
+      module->zeroGrad();
+      auto output = module->forward(inputs).front();
+      output.backward(fl::Variable(fl::full(output.shape(), 1.f), false));
+    };
+  };
+}
+
+void addOpCases(BenchmarkSuite& suite) {
+  suite.add("op/add_4M", []() -> std::function<void()> {
+    auto a = fl::rand({2048, 2048});
+    auto b = fl::rand({2048, 2048});
+    return [a, b]() {
+      auto out = a + b;
+      fl::eval(out);
+    };
+  });
+  suite.add("op/exp_4M", []() -> std::function<void()> {
+    auto a = fl::rand({2048, 2048});
+    return [a]() {
+      auto out = fl::exp(a);
+      fl::eval(out);
+    };
+  });
+  suite.add("op/sum_axis0_4M", []() -> std::function<void()> {
+    auto a = fl::rand({2048, 2048});
+    return [a]() {
+      auto out = fl::sum(a, {0});
+      fl::eval(out);
+    };
+  });
+  suite.add("op/transpose_4M", []() -> std::function<void()> {
+    auto a = fl::rand({2048, 2048});
+    return [a]() {
+      auto out = fl::transpose(a);
+      fl::eval(out);
+    };
+  });
+  suite.add("op/matmul_512", []() -> std::function<void()> {
+    auto a = fl::rand({512, 512});
+    auto b = fl::rand({512, 512});
+    return [a, b]() {
+      auto out = fl::matmul(a, b);
+      fl::eval(out);
+    };
+  });
+  suite.add("op/index_gather_64K", []() -> std::function<void()> {
+    auto a = fl::rand({65536, 16});
+    auto idx = (fl::rand({65536}) * 65535).astype(fl::dtype::s32);
+    return [a, idx]() {
+      auto out = a(idx);
+      fl::eval(out);
+    };
+  });
+}
+
+void addModuleCases(BenchmarkSuite& suite) {
+  suite.add(
+      "module/linear_1024",
+      moduleCase(
+          std::make_shared<fl::Linear>(1024, 1024),
+          {fl::input(fl::rand({1024, 64}))}));
+  suite.add(
+      "module/conv2d_3x3_64",
+      moduleCase(
+          std::make_shared<fl::Conv2D>(64, 64, 3, 3, 1, 1, 1, 1),
+          {fl::input(fl::rand({32, 32, 64, 8}))}));
+  suite.add(
+      "module/lstm_256",
+      moduleCase(
+          std::make_shared<fl::RNN>(256, 256, 1, fl::RnnMode::LSTM),
+          {fl::input(fl::rand({256, 8, 50}))}));
+  suite.add(
+      "module/transformer_256",
+      moduleCase(
+          std::make_shared<fl::Transformer>(256, 64, 1024, 4, 0, 0., 0.),
+          {fl::input(fl::rand({256, 100, 4})), fl::Variable()}));
+  suite.add(
+      "module/conformer_256",
+      moduleCase(
+          std::make_shared<fl::Conformer>(256, 64, 1024, 4, 0, 31, 0.),
+          {fl::input(fl::rand({256, 100, 4})), fl::Variable()}));
+}
+
+// Full training step: forward, criterion, backward and SGD update
+BenchmarkCase modelCase(
+    std::shared_ptr<fl::Module> model,
+    std::vector<fl::Variable> inputs,
+    std::function<fl::Variable(const fl::Variable&)> criterion) {
+  return [model, inputs, criterion]() -> std::function<void()> {
+    model->train();
+    auto optimizer =
+        std::make_shared<fl::SGDOptimizer>(model->params(), 0.1, 0.9);
+    return [model, inputs, criterion, optimizer]() {
+      optimizer->zeroGrad();
+      auto loss = criterion(model->forward(inputs).front());
+      loss.backward();
+      optimizer->step();
+    };
+  };
+}
+
+void addModelCases(BenchmarkSuite& suite) {
+  {
+    const int batchsize = 4, imgSize = 224;
+    auto target =
+        fl::noGrad((fl::rand({batchsize}) * 1000).astype(fl::dtype::s32));
+    suite.add(
+        "model/resnet34",
+        modelCase(
+            fl::pkg::vision::resnet34(),
+            {fl::input(fl::rand({imgSize, imgSize, 3, batchsize}))},
+            [target](const fl::Variable& output) {
+              return fl::categoricalCrossEntropy(
+                  fl::logSoftmax(output, 0), target);
+            }));
+  }
+  {
+    const int batchsize = 2, numFrames = 300, numFeatures = 80;
+    const int numTarget = 30, targetLength = 20;
+    auto target = fl::noGrad(
+        (fl::rand({targetLength, batchsize}) * numTarget)
+            .astype(fl::dtype::s32));
+    auto ctc = std::make_shared<fl::pkg::speech::CTCLoss>(
+        fl::lib::seq::CriterionScaleMode::NONE);
+    suite.add(
+        "model/asr_transformer",
+        modelCase(
+            std::make_shared<fl::app::benchmark::AsrTransformer>(
+                numFeatures, numTarget),
+            {fl::input(fl::rand({numFrames, 1, numFeatures, batchsize})),
+             fl::input(fl::full({1, batchsize}, numFrames))},
+            [ctc, target](const fl::Variable& output) {
+              return ctc->forward({output, target}).front();
+            }));
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  fl::init();
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+  fl::DynamicBenchmark::setBenchmarkMode(true);
+
+  BenchmarkSuite suite;
+  addOpCases(suite);
+  addModuleCases(suite);
+  addModelCases(suite);
+
+  auto results = suite.run(FLAGS_filter, FLAGS_warmup, FLAGS_repetitions);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::left << std::setw(32) << "case" << std::right
+            << std::setw(12) << "mean(ms)" << std::setw(12) << "+/-(ms)"
+            << std::setw(12) << "median(ms)" << std::endl;
+  for (const auto& stats : results) {
+    std::cout << std::left << std::setw(32) << stats.name << std::right
+              << std::setw(12) << stats.mean * 1000 << std::setw(12)
+              << (stats.ciHigh - stats.mean) * 1000 << std::setw(12)
+              << stats.median * 1000 << std::endl;
+  }
+
+  if (!FLAGS_output_json.empty()) {
+    fl::app::benchmark::saveBenchmarkJson(FLAGS_output_json, results);
+  }
+
+  if (!FLAGS_baseline_json.empty()) {
+    auto baseline = fl::app::benchmark::loadBenchmarkJson(FLAGS_baseline_json);
+    auto regressions = fl::app::benchmark::findRegressions(
+        results, baseline, FLAGS_regression_threshold);
+    for (const auto& r : regressions) {
+      std::cout << "REGRESSION " << r.name << ": " << r.baselineMean * 1000
+                << " ms -> " << r.currentMean * 1000 << " ms (+"
+                << r.slowdown * 100 << "%)" << std::endl;
+    }
+    if (!regressions.empty()) {
+      return EXIT_FAILURE;
+    }
+    std::cout << "No regressions against " << FLAGS_baseline_json
+              << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
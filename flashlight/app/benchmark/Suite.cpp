@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/app/benchmark/Suite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <regex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "flashlight/fl/common/Logging.h"
+#include "flashlight/fl/tensor/Compute.h"
+
+namespace fl {
+namespace app {
+namespace benchmark {
+
+namespace {
+
+// Two-sided 97.5% quantiles of Student's t-distribution for 1 to 30 degrees
+// of freedom; the normal quantile is used beyond that.
+constexpr double kStudentT975[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+double studentT975(int64_t degreesOfFreedom) {
+  constexpr int64_t kTableSize = sizeof(kStudentT975) / sizeof(double);
+  if (degreesOfFreedom <= 0) {
+    return 0.;
+  }
+  if (degreesOfFreedom <= kTableSize) {
+    return kStudentT975[degreesOfFreedom - 1];
+  }
+  return 1.96;
+}
+
+} // namespace
+
+BenchmarkStats computeStats(
+    const std::string& name,
+    std::vector<double> timings) {
+  if (timings.empty()) {
+    throw std::invalid_argument("computeStats: no timings for " + name);
+  }
+  BenchmarkStats stats;
+  stats.name = name;
+  const int64_t n = timings.size();
+  stats.repetitions = n;
+  stats.mean = std::accumulate(timings.begin(), timings.end(), 0.) / n;
+  double sqSum = 0.;
+  for (const auto t : timings) {
+    sqSum += (t - stats.mean) * (t - stats.mean);
+  }
+  stats.stddev = n > 1 ? std::sqrt(sqSum / (n - 1)) : 0.;
+  std::sort(timings.begin(), timings.end());
+  stats.min = timings.front();
+  stats.median = n % 2 ? timings[n / 2]
+                       : (timings[n / 2 - 1] + timings[n / 2]) / 2.;
+  const double halfWidth = studentT975(n - 1) * stats.stddev / std::sqrt(n);
+  stats.ciLow = stats.mean - halfWidth;
+  stats.ciHigh = stats.mean + halfWidth;
+  return stats;
+}
+
+BenchmarkStats measure(
+    const std::string& name,
+    const std::function<void()>& fn,
+    int warmup,
+    int repetitions) {
+  if (repetitions <= 0) {
+    throw std::invalid_argument("measure: repetitions must be positive");
+  }
+  for (int i = 0; i < warmup; ++i) {
+    fn();
+  }
+  fl::sync();
+
+  std::vector<double> timings;
+  timings.reserve(repetitions);
+  for (int i = 0; i < repetitions; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    fl::sync();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    timings.push_back(elapsed.count());
+  }
+  return computeStats(name, std::move(timings));
+}
+
+std::vector<BenchmarkRegression> findRegressions(
+    const std::vector<BenchmarkStats>& results,
+    const std::vector<BenchmarkStats>& baseline,
+    double threshold) {
+  std::unordered_map<std::string, const BenchmarkStats*> baselineByName;
+  for (const auto& stats : baseline) {
+    baselineByName[stats.name] = &stats;
+  }
+
+  std::vector<BenchmarkRegression> regressions;
+  for (const auto& current : results) {
+    auto it = baselineByName.find(current.name);
+    if (it == baselineByName.end()) {
+      continue;
+    }
+    const auto& base = *it->second;
+    if (base.mean <= 0.) {
+      continue;
+    }
+    const double slowdown = current.mean / base.mean - 1.;
+    if (slowdown > threshold && current.ciLow > base.ciHigh) {
+      regressions.push_back({current.name, base.mean, current.mean, slowdown});
+    }
+  }
+  return regressions;
+}
+
+void saveBenchmarkJson(
+    const fs::path& path,
+    const std::vector<BenchmarkStats>& results) {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error(
+        "saveBenchmarkJson: cannot open " + path.string() + " for writing");
+  }
+  cereal::JSONOutputArchive ar(file);
+  ar(cereal::make_nvp("benchmarks", results));
+}
+
+std::vector<BenchmarkStats> loadBenchmarkJson(const fs::path& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error(
+        "loadBenchmarkJson: cannot open " + path.string() + " for reading");
+  }
+  std::vector<BenchmarkStats> results;
+  cereal::JSONInputArchive ar(file);
+  ar(cereal::make_nvp("benchmarks", results));
+  return results;
+}
+
+void BenchmarkSuite::add(const std::string& name, BenchmarkCase setup) {
+  cases_.emplace_back(name, std::move(setup));
+}
+
+std::vector<BenchmarkStats> BenchmarkSuite::run(
+    const std::string& filter,
+    int warmup,
+    int repetitions) const {
+  const std::regex filterRegex(filter);
+  std::vector<BenchmarkStats> results;
+  for (const auto& [name, setup] : cases_) {
+    if (!std::regex_search(name, filterRegex)) {
+      continue;
+    }
+    auto fn = setup();
+    results.push_back(measure(name, fn, warmup, repetitions));
+    const auto& stats = results.back();
+    FL_LOG(fl::LogLevel::INFO)
+        << name << ": mean " << stats.mean * 1000 << " ms [95% CI "
+        << stats.ciLow * 1000 << ", " << stats.ciHigh * 1000 << "], median "
+        << stats.median * 1000 << " ms";
+  }
+  return results;
+}
+
+} // namespace benchmark
+} // namespace app
+} // namespace fl
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/common/Serialization.h"
+
+namespace fl {
+namespace app {
+namespace benchmark {
+
+/**
+ * Timing statistics of a single benchmark case, in seconds per iteration.
+ * `ciLow` and `ciHigh` bound the 95% confidence interval of the mean.
+ */
+struct BenchmarkStats {
+  std::string name;
+  int64_t repetitions{0};
+  double mean{0};
+  double stddev{0};
+  double min{0};
+  double median{0};
+  double ciLow{0};
+  double ciHigh{0};
+
+  template <class Archive>
+  void serialize(Archive& ar) {
+    ar(CEREAL_NVP(name),
+       CEREAL_NVP(repetitions),
+       CEREAL_NVP(mean),
+       CEREAL_NVP(stddev),
+       CEREAL_NVP(min),
+       CEREAL_NVP(median),
+       CEREAL_NVP(ciLow),
+       CEREAL_NVP(ciHigh));
+  }
+};
+
+/**
+ * Run `fn` `warmup` times, then time `repetitions` runs of it, synchronizing
+ * the device after each run.
+ */
+BenchmarkStats measure(
+    const std::string& name,
+    const std::function<void()>& fn,
+    int warmup,
+    int repetitions);
+
+/**
+ * Compute statistics over per-iteration timings.
+ */
+BenchmarkStats computeStats(
+    const std::string& name,
+    std::vector<double> timings);
+
+/**
+ * A regression of a benchmark case relative to a baseline.
+ */
+struct BenchmarkRegression {
+  std::string name;
+  double baselineMean;
+  double currentMean;
+  // currentMean / baselineMean - 1
+  double slowdown;
+};
+
+/**
+ * Compare `results` to `baseline`. A case regresses if its mean is more than
+ * `threshold` (relative) slower than the baseline and the confidence intervals
+ * of both runs do not overlap, so that noise alone does not fail the
+ * comparison. Cases missing from either side are ignored.
+ */
+std::vector<BenchmarkRegression> findRegressions(
+    const std::vector<BenchmarkStats>& results,
+    const std::vector<BenchmarkStats>& baseline,
+    double threshold);
+
+void saveBenchmarkJson(
+    const fs::path& path,
+    const std::vector<BenchmarkStats>& results);
+
+std::vector<BenchmarkStats> loadBenchmarkJson(const fs::path& path);
+
+/**
+ * Sets up the inputs of a benchmark case and returns the function to time.
+ * Setup is run once per case and is not timed.
+ */
+using BenchmarkCase = std::function<std::function<void()>()>;
+
+/**
+ * A collection of named benchmark cases which can be selected by a regex
+ * filter and run with the same warmup and repetition settings.
+ */
+class BenchmarkSuite {
+ public:
+  void add(const std::string& name, BenchmarkCase setup);
+
+  /**
+   * Run all cases whose name matches `filter` (as an ECMAScript regex search).
+   */
+  std::vector<BenchmarkStats>
+  run(const std::string& filter, int warmup, int repetitions) const;
+
+ private:
+  std::vector<std::pair<std::string, BenchmarkCase>> cases_;
+};
+
+} // namespace benchmark
+} // namespace app
+} // namespace fl
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "flashlight/app/benchmark/Suite.h"
+#include "flashlight/fl/common/threadpool/ThreadPool.h"
+#include "flashlight/fl/tensor/Init.h"
+
+/**
+ * Scheduling overhead of fl::ThreadPool on fine-grained tasks
+ *
+ * Usage:
+ *
+ *  benchmark_threadpool \
+ *   --threads=8 \
+ *   --filter="parallel_for" \
+ *   --repetitions=20
+ *
+ * -------------------------------
+ *
+ * Runs batches of tiny tasks with fl::ThreadPool and with a reference pool
+ * sharing a single locked queue between the workers (the design ThreadPool
+ * had before), and reports the time per task of both and the speedup.
+ */
+
+DEFINE_string(filter, ".*", "Regex selecting the cases to run");
+DEFINE_int32(warmup, 5, "Number of untimed runs of each case");
+DEFINE_int32(repetitions, 20, "Number of timed runs of each case");
+DEFINE_int32(
+    threads,
+    0,
+    "Number of worker threads; 0 for the number of hardware threads");
+
+namespace {
+
+using fl::app::benchmark::BenchmarkStats;
+using fl::app::benchmark::BenchmarkSuite;
+
+constexpr size_t kNumTasks = 100000;
+
+// A pool with one task queue shared by all the workers
+class GlobalQueuePool {
+ public:
+  explicit GlobalQueuePool(size_t threads) {
+    for (size_t i = 0; i < threads; ++i) {
+      workers_.emplace_back([this] {
+        while (true) {
+          std::function<void()> task;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (stop_ && tasks_.empty()) {
+              return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+          }
+          task();
+        }
+      });
+    }
+  }
+
+  ~GlobalQueuePool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    condition_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  template <typename F>
+  std::future<void> enqueue(F&& f) {
+    auto task = std::make_shared<std::packaged_task<void()>>(
+        std::forward<F>(f));
+    auto res = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.emplace([task]() { (*task)(); });
+    }
+    condition_.notify_one();
+    return res;
+  }
+
+  // Chunks of `grainSize` indices enqueued as tasks, waited for in order
+  template <typename F>
+  void parallelFor(size_t size, size_t grainSize, F fn) {
+    std::vector<std::future<void>> chunks;
+    for (size_t begin = 0; begin < size; begin += grainSize) {
+      const size_t end = std::min(size, begin + grainSize);
+      chunks.push_back(enqueue([&fn, begin, end]() { fn(begin, end); }));
+    }
+    for (auto& chunk : chunks) {
+      chunk.get();
+    }
+  }
+
+ private:
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stop_{false};
+};
+
+// A few hundred nanoseconds of work per index
+void work(std::atomic<size_t>& sink, size_t begin, size_t end) {
+  size_t acc = 0;
+  for (size_t i = begin; i < end; ++i) {
+    for (size_t j = 0; j < 64; ++j) {
+      acc += (i * 2654435761U) ^ j;
+    }
+  }
+  sink.fetch_add(acc, std::memory_order_relaxed);
+}
+
+template <typename Pool>
+void addCases(
+    BenchmarkSuite& suite,
+    const std::string& prefix,
+    std::shared_ptr<Pool> pool) {
+  auto sink = std::make_shared<std::atomic<size_t>>(0);
+  suite.add(prefix + "/enqueue", [pool, sink]() -> std::function<void()> {
+    return [pool, sink]() {
+      std::vector<std::future<void>> results;
+      results.reserve(kNumTasks);
+      for (size_t i = 0; i < kNumTasks; ++i) {
+        results.push_back(
+            pool->enqueue([sink, i]() { work(*sink, i, i + 1); }));
+      }
+      for (auto& result : results) {
+        result.get();
+      }
+    };
+  });
+  for (size_t grain : {1, 16, 256}) {
+    suite.add(
+        prefix + "/parallel_for_grain" + std::to_string(grain),
+        [pool, sink, grain]() -> std::function<void()> {
+          return [pool, sink, grain]() {
+            pool->parallelFor(kNumTasks, grain, [&](size_t begin, size_t end) {
+              work(*sink, begin, end);
+            });
+          };
+        });
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  fl::init();
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+
+  const size_t threads = FLAGS_threads > 0
+      ? FLAGS_threads
+      : std::max(1U, std::thread::hardware_concurrency());
+  BenchmarkSuite suite;
+  addCases(suite, "global_queue", std::make_shared<GlobalQueuePool>(threads));
+  addCases(suite, "work_stealing", std::make_shared<fl::ThreadPool>(threads));
+  auto pool = std::make_shared<fl::ThreadPool>(threads);
+  suite.add("work_stealing/task_group", [pool]() -> std::function<void()> {
+    return [pool]() {
+      std::atomic<size_t> sink{0};
+      fl::TaskGroup group(*pool);
+      for (size_t i = 0; i < kNumTasks; ++i) {
+        group.run([&sink, i]() { work(sink, i, i + 1); });
+      }
+      group.wait();
+    };
+  });
+
+  // case name without the pool prefix -> pool -> stats
+  std::map<std::string, std::map<std::string, BenchmarkStats>> results;
+  for (const auto& stats :
+       suite.run(FLAGS_filter, FLAGS_warmup, FLAGS_repetitions)) {
+    const auto slash = stats.name.find('/');
+    results[stats.name.substr(slash + 1)][stats.name.substr(0, slash)] = stats;
+  }
+
+  std::cout << "threads: " << threads << ", tasks: " << kNumTasks << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::left << std::setw(24) << "case" << std::setw(16) << "pool"
+            << std::right << std::setw(12) << "mean(ms)" << std::setw(12)
+            << "ns/index" << std::setw(12) << "speedup" << std::endl;
+  for (const auto& [name, pools] : results) {
+    const auto baseline = pools.find("global_queue");
+    for (const auto& [poolName, stats] : pools) {
+      std::cout << std::left << std::setw(24) << name << std::setw(16)
+                << poolName << std::right << std::setw(12) << stats.mean * 1000
+                << std::setw(12) << stats.mean / kNumTasks * 1e9;
+      if (baseline != pools.end()) {
+        std::cout << std::setw(11) << baseline->second.mean / stats.mean
+                  << "x";
+      }
+      std::cout << std::endl;
+    }
+  }
+  return EXIT_SUCCESS;
+}
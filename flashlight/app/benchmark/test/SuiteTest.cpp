@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flashlight/app/benchmark/Suite.h"
+#include "flashlight/fl/tensor/Init.h"
+
+using namespace fl::app::benchmark;
+
+namespace {
+
+BenchmarkStats stats(
+    const std::string& name,
+    double mean,
+    double ciLow,
+    double ciHigh) {
+  BenchmarkStats result;
+  result.name = name;
+  result.mean = mean;
+  result.ciLow = ciLow;
+  result.ciHigh = ciHigh;
+  return result;
+}
+
+} // namespace
+
+TEST(SuiteTest, computeStats) {
+  const auto result = computeStats("case", {4., 1., 3., 2.});
+  ASSERT_EQ(result.name, "case");
+  ASSERT_EQ(result.repetitions, 4);
+  ASSERT_DOUBLE_EQ(result.mean, 2.5);
+  ASSERT_DOUBLE_EQ(result.min, 1.);
+  ASSERT_DOUBLE_EQ(result.median, 2.5);
+  // sample standard deviation, with n - 1 degrees of freedom
+  ASSERT_NEAR(result.stddev, 1.2910, 1e-4);
+  // t(0.975, 3) = 3.182
+  ASSERT_NEAR(result.ciHigh - result.mean, 3.182 * 1.2910 / 2, 1e-3);
+  ASSERT_DOUBLE_EQ(result.mean - result.ciLow, result.ciHigh - result.mean);
+
+  ASSERT_DOUBLE_EQ(computeStats("odd", {3., 1., 2.}).median, 2.);
+}
+
+TEST(SuiteTest, computeStatsEdgeCases) {
+  ASSERT_THROW(computeStats("empty", {}), std::invalid_argument);
+
+  // A single run has no spread to estimate
+  const auto single = computeStats("single", {0.5});
+  ASSERT_DOUBLE_EQ(single.stddev, 0.);
+  ASSERT_DOUBLE_EQ(single.ciLow, 0.5);
+  ASSERT_DOUBLE_EQ(single.ciHigh, 0.5);
+
+  const auto constant = computeStats("constant", {2., 2., 2., 2.});
+  ASSERT_DOUBLE_EQ(constant.stddev, 0.);
+  ASSERT_DOUBLE_EQ(constant.ciLow, 2.);
+  ASSERT_DOUBLE_EQ(constant.ciHigh, 2.);
+}
+
+TEST(SuiteTest, findRegressions) {
+  const std::vector<BenchmarkStats> baseline = {
+      stats("fast", 1., 0.9, 1.1),
+      stats("noisy", 1., 0.5, 1.5),
+      stats("steady", 1., 0.99, 1.01),
+      stats("removed", 1., 0.9, 1.1)};
+  const std::vector<BenchmarkStats> current = {
+      // 20% slower with disjoint confidence intervals
+      stats("fast", 1.2, 1.15, 1.25),
+      // 20% slower, but within the noise of the baseline
+      stats("noisy", 1.2, 1.1, 1.3),
+      // disjoint confidence intervals, but below the threshold
+      stats("steady", 1.03, 1.02, 1.04),
+      stats("added", 5., 4.9, 5.1)};
+
+  const auto regressions = findRegressions(current, baseline, 0.05);
+  ASSERT_EQ(regressions.size(), 1);
+  ASSERT_EQ(regressions[0].name, "fast");
+  ASSERT_DOUBLE_EQ(regressions[0].baselineMean, 1.);
+  ASSERT_DOUBLE_EQ(regressions[0].currentMean, 1.2);
+  ASSERT_NEAR(regressions[0].slowdown, 0.2, 1e-12);
+
+  // A lower threshold also catches the steady case
+  ASSERT_EQ(findRegressions(current, baseline, 0.01).size(), 2);
+  // Speedups are never regressions
+  ASSERT_TRUE(findRegressions(baseline, current, 0.).empty());
+}
+
+TEST(SuiteTest, findRegressionsEdgeCases) {
+  const std::vector<BenchmarkStats> runs = {stats("case", 1., 0.9, 1.1)};
+  ASSERT_TRUE(findRegressions({}, runs, 0.05).empty());
+  ASSERT_TRUE(findRegressions(runs, {}, 0.05).empty());
+  ASSERT_TRUE(findRegressions({}, {}, 0.05).empty());
+
+  // Zero variance on both sides: any slowdown over the threshold counts
+  const auto baseline = computeStats("case", {1., 1., 1.});
+  const auto slower = computeStats("case", {1.1, 1.1, 1.1});
+  ASSERT_EQ(findRegressions({slower}, {baseline}, 0.05).size(), 1);
+  // but identical runs don't
+  ASSERT_TRUE(findRegressions({baseline}, {baseline}, 0.).empty());
+
+  // A baseline without a valid mean can't be compared against
+  ASSERT_TRUE(
+      findRegressions(runs, {stats("case", 0., 0., 0.)}, 0.05).empty());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
@@ -50,8 +50,7 @@ DEFINE_string(
     "If empty, uses MPI to initialize.");
 
 using namespace fl;
-using fl::pkg::vision::compose;
-using fl::pkg::vision::ImageTransform;
+using fl::pkg::vision::FusedImageTransform;
 using namespace fl::pkg::vision;
 
 #define FL_LOG_MASTER(lvl) LOG_IF(lvl, (fl::getWorldRank() == 0))
@@ -85,15 +84,16 @@ int main(int argc, char** argv) {
   const int imageSize = 224;
   // Conventional image resize parameter used for evaluation
   const int randomResizeMin = imageSize / .875;
-  ImageTransform testTransforms = compose(
-      {fl::pkg::vision::resizeTransform(randomResizeMin),
-       fl::pkg::vision::centerCropTransform(imageSize),
-       fl::pkg::vision::normalizeImage(
-           fl::app::image::kImageNetMean, fl::app::image::kImageNetStd)});
+  FusedImageTransform testTransform;
+  testTransform.outputSize = imageSize;
+  testTransform.crop =
+      fl::pkg::vision::centerCropSampler(randomResizeMin, imageSize);
+  testTransform.mean = fl::app::image::kImageNetMean;
+  testTransform.std = fl::app::image::kImageNetStd;
 
   auto labelMap = getImagenetLabels(labelPath);
   auto testDataset = fl::pkg::vision::DistributedDataset(
-      imagenetDataset(testList, labelMap, {testTransforms}),
+      imagenetDataset(testList, labelMap, testTransform),
       worldRank,
       worldSize,
       FLAGS_data_batch_size,
@@ -81,8 +81,7 @@ DEFINE_string(
     "Optim modes can be O1, O2, or O3.");
 
 using namespace fl;
-using fl::pkg::vision::compose;
-using fl::pkg::vision::ImageTransform;
+using fl::pkg::vision::FusedImageTransform;
 using namespace fl::pkg::vision;
 
 #define FL_LOG_MASTER(lvl) LOG_IF(lvl, (fl::getWorldRank() == 0))
@@ -177,31 +176,33 @@ int main(int argc, char** argv) {
   const int randomResizeMin = 256;
   const int randomCropSize = 224;
   const float horizontalFlipProb = 0.5f;
-  // TransformDataset will apply each transform in a vector to the respective
-  // Tensor. Thus, we need to `compose` all of the transforms so are each
-  // applied only to the image
-  ImageTransform trainTransforms = compose(
-      {// randomly resize shortest side of image between 256 to 480 for
-       // scale invariance
-       fl::pkg::vision::randomResizeTransform(randomResizeMin, randomResizeMax),
-       fl::pkg::vision::randomCropTransform(randomCropSize, randomCropSize),
-       fl::pkg::vision::normalizeImage(
-           fl::app::image::kImageNetMean, fl::app::image::kImageNetStd),
-       // Randomly flip image with probability of 0.5
-       fl::pkg::vision::randomHorizontalFlipTransform(horizontalFlipProb)});
-  ImageTransform valTransforms = compose(
-      {// Resize shortest side to 256, then take a center crop
-       fl::pkg::vision::resizeTransform(randomResizeMin),
-       fl::pkg::vision::centerCropTransform(randomCropSize),
-       fl::pkg::vision::normalizeImage(
-           fl::app::image::kImageNetMean, fl::app::image::kImageNetStd)});
+  // Decoding, cropping, resizing, normalizing and flipping are fused into a
+  // single pass over each image
+  FusedImageTransform trainTransform;
+  trainTransform.outputSize = randomCropSize;
+  // randomly resize shortest side of image between 256 to 480 for scale
+  // invariance, then take a random crop
+  trainTransform.crop = fl::pkg::vision::randomResizeCropSampler(
+      randomResizeMin, randomResizeMax, randomCropSize);
+  // Randomly flip image with probability of 0.5
+  trainTransform.flipProbability = horizontalFlipProb;
+  trainTransform.mean = fl::app::image::kImageNetMean;
+  trainTransform.std = fl::app::image::kImageNetStd;
+
+  FusedImageTransform valTransform;
+  valTransform.outputSize = randomCropSize;
+  // Resize shortest side to 256, then take a center crop
+  valTransform.crop =
+      fl::pkg::vision::centerCropSampler(randomResizeMin, randomCropSize);
+  valTransform.mean = fl::app::image::kImageNetMean;
+  valTransform.std = fl::app::image::kImageNetStd;
 
   const int64_t batchSizePerGpu = FLAGS_data_batch_size;
   const int64_t prefetchThreads = 10;
   const int64_t prefetchSize = FLAGS_data_batch_size;
   auto labelMap = getImagenetLabels(labelPath);
   auto trainDataset = fl::pkg::vision::DistributedDataset(
-      imagenetDataset(trainList, labelMap, {trainTransforms}),
+      imagenetDataset(trainList, labelMap, trainTransform),
       worldRank,
       worldSize,
       batchSizePerGpu,
@@ -211,7 +212,7 @@ int main(int argc, char** argv) {
       fl::BatchDatasetPolicy::SKIP_LAST);
 
   auto valDataset = fl::pkg::vision::DistributedDataset(
-      imagenetDataset(valList, labelMap, {valTransforms}),
+      imagenetDataset(valList, labelMap, valTransform),
       worldRank,
       worldSize,
       batchSizePerGpu,
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <fstream>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/common/Logging.h"
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/lib/text/String.h"
+#include "flashlight/lib/text/dictionary/Defines.h"
+#include "flashlight/lib/text/dictionary/Dictionary.h"
+#include "flashlight/lib/text/tokenizer/Tokenizer.h"
+#include "flashlight/pkg/runtime/Runtime.h"
+#include "flashlight/pkg/text/data/TokenizedCorpus.h"
+
+/**
+ * Build a pre-tokenized corpus for LM training
+ *
+ * Usage:
+ *
+ *  corpus_builder \
+ *   --data_dir=/tmp \
+ *   --data_train=test1.txt,test2.txt \
+ *   --dictionary=dictionary.txt \
+ *   --dictionary_max_size=200000 \
+ *   --n_workers=40 \
+ *   --output=train.tokbin
+ *
+ * -------------------------------
+ *
+ * It tokenizes the given files in parallel and writes them, in order, into a
+ * single binary corpus which can be memory-mapped by `TextDataset` during
+ * training with `--data_tokenized=true`. The dictionary and its max size must
+ * be the same as the ones used for training.
+ */
+
+namespace {
+DEFINE_string(data_dir, "", "Prefix for the 'data_train' files.");
+DEFINE_string(
+    data_train,
+    "",
+    "Comma-separated list of text files; '--data_dir' will be used to add prefix for the files.");
+DEFINE_string(
+    dictionary,
+    "",
+    "Path to the dictionary file, which defines tokens set of language model.");
+DEFINE_int64(
+    dictionary_max_size,
+    -1,
+    "Number of rows to use from the dictionary file (top rows), cutting the number of target classes.");
+DEFINE_int64(n_workers, 1, "Number of workers for parallel tokenization");
+DEFINE_string(output, "", "Path to the binary corpus to write");
+
+fl::lib::text::Dictionary loadDictionary(const std::string& path) {
+  fl::lib::text::Dictionary dictionary;
+  std::ifstream stream(path);
+  if (!stream) {
+    throw std::runtime_error(
+        "BuildTokenizedCorpus - cannot open dictionary " + path);
+  }
+  std::string line;
+  while (std::getline(stream, line)) {
+    auto tkns = fl::lib::splitOnWhitespace(line, true);
+    if (tkns.empty()) {
+      continue;
+    }
+    dictionary.addEntry(tkns.front());
+    if (dictionary.entrySize() == FLAGS_dictionary_max_size &&
+        FLAGS_dictionary_max_size > 0) {
+      break;
+    }
+  }
+  if (!dictionary.isContiguous()) {
+    throw std::runtime_error("Invalid dictionary format - not contiguous");
+  }
+  dictionary.setDefaultIndex(dictionary.getIndex(fl::lib::text::kUnkToken));
+  return dictionary;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  fl::init();
+  std::string exec(argv[0]);
+  gflags::SetUsageMessage(
+      "Tokenization of text data into a binary corpus. \n Usage: " + exec +
+      " \n Compulsory: [--data_train] [--dictionary] [--output]");
+  LOG(INFO) << "Parsing command line flags";
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+  LOG(INFO) << "Gflags after parsing \n"
+            << fl::pkg::runtime::serializeGflags("; ");
+
+  if (argc <= 1 || FLAGS_data_train.empty() || FLAGS_dictionary.empty() ||
+      FLAGS_output.empty()) {
+    throw std::invalid_argument(gflags::ProgramUsage());
+  }
+
+  auto dictionary = loadDictionary(FLAGS_dictionary);
+  LOG(INFO) << "Loaded dictionary with " << dictionary.entrySize()
+            << " entries";
+
+  auto nSentences = fl::pkg::text::buildTokenizedCorpus(
+      FLAGS_data_dir,
+      FLAGS_data_train,
+      fl::lib::text::Tokenizer(),
+      dictionary,
+      FLAGS_output,
+      FLAGS_n_workers);
+
+  LOG(INFO) << "Corpus with " << nSentences
+            << " sentences saved to: " << FLAGS_output;
+  return 0;
+}
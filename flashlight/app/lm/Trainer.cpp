@@ -110,6 +110,12 @@ DEFINE_bool(
     data_use_dynamic_batching,
     false,
     "if or not use dynamic batching in case of '--data_sample_break_mode=eos'.");
+DEFINE_bool(
+    data_tokenized,
+    false,
+    "if or not '--data_train' and '--data_valid' are single pre-tokenized \
+    corpora built with fl_lm_corpus_builder, which are memory-mapped instead of \
+    being loaded and tokenized at startup.");
 
 /* DICTIONARY OPTIONS */
 DEFINE_string(
@@ -174,6 +180,11 @@ DEFINE_int64(
     train_save_updates,
     0,
     "Specifies to save model every '--train_save_updates' updates.");
+DEFINE_bool(
+    train_async_save,
+    true,
+    "Write checkpoints to disk on a background thread instead of blocking "
+    "training until they are saved.");
 DEFINE_int64(
     train_report_updates,
     0,
@@ -224,7 +235,7 @@ DEFINE_string(
     fl_optim_mode,
     "",
     "[train] Sets the flashlight optimization mode. "
-    "Optim modes can be O1, O2, or O3.");
+    "Optim modes can be O1, O2, O3 or BF16.");
 
 /* ================================ Trainer ================================ */
 
@@ -253,8 +264,8 @@ Trainer::Trainer(const std::string& mode) {
   }
 
   if (FLAGS_fl_amp_use_mixed_precision) {
-    FL_LOG_MASTER(INFO)
-        << "Mixed precision training enabled. Will perform loss scaling.";
+    FL_LOG_MASTER(INFO) << "Mixed precision training enabled."
+                        << (dynamicScaler ? " Will perform loss scaling." : "");
     auto flOptimLevel = FLAGS_fl_optim_mode.empty()
         ? fl::OptimLevel::DEFAULT
         : fl::OptimMode::toOptimLevel(FLAGS_fl_optim_mode);
@@ -331,6 +342,7 @@ void Trainer::runTraining() {
       saveCheckpoint(modelPath, "." + std::to_string(batchIdx_));
     }
   }
+  checkpointWriter_.wait();
 }
 
 void Trainer::trainStep() {
@@ -442,7 +454,11 @@ void Trainer::initTrain() {
   createTrainDatasets();
   createValidDatasets();
 
-  if (FLAGS_fl_amp_use_mixed_precision) {
+  // bf16 has the range of f32 and trains without loss scaling
+  if (FLAGS_fl_amp_use_mixed_precision &&
+      (FLAGS_fl_optim_mode.empty() ||
+       fl::optimLevelRequiresLossScaling(
+           fl::OptimMode::toOptimLevel(FLAGS_fl_optim_mode)))) {
     dynamicScaler = std::make_shared<fl::pkg::runtime::DynamicScaler>(
         FLAGS_fl_amp_scale_factor,
         FLAGS_fl_amp_max_scale_factor,
@@ -554,6 +570,20 @@ void Trainer::createDictionary() {
 }
 
 void Trainer::createTrainDatasets() {
+  if (FLAGS_data_tokenized) {
+    trainDataset_ = std::make_shared<TextDataset>(
+        fs::path(FLAGS_data_dir) / FLAGS_data_train,
+        dictionary_,
+        FLAGS_data_tokens_per_sample,
+        FLAGS_data_batch_size,
+        FLAGS_data_sample_break_mode,
+        true,
+        fl::getWorldRank(),
+        fl::getWorldSize());
+    FL_LOG_MASTER(INFO) << "train dataset: " << trainDataset_->size()
+                        << " samples";
+    return;
+  }
   fl::lib::text::Tokenizer tokenizer;
   fl::lib::text::PartialFileReader partialFileReader(
       fl::getWorldRank(), fl::getWorldSize());
@@ -572,6 +602,20 @@ void Trainer::createTrainDatasets() {
 }
 
 void Trainer::createValidDatasets() {
+  if (FLAGS_data_tokenized) {
+    validDataset_ = std::make_shared<TextDataset>(
+        fs::path(FLAGS_data_dir) / FLAGS_data_valid,
+        dictionary_,
+        FLAGS_data_tokens_per_sample,
+        FLAGS_data_batch_size,
+        "eos",
+        FLAGS_data_use_dynamic_batching,
+        fl::getWorldRank(),
+        fl::getWorldSize());
+    FL_LOG_MASTER(INFO) << "valid dataset: " << validDataset_->size()
+                        << " samples";
+    return;
+  }
   fl::lib::text::Tokenizer tokenizer;
   fl::lib::text::PartialFileReader partialFileReader(
       fl::getWorldRank(), fl::getWorldSize());
@@ -841,8 +885,13 @@ void Trainer::saveCheckpoint(const fs::path& path, const std::string& suffix)
 
   FL_LOG_MASTER(INFO) << "saving model checkpoint (epoch=" << epoch_
                       << " batch=" << batchIdx_ << ") to: " << path;
-  Serializer::save(
-      path,
+  std::vector<fs::path> paths = {path};
+  if (!suffix.empty()) {
+    paths.push_back(path / suffix);
+  }
+  auto start = std::chrono::steady_clock::now();
+  checkpointWriter_.save(
+      paths,
       FL_APP_LM_VERSION,
       network_,
       criterion_,
@@ -851,19 +900,15 @@ void Trainer::saveCheckpoint(const fs::path& path, const std::string& suffix)
       batchIdx_,
       gflagsStr_,
       dynamicScaler);
-
-  if (!suffix.empty()) {
-    Serializer::save(
-        path / suffix,
-        FL_APP_LM_VERSION,
-        network_,
-        criterion_,
-        optimizer_,
-        epoch_,
-        batchIdx_,
-        gflagsStr_,
-        dynamicScaler);
+  if (!FLAGS_train_async_save) {
+    checkpointWriter_.wait();
   }
+  std::chrono::duration<double> stall =
+      std::chrono::steady_clock::now() - start;
+  FL_LOG_MASTER(INFO) << "checkpoint stall: " << stall.count()
+                      << "s (total " << checkpointWriter_.totalStall().count()
+                      << "s over " << checkpointWriter_.numCheckpoints()
+                      << " checkpoints)";
 }
 
 void Trainer::logMemoryManagerStatus() const {
@@ -25,6 +25,7 @@
 #include "flashlight/lib/text/tokenizer/PartialFileReader.h"
 #include "flashlight/lib/text/tokenizer/Tokenizer.h"
 #include "flashlight/pkg/runtime/amp/DynamicScaler.h"
+#include "flashlight/pkg/runtime/common/AsyncCheckpointWriter.h"
 #include "flashlight/pkg/runtime/common/DistributedUtils.h"
 #include "flashlight/pkg/runtime/common/Serializer.h"
 #include "flashlight/pkg/runtime/plugin/ModulePlugin.h"
@@ -60,6 +61,7 @@ DECLARE_int64(data_batch_size);
 DECLARE_int64(data_tokens_per_sample);
 DECLARE_string(data_sample_break_mode);
 DECLARE_bool(data_use_dynamic_batching);
+DECLARE_bool(data_tokenized);
 
 /* DICTIONARY OPTIONS */
 DECLARE_string(dictionary);
@@ -79,6 +81,7 @@ DECLARE_double(train_momentum);
 DECLARE_double(train_weight_decay);
 DECLARE_double(train_max_grad_norm);
 DECLARE_int64(train_save_updates);
+DECLARE_bool(train_async_save);
 DECLARE_int64(train_report_updates);
 DECLARE_int64(train_total_updates);
 
@@ -141,6 +144,9 @@ class Trainer {
   fl::AverageValueMeter tokenCountMeter_;
 
   std::ofstream logWriter_;
+  // Checkpoints are written in the background; saving only stalls training
+  // for the host snapshot
+  mutable fl::pkg::runtime::AsyncCheckpointWriter checkpointWriter_;
 
   /* Initializers */
   void initTrain();
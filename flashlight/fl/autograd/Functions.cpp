@@ -7,7 +7,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <numeric>
 #include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "flashlight/fl/autograd/Functions.h"
@@ -111,6 +115,20 @@ bool areVariableTypesEqual(const Variable& a, const Variable& b) {
 
 } // namespace detail
 
+namespace {
+
+// The result of an op given `input` as an rvalue in inference mode, which
+// records no graph: `input` holds it if it is reusable, else a new Variable
+Variable inferenceResult(Variable&& input, Tensor result) {
+  if (!input.isReusable()) {
+    return Variable(std::move(result), false);
+  }
+  input.tensor() = std::move(result);
+  return std::move(input);
+}
+
+} // namespace
+
 Variable operator+(const Variable& lhs, const Variable& rhs) {
   FL_VARIABLE_DTYPES_MATCH_CHECK(lhs, rhs);
   auto result = lhs.tensor() + rhs.tensor();
@@ -122,6 +140,15 @@ Variable operator+(const Variable& lhs, const Variable& rhs) {
   return Variable(result, {lhs.withoutData(), rhs.withoutData()}, gradFunc);
 }
 
+Variable operator+(Variable&& lhs, const Variable& rhs) {
+  if (!isInferenceMode()) {
+    return std::as_const(lhs) + rhs;
+  }
+  FL_VARIABLE_DTYPES_MATCH_CHECK(lhs, rhs);
+  auto result = lhs.tensor() + rhs.tensor();
+  return inferenceResult(std::move(lhs), std::move(result));
+}
+
 Variable operator+(const Variable& lhs, const double& rhsVal) {
   auto result = (lhs.tensor() + rhsVal).astype(lhs.type());
   auto gradFunc = [](std::vector<Variable>& inputs,
@@ -1262,15 +1289,14 @@ Variable linear(const Variable& in, const Variable& wt, const Variable& bs) {
   auto to4d = input.shape();
   to4d[0] = weight.tensor().dim(0);
 
-  auto output =
-      reshape(fl::matmul(weight.tensor(), reshape(input.tensor(), to2d)), to4d);
-
+  // the bias is added as part of the matmul, which backends may fuse
   auto hasBias = bias.elements() > 0;
-  if (hasBias) {
-    auto tiledims = output.shape();
-    tiledims[0] = 1;
-    output = output + tile(bias.tensor(), tiledims);
-  }
+  auto output = reshape(
+      fl::fusedMatmul(
+          weight.tensor(),
+          reshape(input.tensor(), to2d),
+          hasBias ? fl::reshape(bias.tensor(), {bias.elements()}) : Tensor()),
+      to4d);
 
   auto gradFunc = [hasBias](
                       std::vector<Variable>& inputs,
@@ -1704,7 +1730,192 @@ std::tuple<Variable, Variable, Variable> rnn(
   return std::make_tuple(yv, hyv, cyv);
 }
 
-Variable embedding(const Variable& input, const Variable& embeddings) {
+namespace {
+
+// Rows [begin, end) of a batch along dim 1
+Variable batchRange(const Variable& x, Dim begin, Dim end) {
+  return x(fl::span, fl::range(begin, end), fl::span);
+}
+
+// Appends zeros to x along `dim` up to `size`
+Variable padWithZeros(const Variable& x, int dim, Dim size) {
+  if (x.dim(dim) == size) {
+    return x;
+  }
+  auto padShape = x.shape();
+  padShape[dim] = size - x.dim(dim);
+  Variable zeros(fl::full(padShape, 0.0, x.type()), false);
+  return x.dim(dim) == 0 ? zeros : concatenate({x, zeros}, dim);
+}
+
+} // namespace
+
+std::tuple<Variable, Variable, Variable> rnn(
+    const Variable& input,
+    const Variable& hiddenState,
+    const Variable& cellState,
+    const Variable& weights,
+    int hiddenSize,
+    int numLayers,
+    RnnMode mode,
+    bool bidirectional,
+    float dropProb,
+    const Tensor& lengths) {
+  const Dim batchSize = input.dim(1);
+  const Dim seqLength = input.ndim() > 2 ? input.dim(2) : 1;
+  if (lengths.elements() != batchSize) {
+    throw std::invalid_argument(
+        "rnn: expected one length per batch element, got " +
+        std::to_string(lengths.elements()) + " lengths for a batch of " +
+        std::to_string(batchSize));
+  }
+  auto hostLengths = lengths.astype(fl::dtype::s64).toHostVector<int64_t>();
+  for (auto length : hostLengths) {
+    if (length < 0 || length > seqLength) {
+      throw std::invalid_argument(
+          "rnn: sequence length " + std::to_string(length) +
+          " is not within [0, " + std::to_string(seqLength) + "]");
+    }
+  }
+  if (std::all_of(hostLengths.begin(), hostLengths.end(), [&](int64_t l) {
+        return l == seqLength;
+      })) {
+    return rnn(
+        input,
+        hiddenState,
+        cellState,
+        weights,
+        hiddenSize,
+        numLayers,
+        mode,
+        bidirectional,
+        dropProb);
+  }
+
+  // Sort the batch by decreasing length, so that the sequences still running
+  // at any step are a prefix of the batch
+  std::vector<int> order(batchSize);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return hostLengths[a] > hostLengths[b];
+  });
+  std::vector<int> inverseOrder(batchSize);
+  std::vector<int64_t> sortedLengths(batchSize);
+  for (int i = 0; i < batchSize; ++i) {
+    inverseOrder[order[i]] = i;
+    sortedLengths[i] = hostLengths[order[i]];
+  }
+  auto sortIdx = Tensor::fromVector(order);
+  auto unsortIdx = Tensor::fromVector(inverseOrder);
+
+  const int directions = bidirectional ? 2 : 1;
+  const Dim outputSize = hiddenSize * directions;
+  const bool hasCellState = mode == RnnMode::LSTM;
+  const Shape stateShape({hiddenSize, batchSize, numLayers * directions});
+  auto sortedState = [&](const Variable& state) {
+    return state.isEmpty()
+        ? Variable(fl::full(stateShape, 0.0, input.type()), false)
+        : state(fl::span, sortIdx, fl::span);
+  };
+  auto x = input(fl::span, sortIdx, fl::span);
+  auto h = sortedState(hiddenState);
+  auto c = hasCellState ? sortedState(cellState) : Variable();
+
+  std::vector<Variable> outputs;
+  if (!bidirectional) {
+    // Run the recurrence over segments of steps [start, end) in which the
+    // same sequences are running; the states of the others are kept as is.
+    for (Dim start = 0, end = 0; start < sortedLengths[0]; start = end) {
+      const Dim running = std::lower_bound(
+                              sortedLengths.begin(),
+                              sortedLengths.end(),
+                              start,
+                              std::greater<int64_t>()) -
+          sortedLengths.begin();
+      end = sortedLengths[running - 1];
+      auto [y, hy, cy] =
+          rnn(x(fl::span, fl::range(0, running), fl::range(start, end)),
+              batchRange(h, 0, running),
+              hasCellState ? batchRange(c, 0, running) : Variable(),
+              weights,
+              hiddenSize,
+              numLayers,
+              mode,
+              bidirectional,
+              dropProb);
+      outputs.push_back(padWithZeros(y, 1, batchSize));
+      if (running < batchSize) {
+        h = concatenate({hy, batchRange(h, running, batchSize)}, 1);
+        if (hasCellState) {
+          c = concatenate({cy, batchRange(c, running, batchSize)}, 1);
+        }
+      } else {
+        h = hy;
+        c = cy;
+      }
+    }
+  } else {
+    // The reverse direction starts at the end of each sequence: run the
+    // sequences of each length together, over exactly that length.
+    std::vector<Variable> ys, hs, cs;
+    for (Dim begin = 0, end = 0; begin < batchSize; begin = end) {
+      end = begin + 1;
+      while (end < batchSize && sortedLengths[end] == sortedLengths[begin]) {
+        ++end;
+      }
+      const Dim length = sortedLengths[begin];
+      if (length == 0) {
+        ys.push_back(Variable(
+            fl::full({outputSize, batchSize - begin, seqLength}, 0.0, x.type()),
+            false));
+        hs.push_back(batchRange(h, begin, batchSize));
+        if (hasCellState) {
+          cs.push_back(batchRange(c, begin, batchSize));
+        }
+        break;
+      }
+      auto [y, hy, cy] =
+          rnn(x(fl::span, fl::range(begin, end), fl::range(0, length)),
+              batchRange(h, begin, end),
+              hasCellState ? batchRange(c, begin, end) : Variable(),
+              weights,
+              hiddenSize,
+              numLayers,
+              mode,
+              bidirectional,
+              dropProb);
+      ys.push_back(padWithZeros(y, 2, seqLength));
+      hs.push_back(hy);
+      if (hasCellState) {
+        cs.push_back(cy);
+      }
+    }
+    outputs.push_back(ys.size() == 1 ? ys[0] : concatenate(ys, 1));
+    h = hs.size() == 1 ? hs[0] : concatenate(hs, 1);
+    if (hasCellState) {
+      c = cs.size() == 1 ? cs[0] : concatenate(cs, 1);
+    }
+  }
+
+  Variable output;
+  if (outputs.empty()) {
+    // all the sequences are empty
+    output = Variable(
+        fl::full({outputSize, batchSize, seqLength}, 0.0, x.type()), false);
+  } else {
+    output = outputs.size() == 1 ? outputs[0] : concatenate(outputs, 2);
+    output = padWithZeros(output, 2, seqLength);
+  }
+  return std::make_tuple(
+      output(fl::span, unsortIdx, fl::span),
+      h(fl::span, unsortIdx, fl::span),
+      hasCellState ? c(fl::span, unsortIdx, fl::span) : Variable());
+}
+
+Variable embedding(
+    const Variable& input,
+    const Variable& embeddings,
+    bool sparseGrad /* = false */) {
   // TODO{fl::Tensor}{4-dims} - relax this
   if (input.ndim() >= 4) {
     throw std::invalid_argument("embedding input must have 3 or fewer dims");
@@ -1720,8 +1931,9 @@ Variable embedding(const Variable& input, const Variable& embeddings) {
   Shape resultDims(rDims);
   Tensor result = fl::reshape(embeddings.tensor()(fl::span, idxs), resultDims);
 
-  auto gradFunc = [](std::vector<Variable>& inputs,
-                     const Variable& gradOutput) {
+  auto gradFunc = [sparseGrad](
+                      std::vector<Variable>& inputs,
+                      const Variable& gradOutput) {
     auto& w = inputs[1];
     if (!w.isCalcGrad()) {
       return;
@@ -1731,6 +1943,12 @@ Variable embedding(const Variable& input, const Variable& embeddings) {
     unsigned size = ip.elements();
     auto deltas = fl::reshape(gradOutput.tensor(), {w.dim(0), size});
 
+    if (sparseGrad) {
+      // Duplicated indices are summed when the gradient is coalesced
+      w.addSparseGrad(SparseGrad(ip, deltas, /* dim = */ 1, w.shape()));
+      return;
+    }
+
     // Sparse Tensor
     auto sp = Tensor(
         ip.elements(),
@@ -1784,10 +2002,31 @@ Variable dropout(const Variable& input, double p) {
   }
 }
 
+Variable dropout(Variable&& input, double p) {
+  if (p <= 0.0) {
+    return std::move(input);
+  }
+  if (!isInferenceMode()) {
+    return dropout(std::as_const(input), p);
+  }
+  const auto& data = input.tensor();
+  auto mask = (fl::rand(data.shape(), data.type()) > p).astype(data.type());
+  auto result = (1.0 / (1.0 - p) * mask * data).astype(data.type());
+  return inferenceResult(std::move(input), std::move(result));
+}
+
 Variable relu(const Variable& input) {
   return max(input, 0.0);
 }
 
+Variable relu(Variable&& input) {
+  if (!isInferenceMode()) {
+    return relu(std::as_const(input));
+  }
+  auto result = fl::maximum(input.tensor(), 0.0).astype(input.type());
+  return inferenceResult(std::move(input), std::move(result));
+}
+
 Variable gelu(const Variable& in) {
   auto input = FL_ADJUST_INPUT_TYPE(in);
   return 0.5 * input *
@@ -1795,6 +2034,17 @@ Variable gelu(const Variable& in) {
        fl::tanh(0.7978845608 * (input + 0.044715 * input * input * input)));
 }
 
+Variable gelu(Variable&& input) {
+  if (!isInferenceMode()) {
+    return gelu(std::as_const(input));
+  }
+  auto x = FL_ADJUST_INPUT_TYPE(input.tensor());
+  auto result =
+      (0.5 * x * (1.0 + fl::tanh(0.7978845608 * (x + 0.044715 * x * x * x))))
+          .astype(x.type());
+  return inferenceResult(std::move(input), std::move(result));
+}
+
 fl::Variable relativePositionEmbeddingRotate(const fl::Variable& input) {
   if (input.ndim() != 3) {
     throw std::invalid_argument(
@@ -1825,6 +2075,50 @@ fl::Variable relativePositionEmbeddingRotate(const fl::Variable& input) {
   return fl::Variable(data, {input}, gradFunc);
 }
 
+namespace {
+
+// alpha * matmulNT(lhs, rhs) + bias, with the bias broadcast as per
+// fl::fusedMatmul, computed as a single op by backends fusing it.
+Variable scaledMatmulNT(
+    const Variable& lhs,
+    const Variable& rhs,
+    const double alpha,
+    const Variable& bias) {
+  auto result = fl::fusedMatmul(
+      lhs.tensor(),
+      rhs.tensor(),
+      bias.tensor(),
+      /* lhsProp = */ MatrixProperty::None,
+      /* rhsProp = */ MatrixProperty::Transpose,
+      alpha);
+  auto gradFunc = [alpha](
+                      std::vector<Variable>& inputs,
+                      const Variable& gradOutput) {
+    if (inputs[0].isCalcGrad()) {
+      auto val = fl::matmul(gradOutput.tensor(), inputs[1].tensor()) * alpha;
+      inputs[0].addGrad(Variable(detail::sumAs(val, inputs[0].shape()), false));
+    }
+    if (inputs[1].isCalcGrad()) {
+      auto val = fl::matmul(
+                     gradOutput.tensor(),
+                     inputs[0].tensor(),
+                     /* lhsProp = */ MatrixProperty::Transpose) *
+          alpha;
+      inputs[1].addGrad(Variable(detail::sumAs(val, inputs[1].shape()), false));
+    }
+    if (inputs.size() > 2 && inputs[2].isCalcGrad()) {
+      inputs[2].addGrad(Variable(
+          detail::sumAs(gradOutput.tensor(), inputs[2].shape()), false));
+    }
+  };
+  if (bias.isEmpty()) {
+    return Variable(result, {lhs, rhs}, gradFunc);
+  }
+  return Variable(result, {lhs, rhs, bias}, gradFunc);
+}
+
+} // namespace
+
 fl::Variable multiheadAttention(
     const fl::Variable& query,
     const fl::Variable& key,
@@ -1859,17 +2153,25 @@ fl::Variable multiheadAttention(
   auto k = moddims(key, {-1, headDim, nHeads * bsz});
   auto v = moddims(value, {-1, headDim, nHeads * bsz});
 
-  q = q / std::sqrt(float(headDim));
-  auto scores = matmulNT(q, k);
-  if (!posEmb.isEmpty()) {
+  Variable scores;
+  if (posEmb.isEmpty()) {
+    // scale and mask the scores as part of the matmul
+    scores = scaledMatmulNT(
+        q,
+        k,
+        1.0 / std::sqrt(float(headDim)),
+        mask.isEmpty() ? Variable() : mask.astype(q.type()));
+  } else {
+    q = q / std::sqrt(float(headDim));
+    scores = matmulNT(q, k);
     int n = posEmb.dim(0) / 2 - offset;
     auto pscores =
         relativePositionEmbeddingRotate(matmulNT(posEmb.astype(q.type()), q));
     scores =
         scores + transpose(pscores(fl::range(n, n + k.dim(0))), {1, 0, 2});
-  }
-  if (!mask.isEmpty()) {
-    scores = scores + tileAs(mask.astype(scores.type()), scores);
+    if (!mask.isEmpty()) {
+      scores = scores + tileAs(mask.astype(scores.type()), scores);
+    }
   }
   if (!padMask.isEmpty()) {
     if (padMask.dim(0) != query.dim(0)) {
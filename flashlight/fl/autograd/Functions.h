@@ -67,11 +67,11 @@ T adjustInputType(const T& in, const char* funcname) {
   // TODO: tiny, but this lookup incurs an extra alloc from char* to string
   if (funcs.find(std::string(funcname)) == funcs.end() &&
       optimLevel != OptimLevel::DEFAULT) {
-    // Not in the excluded list - cast to f16
-    res = in.astype(fl::dtype::f16);
+    // Not in the excluded list - cast to f16 (or bf16)
+    res = in.astype(optimLevelHalfPrecisionType(optimLevel));
   } else {
-    // Upcast to f32 only if we have an f16 input - otherwise, leave as is
-    if (in.type() == fl::dtype::f16) {
+    // Upcast to f32 only if we have an f16/bf16 input - otherwise, leave as is
+    if (isHalfPrecisionType(in.type())) {
       res = in.astype(fl::dtype::f32);
     } else {
       res = in;
@@ -118,6 +118,14 @@ std::shared_ptr<AutogradPayload> createAutogradPayload(H head, T... tail) {
  */
 Variable operator+(const Variable& lhs, const Variable& rhs);
 
+/**
+ * Element-wise addition of two Variables. In inference mode, `lhs` holds the
+ * result if it is reusable (see `Variable::isReusable()`), rather than a new
+ * Variable.
+ * \f[ out = var_1 + var_2 \f]
+ */
+Variable operator+(Variable&& lhs, const Variable& rhs);
+
 /**
  * Adds a scalar to each element in the Variable.
  * \f[ out_i = value + var_i \f]
@@ -889,6 +897,45 @@ std::tuple<Variable, Variable, Variable> rnn(
     bool bidirectional,
     float dropout);
 
+/**
+ * Applies an RNN unit to a batch of padded sequences of different lengths.
+ * The recurrence only runs over the valid steps of each sequence, so no
+ * compute is spent on padding: the batch is sorted by length, and the RNN is
+ * run over segments of steps in which the same sequences are running
+ * (unidirectional RNNs) or over the sequences of each length (bidirectional
+ * RNNs, whose reverse direction starts at the end of each sequence).
+ *
+ * Bidirectional RNNs thus take one call per distinct non-zero length: with
+ * many distinct lengths in a batch, bucketing the batches by length keeps
+ * these calls few.
+ *
+ * The lengths can be in any order. If they are all the sequence length, this
+ * is the same as the RNN above.
+ *
+ * @param lengths Tensor of the number of valid steps of each sequence, with
+ * shape [batch size]; steps past them are padding
+ *
+ * Other parameters are the same as above.
+ *
+ * @return a tuple of three Variables:
+ * - `y`: output with zeros at the padded steps of each sequence
+ * - `hiddenState`: hidden state at the last valid step of each sequence (the
+ * input hidden state for empty sequences)
+ * - `cellState`: [LSTM only] cell state at the last valid step of each
+ * sequence
+ */
+std::tuple<Variable, Variable, Variable> rnn(
+    const Variable& input,
+    const Variable& hiddenState,
+    const Variable& cellState,
+    const Variable& weights,
+    int hiddenSize,
+    int numLayers,
+    RnnMode mode,
+    bool bidirectional,
+    float dropout,
+    const Tensor& lengths);
+
 /**
  * Looks up embeddings in a fixed dictionary and size.
  * @param input a Variable of a list of indices with shape [\f$B_1\f$,
@@ -896,10 +943,16 @@ std::tuple<Variable, Variable, Variable> rnn(
  * @param embeddings a Variable of an embedding matrix with shape [\f$D\f$,
  * \f$N\f$], where \f$N\f$ is the number of items and \f$D\f$ is the embedding
  * size.
+ * @param sparseGrad if true, the gradient of `embeddings` is a row-sparse
+ * gradient holding only the looked up rows (see `Variable::addSparseGrad`)
+ * instead of a dense \f$[D, N]\f$ one.
  * @return a Variable of embeddings with shape [\f$D\f$, \f$B_1\f$, \f$B_2\f$,
  * \f$B_3\f$]
  */
-Variable embedding(const Variable& input, const Variable& embeddings);
+Variable embedding(
+    const Variable& input,
+    const Variable& embeddings,
+    bool sparseGrad = false);
 
 /**
  * Applies Batch Normalization over a 4D input (a mini-batch of 2D inputs with
@@ -961,6 +1014,16 @@ Variable padding(
  */
 Variable dropout(const Variable& input, double p);
 
+/**
+ * Applies dropout on a Variable `input`. In inference mode, `input` holds the
+ * result if it is reusable (see `Variable::isReusable()`), rather than a new
+ * Variable.
+ * @param input input Variable
+ * @param p the probability of dropout
+ * @return a droped out Variable
+ */
+Variable dropout(Variable&& input, double p);
+
 /**
  * Applies the [rectified linear
  * unit](https://en.wikipedia.org/wiki/Rectifier_(neural_networks)) function
@@ -969,6 +1032,14 @@ Variable dropout(const Variable& input, double p);
  */
 Variable relu(const Variable& input);
 
+/**
+ * Applies the [rectified linear
+ * unit](https://en.wikipedia.org/wiki/Rectifier_(neural_networks)) function
+ * element-wise to a `Variable`. In inference mode, `input` holds the result
+ * if it is reusable (see `Variable::isReusable()`), rather than a new Variable.
+ */
+Variable relu(Variable&& input);
+
 /**
  * Applies the [Gaussian Error linear
  * Unit](https://arxiv.org/abs/1606.08415) function
@@ -976,6 +1047,14 @@ Variable relu(const Variable& input);
  */
 Variable gelu(const Variable& input);
 
+/**
+ * Applies the [Gaussian Error linear
+ * Unit](https://arxiv.org/abs/1606.08415) function
+ * element-wise to a `Variable`. In inference mode, `input` holds the result
+ * if it is reusable (see `Variable::isReusable()`), rather than a new Variable.
+ */
+Variable gelu(Variable&& input);
+
 /**
  * Relative positional embedding for the multihead attention
  * Implementation partially follows https://arxiv.org/pdf/1803.02155.pdf
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/autograd/SparseGrad.h"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace fl {
+
+SparseGrad::SparseGrad(Tensor indices, Tensor values, int dim, Shape shape)
+    : indices_(std::move(indices)),
+      values_(std::move(values)),
+      dim_(dim),
+      shape_(std::move(shape)) {
+  if (shape_.ndim() != 2 || (dim_ != 0 && dim_ != 1)) {
+    throw std::invalid_argument(
+        "SparseGrad: only rows of 2D Variables are supported");
+  }
+  if (indices_.ndim() > 1 || values_.ndim() > 2 ||
+      values_.dim(dim_) != indices_.elements() ||
+      values_.dim(1 - dim_) != shape_[1 - dim_]) {
+    std::stringstream ss;
+    ss << "SparseGrad: values of shape " << values_.shape()
+       << " don't match indices of shape " << indices_.shape()
+       << " and gradient of shape " << shape_;
+    throw std::invalid_argument(ss.str());
+  }
+  if (indices_.type() != fl::dtype::s32) {
+    indices_ = indices_.astype(fl::dtype::s32);
+  }
+}
+
+void SparseGrad::add(const SparseGrad& other) {
+  if (other.dim_ != dim_ || other.shape_ != shape_ ||
+      other.type() != type()) {
+    throw std::invalid_argument(
+        "SparseGrad::add: gradients of different Variables");
+  }
+  indices_ = fl::concatenate(0, indices_, other.indices_);
+  values_ = fl::concatenate(dim_, values_, other.values_);
+  coalesced_ = false;
+}
+
+void SparseGrad::coalesce() {
+  if (coalesced_) {
+    return;
+  }
+  auto indices = indices_.toHostVector<int>();
+  const int nRows = indices.size();
+  std::vector<int> order(nRows);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&indices](int a, int b) {
+    return indices[a] < indices[b];
+  });
+  // slot of each row in the coalesced gradient
+  std::vector<int> slots(nRows);
+  std::vector<int> uniqueIndices;
+  for (int i : order) {
+    if (uniqueIndices.empty() || uniqueIndices.back() != indices[i]) {
+      uniqueIndices.push_back(indices[i]);
+    }
+    slots[i] = uniqueIndices.size() - 1;
+  }
+  if (uniqueIndices.size() < nRows) {
+    // [nRows, nUnique] matrix with a one at (i, slots[i])
+    const int nUnique = uniqueIndices.size();
+    auto scatter = Tensor(
+        nRows,
+        nUnique,
+        fl::full({nRows}, 1, values_.type()),
+        fl::arange({nRows + 1}, 0, fl::dtype::s32),
+        Tensor::fromVector(slots),
+        fl::StorageType::CSR);
+    if (dim_ == 0) {
+      values_ = fl::matmul(
+          scatter, values_, /* lhsProp = */ MatrixProperty::Transpose);
+    } else {
+      values_ = fl::transpose(fl::matmul(
+          scatter,
+          fl::transpose(values_),
+          /* lhsProp = */ MatrixProperty::Transpose));
+    }
+    indices_ = Tensor::fromVector(uniqueIndices);
+  }
+  coalesced_ = true;
+}
+
+std::vector<Index> SparseGrad::rowIndex() const {
+  std::vector<Index> index = {fl::span, fl::span};
+  index[dim_] = indices_;
+  return index;
+}
+
+Tensor SparseGrad::toDense() {
+  coalesce();
+  auto dense = fl::full(shape_, 0, type());
+  if (indices_.elements() > 0) {
+    dense(rowIndex()) = values_;
+  }
+  return dense;
+}
+
+} // namespace fl
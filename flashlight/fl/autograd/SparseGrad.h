@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/fl/tensor/TensorBase.h"
+
+namespace fl {
+
+/**
+ * A row-sparse gradient of a 2D Variable, e.g. an embedding table of which a
+ * batch only looks up a few rows. The gradient is zero everywhere except on
+ * the rows listed in `indices`; a row is a slice along dimension `dim` of the
+ * dense gradient (`dim` 1 for a \f$[D, N]\f$ table, whose rows are
+ * `grad(fl::span, i)`).
+ *
+ * `values` has the shape of the dense gradient with `indices.elements()` rows.
+ * An index may be listed several times (the gradient is the sum of its rows)
+ * until the gradient is coalesced.
+ */
+class SparseGrad {
+ public:
+  /**
+   * @param[in] indices 1D tensor of row indices
+   * @param[in] values the rows of the gradient
+   * @param[in] dim the dimension of the rows
+   * @param[in] shape the shape of the dense gradient
+   */
+  SparseGrad(Tensor indices, Tensor values, int dim, Shape shape);
+
+  const Tensor& indices() const {
+    return indices_;
+  }
+
+  Tensor& values() {
+    return values_;
+  }
+
+  const Tensor& values() const {
+    return values_;
+  }
+
+  int dim() const {
+    return dim_;
+  }
+
+  const Shape& shape() const {
+    return shape_;
+  }
+
+  fl::dtype type() const {
+    return values_.type();
+  }
+
+  /**
+   * Appends the rows of another gradient of the same Variable.
+   */
+  void add(const SparseGrad& other);
+
+  /**
+   * Sums the rows with the same index so that every index is listed once.
+   * Indices are gathered on the host, and rows are summed with a sparse matrix
+   * product of the size of the batch rather than of the Variable.
+   */
+  void coalesce();
+
+  bool isCoalesced() const {
+    return coalesced_;
+  }
+
+  /**
+   * The index of the rows in the dense Variable, e.g. to update them with
+   * `param.tensor()(sparseGrad.rowIndex())`. Requires a coalesced gradient
+   * for assignments.
+   */
+  std::vector<Index> rowIndex() const;
+
+  /**
+   * Returns the dense gradient.
+   */
+  Tensor toDense();
+
+ private:
+  Tensor indices_;
+  Tensor values_;
+  int dim_;
+  Shape shape_;
+  bool coalesced_{false};
+};
+
+} // namespace fl
@@ -9,19 +9,91 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
 #include "flashlight/fl/autograd/Functions.h"
 #include "flashlight/fl/common/Utils.h"
 #include "flashlight/fl/tensor/Compute.h"
 #include "flashlight/fl/tensor/Index.h"
+#include "flashlight/fl/tensor/OpProfiler.h"
 #include "flashlight/fl/tensor/Shape.h"
 
 namespace fl {
+namespace {
+
+thread_local bool inferenceMode = false;
+
+// The name of the function creating a gradient function, e.g. "matmul" for
+// the lambda defined in fl::matmul, to name backward events when profiling
+const std::string& gradFuncName(const std::type_info& type) {
+  static std::mutex mutex;
+  static std::unordered_map<std::type_index, std::string> names;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = names.find(type);
+  if (it != names.end()) {
+    return it->second;
+  }
+
+  std::string name = type.name();
+#if defined(__GNUG__)
+  int status = 0;
+  char* demangled =
+      abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+  if (status == 0 && demangled) {
+    name = demangled;
+  }
+  std::free(demangled);
+#endif
+  // "fl::matmul(fl::Variable const&, ...)::{lambda(...)#1}" -> "fl::matmul"
+  const auto lambda = name.find("::{lambda");
+  if (lambda != std::string::npos) {
+    name.resize(lambda);
+    if (!name.empty() && name.back() == ')') {
+      int depth = 0;
+      size_t i = name.size();
+      while (i > 0) {
+        --i;
+        depth += name[i] == ')' ? 1 : name[i] == '(' ? -1 : 0;
+        if (depth == 0) {
+          break;
+        }
+      }
+      name.resize(i);
+    }
+  }
+  if (name.rfind("fl::", 0) == 0) {
+    name = name.substr(4);
+  }
+  return names.emplace(type, std::move(name)).first->second;
+}
+
+} // namespace
+
+InferenceModeGuard::InferenceModeGuard() : previous_(inferenceMode) {
+  inferenceMode = true;
+}
+
+InferenceModeGuard::~InferenceModeGuard() {
+  inferenceMode = previous_;
+}
+
+bool isInferenceMode() {
+  return inferenceMode;
+}
 
 Variable::Variable(Tensor data, bool calcGrad) {
   sharedData_->data = std::move(data);
@@ -33,6 +105,9 @@ Variable::Variable(
     std::vector<Variable> inputs,
     GradFunc gradFunc) {
   sharedData_->data = std::move(data);
+  if (inferenceMode) {
+    return;
+  }
   if (std::any_of(inputs.begin(), inputs.end(), [](const Variable& input) {
         return input.isCalcGrad();
       })) {
@@ -85,6 +160,10 @@ Tensor& Variable::tensor() const {
 }
 
 Variable Variable::astype(fl::dtype newType) const {
+  // No copy, so that the data of e.g. parameters keep their identity
+  if (type() == newType) {
+    return *this;
+  }
   auto output = tensor().astype(newType);
   auto gradFunc = [](std::vector<Variable>& inputs,
                      const Variable& gradOutput) {
@@ -100,6 +179,12 @@ Variable& Variable::grad() const {
     throw std::logic_error("gradient calculation disabled for this Variable");
   }
 
+  if (sharedGrad_->sparseGrad) {
+    sharedGrad_->grad = std::make_unique<Variable>(
+        sharedGrad_->sparseGrad->toDense(), false);
+    sharedGrad_->sparseGrad.reset();
+  }
+
   if (!sharedGrad_->grad) {
     throw std::logic_error("gradient not calculated yet for this Variable");
   }
@@ -107,6 +192,14 @@ Variable& Variable::grad() const {
   return *sharedGrad_->grad;
 }
 
+SparseGrad& Variable::sparseGrad() const {
+  if (!isSparseGrad()) {
+    throw std::logic_error("no row-sparse gradient for this Variable");
+  }
+  sharedGrad_->sparseGrad->coalesce();
+  return *sharedGrad_->sparseGrad;
+}
+
 std::vector<Variable>& Variable::getInputs() const {
   return sharedGrad_->inputs;
 }
@@ -119,7 +212,11 @@ bool Variable::isGradAvailable() const {
   if (!sharedGrad_->calcGrad) {
     return false;
   }
-  return sharedGrad_->grad != nullptr;
+  return sharedGrad_->grad != nullptr || sharedGrad_->sparseGrad != nullptr;
+}
+
+bool Variable::isSparseGrad() const {
+  return sharedGrad_->calcGrad && sharedGrad_->sparseGrad != nullptr;
 }
 
 Shape Variable::shape() const {
@@ -167,6 +264,7 @@ void Variable::eval() const {
 
 void Variable::zeroGrad() {
   sharedGrad_->grad.reset();
+  sharedGrad_->sparseGrad.reset();
 }
 
 void Variable::setCalcGrad(bool calcGrad) {
@@ -175,30 +273,39 @@ void Variable::setCalcGrad(bool calcGrad) {
     sharedGrad_->gradFunc = nullptr;
     sharedGrad_->inputs.clear();
     sharedGrad_->grad.reset();
+    sharedGrad_->sparseGrad.reset();
+  }
+}
+
+void Variable::checkGrad(fl::dtype type, const Shape& shape) const {
+  // Ensure the type of the child grad is the same as the type of this
+  // Variable (and transitively, that it's the same type as an existing grad)
+  if (type != this->type()) {
+    std::stringstream ss;
+    ss << "Variable::addGrad: attempted to add child gradient of type " << type
+       << " to a Variable of type " << this->type()
+       << ". You might be performing an operation with "
+          "two inputs of different types.";
+    throw std::invalid_argument(ss.str());
+  }
+  if (shape != this->shape()) {
+    std::stringstream ss;
+    ss << "Variable::addGrad: given gradient has dimensions not equal "
+          "to this Variable's dimensions: this variable has shape "
+       << this->shape() << " whereas the child gradient has dimensions "
+       << shape << std::endl;
+    throw std::invalid_argument(ss.str());
   }
 }
 
 void Variable::addGrad(const Variable& childGrad) {
   if (sharedGrad_->calcGrad) {
-    // Ensure the type of the child grad is the same as the type of this
-    // Variable (and transitively, that it's the same type as an existing grad)
-    if (childGrad.type() != this->type()) {
-      std::stringstream ss;
-      ss << "Variable::addGrad: attempted to add child gradient of type "
-         << childGrad.type() << " to a Variable of type " << this->type()
-         << ". You might be performing an operation with "
-            "two inputs of different types.";
-      throw std::invalid_argument(ss.str());
-    }
-    if (childGrad.shape() != this->shape()) {
-      std::stringstream ss;
-      ss << "Variable::addGrad: given gradient has dimensions not equal "
-            "to this Variable's dimensions: this variable has shape "
-         << this->shape() << " whereas the child gradient has dimensions "
-         << childGrad.shape() << std::endl;
-      throw std::invalid_argument(ss.str());
-    }
-    if (sharedGrad_->grad) {
+    checkGrad(childGrad.type(), childGrad.shape());
+    if (sharedGrad_->sparseGrad) {
+      sharedGrad_->grad = std::make_unique<Variable>(
+          sharedGrad_->sparseGrad->toDense() + childGrad.tensor(), false);
+      sharedGrad_->sparseGrad.reset();
+    } else if (sharedGrad_->grad) {
       // Prevent increment of array refcount to avoid a copy
       // if getting a device pointer. See
       // https://git.io/fp9oM for more
@@ -213,28 +320,57 @@ void Variable::addGrad(const Variable& childGrad) {
   }
 }
 
+void Variable::addSparseGrad(const SparseGrad& childGrad) {
+  if (sharedGrad_->calcGrad) {
+    checkGrad(childGrad.type(), childGrad.shape());
+    if (sharedGrad_->grad) {
+      SparseGrad sparse = childGrad;
+      sharedGrad_->grad = std::make_unique<Variable>(
+          sharedGrad_->grad->tensor() + sparse.toDense(), false);
+    } else if (sharedGrad_->sparseGrad) {
+      sharedGrad_->sparseGrad->add(childGrad);
+    } else {
+      sharedGrad_->sparseGrad = std::make_unique<SparseGrad>(childGrad);
+    }
+  }
+}
+
 void Variable::registerGradHook(const GradHook& hook) {
   sharedGrad_->onGradAvailable = hook;
 }
 
+void Variable::registerSparseGradHook(const SparseGradHook& hook) {
+  sharedGrad_->onSparseGradAvailable = hook;
+}
+
 void Variable::clearGradHook() {
   sharedGrad_->onGradAvailable = nullptr;
+  sharedGrad_->onSparseGradAvailable = nullptr;
 }
 
 void Variable::applyGradHook() {
-  if (sharedGrad_->onGradAvailable) {
-    assert(sharedGrad_->grad);
-    sharedGrad_->onGradAvailable(*sharedGrad_->grad);
+  if (sharedGrad_->sparseGrad && sharedGrad_->onSparseGradAvailable) {
+    sharedGrad_->onSparseGradAvailable(*this);
+  } else if (sharedGrad_->onGradAvailable) {
+    assert(isGradAvailable());
+    sharedGrad_->onGradAvailable(grad());
   }
 }
 
 void Variable::calcGradInputs(bool retainGraph) {
   if (sharedGrad_->gradFunc) {
-    if (!sharedGrad_->grad) {
+    if (!isGradAvailable()) {
       throw std::logic_error("gradient was not propagated to this Variable");
     }
 
-    sharedGrad_->gradFunc(sharedGrad_->inputs, *sharedGrad_->grad);
+    std::optional<detail::OpProfileScope> profile;
+    if (OpProfiler::isEnabled()) {
+      profile.emplace(
+          gradFuncName(sharedGrad_->gradFunc.target_type()).c_str(),
+          std::initializer_list<const Tensor*>{&grad().tensor()},
+          "backward");
+    }
+    sharedGrad_->gradFunc(sharedGrad_->inputs, grad());
   }
   if (!retainGraph) {
     sharedGrad_->inputs.clear();
@@ -259,6 +395,9 @@ void Variable::backward(bool retainGraph) {
 }
 
 Variable Variable::withoutData() const {
+  if (inferenceMode) {
+    return *this;
+  }
   Variable other;
   other.sharedGrad_ = sharedGrad_;
   // Ensure the type of the underlying [but empty] Tensor data is of the same
@@ -267,6 +406,11 @@ Variable Variable::withoutData() const {
   return other;
 }
 
+bool Variable::isReusable() const {
+  return inferenceMode && !sharedGrad_->calcGrad &&
+      sharedData_.use_count() == 1;
+}
+
 Variable::DAG Variable::build() const {
   std::unordered_set<SharedGrad*> cache;
   DAG dag;
@@ -12,6 +12,7 @@
 #include <memory>
 #include <vector>
 
+#include "flashlight/fl/autograd/SparseGrad.h"
 #include "flashlight/fl/common/Defines.h"
 #include "flashlight/fl/common/Serialization.h"
 #include "flashlight/fl/tensor/TensorBase.h"
@@ -66,6 +67,8 @@ class Variable {
 
   using GradHook = std::function<void(Variable& grad)>;
 
+  using SparseGradHook = std::function<void(Variable& var)>;
+
   /**
    * Creates an empty Variable. The underlying array is empty and
    * isCalcGrad() is false.
@@ -116,7 +119,8 @@ class Variable {
 
   /**
    * Creates a new variable based on the current variable whose type will be
-   * adjusted based on the input type.
+   * adjusted based on the input type. If the variable already has that type,
+   * it is returned as is, sharing its data and gradient.
    *
    * @param[in] type target data type
    *
@@ -125,7 +129,8 @@ class Variable {
   Variable astype(fl::dtype type) const;
 
   /**
-   * @return a reference to the underlying gradient Variable.
+   * @return a reference to the underlying gradient Variable. A row-sparse
+   * gradient is converted to a dense one.
    */
   Variable& grad() const;
 
@@ -139,6 +144,18 @@ class Variable {
    */
   bool isGradAvailable() const;
 
+  /**
+   * Returns whether the gradient is only available as a row-sparse gradient,
+   * see `addSparseGrad()`.
+   */
+  bool isSparseGrad() const;
+
+  /**
+   * @return a reference to the row-sparse gradient, coalesced. Throws if the
+   * gradient isn't sparse.
+   */
+  SparseGrad& sparseGrad() const;
+
   /**
    * Returns the dimension of the array wrapped by the Variable
    */
@@ -237,6 +254,15 @@ class Variable {
    */
   void addGrad(const Variable& childGrad);
 
+  /**
+   * Add a row-sparse gradient `childGrad` to the Variable (e.g. the gradient
+   * of an embedding table for the rows looked up by a batch). Row-sparse
+   * gradients are accumulated as such, so that optimizers can update only the
+   * rows present; they are added to a dense gradient if there is one.
+   * No-op if `this->isCalcGrad()` is false.
+   */
+  void addSparseGrad(const SparseGrad& childGrad);
+
   /**
    * Registers a lambda function `hook` to be applied on the gradient w.r.t
    * Variable after it is computed during backward pass
@@ -244,7 +270,16 @@ class Variable {
   void registerGradHook(const GradHook& hook);
 
   /**
-   * Clears the gradient hook stored in the variable
+   * Registers a lambda function `hook` to be applied on the Variable after
+   * its gradient is computed during backward pass, when it is row-sparse. The
+   * hook reads the gradient with `sparseGrad()`, and may make it dense with
+   * `grad()`. If there is no such hook, a row-sparse gradient is made dense
+   * and given to the hook registered with `registerGradHook()`.
+   */
+  void registerSparseGradHook(const SparseGradHook& hook);
+
+  /**
+   * Clears the gradient hooks stored in the variable
    */
   void clearGradHook();
 
@@ -271,10 +306,20 @@ class Variable {
   /**
    * Returns a copy of this variable after removing its underlying array.
    * The new Variable is used to store the inputs for a Variable
-   * which doesn't need the output.
+   * which doesn't need the output. In inference mode, where no inputs are
+   * stored, this is a shallow copy so as not to allocate.
    */
   Variable withoutData() const;
 
+  /**
+   * Returns whether an op given the Variable as an rvalue may reuse it to
+   * hold its result: the current thread is in inference mode (see
+   * `InferenceModeGuard`), the gradient isn't calculated for the Variable and
+   * no other Variable shares its underlying array. The result is still
+   * computed into a new array, which replaces the Variable's.
+   */
+  bool isReusable() const;
+
  private:
   using DAG = std::vector<Variable>;
 
@@ -301,6 +346,11 @@ class Variable {
    */
   void applyGradHook();
 
+  /**
+   * Checks the type and the shape of a gradient added to the Variable.
+   */
+  void checkGrad(fl::dtype type, const Shape& shape) const;
+
   struct SharedData {
     /// Array wrapped by this Variable
     Tensor data;
@@ -315,10 +365,14 @@ class Variable {
     std::vector<Variable> inputs;
     /// Gradient with respect to this Variable
     std::unique_ptr<Variable> grad{nullptr};
+    /// Row-sparse gradient with respect to this Variable, if `grad` is null
+    std::unique_ptr<SparseGrad> sparseGrad{nullptr};
     /// Function for calculating the gradient of the input Variables
     GradFunc gradFunc{nullptr};
     /// Function applied to gradient after it's computed during bwd pass
     GradHook onGradAvailable{nullptr};
+    /// Function applied to a row-sparse gradient after it's computed
+    SparseGradHook onSparseGradAvailable{nullptr};
 
    private:
     FL_SAVE_LOAD(calcGrad);
@@ -333,4 +387,40 @@ class Variable {
   FL_SAVE_LOAD(sharedData_, sharedGrad_)
 };
 
+/**
+ * Disables autograd on the current thread while in scope, e.g. to serve a
+ * model. Functions then return Variables which record neither their inputs
+ * nor a gradient function, and some elementwise functions given a reusable
+ * Variable as an rvalue (see `Variable::isReusable()`) return it with its
+ * array replaced by the result rather than creating a new Variable.
+ *
+ * Guards can be nested; the previous mode is restored on destruction.
+ *
+ * Example :
+ *
+ * \code{.cpp}
+ * model->eval();
+ * {
+ *   fl::InferenceModeGuard guard;
+ *   auto output = model->forward({input}); // builds no computation graph
+ * }
+ * \endcode
+ */
+class InferenceModeGuard {
+ public:
+  InferenceModeGuard();
+  ~InferenceModeGuard();
+
+  InferenceModeGuard(const InferenceModeGuard&) = delete;
+  InferenceModeGuard& operator=(const InferenceModeGuard&) = delete;
+
+ private:
+  bool previous_;
+};
+
+/**
+ * Returns whether an `InferenceModeGuard` is in scope on the current thread.
+ */
+bool isInferenceMode();
+
 } // namespace fl
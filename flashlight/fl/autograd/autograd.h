@@ -8,5 +8,6 @@
 #pragma once
 
 #include "flashlight/fl/autograd/Functions.h"
+#include "flashlight/fl/autograd/SparseGrad.h"
 #include "flashlight/fl/autograd/Utils.h"
 #include "flashlight/fl/autograd/Variable.h"
@@ -46,6 +46,17 @@ dnnl::memory::dims getInputOutputDims(
     const int maxAxis,
     const Tensor& input,
     const int nfeatures) {
+  // Per-channel normalization of 4D inputs: use the dims of the input itself
+  // (reversed, i.e., NCHW). They describe the same data as the general case
+  // below, but also fit the (opaque) layout a convolution picked for them.
+  if (input.ndim() == 4 && minAxis == kChannelSizeIdx &&
+      maxAxis == kChannelSizeIdx) {
+    return {
+        input.dim(kBatchSizeIdx),
+        input.dim(kChannelSizeIdx),
+        input.dim(kWIdx),
+        input.dim(kHIdx)};
+  }
   Shape inDescDims;
   if (minAxis == 0) {
     inDescDims = Shape(
@@ -102,8 +113,10 @@ Tensor OneDnnAutogradExtension::batchnorm(
   if (momentum != 0.) {
     throw std::runtime_error("OneDNN batchnorm op doesn't support momentum.");
   }
-  if (input.type() == fl::dtype::f16) {
-    throw std::runtime_error("OneDNN batchnorm op - f16 inputs not supported.");
+  if (isHalfPrecisionType(input.type())) {
+    // mixed precision keeps batchnorm in f32, see OptimLevel
+    throw std::runtime_error(
+        "OneDNN batchnorm op - f16/bf16 inputs not supported.");
   }
 
   auto payload = std::make_shared<OneDnnBatchNormPayload>();
@@ -111,7 +124,6 @@ Tensor OneDnnAutogradExtension::batchnorm(
     autogradPayload->data = payload;
   }
 
-  auto output = Tensor(input.shape(), input.type());
   int nfeatures = getNfeatures(input.shape(), axes);
 
   if (runningVar.isEmpty()) {
@@ -146,15 +158,23 @@ Tensor OneDnnAutogradExtension::batchnorm(
 
   auto inputOutputDims = getInputOutputDims(minAxis, maxAxis, input, nfeatures);
 
-  auto inputOutputMemDesc =
-      dnnl::memory::desc({inputOutputDims}, dType, formatNCHW);
   payload->weightsDnnlDims = detail::convertToDnnlDims({2, nfeatures});
 
-  // Memory for forward
+  // Memory for forward. In inference, tensors supporting opaque layouts are
+  // normalized in the layout they are in, and the output keeps that layout.
+  // Training uses NCHW, which the backward pass expects.
+  const auto& inputShapeDims = input.shape().get();
+  const bool keepLayout = !train && detail::supportsOpaqueLayout(input) &&
+      inputOutputDims ==
+          dnnl::memory::dims(inputShapeDims.rbegin(), inputShapeDims.rend());
   const detail::DnnlMemoryWrapper inputMemory(
-      input, inputOutputDims, formatNCHW);
+      input, inputOutputDims, formatNCHW, keepLayout);
+  const auto inputOutputMemDesc = inputMemory.getDescriptor();
+  auto output = keepLayout
+      ? detail::createTensorWithLayout(input.shape(), inputOutputMemDesc)
+      : Tensor(input.shape(), input.type());
   const detail::DnnlMemoryWrapper outputMemory(
-      output, inputOutputDims, formatNCHW);
+      output, inputOutputDims, formatNCHW, keepLayout);
   const detail::DnnlMemoryWrapper meanMemory(
       runningMean, {runningMean.dim(0)}, formatX);
   const detail::DnnlMemoryWrapper varMemory(
@@ -15,6 +15,7 @@
 #include <dnnl.hpp>
 
 #include "flashlight/fl/autograd/tensor/backend/onednn/DnnlUtils.h"
+#include "flashlight/fl/tensor/backend/onednn/OneDnnTensor.h"
 
 using namespace dnnl;
 
@@ -64,7 +65,8 @@ OneDnnConv2DData createOneDnnConv2DData(
     const int py,
     const int dx,
     const int dy,
-    const int groups) {
+    const int groups,
+    const bool train = true) {
   const dnnl::memory::data_type dataType = detail::dnnlMapToType(inputType);
   const auto formatWeight =
       (groups == 1) ? memory::format_tag::oihw : memory::format_tag::goihw;
@@ -110,12 +112,8 @@ OneDnnConv2DData createOneDnnConv2DData(
   out.weightMemDesc = memory::desc({out.weightDims}, dataType, formatWeight);
   out.biasMemDesc = memory::desc({out.biasDims}, dataType, formatAny);
 
-  //
-  const auto forwardMode = prop_kind::forward_training;
-  // TODO: determine train mode/assess perf impact of always choosing training
-  // (primitive cache storage overhead?)
-  // const auto forwardMode =
-  //     train ? prop_kind::forward_training : prop_kind::forward_inference;
+  const auto forwardMode =
+      train ? prop_kind::forward_training : prop_kind::forward_inference;
 
   // Convolution descriptor
   std::shared_ptr<convolution_forward::desc> fwdDescriptor;
@@ -165,7 +163,7 @@ Tensor OneDnnAutogradExtension::conv2d(
     const int dx,
     const int dy,
     const int groups,
-    std::shared_ptr<detail::AutogradPayload>) {
+    std::shared_ptr<detail::AutogradPayload> autogradPayload) {
   if (input.type() == fl::dtype::f16) {
     throw std::runtime_error("Half precision is not supported in CPU.");
   }
@@ -178,7 +176,7 @@ Tensor OneDnnAutogradExtension::conv2d(
   // representation) of these shapes and viewing as if the representation is
   // row major transposes along all axis into NCHW for the input and output
   // and OIHW for the weights
-  auto output = Tensor(
+  const Shape outputShape(
       {1 +
            (input.dim(kWIdx) + (2 * px) - (1 + (weights.dim(kWIdx) - 1) * dx)) /
                sx,
@@ -186,14 +184,15 @@ Tensor OneDnnAutogradExtension::conv2d(
            (input.dim(kHIdx) + (2 * py) - (1 + (weights.dim(kHIdx) - 1) * dy)) /
                sy,
        weights.dim(kWeightOutputChannelSizeIdx),
-       input.dim(kIOBatchSizeIdx)},
-      input.type());
+       input.dim(kIOBatchSizeIdx)});
   auto hasBias = bias.elements() > 0;
 
   auto dataType = detail::dnnlMapToType(input.type());
   auto formatWeight =
       (groups == 1) ? memory::format_tag::oihw : memory::format_tag::goihw;
   auto& dnnlEngine = detail::DnnlEngine::getInstance().getEngine();
+  // no payload means no gradient will be computed, i.e., inference
+  const bool train = autogradPayload != nullptr;
 
   /********************************* Forward *******************************/
   OneDnnConv2DData conv2DData = createOneDnnConv2DData(
@@ -201,39 +200,55 @@ Tensor OneDnnAutogradExtension::conv2d(
       input.shape(),
       weights.shape(),
       bias.shape(),
-      output.shape(),
+      outputShape,
       sx,
       sy,
       px,
       py,
       dx,
       dy,
-      groups);
+      groups,
+      train);
 
-  // Create memory
+  // DNNL suggests checking if the layout requested for the convolution
+  // is different from NCHW/OIHW (even if specified), and reordering if
+  // necessary, since the convolution itself may request a different
+  // ordering
+  auto inputDesc = conv2DData.fwdPrimDesc.src_desc();
+  auto weightsDesc = conv2DData.fwdPrimDesc.weights_desc();
+  auto outputDesc = conv2DData.fwdPrimDesc.dst_desc();
+
+  // Create memory. Tensors supporting opaque layouts are used in whatever
+  // layout they are in (e.g., the one a previous convolution wrote), and the
+  // output is kept in the layout the convolution picked, so that a chain of
+  // primitives only reorders when another consumer needs the plain data.
+  const bool keepOutputLayout = detail::supportsOpaqueLayout(input);
+  auto output = keepOutputLayout
+      ? detail::createTensorWithLayout(outputShape, outputDesc)
+      : Tensor(outputShape, input.type());
   const detail::DnnlMemoryWrapper inputMemInit(
-      input, {conv2DData.inputDims}, formatNCHW);
+      input,
+      {conv2DData.inputDims},
+      formatNCHW,
+      /* allowOpaqueLayout = */ true);
   const detail::DnnlMemoryWrapper outputMemInit(
-      output, {conv2DData.outputDims}, formatNCHW);
+      output, {conv2DData.outputDims}, formatNCHW, keepOutputLayout);
   const detail::DnnlMemoryWrapper weightsMem(
-      weights, {conv2DData.weightDims}, formatWeight);
+      weights,
+      {conv2DData.weightDims},
+      formatWeight,
+      /* allowOpaqueLayout = */ true);
 
   // Network for execution
   std::vector<primitive> network;
   std::vector<std::unordered_map<int, dnnl::memory>> fwdArgs;
 
-  // DNNL suggests checking if the layout requested for the convolution
-  // is different from NCHW/OIHW (even if specified), and reordering if
-  // necessary, since the convolution itself may request a different
-  // ordering
-  auto inputDesc = conv2DData.fwdPrimDesc.src_desc();
-  auto weightsDesc = conv2DData.fwdPrimDesc.weights_desc();
-  auto outputDesc = conv2DData.fwdPrimDesc.dst_desc();
   // Input
   auto inputMemory = detail::dnnlAlignOrdering(
       network, fwdArgs, inputMemInit.getMemory(), inputDesc);
-  auto weightsMemory = detail::dnnlAlignOrdering(
-      network, fwdArgs, weightsMem.getMemory(), weightsDesc);
+  // The weights are only reordered again once they changed
+  auto weightsMemory = detail::DnnlWeightsCache::getInstance().reorder(
+      weights, "conv2d", weightsMem.getMemory(), weightsDesc);
   // Output - adds a reorder after the conv if needed
   auto outputMemory = outputMemInit.getMemory();
   if (outputMemInit.getMemory().get_desc() != outputDesc) {
@@ -269,6 +284,13 @@ Tensor OneDnnAutogradExtension::conv2d(
   // Run
   detail::executeNetwork(network, fwdArgs);
 
+  // In inference, keep the weights in the layout the convolution wants, so
+  // that they are only reordered once rather than on every call
+  if (!train && weightsMemory != weightsMem.getMemory() && groups == 1 &&
+      detail::supportsOpaqueLayout(weights)) {
+    toOneDnnTensor(weights).setLayoutMemory(weightsMemory);
+  }
+
   return output;
 }
 
@@ -324,11 +346,17 @@ Tensor OneDnnAutogradExtension::conv2dBackwardData(
 
   // Create memory
   const detail::DnnlMemoryWrapper gradOutputMemInit(
-      gradOutput, conv2DData.outputDims, formatNCHW);
+      gradOutput,
+      conv2DData.outputDims,
+      formatNCHW,
+      /* allowOpaqueLayout = */ true);
   const detail::DnnlMemoryWrapper gradInputMemInit(
       gradInput, conv2DData.inputDims, formatNCHW);
   const detail::DnnlMemoryWrapper weightsMemInitBwd(
-      weights, conv2DData.weightDims, formatWeight);
+      weights,
+      conv2DData.weightDims,
+      formatWeight,
+      /* allowOpaqueLayout = */ true);
 
   std::vector<primitive> networkBackwards;
   std::vector<std::unordered_map<int, dnnl::memory>> bwdDataArgs;
@@ -342,9 +370,10 @@ Tensor OneDnnAutogradExtension::conv2dBackwardData(
       bwdDataArgs,
       gradOutputMemInit.getMemory(),
       gradOutputDesc);
-  auto weightsMemoryBackwards = detail::dnnlAlignOrdering(
-      networkBackwards,
-      bwdDataArgs,
+  auto& weightsCache = detail::DnnlWeightsCache::getInstance();
+  auto weightsMemoryBackwards = weightsCache.reorder(
+      weights,
+      "conv2dBackwardData",
       weightsMemInitBwd.getMemory(),
       weightsDesc);
   auto gradInputMemory = gradInputMemInit.getMemory();
@@ -449,9 +478,12 @@ std::pair<Tensor, Tensor> OneDnnAutogradExtension::conv2dBackwardFilterBias(
 
   // Create memory
   const detail::DnnlMemoryWrapper inputRawMemInitBwd(
-      input, conv2DData.inputDims, formatNCHW);
+      input, conv2DData.inputDims, formatNCHW, /* allowOpaqueLayout = */ true);
   const detail::DnnlMemoryWrapper gradOutputMemInit(
-      gradOutput, conv2DData.outputDims, formatNCHW);
+      gradOutput,
+      conv2DData.outputDims,
+      formatNCHW,
+      /* allowOpaqueLayout = */ true);
   const detail::DnnlMemoryWrapper gradWeightsMemInit(
       gradWeights, conv2DData.weightDims, formatWeight);
 
@@ -8,7 +8,9 @@
 #include "flashlight/fl/autograd/tensor/backend/onednn/DnnlUtils.h"
 
 #include <stdexcept>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #if FL_BACKEND_OPENCL
   #include <dnnl_ocl.hpp>
@@ -16,7 +18,9 @@
 
 #include "flashlight/fl/common/Defines.h"
 #include "flashlight/fl/tensor/Compute.h"
+#include "flashlight/fl/tensor/DefaultTensorType.h"
 #include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/fl/tensor/backend/onednn/OneDnnTensor.h"
 
 #if FL_BACKEND_OPENCL
   #include "flashlight/fl/common/OpenClUtils.h"
@@ -29,7 +33,9 @@ DnnlStream::DnnlStream(dnnl::engine engine) {
 #if FL_BACKEND_OPENCL
   stream_ = dnnl::ocl_interop::make_stream(engine, fl::ocl::getQueue());
 #else
-  stream_ = dnnl::stream(engine);
+  // share the OneDNN tensor backend's stream, so that primitives run in order
+  // with the ops producing and consuming their data
+  stream_ = OneDnnBackend::getInstance().nativeStream();
 #endif
 }
 
@@ -47,7 +53,9 @@ DnnlEngine::DnnlEngine() {
   engine_ = dnnl::ocl_interop::make_engine(
       fl::ocl::getDeviceId(), fl::ocl::getContext());
 #else
-  engine_ = dnnl::engine(dnnl::engine::kind::cpu, 0);
+  // share the OneDNN tensor backend's engine, so that primitives can directly
+  // use the memory of OneDnnTensors
+  engine_ = OneDnnBackend::getInstance().engine();
 #endif
 }
 
@@ -68,10 +76,46 @@ dnnl::memory::dims convertShapeToDnnlDims(const Shape& shape) {
   return convertToDnnlDims(shape.get());
 }
 
+bool supportsOpaqueLayout(const Tensor& tensor) {
+  return tensor.backendType() == TensorBackendType::OneDnn;
+}
+
+Tensor createTensorWithLayout(
+    const Shape& shape,
+    const dnnl::memory::desc& desc) {
+  return toTensor<OneDnnTensor>(
+      shape, dnnl::memory(desc, DnnlEngine::getInstance().getEngine()));
+}
+
 DnnlMemoryWrapper::DnnlMemoryWrapper(
     const Tensor& tensor,
     dnnl::memory::dims dims,
-    dnnl::memory::format_tag format) {
+    dnnl::memory::format_tag format,
+    const bool allowOpaqueLayout /* = false */) {
+  if (supportsOpaqueLayout(tensor)) {
+    // Wrap the memory directly rather than through a DevicePtr, which would
+    // block until the data are ready: primitives are executed on the OneDNN
+    // backend's stream, in order with the ops producing the data.
+    tensor_ = tensor.isContiguous() ? tensor.shallowCopy()
+                                    : tensor.asContiguousTensor();
+    auto& oneDnnTensor = toOneDnnTensor(tensor_);
+    if (allowOpaqueLayout) {
+      auto layoutMemory = oneDnnTensor.layoutMemory();
+      if (layoutMemory.get_desc().dims() == dims) {
+        descriptor_ = layoutMemory.get_desc();
+        memory_ = std::move(layoutMemory);
+        return;
+      }
+    }
+    const auto& memDesc = oneDnnTensor.memoryDesc();
+    auto& memory = oneDnnTensor.memory();
+    const auto typeSize = dnnl::memory::data_type_size(memDesc.data_type());
+    void* buffer = static_cast<char*>(memory.get_data_handle()) +
+        memDesc.data.offset0 * typeSize;
+    descriptor_ = dnnl::memory::desc({dims}, memDesc.data_type(), format);
+    memory_ = dnnl::memory(descriptor_, memory.get_engine(), buffer);
+    return;
+  }
 #if FL_BACKEND_OPENCL
   fl::ocl::DevicePtrOpenCl _devicePtr(tensor);
   cl_mem* buffer = _devicePtr.getAsClMem();
@@ -88,6 +132,7 @@ DnnlMemoryWrapper::DnnlMemoryWrapper(
 
 DnnlMemoryWrapper& DnnlMemoryWrapper::operator=(DnnlMemoryWrapper&& other) {
   devicePtr_ = std::move(other.devicePtr_);
+  tensor_ = std::move(other.tensor_);
   memory_ = std::move(other.memory_);
   descriptor_ = std::move(other.descriptor_);
   return *this;
@@ -117,6 +162,95 @@ dnnl::memory dnnlAlignOrdering(
   return memoryOut;
 }
 
+DnnlWeightsCache& DnnlWeightsCache::getInstance() {
+  static DnnlWeightsCache instance;
+  return instance;
+}
+
+dnnl::memory DnnlWeightsCache::get(
+    const Tensor& weights,
+    const std::string& key,
+    const dnnl::memory::desc& desc,
+    const std::function<dnnl::memory()>& convert) {
+  if (weights.backendType() != TensorBackendType::OneDnn) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++misses_;
+    }
+    return convert();
+  }
+  const auto& oneDnnWeights = toOneDnnTensor(weights);
+  const auto dataId = oneDnnWeights.dataId();
+  const auto& weightsDesc = oneDnnWeights.memoryDesc();
+  // read before converting, so that a concurrent write makes the entry stale
+  const auto version = oneDnnWeights.version();
+  const auto entryKey = std::make_pair(dataId.lock().get(), key);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(entryKey);
+    if (it != entries_.end() && !it->second.dataId.expired() &&
+        it->second.version == version &&
+        it->second.weightsDesc == weightsDesc &&
+        it->second.memory.get_desc() == desc) {
+      ++hits_;
+      return it->second.memory;
+    }
+  }
+
+  auto memory = convert();
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++misses_;
+  // drop the conversions of freed weights
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.dataId.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  entries_[entryKey] = {dataId, weightsDesc, version, memory};
+  return memory;
+}
+
+dnnl::memory DnnlWeightsCache::reorder(
+    const Tensor& weights,
+    const std::string& key,
+    const dnnl::memory& memory,
+    const dnnl::memory::desc& desc) {
+  if (memory.get_desc() == desc) {
+    return memory;
+  }
+  return get(weights, key, desc, [&]() {
+    std::vector<dnnl::primitive> network;
+    std::vector<std::unordered_map<int, dnnl::memory>> args;
+    auto memoryOut = dnnlAlignOrdering(network, args, memory, desc);
+    executeNetwork(network, args);
+    return memoryOut;
+  });
+}
+
+size_t DnnlWeightsCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t DnnlWeightsCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+size_t DnnlWeightsCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+void DnnlWeightsCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
 void executeNetwork(
     std::vector<dnnl::primitive>& net,
     std::vector<std::unordered_map<int, dnnl::memory>>& netArgs) {
@@ -124,6 +258,22 @@ void executeNetwork(
     throw std::invalid_argument(
         "executeNetwork - given different size nets and netArgs");
   }
+  // OneDnnTensors are produced and consumed on the OneDNN backend's stream, so
+  // the network is simply submitted to it (which may run it asynchronously).
+#if FL_BACKEND_OPENCL
+  const bool onBackendStream = false;
+#else
+  const bool onBackendStream =
+      defaultTensorBackend().backendType() == TensorBackendType::OneDnn;
+#endif
+  if (onBackendStream) {
+    auto& stream = OneDnnBackend::getInstance().oneDnnStream();
+    for (size_t i = 0; i < net.size(); ++i) {
+      stream.execute(net.at(i), netArgs.at(i));
+    }
+    return;
+  }
+
   // TODO{fl::Tensor}{macros} -- improve this to work with other backend interop
   // If on the CPU backend, there isn't a AF computation stream that facilitates
   // enforcing that inputs to computation are ready; we're required to wait
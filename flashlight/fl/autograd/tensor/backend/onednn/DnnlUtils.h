@@ -8,18 +8,24 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 
 #include <dnnl.hpp>
 
 #include "flashlight/fl/common/Defines.h"
 #include "flashlight/fl/common/DevicePtr.h"
 #include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/TensorBase.h"
 #include "flashlight/fl/tensor/Types.h"
 
 namespace fl {
 
-class Tensor;
-
 namespace detail {
 
 /**
@@ -67,16 +73,42 @@ class DnnlEngine {
 dnnl::memory::dims convertToDnnlDims(const std::vector<Dim>& dims);
 dnnl::memory::dims convertShapeToDnnlDims(const Shape& shape);
 
+/**
+ * Whether primitives can read and write `tensor` in any memory layout,
+ * including opaque (e.g., blocked) ones, which is the case for OneDnnTensors.
+ */
+bool supportsOpaqueLayout(const Tensor& tensor);
+
+/**
+ * Create a (OneDnnTensor) tensor of the given shape, whose uninitialized data
+ * are in the layout of `desc`, e.g., one picked by a primitive for its output.
+ * The dims of `desc` must be the reversed shape.
+ */
+Tensor createTensorWithLayout(
+    const Shape& shape,
+    const dnnl::memory::desc& desc);
+
 /**
  * A light wrapper around dnnl::memory that manages underlying memory lifetime
- * in accordance with fl::DevicePtr.
+ * in accordance with fl::DevicePtr, or by holding on to the tensor for tensors
+ * of the OneDNN backend.
  */
 class DnnlMemoryWrapper {
  public:
+  /**
+   * @param[in] tensor the tensor whose data to wrap
+   * @param[in] dims the dims the memory should have
+   * @param[in] format the (plain) layout of the tensor data for those dims
+   * @param[in] allowOpaqueLayout if true and the tensor supports opaque layouts
+   * (see `supportsOpaqueLayout`) with dims matching `dims`, wrap its memory in
+   * its current layout (given by `getDescriptor`) instead of converting it to
+   * `format`. Callers must then reorder it as needed (see `dnnlAlignOrdering`).
+   */
   DnnlMemoryWrapper(
       const Tensor& tensor,
       dnnl::memory::dims dims,
-      dnnl::memory::format_tag format);
+      dnnl::memory::format_tag format,
+      bool allowOpaqueLayout = false);
   DnnlMemoryWrapper() = default;
 
   DnnlMemoryWrapper& operator=(DnnlMemoryWrapper&& other);
@@ -89,6 +121,8 @@ class DnnlMemoryWrapper {
   dnnl::memory::desc descriptor_;
   dnnl::memory memory_;
   fl::DevicePtr devicePtr_;
+  // keeps the data alive when wrapping the memory of a OneDnnTensor
+  Tensor tensor_;
 };
 
 /**
@@ -106,6 +140,71 @@ dnnl::memory dnnlAlignOrdering(
     const dnnl::memory& memory,
     const dnnl::memory::desc& desc);
 
+/**
+ * A singleton cache of weights converted for DNNL primitives (e.g., reordered
+ * to the layout a primitive prefers), so that weights which weren't written
+ * since the previous call aren't converted again.
+ *
+ * Entries are keyed on the data of the weights tensor and on the name of the
+ * conversion. They are stale once the data are written in place (see
+ * `OneDnnTensor::version`), and dropped once the data are freed, e.g., when
+ * an optimizer replaces the parameter with its updated value. Only the data
+ * of OneDnnTensors can be tracked: other tensors are converted on every call.
+ */
+class DnnlWeightsCache {
+ public:
+  DnnlWeightsCache() = default;
+  ~DnnlWeightsCache() = default;
+
+  /// Prohibit assignment
+  DnnlWeightsCache& operator=(DnnlWeightsCache const& c) = delete;
+
+  static DnnlWeightsCache& getInstance();
+
+  /**
+   * Returns the memory of `weights` converted by the conversion named `key`,
+   * with descriptor `desc`: the cached one if any, else the one returned by
+   * `convert`, which is cached for the next calls.
+   */
+  dnnl::memory get(
+      const Tensor& weights,
+      const std::string& key,
+      const dnnl::memory::desc& desc,
+      const std::function<dnnl::memory()>& convert);
+
+  /**
+   * Returns `memory`, the memory of `weights`, reordered to `desc` if needed
+   * (see `get`).
+   */
+  dnnl::memory reorder(
+      const Tensor& weights,
+      const std::string& key,
+      const dnnl::memory& memory,
+      const dnnl::memory::desc& desc);
+
+  /// Number of cached conversions
+  size_t size() const;
+  /// Number of calls to `get` served from the cache, and of conversions run,
+  /// since the last `clear`
+  size_t hits() const;
+  size_t misses() const;
+  void clear();
+
+ private:
+  struct Entry {
+    std::weak_ptr<const void> dataId;
+    // the descriptor of the weights, which may be a view of the data
+    dnnl::memory::desc weightsDesc;
+    uint64_t version;
+    dnnl::memory memory;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<std::pair<const void*, std::string>, Entry> entries_;
+  size_t hits_{0};
+  size_t misses_{0};
+};
+
 /**
  * Executes a sequence of DNNL primitives in the default execution stream with
  * the default execution engine.
@@ -127,13 +226,15 @@ void executeNetwork(
 dnnl::algorithm dnnlMapToPoolingMode(const PoolingMode mode);
 
 /**
- * Maps an ArrayFire array datatype into the corresponding DNNL datatype.
+ * Maps a Flashlight datatype into the corresponding DNNL datatype.
  *
  * Needs to be explicitly inlined due to a bug with DNNL.
  */
 inline dnnl::memory::data_type dnnlMapToType(const fl::dtype t) {
   if (t == fl::dtype::f16) {
     return dnnl::memory::data_type::f16;
+  } else if (t == fl::dtype::bf16) {
+    return dnnl::memory::data_type::bf16;
   } else if (t == fl::dtype::f32) {
     return dnnl::memory::data_type::f32;
   } else if (t == fl::dtype::f64) {
@@ -11,7 +11,8 @@ namespace fl {
 
 bool OneDnnAutogradExtension::isDataTypeSupported(
     const fl::dtype& dtype) const {
-  // fp16 computation is not supported with onednn
+  // fp16 computation is not supported with onednn; bf16 is, natively on
+  // platforms with AVX512-BF16/AMX and emulated elsewhere
   return dtype != fl::dtype::f16;
 }
 
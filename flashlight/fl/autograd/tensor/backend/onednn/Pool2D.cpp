@@ -97,25 +97,23 @@ Tensor OneDnnAutogradExtension::pool2d(
   auto c = input.ndim() > kChannelSizeIdx ? input.dim(kChannelSizeIdx) : 1;
   auto b = input.ndim() > kBatchSizeIdx ? input.dim(kBatchSizeIdx) : 1;
 
-  auto output = Tensor(
-      {1 + (ix + 2 * px - wx) / sx, 1 + (iy + 2 * py - wy) / sy, c, b},
-      input.type());
+  const Shape outputShape(
+      {1 + (ix + 2 * px - wx) / sx, 1 + (iy + 2 * py - wy) / sy, c, b});
 
   payload->dimsData =
-      getDimsData({ix, iy, c, b}, output.shape(), wx, wy, sx, sy, px, py);
+      getDimsData({ix, iy, c, b}, outputShape, wx, wy, sx, sy, px, py);
   auto& d = payload->dimsData;
   auto dataType = detail::dnnlMapToType(input.type());
 
-  // Memory desc
-  auto inputMD = memory::desc({d.inputDims}, dataType, formatNCHW);
-  auto outputMD = memory::desc({d.outputDims}, dataType, formatAny);
-
-  // Memory
+  // Memory. Tensors supporting opaque layouts are pooled in the layout they
+  // are in (e.g., the blocked one a convolution wrote) rather than reordered.
   auto& dnnlEngine = detail::DnnlEngine::getInstance().getEngine();
   const detail::DnnlMemoryWrapper inputMemInit(
-      input, {d.inputDims}, formatNCHW);
-  const detail::DnnlMemoryWrapper outputMemInit(
-      output, {d.outputDims}, formatNCHW);
+      input, {d.inputDims}, formatNCHW, /* allowOpaqueLayout = */ true);
+
+  // Memory desc
+  auto inputMD = inputMemInit.getDescriptor();
+  auto outputMD = memory::desc({d.outputDims}, dataType, formatAny);
 
   // Choose a mode based on whether gradients are needed
   auto forwardMode = train ? prop_kind::forward : prop_kind::forward_inference;
@@ -135,12 +133,20 @@ Tensor OneDnnAutogradExtension::pool2d(
       pooling_forward::primitive_desc(desc, dnnlEngine);
   auto& primDesc = payload->poolingFwdPrimDesc;
 
+  // Output, kept in the layout picked by the pooling if possible
+  auto inputDesc = primDesc.src_desc();
+  auto outputDesc = primDesc.dst_desc();
+  const bool keepOutputLayout = detail::supportsOpaqueLayout(input);
+  auto output = keepOutputLayout
+      ? detail::createTensorWithLayout(outputShape, outputDesc)
+      : Tensor(outputShape, input.type());
+  const detail::DnnlMemoryWrapper outputMemInit(
+      output, {d.outputDims}, formatNCHW, keepOutputLayout);
+
   // Network
   std::vector<primitive> network;
   std::vector<std::unordered_map<int, dnnl::memory>> fwdArgs;
   // Reorder if needed
-  auto inputDesc = primDesc.src_desc();
-  auto outputDesc = primDesc.dst_desc();
   auto inputMemory = detail::dnnlAlignOrdering(
       network, fwdArgs, inputMemInit.getMemory(), inputDesc);
   payload->outputMemory = outputMemInit.getMemory();
@@ -194,7 +200,7 @@ Tensor OneDnnAutogradExtension::pool2dBackward(
   auto payload =
       std::static_pointer_cast<OneDnnPool2DPayload>(autogradPayload->data);
 
-  auto gradInput = Tensor(input.shape(), fl::dtype::f32);
+  auto gradInput = Tensor(input.shape(), input.type());
   auto& dnnlEngineBwd = detail::DnnlEngine::getInstance().getEngine();
 
   DimsData& d = payload->dimsData;
@@ -205,13 +211,14 @@ Tensor OneDnnAutogradExtension::pool2dBackward(
   const detail::DnnlMemoryWrapper gradInputMemInit(
       gradInput, {d.inputDims}, formatNCHW);
   const detail::DnnlMemoryWrapper gradOutputMemInit(
-      gradOutput, {d.outputDims}, formatNCHW);
+      gradOutput, {d.outputDims}, formatNCHW, /* allowOpaqueLayout = */ true);
 
   // Descriptors
   // Memory descriptors from initialized memory must be used since
-  // pooling_backward descriptors require an ordering
+  // pooling_backward descriptors require an ordering. The output gradient
+  // takes the layout of the forward output, which the workspace matches.
   auto gradInputMD = gradInputMemInit.getMemory().get_desc();
-  auto gradOutputMD = gradOutputMemInit.getMemory().get_desc();
+  auto gradOutputMD = payload->outputMemory.get_desc();
   auto bwdDesc = pooling_backward::desc(
       poolingMode,
       gradInputMD,
@@ -7,7 +7,9 @@
 
 #include "flashlight/fl/autograd/tensor/backend/onednn/OneDnnAutogradExtension.h"
 
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -224,6 +226,34 @@ ParsedWeightsAndBias parseWeights(
   return out;
 }
 
+/**
+ * The weights of the layers computed by a oneDNN RNN primitive, in the
+ * layouts it reads them in: ldigo weights and ldgo bias.
+ */
+struct RnnWeightsMemory {
+  dnnl::memory weightsInput;
+  dnnl::memory weightsHidden;
+  dnnl::memory bias;
+};
+
+// Copies `tensor`, of the dims of `desc` in the `format` layout, into new
+// memory of descriptor `desc`
+dnnl::memory toMemory(
+    const Tensor& tensor,
+    dnnl::memory::format_tag format,
+    const dnnl::memory::desc& desc) {
+  const detail::DnnlMemoryWrapper memInit(
+      tensor.asContiguousTensor(), desc.dims(), format);
+  auto memory =
+      dnnl::memory(desc, detail::DnnlEngine::getInstance().getEngine());
+  std::vector<dnnl::primitive> network;
+  std::vector<std::unordered_map<int, dnnl::memory>> args;
+  network.push_back(dnnl::reorder(memInit.getMemory(), memory));
+  args.push_back({{DNNL_ARG_FROM, memInit.getMemory()}, {DNNL_ARG_TO, memory}});
+  detail::executeNetwork(network, args);
+  return memory;
+}
+
 struct RnnResult {
   dnnl::memory workspace;
   Tensor y; // output
@@ -238,9 +268,7 @@ RnnResult rnnImpl(
     const Tensor& input,
     const Tensor& hiddenState,
     const Tensor& cellState,
-    const Tensor& weightsInput,
-    const Tensor& weightsHidden,
-    const Tensor& bias,
+    const RnnWeightsMemory& weights,
     int hiddenSize,
     int numLayers,
     RnnMode mode,
@@ -260,21 +288,12 @@ RnnResult rnnImpl(
   dnnl::memory::dims inputDims = {seqLength, batchSize, inSize};
   dnnl::memory::dims outputDims = {
       seqLength, batchSize, hiddenSize * directionMult};
-  auto dType = detail::dnnlMapToType(input.type());
   int totalLayers = numLayers;
   int outSize = hiddenSize;
   dnnl::memory::dims hDims = {
       totalLayers, directionMult, batchSize, hiddenSize};
   dnnl::memory::dims cDims = {
       totalLayers, directionMult, batchSize, hiddenSize};
-  int extraBias = mode == RnnMode::GRU ? 1 : 0; // for LBR GRU
-  dnnl::memory::dims biasDims = {
-      numLayers, directionMult, numGates + extraBias, hiddenSize};
-  // ldigo
-  dnnl::memory::dims weightsInputDims = {
-      numLayers, directionMult, inSize, numGates, hiddenSize};
-  dnnl::memory::dims weightsHiddenDims = {
-      numLayers, directionMult, hiddenSize, numGates, hiddenSize};
 
   // Out tensors: output (y), hidden state output (hy), cell state output (cy)
   auto y = Tensor({outSize, batchSize, seqLength}, input.type());
@@ -287,8 +306,6 @@ RnnResult rnnImpl(
   // Memory for forward
   auto tnc = dnnl::memory::format_tag::tnc;
   auto ldnc = dnnl::memory::format_tag::ldnc;
-  auto ldgoi = dnnl::memory::format_tag::ldgoi;
-  auto ldgo = dnnl::memory::format_tag::ldgo;
   const detail::DnnlMemoryWrapper inputMemInit(
       input.asContiguousTensor(), {inputDims}, tnc);
   const detail::DnnlMemoryWrapper outputMemInit(y, {outputDims}, tnc);
@@ -298,31 +315,18 @@ RnnResult rnnImpl(
         hiddenState.asContiguousTensor(), {hDims}, ldnc);
   }
   const detail::DnnlMemoryWrapper hiddenOutMemInit(hy, {hDims}, ldnc);
-  const detail::DnnlMemoryWrapper weightsInputMemRawInit(
-      weightsInput.asContiguousTensor(), {weightsInputDims}, ldgoi);
-  const detail::DnnlMemoryWrapper weightsHiddenMemRawInit(
-      weightsHidden.asContiguousTensor(), {weightsHiddenDims}, ldgoi);
-  const detail::DnnlMemoryWrapper biasMemInit(
-      bias.asContiguousTensor(), {biasDims}, ldgo);
-
-  // TODO(jacobkahn): don't force a format tag - use any and do a reorder based
-  // on the format of the primitive - what it says - like you're supposed to
-  // Primitive for reordering input weights: ldgoi --> ldigo
-  auto weightsInputMemDesc = dnnl::memory::desc(
-      weightsInputDims, dType, dnnl::memory::format_tag::ldigo);
-  auto weightsInputMemInit = dnnl::memory(weightsInputMemDesc, dnnlEngine);
-  // Primitive for reordering iter/hidden weights: ldgoi --> ldigo
-  auto weightsHiddenMemDesc = dnnl::memory::desc(
-      weightsHiddenDims, dType, dnnl::memory::format_tag::ldigo);
-  auto weightsHiddenMemInit = dnnl::memory(weightsHiddenMemDesc, dnnlEngine);
+  // The weights are already in the ldigo layout the primitive reads
+  auto weightsInputMemDesc = weights.weightsInput.get_desc();
+  auto weightsHiddenMemDesc = weights.weightsHidden.get_desc();
+  auto biasMemDesc = weights.bias.get_desc();
 
   // Add arguments
   std::unordered_map<int, dnnl::memory> rnnFwdArgs = {
       {DNNL_ARG_SRC_LAYER, inputMemInit.getMemory()},
       {DNNL_ARG_SRC_ITER, hiddenInMemInit.getMemory()},
-      {DNNL_ARG_WEIGHTS_LAYER, weightsInputMemInit},
-      {DNNL_ARG_WEIGHTS_ITER, weightsHiddenMemInit},
-      {DNNL_ARG_BIAS, biasMemInit.getMemory()},
+      {DNNL_ARG_WEIGHTS_LAYER, weights.weightsInput},
+      {DNNL_ARG_WEIGHTS_ITER, weights.weightsHidden},
+      {DNNL_ARG_BIAS, weights.bias},
       {DNNL_ARG_DST_LAYER, outputMemInit.getMemory()},
       {DNNL_ARG_DST_ITER, hiddenOutMemInit.getMemory()}};
 
@@ -331,19 +335,6 @@ RnnResult rnnImpl(
   std::vector<dnnl::primitive> network;
   std::vector<std::unordered_map<int, dnnl::memory>> fwdArgs;
 
-  // reorder input weights
-  network.push_back(
-      dnnl::reorder(weightsInputMemRawInit.getMemory(), weightsInputMemInit));
-  fwdArgs.push_back(
-      {{DNNL_ARG_FROM, weightsInputMemRawInit.getMemory()},
-       {DNNL_ARG_TO, weightsInputMemInit}});
-  // reorder iter weights
-  network.push_back(
-      dnnl::reorder(weightsHiddenMemRawInit.getMemory(), weightsHiddenMemInit));
-  fwdArgs.push_back(
-      {{DNNL_ARG_FROM, weightsHiddenMemRawInit.getMemory()},
-       {DNNL_ARG_TO, weightsHiddenMemInit}});
-
   // Initialize descriptors
   if (mode == RnnMode::RELU || mode == RnnMode::TANH) {
     auto vanilla = dnnl::vanilla_rnn_forward::desc(
@@ -354,7 +345,7 @@ RnnResult rnnImpl(
         hiddenInMemInit.getDescriptor(),
         weightsInputMemDesc, // weights "layer"
         weightsHiddenMemDesc, // weights "iter"
-        biasMemInit.getDescriptor(),
+        biasMemDesc,
         outputMemInit.getDescriptor(),
         hiddenOutMemInit.getDescriptor());
     auto vanillaPd =
@@ -385,7 +376,7 @@ RnnResult rnnImpl(
         cellInMemInit.getDescriptor(),
         weightsInputMemDesc, // weights "layer"
         weightsHiddenMemDesc, // weights "iter"
-        biasMemInit.getDescriptor(),
+        biasMemDesc,
         outputMemInit.getDescriptor(),
         hiddenOutMemInit.getDescriptor(),
         cellOutMemInit.getDescriptor());
@@ -404,7 +395,7 @@ RnnResult rnnImpl(
         hiddenInMemInit.getDescriptor(),
         weightsInputMemDesc,
         weightsHiddenMemDesc,
-        biasMemInit.getDescriptor(),
+        biasMemDesc,
         outputMemInit.getDescriptor(),
         hiddenOutMemInit.getDescriptor());
     auto gruPd = dnnl::lbr_gru_forward::primitive_desc(gru, dnnlEngine);
@@ -475,9 +466,68 @@ std::tuple<Tensor, Tensor, Tensor> OneDnnAutogradExtension::rnn(
   // In Flashlight, all RNN weights are stored as one contiguous tensor, so we
   // have to parse out the input weights, input biases, hidden weights, and
   // hidden biases from one tensor. Order doesn't matter since the arrangement
-  // is a black box
-  auto parsedWeights = parseWeights(
-      weights, mode, numLayers, directionMult, inSize, numGates, hiddenSize);
+  // is a black box. They are only parsed if their conversion isn't cached.
+  std::unique_ptr<ParsedWeightsAndBias> parsedWeights;
+  auto getParsedWeights = [&]() -> const ParsedWeightsAndBias& {
+    if (!parsedWeights) {
+      parsedWeights = std::make_unique<ParsedWeightsAndBias>(parseWeights(
+          weights,
+          mode,
+          numLayers,
+          directionMult,
+          inSize,
+          numGates,
+          hiddenSize));
+    }
+    return *parsedWeights;
+  };
+
+  // The weights of `nLayers` layers of input size `layerInSize`, in the
+  // layouts of the primitive: weights reordered from ldgoi to ldigo. They are
+  // cached, so that unchanged weights are only parsed and reordered once.
+  auto dType = detail::dnnlMapToType(input.type());
+  int extraBias = mode == RnnMode::GRU ? 1 : 0; // for LBR GRU
+  auto& weightsCache = detail::DnnlWeightsCache::getInstance();
+  auto getWeightsMemory = [&](bool firstLayer, int nLayers, int layerInSize) {
+    const std::string key = firstLayer ? "rnnLayer1/" : "rnn/";
+    auto weightsInputDesc = dnnl::memory::desc(
+        {nLayers, directionMult, layerInSize, numGates, hiddenSize},
+        dType,
+        dnnl::memory::format_tag::ldigo);
+    auto weightsHiddenDesc = dnnl::memory::desc(
+        {nLayers, directionMult, hiddenSize, numGates, hiddenSize},
+        dType,
+        dnnl::memory::format_tag::ldigo);
+    auto biasDesc = dnnl::memory::desc(
+        {nLayers, directionMult, numGates + extraBias, hiddenSize},
+        dType,
+        dnnl::memory::format_tag::ldgo);
+    RnnWeightsMemory out;
+    out.weightsInput = weightsCache.get(
+        weights, key + "weightsInput", weightsInputDesc, [&]() {
+          const auto& parsed = getParsedWeights();
+          return toMemory(
+              firstLayer ? parsed.weightsInput1L : parsed.weightsInput,
+              dnnl::memory::format_tag::ldgoi,
+              weightsInputDesc);
+        });
+    out.weightsHidden = weightsCache.get(
+        weights, key + "weightsHidden", weightsHiddenDesc, [&]() {
+          const auto& parsed = getParsedWeights();
+          return toMemory(
+              firstLayer ? parsed.weightsHidden1L : parsed.weightsHidden,
+              dnnl::memory::format_tag::ldgoi,
+              weightsHiddenDesc);
+        });
+    out.bias = weightsCache.get(weights, key + "bias", biasDesc, [&]() {
+      const auto& parsed = getParsedWeights();
+      return toMemory(
+          firstLayer ? parsed.bias1L : parsed.bias,
+          dnnl::memory::format_tag::ldgo,
+          biasDesc);
+    });
+    return out;
+  };
 
   RnnResult result;
   // The oneDNN RNN primitive has an API limitation where input size and
@@ -495,9 +545,7 @@ std::tuple<Tensor, Tensor, Tensor> OneDnnAutogradExtension::rnn(
         input,
         hiddenState,
         cellState,
-        parsedWeights.weightsInput,
-        parsedWeights.weightsHidden,
-        parsedWeights.bias,
+        getWeightsMemory(/* firstLayer = */ false, numLayers, inSize),
         hiddenSize,
         numLayers,
         mode,
@@ -515,9 +563,7 @@ std::tuple<Tensor, Tensor, Tensor> OneDnnAutogradExtension::rnn(
         input,
         hiddenState(fl::span, fl::span, 0),
         cellState(fl::span, fl::span, 0),
-        parsedWeights.weightsInput1L,
-        parsedWeights.weightsHidden1L,
-        parsedWeights.bias1L,
+        getWeightsMemory(/* firstLayer = */ true, 1, inSize),
         hiddenSize,
         1,
         mode,
@@ -534,9 +580,7 @@ std::tuple<Tensor, Tensor, Tensor> OneDnnAutogradExtension::rnn(
         resultL1.y, // fixme
         hiddenState(fl::span, fl::span, fl::range(1, fl::end)),
         cellState(fl::span, fl::span, fl::range(1, fl::end)),
-        parsedWeights.weightsInput,
-        parsedWeights.weightsHidden,
-        parsedWeights.bias,
+        getWeightsMemory(/* firstLayer = */ false, numLayers - 1, hiddenSize),
         hiddenSize,
         numLayers - 1, // layers [2..N]
         mode,
@@ -42,6 +42,7 @@ const std::unordered_map<std::string, OptimLevel>
         {"O1", OptimLevel::O1},
         {"O2", OptimLevel::O2},
         {"O3", OptimLevel::O3},
+        {"BF16", OptimLevel::BF16},
 };
 
 } // namespace fl
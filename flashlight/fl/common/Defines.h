@@ -104,7 +104,11 @@ enum class OptimLevel {
   /// occur in f16.
   O2 = 2,
   /// All operations that support it use fp16.
-  O3 = 3
+  O3 = 3,
+  /// Same precision split as O1, but reduced-precision operations are in bf16
+  /// rather than fp16. bf16 has the exponent range of f32, so gradients don't
+  /// over/underflow and no loss scaling is needed.
+  BF16 = 4
 };
 
 /**
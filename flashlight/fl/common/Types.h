@@ -12,6 +12,7 @@
 #include <unordered_set>
 
 #include "flashlight/fl/common/Defines.h"
+#include "flashlight/fl/tensor/Types.h"
 
 namespace fl {
 
@@ -41,12 +42,47 @@ const std::unordered_map<OptimLevel, std::unordered_set<std::string>>
           "logSoftmax",
           "categoricalCrossEntropy",
           "gelu"}},
+        {OptimLevel::BF16,
+         // Perform all operations in bf16 except for:
+         {"batchnorm",
+          "reciprocal",
+          "erf",
+          "exp",
+          "log",
+          "log1p",
+          "pow",
+          "sum",
+          "mean",
+          "var",
+          "norm",
+          "normalize",
+          "softmax",
+          "logSoftmax",
+          "categoricalCrossEntropy",
+          "gelu"}},
         {OptimLevel::O2,
          // Perform all operations in fp16 except for:
          {"batchnorm"}},
         {OptimLevel::O3, {}} // Perform all operations in f16
 };
 
+/**
+ * Returns the reduced-precision type that operators are cast to under the given
+ * optimization level.
+ */
+inline fl::dtype optimLevelHalfPrecisionType(OptimLevel level) {
+  return level == OptimLevel::BF16 ? fl::dtype::bf16 : fl::dtype::f16;
+}
+
 } // namespace detail
 
+/**
+ * Returns whether training under the given optimization level needs loss
+ * scaling (e.g. with a DynamicScaler) to keep f16 gradients from
+ * underflowing. bf16 shares the exponent range of f32 and needs none.
+ */
+inline bool optimLevelRequiresLossScaling(OptimLevel level) {
+  return level != OptimLevel::DEFAULT && level != OptimLevel::BF16;
+}
+
 } // namespace fl
@@ -26,6 +26,10 @@ bool f16Supported() {
   return defaultTensorBackend().isDataTypeSupported(fl::dtype::f16);
 }
 
+bool bf16Supported() {
+  return defaultTensorBackend().isDataTypeSupported(fl::dtype::bf16);
+}
+
 std::string dateTimeWithMicroSeconds() {
   auto systemTime = std::chrono::system_clock::now();
   const time_t secondsSinceEpoc =
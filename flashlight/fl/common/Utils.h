@@ -27,6 +27,12 @@ class Tensor;
  */
 bool f16Supported();
 
+/**
+ * @return if bf16 operations are supported with the current flashlight
+ * configuration.
+ */
+bool bf16Supported();
+
 // Returns high resolution time formatted as:
 // MMDD HH MM SS UUUUUU
 // 0206 08:42:42.123456
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fl {
+namespace detail {
+
+/**
+ * A move-only `void()` callable, like a move-only `std::function`, which
+ * stores callables of up to `kInlineSize` bytes (e.g., lambdas with a few
+ * captures) inline rather than on the heap, so that scheduling small tasks
+ * doesn't allocate.
+ */
+class Task {
+ public:
+  static constexpr size_t kInlineSize = 64;
+
+  Task() = default;
+
+  template <
+      typename F,
+      typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Task>::value>>
+  /* implicit */ Task(F&& f) {
+    using Fn = std::decay_t<F>;
+    if constexpr (fitsInline<Fn>()) {
+      new (&storage_) Fn(std::forward<F>(f));
+      ops_ = &inlineOps<Fn>;
+    } else {
+      new (&storage_) Fn*(new Fn(std::forward<F>(f)));
+      ops_ = &heapOps<Fn>;
+    }
+  }
+
+  Task(Task&& other) noexcept {
+    moveFrom(other);
+  }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      reset();
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() {
+    reset();
+  }
+
+  explicit operator bool() const {
+    return ops_ != nullptr;
+  }
+
+  void operator()() {
+    ops_->invoke(&storage_);
+  }
+
+  /**
+   * Whether the callable is stored inline (for tests).
+   */
+  bool isInline() const {
+    return ops_ != nullptr && ops_->isInline;
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    // move-constructs the callable of `from` into `to`, and destroys `from`'s
+    void (*relocate)(void* from, void* to) noexcept;
+    void (*destroy)(void* storage) noexcept;
+    bool isInline;
+  };
+
+  template <typename Fn>
+  static constexpr bool fitsInline() {
+    return sizeof(Fn) <= kInlineSize &&
+        alignof(Fn) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible<Fn>::value;
+  }
+
+  template <typename Fn>
+  static constexpr Ops inlineOps = {
+      [](void* storage) { (*static_cast<Fn*>(storage))(); },
+      [](void* from, void* to) noexcept {
+        new (to) Fn(std::move(*static_cast<Fn*>(from)));
+        static_cast<Fn*>(from)->~Fn();
+      },
+      [](void* storage) noexcept { static_cast<Fn*>(storage)->~Fn(); },
+      true};
+
+  template <typename Fn>
+  static constexpr Ops heapOps = {
+      [](void* storage) { (**static_cast<Fn**>(storage))(); },
+      [](void* from, void* to) noexcept {
+        new (to) Fn*(*static_cast<Fn**>(from));
+      },
+      [](void* storage) noexcept { delete *static_cast<Fn**>(storage); },
+      false};
+
+  void moveFrom(Task& other) noexcept {
+    if (other.ops_) {
+      other.ops_->relocate(&other.storage_, &storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void reset() noexcept {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  const Ops* ops_{nullptr};
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+};
+
+} // namespace detail
+} // namespace fl
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/common/threadpool/ThreadPool.h"
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace fl {
+
+namespace {
+
+constexpr int kSpinCount = 64;
+constexpr size_t kCacheLineSize = 64;
+
+// The pool and worker index of the calling thread, if a worker
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorkerId = 0;
+
+#ifdef __linux__
+std::vector<int> allowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+// Parses a sysfs CPU list, e.g., "0-3,8-11"
+std::vector<int> parseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") {
+      continue;
+    }
+    const auto dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// The allowed CPUs of each NUMA node which has any
+std::vector<std::vector<int>> numaNodeCpus(const std::vector<int>& allowed) {
+  std::vector<std::vector<int>> nodes;
+  for (int node = 0;; ++node) {
+    std::ifstream file(
+        "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!file) {
+      break;
+    }
+    std::string list;
+    std::getline(file, list);
+    std::vector<int> cpus;
+    for (int cpu : parseCpuList(list)) {
+      if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty()) {
+      nodes.push_back(std::move(cpus));
+    }
+  }
+  return nodes;
+}
+#endif
+
+// The sets of CPUs workers are pinned to, round robin; empty if not pinned
+std::vector<std::vector<int>> workerCpuSets(ThreadAffinity affinity) {
+  std::vector<std::vector<int>> sets;
+#ifdef __linux__
+  const auto allowed = allowedCpus();
+  if (affinity == ThreadAffinity::Core) {
+    for (int cpu : allowed) {
+      sets.push_back({cpu});
+    }
+  } else if (affinity == ThreadAffinity::NumaNode) {
+    sets = numaNodeCpus(allowed);
+    if (sets.empty() && !allowed.empty()) {
+      // no NUMA information
+      sets.push_back(allowed);
+    }
+  }
+#endif
+  return sets;
+}
+
+void pinCurrentThread(const std::vector<int>& cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  // best effort: the thread runs unpinned if it fails
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+} // namespace
+
+struct alignas(kCacheLineSize) ThreadPool::WorkQueue {
+  std::mutex mutex;
+  // tasks scheduled by the worker itself
+  std::deque<detail::Task> tasks;
+  // tasks enqueued from other threads
+  std::deque<detail::Task> inbox;
+};
+
+ThreadPool::ThreadPool(
+    size_t threads,
+    const std::function<void(size_t)>& initFn /* = nullptr */,
+    ThreadAffinity affinity /* = ThreadAffinity::None */) {
+  for (size_t id = 0; id < threads; ++id) {
+    queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  const auto cpuSets = workerCpuSets(affinity);
+  for (size_t id = 0; id < threads; ++id) {
+    std::vector<int> cpus;
+    if (!cpuSets.empty()) {
+      cpus = cpuSets[id % cpuSets.size()];
+    }
+    workers_.emplace_back([this, initFn, id, cpus] {
+      if (!cpus.empty()) {
+        pinCurrentThread(cpus);
+      }
+      if (initFn) {
+        initFn(id);
+      }
+      workerLoop(id);
+    });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    stop_ = true;
+  }
+  sleepCondition_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::size() const {
+  return workers_.size();
+}
+
+int ThreadPool::currentWorker() const {
+  return currentPool == this ? static_cast<int>(currentWorkerId) : -1;
+}
+
+void ThreadPool::schedule(detail::Task task) {
+  const int worker = currentWorker();
+  // workers may still schedule while the pool stops, e.g., parallelFor in a
+  // pending task
+  if (stop_ && worker < 0) {
+    throw std::runtime_error("enqueue on stopped ThreadPool");
+  }
+  if (queues_.empty()) {
+    // no workers
+    task();
+    return;
+  }
+  if (worker >= 0) {
+    auto& queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  } else {
+    auto& queue = *queues_[nextQueue_.fetch_add(1) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.inbox.push_back(std::move(task));
+  }
+  // A sleeping worker registers itself before checking `numQueued_` under
+  // the lock, which is taken before notifying, so the wake-up can't be missed.
+  numQueued_.fetch_add(1);
+  if (numSleeping_.load() > 0) {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    sleepCondition_.notify_one();
+  }
+}
+
+bool ThreadPool::popTask(size_t id, detail::Task& task) {
+  auto tryPop = [&](WorkQueue& queue, bool own) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (own && !queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else if (!queue.inbox.empty()) {
+      task = std::move(queue.inbox.front());
+      queue.inbox.pop_front();
+    } else if (!own && !queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    } else {
+      return false;
+    }
+    numQueued_.fetch_sub(1);
+    return true;
+  };
+
+  if (numQueued_.load() == 0) {
+    return false;
+  }
+  if (tryPop(*queues_[id], /* own = */ true)) {
+    return true;
+  }
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    if (tryPop(*queues_[(id + i) % queues_.size()], /* own = */ false)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::runPendingTask(size_t id) {
+  detail::Task task;
+  if (!popTask(id, task)) {
+    return false;
+  }
+  task();
+  return true;
+}
+
+void ThreadPool::workerLoop(size_t id) {
+  currentPool = this;
+  currentWorkerId = id;
+  int idleSpins = 0;
+  while (true) {
+    if (runPendingTask(id)) {
+      idleSpins = 0;
+      continue;
+    }
+    if (++idleSpins < kSpinCount) {
+      std::this_thread::yield();
+      continue;
+    }
+    idleSpins = 0;
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    ++numSleeping_;
+    sleepCondition_.wait(
+        lock, [this] { return numQueued_.load() > 0 || stop_.load(); });
+    --numSleeping_;
+    if (stop_ && numQueued_.load() == 0) {
+      return;
+    }
+  }
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool_(pool) {}
+
+TaskGroup::~TaskGroup() {
+  waitForTasks();
+}
+
+void TaskGroup::wait() {
+  waitForTasks();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (error_) {
+    auto error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void TaskGroup::waitForTasks() {
+  const int worker = pool_.currentWorker();
+  if (worker < 0) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return numPending_.load() == 0; });
+    return;
+  }
+  // A worker helps with the pending tasks (which may be the group's) instead
+  // of blocking the pool
+  int idleSpins = 0;
+  while (true) {
+    if (numPending_.load() == 0) {
+      // wait for the last task to be done notifying
+      std::lock_guard<std::mutex> lock(mutex_);
+      return;
+    }
+    if (pool_.runPendingTask(worker)) {
+      idleSpins = 0;
+      continue;
+    }
+    if (++idleSpins < kSpinCount) {
+      std::this_thread::yield();
+      continue;
+    }
+    // the remaining tasks are running on other workers, which may schedule
+    // more: check again shortly
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait_for(lock, std::chrono::microseconds(100), [this] {
+      return numPending_.load() == 0;
+    });
+  }
+}
+
+void TaskGroup::finishTask(std::exception_ptr error) {
+  if (!error) {
+    // not the last task: no one to notify
+    size_t pending = numPending_.load();
+    while (pending > 1) {
+      if (numPending_.compare_exchange_weak(pending, pending - 1)) {
+        return;
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (error && !error_) {
+    error_ = error;
+  }
+  if (numPending_.fetch_sub(1) == 1) {
+    condition_.notify_all();
+  }
+}
+
+} // namespace fl
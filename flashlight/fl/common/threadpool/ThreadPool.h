@@ -9,23 +9,55 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <exception>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <stdexcept>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "flashlight/fl/common/threadpool/Task.h"
+
 namespace fl {
 
 /**
-* A simple C++11 Thread Pool implementation.
-* Source - https://github.com/progschj/ThreadPool
-*
-* Basic usage:
+ * Where the workers of a `ThreadPool` may run.
+ */
+enum class ThreadAffinity {
+  /// Workers aren't pinned
+  None,
+  /// Each worker is pinned to one of the CPUs the process may run on, round
+  /// robin
+  Core,
+  /// Workers are spread round robin over the NUMA nodes, each one pinned to
+  /// the CPUs of its node
+  NumaNode,
+};
+
+class TaskGroup;
+
+/**
+ * A work-stealing C++ thread pool, with the interface of
+ * https://github.com/progschj/ThreadPool.
+ *
+ * Every worker has its own task deques. Tasks scheduled by a worker (e.g., by
+ * `parallelFor` or a `TaskGroup` run in a task) go to its deque, which it runs
+ * last in first out, while idle workers steal the oldest ones; tasks enqueued
+ * from other threads are spread over the workers, which run them first in
+ * first out. Tasks whose callable and arguments take up to
+ * `detail::Task::kInlineSize` bytes are scheduled without heap allocation
+ * (besides the shared state of the future returned by `enqueue`).
+ *
+ * Basic usage:
   \code
     // create thread pool with 4 worker threads
     ThreadPool pool(4);
@@ -35,6 +67,9 @@ namespace fl {
 
     // get result from future
     std::cout << result.get() << std::endl;
+
+    // run fn(begin, end) over chunks of at least 64 of the 10000 indices
+    pool.parallelFor(10000, 64, [&](size_t begin, size_t end) { ... });
   \endcode
 */
 class ThreadPool {
@@ -44,10 +79,12 @@ class ThreadPool {
    * \param [in] threads number of threads
    * \param [in] initFn initialization code (if any) that will be run on all the
    * threads
+   * \param [in] affinity the CPUs the threads may run on
    */
   ThreadPool(
       size_t threads,
-      const std::function<void(size_t)>& initFn = nullptr);
+      const std::function<void(size_t)>& initFn = nullptr,
+      ThreadAffinity affinity = ThreadAffinity::None);
 
   /**
    * add new work item to the pool
@@ -57,77 +94,200 @@ class ThreadPool {
   template <class F, class... Args>
   auto enqueue(F&& f, Args&&... args)
       -> std::future<typename std::invoke_result<F, Args...>::type>;
-  ///  destructor joins all threads.
+
+  /**
+   * Runs `fn(begin, end)` over chunks of [0, `size`) of at least `grainSize`
+   * indices (unless `size` is smaller), in parallel, and returns once all
+   * chunks are done. The range is split in halves until chunks are smaller
+   * than twice `grainSize`, so that idle workers steal large ranges first.
+   * The calling thread runs chunks too. If `fn` throws, the first exception is
+   * rethrown once all chunks are done.
+   */
+  template <typename F>
+  void parallelFor(size_t size, size_t grainSize, F&& fn);
+
+  /// Number of worker threads
+  size_t size() const;
+
+  /**
+   * The index of the calling thread among the workers of this pool, or -1 if
+   * it isn't one.
+   */
+  int currentWorker() const;
+
+  ///  destructor runs the pending tasks, then joins all threads.
   ~ThreadPool();
 
  private:
+  friend class TaskGroup;
+  struct WorkQueue;
+
   // need to keep track of threads so we can join them
-  std::vector<std::thread> workers;
-  // the task queue
-  std::queue<std::function<void()>> tasks;
-
-  // synchronization
-  std::mutex queue_mutex;
-  std::condition_variable condition;
-  bool stop;
-}; // namespace flclassThreadPool
-
-inline ThreadPool::ThreadPool(
-    size_t threads,
-    const std::function<void(size_t)>& initFn /* = nullptr */)
-    : stop(false) {
-  for (size_t id = 0; id < threads; ++id)
-    workers.emplace_back([this, initFn, id] {
-      if (initFn) {
-        initFn(id);
-      }
-      for (;;) {
-        std::function<void()> task;
-
-        {
-          std::unique_lock<std::mutex> lock(this->queue_mutex);
-          this->condition.wait(
-              lock, [this] { return this->stop || !this->tasks.empty(); });
-          if (this->stop && this->tasks.empty())
-            return;
-          task = std::move(this->tasks.front());
-          this->tasks.pop();
-        }
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  // the next queue tasks enqueued from other threads go to
+  std::atomic<size_t> nextQueue_{0};
+  // tasks in the queues
+  std::atomic<size_t> numQueued_{0};
 
-        task();
-      }
-    });
-}
+  // idle workers sleep until a task is scheduled
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCondition_;
+  std::atomic<int> numSleeping_{0};
+  std::atomic<bool> stop_{false};
+
+  void workerLoop(size_t id);
+  void schedule(detail::Task task);
+  // Pops a task: the most recent one of `id`'s own tasks, or the oldest of its
+  // enqueued tasks, else steals from another worker.
+  bool popTask(size_t id, detail::Task& task);
+  // Runs a pending task on behalf of worker `id`; false if there was none
+  bool runPendingTask(size_t id);
+
+  template <typename F>
+  void parallelForRange(
+      TaskGroup& group,
+      F& fn,
+      size_t begin,
+      size_t end,
+      size_t grainSize);
+};
+
+/**
+ * A group of tasks run by a `ThreadPool`, which can be waited for. Tasks may
+ * add tasks to their own group. A worker waiting for a group runs pending
+ * tasks meanwhile, so that tasks can wait for groups of subtasks without
+ * deadlocking the pool.
+ *
+ * \code
+ *   TaskGroup group(pool);
+ *   for (auto& item : items) {
+ *     group.run([&item]() { process(item); });
+ *   }
+ *   group.wait(); // rethrows the first exception of the tasks, if any
+ * \endcode
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool& pool);
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  /// Waits for the tasks, ignoring their exceptions.
+  ~TaskGroup();
+
+  template <typename F>
+  void run(F&& f);
+
+  /**
+   * Returns once all the tasks of the group are done, rethrowing the first
+   * exception they threw, if any.
+   */
+  void wait();
+
+ private:
+  ThreadPool& pool_;
+  std::atomic<size_t> numPending_{0};
+  // guards the last decrement of `numPending_`, so that a returning `wait`
+  // can't race with the notification
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::exception_ptr error_;
+
+  void waitForTasks();
+  void finishTask(std::exception_ptr error);
+};
 
 template <class F, class... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args)
     -> std::future<typename std::invoke_result<F, Args...>::type> {
   using return_type = typename std::invoke_result<F, Args...>::type;
 
-  auto task = std::make_shared<std::packaged_task<return_type()>>(
-      std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-
-  std::future<return_type> res = task->get_future();
-  {
-    std::unique_lock<std::mutex> lock(queue_mutex);
+  std::promise<return_type> promise;
+  std::future<return_type> res = promise.get_future();
+  // arguments are passed as lvalues, as by std::bind
+  schedule(detail::Task(
+      [promise = std::move(promise),
+       f = std::forward<F>(f),
+       args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        try {
+          if constexpr (std::is_void<return_type>::value) {
+            std::apply(f, args);
+            promise.set_value();
+          } else {
+            promise.set_value(std::apply(f, args));
+          }
+        } catch (...) {
+          promise.set_exception(std::current_exception());
+        }
+      }));
+  return res;
+}
 
-    // don't allow enqueueing after stopping the pool
-    if (stop)
-      throw std::runtime_error("enqueue on stopped ThreadPool");
+template <typename F>
+void ThreadPool::parallelFor(size_t size, size_t grainSize, F&& fn) {
+  const size_t grain = std::max<size_t>(1, grainSize);
+  if (size <= grain || workers_.empty()) {
+    if (size > 0) {
+      fn(size_t(0), size);
+    }
+    return;
+  }
+  TaskGroup group(*this);
+  std::exception_ptr error;
+  try {
+    parallelForRange(group, fn, 0, size, grain);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // wait before rethrowing, since the tasks reference `fn`
+  try {
+    group.wait();
+  } catch (...) {
+    if (!error) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
 
-    tasks.emplace([task]() { (*task)(); });
+template <typename F>
+void ThreadPool::parallelForRange(
+    TaskGroup& group,
+    F& fn,
+    size_t begin,
+    size_t end,
+    size_t grainSize) {
+  while (end - begin >= 2 * grainSize) {
+    const size_t mid = begin + (end - begin) / 2;
+    group.run([this, &group, &fn, mid, end, grainSize]() {
+      parallelForRange(group, fn, mid, end, grainSize);
+    });
+    end = mid;
   }
-  condition.notify_one();
-  return res;
+  fn(begin, end);
 }
 
-inline ThreadPool::~ThreadPool() {
-  {
-    std::unique_lock<std::mutex> lock(queue_mutex);
-    stop = true;
+template <typename F>
+void TaskGroup::run(F&& f) {
+  numPending_.fetch_add(1);
+  try {
+    pool_.schedule(detail::Task([this, f = std::forward<F>(f)]() mutable {
+      std::exception_ptr error;
+      try {
+        f();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      finishTask(error);
+    }));
+  } catch (...) {
+    finishTask(nullptr);
+    throw;
   }
-  condition.notify_all();
-  for (std::thread& worker : workers)
-    worker.join();
 }
+
 } // namespace fl
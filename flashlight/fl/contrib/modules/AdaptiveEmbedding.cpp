@@ -16,11 +16,42 @@
 
 namespace fl {
 
+namespace {
+
+// Looks up the rows of a [N, D] embedding table, returns [D, B]. The gradient
+// of the table is row-sparse if `sparseGrad`.
+Variable
+lookupRows(const Variable& input, const Variable& table, bool sparseGrad) {
+  if (!sparseGrad) {
+    return embedding(input, reorder(table, {1, 0}));
+  }
+  auto result = fl::transpose(table.tensor()(input.tensor(), fl::span));
+  auto gradFunc = [](std::vector<Variable>& inputs,
+                     const Variable& gradOutput) {
+    auto& table = inputs[1];
+    if (!table.isCalcGrad()) {
+      return;
+    }
+    table.addSparseGrad(SparseGrad(
+        inputs[0].tensor(),
+        fl::transpose(gradOutput.tensor()),
+        /* dim = */ 0,
+        table.shape()));
+  };
+  return Variable(result, {input, table}, gradFunc);
+}
+
+} // namespace
+
 AdaptiveEmbedding::AdaptiveEmbedding(
     int embeddingDim,
     std::vector<int> cutoff,
-    float divValue /*= 4 */)
-    : embeddingDim_(embeddingDim), cutoff_(cutoff), divValue_(divValue) {
+    float divValue /*= 4 */,
+    bool sparseGrad /* = false */)
+    : embeddingDim_(embeddingDim),
+      cutoff_(cutoff),
+      divValue_(divValue),
+      sparseGrad_(sparseGrad) {
   if (cutoff_.empty()) {
     throw std::invalid_argument("Invalid cutoff for AdaptiveEmbedding");
   }
@@ -63,7 +94,7 @@ Variable AdaptiveEmbedding::forward(const Variable& input) {
   Tensor headMask = flatInput.tensor() < cutoff_[0];
   if (fl::sum(headMask).scalar<unsigned>() > 0) {
     auto headEmbedding =
-        embedding(flatInput(headMask), reorder(params_[0], {1, 0}));
+        lookupRows(flatInput(headMask), params_[0], sparseGrad_);
     headEmbedding = matmul(params_[1], headEmbedding);
     indices.push_back(Variable(fl::nonzero(headMask), false));
     embeddings.push_back(headEmbedding);
@@ -73,9 +104,10 @@ Variable AdaptiveEmbedding::forward(const Variable& input) {
     Tensor tailMask = flatInput.tensor() < cutoff_[tailIdx] &&
         flatInput.tensor() >= cutoff_[tailIdx - 1];
     if (fl::any(tailMask).asScalar<bool>()) {
-      auto tailEmbedding = embedding(
+      auto tailEmbedding = lookupRows(
           flatInput(tailMask) - cutoff_[tailIdx - 1],
-          reorder(params_[tailIdx * 2], {1, 0}));
+          params_[tailIdx * 2],
+          sparseGrad_);
       tailEmbedding = matmul(params_[tailIdx * 2 + 1], tailEmbedding);
       indices.push_back(Variable(fl::nonzero(tailMask), false));
       embeddings.push_back(tailEmbedding);
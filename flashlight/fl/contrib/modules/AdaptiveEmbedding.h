@@ -25,8 +25,14 @@ class AdaptiveEmbedding : public UnaryModule {
   int embeddingDim_;
   std::vector<int> cutoff_;
   float divValue_;
+  bool sparseGrad_{false};
 
-  FL_SAVE_LOAD_WITH_BASE(UnaryModule, embeddingDim_, cutoff_, divValue_)
+  FL_SAVE_LOAD_WITH_BASE(
+      UnaryModule,
+      embeddingDim_,
+      cutoff_,
+      divValue_,
+      fl::versioned(sparseGrad_, 1))
 
  public:
   /**
@@ -44,11 +50,15 @@ class AdaptiveEmbedding : public UnaryModule {
    * assigned to an 'overflow' bucket.
    * @param[in] divValue is the scaling factor for tail groups dimention
    * reduction (see paper https://arxiv.org/pdf/1809.10853.pdf for details).
+   * @param[in] sparseGrad if true, the gradients of the head and tail
+   * embeddings only hold the rows looked up by the batch (see
+   * `Variable::addSparseGrad`).
    */
   explicit AdaptiveEmbedding(
       int embeddingDim,
       std::vector<int> cutoff,
-      float divValue = 4);
+      float divValue = 4,
+      bool sparseGrad = false);
 
   Variable forward(const Variable& input) override;
 
@@ -58,3 +68,4 @@ class AdaptiveEmbedding : public UnaryModule {
 } // namespace fl
 
 CEREAL_REGISTER_TYPE(fl::AdaptiveEmbedding)
+CEREAL_CLASS_VERSION(fl::AdaptiveEmbedding, 1)
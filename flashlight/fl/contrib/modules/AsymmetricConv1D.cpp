@@ -103,6 +103,10 @@ Variable AsymmetricConv1D::forward(const Variable& input) {
   return output;
 }
 
+float AsymmetricConv1D::getFuturePart() const {
+  return futurePart_;
+}
+
 std::string AsymmetricConv1D::prettyString() const {
   std::ostringstream ss;
   ss << "AsymmetricConv1D";
@@ -52,6 +52,8 @@ class AsymmetricConv1D : public fl::Conv2D {
 
   fl::Variable forward(const fl::Variable& input) override;
 
+  float getFuturePart() const;
+
   std::string prettyString() const override;
 
  private:
@@ -71,10 +71,11 @@ Variable Transformer::mlp(const Variable& input) {
   return (*w2_)(dropout(relu((*w1_)(input)), pDropout));
 }
 
-Variable Transformer::getMask(int32_t n, bool cache) {
+Variable Transformer::getMask(int32_t n, int32_t nPrev) {
   auto mask = fl::tril(fl::full({n, n}, 1.0));
-  if (cache) {
-    auto maskCache = fl::triu(fl::full({n, n}, 1.0));
+  if (nPrev > 0) {
+    // every position sees the whole previous step
+    auto maskCache = fl::full({n, nPrev}, 1.0);
     mask = fl::concatenate(1, maskCache, mask);
   }
   return Variable(fl::log(mask), false);
@@ -98,7 +99,7 @@ Variable Transformer::selfAttention(const std::vector<Variable>& input) {
   }
   if (useMask_ && encoderInput.dim(1) > 1) {
     // mask future if we use the previous state (then n is previous time)
-    mask = getMask(n, input.size() == 3);
+    mask = getMask(encoderInput.dim(1), input.size() == 3 ? n : 0);
   }
 
   int offset = (input.size() == 2) ? 0 : n;
@@ -130,7 +131,7 @@ std::vector<Variable> Transformer::forward(const std::vector<Variable>& input) {
   // padMask should be empty if previous step is provided
   // padMask is expected to have "1" on the used positions and "0" on padded
   // positions
-  if (input.size() != 2) {
+  if (input.size() != 2 && input.size() != 3) {
     throw std::invalid_argument(
         "Invalid inputs for transformer block: there should be at least input and mask");
   }
@@ -140,6 +141,24 @@ std::vector<Variable> Transformer::forward(const std::vector<Variable>& input) {
         "Transformer::forward - input should be of 3 dimensions "
         "expects an input of size C x T x B - see documentation.");
   }
+  if (input.size() == 3) {
+    if (!input.back().isEmpty()) {
+      throw std::invalid_argument(
+          "Transformer::forward - pad mask must be empty "
+          "if the previous step is provided");
+    }
+    if (input[0].ndim() != 3 || input[0].dim(0) != x.dim(0) ||
+        input[0].dim(2) != x.dim(2)) {
+      throw std::invalid_argument(
+          "Transformer::forward - previous step should be of size C x T' x B "
+          "with the same C and B as the input");
+    }
+    if (bptt_ > 0 && input[0].dim(1) >= bptt_) {
+      throw std::invalid_argument(
+          "Transformer::forward - previous step is longer than "
+          "the positional embedding allows (bptt - 1)");
+    }
+  }
 
   if (!input.back().isEmpty()) {
     if (input.back().ndim() < 2) {
@@ -167,6 +186,14 @@ std::vector<Variable> Transformer::forward(const std::vector<Variable>& input) {
   }
 }
 
+bool Transformer::getUseMask() const {
+  return useMask_;
+}
+
+int32_t Transformer::getBptt() const {
+  return bptt_;
+}
+
 void Transformer::setDropout(float value) {
   pDropout_ = value;
 }
@@ -27,6 +27,10 @@ namespace fl {
  * previous step is used in for the decoder phase, previous output with size
  * C x T' x B. Input dimension at forward is assumed to be C x T x B, where C is
  * the number of features, T the sequence length and B the batch size.
+ * - every input position attends to all T' positions of the previous step, so
+ * with `useMask` feeding the earlier inputs of this layer as previous step
+ * gives the same output as running on the whole sequence (T' must be smaller
+ * than bptt if a positional embedding is used)
  * - padMask is with T'' x B sizes (T'' will be resized to the input size)
  * - padMask should be empty if "previous step" is provided (in the decoder
  * phase)
@@ -62,6 +66,8 @@ class Transformer : public Container {
   std::vector<Variable> forward(const std::vector<Variable>& input) override;
   void setDropout(float value);
   void setLayerDropout(float value);
+  bool getUseMask() const;
+  int32_t getBptt() const;
   std::string prettyString() const override;
 
  private:
@@ -75,7 +81,7 @@ class Transformer : public Container {
   std::shared_ptr<LayerNorm> norm1_, norm2_;
 
   Variable mlp(const Variable& input);
-  Variable getMask(int32_t n, bool cache = false);
+  Variable getMask(int32_t n, int32_t nPrev = 0);
   Variable selfAttention(const std::vector<Variable>& input);
 
   FL_SAVE_LOAD_WITH_BASE(
@@ -7,6 +7,9 @@
 
 #include "flashlight/fl/distributed/DistributedApi.h"
 
+#include <algorithm>
+
+#include "flashlight/fl/tensor/Index.h"
 #include "flashlight/fl/tensor/TensorBase.h"
 
 namespace fl {
@@ -29,6 +32,55 @@ void allReduce(
   var.tensor() *= scale;
 }
 
+void allReduceSparseGrad(Variable& var, double scale /* = 1.0 */) {
+  const int worldSize = getWorldSize();
+  SparseGrad& grad = var.sparseGrad();
+  if (worldSize > 1) {
+    const int rank = getWorldRank();
+    const int dim = grad.dim();
+    const Dim denseRows = grad.shape()[dim];
+
+    std::vector<int> nRows(worldSize, 0);
+    nRows[rank] = grad.indices().elements();
+    auto nRowsTensor = Tensor::fromVector(nRows);
+    allReduce(nRowsTensor);
+    nRows = nRowsTensor.toHostVector<int>();
+    const int maxRows = *std::max_element(nRows.begin(), nRows.end());
+
+    if (static_cast<Dim>(maxRows) * worldSize >= denseRows) {
+      // grad() makes the gradient dense
+      allReduce(var.grad(), scale);
+      return;
+    }
+    if (maxRows > 0) {
+      std::vector<Index> rows = {fl::span, fl::span};
+      // process r writes its rows in [r * maxRows, r * maxRows + nRows[r])
+      Shape valuesShape = grad.shape();
+      valuesShape[dim] = maxRows * worldSize;
+      auto indices = fl::full({maxRows * worldSize}, 0, fl::dtype::s32);
+      auto values = fl::full(valuesShape, 0, grad.type());
+      if (nRows[rank] > 0) {
+        rows[dim] = fl::range(rank * maxRows, rank * maxRows + nRows[rank]);
+        indices(rows[dim]) = grad.indices();
+        values(rows) = grad.values();
+      }
+      allReduce(indices);
+      allReduce(values);
+
+      std::vector<int> filled;
+      for (int r = 0; r < worldSize; ++r) {
+        for (int i = 0; i < nRows[r]; ++i) {
+          filled.push_back(r * maxRows + i);
+        }
+      }
+      rows[dim] = Tensor::fromVector(filled);
+      grad = SparseGrad(indices(rows[dim]), values(rows), dim, grad.shape());
+      grad.coalesce();
+    }
+  }
+  grad.values() *= scale;
+}
+
 void allReduceMultiple(
     std::vector<Variable> vars,
     double scale /* = 1.0 */,
@@ -82,6 +82,20 @@ void allReduce(Variable& var, double scale = 1.0, bool async = false);
  */
 void allReduce(Tensor& arr, bool async = false);
 
+/**
+ * Synchronizes the row-sparse gradient of a Variable: the rows of all the
+ * processes are gathered (with an allreduce of buffers holding the rows of
+ * each process in its own slot) and summed, so that every process gets the
+ * rows of the gradient summed over processes. When the rows of all the
+ * processes wouldn't be smaller than the dense gradient, the gradient is
+ * made dense and reduced as such instead.
+ *
+ * @param[in] var a Variable with a row-sparse gradient (see
+ * `Variable::isSparseGrad()`) which will be synchronized
+ * @param[in] scale scale the gradient after synchronization by this factor
+ */
+void allReduceSparseGrad(Variable& var, double scale = 1.0);
+
 /**
  * Synchronizes a the arrays wrapped by a vector of Variables with allreduce.
  *
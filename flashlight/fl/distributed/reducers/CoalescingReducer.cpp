@@ -45,6 +45,13 @@ void CoalescingReducer::add(Variable& var) {
   }
 }
 
+void CoalescingReducer::addSparse(Variable& var) {
+  flush();
+  // the rows are gathered synchronously
+  synchronize();
+  allReduceSparseGrad(var, scale_);
+}
+
 void CoalescingReducer::finalize() {
   flush();
   synchronize();
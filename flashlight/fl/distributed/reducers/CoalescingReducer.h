@@ -70,6 +70,12 @@ class CoalescingReducer : public Reducer {
    */
   void add(Variable& var) override;
 
+  /**
+   * Synchronize a row-sparse gradient immediately, after flushing the cache so
+   * that all processes run their reductions in the same order.
+   */
+  void addSparse(Variable& var) override;
+
   /**
    * Flush any remaining ``Variable``s in the cache and synchronize.
    */
@@ -19,4 +19,8 @@ void InlineReducer::add(Variable& var) {
   var.tensor() *= scale_;
 }
 
+void InlineReducer::addSparse(Variable& var) {
+  allReduceSparseGrad(var, scale_);
+}
+
 } // namespace fl
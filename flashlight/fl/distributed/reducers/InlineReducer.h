@@ -37,6 +37,14 @@ class InlineReducer : public Reducer {
    */
   void add(Variable& var) override;
 
+  /**
+   * Ingest the row-sparse gradient of a Variable and immediately synchronize
+   * it.
+   *
+   * @param[in] var the Variable whose gradient to process for synchronization
+   */
+  void addSparse(Variable& var) override;
+
   // no-op; no state
   void finalize() override {}
 };
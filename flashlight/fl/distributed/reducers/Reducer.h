@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <stdexcept>
+
 namespace fl {
 
 class Variable;
@@ -31,6 +33,17 @@ class Reducer {
    */
   virtual void add(Variable& var) = 0;
 
+  /**
+   * Have the Reducer ingest the row-sparse gradient of a Variable (see
+   * `Variable::addSparseGrad`), which may be made dense. Reducers which don't
+   * support them throw.
+   *
+   * @param[in] var a Variable whose row-sparse gradient is to be ingested
+   */
+  virtual void addSparse(Variable& /* var */) {
+    throw std::logic_error("Reducer doesn't support row-sparse gradients");
+  }
+
   /**
    * Forces a reduction/synchronization of the Reducer.
    * For some implementations, this may be a no-op if the Reducer immediately
@@ -18,6 +18,8 @@ void distributeModuleGrads(
     std::shared_ptr<Reducer> reducer) {
   for (auto& param : module->params()) {
     param.registerGradHook([reducer](Variable& grad) { reducer->add(grad); });
+    param.registerSparseGradHook(
+        [reducer](Variable& var) { reducer->addSparse(var); });
   }
 }
 
@@ -38,7 +40,11 @@ void allReduceGradients(
     throw std::invalid_argument("null module passed to allReduceGradients");
   }
   for (auto& param : module->params()) {
-    allReduce(param.grad(), scale);
+    if (param.isSparseGrad()) {
+      allReduceSparseGrad(param, scale);
+    } else {
+      allReduce(param.grad(), scale);
+    }
   };
 }
 
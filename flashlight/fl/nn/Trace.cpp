@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/nn/Trace.h"
+
+namespace fl {
+
+GraphPlan trace(
+    Module& module,
+    const std::vector<Shape>& inputShapes,
+    const std::vector<dtype>& inputTypes /* = {} */) {
+  const bool wasTrain = module.isTrain();
+  module.eval();
+  const auto params = module.params();
+  auto restoreParams = [&]() {
+    for (int i = 0; i < params.size(); ++i) {
+      module.setParams(params[i], i);
+    }
+    if (wasTrain) {
+      module.train();
+    }
+  };
+
+  try {
+    auto plan = captureGraph(
+        inputShapes, inputTypes, [&](const std::vector<Tensor>& inputs) {
+          // parameters become constants of the plan
+          for (int i = 0; i < params.size(); ++i) {
+            module.setParams(
+                Variable(captureConstant(params[i].tensor()), false), i);
+          }
+          std::vector<Variable> inputVars;
+          for (const auto& input : inputs) {
+            inputVars.emplace_back(input, false);
+          }
+          std::vector<Tensor> outputs;
+          for (const auto& output : module.forward(inputVars)) {
+            outputs.push_back(output.tensor());
+          }
+          return outputs;
+        });
+    restoreParams();
+    return plan;
+  } catch (...) {
+    restoreParams();
+    throw;
+  }
+}
+
+} // namespace fl
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "flashlight/fl/nn/modules/Module.h"
+#include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/Types.h"
+#include "flashlight/fl/tensor/backend/jit/GraphPlan.h"
+
+namespace fl {
+
+/**
+ * Captures the forward pass of a module in eval mode as a `GraphPlan`, which
+ * can be saved and run with a `GraphPlanRunner` for inference, without the
+ * module, autograd or tracing again. The inputs of the plan are those of
+ * `forward`, of the given shapes and types (f32 if not given), and its
+ * outputs are those of `forward`; the parameters are constants of the plan.
+ *
+ * The module is traced in eval mode, then switched back to train mode if it
+ * was in it. Modules with ops without JIT support
+ * (e.g., convolutions and RNNs) can't be traced; see `captureGraph` for ops
+ * which are only valid for the traced inputs.
+ *
+ * @param[in] module the module to trace
+ * @param[in] inputShapes the shapes of the inputs of the module
+ * @param[in] inputTypes the types of the inputs of the module
+ * @return the plan of the forward pass
+ */
+GraphPlan trace(
+    Module& module,
+    const std::vector<Shape>& inputShapes,
+    const std::vector<dtype>& inputTypes = {});
+
+} // namespace fl
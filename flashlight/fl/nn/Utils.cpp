@@ -158,4 +158,17 @@ Tensor join(
   return padSeq;
 }
 
+Tensor joinLengths(const std::vector<Tensor>& inputs, int dim) {
+  std::vector<int> lengths;
+  lengths.reserve(inputs.size());
+  for (const auto& in : inputs) {
+    if (in.isEmpty()) {
+      lengths.push_back(0);
+    } else {
+      lengths.push_back(dim < in.ndim() ? in.dim(dim) : 1);
+    }
+  }
+  return Tensor::fromVector(lengths);
+}
+
 } // namespace fl
@@ -70,6 +70,12 @@ Tensor join(
     double padValue = 0.0,
     int batchDim = -1);
 
+/// sizes of a list of arrays along a dimension, as an s32 array of shape
+/// [inputs.size()] (0 for empty arrays): e.g. the lengths of sequences packed
+/// by `join`, for the packed sequence `rnn` and `RNN::forward`. Can be used as
+/// a `BatchDataset` batch function for a field holding the sequences.
+Tensor joinLengths(const std::vector<Tensor>& inputs, int dim);
+
 /** @} */
 
 } // namespace fl
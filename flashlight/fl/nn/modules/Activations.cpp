@@ -59,6 +59,17 @@ Variable ReLU::forward(const Variable& input) {
   return max(input, 0.0);
 }
 
+std::vector<Variable> ReLU::forwardReusingInputs(
+    std::vector<Variable>&& inputs) {
+  if (!isInferenceMode()) {
+    return Module::forwardReusingInputs(std::move(inputs));
+  }
+  if (inputs.size() != 1) {
+    throw std::invalid_argument("UnaryModule expects only one input");
+  }
+  return {relu(std::move(inputs[0]))};
+}
+
 std::string ReLU::prettyString() const {
   return "ReLU";
 }
@@ -96,6 +96,9 @@ class ReLU : public UnaryModule {
 
   Variable forward(const Variable& input) override;
 
+  std::vector<Variable> forwardReusingInputs(
+      std::vector<Variable>&& inputs) override;
+
   std::string prettyString() const override;
 
  private:
@@ -57,7 +57,7 @@ Variable BatchNorm::forward(const Variable& input) {
   }
 
   auto paramsType =
-      (input.type() == fl::dtype::f16) ? fl::dtype::f32 : input.type();
+      isHalfPrecisionType(input.type()) ? fl::dtype::f32 : input.type();
   return batchnorm(
       input,
       params_.empty() ? Variable(Tensor(paramsType), false) : params_[0],
@@ -76,8 +76,9 @@ Sequential::Sequential() = default;
 
 std::vector<Variable> Sequential::forward(const std::vector<Variable>& input) {
   auto output = input;
+  // Intermediate outputs aren't used once passed on, so may be reused
   for (auto& module : modules_) {
-    output = module->forward(output);
+    output = module->forwardReusingInputs(std::move(output));
   }
   return output;
 }
@@ -85,7 +86,7 @@ std::vector<Variable> Sequential::forward(const std::vector<Variable>& input) {
 Variable Sequential::forward(const Variable& input) {
   std::vector<Variable> output = {input};
   for (auto& module : modules_) {
-    output = module->forward(output);
+    output = module->forwardReusingInputs(std::move(output));
   }
   if (output.size() != 1) {
     throw std::invalid_argument("Module output size is not 1");
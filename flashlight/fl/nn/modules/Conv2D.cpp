@@ -158,6 +158,22 @@ void Conv2D::initialize() {
   benchmarks_ = std::make_shared<detail::ConvBenchmarks>();
 }
 
+int Conv2D::getXFilter() const {
+  return xFilter_;
+}
+
+int Conv2D::getXStride() const {
+  return xStride_;
+}
+
+int Conv2D::getXPad() const {
+  return xPad_;
+}
+
+int Conv2D::getXDilation() const {
+  return xDilation_;
+}
+
 std::string Conv2D::prettyString() const {
   std::ostringstream ss;
   ss << "Conv2D";
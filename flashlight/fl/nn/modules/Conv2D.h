@@ -178,6 +178,16 @@ class Conv2D : public UnaryModule {
 
   Variable forward(const Variable& input) override;
 
+  /**
+   * Returns the filter size, stride, padding and dilation along the first
+   * dimension. The padding is either a non-negative integer or
+   * `fl::PaddingMode::SAME`.
+   */
+  int getXFilter() const;
+  int getXStride() const;
+  int getXPad() const;
+  int getXDilation() const;
+
   std::string prettyString() const override;
 
  protected:
@@ -22,6 +22,21 @@ Variable Dropout::forward(const Variable& input) {
   }
 }
 
+std::vector<Variable> Dropout::forwardReusingInputs(
+    std::vector<Variable>&& inputs) {
+  if (!isInferenceMode()) {
+    return Module::forwardReusingInputs(std::move(inputs));
+  }
+  if (inputs.size() != 1) {
+    throw std::invalid_argument("UnaryModule expects only one input");
+  }
+  if (train_) {
+    return {dropout(std::move(inputs[0]), ratio_)};
+  } else {
+    return {std::move(inputs[0])};
+  }
+}
+
 std::string Dropout::prettyString() const {
   return ("Dropout (" + std::to_string(ratio_) + ")");
 }
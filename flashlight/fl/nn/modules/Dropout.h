@@ -37,6 +37,9 @@ class Dropout : public UnaryModule {
 
   Variable forward(const Variable& input) override;
 
+  std::vector<Variable> forwardReusingInputs(
+      std::vector<Variable>&& inputs) override;
+
   std::string prettyString() const override;
 };
 
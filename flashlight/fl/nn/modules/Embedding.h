@@ -24,8 +24,13 @@ class Embedding : public UnaryModule {
 
   int embeddingDim_;
   int numEmbeddings_;
+  bool sparseGrad_{false};
 
-  FL_SAVE_LOAD_WITH_BASE(UnaryModule, embeddingDim_, numEmbeddings_)
+  FL_SAVE_LOAD_WITH_BASE(
+      UnaryModule,
+      embeddingDim_,
+      numEmbeddings_,
+      fl::versioned(sparseGrad_, 1))
 
   void initialize();
 
@@ -35,16 +40,20 @@ class Embedding : public UnaryModule {
    *
    * @param embeddingDim the size of each embedding vector
    * @param numEmbeddings the size of the dictionary of embeddings
+   * @param sparseGrad if true, the gradient of the embeddings only holds the
+   *  rows looked up by the batch (see `Variable::addSparseGrad`), which the
+   *  SGD, Adagrad and Adam optimizers update lazily
    */
-  Embedding(int embeddingDim, int numEmbeddings);
+  Embedding(int embeddingDim, int numEmbeddings, bool sparseGrad = false);
 
   /**
    * Constructs an Embedding module from the weight parameter \f$w\f$.
    *
    * @param w the 2D `Variable` tensor for the weight \f$w\f$.
    *  The shape should be [`embeddingDim`, `numEmbeddings`].
+   * @param sparseGrad if true, the gradient of the embeddings is row-sparse
    */
-  explicit Embedding(const Variable& w);
+  explicit Embedding(const Variable& w, bool sparseGrad = false);
 
   Variable forward(const Variable& input) override;
 
@@ -54,3 +63,4 @@ class Embedding : public UnaryModule {
 } // namespace fl
 
 CEREAL_REGISTER_TYPE(fl::Embedding)
+CEREAL_CLASS_VERSION(fl::Embedding, 1)
@@ -84,7 +84,7 @@ Variable LayerNorm::forward(const Variable& _input) {
     inputToBn = reorder(input, reorderDims);
   }
   auto paramsType =
-      (input.type() == fl::dtype::f16) ? fl::dtype::f32 : input.type();
+      isHalfPrecisionType(input.type()) ? fl::dtype::f32 : input.type();
   auto output = batchnorm(
       inputToBn,
       Variable(Tensor(paramsType), false),
@@ -139,6 +139,17 @@ void LayerNorm::initialize() {
   }
 }
 
+std::vector<int> LayerNorm::getAxis() const {
+  std::vector<int> axis;
+  for (int d = 0; d < kLnExpectedNumDims; ++d) {
+    if (std::find(axisComplement_.begin(), axisComplement_.end(), d) ==
+        axisComplement_.end()) {
+      axis.push_back(d);
+    }
+  }
+  return axis;
+}
+
 std::string LayerNorm::prettyString() const {
   std::ostringstream ss;
   ss << "LayerNorm";
@@ -71,6 +71,11 @@ class LayerNorm : public UnaryModule {
 
   Variable forward(const Variable& input) override;
 
+  /**
+   * Returns the axes along which normalization is computed.
+   */
+  std::vector<int> getAxis() const;
+
   std::string prettyString() const override;
 
  private:
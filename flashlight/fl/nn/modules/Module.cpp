@@ -53,6 +53,10 @@ void Module::eval() {
   }
 }
 
+bool Module::isTrain() const {
+  return train_;
+}
+
 std::vector<Variable> Module::params() const {
   return params_;
 }
@@ -61,6 +65,11 @@ std::vector<Variable> Module::operator()(const std::vector<Variable>& input) {
   return this->forward(input);
 }
 
+std::vector<Variable> Module::forwardReusingInputs(
+    std::vector<Variable>&& inputs) {
+  return this->forward(inputs);
+}
+
 UnaryModule::UnaryModule() = default;
 
 UnaryModule::UnaryModule(const std::vector<Variable>& params)
@@ -75,6 +75,13 @@ class Module {
    */
   virtual void eval();
 
+  /**
+   * Returns whether the module is in `train` mode.
+   *
+   * @return true if `train` was called last, false if `eval` was
+   */
+  bool isTrain() const;
+
   /**
    * Returns a module parameter given a particular position.
    *
@@ -122,6 +129,20 @@ class Module {
    */
   std::vector<Variable> operator()(const std::vector<Variable>& inputs);
 
+  /**
+   * Performs forward computation for the module on inputs which the caller
+   * doesn't use afterwards, so that in inference mode (see
+   * `InferenceModeGuard`) the module may reuse them for its outputs. Calls
+   * `forward` by default.
+   *
+   * @param inputs the values to compute forward computation for the
+   * module.
+   * @return a vector of `Variable` tensors containing the result of
+   * the forward computation
+   */
+  virtual std::vector<Variable> forwardReusingInputs(
+      std::vector<Variable>&& inputs);
+
   /**
    * Generates a stringified representation of the module.
    *
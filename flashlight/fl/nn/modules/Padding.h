@@ -42,6 +42,10 @@ class Padding : public UnaryModule {
 
   Variable forward(const Variable& input) override;
 
+  std::vector<std::pair<int, int>> getPadding() const;
+
+  double getPaddingValue() const;
+
   std::string prettyString() const override;
 };
 
@@ -108,6 +108,29 @@ std::tuple<Variable, Variable, Variable> RNN::operator()(
   return forward(input, hidden_state, cell_state);
 }
 
+std::tuple<Variable, Variable, Variable> RNN::forward(
+    const Variable& input,
+    const Tensor& lengths,
+    const Variable& hidden_state /* = Variable() */,
+    const Variable& cell_state /* = Variable() */) {
+  float dropProb = train_ ? dropProb_ : 0.0;
+  return rnn(
+      input,
+      hidden_state.astype(input.type()),
+      cell_state.astype(input.type()),
+      params_[0].astype(input.type()),
+      hiddenSize_,
+      numLayers_,
+      mode_,
+      bidirectional_,
+      dropProb,
+      lengths);
+}
+
+bool RNN::isBidirectional() const {
+  return bidirectional_;
+}
+
 std::string RNN::prettyString() const {
   std::ostringstream ss;
   switch (mode_) {
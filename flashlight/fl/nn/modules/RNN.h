@@ -139,6 +139,33 @@ class RNN : public Module {
       const Variable& hidden_state,
       const Variable& cell_state);
 
+  /** Forward the RNN Layer over a batch of padded sequences of different
+   * lengths, running the recurrence only over the valid steps of each sequence
+   * (see the packed sequence `rnn`, also for the cost of bidirectional RNNs).
+   * @param input Should be of shape [\f$X_{in}\f$, \f$N\f$, \f$T\f$]
+   * @param lengths Should be of shape [\f$N\f$]: the number of valid steps of
+   * each sequence, in any order (e.g. from `joinLengths`)
+   * @param hidden_state Should be of shape [\f$X_{out}\f$, \f$N\f$]. If an
+   * empty Variable is passed in then the hidden state is assumed zero.
+   * @param cell_state [LSTM only] Should be of shape [\f$X_{out}\f$,
+   * \f$N\f$]. If an empty Variable is passed in then the cell state is
+   * assumed zero.
+   * @returns An tuple of output Variables.
+   *  - The first element is the output of the RNN of shape [\f$X_{out}\f$,
+   *  \f$N\f$, \f$T\f$], zero at padded steps
+   *  - The second element is the hidden state at the last valid step of each
+   *  sequence, of shape [\f$X_{out}\f$, \f$N\f$]
+   *  - The third element is the cell state at the last valid step of each
+   *  sequence (LSTM only)
+   */
+  std::tuple<Variable, Variable, Variable> forward(
+      const Variable& input,
+      const Tensor& lengths,
+      const Variable& hidden_state = Variable(),
+      const Variable& cell_state = Variable());
+
+  bool isBidirectional() const;
+
   std::string prettyString() const override;
 };
 
@@ -26,6 +26,10 @@ Variable Reorder::forward(const Variable& input) {
   return reorder(input, shape_);
 }
 
+Shape Reorder::getShape() const {
+  return shape_;
+}
+
 std::string Reorder::prettyString() const {
   std::ostringstream ss;
   ss << "Reorder";
@@ -44,6 +44,8 @@ class Reorder : public UnaryModule {
 
   Variable forward(const Variable& input) override;
 
+  Shape getShape() const;
+
   std::string prettyString() const override;
 };
 
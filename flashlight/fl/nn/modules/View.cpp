@@ -22,6 +22,10 @@ Variable View::forward(const Variable& input) {
   return moddims(input, dims);
 }
 
+Shape View::getDims() const {
+  return dims_;
+}
+
 std::string View::prettyString() const {
   std::ostringstream ss;
   ss << "View (" << dims_ << ")";
@@ -42,6 +42,8 @@ class View : public UnaryModule {
 
   Variable forward(const Variable& input) override;
 
+  Shape getDims() const;
+
   std::string prettyString() const override;
 
   ~View() = default;
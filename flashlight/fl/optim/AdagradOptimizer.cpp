@@ -34,6 +34,24 @@ void AdagradOptimizer::step() {
       continue;
     }
 
+    if (parameters_[i].isSparseGrad()) {
+      const auto& sparseGrad = parameters_[i].sparseGrad();
+      const auto rows = sparseGrad.rowIndex();
+      const Tensor& grad = sparseGrad.values();
+      Tensor& data = parameters_[i].tensor();
+
+      Tensor rowData = data(rows);
+      if (wd_ != 0) {
+        rowData = rowData - wd_ * rowData;
+      }
+      Tensor rowVariance = variance_[i](rows) + grad * grad;
+      variance_[i](rows) = rowVariance;
+      fl::eval(variance_[i]);
+      data(rows) = rowData - lr_ * grad / (fl::sqrt(rowVariance) + eps_);
+      fl::eval(data);
+      continue;
+    }
+
     const Tensor& grad = parameters_[i].grad().tensor();
     Tensor& data = parameters_[i].tensor();
     Tensor& variance = variance_[i];
@@ -20,6 +20,9 @@ namespace fl {
  * [Adaptive Subgradient Methods for Online Learning and Stochastic
  * Optimization](
  *    http://www.jmlr.org/papers/volume12/duchi11a/duchi11a.pdf).
+ *
+ * Row-sparse gradients (see `Variable::addSparseGrad`) only update the rows
+ * they hold, weight decay included.
  */
 class AdagradOptimizer : public FirstOrderOptimizer {
  private:
@@ -53,6 +53,29 @@ void AdamOptimizer::step() {
       continue;
     }
 
+    if (parameters_[i].isSparseGrad()) {
+      const auto& sparseGrad = parameters_[i].sparseGrad();
+      const auto rows = sparseGrad.rowIndex();
+      const Tensor& grad = sparseGrad.values();
+      Tensor& data = parameters_[i].tensor();
+
+      Tensor rowData = data(rows);
+      if (wd_ != 0) {
+        rowData = rowData - wd_ * lr_ * rowData;
+      }
+      Tensor first = beta1_ * biasedFirst_[i](rows) + (1 - beta1_) * grad;
+      Tensor second =
+          beta2_ * biasedSecond_[i](rows) + (1 - beta2_) * grad * grad;
+      biasedFirst_[i](rows) = first;
+      biasedSecond_[i](rows) = second;
+      fl::eval(biasedFirst_[i]);
+      fl::eval(biasedSecond_[i]);
+
+      data(rows) = rowData - (correctedLr * first) / (fl::sqrt(second) + eps_);
+      fl::eval(data);
+      continue;
+    }
+
     const Tensor& grad = parameters_[i].grad().tensor();
     Tensor& data = parameters_[i].tensor();
 
@@ -19,6 +19,9 @@ namespace fl {
  * For more details see the paper
  * [Adam: A Method for Stochastic Optimization](
  *    https://arxiv.org/abs/1412.6980).
+ *
+ * Row-sparse gradients (see `Variable::addSparseGrad`) are applied lazily:
+ * only the moments and weights of the rows they hold are updated.
  */
 class AdamOptimizer : public FirstOrderOptimizer {
  private:
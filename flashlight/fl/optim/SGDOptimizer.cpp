@@ -41,6 +41,31 @@ void SGDOptimizer::step() {
       continue;
     }
 
+    if (parameters_[i].isSparseGrad()) {
+      const auto& sparseGrad = parameters_[i].sparseGrad();
+      const auto rows = sparseGrad.rowIndex();
+      Tensor& data = parameters_[i].tensor();
+      Tensor grad = sparseGrad.values();
+
+      if (wd_ != 0) {
+        grad = grad + wd_ * data(rows);
+      }
+
+      if (mu_ != 0) {
+        Tensor velocity = mu_ * velocities_[i](rows) + grad;
+        velocities_[i](rows) = velocity;
+        fl::eval(velocities_[i]);
+        if (useNesterov_) {
+          grad = grad + velocity * mu_;
+        } else {
+          grad = velocity;
+        }
+      }
+      data(rows) = data(rows) - lr_ * grad;
+      fl::eval(data);
+      continue;
+    }
+
     Tensor& grad = parameters_[i].grad().tensor();
     Tensor& data = parameters_[i].tensor();
 
@@ -27,6 +27,10 @@ namespace fl {
  *
  * Reference for SGD and Momentum:
  * http://cs231n.github.io/neural-networks-3/#sgd
+ *
+ * Row-sparse gradients (see `Variable::addSparseGrad`) are applied lazily:
+ * only the velocities and weights of the rows they hold are updated. The
+ * other rows skip the step, without any momentum or weight decay update.
  */
 class SGDOptimizer : public FirstOrderOptimizer {
  private:
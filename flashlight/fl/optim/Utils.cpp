@@ -19,7 +19,9 @@ double clipGradNorm(const std::vector<Variable>& parameters, double maxNorm) {
     if (!p.isGradAvailable()) {
       continue;
     }
-    const auto& grad = p.grad().tensor();
+    // row-sparse gradients are kept sparse
+    const auto& grad =
+        p.isSparseGrad() ? p.sparseGrad().values() : p.grad().tensor();
     gradNorm += fl::sum(grad * grad).asScalar<double>();
   }
   gradNorm = std::sqrt(gradNorm);
@@ -31,7 +33,11 @@ double clipGradNorm(const std::vector<Variable>& parameters, double maxNorm) {
     if (!p.isGradAvailable()) {
       continue;
     }
-    p.grad().tensor() *= scale;
+    if (p.isSparseGrad()) {
+      p.sparseGrad().values() *= scale;
+    } else {
+      p.grad().tensor() *= scale;
+    }
   }
   return gradNorm;
 }
@@ -16,6 +16,8 @@ class Device;
 
 enum class StreamType {
   CUDA, Synchronous,
+  // A SynchronousStream whose work runs asynchronously to the calling thread
+  Asynchronous,
 };
 
 /**
@@ -37,19 +39,20 @@ class Stream {
   /**
    * Get the underlying implementation of this stream.
    *
-   * Throws invalid_argument if the specified type does not match the actual
-   * derived stream type.
+   * Throws invalid_argument if this stream isn't of the specified type (or of
+   * a type derived from it).
    *
    * @return an immutable reference to the specified stream type.
    */
   template <typename T>
   const T& impl() const {
-    if (T::type != type()) {
+    const auto* derived = dynamic_cast<const T*>(this);
+    if (derived == nullptr) {
       throw std::invalid_argument(
           "[fl::Stream::impl] "
           "specified stream type doesn't match actual stream type.");
     }
-    return *(static_cast<const T*>(this));
+    return *derived;
   }
 
   /**
@@ -118,12 +121,13 @@ class StreamTrait : public Stream {
   }
 
   virtual void relativeSync(const Stream& waitOn) const override {
-    switch (waitOn.type()) {
-      case Derived::type: relativeSync(waitOn.impl<Derived>()); break;
-      default:
-        throw std::runtime_error(
-          "[Stream::relativeSync] Unsupported for different types of streams");
+    // not a switch over `waitOn.type()`, which derived streams may override
+    const auto* derived = dynamic_cast<const Derived*>(&waitOn);
+    if (derived == nullptr) {
+      throw std::runtime_error(
+        "[Stream::relativeSync] Unsupported for different types of streams");
     }
+    relativeSync(*derived);
   }
 };
 
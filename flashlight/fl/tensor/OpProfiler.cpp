@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/tensor/OpProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace fl {
+namespace {
+
+// The events of a thread, kept after the thread exits
+struct ThreadEvents {
+  std::mutex mutex;
+  std::vector<OpEvent> events;
+  int64_t thread;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadEvents>> threads;
+};
+
+Registry& registry() {
+  static Registry registry;
+  return registry;
+}
+
+ThreadEvents& threadEvents() {
+  thread_local std::shared_ptr<ThreadEvents> events = []() {
+    auto events = std::make_shared<ThreadEvents>();
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    events->thread = reg.threads.size();
+    reg.threads.push_back(events);
+    return events;
+  }();
+  return *events;
+}
+
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Start times are relative to the time the events were last cleared
+std::atomic<int64_t> epochNs{nowNs()};
+
+std::string shapesToString(const std::vector<Shape>& shapes) {
+  std::stringstream ss;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    ss << (i == 0 ? "" : ", ") << shapes[i];
+  }
+  return ss.str();
+}
+
+std::string typesToString(const std::vector<dtype>& types) {
+  std::stringstream ss;
+  for (size_t i = 0; i < types.size(); ++i) {
+    ss << (i == 0 ? "" : ", ") << dtypeToString(types[i]);
+  }
+  return ss.str();
+}
+
+std::string jsonEscape(const std::string& str) {
+  std::stringstream ss;
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        ss << "\\\"";
+        break;
+      case '\\':
+        ss << "\\\\";
+        break;
+      case '\n':
+        ss << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          ss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+             << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+          ss << c;
+        }
+    }
+  }
+  return ss.str();
+}
+
+} // namespace
+
+std::atomic<bool> OpProfiler::enabled_{false};
+
+void OpProfiler::enable() {
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void OpProfiler::disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void OpProfiler::clear() {
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (auto& thread : reg.threads) {
+    std::lock_guard<std::mutex> threadLock(thread->mutex);
+    thread->events.clear();
+  }
+  epochNs.store(nowNs());
+}
+
+std::vector<OpEvent> OpProfiler::events() {
+  std::vector<OpEvent> events;
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto& thread : reg.threads) {
+      std::lock_guard<std::mutex> threadLock(thread->mutex);
+      events.insert(
+          events.end(), thread->events.begin(), thread->events.end());
+    }
+  }
+  std::stable_sort(
+      events.begin(), events.end(), [](const OpEvent& a, const OpEvent& b) {
+        return a.startNs < b.startNs;
+      });
+  return events;
+}
+
+std::vector<OpSummary> OpProfiler::summarize(
+    size_t topN /* = 0 */,
+    bool groupByShapes /* = false */) {
+  // (name, category, shapes) -> summary
+  std::map<std::tuple<std::string, std::string, std::string>, OpSummary>
+      summaries;
+  for (const auto& event : events()) {
+    const auto shapes = groupByShapes ? shapesToString(event.shapes) : "";
+    auto& summary = summaries[{event.name, event.category, shapes}];
+    if (summary.count == 0) {
+      summary.name = groupByShapes && !shapes.empty()
+          ? event.name + " [" + shapes + "]"
+          : event.name;
+      summary.category = event.category;
+    }
+    ++summary.count;
+    summary.totalNs += event.durationNs;
+    summary.maxNs = std::max(summary.maxNs, event.durationNs);
+    summary.bytes += event.bytes;
+  }
+
+  std::vector<OpSummary> result;
+  result.reserve(summaries.size());
+  for (auto& [key, summary] : summaries) {
+    result.push_back(std::move(summary));
+  }
+  std::stable_sort(
+      result.begin(), result.end(), [](const OpSummary& a, const OpSummary& b) {
+        return a.totalNs > b.totalNs;
+      });
+  if (topN > 0 && result.size() > topN) {
+    result.resize(topN);
+  }
+  return result;
+}
+
+void OpProfiler::printSummary(
+    std::ostream& ostr,
+    size_t topN /* = 0 */,
+    bool groupByShapes /* = false */) {
+  const auto summaries = summarize(topN, groupByShapes);
+  int64_t totalNs = 0;
+  for (const auto& summary : summaries) {
+    totalNs += summary.totalNs;
+  }
+
+  const auto flags = ostr.flags();
+  const auto precision = ostr.precision();
+  ostr << std::fixed << std::setprecision(3);
+  ostr << std::left << std::setw(40) << "op" << std::setw(10) << "category"
+       << std::right << std::setw(10) << "calls" << std::setw(14)
+       << "total(ms)" << std::setw(12) << "mean(us)" << std::setw(12)
+       << "max(us)" << std::setw(10) << "%" << std::setw(14) << "MB out"
+       << std::endl;
+  for (const auto& summary : summaries) {
+    ostr << std::left << std::setw(40) << summary.name << std::setw(10)
+         << summary.category << std::right << std::setw(10) << summary.count
+         << std::setw(14) << summary.totalNs / 1e6 << std::setw(12)
+         << summary.totalNs / 1e3 / summary.count << std::setw(12)
+         << summary.maxNs / 1e3 << std::setw(10)
+         << (totalNs > 0 ? 100. * summary.totalNs / totalNs : 0.)
+         << std::setw(14) << summary.bytes / 1e6 << std::endl;
+  }
+  ostr.flags(flags);
+  ostr.precision(precision);
+}
+
+void OpProfiler::writeChromeTrace(std::ostream& ostr) {
+  // Timestamps and durations are in microseconds, with ns digits
+  const auto flags = ostr.flags();
+  const auto precision = ostr.precision();
+  ostr << std::fixed << std::setprecision(3);
+  ostr << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& event : events()) {
+    ostr << (first ? "\n" : ",\n");
+    first = false;
+    ostr << "{\"name\":\"" << jsonEscape(event.name) << "\",\"cat\":\""
+         << jsonEscape(event.category) << "\",\"ph\":\"X\",\"ts\":"
+         << event.startNs / 1e3 << ",\"dur\":" << event.durationNs / 1e3
+         << ",\"pid\":0,\"tid\":" << event.thread << ",\"args\":{\"shapes\":\""
+         << shapesToString(event.shapes) << "\",\"types\":\""
+         << typesToString(event.types) << "\",\"bytes\":" << event.bytes
+         << "}}";
+  }
+  ostr << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+  ostr.flags(flags);
+  ostr.precision(precision);
+}
+
+void OpProfiler::writeChromeTrace(const fs::path& path) {
+  std::ofstream ofs(path);
+  if (!ofs) {
+    throw std::runtime_error(
+        "OpProfiler::writeChromeTrace - can't open " + path.string());
+  }
+  writeChromeTrace(ofs);
+}
+
+namespace detail {
+
+void OpProfileScope::begin(
+    const char* name,
+    const char* category,
+    std::initializer_list<const Tensor*> inputs) {
+  event_.emplace();
+  event_->name = name;
+  event_->category = category;
+  event_->shapes.reserve(inputs.size());
+  for (const auto* input : inputs) {
+    event_->shapes.push_back(input->shape());
+    // Querying the type of a JIT tensor would evaluate it
+    if (input->backendType() != TensorBackendType::Jit) {
+      event_->types.push_back(input->type());
+    }
+  }
+  event_->startNs = nowNs();
+}
+
+void OpProfileScope::addOutput(const Tensor& tensor) {
+  if (tensor.backendType() != TensorBackendType::Jit) {
+    event_->bytes += tensor.bytes();
+  }
+}
+
+void OpProfileScope::end() {
+  const auto endNs = nowNs();
+  const auto epoch = epochNs.load();
+  event_->durationNs = endNs - event_->startNs;
+  event_->startNs -= epoch;
+  auto& events = threadEvents();
+  event_->thread = events.thread;
+  std::lock_guard<std::mutex> lock(events.mutex);
+  events.events.push_back(std::move(*event_));
+}
+
+} // namespace detail
+} // namespace fl
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/fl/tensor/Types.h"
+
+namespace fl {
+
+/**
+ * A timed op recorded by the `OpProfiler`.
+ */
+struct OpEvent {
+  std::string name;
+  // "tensor" for Tensor ops, "backward" for autograd gradient functions
+  std::string category;
+  std::vector<Shape> shapes;
+  // Empty for tensors whose type can't be queried without evaluating them
+  // (i.e., JIT tensors)
+  std::vector<dtype> types;
+  // Since the profiler was enabled
+  int64_t startNs{0};
+  int64_t durationNs{0};
+  // Size of the outputs
+  size_t bytes{0};
+  // Sequential id of the recording thread
+  int64_t thread{0};
+};
+
+/**
+ * The events of an op aggregated by the `OpProfiler`.
+ */
+struct OpSummary {
+  std::string name;
+  std::string category;
+  size_t count{0};
+  int64_t totalNs{0};
+  int64_t maxNs{0};
+  size_t bytes{0};
+};
+
+/**
+ * A CPU-side profiler of the ops dispatched to tensor backends and of the
+ * gradient functions run by autograd, which can be turned on and off at
+ * runtime. When disabled, profiling an op costs a relaxed atomic load.
+ *
+ * Ops are timed on the calling thread, so that the time of an op running
+ * asynchronously (e.g., on a GPU, or lazily with ArrayFire or the JIT
+ * backend) is that of dispatching it; call `fl::sync()` or evaluate tensors
+ * to attribute their computation. Ops nest: e.g., the time of a backward
+ * event includes that of the Tensor ops it runs.
+ *
+ * Example :
+ *
+ * \code{.cpp}
+ * fl::OpProfiler::enable();
+ * model->forward(input);
+ * fl::OpProfiler::disable();
+ * fl::OpProfiler::printSummary(std::cout, 20);
+ * fl::OpProfiler::writeChromeTrace("trace.json"); // open in chrome://tracing
+ * \endcode
+ */
+class OpProfiler {
+ public:
+  /**
+   * Start recording events, which are kept until `clear()`.
+   */
+  static void enable();
+
+  static void disable();
+
+  static bool isEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Discard the recorded events.
+   */
+  static void clear();
+
+  /**
+   * The events recorded by all threads, ordered by start time.
+   */
+  static std::vector<OpEvent> events();
+
+  /**
+   * The `topN` ops (all if 0) with the longest total time, aggregated by name
+   * and category, or by name, category and input shapes.
+   */
+  static std::vector<OpSummary> summarize(
+      size_t topN = 0,
+      bool groupByShapes = false);
+
+  /**
+   * Print the summary of the `topN` ops (all if 0) as a table.
+   */
+  static void printSummary(
+      std::ostream& ostr,
+      size_t topN = 0,
+      bool groupByShapes = false);
+
+  /**
+   * Write the recorded events in the Chrome trace event format, which can be
+   * viewed with chrome://tracing or Perfetto.
+   */
+  static void writeChromeTrace(std::ostream& ostr);
+  static void writeChromeTrace(const fs::path& path);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+namespace detail {
+
+/**
+ * Records an op with the `OpProfiler` over its lifetime if the profiler is
+ * enabled, and does nothing otherwise. For example:
+ *
+ * \code
+   Tensor exp(const Tensor& tensor) {
+     detail::OpProfileScope profile("exp", {&tensor});
+     return profile.output(tensor.backend().exp(tensor));
+   }
+ * \endcode
+ */
+class OpProfileScope {
+ public:
+  OpProfileScope(
+      const char* name,
+      std::initializer_list<const Tensor*> inputs,
+      const char* category = "tensor")
+      : enabled_(OpProfiler::isEnabled()) {
+    if (enabled_) {
+      begin(name, category, inputs);
+    }
+  }
+
+  ~OpProfileScope() {
+    if (enabled_) {
+      end();
+    }
+  }
+
+  OpProfileScope(const OpProfileScope&) = delete;
+  OpProfileScope& operator=(const OpProfileScope&) = delete;
+
+  /**
+   * Adds the size of `tensor` to the bytes output by the op.
+   */
+  Tensor output(Tensor&& tensor) {
+    if (enabled_) {
+      addOutput(tensor);
+    }
+    return std::move(tensor);
+  }
+
+  void output(const Tensor& tensor) {
+    if (enabled_) {
+      addOutput(tensor);
+    }
+  }
+
+ private:
+  const bool enabled_;
+  std::optional<OpEvent> event_;
+
+  void begin(
+      const char* name,
+      const char* category,
+      std::initializer_list<const Tensor*> inputs);
+  void addOutput(const Tensor& tensor);
+  void end();
+};
+
+} // namespace detail
+} // namespace fl
@@ -7,6 +7,8 @@
 
 #include "flashlight/fl/tensor/TensorBackend.h"
 
+#include <sstream>
+
 namespace fl {
 namespace detail {
 
@@ -14,6 +16,24 @@ bool areBackendsEqual(const Tensor& a, const Tensor& b) {
   return a.backendType() == b.backendType();
 }
 
+Shape fusedMatmulBiasShape(const Shape& biasShape, const Shape& productShape) {
+  std::vector<Dim> dims = biasShape.get();
+  bool broadcastable = dims.size() <= productShape.ndim();
+  if (broadcastable) {
+    dims.resize(productShape.ndim(), 1);
+    for (unsigned i = 0; i < dims.size(); ++i) {
+      broadcastable &= dims[i] == 1 || dims[i] == productShape[i];
+    }
+  }
+  if (!broadcastable) {
+    std::ostringstream oss;
+    oss << "fusedMatmul: bias of shape " << biasShape
+        << " can't be broadcast to the product of shape " << productShape;
+    throw std::invalid_argument(oss.str());
+  }
+  return Shape(dims);
+}
+
 } // namespace detail
 
 bool TensorBackend::isDataTypeSupported(const fl::dtype& dtype) const {
@@ -88,4 +108,45 @@ Tensor TensorBackend::power(const double& lhs, const Tensor& rhs) {
   return power(full(rhs.shape(), lhs, dtype_traits<double>::ctype), rhs);
 }
 
+Tensor TensorBackend::fusedMatmul(
+    const Tensor& lhs,
+    const Tensor& rhs,
+    const Tensor& bias,
+    MatrixProperty lhsProp,
+    MatrixProperty rhsProp,
+    double alpha,
+    double beta,
+    MatmulActivation activation) {
+  // scale the smaller operand rather than the product, which is usually
+  // larger, e.g., the scores of attention
+  const bool scaleLhs = alpha != 1 && lhs.elements() <= rhs.elements();
+  const bool scaleRhs = alpha != 1 && !scaleLhs;
+  auto result = matmul(
+      scaleLhs ? lhs * alpha : lhs,
+      scaleRhs ? rhs * alpha : rhs,
+      lhsProp,
+      rhsProp);
+  if (!bias.isEmpty() && beta != 0) {
+    const auto biasShape =
+        detail::fusedMatmulBiasShape(bias.shape(), result.shape());
+    std::vector<Dim> tileDims(biasShape.ndim());
+    for (unsigned i = 0; i < tileDims.size(); ++i) {
+      tileDims[i] = result.dim(i) / biasShape[i];
+    }
+    auto tiledBias = fl::tile(fl::reshape(bias, biasShape), Shape(tileDims));
+    result = result + (beta == 1 ? tiledBias : tiledBias * beta);
+  }
+  switch (activation) {
+    case MatmulActivation::None:
+      return result;
+    case MatmulActivation::Relu:
+      return fl::maximum(result, 0.0);
+    case MatmulActivation::Sigmoid:
+      return fl::sigmoid(result);
+    case MatmulActivation::Tanh:
+      return fl::tanh(result);
+  }
+  throw std::invalid_argument("fusedMatmul: unknown activation");
+}
+
 } // namespace fl
@@ -215,6 +215,16 @@ class TensorBackend {
       const Tensor& rhs,
       MatrixProperty lhsProp,
       MatrixProperty rhsProp) = 0;
+  // Defaults to the composition of the individual ops.
+  virtual Tensor fusedMatmul(
+      const Tensor& lhs,
+      const Tensor& rhs,
+      const Tensor& bias,
+      MatrixProperty lhsProp,
+      MatrixProperty rhsProp,
+      double alpha,
+      double beta,
+      MatmulActivation activation);
 
   /************************** Reductions ***************************/
   virtual Tensor
@@ -343,6 +353,15 @@ namespace detail {
  */
 bool areBackendsEqual(const Tensor& a, const Tensor& b);
 
+/**
+ * Get the shape to which the bias of `fusedMatmul` is reshaped, i.e., its
+ * shape padded with trailing 1s to the rank of the product.
+ *
+ * @throws std::invalid_argument if the bias can't be broadcast to the product
+ * @return the padded shape of the bias.
+ */
+Shape fusedMatmulBiasShape(const Shape& biasShape, const Shape& productShape);
+
 /**
  * Compare the backends of multiple tensors.
  *
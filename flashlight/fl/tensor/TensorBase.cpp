@@ -12,6 +12,7 @@
 #include <algorithm>
 
 #include "flashlight/fl/tensor/DefaultTensorType.h"
+#include "flashlight/fl/tensor/OpProfiler.h"
 #include "flashlight/fl/tensor/TensorAdapter.h"
 #include "flashlight/fl/tensor/TensorBackend.h"
 
@@ -68,7 +69,8 @@ Tensor::Tensor(fl::dtype type)
     : impl_(detail::getDefaultAdapter(Shape({0}), type)) {}
 
 Tensor Tensor::copy() const {
-  return impl_->copy();
+  detail::OpProfileScope profile("copy", {this});
+  return profile.output(impl_->copy());
 }
 
 Tensor Tensor::shallowCopy() const {
@@ -116,11 +118,13 @@ bool Tensor::isSparse() const {
 }
 
 Tensor Tensor::astype(const dtype type) const {
-  return impl_->astype(type);
+  detail::OpProfileScope profile("astype", {this});
+  return profile.output(impl_->astype(type));
 }
 
 Tensor Tensor::operator()(const std::vector<Index>& indices) const {
-  return impl_->index(indices);
+  detail::OpProfileScope profile("index", {this});
+  return profile.output(impl_->index(indices));
 }
 
 Tensor Tensor::flatten() const {
@@ -279,10 +283,12 @@ std::ostream& Tensor::operator<<(std::ostream& ostr) const {
 }
 
 /******************** Assignment Operators ********************/
-#define FL_ASSIGN_OP_TYPE(OP, FUN, TYPE) \
-  Tensor& Tensor::OP(TYPE val) {         \
-    impl_->FUN(val);                     \
-    return *this;                        \
+#define FL_ASSIGN_OP_TYPE(OP, FUN, TYPE)          \
+  Tensor& Tensor::OP(TYPE val) {                  \
+    detail::OpProfileScope profile(#FUN, {this}); \
+    impl_->FUN(val);                              \
+    profile.output(*this);                        \
+    return *this;                                 \
   }
 #define FL_ASSIGN_TENSOR_OP(OP, FUN) FL_ASSIGN_OP_TYPE(OP, FUN, const Tensor&);
 #define FL_ASSIGN_SCALAR_OP(OP, FUN)                 \
@@ -325,7 +331,9 @@ Tensor& Tensor::operator=(Tensor&& other) & {
 // Move assignment operator when `this` is a rvalue, e.g., `x(0) =
 // std::move(y)`. In such cases, we copy the data from `other` to `this`.
 Tensor& Tensor::operator=(Tensor&& other) && {
+  detail::OpProfileScope profile("assign", {this, &other});
   this->impl_->assign(other);
+  profile.output(*this);
   return *this;
 }
 
@@ -339,21 +347,25 @@ Tensor& Tensor::operator=(const Tensor& other) & {
 // Copy assignment operator when `this` is a lvalue, e.g., `x(0) = y`.
 // In such cases, we copy the data from `other` to `this`.
 Tensor& Tensor::operator=(const Tensor& other) && {
+  detail::OpProfileScope profile("assign", {this, &other});
   this->impl_->assign(other);
+  profile.output(*this);
   return *this;
 }
 
 /* --------------------------- Tensor Operators --------------------------- */
 
 /******************** Tensor Creation Functions ********************/
-#define FL_CREATE_FUN_LITERAL_TYPE(TYPE)                         \
-  template <>                                                    \
-  Tensor fromScalar(TYPE value, const dtype type) {              \
-    return defaultTensorBackend().fromScalar(value, type);       \
-  }                                                              \
-  template <>                                                    \
-  Tensor full(const Shape& dims, TYPE value, const dtype type) { \
-    return defaultTensorBackend().full(dims, value, type);       \
+#define FL_CREATE_FUN_LITERAL_TYPE(TYPE)                                    \
+  template <>                                                               \
+  Tensor fromScalar(TYPE value, const dtype type) {                         \
+    detail::OpProfileScope profile("fromScalar", {});                       \
+    return profile.output(defaultTensorBackend().fromScalar(value, type));  \
+  }                                                                         \
+  template <>                                                               \
+  Tensor full(const Shape& dims, TYPE value, const dtype type) {            \
+    detail::OpProfileScope profile("full", {});                             \
+    return profile.output(defaultTensorBackend().full(dims, value, type));  \
   }
 FL_CREATE_FUN_LITERAL_TYPE(const double&);
 FL_CREATE_FUN_LITERAL_TYPE(const float&);
@@ -371,7 +383,8 @@ FL_CREATE_FUN_LITERAL_TYPE(const unsigned short&);
 #undef FL_CREATE_FUN_LITERAL_TYPE
 
 Tensor identity(const Dim dim, const dtype type) {
-  return defaultTensorBackend().identity(dim, type);
+  detail::OpProfileScope profile("identity", {});
+  return profile.output(defaultTensorBackend().identity(dim, type));
 }
 
 #define FL_ARANGE_FUN_DEF(TYPE)                                             \
@@ -391,25 +404,30 @@ FL_ARANGE_FUN_DEF(const long long&);
 FL_ARANGE_FUN_DEF(const unsigned long long&);
 
 Tensor arange(const Shape& shape, const Dim seqDim, const dtype type) {
-  return defaultTensorBackend().arange(shape, seqDim, type);
+  detail::OpProfileScope profile("arange", {});
+  return profile.output(defaultTensorBackend().arange(shape, seqDim, type));
 }
 
 Tensor iota(const Shape& dims, const Shape& tileDims, const dtype type) {
-  return defaultTensorBackend().iota(dims, tileDims, type);
+  detail::OpProfileScope profile("iota", {});
+  return profile.output(defaultTensorBackend().iota(dims, tileDims, type));
 }
 
 /************************ Shaping and Indexing *************************/
 
 Tensor reshape(const Tensor& tensor, const Shape& shape) {
-  return tensor.backend().reshape(tensor, shape);
+  detail::OpProfileScope profile("reshape", {&tensor});
+  return profile.output(tensor.backend().reshape(tensor, shape));
 }
 
 Tensor transpose(const Tensor& tensor, const Shape& axes /* = {} */) {
-  return tensor.backend().transpose(tensor, axes);
+  detail::OpProfileScope profile("transpose", {&tensor});
+  return profile.output(tensor.backend().transpose(tensor, axes));
 }
 
 Tensor tile(const Tensor& tensor, const Shape& shape) {
-  return tensor.backend().tile(tensor, shape);
+  detail::OpProfileScope profile("tile", {&tensor});
+  return profile.output(tensor.backend().tile(tensor, shape));
 }
 
 Tensor concatenate(const std::vector<Tensor>& tensors, const unsigned axis) {
@@ -428,141 +446,173 @@ Tensor concatenate(const std::vector<Tensor>& tensors, const unsigned axis) {
         "concatenate: tried to concatenate tensors of different backends");
   }
 
-  return tensors.front().backend().concatenate(tensors, axis);
+  detail::OpProfileScope profile("concatenate", {});
+  return profile.output(tensors.front().backend().concatenate(tensors, axis));
 }
 
 Tensor nonzero(const Tensor& tensor) {
-  return tensor.backend().nonzero(tensor);
+  detail::OpProfileScope profile("nonzero", {&tensor});
+  return profile.output(tensor.backend().nonzero(tensor));
 }
 
 Tensor pad(
     const Tensor& input,
     const std::vector<std::pair<int, int>>& padWidths,
     const PadType type) {
-  return input.backend().pad(input, padWidths, type);
+  detail::OpProfileScope profile("pad", {&input});
+  return profile.output(input.backend().pad(input, padWidths, type));
 }
 
 /************************** Unary Operators ***************************/
 Tensor exp(const Tensor& tensor) {
-  return tensor.backend().exp(tensor);
+  detail::OpProfileScope profile("exp", {&tensor});
+  return profile.output(tensor.backend().exp(tensor));
 }
 
 Tensor log(const Tensor& tensor) {
-  return tensor.backend().log(tensor);
+  detail::OpProfileScope profile("log", {&tensor});
+  return profile.output(tensor.backend().log(tensor));
 }
 
 Tensor negative(const Tensor& tensor) {
-  return tensor.backend().negative(tensor);
+  detail::OpProfileScope profile("negative", {&tensor});
+  return profile.output(tensor.backend().negative(tensor));
 }
 
 Tensor logicalNot(const Tensor& tensor) {
-  return tensor.backend().logicalNot(tensor);
+  detail::OpProfileScope profile("logicalNot", {&tensor});
+  return profile.output(tensor.backend().logicalNot(tensor));
 }
 
 Tensor log1p(const Tensor& tensor) {
-  return tensor.backend().log1p(tensor);
+  detail::OpProfileScope profile("log1p", {&tensor});
+  return profile.output(tensor.backend().log1p(tensor));
 }
 
 Tensor sin(const Tensor& tensor) {
-  return tensor.backend().sin(tensor);
+  detail::OpProfileScope profile("sin", {&tensor});
+  return profile.output(tensor.backend().sin(tensor));
 }
 
 Tensor cos(const Tensor& tensor) {
-  return tensor.backend().cos(tensor);
+  detail::OpProfileScope profile("cos", {&tensor});
+  return profile.output(tensor.backend().cos(tensor));
 }
 
 Tensor sqrt(const Tensor& tensor) {
-  return tensor.backend().sqrt(tensor);
+  detail::OpProfileScope profile("sqrt", {&tensor});
+  return profile.output(tensor.backend().sqrt(tensor));
 }
 
 Tensor tanh(const Tensor& tensor) {
-  return tensor.backend().tanh(tensor);
+  detail::OpProfileScope profile("tanh", {&tensor});
+  return profile.output(tensor.backend().tanh(tensor));
 }
 
 Tensor floor(const Tensor& tensor) {
-  return tensor.backend().floor(tensor);
+  detail::OpProfileScope profile("floor", {&tensor});
+  return profile.output(tensor.backend().floor(tensor));
 }
 
 Tensor ceil(const Tensor& tensor) {
-  return tensor.backend().ceil(tensor);
+  detail::OpProfileScope profile("ceil", {&tensor});
+  return profile.output(tensor.backend().ceil(tensor));
 }
 
 Tensor rint(const Tensor& tensor) {
-  return tensor.backend().rint(tensor);
+  detail::OpProfileScope profile("rint", {&tensor});
+  return profile.output(tensor.backend().rint(tensor));
 }
 
 Tensor absolute(const Tensor& tensor) {
-  return tensor.backend().absolute(tensor);
+  detail::OpProfileScope profile("absolute", {&tensor});
+  return profile.output(tensor.backend().absolute(tensor));
 }
 
 Tensor sigmoid(const Tensor& tensor) {
-  return tensor.backend().sigmoid(tensor);
+  detail::OpProfileScope profile("sigmoid", {&tensor});
+  return profile.output(tensor.backend().sigmoid(tensor));
 }
 
 Tensor erf(const Tensor& tensor) {
-  return tensor.backend().erf(tensor);
+  detail::OpProfileScope profile("erf", {&tensor});
+  return profile.output(tensor.backend().erf(tensor));
 }
 
 Tensor flip(const Tensor& tensor, const unsigned dim) {
-  return tensor.backend().flip(tensor, dim);
+  detail::OpProfileScope profile("flip", {&tensor});
+  return profile.output(tensor.backend().flip(tensor, dim));
 }
 
 Tensor clip(const Tensor& tensor, const Tensor& low, const Tensor& high) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(tensor, low, high);
-  return tensor.backend().clip(tensor, low, high);
+  detail::OpProfileScope profile("clip", {&tensor, &low, &high});
+  return profile.output(tensor.backend().clip(tensor, low, high));
 }
 
 Tensor clip(const Tensor& tensor, const Tensor& low, const double& high) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(tensor, low);
-  return tensor.backend().clip(tensor, low, high);
+  detail::OpProfileScope profile("clip", {&tensor, &low});
+  return profile.output(tensor.backend().clip(tensor, low, high));
 }
 
 Tensor clip(const Tensor& tensor, const double& low, const Tensor& high) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(tensor, high);
-  return tensor.backend().clip(tensor, low, high);
+  detail::OpProfileScope profile("clip", {&tensor, &high});
+  return profile.output(tensor.backend().clip(tensor, low, high));
 }
 
 Tensor clip(const Tensor& tensor, const double& low, const double& high) {
-  return tensor.backend().clip(tensor, low, high);
+  detail::OpProfileScope profile("clip", {&tensor});
+  return profile.output(tensor.backend().clip(tensor, low, high));
 }
 
 Tensor roll(const Tensor& tensor, const int shift, const unsigned axis) {
-  return tensor.backend().roll(tensor, shift, axis);
+  detail::OpProfileScope profile("roll", {&tensor});
+  return profile.output(tensor.backend().roll(tensor, shift, axis));
 }
 
 Tensor isnan(const Tensor& tensor) {
-  return tensor.backend().isnan(tensor);
+  detail::OpProfileScope profile("isnan", {&tensor});
+  return profile.output(tensor.backend().isnan(tensor));
 }
 
 Tensor isinf(const Tensor& tensor) {
-  return tensor.backend().isinf(tensor);
+  detail::OpProfileScope profile("isinf", {&tensor});
+  return profile.output(tensor.backend().isinf(tensor));
 }
 
 Tensor sign(const Tensor& tensor) {
-  return tensor.backend().sign(tensor);
+  detail::OpProfileScope profile("sign", {&tensor});
+  return profile.output(tensor.backend().sign(tensor));
 }
 
 Tensor tril(const Tensor& tensor) {
-  return tensor.backend().tril(tensor);
+  detail::OpProfileScope profile("tril", {&tensor});
+  return profile.output(tensor.backend().tril(tensor));
 }
 
 Tensor triu(const Tensor& tensor) {
-  return tensor.backend().triu(tensor);
+  detail::OpProfileScope profile("triu", {&tensor});
+  return profile.output(tensor.backend().triu(tensor));
 }
 
 Tensor where(const Tensor& condition, const Tensor& x, const Tensor& y) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(condition, x, y);
-  return condition.backend().where(condition, x, y);
+  detail::OpProfileScope profile("where", {&condition, &x, &y});
+  return profile.output(condition.backend().where(condition, x, y));
 }
 
 Tensor where(const Tensor& condition, const Tensor& x, const double& y) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(condition, x);
-  return condition.backend().where(condition, x, y);
+  detail::OpProfileScope profile("where", {&condition, &x});
+  return profile.output(condition.backend().where(condition, x, y));
 }
 
 Tensor where(const Tensor& condition, const double& x, const Tensor& y) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(condition, y);
-  return condition.backend().where(condition, x, y);
+  detail::OpProfileScope profile("where", {&condition, &y});
+  return profile.output(condition.backend().where(condition, x, y));
 }
 
 void topk(
@@ -573,11 +623,15 @@ void topk(
     const Dim axis,
     const SortMode sortMode /* = SortMode::Descending */) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(values, indices, input);
+  detail::OpProfileScope profile("topk", {&input});
   input.backend().topk(values, indices, input, k, axis, sortMode);
+  profile.output(values);
+  profile.output(indices);
 }
 
 Tensor sort(const Tensor& input, const Dim axis, const SortMode sortMode) {
-  return input.backend().sort(input, axis, sortMode);
+  detail::OpProfileScope profile("sort", {&input});
+  return profile.output(input.backend().sort(input, axis, sortMode));
 }
 
 void sort(
@@ -586,26 +640,32 @@ void sort(
     const Tensor& input,
     const Dim axis,
     const SortMode sortMode /* = SortMode::Descending */) {
-  return values.backend().sort(values, indices, input, axis, sortMode);
+  detail::OpProfileScope profile("sort", {&input});
+  values.backend().sort(values, indices, input, axis, sortMode);
+  profile.output(values);
+  profile.output(indices);
 }
 
 Tensor argsort(const Tensor& input, const Dim axis, const SortMode sortMode) {
-  return input.backend().argsort(input, axis, sortMode);
+  detail::OpProfileScope profile("argsort", {&input});
+  return profile.output(input.backend().argsort(input, axis, sortMode));
 }
 
 /************************** Binary Operators ***************************/
-#define FL_BINARY_OP_LITERAL_TYPE_DEF(OP, FUNC, TYPE) \
-  Tensor FUNC(TYPE lhs, const Tensor& rhs) {          \
-    return rhs.backend().FUNC(lhs, rhs);              \
-  }                                                   \
-  Tensor FUNC(const Tensor& lhs, TYPE rhs) {          \
-    return lhs.backend().FUNC(lhs, rhs);              \
-  }                                                   \
-  Tensor operator OP(TYPE lhs, const Tensor& rhs) {   \
-    return FUNC(lhs, rhs);                            \
-  }                                                   \
-  Tensor operator OP(const Tensor& lhs, TYPE rhs) {   \
-    return FUNC(lhs, rhs);                            \
+#define FL_BINARY_OP_LITERAL_TYPE_DEF(OP, FUNC, TYPE)          \
+  Tensor FUNC(TYPE lhs, const Tensor& rhs) {                   \
+    detail::OpProfileScope profile(#FUNC, {&rhs});             \
+    return profile.output(rhs.backend().FUNC(lhs, rhs));       \
+  }                                                            \
+  Tensor FUNC(const Tensor& lhs, TYPE rhs) {                   \
+    detail::OpProfileScope profile(#FUNC, {&lhs});             \
+    return profile.output(lhs.backend().FUNC(lhs, rhs));       \
+  }                                                            \
+  Tensor operator OP(TYPE lhs, const Tensor& rhs) {            \
+    return FUNC(lhs, rhs);                                     \
+  }                                                            \
+  Tensor operator OP(const Tensor& lhs, TYPE rhs) {            \
+    return FUNC(lhs, rhs);                                     \
   }
 
 #define FL_BINARY_OP_LITERALS_DEF(OP, FUNC)                           \
@@ -626,7 +686,8 @@ Tensor argsort(const Tensor& input, const Dim axis, const SortMode sortMode) {
 #define FL_BINARY_OP_DEF(OP, FUNC)                           \
   Tensor FUNC(const Tensor& lhs, const Tensor& rhs) {        \
     FL_TENSOR_BACKENDS_MATCH_CHECK(lhs, rhs);                \
-    return lhs.backend().FUNC(lhs, rhs);                     \
+    detail::OpProfileScope profile(#FUNC, {&lhs, &rhs});     \
+    return profile.output(lhs.backend().FUNC(lhs, rhs));     \
   }                                                          \
   Tensor operator OP(const Tensor& lhs, const Tensor& rhs) { \
     return FUNC(lhs, rhs);                                   \
@@ -658,41 +719,50 @@ FL_BINARY_OP_DEF(>>, rShift);
 
 Tensor minimum(const Tensor& lhs, const Tensor& rhs) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(lhs, rhs);
-  return lhs.backend().minimum(lhs, rhs);
+  detail::OpProfileScope profile("minimum", {&lhs, &rhs});
+  return profile.output(lhs.backend().minimum(lhs, rhs));
 }
 
 Tensor maximum(const Tensor& lhs, const Tensor& rhs) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(lhs, rhs);
-  return lhs.backend().maximum(lhs, rhs);
+  detail::OpProfileScope profile("maximum", {&lhs, &rhs});
+  return profile.output(lhs.backend().maximum(lhs, rhs));
 }
 
 Tensor minimum(const Tensor& lhs, const double& rhs) {
-  return lhs.backend().minimum(lhs, rhs);
+  detail::OpProfileScope profile("minimum", {&lhs});
+  return profile.output(lhs.backend().minimum(lhs, rhs));
 }
 
 Tensor minimum(const double& lhs, const Tensor& rhs) {
-  return rhs.backend().minimum(lhs, rhs);
+  detail::OpProfileScope profile("minimum", {&rhs});
+  return profile.output(rhs.backend().minimum(lhs, rhs));
 }
 
 Tensor maximum(const Tensor& lhs, const double& rhs) {
-  return lhs.backend().maximum(lhs, rhs);
+  detail::OpProfileScope profile("maximum", {&lhs});
+  return profile.output(lhs.backend().maximum(lhs, rhs));
 }
 
 Tensor maximum(const double& lhs, const Tensor& rhs) {
-  return rhs.backend().maximum(lhs, rhs);
+  detail::OpProfileScope profile("maximum", {&rhs});
+  return profile.output(rhs.backend().maximum(lhs, rhs));
 }
 
 Tensor power(const Tensor& lhs, const Tensor& rhs) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(lhs, rhs);
-  return lhs.backend().power(lhs, rhs);
+  detail::OpProfileScope profile("power", {&lhs, &rhs});
+  return profile.output(lhs.backend().power(lhs, rhs));
 }
 
 Tensor power(const Tensor& lhs, const double& rhs) {
-  return lhs.backend().power(lhs, rhs);
+  detail::OpProfileScope profile("power", {&lhs});
+  return profile.output(lhs.backend().power(lhs, rhs));
 }
 
 Tensor power(const double& lhs, const Tensor& rhs) {
-  return rhs.backend().power(lhs, rhs);
+  detail::OpProfileScope profile("power", {&rhs});
+  return profile.output(rhs.backend().power(lhs, rhs));
 }
 
 /******************************* BLAS ********************************/
@@ -702,7 +772,26 @@ Tensor matmul(
     MatrixProperty lhsProp,
     MatrixProperty rhsProp) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(lhs, rhs);
-  return lhs.backend().matmul(lhs, rhs, lhsProp, rhsProp);
+  detail::OpProfileScope profile("matmul", {&lhs, &rhs});
+  return profile.output(lhs.backend().matmul(lhs, rhs, lhsProp, rhsProp));
+}
+
+Tensor fusedMatmul(
+    const Tensor& lhs,
+    const Tensor& rhs,
+    const Tensor& bias,
+    MatrixProperty lhsProp,
+    MatrixProperty rhsProp,
+    double alpha,
+    double beta,
+    MatmulActivation activation) {
+  FL_TENSOR_BACKENDS_MATCH_CHECK(lhs, rhs);
+  if (!bias.isEmpty()) {
+    FL_TENSOR_BACKENDS_MATCH_CHECK(lhs, bias);
+  }
+  detail::OpProfileScope profile("fusedMatmul", {&lhs, &rhs, &bias});
+  return profile.output(lhs.backend().fusedMatmul(
+      lhs, rhs, bias, lhsProp, rhsProp, alpha, beta, activation));
 }
 
 /************************** Reductions ***************************/
@@ -711,14 +800,16 @@ Tensor amin(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().amin(input, axes, keepDims);
+  detail::OpProfileScope profile("amin", {&input});
+  return profile.output(input.backend().amin(input, axes, keepDims));
 }
 
 Tensor amax(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().amax(input, axes, keepDims);
+  detail::OpProfileScope profile("amax", {&input});
+  return profile.output(input.backend().amax(input, axes, keepDims));
 }
 
 void min(
@@ -728,7 +819,10 @@ void min(
     const unsigned axis,
     const bool keepDims) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(values, indices, input);
-  return input.backend().min(values, indices, input, axis, keepDims);
+  detail::OpProfileScope profile("min", {&input});
+  input.backend().min(values, indices, input, axis, keepDims);
+  profile.output(values);
+  profile.output(indices);
 }
 
 void max(
@@ -738,46 +832,55 @@ void max(
     const unsigned axis,
     const bool keepDims /* = false */) {
   FL_TENSOR_BACKENDS_MATCH_CHECK(values, indices, input);
-  return input.backend().max(values, indices, input, axis, keepDims);
+  detail::OpProfileScope profile("max", {&input});
+  input.backend().max(values, indices, input, axis, keepDims);
+  profile.output(values);
+  profile.output(indices);
 }
 
 Tensor sum(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().sum(input, axes, keepDims);
+  detail::OpProfileScope profile("sum", {&input});
+  return profile.output(input.backend().sum(input, axes, keepDims));
 }
 
 Tensor cumsum(const Tensor& input, const unsigned axis) {
-  return input.backend().cumsum(input, axis);
+  detail::OpProfileScope profile("cumsum", {&input});
+  return profile.output(input.backend().cumsum(input, axis));
 }
 
 Tensor argmax(
     const Tensor& input,
     const unsigned axis,
     const bool keepDims /* = false */) {
-  return input.backend().argmax(input, axis, keepDims);
+  detail::OpProfileScope profile("argmax", {&input});
+  return profile.output(input.backend().argmax(input, axis, keepDims));
 }
 
 Tensor argmin(
     const Tensor& input,
     const unsigned axis,
     const bool keepDims /* = false */) {
-  return input.backend().argmin(input, axis, keepDims);
+  detail::OpProfileScope profile("argmin", {&input});
+  return profile.output(input.backend().argmin(input, axis, keepDims));
 }
 
 Tensor mean(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().mean(input, axes, keepDims);
+  detail::OpProfileScope profile("mean", {&input});
+  return profile.output(input.backend().mean(input, axes, keepDims));
 }
 
 Tensor median(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().median(input, axes, keepDims);
+  detail::OpProfileScope profile("median", {&input});
+  return profile.output(input.backend().median(input, axes, keepDims));
 }
 
 Tensor var(
@@ -785,14 +888,16 @@ Tensor var(
     const std::vector<int>& axes /* = {} */,
     const bool bias,
     const bool keepDims /* = false */) {
-  return input.backend().var(input, axes, bias, keepDims);
+  detail::OpProfileScope profile("var", {&input});
+  return profile.output(input.backend().var(input, axes, bias, keepDims));
 }
 
 Tensor std(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().std(input, axes, keepDims);
+  detail::OpProfileScope profile("std", {&input});
+  return profile.output(input.backend().std(input, axes, keepDims));
 }
 
 Tensor norm(
@@ -800,28 +905,32 @@ Tensor norm(
     const std::vector<int>& axes /* = {} */,
     double p /* = 2 */,
     const bool keepDims /* = false */) {
-  return input.backend().norm(input, axes, p, keepDims);
+  detail::OpProfileScope profile("norm", {&input});
+  return profile.output(input.backend().norm(input, axes, p, keepDims));
 }
 
 Tensor countNonzero(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().countNonzero(input, axes, keepDims);
+  detail::OpProfileScope profile("countNonzero", {&input});
+  return profile.output(input.backend().countNonzero(input, axes, keepDims));
 }
 
 Tensor any(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().any(input, axes, keepDims);
+  detail::OpProfileScope profile("any", {&input});
+  return profile.output(input.backend().any(input, axes, keepDims));
 }
 
 Tensor all(
     const Tensor& input,
     const std::vector<int>& axes /* = {} */,
     const bool keepDims /* = false */) {
-  return input.backend().all(input, axes, keepDims);
+  detail::OpProfileScope profile("all", {&input});
+  return profile.output(input.backend().all(input, axes, keepDims));
 }
 
 /************************** Utilities ***************************/
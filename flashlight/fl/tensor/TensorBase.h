@@ -457,6 +457,7 @@ class Tensor {
     // Implicitly cast to the requested return type
     switch (type()) {
       case dtype::f16:
+      case dtype::bf16:
         return astype(dtype::f32).scalar<float>();
       case dtype::f32:
         return scalar<float>();
@@ -1383,6 +1384,46 @@ Tensor matmul(
     MatrixProperty lhsProp = MatrixProperty::None,
     MatrixProperty rhsProp = MatrixProperty::None);
 
+/*!
+ * Element-wise activations which can be applied to the result of
+ * `fusedMatmul`.
+ */
+enum class MatmulActivation { None = 0, Relu = 1, Sigmoid = 2, Tanh = 3 };
+
+/**
+ * Perform matrix multiplication between two tensors, followed by scaling, the
+ * addition of a bias and an activation, i.e.
+ *
+ *   activation(alpha * matmul(lhs, rhs, lhsProp, rhsProp) + beta * bias)
+ *
+ * Backends may compute all of it as a single op, without materializing the
+ * intermediate products.
+ *
+ * @param[in] lhs the Tensor on the left hand side
+ * @param[in] rhs the Tensor on the right hand side
+ * @param[in] bias the Tensor to add to the product, or an empty Tensor for no
+ * bias. It is broadcast to the shape of the product: its shape is padded with
+ * trailing 1s, after which each dimension must be 1 or match the product's.
+ * @param[in] lhsProp the `MatrixProperty` to apply to the tensor on the
+ * left-hand side
+ * @param[in] rhsProp the `MatrixProperty` to apply to the tensor on the
+ * right-hand side
+ * @param[in] alpha the scale of the product
+ * @param[in] beta the scale of the bias
+ * @param[in] activation the activation to apply to the result
+ *
+ * @return an output tensor containing the result.
+ */
+Tensor fusedMatmul(
+    const Tensor& lhs,
+    const Tensor& rhs,
+    const Tensor& bias,
+    MatrixProperty lhsProp = MatrixProperty::None,
+    MatrixProperty rhsProp = MatrixProperty::None,
+    double alpha = 1,
+    double beta = 1,
+    MatmulActivation activation = MatmulActivation::None);
+
 /************************** Reductions ***************************/
 
 /**
@@ -7,6 +7,7 @@
 
 #include "flashlight/fl/tensor/Types.h"
 
+#include <cstdint>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -24,6 +25,7 @@ const std::unordered_map<dtype, std::string> kTypeToString = {
     {dtype::u16, "u16"},
     {dtype::u32, "u32"},
     {dtype::u64, "u64"},
+    {dtype::bf16, "bf16"},
 };
 
 const std::unordered_map<std::string, dtype> kStringToType = {
@@ -38,12 +40,13 @@ const std::unordered_map<std::string, dtype> kStringToType = {
     {"u16", dtype::u16},
     {"u32", dtype::u32},
     {"u64", dtype::u64},
+    {"bf16", dtype::bf16},
 };
 
 size_t getTypeSize(dtype type) {
   switch (type) {
     case dtype::f16:
-      return sizeof(float) / 2;
+      return sizeof(uint16_t);
     case dtype::f32:
       return sizeof(float);
     case dtype::f64:
@@ -64,6 +67,8 @@ size_t getTypeSize(dtype type) {
       return sizeof(unsigned);
     case dtype::u64:
       return sizeof(unsigned long long);
+    case dtype::bf16:
+      return sizeof(uint16_t);
     default:
       throw std::invalid_argument("getTypeSize - invalid type queried.");
   }
@@ -85,4 +90,8 @@ std::ostream& operator<<(std::ostream& ostr, const dtype& s) {
   return ostr;
 }
 
+bool isHalfPrecisionType(dtype type) {
+  return type == dtype::f16 || type == dtype::bf16;
+}
+
 } // namespace fl
@@ -23,7 +23,8 @@ enum class dtype {
   u8 = 7, // 8-bit unsigned integer
   u16 = 8, // 16-bit unsigned integer
   u32 = 9, // 32-bit unsigned integer
-  u64 = 10 // 64-bit unsigned integer
+  u64 = 10, // 64-bit unsigned integer
+  bf16 = 11 // 16-bit brain float (8-bit exponent, 7-bit mantissa)
   // TODO: add support for complex-valued tensors? (AF)
 };
 
@@ -53,6 +54,13 @@ fl::dtype stringToDtype(const std::string& string);
  */
 std::ostream& operator<<(std::ostream& ostr, const dtype& s);
 
+/**
+ * Returns whether the type is a 16-bit floating point type (f16 or bf16).
+ *
+ * @param[in] type the input type to query.
+ */
+bool isHalfPrecisionType(dtype type);
+
 template <typename T>
 struct dtype_traits;
 
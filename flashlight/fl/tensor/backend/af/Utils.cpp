@@ -30,7 +30,13 @@ af::dtype flToAfType(fl::dtype type) {
           {fl::dtype::u16, af::dtype::u16},
           {fl::dtype::u32, af::dtype::u32},
           {fl::dtype::u64, af::dtype::u64}};
-  return kFlashlightTypeToArrayFire.at(type);
+  auto iter = kFlashlightTypeToArrayFire.find(type);
+  if (iter == kFlashlightTypeToArrayFire.end()) {
+    throw std::invalid_argument(
+        "flToAfType: type " + dtypeToString(type) +
+        " doesn't have an ArrayFire analog");
+  }
+  return iter->second;
 }
 
 fl::dtype afToFlType(af::dtype type) {
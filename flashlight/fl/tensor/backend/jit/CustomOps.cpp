@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/tensor/backend/jit/CustomOps.h"
+
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "flashlight/fl/tensor/TensorBase.h"
+
+namespace fl {
+
+namespace {
+
+using EvalFunc = CustomNode::EvalFunc;
+
+// Decodes the attributes encoded by `CustomOpAttributesBuilder`
+class AttributesReader {
+  const std::string& name_;
+  const CustomNode::Attributes& attributes_;
+  size_t nextInt_{0};
+  size_t nextReal_{0};
+
+  long long nextInt() {
+    if (nextInt_ >= attributes_.ints.size()) {
+      throw std::invalid_argument(
+          "[makeCustomOpEvalFunc] Missing attributes for custom op " + name_);
+    }
+    return attributes_.ints[nextInt_++];
+  }
+
+ public:
+  AttributesReader(
+      const std::string& name,
+      const CustomNode::Attributes& attributes)
+      : name_(name), attributes_(attributes) {}
+
+  template <typename T>
+  T next() {
+    return static_cast<T>(nextInt());
+  }
+
+  double nextReal() {
+    if (nextReal_ >= attributes_.reals.size()) {
+      throw std::invalid_argument(
+          "[makeCustomOpEvalFunc] Missing attributes for custom op " + name_);
+    }
+    return attributes_.reals[nextReal_++];
+  }
+
+  Shape nextShape() {
+    std::vector<Dim> dims(nextInt());
+    for (auto& dim : dims) {
+      dim = nextInt();
+    }
+    return Shape(dims);
+  }
+
+  std::vector<int> nextInts() {
+    std::vector<int> values(nextInt());
+    for (auto& value : values) {
+      value = nextInt();
+    }
+    return values;
+  }
+
+  std::vector<std::pair<int, int>> nextIntPairs() {
+    std::vector<std::pair<int, int>> values(nextInt());
+    for (auto& value : values) {
+      value.first = nextInt();
+      value.second = nextInt();
+    }
+    return values;
+  }
+};
+
+using CustomOpFactory =
+    std::function<EvalFunc(TensorBackend& backend, AttributesReader& attrs)>;
+
+#define FL_JIT_CUSTOM_OP_UNARY(OP)                                   \
+  {                                                                  \
+    #OP, [](TensorBackend& backend, AttributesReader&) -> EvalFunc { \
+      return [&backend](const std::vector<const Tensor*>& inputs) {  \
+        return backend.OP(*inputs.at(0));                            \
+      };                                                             \
+    }                                                                \
+  }
+
+#define FL_JIT_CUSTOM_OP_REDUCTION(OP)                                     \
+  {                                                                        \
+    #OP, [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc { \
+      const auto axes = attrs.nextInts();                                  \
+      const auto keepDims = attrs.next<bool>();                            \
+      return [&backend, axes, keepDims](                                   \
+                 const std::vector<const Tensor*>& inputs) {               \
+        return backend.OP(*inputs.at(0), axes, keepDims);                  \
+      };                                                                   \
+    }                                                                      \
+  }
+
+const std::unordered_map<std::string, CustomOpFactory>& customOps() {
+  static const std::unordered_map<std::string, CustomOpFactory> ops = {
+      /******************** Tensor Creation Functions ********************/
+      {"randn",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto shape = attrs.nextShape();
+         const auto type = attrs.next<dtype>();
+         return [&backend, shape, type](const std::vector<const Tensor*>&) {
+           return backend.randn(shape, type);
+         };
+       }},
+      {"rand",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto shape = attrs.nextShape();
+         const auto type = attrs.next<dtype>();
+         return [&backend, shape, type](const std::vector<const Tensor*>&) {
+           return backend.rand(shape, type);
+         };
+       }},
+      {"arange",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto shape = attrs.nextShape();
+         const auto seqDim = attrs.next<Dim>();
+         const auto type = attrs.next<dtype>();
+         return [&backend, shape, seqDim, type](
+                    const std::vector<const Tensor*>&) {
+           return backend.arange(shape, seqDim, type);
+         };
+       }},
+      /************************ Shaping and Indexing *************************/
+      {"reshape",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto shape = attrs.nextShape();
+         return [&backend, shape](const std::vector<const Tensor*>& inputs) {
+           return backend.reshape(*inputs.at(0), shape);
+         };
+       }},
+      {"transpose",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axes = attrs.nextShape();
+         return [&backend, axes](const std::vector<const Tensor*>& inputs) {
+           return backend.transpose(*inputs.at(0), axes);
+         };
+       }},
+      {"tile",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto tileDims = attrs.nextShape();
+         return [&backend, tileDims](const std::vector<const Tensor*>& inputs) {
+           return backend.tile(*inputs.at(0), tileDims);
+         };
+       }},
+      {"concatenate",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axis = attrs.next<unsigned>();
+         return [&backend, axis](const std::vector<const Tensor*>& inputs) {
+           // TODO use shallowcopy here
+           std::vector<Tensor> inputTensors;
+           for (const auto* inputPtr : inputs) {
+             inputTensors.emplace_back(inputPtr->copy());
+           }
+           return backend.concatenate(inputTensors, axis);
+         };
+       }},
+      {"pad",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto padWidths = attrs.nextIntPairs();
+         const auto type = attrs.next<PadType>();
+         return [&backend, padWidths, type](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.pad(*inputs.at(0), padWidths, type);
+         };
+       }},
+      {"astype",
+       [](TensorBackend&, AttributesReader& attrs) -> EvalFunc {
+         const auto type = attrs.next<dtype>();
+         return [type](const std::vector<const Tensor*>& inputs) {
+           return inputs.at(0)->astype(type);
+         };
+       }},
+      {"flatten",
+       [](TensorBackend&, AttributesReader&) -> EvalFunc {
+         return [](const std::vector<const Tensor*>& inputs) {
+           return inputs.at(0)->flatten();
+         };
+       }},
+      {"asContiguousTensor",
+       [](TensorBackend&, AttributesReader&) -> EvalFunc {
+         return [](const std::vector<const Tensor*>& inputs) {
+           return inputs.at(0)->asContiguousTensor();
+         };
+       }},
+      /************************** Unary Operators ***************************/
+      FL_JIT_CUSTOM_OP_UNARY(exp),
+      FL_JIT_CUSTOM_OP_UNARY(log),
+      FL_JIT_CUSTOM_OP_UNARY(negative),
+      FL_JIT_CUSTOM_OP_UNARY(logicalNot),
+      FL_JIT_CUSTOM_OP_UNARY(log1p),
+      FL_JIT_CUSTOM_OP_UNARY(sin),
+      FL_JIT_CUSTOM_OP_UNARY(cos),
+      FL_JIT_CUSTOM_OP_UNARY(sqrt),
+      FL_JIT_CUSTOM_OP_UNARY(tanh),
+      FL_JIT_CUSTOM_OP_UNARY(floor),
+      FL_JIT_CUSTOM_OP_UNARY(ceil),
+      FL_JIT_CUSTOM_OP_UNARY(rint),
+      FL_JIT_CUSTOM_OP_UNARY(absolute),
+      FL_JIT_CUSTOM_OP_UNARY(sigmoid),
+      FL_JIT_CUSTOM_OP_UNARY(erf),
+      FL_JIT_CUSTOM_OP_UNARY(isnan),
+      FL_JIT_CUSTOM_OP_UNARY(isinf),
+      FL_JIT_CUSTOM_OP_UNARY(sign),
+      FL_JIT_CUSTOM_OP_UNARY(tril),
+      FL_JIT_CUSTOM_OP_UNARY(triu),
+      {"flip",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto dim = attrs.next<unsigned>();
+         return [&backend, dim](const std::vector<const Tensor*>& inputs) {
+           return backend.flip(*inputs.at(0), dim);
+         };
+       }},
+      {"clip",
+       [](TensorBackend& backend, AttributesReader&) -> EvalFunc {
+         return [&backend](const std::vector<const Tensor*>& inputs) {
+           return backend.clip(*inputs.at(0), *inputs.at(1), *inputs.at(2));
+         };
+       }},
+      {"roll",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto shift = attrs.next<int>();
+         const auto axis = attrs.next<unsigned>();
+         return [&backend, shift, axis](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.roll(*inputs.at(0), shift, axis);
+         };
+       }},
+      {"where",
+       [](TensorBackend& backend, AttributesReader&) -> EvalFunc {
+         return [&backend](const std::vector<const Tensor*>& inputs) {
+           return backend.where(*inputs.at(0), *inputs.at(1), *inputs.at(2));
+         };
+       }},
+      {"sort",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axis = attrs.next<Dim>();
+         const auto sortMode = attrs.next<SortMode>();
+         return [&backend, axis, sortMode](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.sort(*inputs.at(0), axis, sortMode);
+         };
+       }},
+      {"argsort",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axis = attrs.next<Dim>();
+         const auto sortMode = attrs.next<SortMode>();
+         return [&backend, axis, sortMode](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.argsort(*inputs.at(0), axis, sortMode);
+         };
+       }},
+      /************************** BLAS ***************************/
+      {"matmul",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto lhsProp = attrs.next<MatrixProperty>();
+         const auto rhsProp = attrs.next<MatrixProperty>();
+         return [&backend, lhsProp, rhsProp](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.matmul(
+               *inputs.at(0), *inputs.at(1), lhsProp, rhsProp);
+         };
+       }},
+      /************************** Reductions ***************************/
+      FL_JIT_CUSTOM_OP_REDUCTION(amin),
+      FL_JIT_CUSTOM_OP_REDUCTION(amax),
+      FL_JIT_CUSTOM_OP_REDUCTION(sum),
+      FL_JIT_CUSTOM_OP_REDUCTION(mean),
+      FL_JIT_CUSTOM_OP_REDUCTION(median),
+      FL_JIT_CUSTOM_OP_REDUCTION(std),
+      FL_JIT_CUSTOM_OP_REDUCTION(countNonzero),
+      FL_JIT_CUSTOM_OP_REDUCTION(any),
+      FL_JIT_CUSTOM_OP_REDUCTION(all),
+      {"cumsum",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axis = attrs.next<unsigned>();
+         return [&backend, axis](const std::vector<const Tensor*>& inputs) {
+           return backend.cumsum(*inputs.at(0), axis);
+         };
+       }},
+      {"argmax",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axis = attrs.next<unsigned>();
+         const auto keepDims = attrs.next<bool>();
+         return [&backend, axis, keepDims](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.argmax(*inputs.at(0), axis, keepDims);
+         };
+       }},
+      {"argmin",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axis = attrs.next<unsigned>();
+         const auto keepDims = attrs.next<bool>();
+         return [&backend, axis, keepDims](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.argmin(*inputs.at(0), axis, keepDims);
+         };
+       }},
+      {"var",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axes = attrs.nextInts();
+         const auto bias = attrs.next<bool>();
+         const auto keepDims = attrs.next<bool>();
+         return [&backend, axes, bias, keepDims](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.var(*inputs.at(0), axes, bias, keepDims);
+         };
+       }},
+      {"norm",
+       [](TensorBackend& backend, AttributesReader& attrs) -> EvalFunc {
+         const auto axes = attrs.nextInts();
+         const auto p = attrs.nextReal();
+         const auto keepDims = attrs.next<bool>();
+         return [&backend, axes, p, keepDims](
+                    const std::vector<const Tensor*>& inputs) {
+           return backend.norm(*inputs.at(0), axes, p, keepDims);
+         };
+       }},
+  };
+  return ops;
+}
+
+#undef FL_JIT_CUSTOM_OP_UNARY
+#undef FL_JIT_CUSTOM_OP_REDUCTION
+
+} // namespace
+
+CustomNode::EvalFunc makeCustomOpEvalFunc(
+    TensorBackend& backend,
+    const std::string& name,
+    const CustomNode::Attributes& attributes) {
+  const auto& ops = customOps();
+  const auto it = ops.find(name);
+  if (it == ops.end()) {
+    throw std::invalid_argument(
+        "[makeCustomOpEvalFunc] Unknown custom op " + name);
+  }
+  AttributesReader reader(name, attributes);
+  return it->second(backend, reader);
+}
+
+CustomNode* createCustomOpNode(
+    TensorBackend& backend,
+    std::string&& name,
+    std::vector<Node*>&& inputs,
+    const Shape& shape,
+    CustomNode::Attributes&& attributes /* = {} */) {
+  auto evalFunc = makeCustomOpEvalFunc(backend, name, attributes);
+  return CustomNode::create(
+      std::move(name),
+      std::move(inputs),
+      shape,
+      std::move(evalFunc),
+      std::move(attributes));
+}
+
+CustomOpAttributesBuilder& CustomOpAttributesBuilder::add(const Shape& shape) {
+  add(shape.ndim());
+  for (const auto dim : shape.get()) {
+    add(dim);
+  }
+  return *this;
+}
+
+CustomOpAttributesBuilder& CustomOpAttributesBuilder::add(
+    const std::vector<int>& values) {
+  add(values.size());
+  for (const auto value : values) {
+    add(value);
+  }
+  return *this;
+}
+
+CustomOpAttributesBuilder& CustomOpAttributesBuilder::add(
+    const std::vector<std::pair<int, int>>& values) {
+  add(values.size());
+  for (const auto& [first, second] : values) {
+    add(first);
+    add(second);
+  }
+  return *this;
+}
+
+CustomOpAttributesBuilder& CustomOpAttributesBuilder::addReal(
+    const double value) {
+  attributes_.reals.push_back(value);
+  return *this;
+}
+
+CustomNode::Attributes CustomOpAttributesBuilder::build() {
+  return std::move(attributes_);
+}
+
+} // namespace fl
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/TensorBackend.h"
+#include "flashlight/fl/tensor/backend/jit/ir/CustomNode.h"
+
+namespace fl {
+
+/**
+ * Custom ops are the Tensor operations without a dedicated IR node, which the
+ * JIT captures as `CustomNode`s named after the op (e.g., "matmul"). The
+ * non-tensor arguments of an op are its attributes, so that its evaluation
+ * logic can be rebuilt from the name and attributes alone.
+ *
+ * Return the evaluation logic of custom op `name` with `attributes`, which
+ * dispatches to `backend`.
+ *
+ * @throws std::invalid_argument if the op is unknown or the attributes don't
+ * match it.
+ */
+CustomNode::EvalFunc makeCustomOpEvalFunc(
+    TensorBackend& backend,
+    const std::string& name,
+    const CustomNode::Attributes& attributes);
+
+/**
+ * Create a node evaluating custom op `name` with `attributes` on `backend`.
+ */
+CustomNode* createCustomOpNode(
+    TensorBackend& backend,
+    std::string&& name,
+    std::vector<Node*>&& inputs,
+    const Shape& shape,
+    CustomNode::Attributes&& attributes = {});
+
+/**
+ * Encodes the attributes of a custom op, in the order in which the op reads
+ * them. Lists are prefixed by their size.
+ */
+class CustomOpAttributesBuilder {
+  CustomNode::Attributes attributes_;
+
+ public:
+  // integers, booleans and enums
+  template <typename T>
+  CustomOpAttributesBuilder& add(const T value) {
+    attributes_.ints.push_back(static_cast<long long>(value));
+    return *this;
+  }
+
+  CustomOpAttributesBuilder& add(const Shape& shape);
+  CustomOpAttributesBuilder& add(const std::vector<int>& values);
+  CustomOpAttributesBuilder& add(
+      const std::vector<std::pair<int, int>>& values);
+  CustomOpAttributesBuilder& addReal(const double value);
+
+  CustomNode::Attributes build();
+};
+
+} // namespace fl
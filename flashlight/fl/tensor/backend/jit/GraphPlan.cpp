@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/tensor/backend/jit/GraphPlan.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "flashlight/fl/tensor/DefaultTensorType.h"
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/fl/tensor/backend/jit/CustomOps.h"
+#include "flashlight/fl/tensor/backend/jit/JitTensor.h"
+#include "flashlight/fl/tensor/backend/jit/ir/BinaryNode.h"
+#include "flashlight/fl/tensor/backend/jit/ir/CustomNode.h"
+#include "flashlight/fl/tensor/backend/jit/ir/IndexNode.h"
+#include "flashlight/fl/tensor/backend/jit/ir/IndexedUpdateNode.h"
+#include "flashlight/fl/tensor/backend/jit/ir/ScalarNode.h"
+#include "flashlight/fl/tensor/backend/jit/ir/ValueNode.h"
+#include "flashlight/fl/tensor/backend/jit/opt/Optimizer.h"
+
+namespace fl {
+
+namespace {
+
+// The placeholder inputs of the graph being captured by this thread, if any
+thread_local const std::unordered_set<Node*>* capturePlaceholders = nullptr;
+
+bool dependsOnAny(Node* root, const std::unordered_set<Node*>& leaves) {
+  std::unordered_set<Node*> visited;
+  std::vector<Node*> stack = {root};
+  while (!stack.empty()) {
+    Node* node = stack.back();
+    stack.pop_back();
+    if (leaves.count(node)) {
+      return true;
+    }
+    if (visited.insert(node).second) {
+      stack.insert(stack.end(), node->inputs().begin(), node->inputs().end());
+    }
+  }
+  return false;
+}
+
+/**
+ * JIT tensors of a graph being captured, whose graphs are only rewritten by
+ * backend-agnostic passes, so that every node can be saved in a plan (e.g.,
+ * the backend may fuse nodes into kernels which can't be saved). Backend
+ * passes are applied when the plan is run.
+ */
+template <typename T>
+class CaptureJitTensor : public JitTensor<T> {
+ protected:
+  Tensor fromSharedData(
+      std::shared_ptr<JitTensorBase::SharedData> sharedData) const override {
+    return toTensor<CaptureJitTensor>(sharedData);
+  }
+
+  Optimizer& optimizer() const override {
+    static Optimizer optimizer(
+        this->wrappedBackend(), /* backendPasses = */ false);
+    return optimizer;
+  }
+
+  // The data of a tensor computed from the placeholder inputs isn't known
+  // while capturing: reading it would bake a value into the plan
+  void onMaterialize() const override {
+    if (capturePlaceholders &&
+        dependsOnAny(this->node(), *capturePlaceholders)) {
+      throw std::invalid_argument(
+          "[captureGraph] Can't read the data of a tensor computed from the "
+          "inputs (e.g., with host reads, nonzero, topk, or sort, min or max "
+          "with indices) while capturing a graph");
+    }
+  }
+
+ public:
+  JitBackend& backend() const override {
+    auto creator = [](Node* node) { return toTensor<CaptureJitTensor>(node); };
+    static JitBackend backend(this->wrappedBackend(), creator);
+    return backend;
+  }
+
+  using JitTensor<T>::JitTensor;
+
+  std::unique_ptr<TensorAdapterBase> clone() const override {
+    return std::make_unique<CaptureJitTensor>(this->node());
+  }
+};
+
+using CaptureTensorType = CaptureJitTensor<DefaultTensorType_t>;
+
+TensorBackend& captureWrappedBackend() {
+  static TensorBackend& backend = toTensor<DefaultTensorType_t>().backend();
+  return backend;
+}
+
+// Index encoding: the number of indices, then the type of each index followed
+// by its literal value or range.
+void encodeIndices(
+    const std::vector<Index>& indices,
+    std::vector<long long>& ints) {
+  ints.push_back(indices.size());
+  for (const auto& index : indices) {
+    ints.push_back(static_cast<long long>(index.type()));
+    switch (index.type()) {
+      case detail::IndexType::Literal:
+        ints.push_back(index.get<Dim>());
+        break;
+      case detail::IndexType::Range: {
+        const auto& rangeIdx = index.get<range>();
+        ints.push_back(rangeIdx.start());
+        ints.push_back(rangeIdx.end().has_value());
+        ints.push_back(rangeIdx.end().value_or(0));
+        ints.push_back(rangeIdx.stride());
+        break;
+      }
+      case detail::IndexType::Span:
+        break;
+      case detail::IndexType::Tensor:
+        throw std::invalid_argument(
+            "[GraphPlan::fromGraph] Tensor indices are not supported");
+    }
+  }
+}
+
+// Decodes the indices at `ints[pos]`, moving `pos` past them
+std::vector<Index> decodeIndices(
+    const std::vector<long long>& ints,
+    size_t& pos) {
+  std::vector<Index> indices;
+  const auto numIndices = ints.at(pos++);
+  for (long long i = 0; i < numIndices; ++i) {
+    switch (static_cast<detail::IndexType>(ints.at(pos++))) {
+      case detail::IndexType::Literal:
+        indices.emplace_back(static_cast<Dim>(ints.at(pos++)));
+        break;
+      case detail::IndexType::Range: {
+        const Dim start = ints.at(pos++);
+        const bool hasEnd = ints.at(pos++);
+        const Dim end = ints.at(pos++);
+        const Dim stride = ints.at(pos++);
+        indices.emplace_back(
+            hasEnd ? range(start, end, stride)
+                   : range(start, fl::end, stride));
+        break;
+      }
+      case detail::IndexType::Span:
+        indices.emplace_back(span);
+        break;
+      default:
+        throw std::invalid_argument(
+            "[GraphPlanRunner] Invalid index in graph plan");
+    }
+  }
+  return indices;
+}
+
+// The nodes of the graphs of `roots`, each after its inputs
+std::vector<Node*> topologicalOrder(const std::vector<Node*>& roots) {
+  std::vector<Node*> order;
+  std::unordered_set<Node*> visited;
+  // (node, whether its inputs have been pushed)
+  std::vector<std::pair<Node*, bool>> stack;
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+    stack.emplace_back(*it, false);
+  }
+  while (!stack.empty()) {
+    auto [node, expanded] = stack.back();
+    stack.pop_back();
+    if (expanded) {
+      order.push_back(node);
+      continue;
+    }
+    if (!visited.insert(node).second) {
+      continue;
+    }
+    stack.emplace_back(node, true);
+    const auto& inputs = node->inputs();
+    for (auto it = inputs.rbegin(); it != inputs.rend(); ++it) {
+      if (visited.find(*it) == visited.end()) {
+        stack.emplace_back(*it, false);
+      }
+    }
+  }
+  return order;
+}
+
+} // namespace
+
+GraphPlan GraphPlan::fromGraph(
+    const std::vector<Node*>& inputs,
+    const std::vector<dtype>& inputTypes,
+    const std::vector<Node*>& outputs) {
+  if (inputs.size() != inputTypes.size()) {
+    throw std::invalid_argument(
+        "[GraphPlan::fromGraph] Expected a type for every input");
+  }
+  std::unordered_map<Node*, uint32_t> inputIdx;
+  for (uint32_t i = 0; i < inputs.size(); ++i) {
+    inputIdx.emplace(inputs[i], i);
+  }
+
+  GraphPlan plan;
+  plan.inputTypes_ = inputTypes;
+  plan.inputSteps_.resize(inputs.size());
+  std::vector<Node*> roots = outputs;
+  // inputs which outputs don't depend on are still inputs of the plan
+  roots.insert(roots.end(), inputs.begin(), inputs.end());
+  std::unordered_map<Node*, uint32_t> nodeToStep;
+  for (Node* node : topologicalOrder(roots)) {
+    Step step;
+    step.shape = node->shape();
+    for (Node* input : node->inputs()) {
+      step.inputs.push_back(nodeToStep.at(input));
+    }
+    const auto inputIt = inputIdx.find(node);
+    if (inputIt != inputIdx.end()) {
+      step.kind = StepKind::Input;
+      step.id = inputIt->second;
+      step.inputs.clear();
+      plan.inputSteps_[inputIt->second] = plan.steps_.size();
+    } else {
+      switch (node->type()) {
+        case NodeType::Value:
+          step.kind = StepKind::Value;
+          step.id = plan.constants_.size();
+          plan.constants_.push_back(node->impl<ValueNode>().value());
+          break;
+        case NodeType::Scalar: {
+          const auto& scalarNode = node->impl<ScalarNode>();
+          step.kind = StepKind::Scalar;
+          step.id = static_cast<int64_t>(scalarNode.dataType());
+          switch (scalarNode.dataType()) {
+            case dtype::f16:
+            case dtype::bf16:
+            case dtype::f32:
+            case dtype::f64:
+              step.reals.push_back(scalarNode.scalar<double>());
+              break;
+            case dtype::u64:
+              step.ints.push_back(static_cast<long long>(
+                  scalarNode.scalar<unsigned long long>()));
+              break;
+            default:
+              step.ints.push_back(scalarNode.scalar<long long>());
+          }
+          break;
+        }
+        case NodeType::Binary:
+          step.kind = StepKind::Binary;
+          step.id = static_cast<int64_t>(node->impl<BinaryNode>().op());
+          break;
+        case NodeType::Custom: {
+          const auto& customNode = node->impl<CustomNode>();
+          if (!customNode.attributes().has_value()) {
+            throw std::invalid_argument(
+                "[GraphPlan::fromGraph] Custom node " + customNode.name() +
+                " isn't a custom op and can't be saved");
+          }
+          step.kind = StepKind::Custom;
+          step.name = customNode.name();
+          step.ints = customNode.attributes()->ints;
+          step.reals = customNode.attributes()->reals;
+          break;
+        }
+        case NodeType::Index:
+          step.kind = StepKind::Index;
+          encodeIndices(node->impl<IndexNode>().indices(), step.ints);
+          break;
+        case NodeType::IndexedUpdate: {
+          const auto& indexings = node->impl<IndexedUpdateNode>().indexings();
+          step.kind = StepKind::IndexedUpdate;
+          step.ints.push_back(indexings.size());
+          for (const auto& indices : indexings) {
+            encodeIndices(indices, step.ints);
+          }
+          break;
+        }
+      }
+    }
+    nodeToStep.emplace(node, plan.steps_.size());
+    plan.steps_.push_back(std::move(step));
+  }
+  for (Node* output : outputs) {
+    plan.outputSteps_.push_back(nodeToStep.at(output));
+  }
+  return plan;
+}
+
+void GraphPlan::save(const fs::path& filepath) const {
+  fl::save(filepath, *this);
+}
+
+GraphPlan GraphPlan::load(const fs::path& filepath) {
+  GraphPlan plan;
+  fl::load(filepath, plan);
+  return plan;
+}
+
+GraphPlan captureGraph(
+    const std::vector<Shape>& inputShapes,
+    const std::vector<dtype>& inputTypes,
+    const std::function<std::vector<Tensor>(const std::vector<Tensor>&)>&
+        func) {
+  if (!inputTypes.empty() && inputTypes.size() != inputShapes.size()) {
+    throw std::invalid_argument(
+        "[captureGraph] Expected as many input types as input shapes");
+  }
+  std::vector<Tensor> inputs;
+  std::vector<Node*> inputNodes;
+  std::vector<dtype> types;
+  for (size_t i = 0; i < inputShapes.size(); ++i) {
+    const auto type = inputTypes.empty() ? dtype::f32 : inputTypes[i];
+    // placeholders, whose data can't be read (see `onMaterialize`)
+    inputs.push_back(toTensor<CaptureTensorType>(ValueNode::create(
+        captureWrappedBackend().full(inputShapes[i], 0, type))));
+    inputNodes.push_back(toJitTensorBase(inputs.back()).node());
+    types.push_back(type);
+  }
+
+  // like `withTensorType`, restoring the default tensor type on errors too
+  auto& defaultTensorType = detail::DefaultTensorType::getInstance();
+  auto oldCreator = defaultTensorType.swap(
+      std::make_unique<detail::TensorCreatorImpl<CaptureTensorType>>());
+  const std::unordered_set<Node*> placeholders(
+      inputNodes.begin(), inputNodes.end());
+  capturePlaceholders = &placeholders;
+  std::vector<Tensor> outputs;
+  try {
+    outputs = func(inputs);
+  } catch (...) {
+    capturePlaceholders = nullptr;
+    defaultTensorType.swap(std::move(oldCreator));
+    throw;
+  }
+  capturePlaceholders = nullptr;
+  defaultTensorType.swap(std::move(oldCreator));
+
+  // backend passes are deferred to GraphPlanRunner
+  Optimizer optimizer(captureWrappedBackend(), /* backendPasses = */ false);
+  std::vector<Node*> outputNodes;
+  for (const auto& output : outputs) {
+    Node* node = toJitTensorBase(output).node();
+    Node* optimized = optimizer.optimize(node);
+    optimized->incRefCount();
+    outputNodes.push_back(optimized);
+  }
+  try {
+    auto plan = GraphPlan::fromGraph(inputNodes, types, outputNodes);
+    for (Node* node : outputNodes) {
+      node->decRefCount();
+    }
+    return plan;
+  } catch (...) {
+    for (Node* node : outputNodes) {
+      node->decRefCount();
+    }
+    throw;
+  }
+}
+
+Tensor captureConstant(const Tensor& tensor) {
+  if (tensor.backendType() == TensorBackendType::Jit) {
+    return toTensor<CaptureTensorType>(toJitTensorBase(tensor).node());
+  }
+  return toTensor<CaptureTensorType>(ValueNode::create(Tensor(tensor)));
+}
+
+GraphPlanRunner::GraphPlanRunner(const GraphPlan& plan)
+    : backend_(defaultTensorBackend()), evaluator_(backend_) {
+  const auto& steps = plan.steps();
+  std::vector<Node*> stepNodes;
+  for (const auto& step : steps) {
+    std::vector<Node*> inputs;
+    for (const auto input : step.inputs) {
+      inputs.push_back(stepNodes.at(input));
+    }
+    Node* node = nullptr;
+    switch (step.kind) {
+      case GraphPlan::StepKind::Input:
+        // the result of an input is set by `run`
+        node = CustomNode::create(
+            "input",
+            {},
+            step.shape,
+            [](const std::vector<const Tensor*>& /* inputs */) -> Tensor {
+              throw std::logic_error("[GraphPlanRunner] Unbound input");
+            });
+        break;
+      case GraphPlan::StepKind::Value:
+        node = ValueNode::create(Tensor(plan.constants().at(step.id)));
+        break;
+      case GraphPlan::StepKind::Scalar: {
+        const auto type = static_cast<dtype>(step.id);
+        if (!step.reals.empty()) {
+          node = ScalarNode::create(step.shape, type, step.reals.at(0));
+        } else if (type == dtype::u64) {
+          node = ScalarNode::create(
+              step.shape,
+              type,
+              static_cast<unsigned long long>(step.ints.at(0)));
+        } else {
+          node = ScalarNode::create(step.shape, type, step.ints.at(0));
+        }
+        break;
+      }
+      case GraphPlan::StepKind::Binary:
+        node = BinaryNode::create(
+            inputs.at(0), inputs.at(1), static_cast<BinaryOp>(step.id));
+        break;
+      case GraphPlan::StepKind::Custom:
+        node = createCustomOpNode(
+            backend_,
+            std::string(step.name),
+            std::move(inputs),
+            step.shape,
+            {step.ints, step.reals});
+        break;
+      case GraphPlan::StepKind::Index: {
+        size_t pos = 0;
+        node = IndexNode::create(inputs.at(0), decodeIndices(step.ints, pos));
+        break;
+      }
+      case GraphPlan::StepKind::IndexedUpdate: {
+        size_t pos = 0;
+        std::vector<std::vector<Index>> indexings(step.ints.at(pos++));
+        for (auto& indices : indexings) {
+          indices = decodeIndices(step.ints, pos);
+        }
+        node = IndexedUpdateNode::create(inputs.at(0), indexings, inputs.at(1));
+        break;
+      }
+    }
+    stepNodes.push_back(node);
+  }
+
+  for (const auto step : plan.inputSteps()) {
+    inputNodes_.push_back(stepNodes.at(step));
+    inputNodes_.back()->incRefCount();
+    inputShapes_.push_back(steps.at(step).shape);
+  }
+  inputTypes_ = plan.inputTypes();
+  Optimizer optimizer(backend_);
+  for (const auto step : plan.outputSteps()) {
+    Node* node = stepNodes.at(step);
+    node->incRefCount();
+    Node* optimized = optimizer.optimize(node);
+    if (optimized != node) {
+      optimized->incRefCount();
+      node->decRefCount();
+    }
+    outputNodes_.push_back(optimized);
+  }
+  std::vector<Node*> roots = outputNodes_;
+  roots.insert(roots.end(), inputNodes_.begin(), inputNodes_.end());
+  nodes_ = topologicalOrder(roots);
+}
+
+GraphPlanRunner::~GraphPlanRunner() {
+  clearResults();
+  for (Node* node : outputNodes_) {
+    node->decRefCount();
+  }
+  for (Node* node : inputNodes_) {
+    node->decRefCount();
+  }
+}
+
+void GraphPlanRunner::clearResults() {
+  for (Node* node : nodes_) {
+    if (!node->isValue() && node->getResult().has_value()) {
+      node->unsetResult();
+    }
+  }
+}
+
+std::vector<Tensor> GraphPlanRunner::run(const std::vector<Tensor>& inputs) {
+  if (inputs.size() != inputNodes_.size()) {
+    throw std::invalid_argument(
+        "[GraphPlanRunner::run] Expected " +
+        std::to_string(inputNodes_.size()) + " inputs, got " +
+        std::to_string(inputs.size()));
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (inputs[i].shape() != inputShapes_[i] ||
+        inputs[i].type() != inputTypes_[i]) {
+      std::ostringstream oss;
+      oss << "[GraphPlanRunner::run] Input " << i << " has shape "
+          << inputs[i].shape() << " and type " << inputs[i].type()
+          << ", expected shape " << inputShapes_[i] << " and type "
+          << inputTypes_[i];
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Tensor> outputs;
+  try {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      inputNodes_[i]->setResult(Tensor(inputs[i]));
+    }
+    for (Node* node : outputNodes_) {
+      evaluator_.eval(node);
+      outputs.push_back(node->getResult().value());
+    }
+  } catch (...) {
+    clearResults();
+    throw;
+  }
+  clearResults();
+  return outputs;
+}
+
+} // namespace fl
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/common/Serialization.h"
+#include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/TensorBackend.h"
+#include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/fl/tensor/backend/jit/eval/Evaluator.h"
+#include "flashlight/fl/tensor/backend/jit/ir/Node.h"
+
+#include <cereal/types/string.hpp>
+
+namespace fl {
+
+/**
+ * A serializable plan of a JIT graph, which computes some outputs from some
+ * inputs of fixed shapes and types. The graph is captured once (see
+ * `captureGraph`), optimized with the backend-agnostic JIT passes, and saved
+ * with its constants (e.g., module parameters), so that it can be loaded and
+ * run by a `GraphPlanRunner` without capturing it again.
+ */
+class GraphPlan {
+ public:
+  enum class StepKind {
+    Input,
+    Value,
+    Scalar,
+    Binary,
+    Custom,
+    Index,
+    IndexedUpdate,
+  };
+
+  /**
+   * A node of the graph. Steps are topologically sorted: a step only takes
+   * the results of earlier steps as inputs.
+   */
+  struct Step {
+    StepKind kind;
+    std::vector<uint32_t> inputs;
+    Shape shape;
+    // The plan input of an Input step, the constant of a Value step, the op
+    // of a Binary step and the type of a Scalar step.
+    int64_t id{0};
+    // The op of a Custom step
+    std::string name;
+    // The attributes of a Custom step, the value of a Scalar step and the
+    // indices of Index and IndexedUpdate steps.
+    std::vector<long long> ints;
+    std::vector<double> reals;
+
+   private:
+    FL_SAVE_LOAD(kind, inputs, shape, id, name, ints, reals)
+  };
+
+  GraphPlan() = default;
+
+  /**
+   * Builds the plan of the graph computing `outputs` from `inputs`, where
+   * every other leaf is a constant.
+   *
+   * @throws std::invalid_argument if the graph has nodes which can't be
+   * rebuilt from a plan, i.e., custom nodes which aren't custom ops (see
+   * `CustomOps.h`) and tensor indices.
+   */
+  static GraphPlan fromGraph(
+      const std::vector<Node*>& inputs,
+      const std::vector<dtype>& inputTypes,
+      const std::vector<Node*>& outputs);
+
+  void save(const fs::path& filepath) const;
+  static GraphPlan load(const fs::path& filepath);
+
+  const std::vector<Step>& steps() const {
+    return steps_;
+  }
+
+  const std::vector<uint32_t>& inputSteps() const {
+    return inputSteps_;
+  }
+
+  const std::vector<dtype>& inputTypes() const {
+    return inputTypes_;
+  }
+
+  const std::vector<uint32_t>& outputSteps() const {
+    return outputSteps_;
+  }
+
+  const std::vector<Tensor>& constants() const {
+    return constants_;
+  }
+
+ private:
+  std::vector<Step> steps_;
+  std::vector<uint32_t> inputSteps_;
+  std::vector<dtype> inputTypes_;
+  std::vector<uint32_t> outputSteps_;
+  std::vector<Tensor> constants_;
+
+  FL_SAVE_LOAD(steps_, inputSteps_, inputTypes_, outputSteps_, constants_)
+};
+
+/**
+ * Captures the JIT graph of `func`, called with placeholder inputs of the
+ * given shapes and types (f32 if not given). While `func` runs, tensors are
+ * created as JIT tensors wrapping the default tensor type, whose graphs are
+ * only rewritten by backend-agnostic passes; `func` returns the outputs.
+ *
+ * Tensors which `func` doesn't compute from its inputs become constants of the
+ * plan. Results which the backend materializes eagerly because their shapes
+ * depend on data (e.g., `nonzero`, `topk` and `sort` with indices) and host
+ * reads can't be captured when they depend on the inputs.
+ *
+ * @throws std::invalid_argument if `func` reads the data of a tensor
+ * computed from its inputs, e.g., with one of these ops.
+ */
+GraphPlan captureGraph(
+    const std::vector<Shape>& inputShapes,
+    const std::vector<dtype>& inputTypes,
+    const std::function<std::vector<Tensor>(const std::vector<Tensor>&)>&
+        func);
+
+/**
+ * A constant of the graph being captured, with the value of `tensor`; for
+ * tensors of other backends (e.g., module parameters) used by `captureGraph`.
+ */
+Tensor captureConstant(const Tensor& tensor);
+
+/**
+ * Runs a `GraphPlan` on the default tensor backend. The graph is rebuilt
+ * once and optimized with all JIT passes, including those of the backend
+ * (e.g., op fusion), then evaluated for each set of inputs.
+ *
+ * Runs are serialized, so that a runner can be shared by threads; use one
+ * runner per thread to run a plan concurrently.
+ */
+class GraphPlanRunner {
+  TensorBackend& backend_;
+  Evaluator evaluator_;
+  std::vector<Node*> inputNodes_;
+  std::vector<Shape> inputShapes_;
+  std::vector<dtype> inputTypes_;
+  std::vector<Node*> outputNodes_;
+  // every node of the graph, whose results are cleared after each run
+  std::vector<Node*> nodes_;
+  std::mutex mutex_;
+
+  void clearResults();
+
+ public:
+  explicit GraphPlanRunner(const GraphPlan& plan);
+  ~GraphPlanRunner();
+
+  GraphPlanRunner(const GraphPlanRunner&) = delete;
+  GraphPlanRunner& operator=(const GraphPlanRunner&) = delete;
+
+  /**
+   * Evaluates the outputs of the plan for `inputs`, whose shapes and types
+   * must be those the plan was captured with.
+   */
+  std::vector<Tensor> run(const std::vector<Tensor>& inputs);
+};
+
+} // namespace fl
@@ -13,6 +13,7 @@
 #include <stdexcept>
 
 #include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/fl/tensor/backend/jit/CustomOps.h"
 #include "flashlight/fl/tensor/backend/jit/JitTensorBase.h"
 #include "flashlight/fl/tensor/backend/jit/ShapeInference.h"
 #include "flashlight/fl/tensor/backend/jit/ir/ScalarNode.h"
@@ -47,9 +48,7 @@ std::vector<Node*> tensorsToNodes() {
 }
 
 const Tensor& materialize(Tensor tensor) {
-  auto& jitTensor = toJitTensorBase(tensor);
-  jitTensor.eval();
-  return jitTensor.node()->getResult().value();
+  return toJitTensorBase(tensor).materialize();
 }
 
 } // namespace
@@ -59,6 +58,19 @@ JitBackend::JitBackend(
     std::function<Tensor(Node*)> jitTensorCreator)
     : wrappedBackend_(wrappedBackend), jitTensorCreator_(jitTensorCreator) {}
 
+Tensor JitBackend::createCustomOpJitTensor(
+    std::string&& name,
+    std::vector<Node*>&& inputs,
+    const Shape& shape,
+    CustomNode::Attributes&& attributes /* = {} */) {
+  return jitTensorCreator_(createCustomOpNode(
+      wrappedBackend_,
+      std::move(name),
+      std::move(inputs),
+      shape,
+      std::move(attributes)));
+}
+
 TensorBackendType JitBackend::backendType() const {
   return TensorBackendType::Jit;
 }
@@ -102,23 +114,19 @@ void JitBackend::setSeed(const int seed) {
 }
 
 Tensor JitBackend::randn(const Shape& shape, dtype type) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "randn",
       tensorsToNodes(),
-      Shape(shape),
-      [this, shape, type](const std::vector<const Tensor*>& /* inputs */) {
-        return wrappedBackend_.randn(shape, type);
-      }));
+      shape,
+      CustomOpAttributesBuilder().add(shape).add(type).build());
 }
 
 Tensor JitBackend::rand(const Shape& shape, dtype type) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "rand",
       tensorsToNodes(),
-      Shape(shape),
-      [this, shape, type](const std::vector<const Tensor*>& /* inputs */) {
-        return wrappedBackend_.rand(shape, type);
-      }));
+      shape,
+      CustomOpAttributesBuilder().add(shape).add(type).build());
 }
 
 /* --------------------------- Tensor Operators --------------------------- */
@@ -157,14 +165,11 @@ Tensor JitBackend::identity(const Dim dim, const dtype type) {
 
 Tensor
 JitBackend::arange(const Shape& shape, const Dim seqDim, const dtype type) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "arange",
       tensorsToNodes(),
-      Shape(shape),
-      [this, shape, seqDim, type](
-          const std::vector<const Tensor*>& /* inputs */) {
-        return wrappedBackend_.arange(shape, seqDim, type);
-      }));
+      shape,
+      CustomOpAttributesBuilder().add(shape).add(seqDim).add(type).build());
 }
 
 Tensor
@@ -181,50 +186,37 @@ Tensor JitBackend::reshape(const Tensor& tensor, const Shape& shape) {
         << " to " << shape;
     throw std::invalid_argument(oss.str());
   }
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "reshape",
       tensorsToNodes(tensor),
-      Shape(shape),
-      [this, shape](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.reshape(*inputs.at(0), shape);
-      }));
+      shape,
+      CustomOpAttributesBuilder().add(shape).build());
 }
 
 Tensor JitBackend::transpose(const Tensor& tensor, const Shape& axes = {}) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "transpose",
       tensorsToNodes(tensor),
       inferTransposeOutputShape(tensor.shape(), axes),
-      [this, axes](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.transpose(*inputs.at(0), axes);
-      }));
+      CustomOpAttributesBuilder().add(axes).build());
 }
 
 Tensor JitBackend::tile(const Tensor& tensor, const Shape& tileDims) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "tile",
       tensorsToNodes(tensor),
       inferTileOutputShape(tensor.shape(), tileDims),
-      [this, tileDims](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.tile(*inputs[0], tileDims);
-      }));
+      CustomOpAttributesBuilder().add(tileDims).build());
 }
 
 Tensor JitBackend::concatenate(
     const std::vector<Tensor>& tensors,
     const unsigned axisToConcat) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "concatenate",
       tensorsToNodes(tensors),
       inferConcatenateOutputShape(tensors, axisToConcat),
-      [this, axisToConcat](const std::vector<const Tensor*>& inputs) {
-        // TODO use shallowcopy here
-        std::vector<Tensor> inputTensors;
-        for (const auto* inputPtr : inputs) {
-          inputTensors.emplace_back(inputPtr->copy());
-        }
-        return wrappedBackend_.concatenate(inputTensors, axisToConcat);
-      }));
+      CustomOpAttributesBuilder().add(axisToConcat).build());
 }
 
 Tensor JitBackend::nonzero(const Tensor& tensor) {
@@ -238,26 +230,19 @@ Tensor JitBackend::pad(
     const Tensor& input,
     const std::vector<std::pair<int, int>>& padWidths,
     const PadType type) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "pad",
       tensorsToNodes(input),
       inferPadOutputShape(input.shape(), padWidths),
-      [this, padWidths, type](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.pad(*inputs.at(0), padWidths, type);
-      }));
+      CustomOpAttributesBuilder().add(padWidths).add(type).build());
 }
 
 /************************** Unary Operators ***************************/
 
-#define FL_JIT_BACKEND_UNARY_FALLBACK_IMPL(OP)             \
-  {                                                        \
-    return jitTensorCreator_(CustomNode::create(           \
-        #OP,                                               \
-        tensorsToNodes(tensor),                            \
-        Shape(tensor.shape()),                             \
-        [this](const std::vector<const Tensor*>& inputs) { \
-          return wrappedBackend_.OP(*inputs.at(0));        \
-        }));                                               \
+#define FL_JIT_BACKEND_UNARY_FALLBACK_IMPL(OP)        \
+  {                                                   \
+    return createCustomOpJitTensor(                   \
+        #OP, tensorsToNodes(tensor), tensor.shape()); \
   }
 
 Tensor JitBackend::exp(const Tensor& tensor) {
@@ -321,36 +306,26 @@ Tensor JitBackend::erf(const Tensor& tensor) {
 }
 
 Tensor JitBackend::flip(const Tensor& tensor, const unsigned dim) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "flip",
       tensorsToNodes(tensor),
-      Shape(tensor.shape()),
-      [this, dim](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.flip(*inputs.at(0), dim);
-      }));
+      tensor.shape(),
+      CustomOpAttributesBuilder().add(dim).build());
 }
 
 Tensor
 JitBackend::clip(const Tensor& tensor, const Tensor& low, const Tensor& high) {
-  return jitTensorCreator_(CustomNode::create(
-      "clip",
-      tensorsToNodes(tensor, low, high),
-      Shape(tensor.shape()),
-      [this](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.clip(
-            *inputs.at(0), *inputs.at(1), *inputs.at(2));
-      }));
+  return createCustomOpJitTensor(
+      "clip", tensorsToNodes(tensor, low, high), tensor.shape());
 }
 
 Tensor
 JitBackend::roll(const Tensor& tensor, const int shift, const unsigned axis) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "roll",
       tensorsToNodes(tensor),
-      Shape(tensor.shape()),
-      [this, shift, axis](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.roll(*inputs.at(0), shift, axis);
-      }));
+      tensor.shape(),
+      CustomOpAttributesBuilder().add(shift).add(axis).build());
 }
 
 Tensor JitBackend::isnan(const Tensor& tensor) {
@@ -376,14 +351,8 @@ Tensor JitBackend::triu(const Tensor& tensor) {
 
 Tensor
 JitBackend::where(const Tensor& condition, const Tensor& x, const Tensor& y) {
-  return jitTensorCreator_(CustomNode::create(
-      "where",
-      tensorsToNodes(condition, x, y),
-      Shape(condition.shape()),
-      [this](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.where(
-            *inputs.at(0), *inputs.at(1), *inputs.at(2));
-      }));
+  return createCustomOpJitTensor(
+      "where", tensorsToNodes(condition, x, y), condition.shape());
 }
 
 void JitBackend::topk(
@@ -404,13 +373,11 @@ void JitBackend::topk(
 
 Tensor
 JitBackend::sort(const Tensor& input, const Dim axis, const SortMode sortMode) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "sort",
       tensorsToNodes(input),
-      Shape(input.shape()),
-      [this, axis, sortMode](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.sort(*inputs.at(0), axis, sortMode);
-      }));
+      input.shape(),
+      CustomOpAttributesBuilder().add(axis).add(sortMode).build());
 }
 
 void JitBackend::sort(
@@ -432,13 +399,11 @@ Tensor JitBackend::argsort(
     const Tensor& input,
     const Dim axis,
     const SortMode sortMode) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "argsort",
       tensorsToNodes(input),
-      Shape(input.shape()),
-      [this, axis, sortMode](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.argsort(*inputs.at(0), axis, sortMode);
-      }));
+      input.shape(),
+      CustomOpAttributesBuilder().add(axis).add(sortMode).build());
 }
 
 /************************** Binary Operators ***************************/
@@ -529,27 +494,22 @@ Tensor JitBackend::matmul(
     const Tensor& rhs,
     MatrixProperty lhsProp,
     MatrixProperty rhsProp) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "matmul",
       tensorsToNodes(lhs, rhs),
       inferMatmulOutputShape(lhs.shape(), rhs.shape(), lhsProp, rhsProp),
-      [this, lhsProp, rhsProp](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.matmul(
-            *inputs.at(0), *inputs.at(1), lhsProp, rhsProp);
-      }));
+      CustomOpAttributesBuilder().add(lhsProp).add(rhsProp).build());
 }
 
 /************************** Reductions ***************************/
 
-#define FL_JIT_BACKEND_REDUCTION_FALLBACK_IMPL(OP)                         \
-  {                                                                        \
-    return jitTensorCreator_(CustomNode::create(                           \
-        #OP,                                                               \
-        tensorsToNodes(input),                                             \
-        inferReductionOutputShape(input.shape(), axes, keepDims),          \
-        [this, axes, keepDims](const std::vector<const Tensor*>& inputs) { \
-          return wrappedBackend_.OP(*inputs.at(0), axes, keepDims);        \
-        }));                                                               \
+#define FL_JIT_BACKEND_REDUCTION_FALLBACK_IMPL(OP)                    \
+  {                                                                   \
+    return createCustomOpJitTensor(                                   \
+        #OP,                                                          \
+        tensorsToNodes(input),                                        \
+        inferReductionOutputShape(input.shape(), axes, keepDims),     \
+        CustomOpAttributesBuilder().add(axes).add(keepDims).build()); \
   }
 
 Tensor JitBackend::amin(
@@ -604,41 +564,35 @@ Tensor JitBackend::sum(
 }
 
 Tensor JitBackend::cumsum(const Tensor& input, const unsigned axis) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "cumsum",
       tensorsToNodes(input),
-      Shape(input.shape()),
-      [this, axis](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.cumsum(*inputs.at(0), axis);
-      }));
+      input.shape(),
+      CustomOpAttributesBuilder().add(axis).build());
 }
 
 Tensor JitBackend::argmax(
     const Tensor& input,
     const unsigned axis,
     const bool keepDims) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "argmax",
       tensorsToNodes(input),
       inferReductionOutputShape(
           input.shape(), {static_cast<int>(axis)}, keepDims),
-      [this, axis, keepDims](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.argmax(*inputs.at(0), axis, keepDims);
-      }));
+      CustomOpAttributesBuilder().add(axis).add(keepDims).build());
 }
 
 Tensor JitBackend::argmin(
     const Tensor& input,
     const unsigned axis,
     const bool keepDims) {
-  return jitTensorCreator_(CustomNode::create(
-      "argmax",
+  return createCustomOpJitTensor(
+      "argmin",
       tensorsToNodes(input),
       inferReductionOutputShape(
           input.shape(), {static_cast<int>(axis)}, keepDims),
-      [this, axis, keepDims](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.argmin(*inputs.at(0), axis, keepDims);
-      }));
+      CustomOpAttributesBuilder().add(axis).add(keepDims).build());
 }
 
 Tensor JitBackend::mean(
@@ -660,13 +614,11 @@ Tensor JitBackend::var(
     const std::vector<int>& axes,
     const bool bias,
     const bool keepDims) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "var",
       tensorsToNodes(input),
       inferReductionOutputShape(input.shape(), axes, keepDims),
-      [this, axes, bias, keepDims](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.var(*inputs.at(0), axes, bias, keepDims);
-      }));
+      CustomOpAttributesBuilder().add(axes).add(bias).add(keepDims).build());
 }
 
 Tensor JitBackend::std(
@@ -681,13 +633,11 @@ Tensor JitBackend::norm(
     const std::vector<int>& axes,
     double p /* = 2 */,
     const bool keepDims) {
-  return jitTensorCreator_(CustomNode::create(
+  return createCustomOpJitTensor(
       "norm",
       tensorsToNodes(input),
       inferReductionOutputShape(input.shape(), axes, keepDims),
-      [this, axes, p, keepDims](const std::vector<const Tensor*>& inputs) {
-        return wrappedBackend_.norm(*inputs.at(0), axes, p, keepDims);
-      }));
+      CustomOpAttributesBuilder().add(axes).addReal(p).add(keepDims).build());
 }
 
 Tensor JitBackend::countNonzero(
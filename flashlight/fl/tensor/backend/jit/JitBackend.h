@@ -10,6 +10,7 @@
 #include "flashlight/fl/tensor/TensorAdapter.h"
 #include "flashlight/fl/tensor/TensorBackend.h"
 #include "flashlight/fl/tensor/backend/jit/ir/BinaryNode.h"
+#include "flashlight/fl/tensor/backend/jit/ir/CustomNode.h"
 #include "flashlight/fl/tensor/backend/jit/ir/Node.h"
 
 namespace fl {
@@ -27,6 +28,13 @@ class JitBackend : public TensorBackend {
   Tensor
   createBinopJitTensor(const Tensor& lhs, const Tensor& rhs, BinaryOp op);
 
+  // create a JIT tensor evaluating custom op `name` (see `CustomOps.h`)
+  Tensor createCustomOpJitTensor(
+      std::string&& name,
+      std::vector<Node*>&& inputs,
+      const Shape& shape,
+      CustomNode::Attributes&& attributes = {});
+
   template <typename T>
   Tensor createScalarTensor(unsigned ndim, T val);
 
@@ -11,6 +11,7 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "flashlight/fl/tensor/backend/jit/CustomOps.h"
 #include "flashlight/fl/tensor/backend/jit/ir/IndexedUpdateNode.h"
 #include "flashlight/fl/tensor/backend/jit/ir/ValueNode.h"
 
@@ -192,10 +193,12 @@ Location JitTensorBase::location() {
 
 void JitTensorBase::scalar(void* out) {
   // TODO support tensor.getAdapterBase() so we can use its `scalar` directly
-  const auto& tensor = getTensorOrEvalNode();
+  const auto& tensor = materialize();
   switch (type()) {
     case dtype::f16:
       throw std::runtime_error("[JitTensorBase::scalar] f16 unsupported");
+    case dtype::bf16:
+      throw std::runtime_error("[JitTensorBase::scalar] bf16 unsupported");
     case dtype::f32:
       *((float*)out) = tensor.scalar<float>();
       return;
@@ -231,11 +234,11 @@ void JitTensorBase::scalar(void* out) {
 }
 
 void JitTensorBase::device(void** out) {
-  getTensorOrEvalNode().device(out);
+  materialize().device(out);
 }
 
 void JitTensorBase::host(void* out) {
-  getTensorOrEvalNode().host(out);
+  materialize().host(out);
 }
 
 void JitTensorBase::unlock() {
@@ -264,10 +267,12 @@ const Stream& JitTensorBase::stream() const {
 Tensor JitTensorBase::astype(const dtype type) {
   // TODO cast node after we support type inference, so we can eliminate
   // redundant cast.
-  return fromDataNode(CustomNode::create(
-      "astype", {this->node()}, Shape(this->shape()), [=](auto inputs) {
-        return inputs.at(0)->astype(type);
-      }));
+  return fromDataNode(createCustomOpNode(
+      wrappedBackend(),
+      "astype",
+      {this->node()},
+      Shape(this->shape()),
+      CustomOpAttributesBuilder().add(type).build()));
 }
 
 Tensor JitTensorBase::index(const std::vector<Index>& indices) {
@@ -275,21 +280,19 @@ Tensor JitTensorBase::index(const std::vector<Index>& indices) {
 }
 
 Tensor JitTensorBase::flatten() const {
-  return fromDataNode(CustomNode::create(
+  return fromDataNode(createCustomOpNode(
+      wrappedBackend(),
       "flatten",
       {this->node()},
-      Shape({node()->shape().elements()}),
-      [=](auto inputs) { return inputs.at(0)->flatten(); }));
+      Shape({node()->shape().elements()})));
 }
 
 Tensor JitTensorBase::flat(const Index& idx) const {
   // TODO shape inference for custom node
-  const auto& thisTensorResult =
-      const_cast<JitTensorBase*>(this)->getTensorOrEvalNode();
+  const auto& thisTensorResult = materialize();
   if (idx.type() == detail::IndexType::Tensor) {
     const auto& tensorIdx = idx.get<Tensor>();
-    const auto& tensorIdxResult =
-        toJitTensorBase(tensorIdx).getTensorOrEvalNode();
+    const auto& tensorIdxResult = toJitTensorBase(tensorIdx).materialize();
     return fromDataNode(ValueNode::create(thisTensorResult.flat(tensorIdxResult)));
   }
   return fromDataNode(ValueNode::create(thisTensorResult.flat(idx)));
@@ -298,10 +301,8 @@ Tensor JitTensorBase::flat(const Index& idx) const {
 Tensor JitTensorBase::asContiguousTensor() {
   // TODO add a node for this if we support contiguity or stride inference, so
   // we can eliminate redundant asContiguousTensor call.
-  return fromDataNode(CustomNode::create(
-      "asContiguousTensor", {this->node()}, Shape(shape()), [=](auto inputs) {
-        return inputs.at(0)->asContiguousTensor();
-      }));
+  return fromDataNode(createCustomOpNode(
+      wrappedBackend(), "asContiguousTensor", {this->node()}, Shape(shape())));
 }
 
 void JitTensorBase::setContext(void* /* context */) {
@@ -313,7 +314,7 @@ void* JitTensorBase::getContext() {
 }
 
 std::string JitTensorBase::toString() {
-  return getTensorOrEvalNode().toString();
+  return materialize().toString();
 }
 
 std::ostream& JitTensorBase::operator<<(std::ostream& ostr) {
@@ -401,6 +402,11 @@ void JitTensorBase::eval() const {
   }
 }
 
+const Tensor& JitTensorBase::materialize() const {
+  onMaterialize();
+  return getTensorOrEvalNode();
+}
+
 const JitTensorBase& toJitTensorBase(const Tensor& tensor) {
   return toJitTensorBase(const_cast<Tensor&>(tensor));
 }
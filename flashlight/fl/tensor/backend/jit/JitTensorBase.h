@@ -48,6 +48,10 @@ class JitTensorBase : public TensorAdapterBase {
   virtual Optimizer& optimizer() const = 0;
   virtual Evaluator& evaluator() const = 0;
 
+  // called by `materialize()` before the node is evaluated, e.g., to reject
+  // reads of data which isn't known yet
+  virtual void onMaterialize() const {}
+
   // JitTensorBase manages the backend-agnostic JIT node.
   JitTensorBase(Node* node);
   JitTensorBase(std::shared_ptr<SharedData> sharedData);
@@ -92,6 +96,14 @@ class JitTensorBase : public TensorAdapterBase {
    */
   void eval() const;
 
+  /**
+   * Force evaluation of this tensor's JIT node to read its result as data
+   * (e.g., host reads, or ops whose output shape depends on the data), rather
+   * than only its metadata.
+   * NOTE `const` w.r.t. the underlying Tensor this represents.
+   */
+  const Tensor& materialize() const;
+
   /******************** Assignment Operators ********************/
 #define ASSIGN_OP_TYPE_STUB(OP, TYPE) void OP(const TYPE& val) override;
 
@@ -152,6 +152,7 @@ Tensor Evaluator::evalScalar(ScalarNode& node) {
   const auto dtype = node.dataType();
   switch (dtype) {
     case dtype::f16:
+    case dtype::bf16:
     case dtype::f32:
     case dtype::f64:
       return backend_.full(shape, node.scalar<double>(), dtype);
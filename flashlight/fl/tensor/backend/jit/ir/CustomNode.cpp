@@ -15,10 +15,12 @@ CustomNode::CustomNode(
     std::string&& name,
     std::vector<Node*>&& inputs,
     const Shape& shape,
-    EvalFunc&& evalFunc)
+    EvalFunc&& evalFunc,
+    std::optional<Attributes>&& attributes)
     : NodeTrait(std::move(inputs), shape),
       name_(name),
-      evalFunc_(std::move(evalFunc)) {}
+      evalFunc_(std::move(evalFunc)),
+      attributes_(std::move(attributes)) {}
 
 CustomNode* CustomNode::create(
     std::string&& name,
@@ -26,7 +28,25 @@ CustomNode* CustomNode::create(
     const Shape& shape,
     EvalFunc&& evalFunc) {
   return new CustomNode(
-      std::move(name), std::move(inputs), shape, std::move(evalFunc));
+      std::move(name),
+      std::move(inputs),
+      shape,
+      std::move(evalFunc),
+      std::nullopt);
+}
+
+CustomNode* CustomNode::create(
+    std::string&& name,
+    std::vector<Node*>&& inputs,
+    const Shape& shape,
+    EvalFunc&& evalFunc,
+    Attributes&& attributes) {
+  return new CustomNode(
+      std::move(name),
+      std::move(inputs),
+      shape,
+      std::move(evalFunc),
+      std::move(attributes));
 }
 
 const std::string& CustomNode::name() const {
@@ -37,4 +57,8 @@ const CustomNode::EvalFunc& CustomNode::evalFunc() const {
   return evalFunc_;
 }
 
+const std::optional<CustomNode::Attributes>& CustomNode::attributes() const {
+  return attributes_;
+}
+
 } // namespace fl
@@ -12,6 +12,7 @@
 #include "flashlight/fl/tensor/backend/jit/ir/Node.h"
 
 #include <functional>
+#include <optional>
 #include <vector>
 
 namespace fl {
@@ -24,16 +25,28 @@ class CustomNode : public NodeTrait<CustomNode> {
  public:
   using EvalFunc = std::function<Tensor(const std::vector<const Tensor*>&)>;
 
+  /**
+   * The non-tensor arguments of a custom op (see `CustomOps.h`), from which
+   * its evaluation logic can be rebuilt, e.g., when loading a `GraphPlan`.
+   */
+  struct Attributes {
+    std::vector<long long> ints;
+    std::vector<double> reals;
+  };
+
  private:
   const std::string name_;
   const EvalFunc evalFunc_;
+  // present iff `evalFunc_` is the custom op `name_` with these attributes
+  const std::optional<Attributes> attributes_;
 
   // intentionally kept private to control allocation
   CustomNode(
       std::string&& name,
       std::vector<Node*>&& inputs,
       const Shape& shape,
-      EvalFunc&& evalFunc);
+      EvalFunc&& evalFunc,
+      std::optional<Attributes>&& attributes);
 
  public:
   static constexpr NodeType nodeType = NodeType::Custom;
@@ -44,8 +57,17 @@ class CustomNode : public NodeTrait<CustomNode> {
       const Shape& shape,
       EvalFunc&& evalFunc);
 
+  // Creates a node evaluating the custom op `name` with `attributes`
+  static CustomNode* create(
+      std::string&& name,
+      std::vector<Node*>&& inputs,
+      const Shape& shape,
+      EvalFunc&& evalFunc,
+      Attributes&& attributes);
+
   const std::string& name() const;
   const EvalFunc& evalFunc() const;
+  const std::optional<Attributes>& attributes() const;
 };
 
 } // namespace fl
@@ -47,6 +47,7 @@ class ScalarNode : public NodeTrait<ScalarNode> {
         return new ScalarNode(
             shape, type, static_cast<unsigned long long>(scalar));
       case dtype::f16:
+      case dtype::bf16:
       case dtype::f32:
       case dtype::f64:
         return new ScalarNode(shape, type, static_cast<double>(scalar));
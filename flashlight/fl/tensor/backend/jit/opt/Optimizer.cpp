@@ -28,13 +28,15 @@ void extend(std::vector<T>& extendee, std::vector<T>&& elems) {
 
 } // namespace
 
-Optimizer::Optimizer(TensorBackend& backend) : backend_(backend) {
+Optimizer::Optimizer(TensorBackend& backend, bool backendPasses /* = true */)
+    : backend_(backend) {
   // TODO
   // 1. figure out a configuration API (e.g., LLVM pass style macro)
   // 2. think about ordering
   passes_.emplace_back(std::make_unique<ScalarFolding>());
   auto& registrar = detail::TensorExtensionRegistrar::getInstance();
-  if (registrar.isTensorExtensionRegistered(
+  if (backendPasses &&
+      registrar.isTensorExtensionRegistered(
           backend_.backendType(), TensorExtensionType::JitOptimizer)) {
     extend(passes_, backend_.getExtension<JitOptimizerExtension>().passes());
   }
@@ -23,7 +23,12 @@ class Optimizer {
   TensorBackend& backend_;
 
  public:
-  explicit Optimizer(TensorBackend& backend);
+  /**
+   * Creates an optimizer applying backend-agnostic passes, then the passes of
+   * the backend's JIT optimizer extension if `backendPasses` is true. The
+   * latter rewrite graphs with backend-specific nodes, e.g., fused kernels.
+   */
+  explicit Optimizer(TensorBackend& backend, bool backendPasses = true);
 
   /**
    * Apply in-place optimization to nodes within the tree.
@@ -206,7 +206,8 @@ Node* OneDnnOpFusion::fuseNodes(Node* node, SearchState& state) {
     const auto rhsMemDesc = rhsMem.get_desc();
     const auto dstMemDesc =
         detail::oneDnnContiguousMemDescFromShape(dstShape, dstType);
-    auto dstMem = dnnl::memory(dstMemDesc, engine);
+    auto dst = toTensor<OneDnnTensor>(dstShape, dstMemDesc);
+    auto& dstMem = toOneDnnTensor(dst).memory();
 
     // prepare part of primitive
     const dnnl::binary::desc binaryDesc(
@@ -237,8 +238,8 @@ Node* OneDnnOpFusion::fuseNodes(Node* node, SearchState& state) {
     const auto binaryPrimitive = dnnl::binary(binaryPrimtiveDesc);
 
     // execute primitive
-    binaryPrimitive.execute(backend.nativeStream(), args);
-    return toTensor<OneDnnTensor>(dstShape, std::move(dstMem));
+    backend.oneDnnStream().execute(binaryPrimitive, args);
+    return dst;
   };
 
   return CustomNode::create(
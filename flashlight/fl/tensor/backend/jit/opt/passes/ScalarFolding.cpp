@@ -87,6 +87,7 @@ std::optional<ScalarNode*> foldScalarNodes(
   const auto type = lhs.dataType();
   switch (type) {
     case dtype::f16:
+    case dtype::bf16:
       return std::nullopt;
     case dtype::f32:
       return foldScalarNodes<float>(lhs, rhs, op, type);
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/tensor/backend/onednn/CpuKernels.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "flashlight/fl/common/threadpool/ThreadPool.h"
+
+namespace fl {
+namespace detail {
+
+namespace {
+
+constexpr const char* kNumThreadsEnv = "FL_ONEDNN_NUM_THREADS";
+
+// Whether the current thread is running a `parallelFor` chunk
+thread_local bool inParallelRegion = false;
+
+size_t readNumThreads() {
+  const char* env = std::getenv(kNumThreadsEnv);
+  if (env != nullptr) {
+    const long numThreads = std::strtol(env, nullptr, 10);
+    if (numThreads > 0) {
+      return numThreads;
+    }
+  }
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Workers which run all chunks but the calling thread's. Lazily created, so
+// that processes which never hit a CPU kernel don't spawn threads.
+ThreadPool* getWorkerPool() {
+  static const std::unique_ptr<ThreadPool> pool =
+      []() -> std::unique_ptr<ThreadPool> {
+    const auto numWorkers = getNumCpuKernelThreads() - 1;
+    if (numWorkers == 0) {
+      return nullptr;
+    }
+    return std::make_unique<ThreadPool>(
+        numWorkers, [](size_t /* id */) { inParallelRegion = true; });
+  }();
+  return pool.get();
+}
+
+} // namespace
+
+size_t getNumCpuKernelThreads() {
+  static const size_t numThreads = readNumThreads();
+  return numThreads;
+}
+
+void parallelFor(
+    const size_t size,
+    const size_t grainSize,
+    const std::function<void(size_t, size_t)>& fn) {
+  if (size == 0) {
+    return;
+  }
+  const size_t grain = std::max<size_t>(1, grainSize);
+  auto* pool = getWorkerPool();
+  if (size < 2 * grain || inParallelRegion || pool == nullptr) {
+    fn(0, size);
+    return;
+  }
+
+  // Up to a few chunks per thread, which idle threads steal from the others
+  constexpr size_t kChunksPerThread = 4;
+  const size_t maxChunks = getNumCpuKernelThreads() * kChunksPerThread;
+  const size_t chunkSize = std::max(grain, (size + maxChunks - 1) / maxChunks);
+  // the calling thread runs chunks too
+  inParallelRegion = true;
+  try {
+    pool->parallelFor(size, chunkSize, fn);
+  } catch (...) {
+    inParallelRegion = false;
+    throw;
+  }
+  inParallelRegion = false;
+}
+
+AxisLayout::AxisLayout(const Shape& shape, const unsigned axis) {
+  if (axis >= shape.ndim()) {
+    throw std::invalid_argument(
+        "AxisLayout: axis " + std::to_string(axis) +
+        " out of range for tensor of shape " + shape.toString());
+  }
+  for (unsigned i = 0; i < axis; ++i) {
+    inner *= shape[i];
+  }
+  axisSize = shape[axis];
+  for (unsigned i = axis + 1; i < shape.ndim(); ++i) {
+    outer *= shape[i];
+  }
+}
+
+AxisLayout::AxisLayout(
+    const size_t inner,
+    const size_t axisSize,
+    const size_t outer)
+    : inner(inner), axisSize(axisSize), outer(outer) {}
+
+} // namespace detail
+} // namespace fl
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/Types.h"
+
+/**
+ * Multi-threaded CPU kernels for the OneDNN backend ops which have no OneDNN
+ * primitive. All kernels work on contiguous, column-major host buffers and
+ * are independent of OneDNN itself; the backend is responsible for making
+ * tensors contiguous and converting types the kernels don't handle.
+ *
+ * Loops are written over contiguous inner ranges so that the compiler can
+ * vectorize them, and work is split across threads with `parallelFor`.
+ */
+
+namespace fl {
+namespace detail {
+
+/**
+ * Minimum amount of work (roughly, elements touched) per `parallelFor` chunk,
+ * below which spreading work over threads costs more than it gains.
+ */
+constexpr size_t kCpuKernelGrainSize = 1 << 15;
+
+/**
+ * Split [0, size) into contiguous chunks of at least `grainSize` items and call
+ * `fn(begin, end)` on each of them, using a process-wide pool of worker threads
+ * as well as the calling thread. Runs `fn(0, size)` inline if there is only one
+ * chunk or if called from within another `parallelFor`.
+ *
+ * Exceptions thrown by `fn` are rethrown on the calling thread.
+ */
+void parallelFor(
+    size_t size,
+    size_t grainSize,
+    const std::function<void(size_t, size_t)>& fn);
+
+/**
+ * @return the number of threads `parallelFor` spreads work over, which is the
+ * number of hardware threads unless overridden by the `FL_ONEDNN_NUM_THREADS`
+ * environment variable.
+ */
+size_t getNumCpuKernelThreads();
+
+/**
+ * Call `fn` with a value of the C++ type which holds elements of the given
+ * type in OneDNN tensors, and return its result. Callers convert 16-bit floats
+ * to f32 beforehand.
+ *
+ * @throws std::invalid_argument for types without such a C++ type.
+ */
+template <typename Fn>
+auto dispatchCpuKernelType(const dtype type, Fn&& fn) {
+  switch (type) {
+    case dtype::f32:
+      return fn(float());
+    case dtype::s32:
+      return fn(int());
+    case dtype::b8:
+      return fn(char());
+    case dtype::u8:
+      return fn(static_cast<unsigned char>(0));
+    default:
+      throw std::invalid_argument(
+          "OneDNN CPU kernels don't support type " + dtypeToString(type));
+  }
+}
+
+/**
+ * A contiguous column-major buffer viewed as a 3D array of shape
+ * (inner, axisSize, outer) around one of its axes, i.e. element (i, j, o) is
+ * at `i + (j + o * axisSize) * inner`.
+ */
+struct AxisLayout {
+  size_t inner{1}; // product of the dims before the axis
+  size_t axisSize{1};
+  size_t outer{1}; // product of the dims after the axis
+
+  AxisLayout(const Shape& shape, unsigned axis);
+  AxisLayout(size_t inner, size_t axisSize, size_t outer);
+
+  // number of 1D lines along the axis
+  size_t numLines() const {
+    return inner * outer;
+  }
+
+  // offset of the first element of the given line
+  size_t lineStart(size_t line) const {
+    return (line / inner) * axisSize * inner + line % inner;
+  }
+};
+
+// Items of a (inner, axisSize, outer) buffer are processed in blocks of this
+// many inner elements, which keeps strided passes over the axis in cache.
+constexpr size_t kCpuKernelInnerBlockSize = 1024;
+
+// Run `fn(base, innerBegin, innerEnd)` over (outer, inner block) pairs in
+// parallel, where `base` is the offset of (0, 0, o).
+template <typename Fn>
+void parallelForInnerBlocks(const AxisLayout& layout, Fn fn) {
+  const size_t numBlocks =
+      (layout.inner + kCpuKernelInnerBlockSize - 1) / kCpuKernelInnerBlockSize;
+  const size_t blockSize = std::min(layout.inner, kCpuKernelInnerBlockSize);
+  const size_t itemCost = std::max<size_t>(1, blockSize * layout.axisSize);
+  parallelFor(
+      layout.outer * numBlocks,
+      std::max<size_t>(1, kCpuKernelGrainSize / itemCost),
+      [&](size_t begin, size_t end) {
+        for (size_t item = begin; item < end; ++item) {
+          const size_t o = item / numBlocks;
+          const size_t innerBegin =
+              (item % numBlocks) * kCpuKernelInnerBlockSize;
+          const size_t innerEnd =
+              std::min(layout.inner, innerBegin + kCpuKernelInnerBlockSize);
+          fn(o * layout.axisSize * layout.inner, innerBegin, innerEnd);
+        }
+      });
+}
+
+/**
+ * out[i] = op(in[i]) for i in [0, size).
+ */
+template <typename T, typename U, typename Op>
+void unaryMap(const T* in, U* out, const size_t size, Op op) {
+  parallelFor(size, kCpuKernelGrainSize, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      out[i] = op(in[i]);
+    }
+  });
+}
+
+/**
+ * out[i] = condition[i] ? x[i] : y[i] for i in [0, size).
+ */
+template <typename T>
+void select(
+    const char* condition,
+    const T* x,
+    const T* y,
+    T* out,
+    const size_t size) {
+  parallelFor(size, kCpuKernelGrainSize, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      out[i] = condition[i] ? x[i] : y[i];
+    }
+  });
+}
+
+/**
+ * Copy `in` to `out`, where the two may differ along any axis: index `i` of
+ * `out` along axis `a` is read from index `axisMaps[a][i]` of `in`, or is zero
+ * if that is negative. An empty map stands for the identity. Both shapes must
+ * have the same number of dimensions.
+ *
+ * This covers padding, flipping, rolling and gathering along axes.
+ */
+template <typename T>
+void remap(
+    const T* in,
+    const Shape& inShape,
+    T* out,
+    const Shape& outShape,
+    const std::vector<std::vector<Dim>>& axisMaps) {
+  const int ndim = outShape.ndim();
+  if (inShape.ndim() != ndim || static_cast<int>(axisMaps.size()) != ndim) {
+    throw std::invalid_argument(
+        "remap: input shape, output shape and axis maps must have the same "
+        "number of dimensions");
+  }
+  if (ndim == 0) {
+    out[0] = in[0];
+    return;
+  }
+  std::vector<Dim> inStrides(ndim, 1);
+  for (int axis = 1; axis < ndim; ++axis) {
+    inStrides[axis] = inStrides[axis - 1] * inShape[axis - 1];
+  }
+  const Dim rowSize = outShape[0];
+  if (rowSize == 0) {
+    return;
+  }
+  const auto& rowMap = axisMaps[0];
+  parallelFor(
+      outShape.elements() / rowSize,
+      std::max<size_t>(1, kCpuKernelGrainSize / rowSize),
+      [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+          T* dst = out + row * rowSize;
+          // locate the source row, unless it is padding
+          Dim rem = row;
+          Dim srcOffset = 0;
+          bool isPadding = false;
+          for (int axis = 1; axis < ndim; ++axis) {
+            const Dim idx = rem % outShape[axis];
+            rem /= outShape[axis];
+            const Dim srcIdx =
+                axisMaps[axis].empty() ? idx : axisMaps[axis][idx];
+            isPadding |= srcIdx < 0;
+            srcOffset += srcIdx * inStrides[axis];
+          }
+          if (isPadding) {
+            std::fill(dst, dst + rowSize, T(0));
+            continue;
+          }
+          const T* src = in + srcOffset;
+          if (rowMap.empty()) {
+            std::copy(src, src + rowSize, dst);
+          } else {
+            for (Dim i = 0; i < rowSize; ++i) {
+              dst[i] = rowMap[i] < 0 ? T(0) : src[rowMap[i]];
+            }
+          }
+        }
+      });
+}
+
+/**
+ * The inverse of `remap` for gathering: index `i` of `in` along axis `a` is
+ * written to index `axisMaps[a][i]` of `out`, whose other elements are left
+ * untouched. An empty map stands for the identity. Runs sequentially, so that
+ * the last of repeated positions wins.
+ */
+template <typename T>
+void scatter(
+    const T* in,
+    const Shape& inShape,
+    T* out,
+    const Shape& outShape,
+    const std::vector<std::vector<Dim>>& axisMaps) {
+  const int ndim = inShape.ndim();
+  if (outShape.ndim() != ndim || static_cast<int>(axisMaps.size()) != ndim) {
+    throw std::invalid_argument(
+        "scatter: input shape, output shape and axis maps must have the same "
+        "number of dimensions");
+  }
+  if (ndim == 0) {
+    out[0] = in[0];
+    return;
+  }
+  std::vector<Dim> outStrides(ndim, 1);
+  for (int axis = 1; axis < ndim; ++axis) {
+    outStrides[axis] = outStrides[axis - 1] * outShape[axis - 1];
+  }
+  const Dim rowSize = inShape[0];
+  if (rowSize == 0) {
+    return;
+  }
+  const auto& rowMap = axisMaps[0];
+  const size_t rows = inShape.elements() / rowSize;
+  for (size_t row = 0; row < rows; ++row) {
+    const T* src = in + row * rowSize;
+    Dim rem = row;
+    Dim dstOffset = 0;
+    for (int axis = 1; axis < ndim; ++axis) {
+      const Dim idx = rem % inShape[axis];
+      rem /= inShape[axis];
+      dstOffset +=
+          (axisMaps[axis].empty() ? idx : axisMaps[axis][idx]) *
+          outStrides[axis];
+    }
+    T* dst = out + dstOffset;
+    if (rowMap.empty()) {
+      std::copy(src, src + rowSize, dst);
+    } else {
+      for (Dim i = 0; i < rowSize; ++i) {
+        dst[rowMap[i]] = src[i];
+      }
+    }
+  }
+}
+
+/**
+ * Copy the lower (including the diagonal) or upper triangles of a batch of
+ * column-major (rows, cols) matrices, and zero the rest.
+ */
+template <typename T>
+void triangle(
+    const T* in,
+    T* out,
+    const size_t rows,
+    const size_t cols,
+    const size_t batch,
+    const bool lower) {
+  parallelFor(
+      cols * batch,
+      std::max<size_t>(1, kCpuKernelGrainSize / std::max<size_t>(1, rows)),
+      [&](size_t begin, size_t end) {
+        for (size_t column = begin; column < end; ++column) {
+          const size_t c = column % cols;
+          const T* src = in + column * rows;
+          T* dst = out + column * rows;
+          // rows [0, split) are above the diagonal
+          const size_t split = std::min(lower ? c : c + 1, rows);
+          if (lower) {
+            std::fill(dst, dst + split, T(0));
+            std::copy(src + split, src + rows, dst + split);
+          } else {
+            std::copy(src, src + split, dst);
+            std::fill(dst + split, dst + rows, T(0));
+          }
+        }
+      });
+}
+
+/**
+ * Inclusive prefix sums along the axis of `layout`.
+ */
+template <typename T, typename U>
+void cumsum(const T* in, U* out, const AxisLayout& layout) {
+  const size_t inner = layout.inner;
+  parallelForInnerBlocks(
+      layout, [&](size_t base, size_t innerBegin, size_t innerEnd) {
+        for (size_t i = innerBegin; i < innerEnd; ++i) {
+          out[base + i] = in[base + i];
+        }
+        for (size_t j = 1; j < layout.axisSize; ++j) {
+          const T* src = in + base + j * inner;
+          U* dst = out + base + j * inner;
+          const U* prev = dst - inner;
+          for (size_t i = innerBegin; i < innerEnd; ++i) {
+            dst[i] = prev[i] + src[i];
+          }
+        }
+      });
+}
+
+/**
+ * Find the best element along the axis of `layout`, where `better(a, b)` is
+ * true if `a` should replace the current best `b`; the first of equally good
+ * elements wins. Writes the best values to `values` and their positions along
+ * the axis to `indices`, both of `layout.numLines()` elements.
+ */
+template <typename T, typename Better>
+void reduceWithIndex(
+    const T* in,
+    T* values,
+    int* indices,
+    const AxisLayout& layout,
+    Better better) {
+  if (layout.axisSize == 0) {
+    throw std::invalid_argument("reduceWithIndex: cannot reduce empty axis");
+  }
+  const size_t inner = layout.inner;
+  parallelForInnerBlocks(
+      layout, [&](size_t base, size_t innerBegin, size_t innerEnd) {
+        // (0, 0, o) in the output
+        const size_t outBase = base / layout.axisSize;
+        T* best = values + outBase;
+        int* bestIdx = indices + outBase;
+        for (size_t i = innerBegin; i < innerEnd; ++i) {
+          best[i] = in[base + i];
+          bestIdx[i] = 0;
+        }
+        for (size_t j = 1; j < layout.axisSize; ++j) {
+          const T* src = in + base + j * inner;
+          for (size_t i = innerBegin; i < innerEnd; ++i) {
+            if (better(src[i], best[i])) {
+              best[i] = src[i];
+              bestIdx[i] = j;
+            }
+          }
+        }
+      });
+}
+
+/**
+ * Sort every line along the axis of `layout` and write its first `k` elements
+ * to the lines (of length `k`) of `values` and their original positions along
+ * the axis to `indices`; either output may be null. Equal elements keep their
+ * relative order, and NaNs go last in either order.
+ */
+template <typename T>
+void sortAlongAxis(
+    const T* in,
+    T* values,
+    int* indices,
+    const AxisLayout& layout,
+    const size_t k,
+    const bool ascending) {
+  const size_t n = layout.axisSize;
+  if (k > n) {
+    throw std::invalid_argument(
+        "sortAlongAxis: k = " + std::to_string(k) +
+        " larger than axis size " + std::to_string(n));
+  }
+  const size_t inner = layout.inner;
+  const AxisLayout outLayout(inner, k, layout.outer);
+  // `x != x` only holds for NaN; comparing NaNs with `<` isn't a strict weak
+  // ordering, which std::sort requires
+  const auto valueBefore = [ascending](const T& a, const T& b) {
+    if (a != a) {
+      return false;
+    }
+    if (b != b) {
+      return true;
+    }
+    return ascending ? a < b : b < a;
+  };
+  parallelFor(
+      layout.numLines(),
+      std::max<size_t>(1, kCpuKernelGrainSize / std::max<size_t>(1, n)),
+      [&](size_t begin, size_t end) {
+        std::vector<T> line(n);
+        std::vector<int> perm(indices ? n : 0);
+        for (size_t l = begin; l < end; ++l) {
+          const T* src = in + layout.lineStart(l);
+          const size_t dstStart = outLayout.lineStart(l);
+          for (size_t j = 0; j < n; ++j) {
+            line[j] = src[j * inner];
+          }
+          if (!indices) {
+            // plain values can be sorted in place without tie-breaking
+            if (k < n) {
+              std::partial_sort(
+                  line.begin(), line.begin() + k, line.end(), valueBefore);
+            } else {
+              std::sort(line.begin(), line.end(), valueBefore);
+            }
+            for (size_t j = 0; j < k; ++j) {
+              values[dstStart + j * inner] = line[j];
+            }
+            continue;
+          }
+          std::iota(perm.begin(), perm.end(), 0);
+          const auto before = [&](int a, int b) {
+            if (valueBefore(line[a], line[b])) {
+              return true;
+            }
+            return !valueBefore(line[b], line[a]) && a < b;
+          };
+          if (k < n) {
+            std::partial_sort(
+                perm.begin(), perm.begin() + k, perm.end(), before);
+          } else {
+            std::sort(perm.begin(), perm.end(), before);
+          }
+          for (size_t j = 0; j < k; ++j) {
+            if (values) {
+              values[dstStart + j * inner] = line[perm[j]];
+            }
+            indices[dstStart + j * inner] = perm[j];
+          }
+        }
+      });
+}
+
+/**
+ * Median of every line along the axis of `layout`; the mean of the two middle
+ * elements for lines of even length, and NaN for empty lines.
+ */
+template <typename T, typename U>
+void medianAlongAxis(const T* in, U* out, const AxisLayout& layout) {
+  const size_t n = layout.axisSize;
+  const size_t inner = layout.inner;
+  parallelFor(
+      layout.numLines(),
+      std::max<size_t>(1, kCpuKernelGrainSize / std::max<size_t>(1, n)),
+      [&](size_t begin, size_t end) {
+        std::vector<T> line(n);
+        for (size_t l = begin; l < end; ++l) {
+          if (n == 0) {
+            out[l] = std::numeric_limits<U>::quiet_NaN();
+            continue;
+          }
+          const T* src = in + layout.lineStart(l);
+          for (size_t j = 0; j < n; ++j) {
+            line[j] = src[j * inner];
+          }
+          const auto mid = line.begin() + n / 2;
+          std::nth_element(line.begin(), mid, line.end());
+          double median = *mid;
+          if (n % 2 == 0) {
+            median = (median + *std::max_element(line.begin(), mid)) / 2;
+          }
+          // lines are numbered like the output elements
+          out[l] = static_cast<U>(median);
+        }
+      });
+}
+
+/**
+ * @return the (column-major, linear) indices of the non-zero elements.
+ */
+template <typename T>
+std::vector<int> nonzeroIndices(const T* in, const size_t size) {
+  std::vector<int> indices;
+  for (size_t i = 0; i < size; ++i) {
+    if (in[i] != T(0)) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+} // namespace detail
+} // namespace fl
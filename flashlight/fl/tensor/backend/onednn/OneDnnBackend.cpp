@@ -7,6 +7,7 @@
 
 #include "flashlight/fl/tensor/backend/onednn/OneDnnBackend.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <functional>
@@ -14,13 +15,16 @@
 #include <iostream>
 #include <limits>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
 #include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/fl/tensor/backend/onednn/CpuKernels.h"
 #include "flashlight/fl/tensor/backend/onednn/OneDnnTensor.h"
 #include "flashlight/fl/tensor/backend/onednn/Utils.h"
 
@@ -114,17 +118,11 @@ Tensor iotaWithTypeCpu(const Shape& shape, const dtype type) {
   return toTensor<OneDnnTensor>(shape, type, data.data(), Location::Host);
 }
 
-Tensor iotaSingleAxisCpu(
-    const unsigned ndims,
-    const unsigned axis,
-    const unsigned axisDim,
-    const dtype type) {
-  std::vector<Dim> dims(ndims, 1);
-  dims[axis] = axisDim;
-  const Shape shape(dims);
+Tensor iotaCpu(const Shape& shape, const dtype type) {
   switch (type) {
     case dtype::f16:
-      return iotaWithTypeCpu<float>(shape, dtype::f32).astype(dtype::f16);
+    case dtype::bf16:
+      return iotaWithTypeCpu<float>(shape, dtype::f32).astype(type);
     case dtype::f32:
       return iotaWithTypeCpu<float>(shape, type);
     case dtype::f64:
@@ -148,6 +146,16 @@ Tensor iotaSingleAxisCpu(
   }
 }
 
+Tensor iotaSingleAxisCpu(
+    const unsigned ndims,
+    const unsigned axis,
+    const unsigned axisDim,
+    const dtype type) {
+  std::vector<Dim> dims(ndims, 1);
+  dims[axis] = axisDim;
+  return iotaCpu(Shape(dims), type);
+}
+
 struct BinaryOpOutputDesc {
   BinaryOpOutputDesc(dnnl::memory::desc desc, Shape shape)
       : dstMemDesc(std::move(desc)), dstShape(std::move(shape)) {}
@@ -241,6 +249,9 @@ void applyBinopCpu(
     case fl::dtype::f16:
       throw std::runtime_error(
           "Fallback implementation currently doesn't support f16");
+    case fl::dtype::bf16:
+      throw std::runtime_error(
+          "Fallback implementation currently doesn't support bf16");
     case fl::dtype::f32:
       applyBinopCpu<L, float>(lhs, rhs, dst, count, op);
       break;
@@ -287,6 +298,9 @@ void applyBinopCpu(
     case fl::dtype::f16:
       throw std::runtime_error(
           "Fallback implementation currently doesn't support f16");
+    case fl::dtype::bf16:
+      throw std::runtime_error(
+          "Fallback implementation currently doesn't support bf16");
     case fl::dtype::f32:
       applyBinopCpu<float>(lhs, rhs, rhsType, dst, count, op);
       break;
@@ -376,25 +390,49 @@ Tensor createScalarTensorForBinop(const Tensor& tensor, INPUT_TYPE val) {
   CAST_TYPE castedVal = static_cast<CAST_TYPE>(val);
   Shape literalShape(std::vector<Dim>(tensor.ndim(), 1));
   auto type = dtype_traits<CAST_TYPE>::fl_type;
-  return toTensor<OneDnnTensor>(
+  auto scalarTensor = toTensor<OneDnnTensor>(
       literalShape, type, &castedVal, tensor.location());
-}
-
-dnnl::memory::desc transposeInnerMatrix(const dnnl::memory::desc& memDesc) {
-  const auto ndims = memDesc.data.ndims;
-  if (ndims < 2) {
-    std::ostringstream oss;
-    oss << "[transposeInnerMatrix] expected ndims to be >= 2, got: " << ndims;
-    throw std::runtime_error(oss.str());
+  // don't let a float literal promote a 16-bit float tensor to f32
+  if (type == dtype::f32 && isHalfPrecisionType(tensor.type())) {
+    return scalarTensor.astype(tensor.type());
+  }
+  return scalarTensor;
+}
+
+// The memory descriptor of a matmul operand with (Flashlight) dims `flDims`
+// as a batch of matrices with `ndims` dims, optionally transposed. Vectors and
+// scalars must be given as matrices (their memory is contiguous, so it can be
+// reshaped). Batch dims of 1 are added as needed for broadcasting.
+dnnl::memory::desc matmulOperandMemDesc(
+    const dnnl::memory::desc& memDesc,
+    const std::vector<Dim>& flDims,
+    const size_t ndims,
+    const bool transpose) {
+  const auto matrixMemDesc =
+      memDesc.data.ndims == static_cast<int>(flDims.size())
+      ? memDesc
+      : memDesc.reshape(detail::flDimsToOneDnnDims(flDims));
+  // recall that internal dims (and strides) are reversed
+  const auto& internalStrides = matrixMemDesc.data.format_desc.blocking.strides;
+  std::vector<Dim> dims = flDims;
+  std::vector<Dim> strides;
+  for (int i = flDims.size() - 1; i >= 0; i--) {
+    strides.push_back(internalStrides[i]);
   }
-  // recall that internal dims are reversed from the logical col-major dims
-  std::vector<int> transposeAxesPermutation;
-  for (int i = 0; i < ndims; i++) {
-    transposeAxesPermutation.push_back(i);
+  while (dims.size() < ndims) { // any stride works for dims of 1
+    strides.push_back(strides.back() * dims.back());
+    dims.push_back(1);
   }
-  std::swap(
-      transposeAxesPermutation[ndims - 2], transposeAxesPermutation[ndims - 1]);
-  return memDesc.permute_axes(transposeAxesPermutation);
+  if (transpose) {
+    std::swap(dims[0], dims[1]);
+    std::swap(strides[0], strides[1]);
+  }
+  dnnl::memory::desc operandMemDesc(
+      detail::flDimsToOneDnnDims(dims),
+      matrixMemDesc.data_type(),
+      dnnl::memory::dims(strides.rbegin(), strides.rend()));
+  operandMemDesc.data.offset0 = matrixMemDesc.data.offset0;
+  return operandMemDesc;
 }
 
 std::tuple<Shape, Shape> padShorterDimsWithOnesOnTheRight(
@@ -414,6 +452,226 @@ std::tuple<Shape, Shape> padShorterDimsWithOnesOnTheRight(
   return {Shape(paddedTensorDims), Shape(paddedTileDims)};
 }
 
+bool isFloatType(const dtype type) {
+  return type == dtype::f32 || isHalfPrecisionType(type);
+}
+
+/**
+ * Return a contiguous tensor with the same data as the given one, in a type
+ * supported by the CPU kernels, i.e., 16-bit floats are widened to f32.
+ */
+Tensor toCpuKernelInput(const Tensor& tensor) {
+  if (!hasCpuEngine(tensor)) {
+    throw std::runtime_error(
+        "[OneDnnBackend] CPU kernels unimplemented for non-CPU engine");
+  }
+  if (isHalfPrecisionType(tensor.type())) {
+    return tensor.astype(dtype::f32);
+  }
+  return tensor.isContiguous() ? tensor.shallowCopy()
+                               : tensor.asContiguousTensor();
+}
+
+/**
+ * Narrow a CPU kernel's f32 result back to the type of its 16-bit float
+ * input; other results are returned as is.
+ */
+Tensor fromCpuKernelOutput(Tensor&& result, const dtype inputType) {
+  if (isHalfPrecisionType(inputType) && result.type() == dtype::f32) {
+    return result.astype(inputType);
+  }
+  return std::move(result);
+}
+
+// Uninitialized contiguous tensor for a CPU kernel to write its result into.
+Tensor emptyCpuKernelOutput(const Shape& shape, const dtype type) {
+  return toTensor<OneDnnTensor>(
+      shape,
+      detail::oneDnnContiguousMemDescFromShape(
+          shape, detail::flToOneDnnType(type)));
+}
+
+// Pointer to the first element of a contiguous tensor on a CPU engine, once
+// its data is ready.
+template <typename T>
+T* cpuKernelData(const Tensor& tensor) {
+  auto& oneDnnTensor = toOneDnnTensor(tensor);
+  tensor.stream().sync();
+  return static_cast<T*>(oneDnnTensor.memory().get_data_handle()) +
+      oneDnnTensor.memoryDesc().data.offset0;
+}
+
+// See `detail::remap`; `inShape` may pad the input's shape with 1s.
+Tensor remapCpu(
+    const Tensor& input,
+    const Shape& inShape,
+    const Shape& outShape,
+    const std::vector<std::vector<Dim>>& axisMaps) {
+  const auto src = toCpuKernelInput(input);
+  auto result = emptyCpuKernelOutput(outShape, src.type());
+  detail::dispatchCpuKernelType(src.type(), [&](auto tag) {
+    using T = decltype(tag);
+    detail::remap(
+        cpuKernelData<T>(src),
+        inShape,
+        cpuKernelData<T>(result),
+        outShape,
+        axisMaps);
+  });
+  return fromCpuKernelOutput(std::move(result), input.type());
+}
+
+// The index along an axis of `size` elements which padding copies from, for
+// (possibly out of range) index `idx`; -1 for zeros.
+Dim padSourceIndex(const Dim idx, const Dim size, const PadType type) {
+  if (idx >= 0 && idx < size) {
+    return idx;
+  }
+  switch (type) {
+    case PadType::Constant:
+      return -1;
+    case PadType::Edge:
+      return idx < 0 ? 0 : size - 1;
+    case PadType::Symmetric: {
+      // the input and its mirror image repeat with this period
+      const Dim period = 2 * size;
+      const Dim pos = (idx % period + period) % period;
+      return pos < size ? pos : period - 1 - pos;
+    }
+  }
+  throw std::invalid_argument("[OneDnnBackend::pad] unknown PadType");
+}
+
+Tensor triangleCpu(const Tensor& tensor, const bool lower) {
+  const auto src = toCpuKernelInput(tensor);
+  const auto& shape = tensor.shape();
+  const size_t rows = shape.ndim() > 0 ? shape[0] : 1;
+  const size_t cols = shape.ndim() > 1 ? shape[1] : 1;
+  const size_t batch = rows * cols == 0 ? 0 : shape.elements() / (rows * cols);
+  auto result = emptyCpuKernelOutput(shape, src.type());
+  detail::dispatchCpuKernelType(src.type(), [&](auto tag) {
+    using T = decltype(tag);
+    detail::triangle(
+        cpuKernelData<T>(src),
+        cpuKernelData<T>(result),
+        rows,
+        cols,
+        batch,
+        lower);
+  });
+  return fromCpuKernelOutput(std::move(result), tensor.type());
+}
+
+// Apply `op` element-wise in f32; integer inputs give f32 results.
+template <typename Op>
+Tensor floatUnaryOpCpu(const Tensor& tensor, Op op) {
+  auto src = toCpuKernelInput(tensor);
+  if (src.type() != dtype::f32) {
+    src = src.astype(dtype::f32);
+  }
+  auto result = emptyCpuKernelOutput(tensor.shape(), dtype::f32);
+  detail::unaryMap(
+      cpuKernelData<float>(src),
+      cpuKernelData<float>(result),
+      tensor.elements(),
+      op);
+  return fromCpuKernelOutput(std::move(result), tensor.type());
+}
+
+/**
+ * Sort `input` along `axis` and keep the first `k` elements. Writes the values
+ * and/or their s32 indices along the axis to the non-null outputs.
+ */
+void sortCpu(
+    Tensor* values,
+    Tensor* indices,
+    const Tensor& input,
+    const Dim axis,
+    const Dim k,
+    const SortMode sortMode) {
+  if (sortMode != SortMode::Descending && sortMode != SortMode::Ascending) {
+    throw std::invalid_argument(
+        "[OneDnnBackend] Cannot sort tensor with given SortMode: "
+        "only Descending and Ascending supported.");
+  }
+  if (axis < 0 || axis >= input.ndim()) {
+    std::ostringstream oss;
+    oss << "[OneDnnBackend] Invalid axis for sorting: " << axis
+        << " for tensor of shape: " << input.shape();
+    throw std::invalid_argument(oss.str());
+  }
+  const auto src = toCpuKernelInput(input);
+  const detail::AxisLayout layout(input.shape(), axis);
+  std::vector<Dim> outDims = input.shape().get();
+  outDims[axis] = k;
+  const Shape outShape(outDims);
+  std::optional<Tensor> sortedValues;
+  std::optional<Tensor> sortedIndices;
+  if (values) {
+    sortedValues = emptyCpuKernelOutput(outShape, src.type());
+  }
+  if (indices) {
+    sortedIndices = emptyCpuKernelOutput(outShape, dtype::s32);
+  }
+  detail::dispatchCpuKernelType(src.type(), [&](auto tag) {
+    using T = decltype(tag);
+    detail::sortAlongAxis(
+        cpuKernelData<T>(src),
+        sortedValues ? cpuKernelData<T>(*sortedValues) : nullptr,
+        sortedIndices ? cpuKernelData<int>(*sortedIndices) : nullptr,
+        layout,
+        k,
+        sortMode == SortMode::Ascending);
+  });
+  if (values) {
+    *values = fromCpuKernelOutput(std::move(*sortedValues), input.type());
+  }
+  if (indices) {
+    *indices = std::move(*sortedIndices);
+  }
+}
+
+/**
+ * Reduce `input` along `axis` to the elements for which `better(element,
+ * best)` holds, and their s32 indices; ties go to the first element.
+ */
+template <typename Better>
+void reduceWithIndexCpu(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& input,
+    const unsigned axis,
+    const bool keepDims,
+    Better better) {
+  if (axis >= input.ndim()) {
+    std::ostringstream oss;
+    oss << "[OneDnnBackend] Axis too large: " << axis
+        << " for tensor of shape: " << input.shape();
+    throw std::invalid_argument(oss.str());
+  }
+  const auto src = toCpuKernelInput(input);
+  std::vector<Dim> outputDims = input.shape().get();
+  if (keepDims) {
+    outputDims[axis] = 1;
+  } else {
+    outputDims.erase(outputDims.begin() + axis);
+  }
+  const Shape outputShape(outputDims);
+  auto bestValues = emptyCpuKernelOutput(outputShape, src.type());
+  auto bestIndices = emptyCpuKernelOutput(outputShape, dtype::s32);
+  detail::dispatchCpuKernelType(src.type(), [&](auto tag) {
+    using T = decltype(tag);
+    detail::reduceWithIndex(
+        cpuKernelData<T>(src),
+        cpuKernelData<T>(bestValues),
+        cpuKernelData<int>(bestIndices),
+        detail::AxisLayout(input.shape(), axis),
+        better);
+  });
+  values = fromCpuKernelOutput(std::move(bestValues), input.type());
+  indices = std::move(bestIndices);
+}
+
 } // namespace
 
 OneDnnBackend::OneDnnBackend() {
@@ -424,6 +682,14 @@ OneDnnBackend::OneDnnBackend() {
 #endif // FL_USE_MKL_RNG
   engine_ = dnnl::engine(dnnl::engine::kind::cpu, 0);
   stream_ = OneDnnCPUStream::create(engine_);
+  hostAllocator_ = OneDnnHostAllocator::create();
+  // buffers may still be used by the stream's pending work when released
+  hostAllocator_->setReleaseHook(
+      [stream = std::weak_ptr<OneDnnCPUStream>(stream_)](
+          std::function<void()> recycle) {
+        const auto lockedStream = stream.lock();
+        return lockedStream && lockedStream->deferUntilDone(std::move(recycle));
+      });
 }
 
 OneDnnBackend& OneDnnBackend::getInstance() {
@@ -439,6 +705,10 @@ const Stream& OneDnnBackend::stream() const {
   return *stream_;
 }
 
+OneDnnCPUStream& OneDnnBackend::oneDnnStream() const {
+  return *stream_;
+}
+
 dnnl::stream& OneDnnBackend::nativeStream() const {
   return stream_->handle();
 }
@@ -451,6 +721,10 @@ const dnnl::engine& OneDnnBackend::cpuEngine() const {
   return engine_;
 }
 
+OneDnnHostAllocator& OneDnnBackend::hostAllocator() const {
+  return *hostAllocator_;
+}
+
 /* -------------------------- Compute Functions -------------------------- */
 
 void OneDnnBackend::eval(const Tensor& /* tensor */) {
@@ -462,26 +736,30 @@ bool OneDnnBackend::supportsDataType(const fl::dtype& type) const {
 }
 
 void OneDnnBackend::getMemMgrInfo(
-    const char* /* msg */,
+    const char* msg,
     const int /* deviceId */,
-    std::ostream* /* ostream */) {
-  throw std::runtime_error(
-      "[OneDnnBackend] Currently no memory manager support");
+    std::ostream* ostream) {
+  if (ostream == nullptr) {
+    throw std::invalid_argument(
+        "OneDnnBackend::getMemMgrInfo - got null ostream pointer");
+  }
+  hostAllocator_->printInfo(msg, ostream);
 }
 
-void OneDnnBackend::setMemMgrLogStream(std::ostream* /* stream */) {
-  throw std::runtime_error(
-      "[OneDnnBackend] Currently no memory manager support");
+void OneDnnBackend::setMemMgrLogStream(std::ostream* stream) {
+  if (stream == nullptr) {
+    throw std::invalid_argument(
+        "OneDnnBackend::setMemMgrLogStream - got null ostream pointer");
+  }
+  hostAllocator_->setLogStream(stream);
 }
 
-void OneDnnBackend::setMemMgrLoggingEnabled(const bool /* enabled */) {
-  throw std::runtime_error(
-      "[OneDnnBackend] Currently no memory manager support");
+void OneDnnBackend::setMemMgrLoggingEnabled(const bool enabled) {
+  hostAllocator_->setLoggingEnabled(enabled);
 }
 
-void OneDnnBackend::setMemMgrFlushInterval(const size_t /* interval */) {
-  throw std::runtime_error(
-      "[OneDnnBackend] Currently no memory manager support");
+void OneDnnBackend::setMemMgrFlushInterval(const size_t interval) {
+  hostAllocator_->setLogFlushInterval(interval);
 }
 
 /* -------------------------- Rand Functions -------------------------- */
@@ -558,8 +836,8 @@ Tensor OneDnnBackend::rand(const Shape& shape, dtype type) {
       const Shape& shape, TYPE value, const dtype type) {                      \
     switch (type) {                                                            \
       case dtype::f16:                                                         \
-        return fullWithType<float>(shape, value, dtype::f32)                   \
-            .astype(dtype::f16);                                               \
+      case dtype::bf16:                                                        \
+        return fullWithType<float>(shape, value, dtype::f32).astype(type);     \
       case dtype::f32:                                                         \
         return fullWithType<float>(shape, value, type);                        \
       case dtype::f64:                                                         \
@@ -633,10 +911,18 @@ OneDnnBackend::arange(const Shape& shape, const Dim seqDim, const dtype type) {
 }
 
 Tensor OneDnnBackend::iota(
-    const Shape& /* dims */,
-    const Shape& /* tileDims */,
-    const dtype /* type */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Shape& dims,
+    const Shape& tileDims,
+    const dtype type) {
+  if (engine_.get_kind() != dnnl::engine::kind::cpu) {
+    throw std::runtime_error(
+        "[OneDnnBackend::iota] unimplemented for non-CPU engine");
+  }
+  auto result = iotaCpu(dims, type);
+  if (tileDims.elements() == 1) {
+    return result;
+  }
+  return tile(result, tileDims);
 }
 
 /************************ Shaping and Indexing *************************/
@@ -655,7 +941,8 @@ Tensor OneDnnBackend::reshape(const Tensor& tensor, const Shape& shape) {
   const auto& memDesc = srcTensor.memoryDesc();
   const auto reshapedMemDesc =
       detail::oneDnnContiguousMemDescFromShape(shape, memDesc.data_type());
-  auto reshapedMem = dnnl::memory(reshapedMemDesc, engine_);
+  auto reshaped = toTensor<OneDnnTensor>(shape, reshapedMemDesc);
+  auto& reshapedMem = toOneDnnTensor(reshaped).memory();
 
   // prepare primitive (use reorder to do a copy)
   const auto reorderPrimitiveDesc =
@@ -663,8 +950,9 @@ Tensor OneDnnBackend::reshape(const Tensor& tensor, const Shape& shape) {
   const auto reorderPrimitive = dnnl::reorder(reorderPrimitiveDesc);
 
   // execute primitive
-  reorderPrimitive.execute(stream_->handle(), mem, reshapedMem);
-  return toTensor<OneDnnTensor>(shape, std::move(reshapedMem));
+  stream_->execute(
+      reorderPrimitive, {{DNNL_ARG_FROM, mem}, {DNNL_ARG_TO, reshapedMem}});
+  return reshaped;
 }
 
 // 1. OneDNN doesn't have native support for tensor transpose.
@@ -725,7 +1013,8 @@ Tensor OneDnnBackend::transpose(
   const auto srcMemDims = srcMemDesc.dims();
   const auto dstMemDesc =
       detail::oneDnnContiguousMemDescFromShape(newShape, type);
-  auto dstMem = dnnl::memory(dstMemDesc, engine_);
+  auto dst = toTensor<OneDnnTensor>(newShape, dstMemDesc);
+  auto& dstMem = toOneDnnTensor(dst).memory();
 
   // prepare primitive
   const auto reorderDstStrides =
@@ -737,8 +1026,9 @@ Tensor OneDnnBackend::transpose(
   const auto reorderPrimitive = dnnl::reorder(reorderPrimitiveDesc);
 
   // execute primitive
-  reorderPrimitive.execute(stream_->handle(), srcMem, dstMem);
-  return toTensor<OneDnnTensor>(newShape, std::move(dstMem));
+  stream_->execute(
+      reorderPrimitive, {{DNNL_ARG_FROM, srcMem}, {DNNL_ARG_TO, dstMem}});
+  return dst;
 }
 
 Tensor OneDnnBackend::tile(const Tensor& tensor, const Shape& tileDims) {
@@ -749,6 +1039,8 @@ Tensor OneDnnBackend::tile(const Tensor& tensor, const Shape& tileDims) {
   auto currTiledMem = srcTensor.memory();
   auto currTiledMemDesc = srcTensor.memoryDesc().reshape(
       detail::shapeToOneDnnDims(paddedTensorShape));
+  // owns `currTiledMem` once at least one axis has been tiled
+  std::optional<Tensor> tiled;
   std::vector<Dim> finalDims;
   // TODO use uniform axes once we remove the 'transposed' representation
   for (int shapeAxis = 0; shapeAxis < paddedTileDims.ndim(); shapeAxis++) {
@@ -764,7 +1056,9 @@ Tensor OneDnnBackend::tile(const Tensor& tensor, const Shape& tileDims) {
           dimsAxis, tileMemDescs, engine_);
       const dnnl::concat concatPrimitive(concatPrimitiveDesc);
       const auto newTileMemDesc = concatPrimitiveDesc.dst_desc();
-      auto newTiledMem = dnnl::memory(newTileMemDesc, engine_);
+      auto newTiled = toTensor<OneDnnTensor>(
+          detail::oneDnnDimsToShape(newTileMemDesc.dims()), newTileMemDesc);
+      auto newTiledMem = toOneDnnTensor(newTiled).memory();
 
       // prepare arguments.
       std::unordered_map<int, dnnl::memory> args{{DNNL_ARG_DST, newTiledMem}};
@@ -773,29 +1067,123 @@ Tensor OneDnnBackend::tile(const Tensor& tensor, const Shape& tileDims) {
       }
 
       // execute primitive
-      concatPrimitive.execute(stream_->handle(), args);
+      stream_->execute(concatPrimitive, args);
       currTiledMemDesc = newTileMemDesc;
       currTiledMem = newTiledMem;
+      tiled = std::move(newTiled);
     }
   }
-  return toTensor<OneDnnTensor>(Shape(finalDims), std::move(currTiledMem));
+  if (!tiled.has_value()) {
+    return reshape(tensor, Shape(finalDims));
+  }
+  return std::move(tiled.value());
 }
 
 Tensor OneDnnBackend::concatenate(
-    const std::vector<Tensor>& /* tensors */,
-    const unsigned /* axis */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const std::vector<Tensor>& tensors,
+    const unsigned axis) {
+  if (tensors.empty()) {
+    return toTensor<OneDnnTensor>();
+  }
+  if (tensors.size() == 1) {
+    return tensors.front().shallowCopy();
+  }
+
+  // all inputs are converted to the type with the largest range, and padded
+  // to the same number of dimensions, which must include `axis`
+  auto type = toOneDnnTensor(tensors.front()).memoryDesc().data_type();
+  int ndim = axis + 1;
+  for (const auto& tensor : tensors) {
+    type = detail::getTypeWithLargerRange(
+        type, toOneDnnTensor(tensor).memoryDesc().data_type());
+    ndim = std::max(ndim, tensor.ndim());
+  }
+  std::vector<Tensor> srcs;
+  std::vector<dnnl::memory::desc> srcMemDescs;
+  std::vector<Dim> firstDims;
+  for (const auto& tensor : tensors) {
+    auto src = tensor.type() == detail::oneDnnToFlType(type)
+        ? tensor.shallowCopy()
+        : tensor.astype(detail::oneDnnToFlType(type));
+    std::vector<Dim> paddedDims = src.shape().get();
+    paddedDims.resize(ndim, 1);
+    if (firstDims.empty()) {
+      firstDims = paddedDims;
+    }
+    for (int i = 0; i < ndim; ++i) {
+      if (i != axis && paddedDims[i] != firstDims[i]) {
+        std::ostringstream oss;
+        oss << "[OneDnnBackend::concatenate] Cannot concatenate tensors of "
+            << "shapes " << tensors.front().shape() << " and "
+            << tensor.shape() << " along axis " << axis;
+        throw std::invalid_argument(oss.str());
+      }
+    }
+    // N.B. this reshape doesn't require row-major layout
+    srcMemDescs.push_back(toOneDnnTensor(src).memoryDesc().reshape(
+        detail::shapeToOneDnnDims(Shape(paddedDims))));
+    srcs.push_back(std::move(src));
+  }
+
+  // prepare concat primitive
+  // TODO use uniform axes once we remove the 'transposed' representation
+  const dnnl::concat::primitive_desc concatPrimitiveDesc(
+      ndim - 1 - axis, srcMemDescs, engine_);
+  const dnnl::concat concatPrimitive(concatPrimitiveDesc);
+  const auto dstMemDesc = concatPrimitiveDesc.dst_desc();
+  auto dst = toTensor<OneDnnTensor>(
+      detail::oneDnnDimsToShape(dstMemDesc.dims()), dstMemDesc);
+
+  // prepare arguments.
+  std::unordered_map<int, dnnl::memory> args{
+      {DNNL_ARG_DST, toOneDnnTensor(dst).memory()}};
+  for (int i = 0; i < srcs.size(); ++i) {
+    args.insert({DNNL_ARG_MULTIPLE_SRC + i, toOneDnnTensor(srcs[i]).memory()});
+  }
+
+  // execute primitive
+  stream_->execute(concatPrimitive, args);
+  return dst;
 }
 
-Tensor OneDnnBackend::nonzero(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::nonzero(const Tensor& tensor) {
+  const auto src = toCpuKernelInput(tensor);
+  const auto indices = detail::dispatchCpuKernelType(src.type(), [&](auto tag) {
+    using T = decltype(tag);
+    return detail::nonzeroIndices(cpuKernelData<T>(src), src.elements());
+  });
+  return toTensor<OneDnnTensor>(
+      Shape({static_cast<Dim>(indices.size())}),
+      dtype::s32,
+      indices.data(),
+      Location::Host);
 }
 
 Tensor OneDnnBackend::pad(
-    const Tensor& /* input */,
-    const std::vector<std::pair<int, int>>& /* padWidths */,
-    const PadType /* type */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const std::vector<std::pair<int, int>>& padWidths,
+    const PadType type) {
+  const int ndim = std::max<int>(input.ndim(), padWidths.size());
+  std::vector<Dim> inDims = input.shape().get();
+  inDims.resize(ndim, 1);
+  std::vector<Dim> outDims = inDims;
+  std::vector<std::vector<Dim>> axisMaps(ndim);
+  for (int axis = 0; axis < padWidths.size(); ++axis) {
+    const auto [before, after] = padWidths[axis];
+    if (before < 0 || after < 0) {
+      throw std::invalid_argument(
+          "[OneDnnBackend::pad] pad widths must be non-negative");
+    }
+    if (before == 0 && after == 0) {
+      continue;
+    }
+    outDims[axis] = inDims[axis] + before + after;
+    auto& axisMap = axisMaps[axis];
+    for (Dim i = 0; i < outDims[axis]; ++i) {
+      axisMap.push_back(padSourceIndex(i - before, inDims[axis], type));
+    }
+  }
+  return remapCpu(input, Shape(inDims), Shape(outDims), axisMaps);
 }
 
 /************************** Unary Operators ***************************/
@@ -820,12 +1208,14 @@ Tensor OneDnnBackend::log1p(const Tensor& /* tensor */) {
   FL_ONEDNN_BACKEND_UNIMPLEMENTED;
 }
 
-Tensor OneDnnBackend::sin(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+// OneDNN has no trigonometric or rounding eltwise algorithms, so these use
+// CPU kernels.
+Tensor OneDnnBackend::sin(const Tensor& tensor) {
+  return floatUnaryOpCpu(tensor, [](float x) { return std::sin(x); });
 }
 
-Tensor OneDnnBackend::cos(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::cos(const Tensor& tensor) {
+  return floatUnaryOpCpu(tensor, [](float x) { return std::cos(x); });
 }
 
 Tensor OneDnnBackend::sqrt(const Tensor& tensor) {
@@ -836,12 +1226,18 @@ Tensor OneDnnBackend::tanh(const Tensor& tensor) {
   return applyEltwiseOp(tensor, dnnl::algorithm::eltwise_tanh);
 }
 
-Tensor OneDnnBackend::floor(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::floor(const Tensor& tensor) {
+  if (!isFloatType(tensor.type())) {
+    return tensor.copy();
+  }
+  return floatUnaryOpCpu(tensor, [](float x) { return std::floor(x); });
 }
 
-Tensor OneDnnBackend::ceil(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::ceil(const Tensor& tensor) {
+  if (!isFloatType(tensor.type())) {
+    return tensor.copy();
+  }
+  return floatUnaryOpCpu(tensor, [](float x) { return std::ceil(x); });
 }
 
 Tensor OneDnnBackend::rint(const Tensor& tensor) {
@@ -852,8 +1248,8 @@ Tensor OneDnnBackend::absolute(const Tensor& tensor) {
   return applyEltwiseOp(tensor, dnnl::algorithm::eltwise_abs);
 }
 
-Tensor OneDnnBackend::sigmoid(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::sigmoid(const Tensor& tensor) {
+  return applyEltwiseOp(tensor, dnnl::algorithm::eltwise_logistic);
 }
 
 Tensor OneDnnBackend::erf(const Tensor& tensor) {
@@ -866,10 +1262,19 @@ Tensor OneDnnBackend::erf(const Tensor& tensor) {
   // TODO investigate performance using post-ops -- just launch 1 primitive here
 }
 
-Tensor OneDnnBackend::flip(
-    const Tensor& /* tensor */,
-    const unsigned /* dim */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::flip(const Tensor& tensor, const unsigned dim) {
+  if (dim >= tensor.ndim()) {
+    std::ostringstream oss;
+    oss << "[OneDnnBackend::flip] Invalid dim: " << dim
+        << " for tensor of shape: " << tensor.shape();
+    throw std::invalid_argument(oss.str());
+  }
+  std::vector<std::vector<Dim>> axisMaps(tensor.ndim());
+  auto& axisMap = axisMaps[dim];
+  for (Dim i = tensor.dim(dim) - 1; i >= 0; --i) {
+    axisMap.push_back(i);
+  }
+  return remapCpu(tensor, tensor.shape(), tensor.shape(), axisMaps);
 }
 
 Tensor OneDnnBackend::clip(
@@ -887,10 +1292,22 @@ Tensor OneDnnBackend::clip(
 }
 
 Tensor OneDnnBackend::roll(
-    const Tensor& /* tensor */,
-    const int /* shift */,
-    const unsigned /* axis */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& tensor,
+    const int shift,
+    const unsigned axis) {
+  if (axis >= tensor.ndim()) {
+    std::ostringstream oss;
+    oss << "[OneDnnBackend::roll] Invalid axis: " << axis
+        << " for tensor of shape: " << tensor.shape();
+    throw std::invalid_argument(oss.str());
+  }
+  const Dim size = tensor.dim(axis);
+  std::vector<std::vector<Dim>> axisMaps(tensor.ndim());
+  auto& axisMap = axisMaps[axis];
+  for (Dim i = 0; i < size; ++i) {
+    axisMap.push_back(((i - shift) % size + size) % size);
+  }
+  return remapCpu(tensor, tensor.shape(), tensor.shape(), axisMaps);
 }
 
 Tensor OneDnnBackend::isnan(const Tensor& /* tensor */) {
@@ -906,52 +1323,79 @@ Tensor OneDnnBackend::sign(const Tensor& tensor) {
   return (0 < tensor) - (tensor < 0);
 }
 
-Tensor OneDnnBackend::tril(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::tril(const Tensor& tensor) {
+  return triangleCpu(tensor, /* lower = */ true);
 }
 
-Tensor OneDnnBackend::triu(const Tensor& /* tensor */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::triu(const Tensor& tensor) {
+  return triangleCpu(tensor, /* lower = */ false);
 }
 
 Tensor OneDnnBackend::where(
-    const Tensor& /* condition */,
-    const Tensor& /* x */,
-    const Tensor& /* y */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& condition,
+    const Tensor& x,
+    const Tensor& y) {
+  if (condition.shape() != x.shape() || x.shape() != y.shape()) {
+    std::ostringstream oss;
+    oss << "[OneDnnBackend::where] condition, x and y must have the same "
+        << "shape, got: " << condition.shape() << ", " << x.shape() << " and "
+        << y.shape();
+    throw std::invalid_argument(oss.str());
+  }
+  const auto cond = condition.type() == dtype::b8
+      ? toCpuKernelInput(condition)
+      : toCpuKernelInput(condition != 0);
+  const auto xSrc = toCpuKernelInput(x);
+  const auto ySrc = y.type() == x.type() ? toCpuKernelInput(y)
+                                         : toCpuKernelInput(y.astype(x.type()));
+  auto result = emptyCpuKernelOutput(x.shape(), xSrc.type());
+  detail::dispatchCpuKernelType(xSrc.type(), [&](auto tag) {
+    using T = decltype(tag);
+    detail::select(
+        cpuKernelData<char>(cond),
+        cpuKernelData<T>(xSrc),
+        cpuKernelData<T>(ySrc),
+        cpuKernelData<T>(result),
+        x.elements());
+  });
+  return fromCpuKernelOutput(std::move(result), x.type());
 }
 
 void OneDnnBackend::topk(
-    Tensor& /* values */,
-    Tensor& /* indices */,
-    const Tensor& /* input */,
-    const unsigned /* k */,
-    const Dim /* axis */,
-    const SortMode /* sortMode */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& input,
+    const unsigned k,
+    const Dim axis,
+    const SortMode sortMode) {
+  sortCpu(&values, &indices, input, axis, k, sortMode);
 }
 
 Tensor OneDnnBackend::sort(
-    const Tensor& /* input */,
-    const Dim /* axis */,
-    const SortMode /* sortMode */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const Dim axis,
+    const SortMode sortMode) {
+  Tensor values;
+  sortCpu(&values, nullptr, input, axis, input.dim(axis), sortMode);
+  return values;
 }
 
 void OneDnnBackend::sort(
-    Tensor& /* values */,
-    Tensor& /* indices */,
-    const Tensor& /* input */,
-    const Dim /* axis */,
-    const SortMode /* sortMode */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& input,
+    const Dim axis,
+    const SortMode sortMode) {
+  sortCpu(&values, &indices, input, axis, input.dim(axis), sortMode);
 }
 
 Tensor OneDnnBackend::argsort(
-    const Tensor& /* input */,
-    const Dim /* axis */,
-    const SortMode /* sortMode */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const Dim axis,
+    const SortMode sortMode) {
+  Tensor indices;
+  sortCpu(nullptr, &indices, input, axis, input.dim(axis), sortMode);
+  return indices;
 }
 
 Tensor OneDnnBackend::applyEltwiseOp(
@@ -959,13 +1403,18 @@ Tensor OneDnnBackend::applyEltwiseOp(
     const dnnl::algorithm alg,
     float alpha /* 0 */,
     float beta /* 0 */) {
-  // prepare memories
+  // prepare memories. Opaque layouts (e.g., the blocked ones convolutions
+  // pick) are kept, so elementwise ops between primitives don't reorder.
   auto& srcTensor = toOneDnnTensor(tensor);
-  const auto mem = srcTensor.memory();
-  const auto& memDesc = srcTensor.memoryDesc();
-  const auto dstMemDesc = detail::oneDnnContiguousMemDescFromShape(
-      tensor.shape(), memDesc.data_type());
-  auto dstMem = dnnl::memory(dstMemDesc, engine_);
+  const auto mem = srcTensor.layoutMemory();
+  const auto memDesc = mem.get_desc();
+  auto dst = srcTensor.hasOpaqueLayout()
+      ? toTensor<OneDnnTensor>(tensor.shape(), dnnl::memory(memDesc, engine_))
+      : toTensor<OneDnnTensor>(
+            tensor.shape(),
+            detail::oneDnnContiguousMemDescFromShape(
+                tensor.shape(), memDesc.data_type()));
+  const auto dstMem = toOneDnnTensor(dst).layoutMemory();
 
   // prepare unary primitive
   const auto unaryDesc = dnnl::eltwise_forward::desc(
@@ -981,8 +1430,8 @@ Tensor OneDnnBackend::applyEltwiseOp(
   };
 
   // execute primitive
-  unaryPrimitive.execute(stream_->handle(), args);
-  return toTensor<OneDnnTensor>(tensor.shape(), std::move(dstMem));
+  stream_->execute(unaryPrimitive, args);
+  return dst;
 }
 
 /************************** Binary Operators ***************************/
@@ -1122,16 +1571,43 @@ Tensor OneDnnBackend::applyBinop(
     const Tensor& rhs,
     dnnl::algorithm alg,
     std::optional<dnnl::memory::data_type> dstType /* = std::nullopt */) {
-  // prepare memories
   auto& lhsTensor = toOneDnnTensor(lhs);
   auto& rhsTensor = toOneDnnTensor(rhs);
+  // keep the opaque layout of the lhs (e.g., a convolution output) if the rhs
+  // is in the same layout or is a broadcast scalar, e.g., for residual adds
+  if (!dstType && lhsTensor.hasOpaqueLayout() && lhs.type() == rhs.type() &&
+      (lhs.shape() == rhs.shape() ||
+       (rhs.elements() == 1 && rhs.ndim() == lhs.ndim()))) {
+    const auto lhsLayoutMem = lhsTensor.layoutMemory();
+    const auto rhsLayoutMem = rhsTensor.layoutMemory();
+    const auto layoutDesc = lhsLayoutMem.get_desc();
+    if (rhs.elements() == 1 || rhsLayoutMem.get_desc() == layoutDesc) {
+      auto dst = toTensor<OneDnnTensor>(
+          lhs.shape(), dnnl::memory(layoutDesc, engine_));
+      const auto binaryPrimitive =
+          dnnl::binary(dnnl::binary::primitive_desc(
+              dnnl::binary::desc(
+                  alg, layoutDesc, rhsLayoutMem.get_desc(), layoutDesc),
+              engine_));
+      stream_->execute(
+          binaryPrimitive,
+          {{DNNL_ARG_SRC_0, lhsLayoutMem},
+           {DNNL_ARG_SRC_1, rhsLayoutMem},
+           {DNNL_ARG_DST, toOneDnnTensor(dst).layoutMemory()}});
+      return dst;
+    }
+  }
+
+  // prepare memories
   auto lhsMem = lhsTensor.memory();
   auto rhsMem = rhsTensor.memory();
   const auto& lhsMemDesc = lhsTensor.memoryDesc();
   const auto& rhsMemDesc = rhsTensor.memoryDesc();
   const auto outputDesc = getBinaryOpOutputDesc(
       lhs.shape(), lhsMemDesc, rhs.shape(), rhsMemDesc, dstType);
-  auto dstMem = dnnl::memory(outputDesc.dstMemDesc, engine_);
+  auto dst =
+      toTensor<OneDnnTensor>(outputDesc.dstShape, outputDesc.dstMemDesc);
+  auto& dstMem = toOneDnnTensor(dst).memory();
 
   // prepare primitive
   const auto binaryDesc =
@@ -1148,8 +1624,8 @@ Tensor OneDnnBackend::applyBinop(
   };
 
   // execute primitive
-  binaryPrimitive.execute(stream_->handle(), args);
-  return toTensor<OneDnnTensor>(outputDesc.dstShape, std::move(dstMem));
+  stream_->execute(binaryPrimitive, args);
+  return dst;
 }
 
 Tensor OneDnnBackend::power(const Tensor& /* lhs */, const Tensor& /* rhs */) {
@@ -1168,46 +1644,83 @@ Tensor OneDnnBackend::matmul(
     const Tensor& rhs,
     MatrixProperty lhsProp,
     MatrixProperty rhsProp) {
+  return matmulWithPostOps(
+      lhs, rhs, nullptr, lhsProp, rhsProp, 1, 1, MatmulActivation::None);
+}
+
+Tensor OneDnnBackend::fusedMatmul(
+    const Tensor& lhs,
+    const Tensor& rhs,
+    const Tensor& bias,
+    MatrixProperty lhsProp,
+    MatrixProperty rhsProp,
+    double alpha,
+    double beta,
+    MatmulActivation activation) {
+  return matmulWithPostOps(
+      lhs,
+      rhs,
+      bias.isEmpty() ? nullptr : &bias,
+      lhsProp,
+      rhsProp,
+      alpha,
+      beta,
+      activation);
+}
+
+Tensor OneDnnBackend::matmulWithPostOps(
+    const Tensor& lhs,
+    const Tensor& rhs,
+    const Tensor* bias,
+    MatrixProperty lhsProp,
+    MatrixProperty rhsProp,
+    double alpha,
+    double beta,
+    MatmulActivation activation) {
   std::vector<Dim> lhsDims = lhs.shape().get();
   std::vector<Dim> rhsDims = rhs.shape().get();
   const bool isLhsScalarOrVector = lhsDims.size() <= 1;
   const bool isRhsScalarOrVector = rhsDims.size() <= 1;
-  auto& lhsTensor = toOneDnnTensor(lhs);
-  auto& rhsTensor = toOneDnnTensor(rhs);
-  auto lhsMem = lhsTensor.memory();
-  auto rhsMem = rhsTensor.memory();
-  auto lhsMemDesc = lhsTensor.memoryDesc();
-  auto rhsMemDesc = rhsTensor.memoryDesc();
   if (isLhsScalarOrVector) { // pad to (1 x 1/K)
     lhsDims.insert(lhsDims.end(), 2 - lhsDims.size(), 1);
     std::reverse(lhsDims.begin(), lhsDims.end());
-    lhsMemDesc = lhsMemDesc.reshape(detail::flDimsToOneDnnDims(lhsDims));
-  } else if (lhsProp == MatrixProperty::Transpose) {
-    std::swap(lhsDims[0], lhsDims[1]);
-    lhsMemDesc = transposeInnerMatrix(lhsMemDesc);
   }
   if (isRhsScalarOrVector) { // pad to (1/K x 1)
     rhsDims.insert(rhsDims.end(), 2 - rhsDims.size(), 1);
-    rhsMemDesc = rhsMemDesc.reshape(detail::flDimsToOneDnnDims(rhsDims));
-  } else if (rhsProp == MatrixProperty::Transpose) {
-    std::swap(rhsDims[0], rhsDims[1]);
-    rhsMemDesc = transposeInnerMatrix(rhsMemDesc);
-  }
-
-  // shape check (TODO support broadcasting)
-  if (!(lhsDims.at(1) == rhsDims.at(0) &&
-        std::equal(
-            lhsDims.begin() + 2,
-            lhsDims.end(),
-            rhsDims.begin() + 2,
-            rhsDims.end()))) {
+  }
+  auto& lhsTensor = toOneDnnTensor(lhs);
+  auto& rhsTensor = toOneDnnTensor(rhs);
+  auto lhsMem = lhsTensor.memory();
+  auto rhsMem = rhsTensor.memory();
+  // batch dims are padded to the larger rank for broadcasting
+  const auto ndims = std::max(lhsDims.size(), rhsDims.size());
+  const auto lhsMemDesc = matmulOperandMemDesc(
+      lhsTensor.memoryDesc(),
+      lhsDims,
+      ndims,
+      !isLhsScalarOrVector && lhsProp == MatrixProperty::Transpose);
+  const auto rhsMemDesc = matmulOperandMemDesc(
+      rhsTensor.memoryDesc(),
+      rhsDims,
+      ndims,
+      !isRhsScalarOrVector && rhsProp == MatrixProperty::Transpose);
+
+  // shape check, where batch dims of 1 are broadcast
+  const auto lhsMatDims = detail::oneDnnDimsToShape(lhsMemDesc.dims()).get();
+  const auto rhsMatDims = detail::oneDnnDimsToShape(rhsMemDesc.dims()).get();
+  bool isValid = lhsMatDims[1] == rhsMatDims[0];
+  std::vector<Dim> dstDims = {lhsMatDims[0], rhsMatDims[1]};
+  for (size_t i = 2; i < ndims; ++i) {
+    isValid &= lhsMatDims[i] == rhsMatDims[i] || lhsMatDims[i] == 1 ||
+        rhsMatDims[i] == 1;
+    dstDims.push_back(lhsMatDims[i] == 1 ? rhsMatDims[i] : lhsMatDims[i]);
+  }
+  if (!isValid) {
     std::ostringstream oss;
     oss << "Cannot perform matmul for tensors of shapes: " << lhs.shape()
         << " and " << rhs.shape();
     throw std::invalid_argument(oss.str());
   }
-  std::vector<Dim> dstDims = lhsDims;
-  dstDims[1] = rhsDims[1];
   Shape dstShape(dstDims);
 
   // prepare memories
@@ -1223,7 +1736,8 @@ Tensor OneDnnBackend::matmul(
     dstMemDesc = dstMemArgDesc.reshape({elems});
     dstShape = {elems};
   }
-  auto dstMem = dnnl::memory(dstMemDesc, engine_);
+  auto dst = toTensor<OneDnnTensor>(dstShape, dstMemDesc);
+  auto& dstMem = toOneDnnTensor(dst).memory();
 
   // NOTE since our physical representation is a transpose of the logical
   // representation, we must switch lhs/rhs during matmul. i.e.,
@@ -1237,23 +1751,65 @@ Tensor OneDnnBackend::matmul(
   const auto& weightsMemDesc = lhsMemDesc;
   auto& weightsMem = lhsMem;
 
-  // prepare primitive
-  const auto matmulDesc =
-      dnnl::matmul::desc(srcMemDesc, weightsMemDesc, dstMemArgDesc);
-  const auto matmulPrimitiveDesc =
-      dnnl::matmul::primitive_desc(matmulDesc, engine_);
-  const auto matmulPrimitive = dnnl::matmul(matmulPrimitiveDesc);
-
   // prepare arguments.
-  const std::unordered_map<int, dnnl::memory> args = {
+  std::unordered_map<int, dnnl::memory> args = {
       {DNNL_ARG_SRC, srcMem},
       {DNNL_ARG_WEIGHTS, weightsMem},
       {DNNL_ARG_DST, dstMem},
   };
 
+  // prepare post-ops, computing
+  //   activation(beta * ((alpha / beta) * product + bias))
+  // since OneDNN only scales the product, and not the binary post-op input
+  dnnl::primitive_attr attr;
+  dnnl::post_ops postOps;
+  const bool addBias = bias != nullptr && beta != 0;
+  const double productScale = addBias ? alpha / beta : alpha;
+  if (productScale != 1) {
+    attr.set_output_scales(0, {static_cast<float>(productScale)});
+  }
+  if (addBias) {
+    // throws if the bias can't be broadcast
+    detail::fusedMatmulBiasShape(bias->shape(), Shape(dstDims));
+    auto& biasTensor = toOneDnnTensor(*bias);
+    auto biasMem = biasTensor.memory();
+    const auto biasMemDesc = matmulOperandMemDesc(
+        biasTensor.memoryDesc(),
+        bias->ndim() == 0 ? std::vector<Dim>{1} : bias->shape().get(),
+        ndims,
+        /* transpose = */ false);
+    postOps.append_binary(dnnl::algorithm::binary_add, biasMemDesc);
+    args.insert(
+        {DNNL_ARG_ATTR_MULTIPLE_POST_OP(0) | DNNL_ARG_SRC_1, biasMem});
+    if (beta != 1) {
+      postOps.append_eltwise(1, dnnl::algorithm::eltwise_linear, beta, 0);
+    }
+  }
+  switch (activation) {
+    case MatmulActivation::None:
+      break;
+    case MatmulActivation::Relu:
+      postOps.append_eltwise(1, dnnl::algorithm::eltwise_relu, 0, 0);
+      break;
+    case MatmulActivation::Sigmoid:
+      postOps.append_eltwise(1, dnnl::algorithm::eltwise_logistic, 0, 0);
+      break;
+    case MatmulActivation::Tanh:
+      postOps.append_eltwise(1, dnnl::algorithm::eltwise_tanh, 0, 0);
+      break;
+  }
+  attr.set_post_ops(postOps);
+
+  // prepare primitive
+  const auto matmulDesc =
+      dnnl::matmul::desc(srcMemDesc, weightsMemDesc, dstMemArgDesc);
+  const auto matmulPrimitiveDesc =
+      dnnl::matmul::primitive_desc(matmulDesc, attr, engine_);
+  const auto matmulPrimitive = dnnl::matmul(matmulPrimitiveDesc);
+
   // execute primitive
-  matmulPrimitive.execute(stream_->handle(), args);
-  return toTensor<OneDnnTensor>(dstShape, std::move(dstMem));
+  stream_->execute(matmulPrimitive, args);
+  return dst;
 }
 
 /************************** Reductions ***************************/
@@ -1274,134 +1830,6 @@ Tensor OneDnnBackend::amax(
       input, dnnl::algorithm::reduction_max, axes, keepDims);
 }
 
-template <typename T, typename LessThan>
-void maxWithIndexCpu(
-    Tensor& values,
-    Tensor& indices,
-    const Shape& inputShape,
-    const std::vector<T>& inputData,
-    const unsigned axis,
-    const bool keepDims,
-    LessThan lt) {
-  const auto inputElemCount = inputShape.elements();
-  const auto axisSize = inputShape.dim(axis);
-  const unsigned axisStride = std::accumulate(
-      inputShape.get().begin(),
-      inputShape.get().begin() + axis,
-      1,
-      std::multiplies<>());
-  const auto resultElemCount = inputElemCount / axisSize;
-  std::vector<T> valuesData;
-  std::vector<int> indicesData;
-  valuesData.reserve(resultElemCount);
-  indicesData.reserve(resultElemCount);
-  // default to falses:
-  auto visited = std::make_unique<bool[]>(inputElemCount);
-  for (unsigned idx = 0; idx < inputElemCount; idx++) {
-    if (!visited[idx]) {
-      visited[idx] = true;
-      T maxVal = inputData[idx];
-      int maxAxisIdx = 0;
-      // search for max element & index along this unvisted axis
-      for (unsigned axisIdx = 1; axisIdx < axisSize; axisIdx++) {
-        int elemIdx = idx + axisIdx * axisStride;
-        assert(!visited[elemIdx]);
-        visited[elemIdx] = true;
-        T elemVal = inputData[elemIdx];
-        if (lt(maxVal, elemVal)) {
-          maxVal = elemVal;
-          maxAxisIdx = axisIdx;
-        }
-      }
-      valuesData.push_back(maxVal);
-      indicesData.push_back(maxAxisIdx);
-    }
-  }
-  // write data to output tensors
-  std::vector<Dim> outputDims = inputShape.get();
-  if (keepDims) {
-    outputDims[axis] = 1;
-  } else {
-    outputDims.erase(outputDims.begin() + axis);
-  }
-  auto valType = dtype_traits<T>::fl_type;
-  values = toTensor<OneDnnTensor>(
-      Shape(outputDims), valType, valuesData.data(), Location::Host);
-  indices = toTensor<OneDnnTensor>(
-      Shape(outputDims), dtype::s32, indicesData.data(), Location::Host);
-}
-
-template <typename LessThan>
-void maxWithIndexCpu(
-    Tensor& values,
-    Tensor& indices,
-    const Tensor& input,
-    const unsigned axis,
-    const bool keepDims,
-    LessThan lt) {
-  if (axis >= input.ndim()) {
-    std::ostringstream oss;
-    oss << "[OneDnnBackend::min] Axis too large: " << axis
-        << " for tensor of shape: " << input.shape();
-    throw std::invalid_argument(oss.str());
-  }
-  const Shape& inputShape = input.shape();
-  switch (input.type()) {
-    case dtype::f16:
-      throw std::runtime_error("[OneDnnTensor::min] doesn't support f16");
-    case dtype::f32: {
-      auto dataVec = input.toHostVector<float>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::f64: {
-      auto dataVec = input.toHostVector<double>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::b8: {
-      auto dataVec = input.toHostVector<char>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::s16: {
-      auto dataVec = input.toHostVector<short>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::s32: {
-      auto dataVec = input.toHostVector<int>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::s64: {
-      auto dataVec = input.toHostVector<long long>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::u8: {
-      auto dataVec = input.toHostVector<unsigned char>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::u16: {
-      auto dataVec = input.toHostVector<unsigned short>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::u32: {
-      auto dataVec = input.toHostVector<unsigned int>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-    case dtype::u64: {
-      auto dataVec = input.toHostVector<unsigned long long>();
-      maxWithIndexCpu(values, indices, inputShape, dataVec, axis, keepDims, lt);
-      return;
-    }
-  }
-}
-
 // TODO move this into a generic CPU backend
 void OneDnnBackend::min(
     Tensor& values,
@@ -1410,8 +1838,8 @@ void OneDnnBackend::min(
     const unsigned axis,
     const bool keepDims) {
   if (allHaveCpuEngines(values, indices, input)) {
-    return maxWithIndexCpu(
-        values, indices, input, axis, keepDims, std::greater<>());
+    return reduceWithIndexCpu(
+        values, indices, input, axis, keepDims, std::less<>());
   } else {
     throw std::runtime_error(
         "[OneDnnBackend::min] unimplemented for non-CPU engine");
@@ -1426,11 +1854,11 @@ void OneDnnBackend::max(
     const unsigned axis,
     const bool keepDims) {
   if (allHaveCpuEngines(values, indices, input)) {
-    return maxWithIndexCpu(
-        values, indices, input, axis, keepDims, std::less<>());
+    return reduceWithIndexCpu(
+        values, indices, input, axis, keepDims, std::greater<>());
   } else {
     throw std::runtime_error(
-        "[OneDnnBackend::min] unimplemented for non-CPU engine");
+        "[OneDnnBackend::max] unimplemented for non-CPU engine");
   }
 }
 
@@ -1442,24 +1870,39 @@ Tensor OneDnnBackend::sum(
       input, dnnl::algorithm::reduction_sum, axes, keepDims);
 }
 
-Tensor OneDnnBackend::cumsum(
-    const Tensor& /* input */,
-    const unsigned /* axis */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+Tensor OneDnnBackend::cumsum(const Tensor& input, const unsigned axis) {
+  const auto src = toCpuKernelInput(input);
+  const detail::AxisLayout layout(input.shape(), axis);
+  // sums of bytes would overflow their type, so they're accumulated in s32
+  const bool isByteType = src.type() == dtype::b8 || src.type() == dtype::u8;
+  auto result = emptyCpuKernelOutput(
+      input.shape(), isByteType ? dtype::s32 : src.type());
+  detail::dispatchCpuKernelType(src.type(), [&](auto tag) {
+    using T = decltype(tag);
+    using SumType = std::conditional_t<std::is_same_v<T, float>, float, int>;
+    detail::cumsum(
+        cpuKernelData<T>(src), cpuKernelData<SumType>(result), layout);
+  });
+  return fromCpuKernelOutput(std::move(result), input.type());
 }
 
 Tensor OneDnnBackend::argmax(
-    const Tensor& /* input */,
-    const unsigned /* axis */,
-    const bool /* keepDims */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const unsigned axis,
+    const bool keepDims) {
+  Tensor values, indices;
+  reduceWithIndexCpu(
+      values, indices, input, axis, keepDims, std::greater<>());
+  return indices;
 }
 
 Tensor OneDnnBackend::argmin(
-    const Tensor& /* input */,
-    const unsigned /* axis */,
-    const bool /* keepDims */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const unsigned axis,
+    const bool keepDims) {
+  Tensor values, indices;
+  reduceWithIndexCpu(values, indices, input, axis, keepDims, std::less<>());
+  return indices;
 }
 
 Tensor OneDnnBackend::mean(
@@ -1471,25 +1914,90 @@ Tensor OneDnnBackend::mean(
 }
 
 Tensor OneDnnBackend::median(
-    const Tensor& /* input */,
-    const std::vector<int>& /* axes */,
-    const bool /* keepDims */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const std::vector<int>& axes,
+    const bool keepDims) {
+  // move the reduced axes to the front, so that each median is taken over a
+  // contiguous line
+  std::vector<bool> isReduced(input.ndim(), axes.empty());
+  for (int axis : axes) {
+    if (axis < 0 || axis >= input.ndim()) {
+      std::ostringstream oss;
+      oss << "[OneDnnBackend::median] Invalid axis for reduction: " << axis
+          << " for tensor of shape: " << input.shape();
+      throw std::invalid_argument(oss.str());
+    }
+    isReduced[axis] = true;
+  }
+  std::vector<Dim> permutation;
+  std::vector<Dim> dstDims;
+  size_t reducedSize = 1;
+  for (int axis = 0; axis < input.ndim(); ++axis) {
+    if (isReduced[axis]) {
+      permutation.push_back(axis);
+      reducedSize *= input.dim(axis);
+    }
+  }
+  for (int axis = 0; axis < input.ndim(); ++axis) {
+    if (!isReduced[axis]) {
+      permutation.push_back(axis);
+      dstDims.push_back(input.dim(axis));
+    } else if (keepDims) {
+      dstDims.push_back(1);
+    }
+  }
+  const bool isSorted = std::is_sorted(permutation.begin(), permutation.end());
+  const auto src = isSorted
+      ? toCpuKernelInput(input)
+      : toCpuKernelInput(transpose(input, Shape(permutation)));
+
+  const Shape dstShape(dstDims);
+  auto result = emptyCpuKernelOutput(dstShape, dtype::f32);
+  detail::dispatchCpuKernelType(src.type(), [&](auto tag) {
+    using T = decltype(tag);
+    detail::medianAlongAxis(
+        cpuKernelData<T>(src),
+        cpuKernelData<float>(result),
+        detail::AxisLayout(1, reducedSize, dstShape.elements()));
+  });
+  return fromCpuKernelOutput(std::move(result), input.type());
 }
 
 Tensor OneDnnBackend::var(
-    const Tensor& /* input */,
-    const std::vector<int>& /* axes */,
-    const bool /* bias */,
-    const bool /* keepDims */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const std::vector<int>& axes,
+    const bool bias,
+    const bool keepDims) {
+  const auto src = isFloatType(input.type()) ? input.shallowCopy()
+                                             : input.astype(dtype::f32);
+  Dim count = 1;
+  if (axes.empty()) {
+    count = input.elements();
+  }
+  for (int axis : axes) {
+    count *= input.dim(axis);
+  }
+  // bias = true is the unbiased (sample) estimate, as in the other backends
+  const float scale = 1.f / std::max<Dim>(1, bias ? count - 1 : count);
+  const auto centered = applyBinop(
+      src,
+      applyReductionOp(src, dnnl::algorithm::reduction_mean, axes, true),
+      dnnl::algorithm::binary_sub);
+  const auto squared =
+      applyEltwiseOp(centered, dnnl::algorithm::eltwise_square);
+  return applyEltwiseOp(
+      applyReductionOp(
+          squared, dnnl::algorithm::reduction_sum, axes, keepDims),
+      dnnl::algorithm::eltwise_linear,
+      scale);
 }
 
 Tensor OneDnnBackend::std(
-    const Tensor& /* input */,
-    const std::vector<int>& /* axes */,
-    const bool /* keepDims */) {
-  FL_ONEDNN_BACKEND_UNIMPLEMENTED;
+    const Tensor& input,
+    const std::vector<int>& axes,
+    const bool keepDims) {
+  const auto variance = var(input, axes, /* bias = */ false, keepDims);
+  return applyEltwiseOp(variance, dnnl::algorithm::eltwise_sqrt);
 }
 
 Tensor OneDnnBackend::norm(
@@ -1575,7 +2083,8 @@ Tensor OneDnnBackend::applyReductionOp(
     dstMemDesc = detail::oneDnnContiguousMemDescFromShape(
         dstShape, srcMemDesc.data_type());
   }
-  auto dstMem = dnnl::memory(dstMemDesc, engine_);
+  auto dst = toTensor<OneDnnTensor>(dstShape, dstMemDesc);
+  auto& dstMem = toOneDnnTensor(dst).memory();
 
   // prepare arguments.
   const std::unordered_map<int, dnnl::memory> args = {
@@ -1584,8 +2093,8 @@ Tensor OneDnnBackend::applyReductionOp(
   };
 
   // execute primitive
-  reductionPrimitive.execute(stream_->handle(), args);
-  return toTensor<OneDnnTensor>(dstShape, std::move(dstMem));
+  stream_->execute(reductionPrimitive, args);
+  return dst;
 }
 
 void OneDnnBackend::print(const Tensor& tensor) {
@@ -13,6 +13,7 @@
 #include <optional>
 
 #include "flashlight/fl/tensor/backend/onednn/OneDnnCPUStream.h"
+#include "flashlight/fl/tensor/backend/onednn/OneDnnHostAllocator.h"
 
 #if FL_USE_MKL_RNG
   #include <mkl_vsl.h>
@@ -28,6 +29,7 @@ namespace fl {
 class OneDnnBackend : public TensorBackend {
   dnnl::engine engine_;
   std::shared_ptr<OneDnnCPUStream> stream_;
+  std::shared_ptr<OneDnnHostAllocator> hostAllocator_;
 #if FL_USE_MKL_RNG
   VSLStreamStatePtr randStream_;
 #else
@@ -56,6 +58,18 @@ class OneDnnBackend : public TensorBackend {
       const std::vector<int>& axes,
       const bool keepDims);
 
+  // Matrix multiplication, followed by the post-ops of `fusedMatmul` (with
+  // no bias if `bias` is null), as a single primitive
+  Tensor matmulWithPostOps(
+      const Tensor& lhs,
+      const Tensor& rhs,
+      const Tensor* bias,
+      MatrixProperty lhsProp,
+      MatrixProperty rhsProp,
+      double alpha,
+      double beta,
+      MatmulActivation activation);
+
   Tensor randnCpu(const Shape& shape, dtype type);
   Tensor randCpu(const Shape& shape, dtype type);
 
@@ -82,6 +96,14 @@ class OneDnnBackend : public TensorBackend {
    */
   const Stream& stream() const;
 
+  /**
+   * Gets the active OneDNN stream, through which OneDNN primitives are
+   * executed.
+   *
+   * @return the active OneDNN stream.
+   */
+  OneDnnCPUStream& oneDnnStream() const;
+
   /**
    * Gets the active native OneDNN stream.
    *
@@ -103,6 +125,13 @@ class OneDnnBackend : public TensorBackend {
    */
   const dnnl::engine& cpuEngine() const;
 
+  /**
+   * Gets the caching allocator which backs the host memory of OneDnnTensors.
+   *
+   * @return the host allocator.
+   */
+  OneDnnHostAllocator& hostAllocator() const;
+
   /* -------------------------- Compute Functions -------------------------- */
   void eval(const Tensor& tensor) override;
   bool supportsDataType(const fl::dtype& dtype) const override;
@@ -265,6 +294,15 @@ class OneDnnBackend : public TensorBackend {
       const Tensor& rhs,
       MatrixProperty lhsProp,
       MatrixProperty rhsProp) override;
+  Tensor fusedMatmul(
+      const Tensor& lhs,
+      const Tensor& rhs,
+      const Tensor& bias,
+      MatrixProperty lhsProp,
+      MatrixProperty rhsProp,
+      double alpha,
+      double beta,
+      MatmulActivation activation) override;
 
   /************************** Reductions ***************************/
   Tensor amin(
@@ -7,29 +7,416 @@
 
 #include "flashlight/fl/tensor/backend/onednn/OneDnnCPUStream.h"
 
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
 
 namespace fl {
 
-OneDnnCPUStream::OneDnnCPUStream(const dnnl::engine& engine) {
+namespace {
+
+constexpr const char* kModeEnv = "FL_ONEDNN_STREAM_MODE";
+constexpr const char* kNumWorkersEnv = "FL_ONEDNN_STREAM_WORKERS";
+
+// Readers of a buffer are pruned of finished work past this many.
+constexpr size_t kMaxTrackedReaders = 64;
+
+// Whether a primitive only reads the given argument. Everything else is
+// conservatively assumed to be written.
+bool isSourceArg(const int arg) {
+  if (arg >= DNNL_ARG_MULTIPLE_SRC && arg < DNNL_ARG_MULTIPLE_DST) {
+    return true;
+  }
+  // inputs of post-ops, e.g., the other operand of a binary post-op
+  if (arg & DNNL_ARG_ATTR_MULTIPLE_POST_OP_BASE) {
+    return true;
+  }
+  switch (arg) {
+    case DNNL_ARG_SRC_0:
+    case DNNL_ARG_SRC_1:
+    case DNNL_ARG_SRC_2:
+    case DNNL_ARG_WEIGHTS_0:
+    case DNNL_ARG_WEIGHTS_1:
+    case DNNL_ARG_WEIGHTS_2:
+    case DNNL_ARG_WEIGHTS_3:
+    case DNNL_ARG_BIAS:
+    case DNNL_ARG_SCALE_SHIFT:
+    case DNNL_ARG_DIFF_DST_0:
+    case DNNL_ARG_DIFF_DST_1:
+    case DNNL_ARG_DIFF_DST_2:
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+/**
+ * Runs the work of an asynchronous stream on worker threads. Work is given ids
+ * in submission order, and only starts once the earlier work it depends on is
+ * done:
+ * - work reading a buffer depends on the last work writing it.
+ * - work writing a buffer depends on the last work writing it, and all work
+ *   reading it since.
+ * - work submitted after a barrier depends on the barrier.
+ */
+class OneDnnCPUStream::Scheduler {
+ public:
+  using Work = std::function<void(dnnl::stream&)>;
+
+  Scheduler(const dnnl::engine& engine, const unsigned numWorkers)
+      : engine_(engine) {
+    for (unsigned i = 0; i < numWorkers; ++i) {
+      workers_.emplace_back([this]() { workerLoop(); });
+    }
+  }
+
+  ~Scheduler() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      doneCv_.wait(lock, [this]() { return isIdle(); });
+      stop_ = true;
+    }
+    readyCv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  uint64_t submit(
+      Work work,
+      const std::vector<const void*>& reads,
+      const std::vector<const void*>& writes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t id = ++lastId_;
+    Task task{std::move(work)};
+    dependOn(task, id, barrier_);
+    for (const auto* buffer : reads) {
+      auto& access = buffers_[buffer];
+      dependOn(task, id, access.writer);
+      if (access.readers.size() >= kMaxTrackedReaders) {
+        pruneFinished(access.readers);
+      }
+      access.readers.push_back(id);
+    }
+    for (const auto* buffer : writes) {
+      auto& access = buffers_[buffer];
+      dependOn(task, id, access.writer);
+      for (const auto reader : access.readers) {
+        dependOn(task, id, reader);
+      }
+      access.readers.clear();
+      access.writer = id;
+    }
+    schedule(id, std::move(task));
+    return id;
+  }
+
+  // Work which all later work depends on, e.g., to wait for another stream.
+  void submitBarrier(Work work) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t id = ++lastId_;
+    Task task{std::move(work)};
+    dependOn(task, id, barrier_);
+    barrier_ = id;
+    schedule(id, std::move(task));
+  }
+
+  uint64_t lastSubmitted() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastId_;
+  }
+
+  // Block until all work with ids up to `id` is done.
+  void waitUntilDone(const uint64_t id) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [this, id]() {
+      return pending_.empty() || pending_.begin()->first > id;
+    });
+  }
+
+  // Block until all submitted work (and the callbacks deferred until it is
+  // done) is done, and rethrow its first error.
+  void sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [this]() { return isIdle(); });
+    if (error_) {
+      std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+  }
+
+  bool deferUntilDone(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) {
+      return false;
+    }
+    deferred_.emplace_back(lastId_, std::move(callback));
+    return true;
+  }
+
+ private:
+  struct Task {
+    Work work;
+    size_t numDependencies{0};
+    std::vector<uint64_t> dependents;
+  };
+
+  struct BufferAccess {
+    uint64_t writer{0}; // 0 if none
+    std::vector<uint64_t> readers;
+  };
+
+  const dnnl::engine engine_;
+  mutable std::mutex mutex_;
+  std::condition_variable readyCv_;
+  mutable std::condition_variable doneCv_;
+  // unfinished work, by id
+  std::map<uint64_t, Task> pending_;
+  std::deque<uint64_t> ready_;
+  std::unordered_map<const void*, BufferAccess> buffers_;
+  uint64_t lastId_{0};
+  uint64_t barrier_{0};
+  // callbacks to run once all work up to the given id is done
+  std::deque<std::pair<uint64_t, std::function<void()>>> deferred_;
+  size_t numRunningCallbacks_{0};
+  std::exception_ptr error_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+
+  // Requires holding `mutex_`.
+  bool isIdle() const {
+    return pending_.empty() && numRunningCallbacks_ == 0;
+  }
+
+  // Requires holding `mutex_`.
+  void dependOn(Task& task, const uint64_t id, const uint64_t dependency) {
+    if (dependency == id) {
+      return;
+    }
+    auto it = pending_.find(dependency);
+    if (it != pending_.end()) {
+      it->second.dependents.push_back(id);
+      ++task.numDependencies;
+    }
+  }
+
+  // Requires holding `mutex_`.
+  void pruneFinished(std::vector<uint64_t>& ids) const {
+    std::vector<uint64_t> unfinished;
+    for (const auto id : ids) {
+      if (pending_.count(id)) {
+        unfinished.push_back(id);
+      }
+    }
+    ids = std::move(unfinished);
+  }
+
+  // Requires holding `mutex_`.
+  void schedule(const uint64_t id, Task&& task) {
+    const bool isReady = task.numDependencies == 0;
+    pending_.emplace(id, std::move(task));
+    if (isReady) {
+      ready_.push_back(id);
+      readyCv_.notify_one();
+    }
+  }
+
+  void workerLoop() {
+    // OneDNN streams aren't thread safe, so each worker has its own
+    dnnl::stream stream(engine_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      readyCv_.wait(lock, [this]() { return stop_ || !ready_.empty(); });
+      if (ready_.empty()) {
+        return; // stopped
+      }
+      const auto id = ready_.front();
+      ready_.pop_front();
+      auto work = std::move(pending_.at(id).work);
+      lock.unlock();
+
+      std::exception_ptr error;
+      try {
+        work(stream);
+        stream.wait();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      work = nullptr; // release the arguments before the deferred callbacks
+
+      lock.lock();
+      if (error && !error_) {
+        error_ = error;
+      }
+      finish(id, lock);
+    }
+  }
+
+  // Requires holding `mutex_` through `lock`, which is released while running
+  // the deferred callbacks.
+  void finish(const uint64_t id, std::unique_lock<std::mutex>& lock) {
+    auto node = pending_.extract(id);
+    for (const auto dependent : node.mapped().dependents) {
+      if (--pending_.at(dependent).numDependencies == 0) {
+        ready_.push_back(dependent);
+        readyCv_.notify_one();
+      }
+    }
+    if (pending_.empty()) {
+      buffers_.clear();
+    }
+
+    const uint64_t firstPending = pending_.empty()
+        ? std::numeric_limits<uint64_t>::max()
+        : pending_.begin()->first;
+    std::vector<std::function<void()>> callbacks;
+    while (!deferred_.empty() && deferred_.front().first < firstPending) {
+      callbacks.push_back(std::move(deferred_.front().second));
+      deferred_.pop_front();
+    }
+    if (!callbacks.empty()) {
+      ++numRunningCallbacks_;
+      lock.unlock();
+      for (auto& callback : callbacks) {
+        callback();
+      }
+      lock.lock();
+      --numRunningCallbacks_;
+    }
+    doneCv_.notify_all();
+  }
+};
+
+OneDnnCPUStream::OneDnnCPUStream(
+    const dnnl::engine& engine,
+    const Mode mode,
+    const unsigned numWorkers)
+    : mode_(mode) {
   stream_ = std::make_unique<dnnl::stream>(engine);
+  if (mode == Mode::Asynchronous) {
+    scheduler_ = std::make_shared<Scheduler>(engine, numWorkers);
+  }
 }
 
+OneDnnCPUStream::~OneDnnCPUStream() = default;
+
 std::shared_ptr<OneDnnCPUStream> OneDnnCPUStream::create(
-    const dnnl::engine& engine) {
+    const dnnl::engine& engine,
+    const Mode mode /* = defaultMode() */,
+    const unsigned numWorkers /* = defaultNumWorkers() */) {
   if (engine.get_kind() != dnnl::engine::kind::cpu) {
     throw std::invalid_argument("OneDnnCPUStream expects a CPU engine");
   }
-  const auto rawStreamPtr = new OneDnnCPUStream(engine);
+  if (mode == Mode::Asynchronous && numWorkers == 0) {
+    throw std::invalid_argument(
+        "OneDnnCPUStream: asynchronous streams need at least one worker");
+  }
+  const auto rawStreamPtr = new OneDnnCPUStream(engine, mode, numWorkers);
   const auto stream = std::shared_ptr<OneDnnCPUStream>(rawStreamPtr);
   rawStreamPtr->device_.addStream(stream);
   return stream;
 }
 
+OneDnnCPUStream::Mode OneDnnCPUStream::defaultMode() {
+  const char* env = std::getenv(kModeEnv);
+  return env != nullptr && std::string(env) == "async" ? Mode::Asynchronous
+                                                       : Mode::Synchronous;
+}
+
+unsigned OneDnnCPUStream::defaultNumWorkers() {
+  const char* env = std::getenv(kNumWorkersEnv);
+  if (env != nullptr) {
+    const long numWorkers = std::strtol(env, nullptr, 10);
+    if (numWorkers > 0) {
+      return numWorkers;
+    }
+  }
+  return 1;
+}
+
+OneDnnCPUStream::Mode OneDnnCPUStream::mode() const {
+  return mode_;
+}
+
+StreamType OneDnnCPUStream::type() const {
+  return mode_ == Mode::Asynchronous ? StreamType::Asynchronous
+                                     : StreamType::Synchronous;
+}
+
 void OneDnnCPUStream::sync() const {
+  if (scheduler_) {
+    scheduler_->sync();
+  }
   stream_->wait();
 }
 
+void OneDnnCPUStream::relativeSync(const SynchronousStream& waitOn) const {
+  const auto* other = dynamic_cast<const OneDnnCPUStream*>(&waitOn);
+  if (other == this) {
+    return; // work on a stream is ordered already
+  }
+  if (scheduler_ && other && other->scheduler_) {
+    // read before submitting the barrier, so that `waitUntil` never covers a
+    // barrier waiting on this stream's later work
+    const auto waitUntil = other->scheduler_->lastSubmitted();
+    scheduler_->submitBarrier(
+        [scheduler = other->scheduler_, waitUntil](dnnl::stream&) {
+          scheduler->waitUntilDone(waitUntil);
+        });
+    return;
+  }
+  waitOn.sync();
+}
+
+void OneDnnCPUStream::execute(
+    const dnnl::primitive& primitive,
+    const std::unordered_map<int, dnnl::memory>& args) {
+  if (!scheduler_) {
+    primitive.execute(*stream_, args);
+    return;
+  }
+  std::vector<const void*> reads;
+  std::vector<const void*> writes;
+  for (const auto& [arg, memory] : args) {
+    const void* buffer = memory.get_data_handle();
+    if (buffer != nullptr) {
+      (isSourceArg(arg) ? reads : writes).push_back(buffer);
+    }
+  }
+  scheduler_->submit(
+      [primitive, args](dnnl::stream& stream) {
+        primitive.execute(stream, args);
+      },
+      reads,
+      writes);
+}
+
+void OneDnnCPUStream::enqueue(
+    std::function<void()> fn,
+    const std::vector<const void*>& reads,
+    const std::vector<const void*>& writes) {
+  if (!scheduler_) {
+    fn();
+    return;
+  }
+  scheduler_->submit(
+      [fn = std::move(fn)](dnnl::stream&) { fn(); }, reads, writes);
+}
+
+bool OneDnnCPUStream::deferUntilDone(std::function<void()> callback) {
+  return scheduler_ && scheduler_->deferUntilDone(std::move(callback));
+}
+
 dnnl::stream& OneDnnCPUStream::handle() {
   return *stream_;
 }
@@ -7,7 +7,10 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "flashlight/fl/runtime/SynchronousStream.h"
 
@@ -17,26 +20,135 @@ namespace fl {
 
 /**
  * An abstraction for OneDNN's CPU Stream with controlled creation methods.
+ *
+ * The stream runs in one of two modes:
+ * - `Mode::Synchronous`: work is executed on the calling thread as soon as it
+ *   is submitted.
+ * - `Mode::Asynchronous`: work is only enqueued, and executed by the stream's
+ *   worker threads, so that the calling thread can run ahead and build the
+ *   next ops. A dependency tracker orders work by the buffers it reads and
+ *   writes, so that work on independent buffers may run concurrently (with
+ *   more than one worker) while work on shared buffers keeps its submission
+ *   order. `sync` blocks until all submitted work completed, and rethrows the
+ *   first error thrown by any of it.
+ *
+ * The default mode and number of workers can be set with environment
+ * variables:
+ * - `FL_ONEDNN_STREAM_MODE`: `async` for `Mode::Asynchronous`.
+ * - `FL_ONEDNN_STREAM_WORKERS`: number of workers of asynchronous streams (1
+ *   by default, i.e., work runs in submission order on one worker thread).
  */
 class OneDnnCPUStream : public SynchronousStream {
+ public:
+  enum class Mode { Synchronous, Asynchronous };
+
+ private:
+  // Tracks and runs the work of asynchronous streams, defined in the
+  // translation unit.
+  class Scheduler;
+
   std::unique_ptr<dnnl::stream> stream_; // stored as a pointer to satisfy `sync() const`
+  const Mode mode_;
+  std::shared_ptr<Scheduler> scheduler_; // only set in asynchronous mode
 
   // internal constructor used to create the native OneDNN stream.
-  explicit OneDnnCPUStream(const dnnl::engine& engine);
+  OneDnnCPUStream(const dnnl::engine& engine, Mode mode, unsigned numWorkers);
 
  public:
+  // prevent name hiding
+  using SynchronousStream::relativeSync;
+
+  ~OneDnnCPUStream() override;
+
   /**
    * Creates an OneDnnCPUStream on given engine and automatically register it
    * with the active x64 device from DeviceManager.
    *
    * @param[in] engine is the cpu engine on which the stream will be created.
+   * @param[in] mode the execution mode of the stream.
+   * @param[in] numWorkers the number of worker threads executing the work of
+   * an asynchronous stream.
    * @return a shared pointer to the created OneDnnCPUStream.
-   * @throws invalid_argument if given engine is not a CPU engine.
+   * @throws invalid_argument if given engine is not a CPU engine, or if an
+   * asynchronous stream is given no worker.
+   */
+  static std::shared_ptr<OneDnnCPUStream> create(
+      const dnnl::engine& engine,
+      Mode mode = defaultMode(),
+      unsigned numWorkers = defaultNumWorkers());
+
+  /**
+   * @return the mode set by `FL_ONEDNN_STREAM_MODE`, synchronous by default.
+   */
+  static Mode defaultMode();
+
+  /**
+   * @return the number of workers set by `FL_ONEDNN_STREAM_WORKERS`, 1 by
+   * default.
+   */
+  static unsigned defaultNumWorkers();
+
+  Mode mode() const;
+
+  /**
+   * @return `StreamType::Asynchronous` in asynchronous mode, and
+   * `StreamType::Synchronous` otherwise.
    */
-  static std::shared_ptr<OneDnnCPUStream> create(const dnnl::engine& engine);
+  StreamType type() const override;
 
   void sync() const override;
 
+  /**
+   * Future work on this stream only starts after the completion of the work
+   * currently submitted to `waitOn`. If both streams are asynchronous
+   * OneDnnCPUStreams, this doesn't block the calling thread.
+   *
+   * Waiting on this stream itself is a no-op. Streams waiting on each other
+   * can't deadlock: the work this stream waits for is fixed before the wait is
+   * submitted, so it never includes a later wait on this stream.
+   */
+  void relativeSync(const SynchronousStream& waitOn) const override;
+
+  /**
+   * Executes a OneDNN primitive on this stream. The memories in `args` are the
+   * dependencies of the execution: source arguments are read, and all others
+   * (destinations, workspaces, ...) are assumed to be written.
+   *
+   * NOTE in asynchronous mode, the buffers behind `args` must stay alive until
+   * the execution completed; buffers from the backend's host allocator are
+   * only recycled after the work submitted before their release completed.
+   *
+   * @param[in] primitive the primitive to execute.
+   * @param[in] args the arguments of the primitive.
+   */
+  void execute(
+      const dnnl::primitive& primitive,
+      const std::unordered_map<int, dnnl::memory>& args);
+
+  /**
+   * Runs `fn` on this stream, ordered after the work accessing the buffers in
+   * `reads` or `writes`, and before later work accessing the buffers it
+   * writes.
+   *
+   * @param[in] fn the function to run.
+   * @param[in] reads the data handles of the buffers `fn` reads.
+   * @param[in] writes the data handles of the buffers `fn` writes.
+   */
+  void enqueue(
+      std::function<void()> fn,
+      const std::vector<const void*>& reads,
+      const std::vector<const void*>& writes);
+
+  /**
+   * Runs `callback` once all work submitted so far completed, on the thread
+   * which completes it, unless there is no such work.
+   *
+   * @param[in] callback the function to defer.
+   * @return true if `callback` was deferred, false if the caller should run it
+   * since there is no work to wait for.
+   */
+  bool deferUntilDone(std::function<void()> callback);
+
   /**
    * Gets the underlying OneDNN stream.
    *
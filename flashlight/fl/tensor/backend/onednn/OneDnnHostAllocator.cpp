@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/fl/tensor/backend/onednn/OneDnnHostAllocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+  #include <sched.h>
+  #include <sys/syscall.h>
+#endif // __linux__
+
+namespace fl {
+
+namespace {
+
+// Environment variables names
+constexpr const char* kCacheLimitEnv = "FL_ONEDNN_HOST_CACHE_LIMIT_MB";
+constexpr const char* kHugePagesEnv = "FL_ONEDNN_HOST_HUGE_PAGES";
+constexpr double kMB = static_cast<double>(1UL << 20);
+constexpr size_t kDefaultLogFlushInterval = 50;
+
+std::string formatMemory(size_t bytes) {
+  const std::vector<std::string> units = {"B", "KiB", "MiB", "GiB", "TiB"};
+  size_t unitId =
+      bytes == 0 ? 0 : std::floor(std::log(bytes) / std::log(1024.0));
+  unitId = std::min(unitId, units.size() - 1);
+  std::string bytesStr = std::to_string(bytes / std::pow(1024.0, unitId));
+  bytesStr = bytesStr.substr(0, bytesStr.find(".") + 3);
+  return bytesStr + " " + units[unitId];
+}
+
+size_t getCacheLimitFromEnv() {
+  const char* env = std::getenv(kCacheLimitEnv);
+  if (env == nullptr) {
+    return std::numeric_limits<size_t>::max();
+  }
+  try {
+    return std::round(std::stod(env) * kMB);
+  } catch (const std::exception&) {
+    throw std::invalid_argument(
+        std::string("OneDnnHostAllocator: invalid value for ") +
+        kCacheLimitEnv + ": " + env);
+  }
+}
+
+// Parses a sysfs CPU list such as "0-3,8-11".
+std::vector<int> parseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") {
+      continue;
+    }
+    const auto dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// Returns the NUMA node of each CPU, or an empty vector if the topology can't
+// be read (in which case a single arena is used).
+std::vector<int> readCpuToNode() {
+  std::vector<int> cpuToNode;
+#ifdef __linux__
+  for (int node = 0;; ++node) {
+    std::ifstream cpuList(
+        "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!cpuList) {
+      break;
+    }
+    std::string list;
+    std::getline(cpuList, list);
+    for (int cpu : parseCpuList(list)) {
+      if (cpu >= static_cast<int>(cpuToNode.size())) {
+        cpuToNode.resize(cpu + 1, 0);
+      }
+      cpuToNode[cpu] = node;
+    }
+  }
+#endif // __linux__
+  return cpuToNode;
+}
+
+// Set after the calling thread's caches are destroyed, so that buffers freed
+// later during thread teardown bypass them.
+thread_local bool threadCachesDestroyed = false;
+
+} // namespace
+
+/* -------------------------- Thread caches -------------------------- */
+
+struct OneDnnHostAllocator::ThreadCache {
+  // keeps the allocator alive until this thread's blocks are handed back
+  std::shared_ptr<OneDnnHostAllocator> owner;
+  // cached blocks by size class
+  std::unordered_map<size_t, std::vector<Block>> blocks;
+  size_t bytes{0};
+
+  explicit ThreadCache(std::shared_ptr<OneDnnHostAllocator> allocator)
+      : owner(std::move(allocator)) {}
+
+  ~ThreadCache() {
+    flush();
+  }
+
+  bool pop(size_t size, Block& block) {
+    auto it = blocks.find(size);
+    if (it == blocks.end() || it->second.empty()) {
+      return false;
+    }
+    block = it->second.back();
+    it->second.pop_back();
+    bytes -= size;
+    owner->cachedBytes_ -= size;
+    return true;
+  }
+
+  bool push(const Block& block) {
+    if (bytes + block.size > kThreadCacheCapacity) {
+      return false;
+    }
+    blocks[block.size].push_back(block);
+    bytes += block.size;
+    owner->cachedBytes_ += block.size;
+    return true;
+  }
+
+  void flush() {
+    for (auto& [size, sizeBlocks] : blocks) {
+      for (const auto& block : sizeBlocks) {
+        owner->cachedBytes_ -= size;
+        owner->releaseToArena(block);
+      }
+    }
+    blocks.clear();
+    bytes = 0;
+  }
+};
+
+namespace {
+
+struct ThreadCaches {
+  std::unordered_map<
+      const OneDnnHostAllocator*,
+      std::unique_ptr<OneDnnHostAllocator::ThreadCache>>
+      caches;
+
+  ~ThreadCaches() {
+    threadCachesDestroyed = true;
+    caches.clear();
+  }
+};
+
+thread_local ThreadCaches threadCaches;
+
+} // namespace
+
+/* -------------------------- Allocator -------------------------- */
+
+OneDnnHostAllocator::Options::Options()
+    : cacheLimit(getCacheLimitFromEnv()), useThreadCache(true) {
+  const char* hugePages = std::getenv(kHugePagesEnv);
+  useHugePages = hugePages == nullptr || std::string(hugePages) != "0";
+}
+
+std::shared_ptr<OneDnnHostAllocator> OneDnnHostAllocator::create(
+    const Options& options /* = Options() */) {
+  return std::shared_ptr<OneDnnHostAllocator>(
+      new OneDnnHostAllocator(options));
+}
+
+OneDnnHostAllocator::OneDnnHostAllocator(const Options& options)
+    : options_(options),
+      cpuToNode_(readCpuToNode()),
+      logFlushInterval_(kDefaultLogFlushInterval) {
+  const int nodes = cpuToNode_.empty()
+      ? 1
+      : *std::max_element(cpuToNode_.begin(), cpuToNode_.end()) + 1;
+  for (int node = 0; node < nodes; ++node) {
+    arenas_.emplace_back(std::make_unique<Arena>());
+  }
+}
+
+OneDnnHostAllocator::~OneDnnHostAllocator() {
+  freeArenaBlocks();
+}
+
+size_t OneDnnHostAllocator::roundSize(size_t bytes) {
+  if (bytes <= kMinBlockSize) {
+    return kMinBlockSize;
+  }
+  // four size classes per power of two bound the internal fragmentation to
+  // 25%; since kMinBlockSize >= 4 * kAlignment, every class stays aligned.
+  const int log2 = std::numeric_limits<unsigned long long>::digits - 1 -
+      __builtin_clzll(bytes - 1);
+  const size_t step = size_t(1) << (log2 - 2);
+  size_t size = (bytes + step - 1) & ~(step - 1);
+  if (size >= kLargeBlockSize) {
+    size = (size + kLargeBlockSize - 1) & ~(kLargeBlockSize - 1);
+  }
+  return size;
+}
+
+int OneDnnHostAllocator::numNodes() const {
+  return arenas_.size();
+}
+
+int OneDnnHostAllocator::currentNode() const {
+#ifdef __linux__
+  if (arenas_.size() > 1) {
+    const int cpu = sched_getcpu();
+    if (cpu >= 0 && cpu < static_cast<int>(cpuToNode_.size())) {
+      return cpuToNode_[cpu];
+    }
+  }
+#endif // __linux__
+  return 0;
+}
+
+OneDnnHostAllocator::ThreadCache* OneDnnHostAllocator::threadCache() {
+  if (!options_.useThreadCache || threadCachesDestroyed) {
+    return nullptr;
+  }
+  auto& cache = threadCaches.caches[this];
+  if (!cache) {
+    cache = std::make_unique<ThreadCache>(shared_from_this());
+  }
+  return cache.get();
+}
+
+std::shared_ptr<void> OneDnnHostAllocator::allocate(size_t bytes) {
+  ++numAllocs_;
+  const size_t size = roundSize(bytes);
+  Block block{nullptr, size, 0};
+
+  if (size <= kThreadCacheMaxBlockSize) {
+    if (auto* cache = threadCache()) {
+      cache->pop(size, block);
+    }
+  }
+  if (block.ptr == nullptr) {
+    block.node = currentNode();
+    auto& arena = *arenas_[block.node];
+    std::lock_guard<std::mutex> lock(arena.mutex);
+    auto it = arena.freeBlocks.find(size);
+    if (it != arena.freeBlocks.end() && !it->second.empty()) {
+      block.ptr = it->second.back();
+      it->second.pop_back();
+      arenaCachedBytes_ -= size;
+      cachedBytes_ -= size;
+    }
+  }
+
+  if (block.ptr != nullptr) {
+    ++numCacheHits_;
+  } else {
+    block.ptr = nativeAlloc(size, block.node);
+    if (block.ptr == nullptr) {
+      // retry after giving the cached blocks back to the OS
+      emptyCache();
+      block.ptr = nativeAlloc(size, block.node);
+    }
+    if (block.ptr == nullptr) {
+      std::ostringstream oss;
+      oss << "OneDnnHostAllocator: failed to allocate " << formatMemory(size)
+          << " (Allocated: " << formatMemory(allocatedBytes_)
+          << ", Cached: " << formatMemory(cachedBytes_) << ")";
+      throw std::runtime_error(oss.str());
+    }
+    allocatedBytes_ += size;
+  }
+  log("alloc", size, block.ptr);
+
+  auto self = shared_from_this();
+  return std::shared_ptr<void>(
+      block.ptr, [self = std::move(self), block](void* /* ptr */) {
+        // deferred blocks skip the thread cache, since they may be recycled
+        // by a thread which never allocates
+        if (!self->releaseHook_ ||
+            !self->releaseHook_([self, block]() {
+              self->log("free", block.size, block.ptr);
+              self->releaseToArena(block);
+            })) {
+          self->release(block);
+        }
+      });
+}
+
+void OneDnnHostAllocator::setReleaseHook(ReleaseHook hook) {
+  releaseHook_ = std::move(hook);
+}
+
+void OneDnnHostAllocator::release(const Block& block) {
+  log("free", block.size, block.ptr);
+  if (block.size <= kThreadCacheMaxBlockSize) {
+    auto* cache = threadCache();
+    if (cache && cache->push(block)) {
+      return;
+    }
+  }
+  releaseToArena(block);
+}
+
+void OneDnnHostAllocator::releaseToArena(const Block& block) {
+  if (arenaCachedBytes_ + block.size > options_.cacheLimit) {
+    nativeFree(block.ptr, block.size);
+    allocatedBytes_ -= block.size;
+    return;
+  }
+  auto& arena = *arenas_[block.node];
+  std::lock_guard<std::mutex> lock(arena.mutex);
+  arena.freeBlocks[block.size].push_back(block.ptr);
+  arenaCachedBytes_ += block.size;
+  cachedBytes_ += block.size;
+}
+
+void OneDnnHostAllocator::emptyCache() {
+  if (!threadCachesDestroyed) {
+    auto it = threadCaches.caches.find(this);
+    if (it != threadCaches.caches.end()) {
+      it->second->flush();
+    }
+  }
+  freeArenaBlocks();
+}
+
+void OneDnnHostAllocator::freeArenaBlocks() {
+  for (auto& arena : arenas_) {
+    std::lock_guard<std::mutex> lock(arena->mutex);
+    for (auto& [size, ptrs] : arena->freeBlocks) {
+      for (void* ptr : ptrs) {
+        nativeFree(ptr, size);
+        allocatedBytes_ -= size;
+        arenaCachedBytes_ -= size;
+        cachedBytes_ -= size;
+      }
+    }
+    arena->freeBlocks.clear();
+  }
+}
+
+void* OneDnnHostAllocator::nativeAlloc(size_t size, int node) {
+  ++numNativeAllocs_;
+  if (size < kLargeBlockSize) {
+    return std::aligned_alloc(kAlignment, size);
+  }
+
+  // Map large blocks directly. Transparent huge pages are only used for
+  // ranges aligned to the huge page size, so over-map and trim if needed.
+  const size_t mapSize = options_.useHugePages ? size + kLargeBlockSize : size;
+  void* mapped = mmap(
+      nullptr,
+      mapSize,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      /* fd = */ -1,
+      /* offset = */ 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  auto* ptr = static_cast<char*>(mapped);
+  if (options_.useHugePages) {
+    const auto addr = reinterpret_cast<uintptr_t>(mapped);
+    auto* aligned = reinterpret_cast<char*>(
+        (addr + kLargeBlockSize - 1) & ~(kLargeBlockSize - 1));
+    const size_t head = aligned - ptr;
+    const size_t tail = mapSize - head - size;
+    if (head > 0) {
+      munmap(ptr, head);
+    }
+    if (tail > 0) {
+      munmap(aligned + size, tail);
+    }
+    ptr = aligned;
+#ifdef MADV_HUGEPAGE
+    madvise(ptr, size, MADV_HUGEPAGE); // best effort
+#endif // MADV_HUGEPAGE
+  }
+#if defined(__linux__) && defined(SYS_mbind)
+  if (arenas_.size() > 1) {
+    // prefer the pages of this block to be placed on the arena's node; best
+    // effort, as with first-touch placement for smaller blocks.
+    constexpr int kMpolPreferred = 1;
+    constexpr size_t kBitsPerMask = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> nodeMask(arenas_.size() / kBitsPerMask + 1, 0);
+    nodeMask[node / kBitsPerMask] |= 1UL << (node % kBitsPerMask);
+    syscall(
+        SYS_mbind,
+        ptr,
+        size,
+        kMpolPreferred,
+        nodeMask.data(),
+        nodeMask.size() * kBitsPerMask,
+        /* flags = */ 0);
+  }
+#endif
+  return ptr;
+}
+
+void OneDnnHostAllocator::nativeFree(void* ptr, size_t size) {
+  ++numNativeFrees_;
+  if (size < kLargeBlockSize) {
+    std::free(ptr);
+  } else {
+    munmap(ptr, size);
+  }
+}
+
+OneDnnHostAllocator::Stats OneDnnHostAllocator::stats() const {
+  Stats stats;
+  stats.allocatedBytes = allocatedBytes_;
+  stats.cachedBytes = cachedBytes_;
+  stats.numAllocs = numAllocs_;
+  stats.numCacheHits = numCacheHits_;
+  stats.numNativeAllocs = numNativeAllocs_;
+  stats.numNativeFrees = numNativeFrees_;
+  return stats;
+}
+
+const OneDnnHostAllocator::Options& OneDnnHostAllocator::options() const {
+  return options_;
+}
+
+void OneDnnHostAllocator::printInfo(
+    const char* msg,
+    std::ostream* ostream /* = &std::cout */) {
+  if (ostream == nullptr) {
+    throw std::invalid_argument(
+        "OneDnnHostAllocator::printInfo - got null ostream pointer");
+  }
+  const auto s = stats();
+  *ostream << msg << "\nType: OneDnnHostAllocator" << std::endl
+           << "\nNUMA nodes: " << numNodes()
+           << ", Huge pages: " << (options_.useHugePages ? "on" : "off")
+           << ", Allocated: " << formatMemory(s.allocatedBytes)
+           << ", Cached: " << formatMemory(s.cachedBytes)
+           << ", In use: " << formatMemory(s.allocatedBytes - s.cachedBytes)
+           << std::endl
+           << "\nTotal allocations: " << s.numAllocs << ", "
+           << s.numCacheHits << "(cache hits)" << std::endl
+           << "\nTotal native calls: " << s.numNativeAllocs << "(mallocs), "
+           << s.numNativeFrees << "(frees)" << std::endl;
+}
+
+void OneDnnHostAllocator::setLogStream(std::ostream* logStream) {
+  if (logStream == nullptr) {
+    throw std::invalid_argument(
+        "OneDnnHostAllocator::setLogStream - got null ostream pointer");
+  }
+  std::lock_guard<std::mutex> lock(logMutex_);
+  logStream_ = logStream;
+  loggingEnabled_ = true;
+}
+
+void OneDnnHostAllocator::setLoggingEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(logMutex_);
+  if (enabled && logStream_ == nullptr) {
+    throw std::invalid_argument(
+        "OneDnnHostAllocator::setLoggingEnabled - "
+        "set a log stream before enabling logging");
+  }
+  loggingEnabled_ = enabled;
+}
+
+void OneDnnHostAllocator::setLogFlushInterval(size_t interval) {
+  if (interval < 1) {
+    throw std::invalid_argument(
+        "OneDnnHostAllocator::setLogFlushInterval - "
+        "flush interval must be great than zero.");
+  }
+  std::lock_guard<std::mutex> lock(logMutex_);
+  logFlushInterval_ = interval;
+}
+
+void OneDnnHostAllocator::log(
+    const char* fname,
+    size_t size,
+    const void* ptr) {
+  if (!loggingEnabled_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(logMutex_);
+  logStreamBuffer_ << fname << " " << size << " " << ptr << '\n';
+  logStreamBufferSize_++;
+  if (logStreamBufferSize_ >= logFlushInterval_) {
+    *logStream_ << logStreamBuffer_.str();
+    logStreamBuffer_.str(""); // clear the log buffer.
+    logStreamBufferSize_ = 0;
+  }
+}
+
+} // namespace fl
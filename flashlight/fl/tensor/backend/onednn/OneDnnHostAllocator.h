@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fl {
+
+/**
+ * A caching allocator for the host buffers backing OneDNN tensors.
+ *
+ * Requests are rounded up to one of four size classes per power of two and
+ * served from free lists, so training loops which repeatedly allocate tensors
+ * of the same shapes stop paying for malloc/free and for faulting in fresh
+ * pages after the first iteration.
+ *
+ * - Every block is aligned to `kAlignment` bytes.
+ * - Blocks of at most `kThreadCacheMaxBlockSize` bytes are first recycled
+ *   through a small, bounded per-thread cache which is accessed without
+ *   locking.
+ * - All other blocks are cached in one arena per NUMA node. Threads allocate
+ *   from the arena of the node they run on, and blocks are always returned to
+ *   the arena they came from.
+ * - Blocks of at least `kLargeBlockSize` bytes are mapped directly from the OS,
+ *   bound to their arena's node and, unless disabled, backed by transparent
+ *   huge pages.
+ *
+ * The cache can be tuned with the following environment variables:
+ * - `FL_ONEDNN_HOST_CACHE_LIMIT_MB`: bytes (in MiB, as a float) which the
+ *   arenas may hold on to. Unlimited by default.
+ * - `FL_ONEDNN_HOST_HUGE_PAGES`: set to 0 to disable huge pages.
+ *
+ * NOTE work on an asynchronous OneDnnCPUStream may still use a block after its
+ * owner is released, so the backend sets a release hook which defers the
+ * recycling of blocks until such work completed.
+ */
+class OneDnnHostAllocator
+    : public std::enable_shared_from_this<OneDnnHostAllocator> {
+ public:
+  static constexpr size_t kAlignment = 64;
+  static constexpr size_t kMinBlockSize = 256;
+  static constexpr size_t kThreadCacheMaxBlockSize = 1 << 18; // 256 KiB
+  static constexpr size_t kThreadCacheCapacity = 1 << 23; // 8 MiB
+  static constexpr size_t kLargeBlockSize = 1 << 21; // 2 MiB
+
+  struct Options {
+    // max number of bytes cached by all arenas combined
+    size_t cacheLimit;
+    // whether large blocks are backed by transparent huge pages
+    bool useHugePages;
+    // whether small blocks are recycled through per-thread caches
+    bool useThreadCache;
+
+    // Reads the defaults from the environment variables listed above.
+    Options();
+  };
+
+  struct Stats {
+    size_t allocatedBytes{0}; // bytes obtained from the OS
+    size_t cachedBytes{0}; // bytes held in caches, not used by tensors
+    size_t numAllocs{0}; // calls to `allocate`
+    size_t numCacheHits{0}; // allocations served from a cache
+    size_t numNativeAllocs{0};
+    size_t numNativeFrees{0};
+  };
+
+  // Per-thread cache of small blocks, defined in the translation unit.
+  struct ThreadCache;
+
+  /**
+   * Called with the recycling of a released block. Returns true if it took
+   * over the recycling (e.g., to run it later), false if the block should be
+   * recycled right away.
+   */
+  using ReleaseHook = std::function<bool(std::function<void()> recycle)>;
+
+  /**
+   * Creates an allocator. Allocators are always shared, since the buffers
+   * they hand out keep them alive.
+   */
+  static std::shared_ptr<OneDnnHostAllocator> create(
+      const Options& options = Options());
+
+  ~OneDnnHostAllocator();
+
+  OneDnnHostAllocator(const OneDnnHostAllocator&) = delete;
+  OneDnnHostAllocator& operator=(const OneDnnHostAllocator&) = delete;
+
+  /**
+   * Allocates a buffer of at least `bytes` bytes, aligned to `kAlignment`.
+   * The buffer goes back to the cache once the returned pointer (and all of
+   * its copies) are released.
+   *
+   * @param[in] bytes the minimum size of the buffer.
+   * @return a shared pointer owning the buffer.
+   * @throws std::runtime_error if the memory cannot be obtained, even after
+   * releasing all cached blocks.
+   */
+  std::shared_ptr<void> allocate(size_t bytes);
+
+  /**
+   * Sets the hook through which released blocks are recycled. Must be set
+   * before the allocator hands out any buffer.
+   */
+  void setReleaseHook(ReleaseHook hook);
+
+  /**
+   * Returns all blocks cached by the arenas and by the calling thread to the
+   * OS. Other threads' caches are flushed when those threads exit.
+   */
+  void emptyCache();
+
+  /**
+   * @return the size class a request of `bytes` bytes is served from.
+   */
+  static size_t roundSize(size_t bytes);
+
+  /**
+   * @return the number of NUMA nodes (and hence arenas) used.
+   */
+  int numNodes() const;
+
+  Stats stats() const;
+
+  const Options& options() const;
+
+  /**
+   * Prints allocation statistics to the given stream.
+   */
+  void printInfo(const char* msg, std::ostream* ostream = &std::cout);
+
+  /**
+   * Sets the stream to which `allocate` and free calls are logged, and enables
+   * logging.
+   */
+  void setLogStream(std::ostream* logStream);
+
+  void setLoggingEnabled(bool enabled);
+
+  /**
+   * Sets the number of lines after which the log buffer gets flushed to the
+   * log stream. Must be greater than 0.
+   */
+  void setLogFlushInterval(size_t interval);
+
+ private:
+  struct Block {
+    void* ptr;
+    size_t size;
+    int node;
+  };
+
+  struct Arena {
+    std::mutex mutex;
+    // free blocks by size class
+    std::unordered_map<size_t, std::vector<void*>> freeBlocks;
+  };
+
+  Options options_;
+  std::vector<std::unique_ptr<Arena>> arenas_;
+  // NUMA node of each CPU, indexed by CPU id
+  std::vector<int> cpuToNode_;
+  ReleaseHook releaseHook_;
+
+  std::atomic<size_t> allocatedBytes_{0};
+  std::atomic<size_t> cachedBytes_{0};
+  std::atomic<size_t> arenaCachedBytes_{0};
+  std::atomic<size_t> numAllocs_{0};
+  std::atomic<size_t> numCacheHits_{0};
+  std::atomic<size_t> numNativeAllocs_{0};
+  std::atomic<size_t> numNativeFrees_{0};
+
+  // Logging components, mirroring MemoryManagerAdapter
+  std::atomic<bool> loggingEnabled_{false};
+  std::mutex logMutex_;
+  std::ostream* logStream_{nullptr};
+  std::stringstream logStreamBuffer_;
+  size_t logStreamBufferSize_{0}; // in number of lines
+  size_t logFlushInterval_;
+
+  explicit OneDnnHostAllocator(const Options& options);
+
+  int currentNode() const;
+  ThreadCache* threadCache();
+  void release(const Block& block);
+  void releaseToArena(const Block& block);
+  void* nativeAlloc(size_t size, int node);
+  void nativeFree(void* ptr, size_t size);
+  void freeArenaBlocks();
+  void log(const char* fname, size_t size, const void* ptr);
+};
+
+} // namespace fl
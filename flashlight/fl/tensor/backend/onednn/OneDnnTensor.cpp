@@ -14,9 +14,12 @@
 #include <numeric>
 #include <stdexcept>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include "flashlight/fl/tensor/Index.h"
 #include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/backend/onednn/CpuKernels.h"
 #include "flashlight/fl/tensor/backend/onednn/OneDnnBackend.h"
 #include "flashlight/fl/tensor/backend/onednn/Utils.h"
 
@@ -105,13 +108,61 @@ Index canonicalizeIndex(const Index& idx, const Dim axisDim) {
       return idx;
     }
     case detail::IndexType::Tensor: {
-      throw std::invalid_argument(
-          "[canonicalizeIndex] Currently does not support Tensor as index");
+      return idx;
     }
   }
   throw std::runtime_error("Unexpected IndexType");
 }
 
+// The positions along an axis of size `axisDim` selected by a Tensor index,
+// i.e., those of the non-zero elements of a b8 mask, or the (non-negative)
+// integers in the tensor.
+std::vector<Dim> tensorIndexToAxisMap(const Tensor& idx, const Dim axisDim) {
+  if (idx.type() == dtype::b8) {
+    if (idx.ndim() > 1) {
+      std::ostringstream oss;
+      oss << "[OneDnnTensor::index] only 1D masks, indexing a single axis, are "
+          << "supported; got a mask of shape " << idx.shape();
+      throw std::invalid_argument(oss.str());
+    }
+    if (idx.elements() != axisDim) {
+      std::ostringstream oss;
+      oss << "[OneDnnTensor::index] mask of " << idx.elements()
+          << " elements used to index axis of size " << axisDim;
+      throw std::invalid_argument(oss.str());
+    }
+    const auto mask = idx.toHostVector<char>();
+    const auto positions = detail::nonzeroIndices(mask.data(), mask.size());
+    return std::vector<Dim>(positions.begin(), positions.end());
+  }
+  const auto positions = idx.type() == dtype::s32
+      ? idx.toHostVector<int>()
+      : idx.astype(dtype::s32).toHostVector<int>();
+  for (const auto position : positions) {
+    if (position < 0 || position >= axisDim) {
+      std::ostringstream oss;
+      oss << "[OneDnnTensor::index] index " << position
+          << " out of range for axis of size " << axisDim;
+      throw std::invalid_argument(oss.str());
+    }
+  }
+  return std::vector<Dim>(positions.begin(), positions.end());
+}
+
+// Gather the elements at the given positions along the axes with non-empty
+// `axisMaps`; see `detail::remap`.
+template <typename T>
+Tensor gatherCpu(
+    const Tensor& tensor,
+    const Shape& outShape,
+    const std::vector<std::vector<Dim>>& axisMaps) {
+  const auto src = tensor.toHostVector<T>();
+  std::vector<T> dst(outShape.elements());
+  detail::remap(src.data(), tensor.shape(), dst.data(), outShape, axisMaps);
+  return toTensor<OneDnnTensor>(
+      outShape, tensor.type(), dst.data(), Location::Host);
+}
+
 } // namespace
 
 OneDnnTensor::SharedData::~SharedData() {
@@ -126,10 +177,8 @@ OneDnnTensor::OneDnnTensor(
     : sharedData_(std::move(sharedData)), shape_(shape), memDesc_(memDesc) {}
 
 void* OneDnnTensor::getOrEvalDataHandle() {
-  if (!sharedData_->isDataReady) {
-    stream().sync();
-    sharedData_->isDataReady = true;
-  }
+  ensurePlainLayout();
+  stream().sync();
   return sharedData_->memory.get_data_handle();
 }
 
@@ -143,13 +192,69 @@ unsigned OneDnnTensor::getSizeInBytes() const {
   return numElems * typeSize;
 }
 
+void OneDnnTensor::ensurePlainLayout() const {
+  if (!sharedData_->hasOpaqueLayout) {
+    return;
+  }
+  auto& srcMem = sharedData_->memory;
+  const auto& srcMemDesc = srcMem.get_desc();
+  const auto dstMemDesc = detail::oneDnnContiguousMemDescFromShape(
+      detail::oneDnnDimsToShape(srcMemDesc.dims()), srcMemDesc.data_type());
+  const auto engine = srcMem.get_engine();
+  std::shared_ptr<void> dstBuffer;
+  dnnl::memory dstMem;
+  if (engine.get_kind() == dnnl::engine::kind::cpu) {
+    dstBuffer = backend().hostAllocator().allocate(dstMemDesc.get_size());
+    dstMem = dnnl::memory(dstMemDesc, engine, dstBuffer.get());
+  } else {
+    dstMem = dnnl::memory(dstMemDesc, engine);
+  }
+
+  // block here, since the caller is about to use the plain data
+  backend().oneDnnStream().execute(
+      dnnl::reorder(srcMem, dstMem),
+      {{DNNL_ARG_FROM, srcMem}, {DNNL_ARG_TO, dstMem}});
+  stream().sync();
+  sharedData_->memory = std::move(dstMem);
+  sharedData_->buffer = std::move(dstBuffer);
+  sharedData_->hasOpaqueLayout = false;
+}
+
 OneDnnTensor::OneDnnTensor(const Shape& shape, dnnl::memory&& memory) {
   sharedData_ = std::make_shared<SharedData>();
   shape_ = shape;
-  memDesc_ = memory.get_desc();
+  const auto memDesc = memory.get_desc();
+  const auto& dims = shape.get();
+  const dnnl::memory::dims expectedDims =
+      shape.ndim() == 0 ? dnnl::memory::dims{1}
+                        : dnnl::memory::dims(dims.rbegin(), dims.rend());
+  if (memDesc.dims() != expectedDims) {
+    throw std::invalid_argument(
+        "[OneDnnTensor] memory dims don't match shape " + shape.toString());
+  }
+  memDesc_ =
+      detail::oneDnnContiguousMemDescFromShape(shape, memDesc.data_type());
+  sharedData_->hasOpaqueLayout = memDesc != memDesc_;
   sharedData_->memory = std::move(memory);
 }
 
+OneDnnTensor::OneDnnTensor(
+    const Shape& shape,
+    const dnnl::memory::desc& memDesc)
+    : shape_(shape), memDesc_(memDesc) {
+  sharedData_ = std::make_shared<SharedData>();
+  const auto& engine = backend().engine();
+  // TODO handle device engines once we add CL support
+  if (engine.get_kind() == dnnl::engine::kind::cpu) {
+    sharedData_->buffer =
+        backend().hostAllocator().allocate(memDesc.get_size());
+    sharedData_->memory =
+        dnnl::memory(memDesc, engine, sharedData_->buffer.get());
+  } else {
+    sharedData_->memory = dnnl::memory(memDesc, engine);
+  }
+}
+
 OneDnnTensor::OneDnnTensor()
     : OneDnnTensor({0}, fl::dtype::f32, nullptr, Location::Host) {}
 
@@ -157,16 +262,17 @@ OneDnnTensor::OneDnnTensor(
     const Shape& shape,
     fl::dtype type,
     const void* ptr,
-    Location memoryLocation) : shape_(shape) {
+    Location memoryLocation)
+    : OneDnnTensor(
+          shape,
+          detail::oneDnnContiguousMemDescFromShape(
+              shape,
+              detail::flToOneDnnType(type))) {
   // TODO handle Location::Device once we add CL support
   if (memoryLocation != Location::Host) {
     throw std::invalid_argument(
         "[OneDnnTensor] initialization data must be on host.");
   }
-  memDesc_ = detail::oneDnnContiguousMemDescFromShape(
-      shape, detail::flToOneDnnType(type));
-  sharedData_ = std::make_shared<SharedData>();
-  sharedData_->memory = dnnl::memory(memDesc_, backend().engine());
   const auto numDataBytes = shape.elements() * fl::getTypeSize(type);
   // NOTE, once we support CL, we can take ownership directly for device ptr.
   if (ptr != nullptr) {
@@ -187,13 +293,15 @@ OneDnnTensor::OneDnnTensor(
 
 std::unique_ptr<TensorAdapterBase> OneDnnTensor::clone() const {
   // TODO copy on write if this is not a view
+  ensurePlainLayout();
   auto& srcMem = sharedData_->memory;
   const auto& srcMemDesc = memoryDesc();
   const auto type = srcMemDesc.data_type();
   const auto dstMemDesc =
       detail::oneDnnContiguousMemDescFromShape(shape_, type);
   const auto engine = sharedData_->memory.get_engine();
-  auto dstMem = dnnl::memory(dstMemDesc, engine);
+  auto dstTensor = std::make_unique<OneDnnTensor>(shape_, dstMemDesc);
+  auto& dstMem = dstTensor->memory();
 
   // prepare primitive
   // (using reorder in a passthrough sense to generate a new buffer)
@@ -202,8 +310,9 @@ std::unique_ptr<TensorAdapterBase> OneDnnTensor::clone() const {
   const auto reorderPrimitive = dnnl::reorder(reorderPrimitiveDesc);
 
   // execute primitive
-  reorderPrimitive.execute(backend().nativeStream(), srcMem, dstMem);
-  return std::make_unique<OneDnnTensor>(shape_, std::move(dstMem));
+  backend().oneDnnStream().execute(
+      reorderPrimitive, {{DNNL_ARG_FROM, srcMem}, {DNNL_ARG_TO, dstMem}});
+  return dstTensor;
 }
 
 Tensor OneDnnTensor::copy() {
@@ -264,15 +373,20 @@ void OneDnnTensor::scalar(void* out) {
       srcMem.get_engine(), srcScalarMemDesc, cpuEngine, dstMemDesc);
   const auto reorderPrimitive = dnnl::reorder(reorderPrimitiveDesc);
 
-  // execute primitive
-  auto& stream = backend().nativeStream();
-  reorderPrimitive.execute(stream, srcMem, dstMem);
-  stream.wait();
+  // execute primitive, and block since `out` is the caller's
+  backend().oneDnnStream().execute(
+      reorderPrimitive, {{DNNL_ARG_FROM, srcMem}, {DNNL_ARG_TO, dstMem}});
+  stream().sync();
 }
 
 void OneDnnTensor::device(void** out) {
+  ensurePlainLayout();
+  // the caller may access the data right away
+  stream().sync();
   *out = sharedData_->memory.get_data_handle();
   sharedData_->isDevicePtrLocked = true;
+  // the caller may write through the pointer
+  ++sharedData_->version;
 }
 
 void OneDnnTensor::host(void* out) {
@@ -284,6 +398,7 @@ void OneDnnTensor::host(void* out) {
     // despite the "tranposed" internal representation, the physical data are
     // the same
     const auto& mem = memory();
+    stream().sync();
     void* mappedData = mem.map_data();
     std::memcpy(out, mappedData, getSizeInBytes());
     mem.unmap_data(mappedData);
@@ -330,21 +445,24 @@ const Stream& OneDnnTensor::stream() const {
 
 Tensor OneDnnTensor::astype(const dtype type) {
   // prepare memories
-  auto& srcMem = sharedData_->memory;
+  auto& srcMem = memory();
   const auto engine = srcMem.get_engine();
   const auto& srcMemDesc = memoryDesc();
   const auto dstMemDesc = detail::oneDnnContiguousMemDescFromShape(
       shape(), detail::flToOneDnnType(type));
-  auto dstMem = dnnl::memory(dstMemDesc, engine);
+  auto dstTensor = toTensor<OneDnnTensor>(shape(), dstMemDesc);
+  auto& dstMem = toOneDnnTensor(dstTensor).memory();
 
-  // prepare primitive
+  // prepare primitive -- narrowing float conversions (e.g., f32 -> bf16)
+  // round to nearest even rather than truncating the mantissa
   const auto reorderPrimitiveDesc = dnnl::reorder::primitive_desc(
       engine, srcMemDesc, engine, dstMemDesc);
   const auto reorderPrimitive = dnnl::reorder(reorderPrimitiveDesc);
 
   // execute primitive
-  reorderPrimitive.execute(backend().nativeStream(), srcMem, dstMem);
-  return toTensor<OneDnnTensor>(shape(), std::move(dstMem));
+  backend().oneDnnStream().execute(
+      reorderPrimitive, {{DNNL_ARG_FROM, srcMem}, {DNNL_ARG_TO, dstMem}});
+  return dstTensor;
 }
 
 Tensor OneDnnTensor::index(const std::vector<Index>& indices) {
@@ -362,6 +480,9 @@ Tensor OneDnnTensor::index(const std::vector<Index>& indices) {
   dnnl::memory::dims dims(shape.get().rbegin(), shape.get().rend());
   dnnl::memory::dims offsets(shape.ndim(), 0);
   std::vector<int> dimsAxesWithLiteralIndex;
+  // Tensor indices are applied to the view of all other indices by gathering
+  // along the corresponding axes of the (literal-free) indexed shape
+  std::vector<std::pair<int, Tensor>> indexedAxisToTensorIndex;
   for (int shapeAxis = 0; shapeAxis < indices.size(); shapeAxis++) {
     int dimsAxis = shape.ndim() - 1 - shapeAxis;
     const auto idx = canonicalizeIndex(indices[shapeAxis], shape[shapeAxis]);
@@ -382,8 +503,10 @@ Tensor OneDnnTensor::index(const std::vector<Index>& indices) {
         continue;
       }
       case detail::IndexType::Tensor: {
-        throw std::invalid_argument(
-            "[OneDnnTensor::index] Currently does not support Tensor as index");
+        const int indexedAxis = shapeAxis - dimsAxesWithLiteralIndex.size();
+        indexedAxisToTensorIndex.emplace_back(
+            indexedAxis, idx.get<Tensor>().shallowCopy());
+        continue;
       }
     }
     throw std::runtime_error("Unexpected IndexType");
@@ -397,7 +520,56 @@ Tensor OneDnnTensor::index(const std::vector<Index>& indices) {
   const auto indexedMemDesc =
     resultIsScalar ? subMemDesc.reshape({1}) : subMemDesc.reshape(condensedDims);
   const auto indexedShape = detail::oneDnnDimsToShape(condensedDims);
-  return toTensor<OneDnnTensor>(sharedData_, indexedShape, indexedMemDesc);
+  auto indexed =
+      toTensor<OneDnnTensor>(sharedData_, indexedShape, indexedMemDesc);
+  if (indexedAxisToTensorIndex.empty()) {
+    return indexed;
+  }
+
+  // gathering copies the data, so the result is not a view
+  std::vector<std::vector<Dim>> axisMaps(indexedShape.ndim());
+  std::vector<Dim> gatheredDims = indexedShape.get();
+  for (const auto& [axis, tensorIndex] : indexedAxisToTensorIndex) {
+    axisMaps[axis] = tensorIndexToAxisMap(tensorIndex, indexedShape[axis]);
+    gatheredDims[axis] = axisMaps[axis].size();
+  }
+  const Shape gatheredShape(gatheredDims);
+  const auto type = indexed.type();
+  Tensor gathered;
+  if (isHalfPrecisionType(type)) {
+    gathered =
+        gatherCpu<float>(indexed.astype(dtype::f32), gatheredShape, axisMaps)
+            .astype(type);
+  } else {
+    gathered = detail::dispatchCpuKernelType(type, [&](auto tag) {
+      return gatherCpu<decltype(tag)>(indexed, gatheredShape, axisMaps);
+    });
+  }
+  toOneDnnTensor(gathered).gatherSource_ = std::make_shared<GatherSource>(
+      GatherSource{std::move(indexed), std::move(axisMaps)});
+  return gathered;
+}
+
+void OneDnnTensor::scatterToGatherSource() {
+  auto& view = gatherSource_->view;
+  const auto& axisMaps = gatherSource_->axisMaps;
+  const auto type = view.type();
+  const auto computeType = isHalfPrecisionType(type) ? dtype::f32 : type;
+  const auto toComputeType = [&](const Tensor& tensor) {
+    return computeType == type ? tensor : tensor.astype(computeType);
+  };
+  const auto viewData = toComputeType(view);
+  const auto gatheredData = toComputeType(shallowCopy());
+  auto scattered = detail::dispatchCpuKernelType(computeType, [&](auto tag) {
+    using T = decltype(tag);
+    auto dst = viewData.toHostVector<T>();
+    const auto src = gatheredData.toHostVector<T>();
+    detail::scatter(src.data(), shape_, dst.data(), view.shape(), axisMaps);
+    return toTensor<OneDnnTensor>(
+        view.shape(), computeType, dst.data(), Location::Host);
+  });
+  toOneDnnTensor(view).assign(
+      computeType == type ? scattered : scattered.astype(type));
 }
 
 Tensor OneDnnTensor::flatten() const {
@@ -561,6 +733,9 @@ std::string OneDnnTensor::toString() {
   switch (type()) {
     case fl::dtype::f16:
       throw std::runtime_error("OneDnnTensor::toString doesn't support f16");
+    case fl::dtype::bf16:
+      // bf16 -> f32 is a lossless reorder supported on all CPU platforms
+      return astype(fl::dtype::f32).getAdapter<OneDnnTensor>().toString();
     case fl::dtype::f32:
       return dataToString<float>(data, shape);
     case fl::dtype::f64:
@@ -645,8 +820,12 @@ void OneDnnTensor::assign(const Tensor& tensor) {
   const auto reorderPrimitive = dnnl::reorder(reorderPrimitiveDesc);
 
   // execute primitive
-  reorderPrimitive.execute(backend().nativeStream(), otherMem, thisMem);
-  this->sharedData_->isDataReady = false;
+  backend().oneDnnStream().execute(
+      reorderPrimitive, {{DNNL_ARG_FROM, otherMem}, {DNNL_ARG_TO, thisMem}});
+  ++sharedData_->version;
+  if (gatherSource_) {
+    scatterToGatherSource();
+  }
 }
 
 bool OneDnnTensor::equals(OneDnnTensor&& other) {
@@ -676,13 +855,60 @@ bool OneDnnTensor::equals(OneDnnTensor&& other) {
 }
 
 dnnl::memory& OneDnnTensor::memory() {
+  ensurePlainLayout();
   return sharedData_->memory;
 }
 
+bool OneDnnTensor::hasOpaqueLayout() const {
+  return sharedData_->hasOpaqueLayout;
+}
+
+dnnl::memory OneDnnTensor::layoutMemory() {
+  const auto& fullMemDesc = sharedData_->memory.get_desc();
+  if (sharedData_->hasOpaqueLayout && memDesc_ ==
+      detail::oneDnnContiguousMemDescFromShape(
+          detail::oneDnnDimsToShape(fullMemDesc.dims()),
+          fullMemDesc.data_type())) {
+    return sharedData_->memory;
+  }
+  // views of opaque memory need the plain layout for their offsets to be valid
+  auto& mem = memory();
+  return dnnl::memory(memDesc_, mem.get_engine(), mem.get_data_handle());
+}
+
+void OneDnnTensor::setLayoutMemory(dnnl::memory memory) {
+  const auto& memDesc = memory.get_desc();
+  const auto& fullMemDesc = sharedData_->memory.get_desc();
+  if (memDesc.dims() != memDesc_.dims() ||
+      memDesc.data_type() != memDesc_.data_type() ||
+      fullMemDesc.dims() != memDesc_.dims() ||
+      memDesc_.data.offset0 != 0) {
+    throw std::invalid_argument(
+        "[OneDnnTensor::setLayoutMemory] memory must match the dims and type "
+        "of a (non-view) tensor of shape " + shape_.toString());
+  }
+  if (sharedData_->isDevicePtrLocked) {
+    throw std::runtime_error(
+        "[OneDnnTensor::setLayoutMemory] can't replace locked memory");
+  }
+  sharedData_->memory = std::move(memory);
+  sharedData_->buffer.reset();
+  sharedData_->hasOpaqueLayout =
+      sharedData_->memory.get_desc() != memDesc_;
+}
+
 const dnnl::memory::desc& OneDnnTensor::memoryDesc() const {
   return memDesc_;
 }
 
+uint64_t OneDnnTensor::version() const {
+  return sharedData_->version;
+}
+
+std::weak_ptr<const void> OneDnnTensor::dataId() const {
+  return sharedData_;
+}
+
 OneDnnTensor& toOneDnnTensor(const Tensor& tensor) {
   auto type = tensor.backendType();
   if (type != TensorBackendType::OneDnn) {
@@ -10,6 +10,7 @@
 #include "flashlight/fl/tensor/TensorAdapter.h"
 #include "flashlight/fl/tensor/backend/onednn/OneDnnBackend.h"
 
+#include <cstdint>
 #include <memory>
 
 #include <dnnl.hpp>
@@ -50,9 +51,16 @@ class OneDnnTensor : public TensorAdapterBase {
      *        [4, 5, 6]]
      */
     dnnl::memory memory;
-    // Whether the data in `memory` is ready (its computation finished).
-    bool isDataReady{false};
+    // Owner of the host buffer behind `memory`, if it was obtained from the
+    // backend's OneDnnHostAllocator (otherwise `memory` owns its buffer).
+    std::shared_ptr<void> buffer;
+    // Whether `memory` is in an opaque (e.g., blocked) layout picked by a
+    // OneDNN primitive, rather than the plain layout described above. Such
+    // memory is only reordered to the plain layout when its data are needed.
+    bool hasOpaqueLayout{false};
     bool isDevicePtrLocked{false};
+    // Incremented whenever `memory` may be written in place
+    uint64_t version{0};
 
     ~SharedData();
   };
@@ -62,8 +70,20 @@ class OneDnnTensor : public TensorAdapterBase {
   Shape shape_;
   dnnl::memory::desc memDesc_;
 
-  // Return the underlying data handle in `memory`.
-  // If `isDataReady` is false, sync and set it to true.
+  // Indexing with Tensor indices gathers into new memory. The result keeps the
+  // view it gathered from and the positions it gathered along each axis of the
+  // view (empty for all positions), so that assigning to it can scatter back.
+  struct GatherSource {
+    Tensor view;
+    std::vector<std::vector<Dim>> axisMaps;
+  };
+  std::shared_ptr<GatherSource> gatherSource_;
+
+  // Write the data of this tensor back to the positions it was gathered from.
+  void scatterToGatherSource();
+
+  // Return the underlying data handle in `memory`, once the stream's pending
+  // work (which may write it) completed.
   void* getOrEvalDataHandle();
 
   // Trigger computation to convert to contiguous tensor if needed, block until
@@ -73,6 +93,10 @@ class OneDnnTensor : public TensorAdapterBase {
   // return the # of bytes for the data represented by this tensor.
   unsigned getSizeInBytes() const;
 
+  // If the memory is in an opaque layout, reorder it to the plain layout (and
+  // block until done). Shallow copies and views see the converted memory.
+  void ensurePlainLayout() const;
+
  public:
   constexpr static TensorBackendType tensorBackendType =
       TensorBackendType::OneDnn;
@@ -92,13 +116,25 @@ class OneDnnTensor : public TensorAdapterBase {
       const dnnl::memory::desc& memDesc);
 
   /**
-   * Construct an OneDNNTensor with given shape and memory.
+   * Construct an OneDNNTensor with given shape and memory. The memory may be in
+   * any layout (e.g., one picked by a OneDNN primitive), as long as its dims
+   * are the reversed shape; opaque layouts are reordered to the plain one
+   * lazily, when the plain data are needed.
    *
    * @param[in] shape the shape of the new tensor
    * @param[in] memory the memory handle containing underlying tensor data
    */
   OneDnnTensor(const Shape& shape, dnnl::memory&& memory);
 
+  /**
+   * Construct an OneDNNTensor with given shape and memory descriptor, whose
+   * (uninitialized) buffer is obtained from the backend's host allocator.
+   *
+   * @param[in] shape the shape of the new tensor
+   * @param[in] memDesc the memory descriptor of the new tensor
+   */
+  OneDnnTensor(const Shape& shape, const dnnl::memory::desc& memDesc);
+
   /**
    * Construct an empty OneDNNTensor.
    */
@@ -146,6 +182,14 @@ class OneDnnTensor : public TensorAdapterBase {
   Shape strides() override;
   const Stream& stream() const override;
   Tensor astype(const dtype type) override;
+  /**
+   * Index with ranges, spans and literals (yielding a view), or with Tensor
+   * indices. A Tensor index is either a 1D tensor of integer positions, or a
+   * b8 mask with one element per position along the axis it indexes; masks of
+   * the shape of the indexed tensor aren't supported. Tensor indices copy the
+   * selected data, and assigning a tensor to the result writes it back to the
+   * selected positions (in-place arithmetic on the result is unsupported).
+   */
   Tensor index(const std::vector<Index>& indices) override;
   Tensor flatten() const override;
   Tensor flat(const Index& idx) const override;
@@ -190,7 +234,8 @@ class OneDnnTensor : public TensorAdapterBase {
   bool equals(OneDnnTensor&& other);
 
   /**
-   * Get the underlying OneDNN memory handle.
+   * Get the underlying OneDNN memory handle, in the plain layout (memory in an
+   * opaque layout is reordered first).
    * NOTE not const-correct to conform with OneDNN primitive execution API.
    *
    * @return a reference to the underlying OneDNN memory handle.
@@ -204,6 +249,47 @@ class OneDnnTensor : public TensorAdapterBase {
    * @return an immutable reference to the underlying OneDNN memory descriptro.
    */
   const dnnl::memory::desc& memoryDesc() const;
+
+  /**
+   * Whether the underlying memory is in an opaque (e.g., blocked) layout,
+   * which `memory()` would reorder to the plain layout.
+   */
+  bool hasOpaqueLayout() const;
+
+  /**
+   * Get the underlying OneDNN memory in its current layout, without reordering
+   * it, for OneDNN primitives that accept any layout. The result describes the
+   * plain layout for views or plain memory.
+   *
+   * @return the OneDNN memory handle, whose descriptor gives its layout.
+   */
+  dnnl::memory layoutMemory();
+
+  /**
+   * Replace the data of this tensor (and of its shallow copies) with `memory`,
+   * which holds the same data in another layout, so that later OneDNN
+   * primitives wanting that layout can skip their reorder, e.g., to keep
+   * inference weights in the layout a convolution prefers.
+   *
+   * @param[in] memory the memory, which must own its buffer (e.g., allocated
+   * by `dnnl::memory(desc, engine)`) and whose dims must be the reversed shape
+   */
+  void setLayoutMemory(dnnl::memory memory);
+
+  /**
+   * Number of times the data of this tensor, shared with its shallow copies
+   * and views, may have been written in place (by assignment, or through a
+   * pointer from `device`). Lets caches of values computed from the data
+   * (e.g., weights reordered for a primitive) tell whether they are stale.
+   * Changing the layout of the data (`setLayoutMemory`) doesn't count.
+   */
+  uint64_t version() const;
+
+  /**
+   * A handle identifying the data of this tensor, shared with its shallow
+   * copies and views, which expires once they are all destroyed.
+   */
+  std::weak_ptr<const void> dataId() const;
 };
 
 // Safe to drop `const`, as these are just checked version of `Tensor::impl`
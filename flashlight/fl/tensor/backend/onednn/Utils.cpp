@@ -33,6 +33,7 @@ getFlashlightTypeToOnednnTypeMap() {
   static const std::unordered_map<fl::dtype, dnnl::memory::data_type>
       kFlashlightTypeToOneDnnType = {
           {fl::dtype::f16, dnnl::memory::data_type::f16},
+          {fl::dtype::bf16, dnnl::memory::data_type::bf16},
           {fl::dtype::f32, dnnl::memory::data_type::f32},
           {fl::dtype::b8, dnnl::memory::data_type::s8},
           {fl::dtype::u8, dnnl::memory::data_type::u8},
@@ -124,6 +125,13 @@ bool isIntType(dnnl::memory::data_type type) {
 dnnl::memory::data_type getTypeWithLargerRange(
     dnnl::memory::data_type t1,
     dnnl::memory::data_type t2) {
+  // f16 and bf16 trade precision for range, so neither can represent the other
+  if ((t1 == dnnl::memory::data_type::f16 &&
+       t2 == dnnl::memory::data_type::bf16) ||
+      (t1 == dnnl::memory::data_type::bf16 &&
+       t2 == dnnl::memory::data_type::f16)) {
+    return dnnl::memory::data_type::f32;
+  }
   if ((isFpType(t1) && isFpType(t2)) ||
       (isIntType(t1) && isIntType(t2))) {
     auto t1Size = dnnl::memory::data_type_size(t1);
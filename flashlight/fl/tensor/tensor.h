@@ -9,6 +9,7 @@
 
 #include "flashlight/fl/tensor/Compute.h"
 #include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/OpProfiler.h"
 #include "flashlight/fl/tensor/Random.h"
 #include "flashlight/fl/tensor/Shape.h"
 #include "flashlight/fl/tensor/TensorBase.h"
@@ -10,6 +10,7 @@
 
 #include "flashlight/fl/autograd/Functions.h"
 #include "flashlight/fl/autograd/Variable.h"
+#include "flashlight/fl/nn/Utils.h"
 #include "flashlight/fl/tensor/Init.h"
 #include "flashlight/fl/tensor/Random.h"
 #include "flashlight/fl/test/autograd/AutogradTestUtils.h"
@@ -181,6 +182,195 @@ TEST(AutogradRnnTest, Gru) {
   testRnnImpl(RnnMode::GRU);
 }
 
+TEST(AutogradRnnTest, PackedSequences) {
+  const int numLayers = 2;
+  const int hiddenSize = 3;
+  const int inputSize = 2;
+  const int seqLength = 5;
+  // unsorted, with an empty and a full sequence
+  const std::vector<int> lengths = {3, 5, 0, 2, 3};
+  const int batchSize = lengths.size();
+  auto lengthsTensor = Tensor::fromVector(lengths);
+  auto in = Variable(fl::rand({inputSize, batchSize, seqLength}), false);
+
+  for (auto mode : {RnnMode::TANH, RnnMode::LSTM, RnnMode::GRU}) {
+    for (bool bidirectional : {false, true}) {
+      const int directions = bidirectional ? 2 : 1;
+      auto w = Variable(
+          fl::rand({fl::detail::getNumRnnParams(
+              inputSize, hiddenSize, numLayers, mode, bidirectional)}),
+          false);
+      auto hx = Variable(
+          fl::rand({hiddenSize, batchSize, numLayers * directions}), false);
+      auto cx = mode == RnnMode::LSTM
+          ? Variable(
+                fl::rand({hiddenSize, batchSize, numLayers * directions}),
+                false)
+          : Variable();
+
+      auto [y, hy, cy] =
+          rnn(in,
+              hx,
+              cx,
+              w,
+              hiddenSize,
+              numLayers,
+              mode,
+              bidirectional,
+              0.0,
+              lengthsTensor);
+      ASSERT_EQ(
+          y.shape(),
+          Shape({hiddenSize * directions, batchSize, seqLength}));
+      ASSERT_EQ(hy.shape(), hx.shape());
+
+      // Same as running each sequence alone over its valid steps
+      for (int b = 0; b < batchSize; ++b) {
+        auto sample = fl::range(b, b + 1);
+        if (lengths[b] == 0) {
+          ASSERT_TRUE(fl::all(y.tensor()(fl::span, sample) == 0)
+                          .asScalar<bool>());
+          ASSERT_TRUE(allClose(
+              hy.tensor()(fl::span, sample), hx.tensor()(fl::span, sample)));
+          continue;
+        }
+        auto [yb, hyb, cyb] =
+            rnn(in(fl::span, sample, fl::range(0, lengths[b])),
+                hx(fl::span, sample),
+                mode == RnnMode::LSTM ? cx(fl::span, sample) : Variable(),
+                w,
+                hiddenSize,
+                numLayers,
+                mode,
+                bidirectional,
+                0.0);
+        ASSERT_TRUE(allClose(
+            y.tensor()(fl::span, sample, fl::range(0, lengths[b])),
+            yb.tensor(),
+            1E-5));
+        if (lengths[b] < seqLength) {
+          auto padding = fl::range(lengths[b], fl::end);
+          ASSERT_TRUE(fl::all(y.tensor()(fl::span, sample, padding) == 0)
+                          .asScalar<bool>());
+        }
+        ASSERT_TRUE(
+            allClose(hy.tensor()(fl::span, sample), hyb.tensor(), 1E-5));
+        if (mode == RnnMode::LSTM) {
+          ASSERT_TRUE(
+              allClose(cy.tensor()(fl::span, sample), cyb.tensor(), 1E-5));
+        }
+      }
+    }
+  }
+}
+
+TEST(AutogradRnnTest, PackedSequencesManyLengths) {
+  const int numLayers = 2;
+  const int hiddenSize = 3;
+  const int inputSize = 2;
+  const int seqLength = 14;
+  // a bidirectional RNN over 11 distinct non-zero lengths
+  const std::vector<int> lengths = {7, 12, 1, 0, 9, 3, 12, 5, 2, 11, 4, 8, 6};
+  const int batchSize = lengths.size();
+  auto lengthsTensor = Tensor::fromVector(lengths);
+  auto in = Variable(fl::rand({inputSize, batchSize, seqLength}), false);
+  auto w = Variable(
+      fl::rand({fl::detail::getNumRnnParams(
+          inputSize, hiddenSize, numLayers, RnnMode::LSTM, true)}),
+      false);
+
+  auto [y, hy, cy] =
+      rnn(in,
+          Variable(),
+          Variable(),
+          w,
+          hiddenSize,
+          numLayers,
+          RnnMode::LSTM,
+          true,
+          0.0,
+          lengthsTensor);
+  ASSERT_EQ(y.shape(), Shape({hiddenSize * 2, batchSize, seqLength}));
+  ASSERT_EQ(hy.shape(), Shape({hiddenSize, batchSize, numLayers * 2}));
+  ASSERT_EQ(cy.shape(), hy.shape());
+
+  // Same as running each sequence alone over its valid steps, whatever the
+  // lengths of the other sequences
+  for (int b = 0; b < batchSize; ++b) {
+    auto sample = fl::range(b, b + 1);
+    auto padding = fl::range(lengths[b], fl::end);
+    ASSERT_TRUE(
+        fl::all(y.tensor()(fl::span, sample, padding) == 0).asScalar<bool>());
+    if (lengths[b] == 0) {
+      ASSERT_TRUE(
+          fl::all(hy.tensor()(fl::span, sample) == 0).asScalar<bool>());
+      ASSERT_TRUE(
+          fl::all(cy.tensor()(fl::span, sample) == 0).asScalar<bool>());
+      continue;
+    }
+    auto [yb, hyb, cyb] =
+        rnn(in(fl::span, sample, fl::range(0, lengths[b])),
+            Variable(),
+            Variable(),
+            w,
+            hiddenSize,
+            numLayers,
+            RnnMode::LSTM,
+            true,
+            0.0);
+    ASSERT_TRUE(allClose(
+        y.tensor()(fl::span, sample, fl::range(0, lengths[b])),
+        yb.tensor(),
+        1E-5))
+        << "sequence " << b;
+    ASSERT_TRUE(allClose(hy.tensor()(fl::span, sample), hyb.tensor(), 1E-5))
+        << "sequence " << b;
+    ASSERT_TRUE(allClose(cy.tensor()(fl::span, sample), cyb.tensor(), 1E-5))
+        << "sequence " << b;
+  }
+}
+
+TEST(AutogradRnnTest, PackedSequencesGrad) {
+  if (FL_BACKEND_CPU) {
+    GTEST_SKIP() << "RNN gradient computation not yet supported on CPU";
+  }
+  const int numLayers = 2;
+  const int hiddenSize = 2;
+  const int inputSize = 2;
+  auto lengths = Tensor::fromVector<int>({2, 4, 1});
+  auto in = Variable(fl::rand({inputSize, 3, 4}, fl::dtype::f64), true);
+
+  for (bool bidirectional : {false, true}) {
+    auto numParams = fl::detail::getNumRnnParams(
+        inputSize, hiddenSize, numLayers, RnnMode::TANH, bidirectional);
+    auto w = Variable(fl::rand({numParams}, fl::dtype::f64), true);
+    auto packedRnn = [&](const Variable& input, const Variable& weights) {
+      return rnn(input,
+                 Variable(),
+                 Variable(),
+                 weights,
+                 hiddenSize,
+                 numLayers,
+                 RnnMode::TANH,
+                 bidirectional,
+                 0.0,
+                 lengths);
+    };
+    auto funcRnnIn = [&](Variable& input) -> Variable {
+      return std::get<0>(packedRnn(input, w));
+    };
+    ASSERT_TRUE(fl::detail::jacobianTestImpl(funcRnnIn, in, 1E-5, 1E-4));
+    auto funcRnnW = [&](Variable& weights) -> Variable {
+      return std::get<0>(packedRnn(in, weights));
+    };
+    ASSERT_TRUE(fl::detail::jacobianTestImpl(funcRnnW, w, 1E-5, 1E-4));
+    auto funcRnnInDhy = [&](Variable& input) -> Variable {
+      return std::get<1>(packedRnn(input, w));
+    };
+    ASSERT_TRUE(fl::detail::jacobianTestImpl(funcRnnInDhy, in, 1E-5, 1E-4));
+  }
+}
+
 TEST_F(AutogradTestF16, RnnF16) {
   if (!fl::f16Supported()) {
     GTEST_SKIP() << "Half-precision not supported on this device";
@@ -364,6 +364,34 @@ TEST(AutogradTest, Embedding) {
   ASSERT_TRUE(fl::detail::jacobianTestImpl(funcEmbed, weights, 1E-5));
 }
 
+TEST(AutogradTest, SparseEmbedding) {
+  int nWords = 10;
+  // index 3 is looked up several times
+  auto input = Variable(
+      Tensor::fromVector<float>({2, 4}, {3, 0, 3, 7, 3, 9, 1, 0}), false);
+  auto weights = Variable(fl::randn({5, nWords}), true);
+  auto dense = embedding(input, weights);
+  dense.backward();
+  auto denseGrad = weights.grad().tensor();
+  weights.zeroGrad();
+
+  auto sparse = embedding(input, weights, /* sparseGrad = */ true);
+  ASSERT_TRUE(allClose(sparse.tensor(), dense.tensor()));
+  sparse.backward();
+  ASSERT_TRUE(weights.isSparseGrad());
+  auto& sparseGrad = weights.sparseGrad();
+  ASSERT_EQ(
+      sparseGrad.indices().toHostVector<int>(),
+      (std::vector<int>{0, 1, 3, 7, 9}));
+  ASSERT_EQ(sparseGrad.values().shape(), Shape({5, 5}));
+  ASSERT_TRUE(allClose(sparseGrad.toDense(), denseGrad));
+
+  // a dense gradient added to a sparse one makes it dense
+  weights.addGrad(Variable(denseGrad, false));
+  ASSERT_FALSE(weights.isSparseGrad());
+  ASSERT_TRUE(allClose(weights.grad().tensor(), 2 * denseGrad));
+}
+
 TEST(AutogradTest, GetAdvancedIndex) {
   // TODO: remove me
   if (!FL_BACKEND_CUDA) {
@@ -429,6 +457,69 @@ TEST(AutogradTest, GetAdvancedIndexF16) {
   }
 }
 
+TEST(AutogradTest, InferenceMode) {
+  auto x = Variable(fl::rand({5}), true);
+  ASSERT_FALSE(isInferenceMode());
+  {
+    InferenceModeGuard guard;
+    ASSERT_TRUE(isInferenceMode());
+    {
+      InferenceModeGuard nested;
+      ASSERT_TRUE(isInferenceMode());
+    }
+    ASSERT_TRUE(isInferenceMode());
+    auto y = x * 2 + x;
+    ASSERT_FALSE(y.isCalcGrad());
+    ASSERT_TRUE(allClose(y.tensor(), x.tensor() * 3));
+  }
+  ASSERT_FALSE(isInferenceMode());
+  auto y = x * 2 + x;
+  ASSERT_TRUE(y.isCalcGrad());
+  y.backward();
+  ASSERT_TRUE(allClose(x.grad().tensor(), fl::full({5}, 3.0)));
+}
+
+TEST(AutogradTest, InferenceModeReuse) {
+  const auto t = fl::rand({10}) - 0.5;
+  const auto u = fl::rand({10});
+  const auto expected = gelu(relu(Variable(t, false))) + Variable(u, false);
+  {
+    InferenceModeGuard guard;
+    // reused: the moved Variable holds the result, whose array is new
+    auto a = Variable(t, false);
+    ASSERT_TRUE(a.isReusable());
+    auto b = dropout(gelu(relu(std::move(a))) + Variable(u, false), 0.0);
+    ASSERT_FALSE(b.isCalcGrad());
+    ASSERT_TRUE(allClose(b.tensor(), expected.tensor(), 1e-5));
+    b = dropout(std::move(b), 0.5);
+    // the elements which aren't dropped are scaled by 1 / (1 - p)
+    const auto dropped = b.tensor() == 0;
+    ASSERT_TRUE(allClose(
+        fl::where(dropped, 0.0, b.tensor()),
+        fl::where(dropped, 0.0, expected.tensor() * 2),
+        1e-5));
+
+    // not reused: shared with another Variable or needs a gradient, while no
+    // graph is recorded either
+    auto c = Variable(t, false);
+    auto shared = c;
+    ASSERT_FALSE(c.isReusable());
+    auto d = relu(std::move(c));
+    ASSERT_TRUE(allClose(d.tensor(), fl::maximum(t, 0.0)));
+    ASSERT_TRUE(allClose(shared.tensor(), t));
+    auto e = Variable(t, true);
+    ASSERT_FALSE(e.isReusable());
+    auto g = std::move(e) + Variable(u, false);
+    ASSERT_FALSE(g.isCalcGrad());
+    ASSERT_TRUE(allClose(e.tensor(), t));
+  }
+  auto f = Variable(t, true);
+  auto y = relu(std::move(f));
+  ASSERT_TRUE(y.isCalcGrad());
+  y.backward();
+  ASSERT_TRUE(allClose(f.grad().tensor(), (t > 0).astype(t.type())));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flashlight/fl/common/threadpool/ThreadPool.h"
+#include "flashlight/fl/tensor/Init.h"
+
+using namespace fl;
+
+namespace {
+
+TEST(ThreadPoolTest, Task) {
+  int value = 0;
+  detail::Task small([&value]() { ++value; });
+  ASSERT_TRUE(small.isInline());
+  std::array<char, 2 * detail::Task::kInlineSize> big{};
+  detail::Task large([&value, big]() { value += big.size(); });
+  ASSERT_FALSE(large.isInline());
+
+  detail::Task moved = std::move(small);
+  ASSERT_FALSE(small);
+  moved();
+  large();
+  ASSERT_EQ(value, static_cast<int>(1 + 2 * detail::Task::kInlineSize));
+
+  // move-only callables are destroyed once
+  auto counter = std::make_shared<int>(0);
+  {
+    detail::Task task(
+        [counter, owned = std::make_unique<int>(1)]() { *counter += *owned; });
+    detail::Task other;
+    other = std::move(task);
+    other();
+    ASSERT_EQ(counter.use_count(), 2);
+  }
+  ASSERT_EQ(*counter, 1);
+  ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(ThreadPoolTest, Enqueue) {
+  ThreadPool pool(4);
+  ASSERT_EQ(pool.size(), 4U);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 1000; ++i) {
+    results.push_back(pool.enqueue([](int x, int y) { return x * y; }, i, 2));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(results[i].get(), 2 * i);
+  }
+
+  // arguments are stored by value
+  auto appended = pool.enqueue(
+      [](const std::string& s, const std::string& suffix) {
+        return s + suffix;
+      },
+      std::string("a"),
+      std::string("b"));
+  ASSERT_EQ(appended.get(), "ab");
+
+  auto failed = pool.enqueue([]() { throw std::runtime_error("failed"); });
+  ASSERT_THROW(failed.get(), std::runtime_error);
+  ASSERT_EQ(pool.currentWorker(), -1);
+  ASSERT_GE(pool.enqueue([&pool]() { return pool.currentWorker(); }).get(), 0);
+}
+
+TEST(ThreadPoolTest, InitAndShutdown) {
+  std::atomic<int> numInit{0};
+  std::atomic<int> numRun{0};
+  {
+    ThreadPool pool(3, [&numInit](size_t id) {
+      ASSERT_LT(id, 3U);
+      ++numInit;
+    });
+    for (int i = 0; i < 100; ++i) {
+      pool.enqueue([&numRun]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        ++numRun;
+      });
+    }
+  }
+  // pending tasks are run before the workers are joined
+  ASSERT_EQ(numInit, 3);
+  ASSERT_EQ(numRun, 100);
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  ThreadPool pool(4);
+  for (size_t grain : {1, 7, 64, 5000}) {
+    const size_t size = 10000;
+    std::vector<std::atomic<int>> visits(size);
+    std::atomic<int> numChunks{0};
+    pool.parallelFor(size, grain, [&](size_t begin, size_t end) {
+      ASSERT_LT(begin, end);
+      // chunks are at least the grain size, but less than twice as large
+      ASSERT_GE(end - begin, std::min(grain, size));
+      ASSERT_LT(end - begin, 2 * grain);
+      for (size_t i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+      ++numChunks;
+    });
+    for (const auto& count : visits) {
+      ASSERT_EQ(count, 1);
+    }
+    ASSERT_GE(numChunks.load(), static_cast<int>(size / (2 * grain)));
+  }
+
+  // nested loops
+  std::atomic<size_t> total{0};
+  pool.parallelFor(64, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      pool.parallelFor(
+          1000, 10, [&](size_t b, size_t e) { total += e - b; });
+    }
+  });
+  ASSERT_EQ(total.load(), 64U * 1000);
+
+  ASSERT_THROW(
+      pool.parallelFor(
+          1000,
+          1,
+          [](size_t /* begin */, size_t end) {
+            if (end == 1000) {
+              throw std::invalid_argument("last chunk failed");
+            }
+          }),
+      std::invalid_argument);
+
+  // without workers, the calling thread runs the loop
+  ThreadPool empty(0);
+  size_t emptyTotal = 0;
+  empty.parallelFor(100, 1, [&](size_t b, size_t e) { emptyTotal += e - b; });
+  ASSERT_EQ(emptyTotal, 100U);
+}
+
+TEST(ThreadPoolTest, TaskGroup) {
+  ThreadPool pool(4);
+  std::atomic<int> count{0};
+  {
+    TaskGroup group(pool);
+    for (int i = 0; i < 100; ++i) {
+      group.run([&]() {
+        // tasks waiting for subtasks don't deadlock the pool
+        TaskGroup subgroup(pool);
+        for (int j = 0; j < 10; ++j) {
+          subgroup.run([&count]() { ++count; });
+        }
+        subgroup.wait();
+      });
+    }
+    group.wait();
+    ASSERT_EQ(count, 1000);
+  }
+
+  TaskGroup group(pool);
+  for (int i = 0; i < 10; ++i) {
+    group.run([i]() {
+      if (i == 5) {
+        throw std::runtime_error("task failed");
+      }
+    });
+  }
+  ASSERT_THROW(group.wait(), std::runtime_error);
+  // the error is only rethrown once
+  group.run([&count]() { ++count; });
+  group.wait();
+  ASSERT_EQ(count, 1001);
+}
+
+TEST(ThreadPoolTest, Affinity) {
+  for (auto affinity : {ThreadAffinity::Core, ThreadAffinity::NumaNode}) {
+    ThreadPool pool(2, nullptr, affinity);
+    std::set<int> workers;
+    std::mutex mutex;
+    pool.parallelFor(100, 1, [&](size_t /* begin */, size_t /* end */) {
+      std::lock_guard<std::mutex> lock(mutex);
+      workers.insert(pool.currentWorker());
+    });
+    ASSERT_FALSE(workers.empty());
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
@@ -15,6 +15,7 @@
 
 #include "flashlight/fl/common/Filesystem.h"
 #include "flashlight/fl/distributed/distributed.h"
+#include "flashlight/fl/tensor/Index.h"
 #include "flashlight/fl/tensor/Init.h"
 #include "flashlight/fl/tensor/TensorBase.h"
 
@@ -56,6 +57,40 @@ TEST(Distributed, InlineReducer) {
   ASSERT_TRUE(fl::all(arr == expected_val).scalar<char>());
 }
 
+TEST(Distributed, SparseReducer) {
+  if (!isDistributedInit()) {
+    GTEST_SKIP() << "Distributed initialization failed or not enabled.";
+  }
+
+  auto rank = getWorldRank();
+  auto size = getWorldSize();
+
+  auto reducer = std::make_shared<InlineReducer>(1.0 / size);
+  // process r holds rows r and nRows / 2 + r of a [4, nRows] gradient, and
+  // row 0 twice. Their rows are smaller than a gradient of 200 * size rows,
+  // but not than one of 2 * size rows, which is made dense.
+  for (const int nRows : {200 * size, 2 * size}) {
+    Variable var(fl::full({4, nRows}, 0.0), true);
+    var.addSparseGrad(SparseGrad(
+        Tensor::fromVector<int>({rank, nRows / 2 + rank, 0}),
+        fl::full({4, 3}, 1.0),
+        /* dim = */ 1,
+        {4, nRows}));
+
+    reducer->addSparse(var);
+    ASSERT_EQ(var.isSparseGrad(), size == 1 || nRows > 2 * size);
+
+    auto dense = var.grad().tensor() * size;
+    auto expected = fl::full({4, nRows}, 0.0);
+    for (int r = 0; r < size; ++r) {
+      expected(fl::span, r) += 1;
+      expected(fl::span, nRows / 2 + r) += 1;
+      expected(fl::span, 0) += 1;
+    }
+    ASSERT_TRUE(allClose(dense, expected));
+  }
+}
+
 TEST(Distributed, AllReduceAsync) {
   if (!isDistributedInit()) {
     GTEST_SKIP() << "Distributed initialization failed or not enabled.";
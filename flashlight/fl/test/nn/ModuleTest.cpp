@@ -627,6 +627,47 @@ TEST_F(ModuleTestF16, DropoutFwdF16) {
   ASSERT_TRUE(allClose(out, in, 1E-5));
 }
 
+TEST(ModuleTest, SequentialInferenceMode) {
+  Sequential seq;
+  seq.add(Linear(10, 20));
+  seq.add(ReLU());
+  seq.add(Dropout(0.5));
+  seq.add(Linear(20, 5));
+  seq.add(ReLU());
+  seq.eval();
+  auto in = Variable(fl::rand({10, 4}), false);
+  const auto inCopy = in.tensor().copy();
+  const auto expected = seq(in);
+
+  InferenceModeGuard guard;
+  const auto out = seq(in);
+  ASSERT_TRUE(allClose(out, expected, 1E-5));
+  // The input is still held by the caller, so isn't reused
+  ASSERT_TRUE(allClose(in.tensor(), inCopy));
+}
+
+TEST(ModuleTest, SequentialForwardOverrides) {
+  // Outside of inference mode, modules run their own forward
+  struct CountingReLU : public ReLU {
+    int calls = 0;
+    Variable forward(const Variable& input) override {
+      ++calls;
+      return ReLU::forward(input);
+    }
+  };
+  auto relu = std::make_shared<CountingReLU>();
+  Sequential seq;
+  seq.add(Linear(10, 20));
+  seq.add(relu);
+  auto in = Variable(fl::rand({10, 4}), true);
+  auto out = seq(in);
+  ASSERT_EQ(relu->calls, 1);
+  ASSERT_TRUE(out.isCalcGrad());
+  seq.eval();
+  seq(in);
+  ASSERT_EQ(relu->calls, 2);
+}
+
 TEST(ModuleTest, PaddingFwd) {
   auto module = Padding({{1, 2}, {3, 4}}, -1);
   auto input = Variable(fl::rand({1, 2, 3, 4}, fl::dtype::f64), true);
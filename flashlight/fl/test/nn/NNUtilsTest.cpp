@@ -111,6 +111,15 @@ TEST(UtilsTest, Join) {
                   .asScalar<bool>());
 }
 
+TEST(UtilsTest, JoinLengths) {
+  std::vector<Tensor> inputs = {
+      fl::rand({5, 7}), Tensor(), fl::rand({5, 2}), fl::rand({5})};
+  auto lengths = joinLengths(inputs, 1);
+  ASSERT_EQ(lengths.type(), fl::dtype::s32);
+  ASSERT_EQ(lengths.toHostVector<int>(), std::vector<int>({7, 0, 2, 1}));
+  ASSERT_EQ(join(inputs).dim(1), 7);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
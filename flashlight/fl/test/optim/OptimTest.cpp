@@ -7,10 +7,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cmath>
 
+#include "flashlight/fl/autograd/Functions.h"
 #include "flashlight/fl/common/common.h"
 #include "flashlight/fl/optim/optim.h"
+#include "flashlight/fl/tensor/Index.h"
 #include "flashlight/fl/tensor/Random.h"
 
 using namespace fl;
@@ -59,6 +62,91 @@ TEST(OptimTest, GradNormF16) {
   ASSERT_TRUE(allClose(fl::full({1}, max_norm), fl::full({1}, clipped), 1e-2));
 }
 
+TEST(OptimTest, SparseGradStep) {
+  // On a first step, the lazy updates of the rows absent from a row-sparse
+  // gradient are the dense updates of their zero gradient
+  const int nWords = 20;
+  auto input = Variable(Tensor::fromVector<float>({4}, {2, 5, 2, 11}), false);
+  auto makeOptimizer = [](int type, const std::vector<Variable>& params)
+      -> std::shared_ptr<FirstOrderOptimizer> {
+    switch (type) {
+      case 0:
+        return std::make_shared<SGDOptimizer>(params, 0.1, 0.9, 0, true);
+      case 1:
+        return std::make_shared<AdagradOptimizer>(params, 0.1);
+      default:
+        return std::make_shared<AdamOptimizer>(params, 0.1);
+    }
+  };
+  for (int type = 0; type < 3; ++type) {
+    auto init = fl::randn({3, nWords});
+    auto denseWeights = Variable(init.copy(), true);
+    auto sparseWeights = Variable(init.copy(), true);
+    auto denseOpt = makeOptimizer(type, {denseWeights});
+    auto sparseOpt = makeOptimizer(type, {sparseWeights});
+
+    embedding(input, denseWeights).backward();
+    embedding(input, sparseWeights, /* sparseGrad = */ true).backward();
+    ASSERT_TRUE(sparseWeights.isSparseGrad());
+    denseOpt->step();
+    sparseOpt->step();
+    ASSERT_TRUE(allClose(denseWeights.tensor(), sparseWeights.tensor(), 1e-5))
+        << denseOpt->prettyString();
+    ASSERT_TRUE(
+        allClose(sparseWeights.tensor()(fl::span, 0), init(fl::span, 0)))
+        << sparseOpt->prettyString();
+  }
+}
+
+TEST(OptimTest, SparseGradLazySGD) {
+  // A row follows the dense updates of the steps it appears in, and is left
+  // as is (velocity included) by the steps it is absent from
+  const int nWords = 12;
+  const std::vector<std::vector<float>> batches = {
+      {2, 5, 2}, {5, 7}, {2, 9, 2}, {7}};
+  auto init = fl::randn({3, nWords});
+  auto weights = Variable(init.copy(), true);
+  SGDOptimizer opt({weights}, 0.1, 0.9, 0.01, true);
+  std::vector<Variable> rows;
+  std::vector<std::shared_ptr<SGDOptimizer>> rowOpts;
+  for (int r = 0; r < nWords; ++r) {
+    rows.emplace_back(init(fl::span, r).copy(), true);
+    rowOpts.push_back(std::make_shared<SGDOptimizer>(
+        std::vector<Variable>{rows.back()}, 0.1, 0.9, 0.01, true));
+  }
+
+  for (const auto& batch : batches) {
+    auto input = Variable(
+        Tensor::fromVector<float>({static_cast<Dim>(batch.size())}, batch),
+        false);
+    opt.zeroGrad();
+    embedding(input, weights, /* sparseGrad = */ true).backward();
+    ASSERT_TRUE(weights.isSparseGrad());
+    opt.step();
+    for (int r = 0; r < nWords; ++r) {
+      const float count = std::count(batch.begin(), batch.end(), r);
+      if (count > 0) {
+        rowOpts[r]->zeroGrad();
+        rows[r].addGrad(Variable(fl::full({3}, count), false));
+        rowOpts[r]->step();
+      }
+      ASSERT_TRUE(
+          allClose(weights.tensor()(fl::span, r), rows[r].tensor(), 1e-5))
+          << "row " << r;
+    }
+  }
+}
+
+TEST(OptimTest, SparseGradNorm) {
+  auto input = Variable(Tensor::fromVector<float>({3}, {1, 4, 1}), false);
+  auto weights = Variable(fl::randn({10, 6}), true);
+  embedding(input, weights, /* sparseGrad = */ true).backward();
+  clipGradNorm({weights}, 1.0);
+  ASSERT_TRUE(weights.isSparseGrad());
+  const auto& values = weights.sparseGrad().values();
+  ASSERT_NEAR(std::sqrt(fl::sum(values * values).asScalar<double>()), 1, 1e-4);
+}
+
 TEST(SerializationTest, OptimizerSerialize) {
   const fs::path path = fs::temp_directory_path() / "optmizer.bin";
 
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <regex>
+#include <sstream>
+#include <string>
+
+#include "flashlight/fl/autograd/autograd.h"
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/OpProfiler.h"
+#include "flashlight/fl/tensor/Random.h"
+#include "flashlight/fl/tensor/TensorBase.h"
+
+using namespace ::testing;
+using namespace fl;
+
+namespace {
+
+class OpProfilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    OpProfiler::clear();
+  }
+
+  void TearDown() override {
+    OpProfiler::disable();
+    OpProfiler::clear();
+  }
+};
+
+} // namespace
+
+TEST_F(OpProfilerTest, Disabled) {
+  auto a = fl::rand({3, 3});
+  auto b = fl::exp(a) + a;
+  ASSERT_FALSE(OpProfiler::isEnabled());
+  ASSERT_TRUE(OpProfiler::events().empty());
+}
+
+TEST_F(OpProfilerTest, Events) {
+  auto a = fl::rand({2, 3});
+  auto b = fl::rand({3, 4});
+  OpProfiler::enable();
+  auto c = fl::matmul(a, b);
+  auto d = fl::sum(c, {0});
+  OpProfiler::disable();
+  auto e = fl::exp(d);
+
+  // Backends may dispatch other ops while running these
+  const auto events = OpProfiler::events();
+  const auto find = [&](const std::string& name) {
+    return std::find_if(
+        events.begin(), events.end(), [&](const OpEvent& event) {
+          return event.name == name;
+        });
+  };
+  const auto matmul = find("matmul");
+  const auto sum = find("sum");
+  ASSERT_NE(matmul, events.end());
+  ASSERT_NE(sum, events.end());
+  ASSERT_EQ(find("exp"), events.end());
+  ASSERT_EQ(matmul->category, "tensor");
+  ASSERT_EQ(matmul->shapes.size(), 2);
+  ASSERT_EQ(matmul->shapes[0], Shape({2, 3}));
+  ASSERT_EQ(matmul->shapes[1], Shape({3, 4}));
+  ASSERT_LE(matmul->startNs, sum->startNs);
+  ASSERT_GE(sum->durationNs, 0);
+  if (c.backendType() != TensorBackendType::Jit) {
+    ASSERT_EQ(matmul->types.size(), 2);
+    ASSERT_EQ(matmul->bytes, c.bytes());
+  }
+
+  OpProfiler::clear();
+  ASSERT_TRUE(OpProfiler::events().empty());
+}
+
+TEST_F(OpProfilerTest, TensorMethods) {
+  auto a = fl::rand({4, 4});
+  OpProfiler::enable();
+  auto b = a.astype(fl::dtype::f64);
+  auto c = a.copy();
+  auto d = a(fl::range(0, 2));
+  c += a;
+  c(0) = d(0);
+  OpProfiler::disable();
+
+  const auto events = OpProfiler::events();
+  for (const auto* name :
+       {"astype", "copy", "index", "inPlaceAdd", "assign"}) {
+    ASSERT_NE(
+        std::find_if(
+            events.begin(),
+            events.end(),
+            [&](const OpEvent& event) { return event.name == name; }),
+        events.end())
+        << name;
+  }
+}
+
+TEST_F(OpProfilerTest, Summary) {
+  auto a = fl::rand({4, 4});
+  OpProfiler::enable();
+  for (int i = 0; i < 3; ++i) {
+    a = fl::tanh(a);
+  }
+  a = a * 2;
+  a = fl::reshape(a, {16});
+  OpProfiler::disable();
+
+  const auto summaries = OpProfiler::summarize();
+  ASSERT_GE(summaries.size(), 3);
+  for (size_t i = 1; i < summaries.size(); ++i) {
+    ASSERT_GE(summaries[i - 1].totalNs, summaries[i].totalNs);
+  }
+  const auto tanh = std::find_if(
+      summaries.begin(), summaries.end(), [](const OpSummary& summary) {
+        return summary.name == "tanh";
+      });
+  ASSERT_NE(tanh, summaries.end());
+  ASSERT_EQ(tanh->count, 3);
+  ASSERT_GE(tanh->totalNs, tanh->maxNs);
+  ASSERT_EQ(OpProfiler::summarize(1).size(), 1);
+
+  std::stringstream ss;
+  OpProfiler::printSummary(ss);
+  ASSERT_NE(ss.str().find("tanh"), std::string::npos);
+  ASSERT_NE(ss.str().find("mul"), std::string::npos);
+}
+
+TEST_F(OpProfilerTest, ChromeTrace) {
+  auto a = fl::rand({2, 2});
+  OpProfiler::enable();
+  auto b = fl::log(a);
+  OpProfiler::disable();
+
+  // Times are written in fixed point whatever the stream's format, which is
+  // left as is
+  std::stringstream ss;
+  ss << std::scientific << std::setprecision(2);
+  OpProfiler::writeChromeTrace(ss);
+  const auto trace = ss.str();
+  ASSERT_EQ(trace.find("{\"traceEvents\":["), 0);
+  ASSERT_NE(trace.find("\"name\":\"log\""), std::string::npos);
+  ASSERT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+  ASSERT_NE(trace.find("\"shapes\":\"(2, 2)\""), std::string::npos);
+  ASSERT_EQ(trace.find("e+"), std::string::npos);
+  const std::regex times("\"ts\":[0-9]+\\.[0-9]{3},\"dur\":[0-9]+\\.[0-9]{3},");
+  ASSERT_TRUE(std::regex_search(trace, times));
+  ASSERT_EQ(ss.flags() & std::ios::floatfield, std::ios::scientific);
+  ASSERT_EQ(ss.precision(), 2);
+}
+
+TEST_F(OpProfilerTest, Backward) {
+  auto x = Variable(fl::rand({3, 3}), true);
+  auto w = Variable(fl::rand({3, 3}), true);
+  auto y = fl::sum(fl::matmul(w, x), {0, 1});
+  OpProfiler::enable();
+  y.backward();
+  OpProfiler::disable();
+
+  const auto events = OpProfiler::events();
+  const auto backward = std::find_if(
+      events.begin(), events.end(), [](const OpEvent& event) {
+        return event.category == "backward" && event.name == "matmul";
+      });
+  ASSERT_NE(backward, events.end());
+  ASSERT_EQ(backward->shapes.at(0), Shape({3, 3}));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
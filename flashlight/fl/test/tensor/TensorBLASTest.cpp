@@ -174,6 +174,66 @@ TEST(TensorBLASTest, matmulShapes) {
       Shape({256, 256, 2}));
 }
 
+TEST(TensorBLASTest, fusedMatmul) {
+  using T = fl::MatrixProperty;
+  unsigned M = 8;
+  unsigned K = 10;
+  unsigned N = 12;
+  unsigned B = 3;
+  auto a = fl::rand({M, K, B});
+  auto b = fl::rand({N, K, B});
+  auto product = fl::matmul(a, b, T::None, T::Transpose);
+
+  // no bias
+  ASSERT_TRUE(allClose(
+      fl::fusedMatmul(a, b, Tensor(), T::None, T::Transpose, 0.5),
+      product * 0.5));
+  // with the smaller operand on the right
+  ASSERT_TRUE(allClose(
+      fl::fusedMatmul(b, a, Tensor(), T::None, T::Transpose, 0.5),
+      fl::matmul(b, a, T::None, T::Transpose) * 0.5));
+
+  // bias broadcast along all but the first dim
+  auto bias = fl::rand({M}) - 0.5;
+  auto tiledBias = fl::tile(fl::reshape(bias, {M, 1, 1}), {1, N, B});
+  ASSERT_TRUE(allClose(
+      fl::fusedMatmul(a, b, bias, T::None, T::Transpose, 2, 3),
+      product * 2 + tiledBias * 3));
+  ASSERT_TRUE(allClose(
+      fl::fusedMatmul(
+          a,
+          b,
+          bias,
+          T::None,
+          T::Transpose,
+          1,
+          1,
+          fl::MatmulActivation::Relu),
+      fl::maximum(product + tiledBias, 0.0)));
+  ASSERT_TRUE(allClose(
+      fl::fusedMatmul(
+          a, b, bias, T::None, T::Transpose, 1, 1, fl::MatmulActivation::Tanh),
+      fl::tanh(product + tiledBias)));
+
+  // bias broadcast along the batch dim
+  auto mask = fl::rand({M, N});
+  ASSERT_TRUE(allClose(
+      fl::fusedMatmul(
+          a,
+          b,
+          mask,
+          T::None,
+          T::Transpose,
+          1,
+          1,
+          fl::MatmulActivation::Sigmoid),
+      fl::sigmoid(product + fl::tile(mask, {1, 1, B}))));
+
+  ASSERT_THROW(
+      fl::fusedMatmul(a, b, fl::rand({M + 1}), T::None, T::Transpose),
+      std::invalid_argument);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <functional>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/nn/Trace.h"
+#include "flashlight/fl/nn/modules/modules.h"
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/Random.h"
+#include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/backend/jit/GraphPlan.h"
+#include "flashlight/fl/tensor/backend/jit/ir/CustomNode.h"
+#include "flashlight/fl/tensor/backend/jit/ir/ValueNode.h"
+
+using namespace fl;
+
+namespace {
+
+Tensor affine(const Tensor& x, const Tensor& weight, const Tensor& bias) {
+  return fl::exp(fl::matmul(weight, x) + fl::tile(bias, {1, x.dim(1)}));
+}
+
+} // namespace
+
+TEST(JitGraphPlanTest, captureAndRun) {
+  const auto weight = fl::rand({3, 4});
+  const auto bias = fl::rand({3, 1});
+  const auto plan =
+      captureGraph({{4, 5}}, {}, [&](const std::vector<Tensor>& inputs) {
+        const auto y = affine(
+            inputs[0], captureConstant(weight), captureConstant(bias));
+        return std::vector<Tensor>{
+            fl::sum(y, {1}), y(fl::span, fl::range(1, 3))};
+      });
+  ASSERT_EQ(plan.inputSteps().size(), 1);
+  ASSERT_EQ(plan.outputSteps().size(), 2);
+  ASSERT_EQ(plan.constants().size(), 2);
+
+  GraphPlanRunner runner(plan);
+  for (int i = 0; i < 2; ++i) {
+    const auto x = fl::rand({4, 5});
+    const auto outputs = runner.run({x});
+    const auto y = affine(x, weight, bias);
+    ASSERT_EQ(outputs.size(), 2);
+    ASSERT_TRUE(allClose(outputs[0], fl::sum(y, {1}), 1e-5));
+    ASSERT_TRUE(allClose(outputs[1], y(fl::span, fl::range(1, 3)), 1e-5));
+  }
+}
+
+TEST(JitGraphPlanTest, saveAndLoad) {
+  const auto weight = fl::rand({3, 4});
+  const auto bias = fl::rand({3, 1});
+  const fs::path path = fs::temp_directory_path() / "JitGraphPlanTest.plan";
+  captureGraph({{4, 2}}, {dtype::f32}, [&](const std::vector<Tensor>& inputs) {
+    const auto y =
+        affine(inputs[0], captureConstant(weight), captureConstant(bias));
+    return std::vector<Tensor>{fl::reshape(y * 2, {6}) - 1};
+  }).save(path);
+
+  GraphPlanRunner runner(GraphPlan::load(path));
+  const auto x = fl::rand({4, 2});
+  const auto outputs = runner.run({x});
+  ASSERT_EQ(outputs.size(), 1);
+  ASSERT_TRUE(allClose(
+      outputs[0], fl::reshape(affine(x, weight, bias) * 2, {6}) - 1, 1e-5));
+  fs::remove(path);
+}
+
+TEST(JitGraphPlanTest, inputMismatch) {
+  const auto plan =
+      captureGraph({{2, 2}}, {}, [](const std::vector<Tensor>& inputs) {
+        return std::vector<Tensor>{inputs[0] + 1};
+      });
+  GraphPlanRunner runner(plan);
+  ASSERT_THROW(runner.run({}), std::invalid_argument);
+  ASSERT_THROW(runner.run({fl::rand({2, 3})}), std::invalid_argument);
+  ASSERT_THROW(
+      runner.run({fl::full({2, 2}, 1, dtype::s32)}), std::invalid_argument);
+  ASSERT_TRUE(allClose(
+      runner.run({fl::full({2, 2}, 1.0)}).at(0), fl::full({2, 2}, 2.0)));
+}
+
+TEST(JitGraphPlanTest, dataDependentOnInputs) {
+  const Shape shape({2, 3});
+  const auto capture = [&](std::function<Tensor(const Tensor&)> func) {
+    return captureGraph({shape}, {}, [&](const std::vector<Tensor>& inputs) {
+      return std::vector<Tensor>{func(inputs[0])};
+    });
+  };
+  ASSERT_THROW(
+      capture([](const Tensor& x) { return fl::nonzero(x + 1); }),
+      std::invalid_argument);
+  ASSERT_THROW(
+      capture([](const Tensor& x) {
+        Tensor values, indices;
+        fl::topk(values, indices, x, 1, 0);
+        return indices;
+      }),
+      std::invalid_argument);
+  ASSERT_THROW(
+      capture([](const Tensor& x) {
+        Tensor values, indices;
+        fl::max(values, indices, x, 0);
+        return indices;
+      }),
+      std::invalid_argument);
+  ASSERT_THROW(
+      capture([](const Tensor& x) {
+        return x * fl::sum(x).scalar<float>();
+      }),
+      std::invalid_argument);
+
+  // data which doesn't depend on the inputs is a constant of the plan
+  const auto mask = fl::rand(shape) > 0.5;
+  const auto plan = capture([&](const Tensor& x) {
+    const auto count = fl::nonzero(captureConstant(mask)).dim(0);
+    return x + static_cast<float>(count);
+  });
+  GraphPlanRunner runner(plan);
+  const auto x = fl::rand(shape);
+  ASSERT_TRUE(allClose(
+      runner.run({x}).at(0),
+      x + static_cast<float>(fl::nonzero(mask).dim(0)),
+      1e-5));
+}
+
+TEST(JitGraphPlanTest, customNodeWithoutOp) {
+  const Shape shape({2, 2});
+  const auto input = ValueNode::create(fl::rand(shape));
+  const auto custom = CustomNode::create(
+      "custom", {input}, shape, [](const std::vector<const Tensor*>& inputs) {
+        return *inputs.at(0) + 1;
+      });
+  ASSERT_THROW(
+      GraphPlan::fromGraph({input}, {dtype::f32}, {custom}),
+      std::invalid_argument);
+  // root node is owned locally (didn't transition to shared ownership)
+  delete custom;
+}
+
+TEST(JitGraphPlanTest, traceModule) {
+  Sequential model;
+  model.add(Linear(4, 3));
+  model.add(Sigmoid());
+  model.add(Linear(3, 2));
+  const auto plan = trace(model, {{4, 5}});
+  ASSERT_EQ(plan.constants().size(), model.params().size());
+  // the module is back in train mode
+  ASSERT_TRUE(model.isTrain());
+  ASSERT_TRUE(model.param(0).isCalcGrad());
+
+  GraphPlanRunner runner(plan);
+  const auto x = fl::rand({4, 5});
+  const auto outputs = runner.run({x});
+  ASSERT_EQ(outputs.size(), 1);
+  ASSERT_TRUE(allClose(outputs[0], model(Variable(x, false)).tensor(), 1e-5));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
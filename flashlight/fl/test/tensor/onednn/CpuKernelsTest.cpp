@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/backend/onednn/CpuKernels.h"
+
+using namespace fl;
+using namespace fl::detail;
+
+namespace {
+
+// column-major (rows, cols) matrix with element (r, c) = r + 10 * c
+std::vector<float> matrix(const int rows, const int cols) {
+  std::vector<float> data(rows * cols);
+  for (int c = 0; c < cols; ++c) {
+    for (int r = 0; r < rows; ++r) {
+      data[r + c * rows] = r + 10 * c;
+    }
+  }
+  return data;
+}
+
+} // namespace
+
+TEST(CpuKernelsTest, parallelFor) {
+  const size_t size = 1 << 20;
+  std::vector<std::atomic<int>> visits(size);
+  parallelFor(size, 1000, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      visits[i]++;
+    }
+  });
+  for (const auto& count : visits) {
+    ASSERT_EQ(count, 1);
+  }
+
+  // nested loops run inline
+  std::atomic<size_t> total{0};
+  parallelFor(64, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      parallelFor(1000, 1, [&](size_t b, size_t e) { total += e - b; });
+    }
+  });
+  ASSERT_EQ(total, 64 * 1000);
+
+  ASSERT_THROW(
+      parallelFor(
+          size,
+          1,
+          [size](size_t /* begin */, size_t end) {
+            if (end == size) {
+              throw std::runtime_error("last chunk failed");
+            }
+          }),
+      std::runtime_error);
+  ASSERT_GE(getNumCpuKernelThreads(), 1);
+}
+
+TEST(CpuKernelsTest, axisLayout) {
+  AxisLayout layout({2, 3, 4}, 1);
+  ASSERT_EQ(layout.inner, 2);
+  ASSERT_EQ(layout.axisSize, 3);
+  ASSERT_EQ(layout.outer, 4);
+  ASSERT_EQ(layout.numLines(), 8);
+  ASSERT_EQ(layout.lineStart(3), 1 + 6);
+  ASSERT_THROW(AxisLayout({2, 3}, 2), std::invalid_argument);
+}
+
+TEST(CpuKernelsTest, unaryMapAndSelect) {
+  std::vector<float> in(100000);
+  std::iota(in.begin(), in.end(), -50000.f);
+  std::vector<int> out(in.size());
+  unaryMap(in.data(), out.data(), in.size(), [](float x) {
+    return static_cast<int>(std::floor(x / 2));
+  });
+  ASSERT_EQ(out[0], -25000);
+  ASSERT_EQ(out[1], -25000);
+  ASSERT_EQ(out[99999], 24999);
+
+  const std::vector<char> condition = {1, 0, 0, 1};
+  const std::vector<float> x = {1, 2, 3, 4}, y = {-1, -2, -3, -4};
+  std::vector<float> selected(4);
+  select(condition.data(), x.data(), y.data(), selected.data(), 4);
+  ASSERT_EQ(selected, std::vector<float>({1, -2, -3, 4}));
+}
+
+TEST(CpuKernelsTest, remap) {
+  const auto in = matrix(3, 2);
+  // pad one zero row above and flip the columns
+  std::vector<float> out(4 * 2);
+  remap<float>(in.data(), {3, 2}, out.data(), {4, 2}, {{-1, 0, 1, 2}, {1, 0}});
+  ASSERT_EQ(out, std::vector<float>({0, 10, 11, 12, 0, 0, 1, 2}));
+
+  // gather along the last axis only
+  std::vector<float> gathered(3 * 3);
+  remap<float>(in.data(), {3, 2}, gathered.data(), {3, 3}, {{}, {1, 1, 0}});
+  ASSERT_EQ(
+      gathered, std::vector<float>({10, 11, 12, 10, 11, 12, 0, 1, 2}));
+
+  ASSERT_THROW(
+      remap<float>(in.data(), {3, 2}, out.data(), {6}, {{}}),
+      std::invalid_argument);
+}
+
+TEST(CpuKernelsTest, scatter) {
+  // rows 0 and 1 go to rows 2 and 0, and both columns to column 0 (the last
+  // one wins)
+  const auto in = matrix(2, 2);
+  std::vector<float> out(3 * 2, -1);
+  scatter<float>(in.data(), {2, 2}, out.data(), {3, 2}, {{2, 0}, {0, 0}});
+  ASSERT_EQ(out, std::vector<float>({11, -1, 10, -1, -1, -1}));
+
+  ASSERT_THROW(
+      scatter<float>(in.data(), {2, 2}, out.data(), {6}, {{}}),
+      std::invalid_argument);
+}
+
+TEST(CpuKernelsTest, triangle) {
+  const auto in = matrix(3, 3);
+  std::vector<float> lower(9), upper(9);
+  triangle(in.data(), lower.data(), 3, 3, 1, /* lower = */ true);
+  triangle(in.data(), upper.data(), 3, 3, 1, /* lower = */ false);
+  ASSERT_EQ(lower, std::vector<float>({0, 1, 2, 0, 11, 12, 0, 0, 22}));
+  ASSERT_EQ(upper, std::vector<float>({0, 0, 0, 10, 11, 0, 20, 21, 22}));
+
+  // batched, non-square
+  std::vector<float> batch(2 * 3 * 2, 1), out(12);
+  triangle(batch.data(), out.data(), 2, 3, 2, /* lower = */ true);
+  ASSERT_EQ(
+      out, std::vector<float>({1, 1, 0, 1, 0, 0, 1, 1, 0, 1, 0, 0}));
+}
+
+TEST(CpuKernelsTest, cumsum) {
+  const auto in = matrix(3, 2);
+  std::vector<float> out(6);
+  cumsum(in.data(), out.data(), AxisLayout({3, 2}, 0));
+  ASSERT_EQ(out, std::vector<float>({0, 1, 3, 10, 21, 33}));
+  cumsum(in.data(), out.data(), AxisLayout({3, 2}, 1));
+  ASSERT_EQ(out, std::vector<float>({0, 1, 2, 10, 12, 14}));
+
+  // more than one inner block, accumulating into a wider type
+  const int inner = 3000, axisSize = 5;
+  std::vector<char> ones(inner * axisSize, 1);
+  std::vector<int> sums(ones.size());
+  cumsum(ones.data(), sums.data(), AxisLayout(inner, axisSize, 1));
+  for (int j = 0; j < axisSize; ++j) {
+    for (int i = 0; i < inner; ++i) {
+      ASSERT_EQ(sums[i + j * inner], j + 1);
+    }
+  }
+}
+
+TEST(CpuKernelsTest, reduceWithIndex) {
+  const std::vector<float> in = {3, 1, 3, 0, 5, 5};
+  std::vector<float> values(2);
+  std::vector<int> indices(2);
+  reduceWithIndex(
+      in.data(),
+      values.data(),
+      indices.data(),
+      AxisLayout({3, 2}, 0),
+      std::greater<>());
+  ASSERT_EQ(values, std::vector<float>({3, 5}));
+  ASSERT_EQ(indices, std::vector<int>({0, 1})); // first of ties
+
+  std::vector<float> minValues(3);
+  std::vector<int> minIndices(3);
+  reduceWithIndex(
+      in.data(),
+      minValues.data(),
+      minIndices.data(),
+      AxisLayout({3, 2}, 1),
+      std::less<>());
+  ASSERT_EQ(minValues, std::vector<float>({0, 1, 3}));
+  ASSERT_EQ(minIndices, std::vector<int>({1, 0, 0}));
+}
+
+TEST(CpuKernelsTest, sortAlongAxis) {
+  // two columns of length 4
+  const std::vector<int> in = {3, 1, 3, 2, 7, 9, 8, 9};
+  const AxisLayout layout({4, 2}, 0);
+  std::vector<int> values(8), indices(8);
+  sortAlongAxis(in.data(), values.data(), indices.data(), layout, 4, true);
+  ASSERT_EQ(values, std::vector<int>({1, 2, 3, 3, 7, 8, 9, 9}));
+  ASSERT_EQ(indices, std::vector<int>({1, 3, 0, 2, 0, 2, 1, 3}));
+
+  sortAlongAxis(in.data(), values.data(), nullptr, layout, 4, false);
+  ASSERT_EQ(values, std::vector<int>({3, 3, 2, 1, 9, 9, 8, 7}));
+
+  // top 1 along the second axis
+  std::vector<int> topValues(4), topIndices(4);
+  sortAlongAxis(
+      in.data(),
+      topValues.data(),
+      topIndices.data(),
+      AxisLayout({4, 2}, 1),
+      1,
+      false);
+  ASSERT_EQ(topValues, std::vector<int>({7, 9, 8, 9}));
+  ASSERT_EQ(topIndices, std::vector<int>({1, 1, 1, 1}));
+
+  ASSERT_THROW(
+      sortAlongAxis(in.data(), values.data(), nullptr, layout, 5, true),
+      std::invalid_argument);
+}
+
+TEST(CpuKernelsTest, sortAlongAxisNan) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const std::vector<float> in = {2, nan, 1, nan, 3};
+  const AxisLayout layout({5}, 0);
+  std::vector<float> values(5);
+  std::vector<int> indices(5);
+  for (const bool ascending : {true, false}) {
+    sortAlongAxis(
+        in.data(), values.data(), indices.data(), layout, 5, ascending);
+    ASSERT_EQ(values[0], ascending ? 1 : 3);
+    ASSERT_EQ(values[1], 2);
+    ASSERT_EQ(values[2], ascending ? 3 : 1);
+    ASSERT_TRUE(std::isnan(values[3]) && std::isnan(values[4]));
+    ASSERT_EQ(indices[3], 1);
+    ASSERT_EQ(indices[4], 3);
+  }
+}
+
+TEST(CpuKernelsTest, medianAlongAxis) {
+  const std::vector<int> in = {5, 1, 3, 4, 2, 8};
+  std::vector<float> out(2);
+  medianAlongAxis(in.data(), out.data(), AxisLayout({3, 2}, 0));
+  ASSERT_EQ(out, std::vector<float>({3, 4}));
+  std::vector<float> evenOut(1);
+  medianAlongAxis(in.data(), evenOut.data(), AxisLayout({6}, 0));
+  ASSERT_EQ(evenOut[0], 3.5);
+  medianAlongAxis(in.data(), out.data(), AxisLayout(1, 0, 2));
+  ASSERT_TRUE(std::isnan(out[0]));
+}
+
+TEST(CpuKernelsTest, nonzeroIndices) {
+  const std::vector<char> in = {0, 1, 0, 0, 1, 1};
+  ASSERT_EQ(nonzeroIndices(in.data(), in.size()), std::vector<int>({1, 4, 5}));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
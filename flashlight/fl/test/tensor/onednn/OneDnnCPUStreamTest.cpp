@@ -5,6 +5,12 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "flashlight/fl/runtime/DeviceManager.h"
@@ -19,13 +25,23 @@ using fl::Stream;
 using fl::StreamType;
 using fl::OneDnnCPUStream;
 
+namespace {
+
+std::shared_ptr<OneDnnCPUStream> createAsyncStream(unsigned numWorkers) {
+  const dnnl::engine engine(dnnl::engine::kind::cpu, 0);
+  return OneDnnCPUStream::create(
+      engine, OneDnnCPUStream::Mode::Asynchronous, numWorkers);
+}
+
+} // namespace
+
 TEST(OneDnnCPUStreamTest, create) {
   const dnnl::engine cpuEngine(dnnl::engine::kind::cpu, 0);
   const auto& manager = DeviceManager::getInstance();
   const auto& x64Device = manager.getActiveDevice(DeviceType::x64);
   const auto stream = OneDnnCPUStream::create(cpuEngine);
 
-  ASSERT_EQ(stream->type, StreamType::Synchronous);
+  ASSERT_EQ(stream->type(), StreamType::Synchronous);
   ASSERT_EQ(&stream->device(), &x64Device);
   ASSERT_EQ(&stream->impl<OneDnnCPUStream>(), stream.get());
 }
@@ -52,6 +68,157 @@ TEST(OneDnnCPUStreamTest, sync) {
   ASSERT_NO_THROW(os1->sync());
 }
 
+TEST(OneDnnCPUStreamTest, createAsync) {
+  const dnnl::engine engine(dnnl::engine::kind::cpu, 0);
+  ASSERT_THROW(
+      OneDnnCPUStream::create(engine, OneDnnCPUStream::Mode::Asynchronous, 0),
+      std::invalid_argument);
+  const auto stream = createAsyncStream(2);
+  ASSERT_EQ(stream->mode(), OneDnnCPUStream::Mode::Asynchronous);
+  ASSERT_EQ(stream->type(), StreamType::Asynchronous);
+  ASSERT_EQ(&stream->impl<OneDnnCPUStream>(), stream.get());
+  ASSERT_NO_THROW(stream->sync());
+
+  // relative synchronization with synchronous streams
+  const std::shared_ptr<Stream> syncStream = OneDnnCPUStream::create(engine);
+  ASSERT_NO_THROW(syncStream->relativeSync(*stream));
+  ASSERT_NO_THROW(stream->relativeSync(*syncStream));
+}
+
+TEST(OneDnnCPUStreamTest, synchronousEnqueueRunsImmediately) {
+  const dnnl::engine engine(dnnl::engine::kind::cpu, 0);
+  const auto stream =
+      OneDnnCPUStream::create(engine, OneDnnCPUStream::Mode::Synchronous);
+  int value = 0;
+  stream->enqueue([&value]() { value = 1; }, {}, {&value});
+  ASSERT_EQ(value, 1);
+  ASSERT_FALSE(stream->deferUntilDone([]() {}));
+}
+
+TEST(OneDnnCPUStreamTest, asyncOrdersWorkOnSameBuffer) {
+  const auto stream = createAsyncStream(4);
+  std::vector<int> order;
+  int buffer = 0;
+  for (int i = 0; i < 100; ++i) {
+    stream->enqueue(
+        [&order, i]() {
+          // give later work a chance to overtake if it wasn't ordered
+          if (i % 10 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+          order.push_back(i);
+        },
+        {},
+        {&buffer});
+  }
+  stream->sync();
+  ASSERT_EQ(order.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(order[i], i);
+  }
+}
+
+TEST(OneDnnCPUStreamTest, asyncReaderWaitsForWriter) {
+  const auto stream = createAsyncStream(2);
+  int buffer = 0;
+  int result = 0;
+  stream->enqueue(
+      [&buffer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer = 42;
+      },
+      {},
+      {&buffer});
+  stream->enqueue(
+      [&buffer, &result]() { result = buffer; }, {&buffer}, {&result});
+  stream->sync();
+  ASSERT_EQ(result, 42);
+}
+
+TEST(OneDnnCPUStreamTest, asyncRunsIndependentWorkConcurrently) {
+  const auto stream = createAsyncStream(2);
+  int buffer1 = 0;
+  int buffer2 = 0;
+  std::atomic<int> running{0};
+  std::atomic<bool> overlapped{false};
+  const auto work = [&]() {
+    if (++running == 2) {
+      overlapped = true;
+    }
+    // wait (bounded) for the other work to start
+    for (int i = 0; i < 1000 && !overlapped; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    --running;
+  };
+  stream->enqueue(work, {}, {&buffer1});
+  stream->enqueue(work, {}, {&buffer2});
+  stream->sync();
+  ASSERT_TRUE(overlapped);
+}
+
+TEST(OneDnnCPUStreamTest, asyncSyncRethrows) {
+  const auto stream = createAsyncStream(1);
+  int buffer = 0;
+  stream->enqueue(
+      []() { throw std::runtime_error("failed"); }, {}, {&buffer});
+  ASSERT_THROW(stream->sync(), std::runtime_error);
+  // the error is only reported once
+  ASSERT_NO_THROW(stream->sync());
+}
+
+TEST(OneDnnCPUStreamTest, asyncRelativeSync) {
+  const auto s1 = createAsyncStream(1);
+  const auto s2 = createAsyncStream(1);
+  int buffer1 = 0;
+  int buffer2 = 0;
+  int result = 0;
+  s2->enqueue(
+      [&buffer2]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer2 = 7;
+      },
+      {},
+      {&buffer2});
+  s1->relativeSync(*s2);
+  // doesn't declare its dependency on buffer2, but is ordered by relativeSync
+  s1->enqueue(
+      [&buffer2, &result]() { result = buffer2; }, {&buffer1}, {&result});
+  s1->sync();
+  ASSERT_EQ(result, 7);
+
+  // waiting on each other, or on itself, doesn't deadlock
+  for (int i = 0; i < 10; ++i) {
+    s1->enqueue([]() {}, {}, {&buffer1});
+    s2->enqueue([]() {}, {}, {&buffer2});
+    s1->relativeSync(*s2);
+    s2->relativeSync(*s1);
+    s1->relativeSync(*s1);
+  }
+  s1->sync();
+  s2->sync();
+}
+
+TEST(OneDnnCPUStreamTest, asyncDeferUntilDone) {
+  const auto stream = createAsyncStream(2);
+  ASSERT_FALSE(stream->deferUntilDone([]() {}));
+
+  int buffer = 0;
+  std::atomic<bool> done{false};
+  std::atomic<bool> doneBeforeCallback{false};
+  stream->enqueue(
+      [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        done = true;
+      },
+      {},
+      {&buffer});
+  ASSERT_TRUE(stream->deferUntilDone(
+      [&]() { doneBeforeCallback = done.load(); }));
+  stream->sync();
+  ASSERT_TRUE(doneBeforeCallback);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
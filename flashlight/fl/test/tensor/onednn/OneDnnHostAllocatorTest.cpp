@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/backend/onednn/OneDnnHostAllocator.h"
+
+using fl::OneDnnHostAllocator;
+
+namespace {
+
+OneDnnHostAllocator::Options testOptions() {
+  OneDnnHostAllocator::Options options;
+  options.cacheLimit = std::numeric_limits<size_t>::max();
+  return options;
+}
+
+bool isAligned(const void* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % OneDnnHostAllocator::kAlignment ==
+      0;
+}
+
+} // namespace
+
+TEST(OneDnnHostAllocatorTest, roundSize) {
+  ASSERT_EQ(OneDnnHostAllocator::roundSize(0), 256);
+  ASSERT_EQ(OneDnnHostAllocator::roundSize(1), 256);
+  ASSERT_EQ(OneDnnHostAllocator::roundSize(256), 256);
+  ASSERT_EQ(OneDnnHostAllocator::roundSize(257), 320);
+  ASSERT_EQ(OneDnnHostAllocator::roundSize(1000), 1024);
+  ASSERT_EQ(OneDnnHostAllocator::roundSize(1025), 1280);
+  // large blocks are whole huge pages
+  ASSERT_EQ(OneDnnHostAllocator::roundSize(3 << 20), 4 << 20);
+  for (size_t bytes = 1; bytes < (1 << 22); bytes = bytes * 3 / 2 + 1) {
+    const auto size = OneDnnHostAllocator::roundSize(bytes);
+    ASSERT_GE(size, bytes);
+    ASSERT_EQ(size % OneDnnHostAllocator::kAlignment, 0);
+    ASSERT_EQ(OneDnnHostAllocator::roundSize(size), size);
+  }
+}
+
+TEST(OneDnnHostAllocatorTest, reuse) {
+  auto allocator = OneDnnHostAllocator::create(testOptions());
+  void* first = nullptr;
+  {
+    auto buffer = allocator->allocate(1000);
+    first = buffer.get();
+    ASSERT_TRUE(isAligned(first));
+    std::memset(first, 1, 1000);
+  }
+  auto stats = allocator->stats();
+  ASSERT_EQ(stats.numNativeAllocs, 1);
+  ASSERT_EQ(stats.cachedBytes, 1024);
+
+  // same size class is served from the cache
+  auto buffer = allocator->allocate(900);
+  ASSERT_EQ(buffer.get(), first);
+  stats = allocator->stats();
+  ASSERT_EQ(stats.numAllocs, 2);
+  ASSERT_EQ(stats.numCacheHits, 1);
+  ASSERT_EQ(stats.numNativeAllocs, 1);
+  ASSERT_EQ(stats.cachedBytes, 0);
+
+  // a different size class isn't
+  auto other = allocator->allocate(5000);
+  ASSERT_NE(other.get(), first);
+  ASSERT_EQ(allocator->stats().numNativeAllocs, 2);
+}
+
+TEST(OneDnnHostAllocatorTest, largeBlocks) {
+  auto allocator = OneDnnHostAllocator::create(testOptions());
+  const size_t bytes = (3 << 20) + 7;
+  void* first = nullptr;
+  {
+    auto buffer = allocator->allocate(bytes);
+    first = buffer.get();
+    ASSERT_TRUE(isAligned(first));
+    std::memset(first, 0, bytes);
+  }
+  auto buffer = allocator->allocate(bytes);
+  ASSERT_EQ(buffer.get(), first);
+  ASSERT_EQ(
+      allocator->stats().allocatedBytes, OneDnnHostAllocator::roundSize(bytes));
+}
+
+TEST(OneDnnHostAllocatorTest, emptyCache) {
+  auto allocator = OneDnnHostAllocator::create(testOptions());
+  allocator->allocate(100);
+  allocator->allocate(1 << 20);
+  allocator->allocate(4 << 20);
+  ASSERT_GT(allocator->stats().cachedBytes, 0);
+  allocator->emptyCache();
+  const auto stats = allocator->stats();
+  ASSERT_EQ(stats.cachedBytes, 0);
+  ASSERT_EQ(stats.allocatedBytes, 0);
+  ASSERT_EQ(stats.numNativeAllocs, stats.numNativeFrees);
+}
+
+TEST(OneDnnHostAllocatorTest, cacheLimit) {
+  auto options = testOptions();
+  options.cacheLimit = 0;
+  options.useThreadCache = false;
+  auto allocator = OneDnnHostAllocator::create(options);
+  allocator->allocate(1000);
+  const auto stats = allocator->stats();
+  ASSERT_EQ(stats.cachedBytes, 0);
+  ASSERT_EQ(stats.numNativeFrees, 1);
+}
+
+TEST(OneDnnHostAllocatorTest, crossThread) {
+  auto allocator = OneDnnHostAllocator::create(testOptions());
+  std::shared_ptr<void> buffer;
+  std::thread producer([&]() {
+    buffer = allocator->allocate(1 << 16);
+    std::memset(buffer.get(), 1, 1 << 16);
+  });
+  producer.join();
+  // freed on this thread, cached in this thread's cache
+  void* ptr = buffer.get();
+  buffer.reset();
+  ASSERT_EQ(allocator->allocate(1 << 16).get(), ptr);
+
+  // blocks cached by exiting threads are handed back to the arenas
+  std::thread worker([&]() {
+    allocator->allocate(1 << 12);
+  });
+  worker.join();
+  const auto stats = allocator->stats();
+  ASSERT_EQ(stats.cachedBytes, (1 << 16) + (1 << 12));
+  allocator->emptyCache();
+  ASSERT_EQ(allocator->stats().allocatedBytes, 0);
+}
+
+TEST(OneDnnHostAllocatorTest, logging) {
+  auto allocator = OneDnnHostAllocator::create(testOptions());
+  ASSERT_THROW(allocator->setLoggingEnabled(true), std::invalid_argument);
+  ASSERT_THROW(allocator->setLogFlushInterval(0), std::invalid_argument);
+
+  std::stringstream logStream;
+  allocator->setLogStream(&logStream);
+  allocator->setLogFlushInterval(2);
+  allocator->allocate(100); // alloc + free
+  ASSERT_EQ(logStream.str().rfind("alloc 256 ", 0), 0);
+  ASSERT_NE(logStream.str().find("free 256 "), std::string::npos);
+
+  allocator->setLoggingEnabled(false);
+  const auto logged = logStream.str();
+  allocator->allocate(100);
+  allocator->allocate(100);
+  ASSERT_EQ(logStream.str(), logged);
+
+  std::stringstream info;
+  allocator->printInfo("info", &info);
+  ASSERT_NE(info.str().find("OneDnnHostAllocator"), std::string::npos);
+  ASSERT_NE(info.str().find("cache hits"), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
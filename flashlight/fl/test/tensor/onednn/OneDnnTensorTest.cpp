@@ -8,12 +8,19 @@
 #include <cmath>
 #include <exception>
 #include <limits>
+#include <sstream>
 #include <stdexcept>
 
 #include <gtest/gtest.h>
 
+#include "flashlight/fl/autograd/Variable.h"
+#include "flashlight/fl/autograd/tensor/backend/onednn/DnnlUtils.h"
+#include "flashlight/fl/nn/modules/Conv2D.h"
+#include "flashlight/fl/nn/modules/RNN.h"
+#include "flashlight/fl/tensor/Compute.h"
 #include "flashlight/fl/tensor/Index.h"
 #include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/Random.h"
 #include "flashlight/fl/tensor/backend/onednn/OneDnnBackend.h"
 #include "flashlight/fl/tensor/backend/onednn/OneDnnTensor.h"
 
@@ -259,6 +266,45 @@ TEST(OneDnnTensorTest, astype) {
   assertOneDnnTensorEq(tFloat, tInt.astype(fl::dtype::f32));
 }
 
+TEST(OneDnnTensorTest, bf16) {
+  using MP = fl::MatrixProperty;
+  auto& backend = fl::OneDnnBackend::getInstance();
+  // small integers are exactly representable in bf16
+  auto tFloat = fl::full({2, 2, 2}, 40.0f, fl::dtype::f32);
+  auto tBf16 = tFloat.astype(fl::dtype::bf16);
+  ASSERT_EQ(tBf16.type(), fl::dtype::bf16);
+  assertOneDnnTensorEq(tFloat, tBf16.astype(fl::dtype::f32));
+  // float literals don't promote bf16 tensors
+  ASSERT_EQ((tBf16 * 2.0).type(), fl::dtype::bf16);
+  ASSERT_EQ(fl::tanh(tBf16).type(), fl::dtype::bf16);
+
+  auto t1 = fl::Tensor::fromVector<float>({2, 3}, {1, 4, 2, 5, 3, 6});
+  auto t2 = fl::Tensor::fromVector<float>({3, 2}, {2, 3, 4, 5, 6, 7});
+  auto res = backend.matmul(
+      t1.astype(fl::dtype::bf16),
+      t2.astype(fl::dtype::bf16),
+      MP::None,
+      MP::None);
+  ASSERT_EQ(res.type(), fl::dtype::bf16);
+  assertOneDnnTensorEq(
+      res.astype(fl::dtype::f32),
+      fl::Tensor::fromVector<float>({2, 2}, {20, 47, 38, 92}));
+}
+
+TEST(OneDnnTensorTest, bf16Rounding) {
+  // bf16 keeps 7 explicit mantissa bits, i.e. a spacing of 2^-7 in [1, 2)
+  const float ulp = 1.0f / 128;
+  auto t = fl::Tensor::fromVector<float>(
+      {4},
+      {1 + 0.75f * ulp, // above the midpoint: rounds up
+       1 + 0.25f * ulp, // below the midpoint: rounds down
+       1 + 0.5f * ulp, // tie: rounds to the even mantissa (1)
+       1 + 1.5f * ulp}); // tie: rounds to the even mantissa (1 + 2 ulp)
+  assertOneDnnTensorEq(
+      t.astype(fl::dtype::bf16).astype(fl::dtype::f32),
+      fl::Tensor::fromVector<float>({4}, {1 + ulp, 1, 1, 1 + 2 * ulp}));
+}
+
 TEST(OneDnnTensorTest, host) {
   const std::vector<int> data{0, 1, 2, 3};
   std::vector<int> temp(4, 0);
@@ -553,9 +599,11 @@ TEST(OneDnnTensorTest, matmulShapes) {
       // batch matrix
       {{2, 3, 42}, {2, 3, 42}, MP::None, MP::Transpose, {{2, 2, 42}}},
       {{2, 3, 41}, {2, 3, 42}, MP::None, MP::Transpose, std::nullopt},
-      // TODO support broadcast
-      {{2, 3, 1}, {2, 3, 42}, MP::None, MP::Transpose, std::nullopt},
-      {{2, 3}, {2, 3, 42}, MP::None, MP::Transpose, std::nullopt},
+      // batch broadcast
+      {{2, 3, 1}, {2, 3, 42}, MP::None, MP::Transpose, {{2, 2, 42}}},
+      {{2, 3}, {2, 3, 42}, MP::None, MP::Transpose, {{2, 2, 42}}},
+      {{3, 2, 5, 1}, {3, 4, 1, 6}, MP::Transpose, MP::None, {{2, 4, 5, 6}}},
+      {{2, 3, 2}, {3, 4, 3}, MP::None, MP::None, std::nullopt},
   };
   for (auto& input : inputs) {
     const auto lhs = backend.rand(input.lhsShape, fl::dtype::f32);
@@ -572,6 +620,57 @@ TEST(OneDnnTensorTest, matmulShapes) {
   }
 }
 
+TEST(OneDnnTensorTest, matmulBroadcastBatch) {
+  unsigned M = 4;
+  unsigned K = 5;
+  unsigned N = 6;
+  auto a = fl::rand({M, K, 1, 3});
+  auto b = fl::rand({K, N, 2, 1});
+  auto out = fl::matmul(a, b);
+  ASSERT_EQ(out.shape(), fl::Shape({M, N, 2, 3}));
+  for (unsigned i = 0; i < 2; ++i) {
+    for (unsigned j = 0; j < 3; ++j) {
+      ASSERT_TRUE(fl::allClose(
+          out(fl::span, fl::span, i, j),
+          fl::matmul(
+              a(fl::span, fl::span, 0, j), b(fl::span, fl::span, i, 0))));
+    }
+  }
+  ASSERT_THROW(
+      fl::matmul(fl::rand({M, K, 2}), fl::rand({K, N, 3})),
+      std::invalid_argument);
+}
+
+TEST(OneDnnTensorTest, fusedMatmul) {
+  using MP = fl::MatrixProperty;
+  // 1 2 3  X  2 5  =  20 38
+  // 4 5 6     3 6     47 92
+  //           4 7
+  auto t1 = fl::Tensor::fromVector<float>({2, 3}, {1, 4, 2, 5, 3, 6});
+  auto t2 = fl::Tensor::fromVector<float>({3, 2}, {2, 3, 4, 5, 6, 7});
+  auto bias = fl::Tensor::fromVector<float>({2}, {-30, -50});
+  // 2 * (20 38) - (30) = (10 46)
+  //     (47 92)   (50)   (44 134)
+  auto res = fl::fusedMatmul(t1, t2, bias, MP::None, MP::None, 2, 1);
+  assertOneDnnTensorEq(
+      res, fl::Tensor::fromVector<float>({2, 2}, {10, 44, 46, 134}));
+  // 0.5 * (20 38) - 2 * (30) = (-50 -41), relu -> (0 0)
+  //       (47 92)       (50)   (-76.5 -54)         (0 0)
+  res = fl::fusedMatmul(
+      t1, t2, bias, MP::None, MP::None, 0.5, 2, fl::MatmulActivation::Relu);
+  assertOneDnnTensorEq(
+      res, fl::Tensor::fromVector<float>({2, 2}, {0, 0, 0, 0}));
+  // transposed operands and a scalar bias
+  res = fl::fusedMatmul(
+      fl::transpose(t1),
+      fl::transpose(t2),
+      fl::Tensor::fromVector<float>({1}, {1}),
+      MP::Transpose,
+      MP::Transpose);
+  assertOneDnnTensorEq(
+      res, fl::Tensor::fromVector<float>({2, 2}, {21, 48, 39, 93}));
+}
+
 TEST(OneDnnTensorTest, max) {
   using fl::Shape;
   using fl::Tensor;
@@ -678,6 +777,365 @@ TEST(OneDnnTensorTest, arange) {
       fl::Tensor::fromVector<float>({2, 2}, {0, 0, 1, 1}));
 }
 
+TEST(OneDnnTensorTest, iota) {
+  assertOneDnnTensorEq(
+      fl::iota({2, 2}, {1, 2}, fl::dtype::s32),
+      fl::Tensor::fromVector<int>({2, 4}, {0, 1, 2, 3, 0, 1, 2, 3}));
+}
+
+TEST(OneDnnTensorTest, indexWithTensor) {
+  // 1 4 7
+  // 2 5 8
+  // 3 6 9
+  auto a = fl::Tensor::fromVector<float>({3, 3}, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  const auto idx = fl::Tensor::fromVector<int>({2}, {2, 0});
+  assertOneDnnTensorEq(
+      a(idx), fl::Tensor::fromVector<float>({2, 3}, {3, 1, 6, 4, 9, 7}));
+  assertOneDnnTensorEq(
+      a(1, idx), fl::Tensor::fromVector<float>({2}, {8, 2}));
+  assertOneDnnTensorEq(
+      a(fl::range(0, 2), idx),
+      fl::Tensor::fromVector<float>({2, 2}, {7, 8, 1, 2}));
+  const auto mask = fl::Tensor::fromVector<char>({3}, {0, 1, 1});
+  assertOneDnnTensorEq(
+      a(fl::span, mask),
+      fl::Tensor::fromVector<float>({3, 2}, {4, 5, 6, 7, 8, 9}));
+  ASSERT_THROW(a(fl::Tensor::fromVector<int>({1}, {3})), std::invalid_argument);
+  // masks index a single axis
+  ASSERT_THROW(
+      a(fl::full({3, 3}, 1, fl::dtype::b8)), std::invalid_argument);
+}
+
+TEST(OneDnnTensorTest, assignWithTensorIndex) {
+  auto a = fl::Tensor::fromVector<float>({3, 3}, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  a(fl::Tensor::fromVector<int>({2}, {2, 0})) =
+      fl::Tensor::fromVector<float>({2, 3}, {0, -1, 0, -4, 0, -7});
+  assertOneDnnTensorEq(
+      a,
+      fl::Tensor::fromVector<float>({3, 3}, {-1, 2, 0, -4, 5, 0, -7, 8, 0}));
+
+  // through a view, and with a mask
+  const auto mask = fl::Tensor::fromVector<char>({3}, {1, 0, 1});
+  a(1, mask) = fl::Tensor::fromVector<float>({2}, {20, 80});
+  assertOneDnnTensorEq(
+      a,
+      fl::Tensor::fromVector<float>({3, 3}, {-1, 20, 0, -4, 5, 0, -7, 80, 0}));
+
+  // the gathered tensor is still a copy otherwise
+  auto gathered = a(fl::Tensor::fromVector<int>({1}, {1}));
+  gathered = fl::full({1, 3}, 100.f);
+  ASSERT_EQ(a(1, 1).scalar<float>(), 5);
+}
+
+TEST(OneDnnTensorTest, unaryCpuKernels) {
+  auto a = fl::Tensor::fromVector<float>({4}, {-1.5, -0.5, 0.5, 1.5});
+  assertOneDnnTensorEq(
+      fl::floor(a), fl::Tensor::fromVector<float>({4}, {-2, -1, 0, 1}));
+  assertOneDnnTensorEq(
+      fl::ceil(a), fl::Tensor::fromVector<float>({4}, {-1, -0, 1, 2}));
+  assertOneDnnTensorEq(
+      fl::sin(a),
+      fl::Tensor::fromVector<float>(
+          {4},
+          {std::sin(-1.5f), std::sin(-0.5f), std::sin(0.5f), std::sin(1.5f)}));
+  assertOneDnnTensorEq(
+      fl::cos(a),
+      fl::Tensor::fromVector<float>(
+          {4},
+          {std::cos(-1.5f), std::cos(-0.5f), std::cos(0.5f), std::cos(1.5f)}));
+  assertOneDnnTensorEq(
+      fl::sigmoid(fl::Tensor::fromVector<float>({1}, {0})),
+      fl::Tensor::fromVector<float>({1}, {0.5}));
+
+  auto b = fl::Tensor::fromVector<int>({2}, {1, 2});
+  assertOneDnnTensorEq(fl::floor(b), fl::Tensor::fromVector<int>({2}, {1, 2}));
+  ASSERT_EQ(fl::sin(b).type(), fl::dtype::f32);
+  ASSERT_EQ(fl::floor(a.astype(fl::dtype::f16)).type(), fl::dtype::f16);
+}
+
+TEST(OneDnnTensorTest, shapingCpuKernels) {
+  // 1 3
+  // 2 4
+  auto a = fl::Tensor::fromVector<float>({2, 2}, {1, 2, 3, 4});
+  assertOneDnnTensorEq(
+      fl::concatenate({a, a(fl::span, 0)}, 1),
+      fl::Tensor::fromVector<float>({2, 3}, {1, 2, 3, 4, 1, 2}));
+  assertOneDnnTensorEq(
+      fl::concatenate({a, a}, 0),
+      fl::Tensor::fromVector<float>({4, 2}, {1, 2, 1, 2, 3, 4, 3, 4}));
+  ASSERT_THROW(
+      fl::concatenate({a, fl::full({3, 2}, 1.)}, 1), std::invalid_argument);
+
+  assertOneDnnTensorEq(
+      fl::pad(a, {{1, 0}}),
+      fl::Tensor::fromVector<float>({3, 2}, {0, 1, 2, 0, 3, 4}));
+  assertOneDnnTensorEq(
+      fl::pad(a, {{0, 0}, {0, 1}}, fl::PadType::Edge),
+      fl::Tensor::fromVector<float>({2, 3}, {1, 2, 3, 4, 3, 4}));
+  assertOneDnnTensorEq(
+      fl::pad(a(fl::span, 0), {{2, 2}}, fl::PadType::Symmetric),
+      fl::Tensor::fromVector<float>({6}, {2, 1, 1, 2, 2, 1}));
+
+  assertOneDnnTensorEq(
+      fl::flip(a, 1), fl::Tensor::fromVector<float>({2, 2}, {3, 4, 1, 2}));
+  assertOneDnnTensorEq(
+      fl::roll(fl::Tensor::fromVector<int>({4}, {1, 2, 3, 4}), 1, 0),
+      fl::Tensor::fromVector<int>({4}, {4, 1, 2, 3}));
+
+  assertOneDnnTensorEq(
+      fl::tril(a), fl::Tensor::fromVector<float>({2, 2}, {1, 2, 0, 4}));
+  assertOneDnnTensorEq(
+      fl::triu(a), fl::Tensor::fromVector<float>({2, 2}, {1, 0, 3, 4}));
+
+  const auto condition = fl::Tensor::fromVector<char>({2, 2}, {1, 0, 0, 1});
+  assertOneDnnTensorEq(
+      fl::where(condition, a, -a),
+      fl::Tensor::fromVector<float>({2, 2}, {1, -2, -3, 4}));
+  assertOneDnnTensorEq(
+      fl::nonzero(condition), fl::Tensor::fromVector<int>({2}, {0, 3}));
+}
+
+TEST(OneDnnTensorTest, sortCpuKernels) {
+  // 3 1
+  // 1 4
+  // 2 1
+  auto a = fl::Tensor::fromVector<float>({3, 2}, {3, 1, 2, 1, 4, 1});
+  assertOneDnnTensorEq(
+      fl::sort(a, 0),
+      fl::Tensor::fromVector<float>({3, 2}, {1, 2, 3, 1, 1, 4}));
+  assertOneDnnTensorEq(
+      fl::argsort(a, 0, fl::SortMode::Descending),
+      fl::Tensor::fromVector<int>({3, 2}, {0, 2, 1, 1, 0, 2}));
+
+  fl::Tensor values, indices;
+  fl::topk(values, indices, a, 1, 1);
+  assertOneDnnTensorEq(
+      values, fl::Tensor::fromVector<float>({3, 1}, {3, 4, 2}));
+  assertOneDnnTensorEq(indices, fl::Tensor::fromVector<int>({3, 1}, {0, 1, 0}));
+  ASSERT_THROW(fl::topk(values, indices, a, 3, 1), std::invalid_argument);
+
+  assertOneDnnTensorEq(
+      fl::argmax(a, 0), fl::Tensor::fromVector<int>({2}, {0, 1}));
+  assertOneDnnTensorEq(
+      fl::argmin(a, 1, /* keepDims = */ true),
+      fl::Tensor::fromVector<int>({3, 1}, {1, 0, 1}));
+}
+
+TEST(OneDnnTensorTest, statisticsCpuKernels) {
+  // 1 4
+  // 2 6
+  // 3 8
+  auto a = fl::Tensor::fromVector<float>({3, 2}, {1, 2, 3, 4, 6, 8});
+  assertOneDnnTensorEq(
+      fl::cumsum(a, 0),
+      fl::Tensor::fromVector<float>({3, 2}, {1, 3, 6, 4, 10, 18}));
+  auto mask = fl::Tensor::fromVector<char>({3}, {1, 1, 1});
+  assertOneDnnTensorEq(
+      fl::cumsum(mask, 0), fl::Tensor::fromVector<int>({3}, {1, 2, 3}));
+
+  assertOneDnnTensorEq(
+      fl::median(a, {0}), fl::Tensor::fromVector<float>({2}, {2, 6}));
+  assertOneDnnTensorEq(
+      fl::median(a, {1}, /* keepDims = */ true),
+      fl::Tensor::fromVector<float>({3, 1}, {2.5, 4, 5.5}));
+  assertOneDnnTensorEq(
+      fl::median(a), fl::Tensor::fromVector<float>({}, {3.5}));
+
+  assertOneDnnTensorEq(
+      fl::var(a, {0}), fl::Tensor::fromVector<float>({2}, {2.f / 3, 8.f / 3}));
+  assertOneDnnTensorEq(
+      fl::var(a, {0}, /* bias = */ true),
+      fl::Tensor::fromVector<float>({2}, {1, 4}));
+  assertOneDnnTensorEq(
+      fl::std(a, {1}), fl::Tensor::fromVector<float>({3}, {1.5, 2, 2.5}));
+}
+
+TEST(OneDnnTensorTest, hostAllocator) {
+  auto& allocator = fl::OneDnnBackend::getInstance().hostAllocator();
+  { auto a = fl::full({64, 64}, 1.) + 1; }
+  const auto stats = allocator.stats();
+  { auto b = fl::full({64, 64}, 2.) * 2; }
+  // the buffers of `a` are recycled for `b`
+  ASSERT_EQ(allocator.stats().numNativeAllocs, stats.numNativeAllocs);
+  ASSERT_GT(allocator.stats().numCacheHits, stats.numCacheHits);
+
+  std::stringstream info;
+  fl::getMemMgrInfo("hostAllocator", 0, &info);
+  ASSERT_NE(info.str().find("OneDnnHostAllocator"), std::string::npos);
+  std::stringstream log;
+  fl::setMemMgrLogStream(&log);
+  fl::setMemMgrFlushInterval(1);
+  { auto c = fl::full({4}, 3.); }
+  fl::setMemMgrLoggingEnabled(false);
+  ASSERT_NE(log.str().find("alloc"), std::string::npos);
+  ASSERT_NE(log.str().find("free"), std::string::npos);
+}
+
+TEST(OneDnnTensorTest, opaqueLayout) {
+  auto& backend = fl::OneDnnBackend::getInstance();
+  const fl::Shape shape({2, 2, 16, 1}); // WHCN, i.e., NCHW dims {1, 16, 2, 2}
+  auto plain = fl::arange(shape, 2);
+  const dnnl::memory::desc blockedDesc(
+      {1, 16, 2, 2},
+      dnnl::memory::data_type::f32,
+      dnnl::memory::format_tag::nChw8c);
+  dnnl::memory blockedMem(blockedDesc, backend.engine());
+  auto plainMem = plain.getAdapter<OneDnnTensor>().layoutMemory();
+  dnnl::reorder(plainMem, blockedMem)
+      .execute(backend.nativeStream(), plainMem, blockedMem);
+  backend.nativeStream().wait();
+
+  auto blocked = fl::toTensor<OneDnnTensor>(shape, std::move(blockedMem));
+  auto& blockedTensor = blocked.getAdapter<OneDnnTensor>();
+  ASSERT_TRUE(blockedTensor.hasOpaqueLayout());
+  // OneDNN-backed ops keep the layout
+  auto sum = fl::abs(blocked) + blocked;
+  ASSERT_TRUE(sum.getAdapter<OneDnnTensor>().hasOpaqueLayout());
+  auto scaled = blocked * 2;
+  ASSERT_TRUE(scaled.getAdapter<OneDnnTensor>().hasOpaqueLayout());
+  // reading data reorders lazily, once
+  assertOneDnnTensorEq(sum, plain * 2);
+  ASSERT_FALSE(sum.getAdapter<OneDnnTensor>().hasOpaqueLayout());
+  assertOneDnnTensorEq(blocked, plain.copy());
+  ASSERT_FALSE(blockedTensor.hasOpaqueLayout());
+  ASSERT_EQ(
+      scaled(fl::span, fl::span, 3).toHostVector<float>(),
+      std::vector<float>({6, 6, 6, 6}));
+
+  // replace a plain tensor's data with a blocked copy
+  auto target = plain.copy();
+  auto shallow = target.shallowCopy();
+  dnnl::memory copyMem(blockedDesc, backend.engine());
+  dnnl::reorder(plainMem, copyMem)
+      .execute(backend.nativeStream(), plainMem, copyMem);
+  target.getAdapter<OneDnnTensor>().setLayoutMemory(copyMem);
+  ASSERT_TRUE(shallow.getAdapter<OneDnnTensor>().hasOpaqueLayout());
+  assertOneDnnTensorEq(shallow, plain.copy());
+  ASSERT_THROW(
+      target(fl::range(0, 1)).getAdapter<OneDnnTensor>().setLayoutMemory(
+          dnnl::memory(blockedDesc, backend.engine())),
+      std::invalid_argument);
+  ASSERT_THROW(
+      fl::toTensor<OneDnnTensor>(
+          fl::Shape({4, 16}), dnnl::memory(blockedDesc, backend.engine())),
+      std::invalid_argument);
+}
+
+TEST(OneDnnTensorTest, dataVersion) {
+  auto a = fl::full({4, 4}, 1.);
+  auto shallow = a.shallowCopy();
+  auto& adapter = a.getAdapter<OneDnnTensor>();
+  const auto version = adapter.version();
+  auto deep = a.copy();
+  ASSERT_EQ(adapter.version(), version);
+  // writes through views and shallow copies are seen
+  a(fl::range(0, 2)) = fl::full({2, 4}, 2.);
+  ASSERT_EQ(shallow.getAdapter<OneDnnTensor>().version(), version + 1);
+  shallow.device<float>();
+  shallow.unlock();
+  ASSERT_EQ(adapter.version(), version + 2);
+  ASSERT_EQ(deep.getAdapter<OneDnnTensor>().version(), 0);
+
+  auto dataId = adapter.dataId();
+  ASSERT_EQ(dataId.lock(), shallow.getAdapter<OneDnnTensor>().dataId().lock());
+  ASSERT_NE(dataId.lock(), deep.getAdapter<OneDnnTensor>().dataId().lock());
+  a = fl::Tensor();
+  ASSERT_FALSE(dataId.expired());
+  shallow = fl::Tensor();
+  ASSERT_TRUE(dataId.expired());
+}
+
+TEST(OneDnnTensorTest, weightsCache) {
+  auto& backend = fl::OneDnnBackend::getInstance();
+  auto& cache = fl::detail::DnnlWeightsCache::getInstance();
+  cache.clear();
+  auto weights = fl::rand({4, 16});
+  const auto plainDesc = weights.getAdapter<OneDnnTensor>().memoryDesc();
+  const dnnl::memory::desc transposedDesc(
+      {16, 4}, dnnl::memory::data_type::f32, dnnl::memory::format_tag::ba);
+  int numConversions = 0;
+  auto convert = [&]() {
+    ++numConversions;
+    return dnnl::memory(transposedDesc, backend.engine());
+  };
+
+  auto memory = cache.get(weights, "test", transposedDesc, convert);
+  ASSERT_EQ(numConversions, 1);
+  // unchanged weights, and their shallow copies, aren't converted again
+  ASSERT_EQ(
+      cache.get(weights, "test", transposedDesc, convert).get_data_handle(),
+      memory.get_data_handle());
+  ASSERT_EQ(
+      cache.get(weights.shallowCopy(), "test", transposedDesc, convert)
+          .get_data_handle(),
+      memory.get_data_handle());
+  ASSERT_EQ(numConversions, 1);
+  // but other conversions, views, and written weights are
+  cache.get(weights, "other", transposedDesc, convert);
+  ASSERT_EQ(numConversions, 2);
+  cache.get(weights(fl::range(0, 2)), "test", transposedDesc, convert);
+  ASSERT_EQ(numConversions, 3);
+  weights(fl::range(0, 2)) = fl::full({2, 16}, 0.);
+  cache.get(weights, "test", transposedDesc, convert);
+  ASSERT_EQ(numConversions, 4);
+  cache.get(weights, "test", transposedDesc, convert);
+  ASSERT_EQ(numConversions, 4);
+
+  // a reorder only converts weights not already in the wanted layout
+  auto plainMemory = weights.getAdapter<OneDnnTensor>().layoutMemory();
+  ASSERT_EQ(
+      cache.reorder(weights, "reorder", plainMemory, plainDesc)
+          .get_data_handle(),
+      plainMemory.get_data_handle());
+  auto reordered =
+      cache.reorder(weights, "reorder", plainMemory, transposedDesc);
+  ASSERT_EQ(reordered.get_desc(), transposedDesc);
+  ASSERT_EQ(
+      cache.reorder(weights, "reorder", plainMemory, transposedDesc)
+          .get_data_handle(),
+      reordered.get_data_handle());
+
+  // the conversions of freed weights are dropped
+  const auto size = cache.size();
+  ASSERT_GT(size, 0);
+  weights = fl::Tensor();
+  auto other = fl::rand({4, 16});
+  cache.get(other, "test", transposedDesc, convert);
+  ASSERT_EQ(cache.size(), 1);
+  cache.clear();
+}
+
+TEST(OneDnnTensorTest, weightsCacheModules) {
+  auto& cache = fl::detail::DnnlWeightsCache::getInstance();
+
+  // the weights of modules are converted on the first eval forward only
+  fl::RNN rnn(8, 16, 2, fl::RnnMode::LSTM);
+  rnn.eval();
+  const fl::Variable sequence(fl::rand({8, 4, 5}), false);
+  cache.clear();
+  const auto expectedSequence = rnn.forward(sequence).tensor();
+  const auto rnnMisses = cache.misses();
+  ASSERT_GT(rnnMisses, 0);
+  ASSERT_EQ(cache.hits(), 0);
+  ASSERT_TRUE(
+      allClose(rnn.forward(sequence).tensor(), expectedSequence, 1e-5));
+  ASSERT_EQ(cache.misses(), rnnMisses);
+  ASSERT_EQ(cache.hits(), rnnMisses);
+
+  fl::Conv2D conv(16, 32, 3, 3);
+  conv.eval();
+  const fl::Variable image(fl::rand({10, 10, 16, 2}), false);
+  cache.clear();
+  const auto expectedImage = conv.forward(image).tensor();
+  const auto convMisses = cache.misses();
+  // weights reordered for the convolution are kept in that layout
+  const auto& convWeights = conv.param(0).tensor().getAdapter<OneDnnTensor>();
+  ASSERT_EQ(convWeights.hasOpaqueLayout(), convMisses > 0);
+  ASSERT_TRUE(allClose(conv.forward(image).tensor(), expectedImage, 1e-5));
+  ASSERT_EQ(cache.misses(), convMisses);
+  cache.clear();
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
@@ -11,6 +11,7 @@
 
 #include "flashlight/fl/tensor/Compute.h"
 
+#if FL_HALIDE_USE_CUDA
 #include <cublas_v2.h> // this must proceed `af/cuda.h` for some reason
 #include <af/cuda.h>
 #include <af/device.h>
@@ -141,6 +142,7 @@ int halide_get_gpu_device(void* /* user_context */) {
 }
 
 } // extern "C"
+#endif // FL_HALIDE_USE_CUDA
 
 namespace fl {
 namespace pkg {
@@ -13,7 +13,9 @@
 #include <Halide.h>
 #include <HalideBuffer.h>
 #include <HalideRuntime.h>
+#if FL_HALIDE_USE_CUDA
 #include <HalideRuntimeCuda.h>
+#endif
 
 #include "flashlight/fl/autograd/Variable.h"
 #include "flashlight/fl/common/DevicePtr.h"
@@ -46,8 +48,49 @@ Shape halideToFlDims(const Halide::Buffer<void>& buffer);
 
 fl::dtype halideRuntimeTypeToFlType(halide_type_t type);
 
+namespace detail {
+
 /**
- * A thin wrapper around an ArrayFire array as converted to a Halide buffer.
+ * Throws if a tensor can't be wrapped in a Halide buffer of type T: its memory
+ * must be on the host (ArrayFire CPU or OneDNN backends) or on a CUDA device
+ * (ArrayFire CUDA backend, if built with CUDA support), be contiguous and hold
+ * elements of type T.
+ */
+template <typename T>
+void checkWrappable(const Tensor& tensor) {
+  const auto backend = tensor.backendType();
+  if (backend != TensorBackendType::ArrayFire &&
+      backend != TensorBackendType::OneDnn) {
+    throw std::runtime_error(
+        "[HalideBufferWrapper] Only support Tensor with ArrayFire or OneDnn "
+        "backends");
+  }
+#if !FL_HALIDE_USE_CUDA
+  if (tensor.location() != Location::Host) {
+    throw std::runtime_error(
+        "[HalideBufferWrapper] device Tensors require Flashlight Halide to be "
+        "built with CUDA");
+  }
+#endif
+  if (!tensor.isContiguous()) {
+    throw std::invalid_argument(
+        "[HalideBufferWrapper] Tensor must be contiguous");
+  }
+  if (tensor.type() != dtype_traits<T>::fl_type) {
+    throw std::invalid_argument(
+        "[HalideBufferWrapper] Tensor of type " +
+        std::string(dtypeToString(tensor.type())) +
+        " can't be wrapped in a buffer of type " + dtype_traits<T>::getName());
+  }
+}
+
+} // namespace detail
+
+/**
+ * A thin wrapper around a Flashlight Tensor as converted to a Halide buffer.
+ * Host tensors (ArrayFire CPU and OneDNN backends) are wrapped as host memory,
+ * for pipelines scheduled on the CPU; CUDA tensors as CUDA device memory, for
+ * pipelines scheduled on the GPU.
  *
  * Uses RAII via DevicePtr to ensure that the memory associated with the
  * underlying Array is properly managed as it relates to the lifetime of hte
@@ -61,17 +104,22 @@ template <typename T>
 class HalideBufferWrapper {
  public:
   HalideBufferWrapper(Tensor& tensor) {
-    if (tensor.backendType() != TensorBackendType::ArrayFire) {
-      throw std::runtime_error(
-          "[HalideBufferWrapper] Only support Tensor with ArrayFireBackend");
-    }
+    detail::checkWrappable<T>(tensor);
     devicePtr_ = DevicePtr(tensor);
+    if (tensor.location() == Location::Host) {
+      // The buffer doesn't own host memory it wraps
+      halideBuffer_ = Halide::Buffer<T>(
+          devicePtr_.getAs<T>(), flToHalideDims(tensor.shape()));
+      return;
+    }
+#if FL_HALIDE_USE_CUDA
     halideBuffer_ = Halide::Buffer<T>(flToHalideDims(tensor.shape()));
     // Halide::Buffer::device_detach_native(...) is implicitly called by the
     // Halide::Buffer dtor which will preserve the Array's underlying memory
     FL_HALIDE_CHECK(halideBuffer_.device_wrap_native(
         halide_cuda_device_interface(), (uint64_t)devicePtr_.get()));
     halideBuffer_.set_device_dirty();
+#endif
   }
 
   Halide::Buffer<T>& getBuffer() {
@@ -99,13 +147,17 @@ namespace detail {
  */
 template <typename T>
 Halide::Buffer<T> toHalideBuffer(Tensor& arr) {
-  if (arr.backendType() != TensorBackendType::ArrayFire) {
-    throw std::runtime_error(
-        "[HalideBufferWrapper] Only support Tensor with ArrayFireBackend");
-  }
+  checkWrappable<T>(arr);
   // Since the buffer manages the memory, give it a persistent pointer that
   // won't be unlocked or invalidated if the Array falls out of scope.
   void* deviceMem = arr.device<void>();
+  if (arr.location() == Location::Host) {
+    return Halide::Buffer<T>(
+        static_cast<T*>(deviceMem), flToHalideDims(arr.shape()));
+  }
+#if !FL_HALIDE_USE_CUDA
+  throw std::logic_error("toHalideBuffer: unreachable without CUDA");
+#else
   Halide::Buffer<T> buffer(flToHalideDims(arr.shape()));
   // Target is CUDA only -- TODO: change based on location of Tensor
   // and try to move away from halide_cuda_device_interface()
@@ -119,6 +171,7 @@ Halide::Buffer<T> toHalideBuffer(Tensor& arr) {
       halide_cuda_device_interface(), (uint64_t)deviceMem));
   buffer.set_device_dirty();
   return buffer;
+#endif
 }
 
 /**
@@ -129,7 +182,7 @@ Halide::Buffer<T> toHalideBuffer(Tensor& arr) {
  * Halide Buffer's underlying memory and creates a new Array with it. Only
  * buffer types created with Halide::BufferDeviceOwnership::Unmanaged can be
  * convered since otherwise the underlying memory will be freed once the Buffer
- * is destroyed.
+ * is destroyed. Buffers without device memory are copied from the host.
  *
  * @param buffer the Halide buffer with which to create the Array
  * @return a Flashlight Tensor that has the same underlying memory and
@@ -137,6 +190,10 @@ Halide::Buffer<T> toHalideBuffer(Tensor& arr) {
  */
 template <typename T>
 Tensor fromHalideBuffer(Halide::Buffer<T>& buffer) {
+  if (!buffer.has_device_allocation()) {
+    return Tensor::fromBuffer(
+        halideToFlDims(buffer), buffer.data(), MemoryLocation::Host);
+  }
   T* deviceMem = reinterpret_cast<T*>(buffer.raw_buffer()->device);
   if (buffer.get()->device_ownership() ==
       Halide::Runtime::BufferDeviceOwnership::WrappedNative) {
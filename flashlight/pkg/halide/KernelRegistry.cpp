@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/halide/KernelRegistry.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace fl {
+namespace pkg {
+namespace halide {
+
+HalideKernelRegistry& HalideKernelRegistry::getInstance() {
+  static HalideKernelRegistry instance;
+  return instance;
+}
+
+void HalideKernelRegistry::registerKernel(
+    const std::string& op,
+    fl::dtype type,
+    HalideKernel kernel) {
+  if (!kernel.forward) {
+    throw std::invalid_argument(
+        "HalideKernelRegistry::registerKernel - kernel for op " + op +
+        " has no forward function");
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  anyShape_[{op, type}] = std::move(kernel);
+}
+
+void HalideKernelRegistry::registerKernel(
+    const std::string& op,
+    fl::dtype type,
+    const Shape& shape,
+    HalideKernel kernel) {
+  if (!kernel.forward) {
+    throw std::invalid_argument(
+        "HalideKernelRegistry::registerKernel - kernel for op " + op +
+        " has no forward function");
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  byShape_[{op, type, shape.get()}] = std::move(kernel);
+}
+
+std::optional<HalideKernel> HalideKernelRegistry::find(
+    const std::string& op,
+    fl::dtype type,
+    const Shape& shape) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto exact = byShape_.find({op, type, shape.get()});
+  if (exact != byShape_.end()) {
+    return exact->second;
+  }
+  auto any = anyShape_.find({op, type});
+  if (any != anyShape_.end()) {
+    return any->second;
+  }
+  return std::nullopt;
+}
+
+void HalideKernelRegistry::unregisterOp(const std::string& op) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = anyShape_.begin(); it != anyShape_.end();) {
+    it = std::get<0>(it->first) == op ? anyShape_.erase(it) : std::next(it);
+  }
+  for (auto it = byShape_.begin(); it != byShape_.end();) {
+    it = std::get<0>(it->first) == op ? byShape_.erase(it) : std::next(it);
+  }
+}
+
+Variable halideFunction(
+    const std::string& op,
+    const std::vector<Variable>& inputs,
+    const std::function<Variable(const std::vector<Variable>&)>& fallback) {
+  if (inputs.empty()) {
+    throw std::invalid_argument("halideFunction - op " + op + " has no inputs");
+  }
+  auto kernel = HalideKernelRegistry::getInstance().find(
+      op, inputs[0].type(), inputs[0].shape());
+  if (!kernel) {
+    return fallback(inputs);
+  }
+
+  std::vector<Tensor> inputTensors;
+  inputTensors.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    inputTensors.push_back(input.tensor());
+  }
+  auto outputs = kernel->forward(inputTensors);
+  if (outputs.empty()) {
+    throw std::runtime_error(
+        "halideFunction - kernel for op " + op + " returned no outputs");
+  }
+  auto backward = kernel->backward;
+  auto gradFunc = [op, backward](
+                      std::vector<Variable>& inputs,
+                      const Variable& gradOutput) {
+    if (!backward) {
+      throw std::runtime_error(
+          "halideFunction - kernel for op " + op + " has no backward function");
+    }
+    std::vector<Tensor> backwardInputs;
+    backwardInputs.reserve(inputs.size() + 1);
+    for (const auto& input : inputs) {
+      backwardInputs.push_back(input.tensor());
+    }
+    backwardInputs.push_back(gradOutput.tensor());
+    auto grads = backward(backwardInputs);
+    if (grads.size() != inputs.size()) {
+      throw std::runtime_error(
+          "halideFunction - backward function of op " + op + " returned " +
+          std::to_string(grads.size()) + " gradients for " +
+          std::to_string(inputs.size()) + " inputs");
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      inputs[i].addGrad(Variable(grads[i], false));
+    }
+  };
+  // the backward function is given the inputs, so keep their data
+  return Variable(outputs[0], inputs, gradFunc);
+}
+
+std::vector<Tensor> runHalideKernel(
+    const std::string& op,
+    const std::vector<Tensor>& inputs) {
+  if (inputs.empty()) {
+    throw std::invalid_argument(
+        "runHalideKernel - op " + op + " has no inputs");
+  }
+  auto kernel = HalideKernelRegistry::getInstance().find(
+      op, inputs[0].type(), inputs[0].shape());
+  if (!kernel) {
+    throw std::invalid_argument(
+        "runHalideKernel - no kernel registered for op " + op + " on " +
+        dtypeToString(inputs[0].type()) + " inputs of shape " +
+        inputs[0].shape().toString());
+  }
+  return kernel->forward(inputs);
+}
+
+} // namespace halide
+} // namespace pkg
+} // namespace fl
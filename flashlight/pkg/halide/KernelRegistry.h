@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "flashlight/fl/autograd/Variable.h"
+#include "flashlight/fl/tensor/Shape.h"
+#include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/fl/tensor/Types.h"
+
+namespace fl {
+namespace pkg {
+namespace halide {
+
+/**
+ * A compiled Halide kernel, e.g. an AOT-generated pipeline wrapped to take and
+ * return Flashlight Tensors.
+ *
+ * `forward` computes the outputs from the inputs. `backward`, if any, is given
+ * the inputs followed by the gradient of the (first) output, and returns the
+ * gradients of the inputs; kernels without it can't be differentiated.
+ */
+struct HalideKernel {
+  using Fn = std::function<std::vector<Tensor>(const std::vector<Tensor>&)>;
+
+  Fn forward;
+  Fn backward;
+};
+
+/**
+ * Registry of compiled Halide kernels, looked up by op name and the type and
+ * shape of the first input, so that ops can dispatch to a fused kernel where
+ * one was compiled for their inputs and fall back to Flashlight ops elsewhere.
+ *
+ * Kernels are registered either for a given shape (e.g. pipelines compiled
+ * with constant extents) or for any shape; kernels for the exact shape are
+ * preferred.
+ *
+ * \code
+   HalideKernelRegistry::getInstance().registerKernel(
+       "swish", fl::dtype::f32, {swishForward, swishBackward});
+   // runs the kernel on f32 inputs, fl ops on others
+   auto out = halideFunction("swish", {x}, [](const auto& in) {
+     return in[0] * fl::sigmoid(in[0]);
+   });
+ * \endcode
+ */
+class HalideKernelRegistry {
+ public:
+  static HalideKernelRegistry& getInstance();
+
+  /**
+   * Registers a kernel for inputs of any shape. Replaces any kernel already
+   * registered for the same op and type.
+   */
+  void
+  registerKernel(const std::string& op, fl::dtype type, HalideKernel kernel);
+
+  /**
+   * Registers a kernel for inputs of a given shape. Replaces any kernel already
+   * registered for the same op, type and shape.
+   */
+  void registerKernel(
+      const std::string& op,
+      fl::dtype type,
+      const Shape& shape,
+      HalideKernel kernel);
+
+  /**
+   * The kernel for an op on inputs of the given type and shape, if any.
+   */
+  std::optional<HalideKernel>
+  find(const std::string& op, fl::dtype type, const Shape& shape) const;
+
+  /**
+   * Removes all kernels registered for an op.
+   */
+  void unregisterOp(const std::string& op);
+
+ private:
+  HalideKernelRegistry() = default;
+
+  mutable std::mutex mutex_;
+  // (op, type) -> kernel for any shape
+  std::map<std::tuple<std::string, fl::dtype>, HalideKernel> anyShape_;
+  // (op, type, shape) -> kernel for that shape
+  std::map<std::tuple<std::string, fl::dtype, std::vector<Dim>>, HalideKernel>
+      byShape_;
+};
+
+/**
+ * Applies an op to Variables with the kernel registered for the type and shape
+ * of the first input, or with `fallback` if there is none. The output is
+ * differentiable through the kernel's backward function (or through
+ * `fallback`'s own graph when falling back). Kernels returning several outputs
+ * only have their first one returned.
+ */
+Variable halideFunction(
+    const std::string& op,
+    const std::vector<Variable>& inputs,
+    const std::function<Variable(const std::vector<Variable>&)>& fallback);
+
+/**
+ * Runs the kernel registered for an op on the given inputs. Throws if there
+ * is none.
+ */
+std::vector<Tensor> runHalideKernel(
+    const std::string& op,
+    const std::vector<Tensor>& inputs);
+
+} // namespace halide
+} // namespace pkg
+} // namespace fl
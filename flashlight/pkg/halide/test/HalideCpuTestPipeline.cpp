@@ -0,0 +1,33 @@
+#include <iostream>
+
+#include "Halide.h"
+
+using namespace Halide;
+
+// A fused swish activation, x * sigmoid(x), over a flattened tensor
+int main(int argc, char** argv) {
+  Var x;
+  ImageParam input(Float(32), 1);
+
+  Func swishCpu;
+  swishCpu(x) = input(x) / (1.f + exp(-input(x)));
+
+  // Parallel over blocks of vectors, guarding the tail of inputs of any size
+  const Target target = get_host_target();
+  Var xOuter, xInner;
+  const int vectorSize = target.natural_vector_size<float>();
+  swishCpu.split(x, xOuter, xInner, 64 * vectorSize, TailStrategy::GuardWithIf)
+      .parallel(xOuter)
+      .vectorize(xInner, vectorSize, TailStrategy::GuardWithIf);
+
+  swishCpu.compile_to_static_library(
+      "HalideCpuTestPipeline",
+      {input}, // arguments
+      "swishCpu",
+      target);
+
+  std::cout << "HalideCpuTestPipeline pipeline compiled, but not yet run."
+            << std::endl;
+
+  return 0;
+}
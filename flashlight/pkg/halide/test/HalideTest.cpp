@@ -13,14 +13,40 @@
 #include "flashlight/fl/autograd/Functions.h"
 #include "flashlight/fl/autograd/Variable.h"
 #include "flashlight/fl/tensor/Index.h"
+#include "flashlight/fl/tensor/Init.h"
 #include "flashlight/fl/tensor/Random.h"
 #include "flashlight/pkg/halide/HalideInterface.h"
+#include "flashlight/pkg/halide/KernelRegistry.h"
 
 // Generated at build time -- see the accompanying CMakeList
+#include "HalideCpuTestPipeline.h"
+#if FL_HALIDE_USE_CUDA
 #include "HalideTestPipeline.h"
+#endif
 
 using namespace fl;
 
+namespace {
+
+bool defaultTensorsOnHost() {
+  return fl::rand({1}).location() == Location::Host;
+}
+
+// Runs the CPU-scheduled swish pipeline on a tensor of any shape
+Tensor swishCpuKernel(const Tensor& input) {
+  auto flatInput = fl::reshape(input, {static_cast<Dim>(input.elements())});
+  auto flatOutput = Tensor(flatInput.shape(), fl::dtype::f32);
+  {
+    auto inputHalide = pkg::halide::HalideBufferWrapper<float>(flatInput);
+    auto outputHalide = pkg::halide::HalideBufferWrapper<float>(flatOutput);
+    FL_HALIDE_CHECK(swishCpu(
+        inputHalide.getRuntimeBuffer(), outputHalide.getRuntimeBuffer()));
+  }
+  return fl::reshape(flatOutput, input.shape());
+}
+
+} // namespace
+
 TEST(HalideTest, TypeMapping) {
   Halide::Buffer<Halide::float16_t> halfBuf({1});
   EXPECT_EQ(
@@ -90,10 +116,12 @@ TEST(HalideTest, ConvertArray) {
     pkg::halide::HalideBufferWrapper<float> halideBufWrapper(arr);
     // Underlying memory should be the same
     DevicePtr arrPtr(arr);
+    auto* rawBuffer = halideBufWrapper.getBuffer().raw_buffer();
     EXPECT_EQ(
         arrPtr.get(),
-        reinterpret_cast<void*>(
-            halideBufWrapper.getBuffer().raw_buffer()->device));
+        arr.location() == Location::Host
+            ? reinterpret_cast<void*>(rawBuffer->host)
+            : reinterpret_cast<void*>(rawBuffer->device));
   }
   // The underlying Array should remain unchanged after the wrapper is destroyed
   EXPECT_TRUE(fl::allClose(arr, arrCopy));
@@ -119,6 +147,104 @@ TEST(HalideTest, RoundTripConvertArrayManual) {
   EXPECT_TRUE(fl::allClose(arr, out));
 }
 
+TEST(HalideTest, ConvertArrayChecks) {
+  auto arr = fl::rand({5, 4});
+  // wrong element type
+  EXPECT_THROW(
+      pkg::halide::HalideBufferWrapper<double> wrapper(arr),
+      std::invalid_argument);
+  // not contiguous
+  auto strided = arr(fl::range(0, 5, 2));
+  if (!strided.isContiguous()) {
+    EXPECT_THROW(
+        pkg::halide::HalideBufferWrapper<float> wrapper(strided),
+        std::invalid_argument);
+  }
+}
+
+TEST(HalideTest, CpuAOTCompiledHalidePipeline) {
+  if (!defaultTensorsOnHost()) {
+    GTEST_SKIP() << "CPU pipelines run on host tensors";
+  }
+  auto input = fl::rand({7, 33, 5}) * 10 - 5;
+  auto output = swishCpuKernel(input);
+  ASSERT_EQ(output.shape(), input.shape());
+  EXPECT_TRUE(fl::allClose(output, input * fl::sigmoid(input), 1e-5));
+  // the input is left untouched
+  EXPECT_TRUE(fl::allClose(input, input.copy()));
+}
+
+TEST(HalideTest, KernelRegistry) {
+  if (!defaultTensorsOnHost()) {
+    GTEST_SKIP() << "CPU pipelines run on host tensors";
+  }
+  auto& registry = pkg::halide::HalideKernelRegistry::getInstance();
+  int numForward = 0;
+  int numBackward = 0;
+  pkg::halide::HalideKernel swish{
+      [&numForward](const std::vector<Tensor>& in) {
+        ++numForward;
+        return std::vector<Tensor>{swishCpuKernel(in[0])};
+      },
+      [&numBackward](const std::vector<Tensor>& in) {
+        ++numBackward;
+        // in = {input, gradOutput}
+        auto sig = fl::sigmoid(in[0]);
+        return std::vector<Tensor>{in[1] * sig * (1 + in[0] * (1 - sig))};
+      }};
+  registry.registerKernel("testSwish", fl::dtype::f32, swish);
+  auto fallback = [](const std::vector<Variable>& in) {
+    return fl::swish(in[0], 1.0);
+  };
+
+  auto x = Variable(fl::rand({10, 6}) * 4 - 2, true);
+  auto out = pkg::halide::halideFunction("testSwish", {x}, fallback);
+  ASSERT_EQ(numForward, 1);
+  auto expected = fl::swish(Variable(x.tensor(), true), 1.0);
+  EXPECT_TRUE(fl::allClose(out.tensor(), expected.tensor(), 1e-5));
+
+  // gradients go through the kernel's backward function
+  out.backward();
+  ASSERT_EQ(numBackward, 1);
+  auto xRef = Variable(x.tensor(), true);
+  fl::swish(xRef, 1.0).backward();
+  EXPECT_TRUE(fl::allClose(x.grad().tensor(), xRef.grad().tensor(), 1e-5));
+
+  // no kernel for f64: fall back
+  auto x64 = Variable(fl::rand({10, 6}, fl::dtype::f64), false);
+  pkg::halide::halideFunction("testSwish", {x64}, fallback);
+  ASSERT_EQ(numForward, 1);
+  EXPECT_THROW(
+      pkg::halide::runHalideKernel("testSwish", {x64.tensor()}),
+      std::invalid_argument);
+
+  // kernels for an exact shape are preferred
+  int numExact = 0;
+  registry.registerKernel(
+      "testSwish",
+      fl::dtype::f32,
+      Shape({3, 3}),
+      {[&numExact](const std::vector<Tensor>& in) {
+         ++numExact;
+         return std::vector<Tensor>{swishCpuKernel(in[0])};
+       },
+       nullptr});
+  pkg::halide::runHalideKernel("testSwish", {fl::rand({3, 3})});
+  pkg::halide::runHalideKernel("testSwish", {fl::rand({3, 4})});
+  ASSERT_EQ(numExact, 1);
+  ASSERT_EQ(numForward, 2);
+  // kernels without a backward function can't be differentiated
+  auto y = Variable(fl::rand({3, 3}), true);
+  EXPECT_THROW(
+      pkg::halide::halideFunction("testSwish", {y}, fallback).backward(),
+      std::runtime_error);
+
+  registry.unregisterOp("testSwish");
+  EXPECT_FALSE(
+      registry.find("testSwish", fl::dtype::f32, Shape({3, 3})).has_value());
+}
+
+#if FL_HALIDE_USE_CUDA
 TEST(HalideTest, SimpleAOTCompiledHalidePipeline) {
   int yDim = 240, xDim = 240;
   int offset = 5;
@@ -147,6 +273,7 @@ TEST(HalideTest, SimpleAOTCompiledHalidePipeline) {
   // Ensure the output buffer is correctly-modified
   EXPECT_TRUE(fl::allClose(expected, output));
 }
+#endif
 
 TEST(HalideTest, SimpleJITHalidePipeline) {
   // Make sure we can call the Halide JIT inline in flashlight
@@ -161,5 +288,6 @@ TEST(HalideTest, SimpleJITHalidePipeline) {
 
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
   return RUN_ALL_TESTS();
 }
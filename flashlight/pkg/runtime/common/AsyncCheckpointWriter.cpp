@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/runtime/common/AsyncCheckpointWriter.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "flashlight/fl/common/Logging.h"
+#include "flashlight/fl/common/Utils.h"
+
+namespace fl {
+namespace pkg {
+namespace runtime {
+
+namespace {
+
+void throwSystemError(const std::string& what, const fs::path& path) {
+  throw std::runtime_error(
+      what + " failed for " + path.string() + ": " + std::strerror(errno));
+}
+
+// Best effort: persist a rename by syncing the directory entry.
+void fsyncDirectory(const fs::path& dir) {
+  int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return;
+  }
+  ::fsync(fd);
+  ::close(fd);
+}
+
+} // namespace
+
+AsyncCheckpointWriter::AsyncCheckpointWriter() = default;
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() {
+  try {
+    wait();
+  } catch (const std::exception& ex) {
+    FL_LOG(fl::LogLevel::ERROR)
+        << "AsyncCheckpointWriter: pending checkpoint failed: " << ex.what();
+  }
+}
+
+void AsyncCheckpointWriter::wait() {
+  if (pending_.valid()) {
+    // get() invalidates the future and rethrows any exception
+    pending_.get();
+  }
+}
+
+bool AsyncCheckpointWriter::busy() const {
+  return pending_.valid() &&
+      pending_.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+std::chrono::duration<double> AsyncCheckpointWriter::lastStall() const {
+  return lastStall_;
+}
+
+std::chrono::duration<double> AsyncCheckpointWriter::totalStall() const {
+  return totalStall_;
+}
+
+int64_t AsyncCheckpointWriter::numCheckpoints() const {
+  return numCheckpoints_;
+}
+
+void AsyncCheckpointWriter::writeAtomic(
+    const fs::path& filepath,
+    const std::string& data) {
+  fs::path tmpPath = filepath;
+  tmpPath += ".tmp";
+
+  int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throwSystemError("open", tmpPath);
+  }
+  const char* ptr = data.data();
+  size_t remaining = data.size();
+  while (remaining > 0) {
+    ssize_t written = ::write(fd, ptr, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ::close(fd);
+      throwSystemError("write", tmpPath);
+    }
+    ptr += written;
+    remaining -= written;
+  }
+  if (::fsync(fd) != 0) {
+    ::close(fd);
+    throwSystemError("fsync", tmpPath);
+  }
+  if (::close(fd) != 0) {
+    throwSystemError("close", tmpPath);
+  }
+  fs::rename(tmpPath, filepath);
+  fsyncDirectory(filepath.parent_path());
+}
+
+void AsyncCheckpointWriter::enqueue(
+    const std::vector<fs::path>& filepaths,
+    std::string&& data) {
+  auto payload = std::make_shared<std::string>(std::move(data));
+  pending_ = writerThread_.enqueue([targets = filepaths, payload]() {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& target : targets) {
+      try {
+        fl::retryWithBackoff(
+            std::chrono::seconds(1),
+            2.0,
+            6,
+            &AsyncCheckpointWriter::writeAtomic,
+            target,
+            *payload); // max wait 31s
+      } catch (const std::exception& ex) {
+        FL_LOG(fl::LogLevel::ERROR) << "Error while saving \"" << target
+                                    << "\": " << ex.what() << "\n";
+        throw;
+      }
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    FL_VLOG(1) << "AsyncCheckpointWriter: wrote " << payload->size()
+               << " bytes to " << targets.size() << " file(s) in "
+               << elapsed.count() << "s";
+  });
+}
+
+void AsyncCheckpointWriter::recordStall(std::chrono::duration<double> stall) {
+  lastStall_ = stall;
+  totalStall_ += stall;
+  ++numCheckpoints_;
+}
+
+} // namespace runtime
+} // namespace pkg
+} // namespace fl
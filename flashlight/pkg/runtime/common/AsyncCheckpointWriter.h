@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/common/threadpool/ThreadPool.h"
+#include "flashlight/fl/flashlight.h"
+
+namespace fl {
+namespace pkg {
+namespace runtime {
+namespace detail {
+
+/**
+ * A stream buffer appending to a string that can be moved out, so that a
+ * serialized checkpoint isn't copied (as `std::ostringstream::str()` would).
+ */
+class StringSink : public std::streambuf {
+ public:
+  std::string release() {
+    return std::move(data_);
+  }
+
+ protected:
+  int_type overflow(int_type ch) override {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      data_.push_back(traits_type::to_char_type(ch));
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    data_.append(s, n);
+    return n;
+  }
+
+ private:
+  std::string data_;
+};
+
+} // namespace detail
+
+/**
+ * Writes checkpoints without blocking the training loop on disk I/O.
+ *
+ * A call to `save` serializes its arguments with cereal into a host memory
+ * buffer on the calling thread; serialization is synchronous and only the
+ * disk write is not. The buffer is handed to the writer without a copy, so
+ * peak host memory is one serialized snapshot. Tensors are copied to host as
+ * part of this step, so the buffer is a private snapshot and the caller is
+ * free to keep updating parameters and optimizer state as soon as `save`
+ * returns. Writing the buffer to disk happens on a background thread: data is
+ * written to a temporary file next to the destination, `fsync`ed, then
+ * atomically renamed over the destination so readers never observe a partial
+ * checkpoint.
+ *
+ * At most one checkpoint is in flight; a `save` issued while a previous one is
+ * still being written first waits for it, which bounds host memory usage to a
+ * single snapshot. Errors raised by the background write are rethrown from the
+ * next call to `save` or `wait`.
+ *
+ * Checkpoints written with `save` can be read back with `Serializer::load`.
+ *
+ * Example:
+ * \code
+ *   AsyncCheckpointWriter writer;
+ *   auto stall = writer.save("model.bin", version, network, optimizer);
+ *   // ... keep training ...
+ *   writer.wait(); // before exiting
+ * \endcode
+ */
+class AsyncCheckpointWriter {
+ public:
+  AsyncCheckpointWriter();
+
+  /**
+   * Blocks until the in-flight checkpoint (if any) is on disk. Errors are
+   * logged rather than thrown.
+   */
+  ~AsyncCheckpointWriter();
+
+  AsyncCheckpointWriter(const AsyncCheckpointWriter&) = delete;
+  AsyncCheckpointWriter& operator=(const AsyncCheckpointWriter&) = delete;
+
+  /**
+   * Snapshot the given objects and write them asynchronously to each of
+   * `filepaths`. The snapshot is serialized once and shared by all
+   * destinations.
+   *
+   * @return the time the caller was blocked, which includes waiting for the
+   * previous checkpoint and taking the host snapshot.
+   */
+  template <class... Args>
+  std::chrono::duration<double> save(
+      const std::vector<fs::path>& filepaths,
+      const std::string& version,
+      const Args&... args) {
+    auto start = std::chrono::steady_clock::now();
+    wait();
+    detail::StringSink sink;
+    {
+      std::ostream buffer(&sink);
+      cereal::BinaryOutputArchive ar(buffer);
+      ar(version);
+      ar(args...);
+    }
+    enqueue(filepaths, sink.release());
+    std::chrono::duration<double> stall =
+        std::chrono::steady_clock::now() - start;
+    recordStall(stall);
+    return stall;
+  }
+
+  template <class... Args>
+  std::chrono::duration<double> save(
+      const fs::path& filepath,
+      const std::string& version,
+      const Args&... args) {
+    return save(std::vector<fs::path>{filepath}, version, args...);
+  }
+
+  /**
+   * Block until the in-flight checkpoint (if any) has been written, and
+   * rethrow any error it raised.
+   */
+  void wait();
+
+  /**
+   * @return true if a checkpoint is still being written.
+   */
+  bool busy() const;
+
+  /**
+   * @return the stall time of the most recent call to `save`.
+   */
+  std::chrono::duration<double> lastStall() const;
+
+  /**
+   * @return the accumulated stall time across all calls to `save`.
+   */
+  std::chrono::duration<double> totalStall() const;
+
+  /**
+   * @return the number of checkpoints taken so far.
+   */
+  int64_t numCheckpoints() const;
+
+  /**
+   * Write `data` to a temporary file beside `filepath`, flush it to stable
+   * storage and atomically rename it to `filepath`.
+   */
+  static void writeAtomic(const fs::path& filepath, const std::string& data);
+
+ private:
+  void enqueue(const std::vector<fs::path>& filepaths, std::string&& data);
+  void recordStall(std::chrono::duration<double> stall);
+
+  // Single worker so that checkpoints land on disk in order
+  ThreadPool writerThread_{1};
+  std::future<void> pending_;
+  std::chrono::duration<double> lastStall_{0};
+  std::chrono::duration<double> totalStall_{0};
+  int64_t numCheckpoints_{0};
+};
+
+} // namespace runtime
+} // namespace pkg
+} // namespace fl
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/fl/tensor/Random.h"
+#include "flashlight/pkg/runtime/common/AsyncCheckpointWriter.h"
+#include "flashlight/pkg/runtime/common/Serializer.h"
+
+using namespace fl;
+using namespace fl::pkg::runtime;
+
+TEST(AsyncCheckpointWriterTest, SaveAndLoad) {
+  const fs::path path = fs::temp_directory_path() / "async_ckpt_test.bin";
+  const fs::path copyPath =
+      fs::temp_directory_path() / "async_ckpt_test_copy.bin";
+
+  auto model = std::make_shared<Linear>(4, 3);
+  auto expectedWeight = model->param(0).tensor().copy();
+
+  AsyncCheckpointWriter writer;
+  auto stall = writer.save({path, copyPath}, "1", model, 42);
+  ASSERT_GE(stall.count(), 0.);
+  // Mutating the model after save returns must not affect the checkpoint
+  model->param(0).tensor() += 1;
+  writer.wait();
+  ASSERT_FALSE(writer.busy());
+  ASSERT_EQ(writer.numCheckpoints(), 1);
+  ASSERT_FALSE(fs::exists(fs::path(path.string() + ".tmp")));
+
+  for (const auto& p : {path, copyPath}) {
+    std::string version;
+    std::shared_ptr<Linear> loaded;
+    int value = 0;
+    Serializer::load(p, version, loaded, value);
+    ASSERT_EQ(version, "1");
+    ASSERT_EQ(value, 42);
+    ASSERT_TRUE(allClose(loaded->param(0).tensor(), expectedWeight));
+    fs::remove(p);
+  }
+}
+
+TEST(AsyncCheckpointWriterTest, ConsecutiveSaves) {
+  const fs::path path = fs::temp_directory_path() / "async_ckpt_consec.bin";
+  AsyncCheckpointWriter writer;
+  for (int i = 0; i < 3; ++i) {
+    writer.save(path, "1", fl::full({16, 16}, i));
+  }
+  writer.wait();
+  ASSERT_EQ(writer.numCheckpoints(), 3);
+  ASSERT_GE(writer.totalStall().count(), writer.lastStall().count());
+
+  std::string version;
+  Tensor loaded;
+  Serializer::load(path, version, loaded);
+  ASSERT_TRUE(allClose(loaded, fl::full({16, 16}, 2)));
+  fs::remove(path);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
@@ -23,12 +23,7 @@ Mfcc::Mfcc(const FeatureParams& params)
   validateMfccParams();
 }
 
-std::vector<float> Mfcc::apply(const std::vector<float>& input) {
-  auto frames = frameSignal(input, this->featParams_);
-  if (frames.empty()) {
-    return {};
-  }
-
+std::vector<float> Mfcc::frameFeatures(std::vector<float>& frames) {
   int nSamples = this->featParams_.numFrameSizeSamples();
   int nFrames = frames.size() / nSamples;
 
@@ -58,7 +53,11 @@ std::vector<float> Mfcc::apply(const std::vector<float>& input) {
       cep[f * nFeat] = energy[f];
     }
   }
-  return derivatives_.apply(cep, nFeat);
+  return cep;
+}
+
+std::vector<float> Mfcc::signalFeatures(std::vector<float>& frameFeat) {
+  return derivatives_.apply(frameFeat, this->featParams_.numCepstralCoeffs);
 }
 
 int Mfcc::outputSize(int inputSz) {
@@ -57,12 +57,14 @@ class Mfcc : public Mfsc {
 
   virtual ~Mfcc() override {}
 
-  // input - input speech signal (T)
-  // Returns - MFCC features (Col Major : FEAT X FRAMESZ)
-  std::vector<float> apply(const std::vector<float>& input) override;
-
   int outputSize(int inputSz) override;
 
+ protected:
+  // Returns - MFCC features (Col Major : FEAT X FRAMESZ) without derivatives
+  std::vector<float> frameFeatures(std::vector<float>& frames) override;
+
+  std::vector<float> signalFeatures(std::vector<float>& frameFeat) override;
+
  private:
   // The following classes are defined in the order they are applied
   Dct dct_;
@@ -30,12 +30,7 @@ Mfsc::Mfsc(const FeatureParams& params)
   validateMfscParams();
 }
 
-std::vector<float> Mfsc::apply(const std::vector<float>& input) {
-  auto frames = frameSignal(input, this->featParams_);
-  if (frames.empty()) {
-    return {};
-  }
-
+std::vector<float> Mfsc::frameFeatures(std::vector<float>& frames) {
   int nSamples = this->featParams_.numFrameSizeSamples();
   int nFrames = frames.size() / nSamples;
 
@@ -71,10 +66,15 @@ std::vector<float> Mfsc::apply(const std::vector<float>& input) {
           newMfscFeat.data() + start + f + 1);
     }
     std::swap(mfscFeat, newMfscFeat);
-    ++numFeat;
   }
+  return mfscFeat;
+}
+
+std::vector<float> Mfsc::signalFeatures(std::vector<float>& frameFeat) {
+  auto numFeat = this->featParams_.numFilterbankChans +
+      (this->featParams_.useEnergy ? 1 : 0);
   // Derivatives will not be computed if windowsize < 0
-  return derivatives_.apply(mfscFeat, numFeat);
+  return derivatives_.apply(frameFeat, numFeat);
 }
 
 std::vector<float> Mfsc::mfscImpl(std::vector<float>& frames) {
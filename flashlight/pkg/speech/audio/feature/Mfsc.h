@@ -25,13 +25,14 @@ class Mfsc : public PowerSpectrum {
 
   virtual ~Mfsc() override {}
 
-  // input - input speech signal (T)
-  // Returns - MFSC feature (Col Major : FEAT X FRAMESZ)
-  std::vector<float> apply(const std::vector<float>& input) override;
-
   int outputSize(int inputSz) override;
 
  protected:
+  // Returns - MFSC feature (Col Major : FEAT X FRAMESZ) without derivatives
+  std::vector<float> frameFeatures(std::vector<float>& frames) override;
+
+  std::vector<float> signalFeatures(std::vector<float>& frameFeat) override;
+
   // Helper function which takes input as signal after dividing the signal into
   // frames. Main purpose of this function is to reuse it in MFCC code
   std::vector<float> mfscImpl(std::vector<float>& frames);
@@ -11,7 +11,9 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <numeric>
 #include <unordered_map>
+#include <utility>
 
 #include "flashlight/pkg/speech/audio/feature/SpeechUtils.h"
 
@@ -19,6 +21,14 @@ namespace fl {
 namespace lib {
 namespace audio {
 
+namespace {
+
+// Frames featurized at once: small enough for a block of frames to stay in
+// cache, large enough to amortize the per-block overhead
+constexpr int64_t kFramesPerBlock = 64;
+
+} // namespace
+
 std::mutex PowerSpectrum::fftPlanMutex_;
 
 PowerSpectrum::PowerSpectrum(const FeatureParams& params)
@@ -40,13 +50,36 @@ PowerSpectrum::PowerSpectrum(const FeatureParams& params)
 }
 
 std::vector<float> PowerSpectrum::apply(const std::vector<float>& input) {
-  auto frames = frameSignal(input, featParams_);
-  if (frames.empty()) {
+  return apply(input.data(), input.size());
+}
+
+std::vector<float> PowerSpectrum::apply(const float* input, int64_t inputSz) {
+  const int64_t nFrames = featParams_.numFrames(inputSz);
+  if (nFrames == 0) {
     return {};
   }
+  std::vector<float> frameFeat;
+  for (int64_t f = 0; f < nFrames; f += kFramesPerBlock) {
+    auto frames = frameSignal(
+        input, f, std::min(kFramesPerBlock, nFrames - f), featParams_);
+    auto blockFeat = frameFeatures(frames);
+    if (f == 0) {
+      frameFeat.reserve(blockFeat.size() * (nFrames / kFramesPerBlock + 1));
+    }
+    frameFeat.insert(frameFeat.end(), blockFeat.begin(), blockFeat.end());
+  }
+  return signalFeatures(frameFeat);
+}
+
+std::vector<float> PowerSpectrum::frameFeatures(std::vector<float>& frames) {
   return powSpectrumImpl(frames);
 }
 
+std::vector<float> PowerSpectrum::signalFeatures(
+    std::vector<float>& frameFeat) {
+  return std::move(frameFeat);
+}
+
 std::vector<float> PowerSpectrum::powSpectrumImpl(std::vector<float>& frames) {
   int nSamples = featParams_.numFrameSizeSamples();
   int nFrames = frames.size() / nSamples;
@@ -97,21 +130,26 @@ std::vector<float> PowerSpectrum::powSpectrumImpl(std::vector<float>& frames) {
 std::vector<float> PowerSpectrum::batchApply(
     const std::vector<float>& input,
     int batchSz) {
+  return batchApply(input.data(), input.size(), batchSz);
+}
+
+std::vector<float> PowerSpectrum::batchApply(
+    const float* input,
+    int64_t inputSz,
+    int batchSz) {
   if (batchSz <= 0) {
     throw std::invalid_argument("PowerSpectrum: negative batchSz");
-  } else if (input.size() % batchSz != 0) {
+  } else if (inputSz % batchSz != 0) {
     throw std::invalid_argument(
         "PowerSpectrum: input size is not divisible by batchSz");
   }
-  int N = input.size() / batchSz;
+  int N = inputSz / batchSz;
   int outputSz = outputSize(N);
   std::vector<float> feat(outputSz * batchSz);
 
 #pragma omp parallel for num_threads(batchSz)
   for (int b = 0; b < batchSz; ++b) {
-    auto start = input.begin() + b * N;
-    std::vector<float> inputBuf(start, start + N);
-    auto curFeat = apply(inputBuf);
+    auto curFeat = apply(input + b * N, N);
     if (outputSz != curFeat.size()) {
       throw std::logic_error("PowerSpectrum: apply() returned wrong size");
     }
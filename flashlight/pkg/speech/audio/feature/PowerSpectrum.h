@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "flashlight/pkg/speech/audio/feature/Dither.h"
 #include "flashlight/pkg/speech/audio/feature/FeatureParams.h"
@@ -33,16 +35,31 @@ class PowerSpectrum {
 
   // input - input speech signal (T)
   // Returns - Power spectrum (Col Major : FEAT X FRAMESZ)
-  virtual std::vector<float> apply(const std::vector<float>& input);
+  std::vector<float> apply(const std::vector<float>& input);
+
+  // input - input speech signal of inputSz samples (T), e.g. decoded audio
+  // which isn't held by a vector. The signal is framed and featurized in
+  // blocks of frames, so its frames are never all held in memory at once.
+  // Returns - Output features (Col Major : FEAT X FRAMESZ)
+  std::vector<float> apply(const float* input, int64_t inputSz);
 
   // input - input speech signal (Col Major : T X BATCHSZ)
   // Returns - Output features (Col Major : FEAT X FRAMESZ X BATCHSZ)
   std::vector<float> batchApply(const std::vector<float>& input, int batchSz);
 
+  std::vector<float>
+  batchApply(const float* input, int64_t inputSz, int batchSz);
+
   virtual int outputSize(int inputSz);
 
   FeatureParams getFeatureParams() const;
 
+  // The fftw planner isn't thread-safe: every plan of the process must be
+  // created while holding this mutex
+  static std::mutex& fftPlanMutex() {
+    return fftPlanMutex_;
+  }
+
  protected:
   FeatureParams featParams_;
 
@@ -50,6 +67,14 @@ class PowerSpectrum {
   // frames. Main purpose of this function is to reuse it in MFSC, MFCC code
   std::vector<float> powSpectrumImpl(std::vector<float>& frames);
 
+  // Features of a block of consecutive frames (Col Major : FEAT X NFRAMES).
+  // The frames may be modified.
+  virtual std::vector<float> frameFeatures(std::vector<float>& frames);
+
+  // Features of the signal from the features of all its frames, for features
+  // spanning several frames (e.g. derivatives)
+  virtual std::vector<float> signalFeatures(std::vector<float>& frameFeat);
+
   void validatePowSpecParams() const;
 
  private:
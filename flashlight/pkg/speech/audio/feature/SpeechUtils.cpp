@@ -26,16 +26,24 @@ namespace audio {
 std::vector<float> frameSignal(
     const std::vector<float>& input,
     const FeatureParams& params) {
+  return frameSignal(input.data(), 0, params.numFrames(input.size()), params);
+}
+
+std::vector<float> frameSignal(
+    const float* input,
+    int64_t firstFrame,
+    int64_t numFrames,
+    const FeatureParams& params) {
   auto frameSize = params.numFrameSizeSamples();
   auto frameStride = params.numFrameStrideSamples();
-  int numframes = params.numFrames(input.size());
   // HTK: Values coming out of rasta treat samples as integers,
   // not range -1..1, hence scale up here to match (approx)
   float scale = 32768.0;
-  std::vector<float> frames(numframes * frameSize);
-  for (size_t f = 0; f < numframes; ++f) {
+  std::vector<float> frames(numFrames * frameSize);
+  for (size_t f = 0; f < numFrames; ++f) {
+    auto begin = input + (firstFrame + f) * frameStride;
     for (size_t i = 0; i < frameSize; ++i) {
-      frames[f * frameSize + i] = scale * input[f * frameStride + i];
+      frames[f * frameSize + i] = scale * begin[i];
     }
   }
   return frames;
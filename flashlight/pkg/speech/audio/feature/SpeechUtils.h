@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "flashlight/pkg/speech/audio/feature/FeatureParams.h"
@@ -21,6 +22,15 @@ std::vector<float> frameSignal(
     const std::vector<float>& input,
     const FeatureParams& params);
 
+// Convert frames [firstFrame, firstFrame + numFrames) of the speech signal
+// into frames
+
+std::vector<float> frameSignal(
+    const float* input,
+    int64_t firstFrame,
+    int64_t numFrames,
+    const FeatureParams& params);
+
 // row major;  matA - m x k , matB - k x n
 
 std::vector<float> cblasGemm(
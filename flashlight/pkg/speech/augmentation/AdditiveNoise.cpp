@@ -11,10 +11,10 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <utility>
 
 #include "flashlight/fl/common/Logging.h"
 #include "flashlight/pkg/speech/augmentation/SoundEffectUtil.h"
-#include "flashlight/pkg/speech/data/Sound.h"
 
 namespace fl {
 namespace pkg {
@@ -37,8 +37,11 @@ std::string AdditiveNoise::prettyString() const {
 
 AdditiveNoise::AdditiveNoise(
     const AdditiveNoise::Config& config,
-    unsigned int seed /* = 0 */)
-    : conf_(config), rng_(seed) {
+    unsigned int seed /* = 0 */,
+    std::shared_ptr<SoundBank> soundBank /* = nullptr */)
+    : conf_(config),
+      soundBank_(soundBank ? std::move(soundBank) : SoundBank::global()),
+      rng_(seed) {
   std::ifstream listFile(conf_.listFilePath_);
   if (!listFile) {
     throw std::runtime_error(
@@ -76,11 +79,11 @@ void AdditiveNoise::apply(std::vector<float>& signal) {
   std::vector<float> mixedNoise(signal.size(), 0.0f);
   for (int i = 0; i < nClips; ++i) {
     auto curNoiseFileIdx = rng_.randInt(0, noiseFiles_.size() - 1);
-    auto curNoise = loadSound<float>(noiseFiles_[curNoiseFileIdx]);
-    int shift = rng_.randInt(0, curNoise.size() - 1);
+    auto curNoise = soundBank_->get(noiseFiles_[curNoiseFileIdx]);
+    int shift = rng_.randInt(0, curNoise->size() - 1);
     for (int j = augStart; j < augEnd; ++j) {
       mixedNoise[j % mixedNoise.size()] +=
-          curNoise[(shift + j) % curNoise.size()];
+          (*curNoise)[(shift + j) % curNoise->size()];
     }
   }
 
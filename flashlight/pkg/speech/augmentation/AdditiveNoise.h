@@ -9,10 +9,12 @@
 
 #include "flashlight/pkg/speech/augmentation/SoundEffect.h"
 
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
 
+#include "flashlight/pkg/speech/augmentation/SoundBank.h"
 #include "flashlight/pkg/speech/augmentation/SoundEffectUtil.h"
 
 namespace fl {
@@ -35,6 +37,8 @@ namespace sfx {
  * rms(signal)/rms(noise) / snrDB. rms(signal) is calculated only on the
  * augmented interval. rms(noise) is calculated on the sum of all noise clipse
  * over the augmented interval.
+ * Noise files are decoded once and kept in the `SoundBank` shared by all the
+ * sound effects of the process.
  */
 class AdditiveNoise : public SoundEffect {
  public:
@@ -52,9 +56,13 @@ class AdditiveNoise : public SoundEffect {
     std::string prettyString() const;
   };
 
+  /**
+   * Noise files are read from `soundBank`, `SoundBank::global()` if null.
+   */
   explicit AdditiveNoise(
       const AdditiveNoise::Config& config,
-      unsigned int seed = 0);
+      unsigned int seed = 0,
+      std::shared_ptr<SoundBank> soundBank = nullptr);
   ~AdditiveNoise() override = default;
   void apply(std::vector<float>& signal) override;
   std::string prettyString() const override;
@@ -62,6 +70,7 @@ class AdditiveNoise : public SoundEffect {
  private:
   const AdditiveNoise::Config conf_;
   std::vector<std::string> noiseFiles_;
+  std::shared_ptr<SoundBank> soundBank_;
   RandomNumberGenerator rng_;
 };
 
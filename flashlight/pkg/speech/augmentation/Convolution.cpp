@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/speech/augmentation/Convolution.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#include <fftw3.h>
+
+#include "flashlight/pkg/speech/audio/feature/PowerSpectrum.h"
+
+namespace fl {
+namespace pkg {
+namespace speech {
+namespace sfx {
+
+namespace {
+
+constexpr size_t kMinFftSize = 1024;
+
+// Buffer with the alignment fftw plans expect
+template <typename T>
+class FftwBuffer {
+ public:
+  explicit FftwBuffer(size_t size)
+      : data_(static_cast<T*>(fftw_malloc(sizeof(T) * size))) {
+    if (!data_) {
+      throw std::bad_alloc();
+    }
+  }
+  ~FftwBuffer() {
+    fftw_free(data_);
+  }
+  FftwBuffer(const FftwBuffer&) = delete;
+  FftwBuffer& operator=(const FftwBuffer&) = delete;
+
+  T* get() {
+    return data_;
+  }
+
+ private:
+  T* data_;
+};
+
+struct FftPlans {
+  fftw_plan forward;
+  fftw_plan backward;
+};
+
+// Plans are created once per FFT size and kept for the life of the process.
+// Executing a plan on new arrays is thread-safe.
+const FftPlans& getPlans(size_t fftSize) {
+  static std::unordered_map<size_t, FftPlans> plans;
+  std::lock_guard<std::mutex> lock(
+      fl::lib::audio::PowerSpectrum::fftPlanMutex());
+  auto it = plans.find(fftSize);
+  if (it == plans.end()) {
+    FftwBuffer<double> real(fftSize);
+    FftwBuffer<fftw_complex> complex(fftSize / 2 + 1);
+    FftPlans fftPlans;
+    fftPlans.forward = fftw_plan_dft_r2c_1d(
+        fftSize, real.get(), complex.get(), FFTW_ESTIMATE);
+    fftPlans.backward = fftw_plan_dft_c2r_1d(
+        fftSize, complex.get(), real.get(), FFTW_ESTIMATE);
+    it = plans.emplace(fftSize, fftPlans).first;
+  }
+  return it->second;
+}
+
+size_t nextPowerOfTwo(size_t n) {
+  size_t result = 1;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+
+} // namespace
+
+std::vector<float> fftConvolve(
+    const std::vector<float>& signal,
+    const std::vector<float>& kernel,
+    size_t blockSize /* = 0 */) {
+  const size_t signalSize = signal.size();
+  std::vector<float> output(signalSize, 0);
+  // kernel samples past the signal length don't contribute to the output
+  const size_t kernelSize = std::min(kernel.size(), signalSize);
+  if (kernelSize == 0) {
+    return output;
+  }
+
+  size_t fftSize;
+  if (blockSize > 0) {
+    fftSize = nextPowerOfTwo(blockSize + kernelSize - 1);
+  } else {
+    fftSize = std::max(kMinFftSize, nextPowerOfTwo(2 * kernelSize));
+    fftSize = std::min(fftSize, nextPowerOfTwo(signalSize + kernelSize - 1));
+  }
+  blockSize = fftSize - kernelSize + 1;
+  const size_t nBins = fftSize / 2 + 1;
+  const auto& plans = getPlans(fftSize);
+
+  FftwBuffer<double> real(fftSize);
+  FftwBuffer<fftw_complex> kernelSpectrum(nBins);
+  FftwBuffer<fftw_complex> spectrum(nBins);
+
+  std::fill(real.get(), real.get() + fftSize, 0.0);
+  std::copy(kernel.begin(), kernel.begin() + kernelSize, real.get());
+  fftw_execute_dft_r2c(plans.forward, real.get(), kernelSpectrum.get());
+
+  for (size_t start = 0; start < signalSize; start += blockSize) {
+    const size_t n = std::min(blockSize, signalSize - start);
+    std::copy(signal.begin() + start, signal.begin() + start + n, real.get());
+    std::fill(real.get() + n, real.get() + fftSize, 0.0);
+    fftw_execute_dft_r2c(plans.forward, real.get(), spectrum.get());
+    for (size_t k = 0; k < nBins; ++k) {
+      const double re = spectrum.get()[k][0] * kernelSpectrum.get()[k][0] -
+          spectrum.get()[k][1] * kernelSpectrum.get()[k][1];
+      const double im = spectrum.get()[k][0] * kernelSpectrum.get()[k][1] +
+          spectrum.get()[k][1] * kernelSpectrum.get()[k][0];
+      spectrum.get()[k][0] = re;
+      spectrum.get()[k][1] = im;
+    }
+    fftw_execute_dft_c2r(plans.backward, spectrum.get(), real.get());
+    // fftw transforms are unnormalized
+    const size_t end = std::min(start + n + kernelSize - 1, signalSize);
+    for (size_t i = start; i < end; ++i) {
+      output[i] += real.get()[i - start] / fftSize;
+    }
+  }
+  return output;
+}
+
+} // namespace sfx
+} // namespace speech
+} // namespace pkg
+} // namespace fl
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace fl {
+namespace pkg {
+namespace speech {
+namespace sfx {
+
+/**
+ * Returns the first `signal.size()` samples of the convolution of `signal`
+ * with `kernel` (e.g. a room impulse response), computed with FFT overlap-add:
+ * the signal is cut into blocks which are convolved in the frequency domain
+ * and summed back with overlaps. Costs O(N log K) instead of the O(N K) of the
+ * time domain.
+ *
+ * `blockSize` is the number of signal samples per block, 0 picks it from the
+ * kernel size.
+ */
+std::vector<float> fftConvolve(
+    const std::vector<float>& signal,
+    const std::vector<float>& kernel,
+    size_t blockSize = 0);
+
+} // namespace sfx
+} // namespace speech
+} // namespace pkg
+} // namespace fl
@@ -10,6 +10,9 @@
 #include <algorithm>
 #include <cmath>
 #include <sstream>
+#include <utility>
+
+#include "flashlight/pkg/speech/augmentation/Convolution.h"
 
 namespace fl {
 namespace pkg {
@@ -26,16 +29,12 @@ void ReverbEcho::applyReverb(
     float initial,
     float firstDelay,
     float rt60) {
-  size_t length = source.size();
-  std::vector<float> reverb(length, 0);
+  const size_t length = source.size();
+  // The echo trains form a sparse impulse response with a tap per echo
+  std::vector<std::pair<size_t, float>> taps;
+  size_t minDelay = length, maxDelay = 0;
   for (int i = 0; i < conf_.repeat_; ++i) {
     float frac = 1;
-    // echo = initial * source
-    std::vector<float> echo = source;
-    std::transform(
-        echo.begin(), echo.end(), echo.begin(), [initial](float x) -> float {
-          return x * initial;
-        });
     while (frac > 1e-3) {
       // Add jitter noise for the delay
       float jitter = 1 + rng_.uniform(-conf_.jitter_, conf_.jitter_);
@@ -43,9 +42,9 @@ void ReverbEcho::applyReverb(
       if (delay > length - 1) {
         break;
       }
-      for (int j = 0; j < length - delay - 1; ++j) {
-        reverb[delay + j] += echo[j] * frac;
-      }
+      taps.emplace_back(delay, initial * frac);
+      minDelay = std::min(minDelay, delay);
+      maxDelay = std::max(maxDelay, delay);
 
       // Add jitter noise for the attenuation
       jitter = 1 + rng_.uniform(-conf_.jitter_, conf_.jitter_);
@@ -54,7 +53,27 @@ void ReverbEcho::applyReverb(
       frac *= attenuation;
     }
   }
-  for (int i = 0; i < length; ++i) {
+  if (taps.empty()) {
+    return;
+  }
+
+  std::vector<float> reverb;
+  if (taps.size() <= kMaxTimeDomainTaps) {
+    reverb.assign(length, 0);
+    for (const auto& tap : taps) {
+      for (size_t j = tap.first; j + 1 < length; ++j) {
+        reverb[j] += source[j - tap.first] * tap.second;
+      }
+    }
+  } else {
+    std::vector<float> impulseResponse(maxDelay + 1, 0);
+    for (const auto& tap : taps) {
+      impulseResponse[tap.first] += tap.second;
+    }
+    reverb = fftConvolve(source, impulseResponse);
+  }
+  // samples before the first echo and the last sample are left dry, exactly
+  for (size_t i = minDelay; i + 1 < length; ++i) {
     source[i] += reverb[i];
   }
 }
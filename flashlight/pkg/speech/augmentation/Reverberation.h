@@ -25,6 +25,9 @@ namespace sfx {
  * absorption coefficient, room size, and jitter.
  * This a c++ port of:
  * https://github.com/facebookresearch/denoiser/blob/master/denoiser/augment.py
+ *
+ * The echoes are gathered into an impulse response which is applied in the
+ * time domain when it has few echoes, and with FFT convolution otherwise.
  */
 class ReverbEcho : public SoundEffect {
  public:
@@ -84,6 +87,9 @@ class ReverbEcho : public SoundEffect {
   std::string prettyString() const override;
 
  private:
+  // Above this number of echoes, the reverb is applied with FFT convolution
+  static constexpr size_t kMaxTimeDomainTaps = 32;
+
   // augments source with reverberation noise
   void applyReverb(
       std::vector<float>& source,
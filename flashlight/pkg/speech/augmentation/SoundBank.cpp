@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/speech/augmentation/SoundBank.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/pkg/speech/data/Sound.h"
+
+namespace fl {
+namespace pkg {
+namespace speech {
+namespace sfx {
+
+namespace {
+
+constexpr const char* kRawExtension = ".f32";
+
+int64_t modificationTime(const std::string& filename) {
+  return fs::last_write_time(filename).time_since_epoch().count();
+}
+
+} // namespace
+
+BankSound::BankSound(std::vector<float> samples)
+    : samples_(std::move(samples)),
+      data_(samples_.data()),
+      size_(samples_.size()) {}
+
+BankSound::BankSound(const std::string& rawFilename) {
+  int fd = ::open(rawFilename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(
+        "BankSound - cannot open " + rawFilename + ": " +
+        std::strerror(errno));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size % sizeof(float) != 0) {
+    ::close(fd);
+    throw std::runtime_error(
+        "BankSound - invalid raw float file " + rawFilename);
+  }
+  if (st.st_size == 0) {
+    ::close(fd);
+    return;
+  }
+  mappingBytes_ = st.st_size;
+  void* mapping = ::mmap(nullptr, mappingBytes_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error(
+        "BankSound - cannot mmap " + rawFilename + ": " +
+        std::strerror(errno));
+  }
+  mapping_ = mapping;
+  data_ = static_cast<const float*>(mapping_);
+  size_ = mappingBytes_ / sizeof(float);
+}
+
+BankSound::~BankSound() {
+  if (mapping_) {
+    ::munmap(mapping_, mappingBytes_);
+  }
+}
+
+SoundBank::SoundBank(size_t maxBytes) : maxBytes_(maxBytes) {}
+
+std::shared_ptr<SoundBank> SoundBank::global() {
+  static std::shared_ptr<SoundBank> bank = []() {
+    size_t maxMb = kDefaultMaxMb;
+    if (const char* env = std::getenv(kMaxMbEnv)) {
+      maxMb = std::stoul(env);
+    }
+    return std::make_shared<SoundBank>(maxMb << 20);
+  }();
+  return bank;
+}
+
+std::shared_ptr<const BankSound> SoundBank::get(const std::string& filename) {
+  const int64_t mtime = modificationTime(filename);
+  std::promise<std::shared_ptr<const BankSound>> promise;
+  std::shared_future<std::shared_ptr<const BankSound>> pending;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(filename);
+    if (it != cache_.end() && it->second.modificationTime == mtime) {
+      ++numHits_;
+      lru_.splice(lru_.begin(), lru_, it->second.lruIt);
+      return it->second.sound;
+    }
+    auto loadingIt = loading_.find(filename);
+    if (loadingIt != loading_.end()) {
+      ++numHits_;
+      pending = loadingIt->second;
+    } else {
+      ++numMisses_;
+      loading_.emplace(filename, promise.get_future().share());
+    }
+  }
+  if (pending.valid()) {
+    // another thread is loading it
+    return pending.get();
+  }
+
+  std::shared_ptr<const BankSound> sound;
+  try {
+    if (fs::path(filename).extension() == kRawExtension) {
+      sound = std::make_shared<BankSound>(filename);
+    } else {
+      sound = std::make_shared<BankSound>(loadSound<float>(filename));
+    }
+  } catch (...) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      loading_.erase(filename);
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loading_.erase(filename);
+    insert(filename, sound, mtime);
+  }
+  promise.set_value(sound);
+  return sound;
+}
+
+void SoundBank::insert(
+    const std::string& filename,
+    std::shared_ptr<const BankSound> sound,
+    int64_t modificationTime) {
+  auto it = cache_.find(filename);
+  if (it != cache_.end()) {
+    // outdated version of the file
+    cachedBytes_ -= it->second.bytes;
+    lru_.erase(it->second.lruIt);
+    cache_.erase(it);
+  }
+  const size_t bytes = sound->isMapped() ? 0 : sound->size() * sizeof(float);
+  if (bytes > maxBytes_) {
+    return;
+  }
+  lru_.push_front(filename);
+  cache_[filename] = {std::move(sound), modificationTime, bytes, lru_.begin()};
+  cachedBytes_ += bytes;
+  while (cachedBytes_ > maxBytes_) {
+    auto evicted = cache_.find(lru_.back());
+    cachedBytes_ -= evicted->second.bytes;
+    cache_.erase(evicted);
+    lru_.pop_back();
+  }
+}
+
+void SoundBank::preload(
+    const std::vector<std::string>& filenames,
+    int nThreads /* = 1 */) {
+  nThreads = std::max(1, nThreads);
+  std::vector<std::future<void>> futures;
+  for (int t = 0; t < nThreads; ++t) {
+    futures.push_back(std::async(std::launch::async, [&, t]() {
+      for (size_t i = t; i < filenames.size(); i += nThreads) {
+        get(filenames[i]);
+      }
+    }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+size_t SoundBank::cachedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cachedBytes_;
+}
+
+int64_t SoundBank::numHits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numHits_;
+}
+
+int64_t SoundBank::numMisses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numMisses_;
+}
+
+} // namespace sfx
+} // namespace speech
+} // namespace pkg
+} // namespace fl
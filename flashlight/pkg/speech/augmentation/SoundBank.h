@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fl {
+namespace pkg {
+namespace speech {
+namespace sfx {
+
+/**
+ * A sound of a `SoundBank`: samples decoded into memory, or mapped from a raw
+ * file.
+ */
+class BankSound {
+ public:
+  explicit BankSound(std::vector<float> samples);
+  // Maps a file of raw little-endian 32-bit float samples
+  explicit BankSound(const std::string& rawFilename);
+  ~BankSound();
+
+  BankSound(const BankSound&) = delete;
+  BankSound& operator=(const BankSound&) = delete;
+
+  const float* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  float operator[](size_t i) const {
+    return data_[i];
+  }
+
+  bool isMapped() const {
+    return mapping_ != nullptr;
+  }
+
+ private:
+  std::vector<float> samples_;
+  void* mapping_{nullptr};
+  size_t mappingBytes_{0};
+  const float* data_{nullptr};
+  size_t size_{0};
+};
+
+/**
+ * Thread-safe cache of the sounds used by the sound effects (noise clips,
+ * impulse responses), shared by all the data loading threads so that every
+ * file is decoded once rather than for every augmented sample.
+ *
+ * Decoded sounds are kept up to `maxBytes`, the least recently used ones are
+ * evicted first. Files with the `.f32` extension hold raw little-endian
+ * 32-bit float samples and are memory mapped instead: they take no decoding
+ * time and don't count towards `maxBytes`, as the OS can page them out; they
+ * should be replaced (e.g. renamed over) rather than rewritten in place.
+ * A cached file is reloaded if it has been modified since.
+ */
+class SoundBank {
+ public:
+  static constexpr const char* kMaxMbEnv = "FL_SFX_SOUND_BANK_MB";
+  static constexpr size_t kDefaultMaxMb = 1024;
+
+  explicit SoundBank(size_t maxBytes);
+
+  /**
+   * The sound bank shared by the process, of `FL_SFX_SOUND_BANK_MB` MB
+   * (default 1024).
+   */
+  static std::shared_ptr<SoundBank> global();
+
+  /**
+   * Returns the samples of a sound file, loading it on a cache miss. The
+   * returned sound stays valid after being evicted from the cache.
+   */
+  std::shared_ptr<const BankSound> get(const std::string& filename);
+
+  /**
+   * Loads sound files in the cache ahead of time, using `nThreads` threads.
+   */
+  void preload(const std::vector<std::string>& filenames, int nThreads = 1);
+
+  size_t cachedBytes() const;
+  int64_t numHits() const;
+  int64_t numMisses() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<const BankSound> sound;
+    int64_t modificationTime;
+    size_t bytes;
+    std::list<std::string>::iterator lruIt;
+  };
+
+  const size_t maxBytes_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> cache_;
+  // most recently used first
+  std::list<std::string> lru_;
+  // files being loaded by a thread, waited for by the others
+  std::unordered_map<
+      std::string,
+      std::shared_future<std::shared_ptr<const BankSound>>>
+      loading_;
+  size_t cachedBytes_{0};
+  int64_t numHits_{0};
+  int64_t numMisses_{0};
+
+  void insert(
+      const std::string& filename,
+      std::shared_ptr<const BankSound> sound,
+      int64_t modificationTime);
+};
+
+} // namespace sfx
+} // namespace speech
+} // namespace pkg
+} // namespace fl
@@ -74,6 +74,18 @@ DEFINE_int64(
     0,
     "Maximum number of tokens/frames in the batch when using 'dynamic' batching strategy. "
     "Measured with the same unit as input sizes are specified in data list files");
+DEFINE_string(
+    list_index_cache_dir,
+    "",
+    "Directory where the parsed indices of data list files are cached, and "
+    "memory mapped from on later runs instead of parsing the lists again. "
+    "Caches are rebuilt when their list file changes. No caching if empty");
+DEFINE_bool(
+    list_encode_targets,
+    false,
+    "Encode the targets of data list files once, when datasets are created, "
+    "instead of on every access. Ignored if sampletarget > 0, as sampled "
+    "targets change between accesses");
 DEFINE_bool(
     usewordpiece,
     false,
@@ -131,6 +143,11 @@ DEFINE_int64(
     std::numeric_limits<int64_t>::max(),
     "[train] Total number of updates for training");
 DEFINE_bool(itersave, false, "Save model or not at each update");
+DEFINE_bool(
+    asyncsave,
+    true,
+    "[train] Write checkpoints to disk on a background thread instead of "
+    "blocking training until they are saved");
 DEFINE_double(lr, 1.0, "[train] Learning rate for the network parameters");
 DEFINE_double(
     momentum,
@@ -313,7 +330,7 @@ DEFINE_string(
     fl_optim_mode,
     "",
     "[train] Sets the flashlight optimization mode. "
-    "Optim modes can be O1, O2, or O3.");
+    "Optim modes can be O1, O2, O3 or BF16.");
 DEFINE_string(
     fl_log_level,
     "",
@@ -481,6 +498,26 @@ DEFINE_int32(
     emission_queue_size,
     3000,
     "[test, decode] Maximum size of emission queue for acoustic model forward pass");
+DEFINE_int32(
+    am_forward_batchsize,
+    1,
+    "[decode] Maximum number of samples batched together in the acoustic "
+    "model forward pass; batches are formed dynamically when > 1");
+DEFINE_int64(
+    am_forward_batch_frames,
+    -1,
+    "[decode] Maximum number of (padded) input frames in an acoustic model "
+    "forward batch, -1 for no limit");
+DEFINE_double(
+    am_forward_max_wait_ms,
+    50,
+    "[decode] Maximum time (in ms) a sample waits for its acoustic model "
+    "forward batch to fill up");
+DEFINE_int32(
+    am_forward_bucket_frames,
+    100,
+    "[decode] Only samples whose number of input frames fall in the same "
+    "interval of this width are batched together");
 
 DEFINE_double(
     smoothingtemperature,
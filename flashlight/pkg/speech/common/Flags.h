@@ -77,6 +77,8 @@ DECLARE_int64(channels);
 DECLARE_string(tokens);
 DECLARE_string(batching_strategy);
 DECLARE_int64(batching_max_duration);
+DECLARE_string(list_index_cache_dir);
+DECLARE_bool(list_encode_targets);
 DECLARE_bool(usewordpiece);
 DECLARE_int64(replabel);
 DECLARE_string(surround);
@@ -95,6 +97,7 @@ DECLARE_bool(lrcosine);
 
 DECLARE_int64(iter);
 DECLARE_bool(itersave);
+DECLARE_bool(asyncsave);
 DECLARE_double(lr);
 DECLARE_double(momentum);
 DECLARE_double(weightdecay);
@@ -213,6 +216,10 @@ DECLARE_int32(nthread_decoder);
 DECLARE_int32(lm_memory);
 
 DECLARE_int32(emission_queue_size);
+DECLARE_int32(am_forward_batchsize);
+DECLARE_int64(am_forward_batch_frames);
+DECLARE_double(am_forward_max_wait_ms);
+DECLARE_int32(am_forward_bucket_frames);
 
 DECLARE_double(lmweight_low);
 DECLARE_double(lmweight_high);
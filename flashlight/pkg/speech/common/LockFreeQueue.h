@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fl {
+namespace lib {
+
+/**
+ * LockFreeQueue is a bounded multi-producer multi-consumer queue with the same
+ * interface and semantics as `ProducerConsumerQueue`, for the cases where the
+ * queue is contended (small objects, many threads).
+ *
+ * Elements are stored in a ring buffer whose cells carry a sequence number
+ * (D. Vyukov's bounded MPMC queue): producers and consumers reserve a cell
+ * with a single compare-and-swap on their own position counter and never take
+ * a lock while the queue is neither full nor empty. A thread which can't make
+ * progress spins for a while, then parks on a condition variable; the other
+ * side only takes the lock to wake it up when a thread is actually parked.
+ *
+ * The capacity is `maxSize` rounded up to a power of two.
+ *
+ * Sample usage:
+ *
+ *   LockFreeQueue<T> queue(1024);
+ *
+ *   // Producer threads
+ *   queue.add(std::move(obj));
+ *   queue.finishAdding(); // when all producer threads joined
+ *
+ *   // Consumer threads
+ *   std::vector<T> objs;
+ *   while (queue.get(objs, 16)) { // up to 16 objects at once
+ *     ...
+ *     objs.clear();
+ *   }
+ */
+template <typename T>
+class LockFreeQueue {
+ public:
+  explicit LockFreeQueue(int maxSize = 3000)
+      : capacity_(roundUpPowerOfTwo(maxSize)),
+        mask_(capacity_ - 1),
+        cells_(new Cell[capacity_]) {
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  LockFreeQueue(const LockFreeQueue&) = delete;
+  LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+  /*
+   * - Adds an element to the queue, waits while the queue is full.
+   * - Ignores the current one if adding is finished.
+   */
+  void add(T unit) {
+    for (int spin = 0; spin < kSpinCount; ++spin) {
+      if (isAddingFinished_.load(std::memory_order_acquire)) {
+        return;
+      }
+      if (tryAdd(unit)) {
+        notifyConsumers();
+        return;
+      }
+      backoff(spin);
+    }
+    bool added = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ++numWaitingProducers_;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!isAddingFinished_.load() && !(added = tryAdd(unit))) {
+        producerCondition_.wait(lock);
+      }
+      --numWaitingProducers_;
+    }
+    if (added) {
+      notifyConsumers();
+    }
+  }
+
+  /*
+   * - Pops an element from the queue, waits while the queue is empty.
+   * - Returns false when adding is finished and queue is empty.
+   */
+  bool get(T& unit) {
+    for (int spin = 0; spin < kSpinCount; ++spin) {
+      if (tryGet(unit)) {
+        notifyProducers();
+        return true;
+      }
+      if (isAddingFinished_.load(std::memory_order_acquire)) {
+        return tryGet(unit);
+      }
+      backoff(spin);
+    }
+    bool found = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ++numWaitingConsumers_;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!(found = tryGet(unit)) && !isAddingFinished_.load()) {
+        consumerCondition_.wait(lock);
+      }
+      --numWaitingConsumers_;
+    }
+    if (found) {
+      notifyProducers();
+      return true;
+    }
+    // adding is finished, remaining elements are still returned
+    return tryGet(unit);
+  }
+
+  /*
+   * - Waits for at least one element, then pops up to `maxUnits` elements
+   *   without waiting and appends them to `units`.
+   * - Returns the number of elements popped, 0 when adding is finished and
+   *   queue is empty.
+   */
+  size_t get(std::vector<T>& units, size_t maxUnits) {
+    if (maxUnits == 0) {
+      return 0;
+    }
+    T unit;
+    if (!get(unit)) {
+      return 0;
+    }
+    units.push_back(std::move(unit));
+    size_t count = 1;
+    while (count < maxUnits && tryGet(unit)) {
+      units.push_back(std::move(unit));
+      ++count;
+    }
+    if (count > 1) {
+      // several slots were freed at once
+      notifyProducers(/* all = */ true);
+    }
+    return count;
+  }
+
+  /*
+   * - Sets the status of the queue to be adding-finished.
+   * - Notifies all the consumers to consume the remaining elements.
+   */
+  void finishAdding() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    isAddingFinished_.store(true);
+    consumerCondition_.notify_all();
+    producerCondition_.notify_all();
+  }
+
+  /*
+   * Number of elements in the queue, approximate while other threads use it.
+   */
+  size_t size() const {
+    auto enqueuePos = enqueuePos_.load(std::memory_order_relaxed);
+    auto dequeuePos = dequeuePos_.load(std::memory_order_relaxed);
+    return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+  }
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+ private:
+  static constexpr int kSpinCount = 128;
+  static constexpr int kYieldAfter = 16;
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  // Producers and consumers positions on separate cache lines
+  alignas(kCacheLineSize) std::atomic<size_t> enqueuePos_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> dequeuePos_{0};
+
+  alignas(kCacheLineSize) std::atomic<bool> isAddingFinished_{false};
+  std::atomic<int> numWaitingProducers_{0};
+  std::atomic<int> numWaitingConsumers_{0};
+  std::mutex mutex_;
+  std::condition_variable producerCondition_;
+  std::condition_variable consumerCondition_;
+
+  static size_t roundUpPowerOfTwo(int size) {
+    size_t capacity = 2;
+    while (capacity < static_cast<size_t>(size)) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  static void backoff(int spin) {
+    if (spin >= kYieldAfter) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Moves `unit` into the queue, returns false (leaving `unit` as is) if full.
+  // `tryAdd` and `tryGet` don't notify, so they can be called under the lock.
+  bool tryAdd(T& unit) {
+    Cell* cell;
+    auto pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      auto seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff =
+          static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(unit);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pops an element into `unit`, returns false if empty
+  bool tryGet(T& unit) {
+    Cell* cell;
+    auto pos = dequeuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      auto seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::intptr_t>(seq) -
+          static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeuePos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    unit = std::move(cell->data);
+    cell->sequence.store(pos + capacity_, std::memory_order_release);
+    return true;
+  }
+
+  // A parked thread registers itself before checking the queue one last time
+  // under the lock, and the other side takes the lock before notifying, so a
+  // wake-up can't be missed.
+  void notifyConsumers() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numWaitingConsumers_.load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      consumerCondition_.notify_one();
+    }
+  }
+
+  void notifyProducers(bool all = false) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numWaitingProducers_.load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (all) {
+        producerCondition_.notify_all();
+      } else {
+        producerCondition_.notify_one();
+      }
+    }
+  }
+};
+
+} // namespace lib
+} // namespace fl
@@ -8,12 +8,33 @@
 #include "flashlight/pkg/speech/criterion/CriterionUtils.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 
 #include "flashlight/fl/tensor/Index.h"
 
 using fl::lib::seq::CriterionScaleMode;
 
+namespace {
+
+constexpr const char* kCtcFastMathEnv = "FL_CTC_FAST_MATH";
+
+std::atomic<bool>& ctcFastMath() {
+  static std::atomic<bool> enabled([]() {
+    const char* env = std::getenv(kCtcFastMathEnv);
+    return env != nullptr && std::strcmp(env, "1") == 0;
+  }());
+  return enabled;
+}
+
+std::atomic<int> ctcMaxThreads{0};
+
+} // namespace
+
 namespace fl {
 namespace pkg {
 namespace speech {
@@ -35,6 +56,27 @@ int getTargetSize(const int* labels, int len) {
   return len;
 }
 
+bool getCtcFastMath() {
+  return ctcFastMath().load();
+}
+
+void setCtcFastMath(bool enabled) {
+  ctcFastMath().store(enabled);
+}
+
+int getCtcMaxThreads() {
+  return ctcMaxThreads.load();
+}
+
+void setCtcMaxThreads(int maxThreads) {
+  if (maxThreads < 0) {
+    throw std::invalid_argument(
+        "setCtcMaxThreads: invalid number of threads " +
+        std::to_string(maxThreads));
+  }
+  ctcMaxThreads.store(maxThreads);
+}
+
 CriterionScaleMode getCriterionScaleMode(
     const std::string& onorm,
     bool sqnorm) {
@@ -89,6 +89,22 @@ lib::seq::CriterionScaleMode getCriterionScaleMode(
     const std::string& onorm,
     bool sqnorm);
 
+// Whether the CPU CTC kernels approximate exp and log with polynomials rather
+// than calling std::exp and std::log. The polynomials are within about 1e-7
+// relative error of std::exp and std::log; over a whole sequence, the loss is
+// within 1e-5 relative error and the gradient within 1e-3 of the exact ones.
+// Off unless the environment variable FL_CTC_FAST_MATH is set to 1.
+bool getCtcFastMath();
+
+void setCtcFastMath(bool enabled);
+
+// The most threads the CPU CTC kernels run a batch on, which includes the
+// threads splitting the states of each frame of long sequences. 0 (the
+// default) for the OpenMP maximum.
+int getCtcMaxThreads();
+
+void setCtcMaxThreads(int maxThreads);
+
 // Input: N x T x B (type: float), Output: T x B (type: int)
 Tensor viterbiPath(const Tensor& input, const Tensor& trans);
 
@@ -7,6 +7,14 @@
 
 #include "flashlight/pkg/speech/criterion/ConnectionistTemporalClassificationCriterion.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "flashlight/pkg/speech/criterion/CriterionUtils.h"
 
 #include <flashlight/lib/sequence/criterion/cpu/CriterionUtils.h>
@@ -15,6 +23,474 @@ using namespace fl;
 
 using CriterionUtils = fl::lib::cpu::CriterionUtils<float>;
 
+namespace {
+
+// Rows of states are padded with -inf on both sides, so that the recursion
+// reads the states s - 2 and s - 1 (forward) or s + 1 and s + 2 (backward)
+// without bound checks, which lets the loops over states vectorize.
+constexpr int64_t kPad = 2;
+
+// Below this many states per thread, splitting the states of a frame across
+// threads costs more in barriers than it saves.
+constexpr int64_t kMinStatesPerThread = 256;
+
+int getMaxThreads() {
+  if (const int maxThreads = getCtcMaxThreads(); maxThreads > 0) {
+    return maxThreads;
+  }
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+inline float asFloat(int32_t i) {
+  float f;
+  std::memcpy(&f, &i, sizeof(f));
+  return f;
+}
+
+inline int32_t asInt(float f) {
+  int32_t i;
+  std::memcpy(&i, &f, sizeof(i));
+  return i;
+}
+
+// `cond ? a : b` with a bit mask, since the compiler may turn a conditional
+// expression into a branch, which prevents the loop from vectorizing.
+inline float select(bool cond, float a, float b) {
+  const int32_t mask = -static_cast<int32_t>(cond);
+  return asFloat((asInt(a) & mask) | (asInt(b) & ~mask));
+}
+
+inline float max3(float a, float b, float c) {
+  const float ab = select(a > b, a, b);
+  return select(ab > c, ab, c);
+}
+
+inline float min3(float a, float b, float c) {
+  const float ab = select(a < b, a, b);
+  return select(ab < c, ab, c);
+}
+
+inline float median3(float a, float b, float c) {
+  const float lo = select(a < b, a, b);
+  const float hi = select(a < b, b, a);
+  const float hiOrC = select(hi < c, hi, c);
+  return select(lo > hiOrC, lo, hiOrC);
+}
+
+// std::exp and std::log, which don't vectorize. exp is skipped for -inf, which
+// is frequent for the alphas of unreachable states. log1p(x) is computed as
+// log(1 + x), which is precise enough for the x in [0, 2] of the recursion but
+// much cheaper than std::log1p.
+struct ExactMath {
+  static inline float exp(float x) {
+    return x == NEG_INFINITY_FLT ? 0.0f : std::exp(x);
+  }
+
+  static inline float log1p(float x) {
+    return std::log(1.0f + x);
+  }
+};
+
+// Cephes' expf and logf without their special-case branches, so that they
+// vectorize. exp(-inf) is 0, and log1p is only valid for positive inputs.
+struct FastMath {
+  static inline float exp(float x) {
+    // exp(x) = 2^n * exp(r) with r = x - n * log(2) in [-log(2)/2, log(2)/2]
+    const bool underflow = x < -87.0f;
+    const float c = select(underflow, -87.0f, std::min(x, 88.0f));
+    // n = floor(c * log2(e) + 0.5), offset to truncate a positive number
+    const float n = static_cast<float>(static_cast<int32_t>(
+                        c * 1.44269504088896341f + 128.5f)) -
+        128.0f;
+    const float r = c - n * 0.693359375f + n * 2.12194440e-4f;
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+    const float result = asFloat(asInt(p) + (static_cast<int32_t>(n) << 23));
+    return select(underflow, 0.0f, result);
+  }
+
+  static inline float log(float x) {
+    // log(x) = e * log(2) + log(m) with m in [sqrt(2)/2, sqrt(2)]
+    const int32_t bits = asInt(x);
+    float e = static_cast<float>((bits >> 23) - 126);
+    float m = asFloat((bits & 0x007fffff) | 0x3f000000); // in [0.5, 1)
+    const bool small = m < 0.707106781186547524f;
+    e = select(small, e - 1.0f, e);
+    m = select(small, m + m - 1.0f, m - 1.0f);
+    const float z = m * m;
+    float p = 7.0376836292e-2f;
+    p = p * m - 1.1514610310e-1f;
+    p = p * m + 1.1676998740e-1f;
+    p = p * m - 1.2420140846e-1f;
+    p = p * m + 1.4249322787e-1f;
+    p = p * m - 1.6668057665e-1f;
+    p = p * m + 2.0000714765e-1f;
+    p = p * m - 2.4999993993e-1f;
+    p = p * m + 3.3333331174e-1f;
+    p = p * m * z - e * 2.12194440e-4f - 0.5f * z;
+    return m + p + e * 0.693359375f;
+  }
+
+  static inline float log1p(float x) {
+    return log(1.0f + x);
+  }
+};
+
+// The per-sequence state of the CTC recursion, shared by forward and backward
+struct Sequence {
+  int64_t S; // number of states, i.e. 2 * L + 1
+  // The token emitted by each state, padded with blanks (S + 2 * kPad)
+  std::vector<int> labels;
+  // 0 if a state can be reached by skipping the previous blank, -inf
+  // otherwise (S + 2 * kPad)
+  std::vector<float> skips;
+  std::vector<int64_t> starts; // the reachable states at each frame (T)
+  std::vector<int64_t> ends;
+  std::vector<float> alphas; // T x (S + 2 * kPad)
+  // log(sum_i(exp(x_i - max_i(x_i)))) for the alphas x_i leading to each
+  // state (T x (S + 2 * kPad)). Keeping it apart from the max, which the
+  // backward pass recomputes, preserves its precision when alphas are large.
+  // Only computed by `computeAlphas`, not by `computeAlphasScalar`
+  std::vector<float> logSums;
+  int numThreads; // the threads splitting the states of each frame
+};
+
+// By passing shared_ptr<Context> we avoid copies from forward to backward.
+struct Context {
+  std::vector<Sequence> sequences;
+  std::vector<float> scales;
+  bool fastMath;
+};
+
+void initSequence(
+    Sequence& seq,
+    const int* targetVec,
+    int64_t targetSize,
+    int64_t T,
+    int64_t N,
+    int maxThreads) {
+  int64_t L = targetSize;
+  const int64_t S = 2 * L + 1;
+  int64_t R = fl::pkg::speech::countRepeats(targetVec, L);
+
+  // A heuristic to modify target length to be able to compute CTC loss
+  L = std::min(L + R, T) - R;
+  R = fl::pkg::speech::countRepeats(
+      targetVec, L); // Recompute repeats as L has changed
+
+  seq.S = S;
+  seq.labels.assign(S + 2 * kPad, N - 1);
+  seq.skips.assign(S + 2 * kPad, NEG_INFINITY_FLT);
+  for (int64_t s = 1; s < S; s += 2) {
+    seq.labels[kPad + s] = targetVec[s / 2];
+    if (s > 1 && targetVec[s / 2] != targetVec[s / 2 - 1]) {
+      seq.skips[kPad + s] = 0;
+    }
+  }
+
+  // At each time frame t, only few states can be reached depending on the
+  // labels, their ordering and the current time frame.
+  seq.starts.resize(T);
+  seq.ends.resize(T);
+  int64_t start = (T - (L + R)) > 0 ? 0 : 1;
+  int64_t end = (S == 1) ? 1 : 2;
+  for (int64_t t = 0; t < T; ++t) {
+    if (t > 0 && T - t <= L + R) {
+      if (start & 1 && targetVec[start / 2] != targetVec[start / 2 + 1]) {
+        ++start;
+      }
+      ++start;
+    }
+    if (t > 0 && t <= L + R) {
+      if (end % 2 == 0 && end < 2 * L &&
+          (targetVec[end / 2 - 1] != targetVec[end / 2])) {
+        ++end;
+      }
+      ++end;
+    }
+    seq.starts[t] = start;
+    seq.ends[t] = end;
+  }
+
+  seq.numThreads = static_cast<int>(std::min<int64_t>(
+      std::max<int64_t>(S / kMinStatesPerThread, 1), maxThreads));
+}
+
+// Computes the alphas of a sequence, and returns the log-likelihood of its
+// target. Each frame only depends on the previous one, so the states of a
+// frame are the wavefront of the recursion: they are computed with SIMD,
+// split across `seq.numThreads` threads.
+template <class Math>
+float computeAlphas(
+    Sequence& seq,
+    const float* inputVec,
+    int64_t T,
+    int64_t N) {
+  const int64_t S = seq.S;
+  const int64_t stride = S + 2 * kPad;
+  seq.alphas.assign(T * stride, NEG_INFINITY_FLT);
+  seq.logSums.assign(T * stride, NEG_INFINITY_FLT);
+
+  // base case
+  float* alphas = seq.alphas.data() + kPad;
+  float* logSums = seq.logSums.data() + kPad;
+  const int* labels = seq.labels.data() + kPad;
+  const float* skips = seq.skips.data() + kPad;
+  if (seq.starts[0] == 0) {
+    alphas[0] = inputVec[N - 1];
+    logSums[0] = 0;
+  }
+  if (S != 1) {
+    alphas[1] = inputVec[labels[1]];
+    logSums[1] = 0;
+  }
+
+#pragma omp parallel num_threads(seq.numThreads) if (seq.numThreads > 1)
+  for (int64_t t = 1; t < T; ++t) {
+    const float* prev = alphas + (t - 1) * stride;
+    float* cur = alphas + t * stride;
+    float* curLogSums = logSums + t * stride;
+    const float* emissions = inputVec + t * N;
+#pragma omp for simd schedule(static)
+    for (int64_t s = seq.starts[t]; s < seq.ends[t]; ++s) {
+      const float a = prev[s];
+      const float b = prev[s - 1];
+      const float c = prev[s - 2] + skips[s];
+      // log(exp(a) + exp(b) + exp(c)) = m + log1p(exp(mid - m) + exp(lo - m))
+      float m = max3(a, b, c);
+      const bool reachable = m > NEG_INFINITY_FLT;
+      m = select(reachable, m, 0.0f);
+      const float mid = median3(a, b, c);
+      const float lo = min3(a, b, c);
+      const float logSum = select(
+          reachable,
+          Math::log1p(Math::exp(mid - m) + Math::exp(lo - m)),
+          NEG_INFINITY_FLT);
+      curLogSums[s] = logSum;
+      cur[s] = m + logSum + emissions[labels[s]];
+    }
+  }
+
+  const float* last = alphas + (T - 1) * stride;
+  return fl::pkg::speech::logSumExp(
+      last[S - 1], (S == 1) ? NEG_INFINITY_FLT : last[S - 2]);
+}
+
+// Computes the alphas of a sequence one state at a time with std::exp and
+// std::log, and returns the log-likelihood of its target. On a single thread,
+// this is faster than `computeAlphas<ExactMath>`: std::exp and std::log don't
+// vectorize, and states which can't skip the previous blank only need one exp.
+float computeAlphasScalar(
+    Sequence& seq,
+    const float* inputVec,
+    int64_t T,
+    int64_t N) {
+  const int64_t S = seq.S;
+  const int64_t stride = S + 2 * kPad;
+  seq.alphas.assign(T * stride, NEG_INFINITY_FLT);
+
+  float* alphas = seq.alphas.data() + kPad;
+  const int* labels = seq.labels.data() + kPad;
+  const float* skips = seq.skips.data() + kPad;
+  if (seq.starts[0] == 0) {
+    alphas[0] = inputVec[N - 1];
+  }
+  if (S != 1) {
+    alphas[1] = inputVec[labels[1]];
+  }
+  for (int64_t t = 1; t < T; ++t) {
+    const float* prev = alphas + (t - 1) * stride;
+    float* cur = alphas + t * stride;
+    const float* emissions = inputVec + t * N;
+    for (int64_t s = seq.starts[t]; s < seq.ends[t]; ++s) {
+      if (s == 0) {
+        cur[s] = prev[s];
+      } else if (skips[s] == 0) {
+        cur[s] = fl::pkg::speech::logSumExp(prev[s], prev[s - 1], prev[s - 2]);
+      } else {
+        cur[s] = fl::pkg::speech::logSumExp(prev[s], prev[s - 1]);
+      }
+      cur[s] += emissions[labels[s]];
+    }
+  }
+
+  const float* last = alphas + (T - 1) * stride;
+  return fl::pkg::speech::logSumExp(
+      last[S - 1], (S == 1) ? NEG_INFINITY_FLT : last[S - 2]);
+}
+
+// Adds to `grad` the gradient of the negative log-likelihood of the target of
+// a sequence w.r.t. its log probabilities, scaled by `gradScale`. The gradient
+// of each alpha is gathered from the states it leads to in the next frame, so
+// that the states of a frame are computed independently.
+template <class Math>
+void computeGrad(
+    const Sequence& seq,
+    float* grad,
+    float gradScale,
+    int64_t T,
+    int64_t N) {
+  const int64_t S = seq.S;
+  const int64_t stride = S + 2 * kPad;
+  const float* alphas = seq.alphas.data() + kPad;
+  const float* logSums = seq.logSums.data() + kPad;
+  const int* labels = seq.labels.data() + kPad;
+  const float* skips = seq.skips.data() + kPad;
+  const float neginf = NEG_INFINITY_FLT;
+
+  std::vector<float> dAlphasVec(T * stride, 0.0);
+  float* dAlphas = dAlphasVec.data() + kPad;
+
+  // Compute dAlphas for the last timeframe
+  const float* last = alphas + (T - 1) * stride;
+  float* dLast = dAlphas + (T - 1) * stride;
+  if (S == 1) {
+    dLast[0] = -1.0;
+  } else {
+    fl::pkg::speech::dLogSumExp(
+        last[S - 2], last[S - 1], dLast[S - 2], dLast[S - 1], -1.0);
+  }
+
+#pragma omp parallel num_threads(seq.numThreads) if (seq.numThreads > 1)
+  {
+    for (int64_t t = T - 1; t > 0; --t) {
+      const float* prev = alphas + (t - 1) * stride;
+      const float* curLogSums = logSums + t * stride;
+      const float* dCur = dAlphas + t * stride;
+      float* dPrev = dAlphas + (t - 1) * stride;
+#pragma omp for simd schedule(static)
+      for (int64_t s = seq.starts[t - 1]; s < seq.ends[t - 1]; ++s) {
+        // The alpha of s leads to the states s, s + 1 and s + 2 (if it can
+        // skip s + 1). The gradient of a state w.r.t. each alpha x leading to
+        // it is exp(x - max) / sum_i(exp(x_i - max)).
+        const float a = prev[s];
+        const float aSkip = a + skips[s + 2];
+        const float m0 = max3(a, prev[s - 1], prev[s - 2] + skips[s]);
+        const float m1 = max3(prev[s + 1], a, prev[s - 1] + skips[s + 1]);
+        const float m2 = max3(prev[s + 2], prev[s + 1], aSkip);
+        const float l0 = curLogSums[s];
+        const float l1 = curLogSums[s + 1];
+        const float l2 = curLogSums[s + 2];
+        const float d0 = select(l0 > neginf, a - m0 - l0, neginf);
+        const float d1 = select(l1 > neginf, a - m1 - l1, neginf);
+        const float d2 = select(l2 > neginf, aSkip - m2 - l2, neginf);
+        dPrev[s] = dCur[s] * Math::exp(d0) + dCur[s + 1] * Math::exp(d1) +
+            dCur[s + 2] * Math::exp(d2);
+      }
+    }
+
+    // The frames of grad are disjoint
+#pragma omp for schedule(static)
+    for (int64_t t = 0; t < T; ++t) {
+      const float* dCur = dAlphas + t * stride;
+      float* gradFrame = grad + t * N;
+      for (int64_t s = seq.starts[t]; s < seq.ends[t]; ++s) {
+        gradFrame[labels[s]] += dCur[s] * gradScale;
+      }
+    }
+  }
+}
+
+// The counterpart of `computeGrad` for `computeAlphasScalar`, which scatters
+// the gradient of each state to the alphas leading to it.
+void computeGradScalar(
+    const Sequence& seq,
+    float* grad,
+    float gradScale,
+    int64_t T,
+    int64_t N) {
+  const int64_t S = seq.S;
+  const int64_t stride = S + 2 * kPad;
+  const float* alphas = seq.alphas.data() + kPad;
+  const int* labels = seq.labels.data() + kPad;
+  const float* skips = seq.skips.data() + kPad;
+
+  std::vector<float> dAlphasVec(T * stride, 0.0);
+  float* dAlphas = dAlphasVec.data() + kPad;
+
+  const float* last = alphas + (T - 1) * stride;
+  float* dLast = dAlphas + (T - 1) * stride;
+  if (S == 1) {
+    dLast[0] = -1.0;
+  } else {
+    fl::pkg::speech::dLogSumExp(
+        last[S - 2], last[S - 1], dLast[S - 2], dLast[S - 1], -1.0);
+  }
+
+  for (int64_t t = T - 1; t >= 0; --t) {
+    const float* dCur = dAlphas + t * stride;
+    float* gradFrame = grad + t * N;
+    for (int64_t s = seq.starts[t]; s < seq.ends[t]; ++s) {
+      gradFrame[labels[s]] += dCur[s] * gradScale;
+    }
+    if (t == 0) {
+      break;
+    }
+    const float* prev = alphas + (t - 1) * stride;
+    float* dPrev = dAlphas + (t - 1) * stride;
+    for (int64_t s = seq.starts[t]; s < seq.ends[t]; ++s) {
+      if (s == 0) {
+        dPrev[s] += dCur[s];
+      } else if (skips[s] == 0) {
+        fl::pkg::speech::dLogSumExp(
+            prev[s],
+            prev[s - 1],
+            prev[s - 2],
+            dPrev[s],
+            dPrev[s - 1],
+            dPrev[s - 2],
+            dCur[s]);
+      } else {
+        fl::pkg::speech::dLogSumExp(
+            prev[s], prev[s - 1], dPrev[s], dPrev[s - 1], dCur[s]);
+      }
+    }
+  }
+}
+
+// Only split the states of long sequences across threads if the batch is
+// too small to keep all threads busy on its own.
+void assignThreads(std::vector<Sequence>& sequences, int maxThreads) {
+  if (sequences.size() < maxThreads) {
+    return;
+  }
+  for (auto& seq : sequences) {
+    seq.numThreads = 1;
+  }
+}
+
+// Runs `fn(b)` for each sequence of the batch. Sequences run in parallel,
+// unless some split their states across threads.
+template <class Fn>
+void forEachSequence(const std::vector<Sequence>& sequences, Fn&& fn) {
+  const int64_t B = sequences.size();
+  bool splitStates = false;
+  for (const auto& seq : sequences) {
+    splitStates |= seq.numThreads > 1;
+  }
+  if (splitStates) {
+    for (int64_t b = 0; b < B; ++b) {
+      fn(b);
+    }
+  } else {
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < B; ++b) {
+      fn(b);
+    }
+  }
+}
+
+} // namespace
+
 namespace fl {
 namespace pkg {
 namespace speech {
@@ -29,20 +505,19 @@ std::vector<Variable> ConnectionistTemporalClassificationCriterion::forward(
   validate(input, target);
   auto logprobs = logSoftmax(input, 0);
 
-  std::vector<std::vector<float>> batchAlphas;
+  auto ctx = std::make_shared<Context>();
+  ctx->fastMath = getCtcFastMath();
   std::vector<float> batchLoss;
-  std::vector<float> batchScales;
-  std::vector<int> batchTargetSizes;
   {
     const int64_t N = logprobs.dim(0);
     const int64_t T = logprobs.dim(1);
     const int64_t B = logprobs.dim(2);
     const int64_t batchL = target.dim(0);
 
-    batchAlphas.resize(B);
+    ctx->sequences.resize(B);
+    ctx->scales.resize(B);
     batchLoss.resize(B);
-    batchScales.resize(B);
-    batchTargetSizes.resize(B);
+    std::vector<int> batchTargetSizes(B);
 
     // get host pointers
     std::vector<float> batchInputVec(logprobs.elements());
@@ -55,171 +530,62 @@ std::vector<Variable> ConnectionistTemporalClassificationCriterion::forward(
         B, batchL, batchL, batchTargetVec.data(), batchTargetSizes.data());
 
     CriterionUtils::computeScale(
-        B, T, N, scaleMode_, batchTargetSizes.data(), batchScales.data());
+        B, T, N, scaleMode_, batchTargetSizes.data(), ctx->scales.data());
 
-#pragma omp parallel for num_threads(B)
+    const int maxThreads = getMaxThreads();
     for (int64_t b = 0; b < B; ++b) {
-      const float* inputVec = batchInputVec.data() + b * N * T;
-      const int* targetVec = batchTargetVec.data() + b * batchL;
-
-      int64_t L = batchTargetSizes[b];
-      const int64_t S = 2 * L + 1;
-      int64_t R = fl::pkg::speech::countRepeats(targetVec, L);
-
-      // A heuristic to modify target length to be able to compute CTC loss
-      L = std::min(L + R, T) - R;
-      R = fl::pkg::speech::countRepeats(
-          targetVec, L); // Recompute repeats as L has changed
-
-      auto& alphas = batchAlphas[b];
-      alphas.resize(T * S, NEG_INFINITY_FLT);
-
-      int64_t start = (T - (L + R)) > 0 ? 0 : 1;
-      int64_t end = (S == 1) ? 1 : 2;
+      initSequence(
+          ctx->sequences[b],
+          batchTargetVec.data() + b * batchL,
+          batchTargetSizes[b],
+          T,
+          N,
+          maxThreads);
+    }
+    assignThreads(ctx->sequences, maxThreads);
 
-      // base case
-      alphas[0] = (start == 0) ? inputVec[N - 1] : NEG_INFINITY_FLT;
-      if (S != 1) {
-        alphas[1] = inputVec[targetVec[0]];
-      }
-      for (int64_t t = 1; t < T; ++t) {
-        // At each time frame t, only few states can be reached depending
-        // on the labels, their ordering and the current time frame.
-        if (T - t <= L + R) {
-          if (start & 1 && targetVec[start / 2] != targetVec[start / 2 + 1]) {
-            ++start;
-          }
-          ++start;
-        }
-        if (t <= L + R) {
-          if (end % 2 == 0 && end < 2 * L &&
-              (targetVec[end / 2 - 1] != targetVec[end / 2])) {
-            ++end;
-          }
-          ++end;
-        }
-        // Use dynamic programming to recursively compute alphas
-        for (int64_t s = start; s < end; ++s) {
-          int64_t ts = t * S + s;
-          int64_t curLabel = t * N + ((s & 1) ? targetVec[s / 2] : N - 1);
-          if (s == 0) {
-            alphas[ts] = alphas[ts - S];
-          } else if (
-              (s % 2 == 0) || s == 1 ||
-              targetVec[s / 2] == targetVec[s / 2 - 1]) {
-            alphas[ts] =
-                fl::pkg::speech::logSumExp(alphas[ts - S], alphas[ts - S - 1]);
-          } else {
-            alphas[ts] = fl::pkg::speech::logSumExp(
-                alphas[ts - S], alphas[ts - S - 1], alphas[ts - S - 2]);
-          }
-          alphas[ts] += inputVec[curLabel];
-        }
+    // Without fast math, the SIMD kernels only pay off when the states of a
+    // frame are split across threads
+    forEachSequence(ctx->sequences, [&](int64_t b) {
+      auto& seq = ctx->sequences[b];
+      const float* inputVec = batchInputVec.data() + b * N * T;
+      float logLikelihood;
+      if (ctx->fastMath) {
+        logLikelihood = computeAlphas<FastMath>(seq, inputVec, T, N);
+      } else if (seq.numThreads > 1) {
+        logLikelihood = computeAlphas<ExactMath>(seq, inputVec, T, N);
+      } else {
+        logLikelihood = computeAlphasScalar(seq, inputVec, T, N);
       }
-      batchLoss[b] = -fl::pkg::speech::logSumExp(
-                         alphas.end()[-1],
-                         (S == 1) ? NEG_INFINITY_FLT : alphas.end()[-2]) *
-          batchScales[b];
-    }
+      batchLoss[b] = -logLikelihood * ctx->scales[b];
+    });
   }
   auto result = Tensor::fromVector(batchLoss);
 
-  auto gradFunc = [batchAlphas, batchScales, batchTargetSizes](
+  auto gradFunc = [ctx](
                       std::vector<Variable>& moduleInputs,
                       const Variable& gradOutput) {
     const int64_t N = moduleInputs[0].dim(0);
     const int64_t T = moduleInputs[0].dim(1);
     const int64_t B = moduleInputs[0].dim(2);
-    const int64_t batchL = moduleInputs[1].dim(0);
 
     std::vector<float> batchInGrad(moduleInputs[0].elements(), 0.0);
 
-    std::vector<int> batchTargetVec(moduleInputs[1].elements());
-    moduleInputs[1].host(batchTargetVec.data());
-
     std::vector<float> batchOutGrad(gradOutput.elements());
     gradOutput.host(batchOutGrad.data());
 
-#pragma omp parallel for num_threads(B)
-    for (int64_t b = 0; b < B; ++b) {
-      const int* targetVec = batchTargetVec.data() + b * batchL;
+    forEachSequence(ctx->sequences, [&](int64_t b) {
+      const auto& seq = ctx->sequences[b];
       float* grad = batchInGrad.data() + b * N * T;
-
-      int64_t L = batchTargetSizes[b];
-
-      L = std::min(L, T);
-      const int64_t R = fl::pkg::speech::countRepeats(targetVec, L);
-      L = std::min(L + R, T) - R;
-
-      const int64_t S = 2 * L + 1;
-      const auto& alphas = batchAlphas[b];
-
-      int64_t start = (S == 1) ? S : S - 1;
-      int64_t end = S;
-      std::vector<float> dAlphas(T * S, 0.0);
-
-      // Compute dAlphas for the last timeframe
-      if (S == 1) {
-        dAlphas[T * S - 1] = -1.0;
+      const float gradScale = batchOutGrad[b] * ctx->scales[b];
+      if (ctx->fastMath) {
+        computeGrad<FastMath>(seq, grad, gradScale, T, N);
+      } else if (seq.numThreads > 1) {
+        computeGrad<ExactMath>(seq, grad, gradScale, T, N);
       } else {
-        fl::pkg::speech::dLogSumExp(
-            alphas[T * S - 2],
-            alphas[T * S - 1],
-            dAlphas[T * S - 2],
-            dAlphas[T * S - 1],
-            -1.0);
-      }
-      float gradScale = batchOutGrad[b] * batchScales[b];
-
-      for (int64_t t = T - 1; t >= 0; --t) {
-        // Compute start and end values at time (t) similar to calculation
-        // of alpha in CTC forward pass
-        if (T - t <= L + R + 1) {
-          if (start & 1 && start > 1 &&
-              targetVec[start / 2] != targetVec[start / 2 - 1]) {
-            --start;
-          }
-          --start;
-        }
-        if (t < L + R) {
-          if (end % 2 == 0 &&
-              (targetVec[end / 2 - 1] != targetVec[end / 2 - 2])) {
-            --end;
-          }
-          --end;
-        }
-        // Compute grad and dAlphas for (t-1)th frame using chain rule
-        for (int64_t s = start; s < end; ++s) {
-          int64_t ts = t * S + s;
-          int64_t curLabel = t * N + ((s & 1) ? targetVec[s / 2] : N - 1);
-          grad[curLabel] += dAlphas[ts] * gradScale;
-          if (t == 0) {
-            continue;
-          }
-          if (s == 0) {
-            dAlphas[ts - S] += dAlphas[ts];
-          } else if (
-              (s % 2 == 0) || s == 1 ||
-              targetVec[s / 2] == targetVec[s / 2 - 1]) {
-            fl::pkg::speech::dLogSumExp(
-                alphas[ts - S],
-                alphas[ts - S - 1],
-                dAlphas[ts - S],
-                dAlphas[ts - S - 1],
-                dAlphas[ts]);
-          } else {
-            fl::pkg::speech::dLogSumExp(
-                alphas[ts - S],
-                alphas[ts - S - 1],
-                alphas[ts - S - 2],
-                dAlphas[ts - S],
-                dAlphas[ts - S - 1],
-                dAlphas[ts - S - 2],
-                dAlphas[ts]);
-          }
-        }
+        computeGradScalar(seq, grad, gradScale, T, N);
       }
-    }
+    });
     moduleInputs[0].addGrad(
         Variable(Tensor::fromVector({N, T, B}, batchInGrad), false));
   };
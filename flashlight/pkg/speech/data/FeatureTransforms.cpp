@@ -13,6 +13,7 @@
 #include <mutex>
 #include <stdexcept>
 #include <thread>
+#include <utility>
 
 #include "flashlight/pkg/speech/audio/feature/Mfcc.h"
 #include "flashlight/pkg/speech/audio/feature/Mfsc.h"
@@ -85,12 +86,19 @@ fl::Dataset::DataTransformFunction inputFeatures(
           "'inputFeatures': Invalid input dims . Expected 2d array - Channels x T");
     }
     auto channels = dims[0];
-    std::vector<float> input(dims.elements());
-    std::copy_n(static_cast<const float*>(data), input.size(), input.data());
-    if (channels > 1) {
-      input = transpose2d(input, dims[1], channels);
+    const bool applySfx = !sfxConf.empty() && sfxCounter->decrementAndCheck();
+    // Mono audio is featurized in place, without copies
+    const float* samples = static_cast<const float*>(data);
+    int64_t numSamples = dims.elements();
+    std::vector<float> input;
+    if (channels > 1 || applySfx || !spectralFeature) {
+      input.assign(samples, samples + dims.elements());
+      if (channels > 1) {
+        input = transpose2d(input, dims[1], channels);
+      }
+      samples = input.data();
     }
-    if (!sfxConf.empty() && sfxCounter->decrementAndCheck()) {
+    if (applySfx) {
       if (channels > 1) {
         throw std::invalid_argument(
             "'inputFeatures': Invalid input dims. sound effect supports a single channel audio");
@@ -99,14 +107,16 @@ fl::Dataset::DataTransformFunction inputFeatures(
       thread_local std::shared_ptr<sfx::SoundEffect> sfx =
           sfx::createSoundEffect(sfxConf, seed);
       sfx->apply(input);
+      samples = input.data();
+      numSamples = input.size();
     }
 
     std::vector<float> output;
     if (spectralFeature) {
-      output = spectralFeature->batchApply(input, channels);
+      output = spectralFeature->batchApply(samples, numSamples, channels);
     } else {
       // use raw audio
-      output = input; // T X CHANNELS (Col Major)
+      output = std::move(input); // T X CHANNELS (Col Major)
     }
 
     auto T = output.size() / (featSz * channels);
@@ -7,20 +7,16 @@
 
 #include "flashlight/pkg/speech/data/ListFileDataset.h"
 
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <utility>
+
 #include "flashlight/lib/text/String.h"
 #include "flashlight/pkg/speech/data/Sound.h"
 
 using namespace fl::lib;
 
-namespace {
-constexpr const size_t kIdIdx = 0;
-constexpr const size_t kInIdx = 1;
-constexpr const size_t kSzIdx = 2;
-constexpr const size_t kTgtIdx = 3;
-constexpr const size_t kNumCols = 4;
-
-} // namespace
-
 namespace fl {
 namespace pkg {
 namespace speech {
@@ -28,37 +24,89 @@ ListFileDataset::ListFileDataset(
     const std::string& filename,
     const DataTransformFunction& inFeatFunc /* = nullptr */,
     const DataTransformFunction& tgtFeatFunc /* = nullptr */,
-    const DataTransformFunction& wrdFeatFunc /* = nullptr */)
+    const DataTransformFunction& wrdFeatFunc /* = nullptr */,
+    const std::string& indexCacheDir /* = "" */,
+    int nThreads /* = 0 */,
+    bool encodeTargetsAhead /* = false */)
     : inFeatFunc_(inFeatFunc),
       tgtFeatFunc_(tgtFeatFunc),
       wrdFeatFunc_(wrdFeatFunc),
       numRows_(0) {
-  std::ifstream inFile(filename);
-  if (!inFile) {
-    throw std::invalid_argument("Unable to open file -" + filename);
-  }
-  std::string line;
-  while (std::getline(inFile, line)) {
-    if (line.empty()) {
-      continue;
-    }
-    auto splits = splitOnWhitespace(line, true);
-    if (splits.size() < 3) {
-      throw std::runtime_error(
-          "File " + filename +
-          " has invalid columns in line (expected 3 columns at least): " +
-          line);
-    }
+  if (nThreads <= 0) {
+    nThreads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (indexCacheDir.empty()) {
+    index_ = ListFileIndex::parse(filename, nThreads);
+  } else {
+    index_ = ListFileIndex::load(
+        filename, ListFileIndex::cachePath(filename, indexCacheDir), nThreads);
+  }
+  numRows_ = index_->size();
+  targetSizesCache_.resize(numRows_, -1);
+  if (encodeTargetsAhead) {
+    encodeTargets(nThreads);
+  }
+}
+
+Tensor ListFileDataset::encodeTarget(const int64_t idx) const {
+  // transforms only read the transcription
+  const auto target = index_->target(idx);
+  return tgtFeatFunc_(
+      const_cast<char*>(target.data()),
+      {static_cast<Dim>(target.size())},
+      fl::dtype::b8);
+}
+
+void ListFileDataset::encodeTargets(int nThreads) {
+  if (!tgtFeatFunc_ || numRows_ == 0) {
+    return;
+  }
+  // only targets of ints, e.g. token indices, are encoded ahead
+  auto first = encodeTarget(0);
+  if (first.type() != fl::dtype::s32 || first.ndim() > 1) {
+    return;
+  }
 
-    ids_.emplace_back(std::move(splits[kIdIdx]));
-    inputs_.emplace_back(std::move(splits[kInIdx]));
-    inputSizes_.emplace_back(std::stof(splits[kSzIdx]));
-    targets_.emplace_back(fl::lib::join(
-        " ", std::vector<std::string>(splits.begin() + kTgtIdx, splits.end())));
-    ++numRows_;
+  // Encode contiguous ranges of samples in parallel, then concatenate them
+  struct EncodedRange {
+    std::vector<int> tokens;
+    std::vector<int64_t> sizes;
+  };
+  const int64_t numRanges = std::min<int64_t>(nThreads, numRows_);
+  std::vector<std::future<EncodedRange>> futures;
+  for (int64_t r = 0; r < numRanges; ++r) {
+    futures.push_back(std::async(std::launch::async, [this, r, numRanges]() {
+      EncodedRange range;
+      const int64_t begin = numRows_ * r / numRanges;
+      const int64_t end = numRows_ * (r + 1) / numRanges;
+      for (int64_t idx = begin; idx < end; ++idx) {
+        auto target = encodeTarget(idx);
+        if (target.type() != fl::dtype::s32 || target.ndim() > 1) {
+          throw std::runtime_error(
+              "ListFileDataset - target transform returned inconsistent "
+              "types or shapes");
+        }
+        const size_t offset = range.tokens.size();
+        range.tokens.resize(offset + target.elements());
+        if (target.elements() > 0) {
+          target.host(range.tokens.data() + offset);
+        }
+        range.sizes.push_back(target.elements());
+      }
+      return range;
+    }));
+  }
+  targetOffsets_.reserve(numRows_ + 1);
+  targetOffsets_.push_back(0);
+  for (auto& future : futures) {
+    auto range = future.get();
+    targetTokens_.insert(
+        targetTokens_.end(), range.tokens.begin(), range.tokens.end());
+    for (int64_t size : range.sizes) {
+      targetOffsets_.push_back(targetOffsets_.back() + size);
+    }
   }
-  inFile.close();
-  targetSizesCache_.resize(inputSizes_.size(), -1);
+  targetTokens_.shrink_to_fit();
 }
 
 int64_t ListFileDataset::size() const {
@@ -68,45 +116,53 @@ int64_t ListFileDataset::size() const {
 std::vector<Tensor> ListFileDataset::get(const int64_t idx) const {
   checkIndexBounds(idx);
 
-  auto audio = loadAudio(inputs_[idx]); // channels x time
+  const std::string handle(index_->input(idx));
   Tensor input;
-  if (inFeatFunc_) {
-    input = inFeatFunc_(
-        static_cast<void*>(audio.first.data()), audio.second, fl::dtype::f32);
+  auto raw = RawSoundHandle::parse(handle);
+  auto shard = raw ? rawShard(raw->shard) : nullptr;
+  if (const float* samples = shard ? shard->floatData(*raw) : nullptr) {
+    // featurized straight from the mapped shard
+    input = loadInput(samples, {1, raw->frames()});
   } else {
-    input = Tensor::fromBuffer(
-        {audio.second}, audio.first.data(), MemoryLocation::Host);
+    auto audio = loadAudio(handle); // channels x time
+    input = loadInput(audio.first.data(), audio.second);
   }
 
   Tensor target;
-  if (tgtFeatFunc_) {
-    std::vector<char> curTarget(targets_[idx].begin(), targets_[idx].end());
-    target = tgtFeatFunc_(
-        static_cast<void*>(curTarget.data()),
-        {static_cast<Dim>(curTarget.size())},
-        fl::dtype::b8);
+  if (!targetOffsets_.empty()) {
+    const int64_t begin = targetOffsets_[idx];
+    const Dim numTokens = targetOffsets_[idx + 1] - begin;
+    target = numTokens > 0
+        ? Tensor::fromBuffer(
+              {numTokens}, targetTokens_.data() + begin, MemoryLocation::Host)
+        : Tensor({0}, fl::dtype::s32);
+  } else if (tgtFeatFunc_) {
+    target = encodeTarget(idx);
+    targetSizesCache_[idx] = target.elements();
   }
-  targetSizesCache_[idx] = target.elements();
 
   Tensor words;
   if (wrdFeatFunc_) {
-    std::vector<char> curTarget(targets_[idx].begin(), targets_[idx].end());
+    const auto transcription = index_->target(idx);
     words = wrdFeatFunc_(
-        static_cast<void*>(curTarget.data()),
-        {static_cast<Dim>(curTarget.size())},
+        const_cast<char*>(transcription.data()),
+        {static_cast<Dim>(transcription.size())},
         fl::dtype::b8);
   }
 
+  const auto id = index_->id(idx);
   Tensor sampleIdx = Tensor::fromBuffer(
-      {static_cast<long long>(ids_[idx].length())},
-      const_cast<char*>(ids_[idx].data()), // fix me post C++-17?
+      {static_cast<long long>(id.length())},
+      id.data(),
       MemoryLocation::Host);
+  const auto path = index_->input(idx);
   Tensor samplePath = Tensor::fromBuffer(
-      {static_cast<long long>(inputs_[idx].length())},
-      inputs_[idx].data(),
+      {static_cast<long long>(path.length())},
+      path.data(),
       MemoryLocation::Host);
+  float inputSize = index_->inputSize(idx);
   Tensor sampleDuration =
-      Tensor::fromBuffer({1}, inputSizes_.data() + idx, MemoryLocation::Host);
+      Tensor::fromBuffer({1}, &inputSize, MemoryLocation::Host);
   Tensor sampleTargetSize = fl::full({1}, float(target.elements()));
 
   return {
@@ -121,29 +177,50 @@ std::vector<Tensor> ListFileDataset::get(const int64_t idx) const {
 
 std::pair<std::vector<float>, Shape> ListFileDataset::loadAudio(
     const std::string& handle) const {
-  auto info = loadSoundInfo(handle.c_str());
-  return {loadSound<float>(handle.c_str()), {info.channels, info.frames}};
+  if (auto raw = RawSoundHandle::parse(handle)) {
+    return {rawShard(raw->shard)->load(*raw), {1, raw->frames()}};
+  }
+  SoundInfo info;
+  auto samples = loadSound<float>(handle, info);
+  return {std::move(samples), {info.channels, info.frames}};
+}
+
+Tensor ListFileDataset::loadInput(const float* samples, const Shape& dims)
+    const {
+  if (inFeatFunc_) {
+    // transforms only read the samples
+    return inFeatFunc_(const_cast<float*>(samples), dims, fl::dtype::f32);
+  }
+  return Tensor::fromBuffer(dims, samples, MemoryLocation::Host);
+}
+
+std::shared_ptr<const RawSoundShard> ListFileDataset::rawShard(
+    const std::string& filename) const {
+  std::lock_guard<std::mutex> lock(rawShardsMutex_);
+  auto& shard = rawShards_[filename];
+  if (!shard) {
+    shard = std::make_shared<const RawSoundShard>(filename);
+  }
+  return shard;
 }
 
 float ListFileDataset::getInputSize(const int64_t idx) const {
   checkIndexBounds(idx);
-  return inputSizes_[idx];
+  return index_->inputSize(idx);
 }
 
 int64_t ListFileDataset::getTargetSize(const int64_t idx) const {
   checkIndexBounds(idx);
+  if (!targetOffsets_.empty()) {
+    return targetOffsets_[idx + 1] - targetOffsets_[idx];
+  }
   if (targetSizesCache_[idx] >= 0) {
     return targetSizesCache_[idx];
   }
   if (!tgtFeatFunc_) {
     return 0;
   }
-  std::vector<char> curTarget(targets_[idx].begin(), targets_[idx].end());
-  auto tgtSize = tgtFeatFunc_(
-                     static_cast<void*>(curTarget.data()),
-                     {static_cast<long long>(curTarget.size())},
-                     fl::dtype::b8)
-                     .elements();
+  auto tgtSize = encodeTarget(idx).elements();
   targetSizesCache_[idx] = tgtSize;
   return tgtSize;
 }
@@ -7,12 +7,17 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "flashlight/fl/flashlight.h"
 
 #include "flashlight/lib/text/dictionary/Dictionary.h"
+#include "flashlight/pkg/speech/data/ListFileIndex.h"
+#include "flashlight/pkg/speech/data/RawSound.h"
 
 namespace fl {
 namespace pkg {
@@ -42,6 +47,19 @@ namespace speech {
  * Calling `dataset.get(idx)` returns a Tensor vector of size 4 - `input`,
  * `target`, `word_transcription`, `sample_id` in the same order.
  *
+ * The list file is parsed by `nThreads` threads (all hardware threads by
+ * default) into a compact `ListFileIndex`. If `indexCacheDir` is given, the
+ * index is cached there and memory mapped by later runs instead of parsing the
+ * list file again. If `encodeTargetsAhead` is set, targets are encoded with
+ * `tgtFeatFunc` once, by `nThreads` threads, when the dataset is created, if it
+ * yields 1D int targets; `tgtFeatFunc` must then be thread safe and return the
+ * same target on every call, e.g. it must not sample spellings. Otherwise
+ * targets are encoded on every `get()`.
+ *
+ * Input handles can also be raw sounds in shard files (see `RawSoundHandle`),
+ * e.g. `/tmp/shard000.f32:1048576:64000`. Shards are memory mapped, and float
+ * sounds are given to `inFeatFunc` straight from the mapping, without copies.
+ *
  */
 class ListFileDataset : public fl::Dataset {
  public:
@@ -49,7 +67,10 @@ class ListFileDataset : public fl::Dataset {
       const std::string& filename,
       const DataTransformFunction& inFeatFunc = nullptr,
       const DataTransformFunction& tgtFeatFunc = nullptr,
-      const DataTransformFunction& wrdFeatFunc = nullptr);
+      const DataTransformFunction& wrdFeatFunc = nullptr,
+      const std::string& indexCacheDir = "",
+      int nThreads = 0,
+      bool encodeTargetsAhead = false);
 
   int64_t size() const override;
 
@@ -65,11 +86,27 @@ class ListFileDataset : public fl::Dataset {
  protected:
   DataTransformFunction inFeatFunc_, tgtFeatFunc_, wrdFeatFunc_;
   int64_t numRows_;
-  std::vector<std::string> ids_;
-  std::vector<std::string> inputs_;
-  std::vector<std::string> targets_;
-  std::vector<float> inputSizes_;
+  std::shared_ptr<const ListFileIndex> index_;
+  // Targets encoded by `tgtFeatFunc_`: the tokens of sample `i` are at
+  // [targetOffsets_[i], targetOffsets_[i + 1]); empty if not encoded ahead.
+  std::vector<int> targetTokens_;
+  std::vector<int64_t> targetOffsets_;
   mutable std::vector<int64_t> targetSizesCache_;
+
+  // Runs `tgtFeatFunc_` on the transcription of a sample
+  Tensor encodeTarget(const int64_t idx) const;
+  // Encodes all the targets with `nThreads` threads, if they are 1D int
+  void encodeTargets(int nThreads);
+
+  // Runs `inFeatFunc_`, if any, on samples (channels x time)
+  Tensor loadInput(const float* samples, const Shape& dims) const;
+
+  // The mapped raw sound shard file `filename`, mapped on first use
+  std::shared_ptr<const RawSoundShard> rawShard(
+      const std::string& filename) const;
+  mutable std::mutex rawShardsMutex_;
+  mutable std::unordered_map<std::string, std::shared_ptr<const RawSoundShard>>
+      rawShards_;
 };
 
 } // namespace speech
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/speech/data/ListFileIndex.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glog/logging.h>
+
+#include "flashlight/fl/common/Filesystem.h"
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+namespace {
+
+constexpr char kCacheMagic[8] = {'F', 'L', 'L', 'S', 'T', 'I', 'D', 'X'};
+constexpr uint32_t kCacheVersion = 1;
+constexpr const char* kCacheExtension = ".lstidx";
+
+// Layout of the cache file: the header, then the offset table, the input sizes
+// and the character arena.
+struct CacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t listFileBytes;
+  int64_t listFileModificationTime;
+  uint64_t numRows;
+  uint64_t arenaBytes;
+};
+
+size_t cacheBytes(uint64_t numRows, uint64_t arenaBytes) {
+  return sizeof(CacheHeader) + (numRows * 3 + 1) * sizeof(uint64_t) +
+      numRows * sizeof(float) + arenaBytes;
+}
+
+int64_t modificationTime(const std::string& filename) {
+  return fs::last_write_time(filename).time_since_epoch().count();
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+      c == '\r';
+}
+
+// The rows of a chunk of the list file
+struct ParsedChunk {
+  std::string arena;
+  // start of each field in `arena`
+  std::vector<uint64_t> offsets;
+  std::vector<float> inputSizes;
+};
+
+// Parses the rows of [begin, end), which starts at the beginning of a line.
+// Fields are separated by whitespace; words of the transcription are joined
+// by single spaces.
+ParsedChunk parseChunk(
+    const std::string& filename,
+    const char* begin,
+    const char* end) {
+  ParsedChunk chunk;
+  chunk.arena.reserve(end - begin);
+  std::vector<std::string_view> words;
+  for (const char* lineBegin = begin; lineBegin < end;) {
+    const char* lineEnd = std::find(lineBegin, end, '\n');
+    const std::string_view line(lineBegin, lineEnd - lineBegin);
+    lineBegin = lineEnd + 1;
+    if (line.empty()) {
+      continue;
+    }
+
+    words.clear();
+    for (size_t pos = 0; pos < line.size();) {
+      while (pos < line.size() && isSpace(line[pos])) {
+        ++pos;
+      }
+      const size_t wordBegin = pos;
+      while (pos < line.size() && !isSpace(line[pos])) {
+        ++pos;
+      }
+      if (pos > wordBegin) {
+        words.push_back(line.substr(wordBegin, pos - wordBegin));
+      }
+    }
+    if (words.size() < 3) {
+      throw std::runtime_error(
+          "File " + filename +
+          " has invalid columns in line (expected 3 columns at least): " +
+          std::string(line));
+    }
+
+    const std::string size(words[2]);
+    char* sizeEnd = nullptr;
+    const float inputSize = std::strtof(size.c_str(), &sizeEnd);
+    if (sizeEnd == size.c_str()) {
+      throw std::runtime_error(
+          "File " + filename + " has an invalid size in line: " +
+          std::string(line));
+    }
+
+    chunk.offsets.push_back(chunk.arena.size());
+    chunk.arena.append(words[0]);
+    chunk.offsets.push_back(chunk.arena.size());
+    chunk.arena.append(words[1]);
+    chunk.offsets.push_back(chunk.arena.size());
+    for (size_t i = 3; i < words.size(); ++i) {
+      if (i > 3) {
+        chunk.arena.push_back(' ');
+      }
+      chunk.arena.append(words[i]);
+    }
+    chunk.inputSizes.push_back(inputSize);
+  }
+  return chunk;
+}
+
+} // namespace
+
+std::shared_ptr<const ListFileIndex> ListFileIndex::parse(
+    const std::string& listFile,
+    int nThreads /* = 0 */) {
+  std::ifstream in(listFile, std::ios::binary);
+  if (!in) {
+    throw std::invalid_argument("Unable to open file -" + listFile);
+  }
+  std::shared_ptr<ListFileIndex> index(new ListFileIndex());
+  index->listFileBytes_ = fs::file_size(listFile);
+  index->listFileModificationTime_ = modificationTime(listFile);
+  std::string contents(index->listFileBytes_, '\0');
+  in.read(&contents[0], contents.size());
+  contents.resize(in.gcount());
+
+  if (nThreads <= 0) {
+    nThreads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  // Chunks end at line boundaries
+  std::vector<const char*> bounds = {contents.data()};
+  const char* contentsEnd = contents.data() + contents.size();
+  for (int t = 1; t < nThreads; ++t) {
+    const char* bound = std::max<const char*>(
+        bounds.back(), contents.data() + contents.size() * t / nThreads);
+    bound = std::find(bound, contentsEnd, '\n');
+    bounds.push_back(bound == contentsEnd ? bound : bound + 1);
+  }
+  bounds.push_back(contentsEnd);
+
+  std::vector<std::future<ParsedChunk>> futures;
+  for (size_t c = 0; c + 1 < bounds.size(); ++c) {
+    futures.push_back(std::async(
+        std::launch::async, parseChunk, listFile, bounds[c], bounds[c + 1]));
+  }
+  std::vector<ParsedChunk> chunks;
+  for (auto& future : futures) {
+    chunks.push_back(future.get());
+  }
+
+  size_t arenaBytes = 0;
+  for (const auto& chunk : chunks) {
+    index->numRows_ += chunk.inputSizes.size();
+    arenaBytes += chunk.arena.size();
+  }
+  index->arenaStorage_.reserve(arenaBytes);
+  index->offsetsStorage_.reserve(index->numRows_ * kNumFields + 1);
+  index->inputSizesStorage_.reserve(index->numRows_);
+  for (auto& chunk : chunks) {
+    const uint64_t base = index->arenaStorage_.size();
+    for (uint64_t offset : chunk.offsets) {
+      index->offsetsStorage_.push_back(base + offset);
+    }
+    index->arenaStorage_.append(chunk.arena);
+    index->inputSizesStorage_.insert(
+        index->inputSizesStorage_.end(),
+        chunk.inputSizes.begin(),
+        chunk.inputSizes.end());
+    chunk = ParsedChunk();
+  }
+  index->offsetsStorage_.push_back(index->arenaStorage_.size());
+
+  index->arena_ = index->arenaStorage_.data();
+  index->offsets_ = index->offsetsStorage_.data();
+  index->inputSizes_ = index->inputSizesStorage_.data();
+  return index;
+}
+
+std::shared_ptr<const ListFileIndex> ListFileIndex::load(
+    const std::string& listFile,
+    const std::string& cacheFile,
+    int nThreads /* = 0 */) {
+  if (auto index = map(listFile, cacheFile)) {
+    return index;
+  }
+  auto index = parse(listFile, nThreads);
+  try {
+    index->save(cacheFile);
+  } catch (const std::exception& ex) {
+    // the index is still usable without a cache
+    LOG(WARNING) << "ListFileIndex - cannot write index cache " << cacheFile
+                 << ": " << ex.what();
+  }
+  return index;
+}
+
+std::string ListFileIndex::cachePath(
+    const std::string& listFile,
+    const std::string& cacheDir) {
+  const auto absolute = fs::absolute(listFile);
+  std::stringstream name;
+  name << absolute.stem().string() << "-" << std::hex
+       << std::hash<std::string>()(absolute.string()) << kCacheExtension;
+  return (fs::path(cacheDir) / name.str()).string();
+}
+
+std::shared_ptr<const ListFileIndex> ListFileIndex::map(
+    const std::string& listFile,
+    const std::string& cacheFile) {
+  if (!fs::exists(cacheFile) || !fs::exists(listFile)) {
+    return nullptr;
+  }
+  int fd = ::open(cacheFile.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(CacheHeader)) {
+    ::close(fd);
+    return nullptr;
+  }
+  const size_t bytes = st.st_size;
+  void* mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+
+  std::shared_ptr<ListFileIndex> index(new ListFileIndex());
+  index->mapping_ = mapping;
+  index->mappingBytes_ = bytes;
+  const auto* header = static_cast<const CacheHeader*>(mapping);
+  if (std::memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+      header->version != kCacheVersion ||
+      header->listFileBytes != fs::file_size(listFile) ||
+      header->listFileModificationTime != modificationTime(listFile) ||
+      cacheBytes(header->numRows, header->arenaBytes) != bytes) {
+    // stale or from another version: parse again
+    return nullptr;
+  }
+  index->numRows_ = header->numRows;
+  index->listFileBytes_ = header->listFileBytes;
+  index->listFileModificationTime_ = header->listFileModificationTime;
+  const char* data = static_cast<const char*>(mapping) + sizeof(CacheHeader);
+  index->offsets_ = reinterpret_cast<const uint64_t*>(data);
+  data += (header->numRows * kNumFields + 1) * sizeof(uint64_t);
+  index->inputSizes_ = reinterpret_cast<const float*>(data);
+  data += header->numRows * sizeof(float);
+  index->arena_ = data;
+  if (index->offsets_[header->numRows * kNumFields] != header->arenaBytes) {
+    return nullptr;
+  }
+  return index;
+}
+
+ListFileIndex::~ListFileIndex() {
+  if (mapping_) {
+    ::munmap(mapping_, mappingBytes_);
+  }
+}
+
+void ListFileIndex::save(const std::string& cacheFile) const {
+  const uint64_t arenaBytes = offsets_[numRows_ * kNumFields];
+  CacheHeader header{};
+  std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.version = kCacheVersion;
+  header.listFileBytes = listFileBytes_;
+  header.listFileModificationTime = listFileModificationTime_;
+  header.numRows = numRows_;
+  header.arenaBytes = arenaBytes;
+
+  const std::string tmpFile = cacheFile + ".tmp." + std::to_string(::getpid()) +
+      "." + std::to_string(std::hash<std::thread::id>()(
+                std::this_thread::get_id()));
+  {
+    std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error(
+          "ListFileIndex::save - cannot open " + tmpFile + ": " +
+          std::strerror(errno));
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(
+        reinterpret_cast<const char*>(offsets_),
+        (numRows_ * kNumFields + 1) * sizeof(uint64_t));
+    out.write(
+        reinterpret_cast<const char*>(inputSizes_), numRows_ * sizeof(float));
+    out.write(arena_, arenaBytes);
+    if (!out) {
+      out.close();
+      fs::remove(tmpFile);
+      throw std::runtime_error("ListFileIndex::save - cannot write " + tmpFile);
+    }
+  }
+  fs::rename(tmpFile, cacheFile);
+}
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
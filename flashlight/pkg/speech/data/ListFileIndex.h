@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+/**
+ * Compact in-memory index of a list file (see `ListFileDataset`): the id,
+ * input handle and transcription of every row are stored back to back in a
+ * single character arena, addressed by an offset table, along with the input
+ * sizes. Transcriptions are normalized to single spaces between words.
+ *
+ * The index can be saved to a binary cache file, which is memory mapped when
+ * loaded again, so that large lists are neither parsed nor copied on later
+ * runs. The cache records the size and modification time of its list file and
+ * is ignored once the list file changes.
+ */
+class ListFileIndex {
+ public:
+  /**
+   * Parses a list file, splitting it into chunks of rows parsed by `nThreads`
+   * threads (the number of hardware threads if <= 0).
+   */
+  static std::shared_ptr<const ListFileIndex> parse(
+      const std::string& listFile,
+      int nThreads = 0);
+
+  /**
+   * Maps the index cache of `listFile` from `cacheFile` if it is valid; else
+   * parses the list file and saves its index to `cacheFile`. The cache file is
+   * written to a temporary file first and renamed, so that processes sharing a
+   * cache directory never read partial files.
+   */
+  static std::shared_ptr<const ListFileIndex> load(
+      const std::string& listFile,
+      const std::string& cacheFile,
+      int nThreads = 0);
+
+  /**
+   * The cache file of `listFile` in `cacheDir`, named after the list file and
+   * a hash of its absolute path.
+   */
+  static std::string cachePath(
+      const std::string& listFile,
+      const std::string& cacheDir);
+
+  ~ListFileIndex();
+
+  ListFileIndex(const ListFileIndex&) = delete;
+  ListFileIndex& operator=(const ListFileIndex&) = delete;
+
+  /**
+   * Writes the index to `cacheFile`.
+   */
+  void save(const std::string& cacheFile) const;
+
+  int64_t size() const {
+    return numRows_;
+  }
+
+  std::string_view id(int64_t idx) const {
+    return field(idx, kIdField);
+  }
+
+  std::string_view input(int64_t idx) const {
+    return field(idx, kInputField);
+  }
+
+  std::string_view target(int64_t idx) const {
+    return field(idx, kTargetField);
+  }
+
+  float inputSize(int64_t idx) const {
+    return inputSizes_[idx];
+  }
+
+  /**
+   * Whether the index is mapped from a cache file.
+   */
+  bool isMapped() const {
+    return mapping_ != nullptr;
+  }
+
+ private:
+  static constexpr int kIdField = 0;
+  static constexpr int kInputField = 1;
+  static constexpr int kTargetField = 2;
+  static constexpr int kNumFields = 3;
+
+  ListFileIndex() = default;
+
+  // Maps a cache file; null if it is missing, invalid or stale
+  static std::shared_ptr<const ListFileIndex> map(
+      const std::string& listFile,
+      const std::string& cacheFile);
+
+  std::string_view field(int64_t idx, int field) const {
+    const int64_t i = idx * kNumFields + field;
+    return std::string_view(
+        arena_ + offsets_[i], offsets_[i + 1] - offsets_[i]);
+  }
+
+  int64_t numRows_{0};
+  // Size and modification time of the list file the index was parsed from
+  uint64_t listFileBytes_{0};
+  int64_t listFileModificationTime_{0};
+
+  // The fields of row `i` are at [offsets_[3 * i + f], offsets_[3 * i + f + 1])
+  // in the arena, for f in {id, input, target}.
+  const char* arena_{nullptr};
+  const uint64_t* offsets_{nullptr};
+  const float* inputSizes_{nullptr};
+
+  // Storage of the index when parsed
+  std::string arenaStorage_;
+  std::vector<uint64_t> offsetsStorage_;
+  std::vector<float> inputSizesStorage_;
+  // Storage of the index when mapped
+  void* mapping_{nullptr};
+  size_t mappingBytes_{0};
+};
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/speech/data/RawSound.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+namespace {
+
+constexpr const char* kPcm16Extension = ".s16";
+constexpr const char* kFloatExtension = ".f32";
+
+bool endsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+      str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Parses a non-negative integer
+std::optional<int64_t> parseOffset(const std::string& str) {
+  if (str.empty() || str.size() > 18 ||
+      str.find_first_not_of("0123456789") != std::string::npos) {
+    return std::nullopt;
+  }
+  return std::stoll(str);
+}
+
+} // namespace
+
+std::optional<RawSoundHandle> RawSoundHandle::parse(const std::string& handle) {
+  const auto bytesPos = handle.rfind(':');
+  if (bytesPos == std::string::npos || bytesPos == 0) {
+    return std::nullopt;
+  }
+  const auto offsetPos = handle.rfind(':', bytesPos - 1);
+  if (offsetPos == std::string::npos) {
+    return std::nullopt;
+  }
+  RawSoundHandle raw;
+  raw.shard = handle.substr(0, offsetPos);
+  if (endsWith(raw.shard, kPcm16Extension)) {
+    raw.type = RawSampleType::PCM_16;
+  } else if (endsWith(raw.shard, kFloatExtension)) {
+    raw.type = RawSampleType::FLOAT;
+  } else {
+    return std::nullopt;
+  }
+  auto offset =
+      parseOffset(handle.substr(offsetPos + 1, bytesPos - offsetPos - 1));
+  auto bytes = parseOffset(handle.substr(bytesPos + 1));
+  if (!offset || !bytes) {
+    return std::nullopt;
+  }
+  raw.offset = *offset;
+  raw.bytes = *bytes;
+  return raw;
+}
+
+RawSoundShard::RawSoundShard(const std::string& filename)
+    : filename_(filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(
+        "RawSoundShard - cannot open " + filename + ": " +
+        std::strerror(errno));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("RawSoundShard - cannot stat " + filename);
+  }
+  size_ = st.st_size;
+  if (size_ > 0) {
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (data_ == MAP_FAILED) {
+      data_ = nullptr;
+      ::close(fd);
+      throw std::runtime_error(
+          "RawSoundShard - cannot map " + filename + ": " +
+          std::strerror(errno));
+    }
+    // sounds are read at random offsets
+    ::madvise(data_, size_, MADV_RANDOM);
+  }
+  ::close(fd);
+}
+
+RawSoundShard::~RawSoundShard() {
+  if (data_) {
+    ::munmap(data_, size_);
+  }
+}
+
+const char* RawSoundShard::data(const RawSoundHandle& handle) const {
+  if (handle.offset < 0 || handle.bytes < 0 ||
+      static_cast<size_t>(handle.offset + handle.bytes) > size_) {
+    throw std::out_of_range(
+        "RawSoundShard - sound [" + std::to_string(handle.offset) + ", " +
+        std::to_string(handle.offset + handle.bytes) + ") is not within " +
+        filename_ + " of size " + std::to_string(size_));
+  }
+  return static_cast<const char*>(data_) + handle.offset;
+}
+
+const float* RawSoundShard::floatData(const RawSoundHandle& handle) const {
+  const char* sound = data(handle);
+  if (handle.type != RawSampleType::FLOAT ||
+      reinterpret_cast<uintptr_t>(sound) % alignof(float) != 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const float*>(sound);
+}
+
+std::vector<float> RawSoundShard::load(const RawSoundHandle& handle) const {
+  const char* sound = data(handle);
+  std::vector<float> samples(handle.frames());
+  if (handle.type == RawSampleType::FLOAT) {
+    std::memcpy(samples.data(), sound, samples.size() * sizeof(float));
+  } else {
+    // the scale of libsndfile's conversion to floats
+    constexpr float kScale = 1.0f / 0x8000;
+    for (size_t i = 0; i < samples.size(); ++i) {
+      int16_t sample;
+      std::memcpy(&sample, sound + i * sizeof(int16_t), sizeof(int16_t));
+      samples[i] = sample * kScale;
+    }
+  }
+  return samples;
+}
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
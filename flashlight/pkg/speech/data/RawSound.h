@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+enum class RawSampleType {
+  PCM_16, // Signed 16 bit little endian samples
+  FLOAT, // 32 bit little endian float samples
+};
+
+/**
+ * Handle of a sound stored as headerless mono PCM samples in a large shard
+ * file, which packs the sounds of many samples back to back:
+ *
+ *   <shard>.s16:<offset>:<bytes>  (16 bit signed samples)
+ *   <shard>.f32:<offset>:<bytes>  (32 bit float samples)
+ *
+ * where the sound is at [offset, offset + bytes) of the shard file.
+ */
+struct RawSoundHandle {
+  std::string shard;
+  int64_t offset;
+  int64_t bytes;
+  RawSampleType type;
+
+  // The raw sound handle given by `handle`, if it is one
+  static std::optional<RawSoundHandle> parse(const std::string& handle);
+
+  int64_t sampleBytes() const {
+    return type == RawSampleType::PCM_16 ? sizeof(int16_t) : sizeof(float);
+  }
+
+  int64_t frames() const {
+    return bytes / sampleBytes();
+  }
+};
+
+/**
+ * A shard file of raw sounds, memory mapped so that its sounds are read from
+ * the page cache without copies. Thread-safe.
+ */
+class RawSoundShard {
+ public:
+  explicit RawSoundShard(const std::string& filename);
+  ~RawSoundShard();
+
+  RawSoundShard(const RawSoundShard&) = delete;
+  RawSoundShard& operator=(const RawSoundShard&) = delete;
+
+  /**
+   * The samples of a sound of the shard, if they are float samples aligned
+   * for float loads; null otherwise (see `load`). Throws if the sound isn't
+   * within the shard.
+   */
+  const float* floatData(const RawSoundHandle& handle) const;
+
+  /**
+   * The samples of a sound of the shard, converted to floats in [-1, 1) as
+   * `loadSound<float>` does.
+   */
+  std::vector<float> load(const RawSoundHandle& handle) const;
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  const char* data(const RawSoundHandle& handle) const;
+
+  std::string filename_;
+  void* data_{nullptr};
+  size_t size_{0};
+};
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
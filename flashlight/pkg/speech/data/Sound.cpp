@@ -224,15 +224,27 @@ SoundInfo loadSoundInfo(std::istream& f) {
 
 template <typename T>
 std::vector<T> loadSound(const std::string& filename) {
+  SoundInfo info;
+  return loadSound<T>(filename, info);
+}
+
+template <typename T>
+std::vector<T> loadSound(std::istream& f) {
+  SoundInfo info;
+  return loadSound<T>(f, info);
+}
+
+template <typename T>
+std::vector<T> loadSound(const std::string& filename, SoundInfo& usrinfo) {
   std::ifstream f(filename);
   if (!f.is_open()) {
     throw std::runtime_error("could not open file " + filename);
   }
-  return loadSound<T>(f);
+  return loadSound<T>(f, usrinfo);
 }
 
 template <typename T>
-std::vector<T> loadSound(std::istream& f) {
+std::vector<T> loadSound(std::istream& f, SoundInfo& usrinfo) {
   SF_VIRTUAL_IO vsf = {sf_vio_ro_get_filelen,
                        sf_vio_ro_seek,
                        sf_vio_ro_read,
@@ -268,6 +280,9 @@ std::vector<T> loadSound(std::istream& f) {
   if (nframe != info.frames) {
     throw std::runtime_error("loadSound: read error");
   }
+  usrinfo.frames = info.frames;
+  usrinfo.samplerate = info.samplerate;
+  usrinfo.channels = info.channels;
   return in;
 }
 
@@ -373,6 +388,16 @@ template std::vector<double> loadSound<double>(std::istream&);
 template std::vector<int> loadSound<int>(std::istream&);
 template std::vector<short> loadSound<short>(std::istream&);
 
+template std::vector<float> loadSound(const std::string&, SoundInfo&);
+template std::vector<double> loadSound(const std::string&, SoundInfo&);
+template std::vector<int> loadSound(const std::string&, SoundInfo&);
+template std::vector<short> loadSound(const std::string&, SoundInfo&);
+
+template std::vector<float> loadSound<float>(std::istream&, SoundInfo&);
+template std::vector<double> loadSound<double>(std::istream&, SoundInfo&);
+template std::vector<int> loadSound<int>(std::istream&, SoundInfo&);
+template std::vector<short> loadSound<short>(std::istream&, SoundInfo&);
+
 template void saveSound(
     const std::string&,
     const std::vector<float>&,
@@ -83,6 +83,12 @@ std::vector<T> loadSound(std::istream& f);
 template <typename T>
 std::vector<T> loadSound(const std::string& filename);
 
+// Loads a sound and its info, opening and decoding the stream only once
+template <typename T>
+std::vector<T> loadSound(std::istream& f, SoundInfo& info);
+template <typename T>
+std::vector<T> loadSound(const std::string& filename, SoundInfo& info);
+
 template <typename T>
 void saveSound(
     std::ostream& f,
@@ -30,7 +30,7 @@ std::vector<std::string> wrd2Target(
   auto lit = lexicon.find(word);
   if (lit != lexicon.end()) {
     // sample random spelling if word has different spellings
-    if (lit->second.size() > 1 &&
+    if (lit->second.size() > 1 && targetSamplePct > 0 &&
         targetSamplePct >
             static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX)) {
       return lit->second[std::rand() % lit->second.size()];
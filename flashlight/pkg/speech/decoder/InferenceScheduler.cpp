@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/speech/decoder/InferenceScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+InferenceScheduler::InferenceScheduler(
+    fl::lib::LockFreeQueue<EmissionTargetPair>& emissionQueue,
+    const InferenceSchedulerOptions& options)
+    : emissionQueue_(emissionQueue), options_(options) {
+  if (options_.maxBatchSize < 1 || options_.bucketFrames < 1 ||
+      options_.maxPending < 1 || options_.maxWaitMsec < 0) {
+    throw std::invalid_argument("InferenceScheduler: invalid options");
+  }
+}
+
+void InferenceScheduler::add(InferenceRequest request) {
+  if (request.input.ndim() < 1 || request.input.ndim() > 4) {
+    throw std::invalid_argument(
+        "InferenceScheduler: input expected as T x FEAT x C x 1");
+  }
+  int64_t bucket = request.input.dim(0) / options_.bucketFrames;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  producerCondition_.wait(lock, [this]() {
+    return numPending_ < options_.maxPending || isAddingFinished_ ||
+        isCancelled_;
+  });
+  if (isCancelled_) {
+    throw std::runtime_error("InferenceScheduler: cancelled");
+  }
+  if (isAddingFinished_) {
+    throw std::logic_error(
+        "InferenceScheduler: add() called after finishAdding()");
+  }
+  auto now = Clock::now();
+  if (!hasArrivals_) {
+    firstArrival_ = now;
+    hasArrivals_ = true;
+  }
+  buckets_[bucket].push_back({std::move(request), now});
+  ++numPending_;
+  consumerCondition_.notify_one();
+}
+
+void InferenceScheduler::finishAdding() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  isAddingFinished_ = true;
+  consumerCondition_.notify_all();
+  producerCondition_.notify_all();
+}
+
+void InferenceScheduler::cancel() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  isCancelled_ = true;
+  buckets_.clear();
+  numPending_ = 0;
+  consumerCondition_.notify_all();
+  producerCondition_.notify_all();
+}
+
+bool InferenceScheduler::isBucketFull(
+    const std::deque<PendingRequest>& bucket) const {
+  const int64_t size = bucket.size();
+  if (size >= options_.maxBatchSize) {
+    return true;
+  }
+  if (options_.maxBatchFrames > 0) {
+    Dim maxT = 0;
+    for (const auto& pending : bucket) {
+      maxT = std::max(maxT, pending.request.input.dim(0));
+    }
+    return size * maxT >= options_.maxBatchFrames;
+  }
+  return false;
+}
+
+std::vector<InferenceScheduler::PendingRequest> InferenceScheduler::takeBatch(
+    int64_t bucket) {
+  auto it = buckets_.find(bucket);
+  auto& requests = it->second;
+  std::vector<PendingRequest> batch;
+  int64_t size = 0;
+  Dim maxT = 0;
+  while (!requests.empty() && size < options_.maxBatchSize) {
+    auto T = std::max(maxT, requests.front().request.input.dim(0));
+    if (size > 0 && options_.maxBatchFrames > 0 &&
+        (size + 1) * T > options_.maxBatchFrames) {
+      break;
+    }
+    maxT = T;
+    batch.push_back(std::move(requests.front()));
+    requests.pop_front();
+    ++size;
+  }
+  if (requests.empty()) {
+    buckets_.erase(it);
+  }
+  numPending_ -= size;
+  producerCondition_.notify_all();
+  if (numPending_ > 0) {
+    consumerCondition_.notify_one();
+  }
+  return batch;
+}
+
+std::vector<InferenceScheduler::PendingRequest>
+InferenceScheduler::nextBatch() {
+  const auto maxWait = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double, std::milli>(options_.maxWaitMsec));
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (isCancelled_) {
+      return {};
+    }
+    auto oldest = buckets_.end();
+    for (auto it = buckets_.begin(); it != buckets_.end(); ++it) {
+      if (oldest == buckets_.end() ||
+          it->second.front().arrival < oldest->second.front().arrival) {
+        oldest = it;
+      }
+    }
+    if (oldest == buckets_.end()) {
+      if (isAddingFinished_) {
+        return {};
+      }
+      consumerCondition_.wait(lock);
+      continue;
+    }
+    // The batch of the sample which waits the longest is run once its
+    // deadline has passed, even if other buckets keep filling up
+    const auto deadline = oldest->second.front().arrival + maxWait;
+    if (Clock::now() >= deadline) {
+      return takeBatch(oldest->first);
+    }
+    // Otherwise a full batch is run right away
+    for (const auto& bucket : buckets_) {
+      if (isBucketFull(bucket.second)) {
+        return takeBatch(bucket.first);
+      }
+    }
+    if (isAddingFinished_) {
+      return takeBatch(oldest->first);
+    }
+    consumerCondition_.wait_until(lock, deadline);
+  }
+}
+
+void InferenceScheduler::run(const ForwardFunction& forward) {
+  try {
+    runBatches(forward);
+  } catch (...) {
+    // don't leave producers and other forward threads waiting
+    cancel();
+    throw;
+  }
+}
+
+void InferenceScheduler::runBatches(const ForwardFunction& forward) {
+  while (true) {
+    auto batch = nextBatch();
+    if (batch.empty()) {
+      return;
+    }
+
+    // Pad all the inputs to the longest one: T x FEAT x C x B
+    Dim maxT = 0;
+    for (const auto& pending : batch) {
+      maxT = std::max(maxT, pending.request.input.dim(0));
+    }
+    std::vector<Tensor> inputs;
+    std::vector<float> inputSizes;
+    for (const auto& pending : batch) {
+      const auto& input = pending.request.input;
+      auto dims = input.shape().get();
+      dims.resize(4, 1);
+      std::vector<std::pair<int, int>> padWidths(4, {0, 0});
+      padWidths[0].second = maxT - input.dim(0);
+      inputs.push_back(fl::pad(fl::reshape(input, Shape(dims)), padWidths));
+      inputSizes.push_back(input.dim(0));
+    }
+    const int B = batch.size();
+    auto output =
+        forward(
+            fl::input(fl::concatenate(inputs, 3)),
+            Tensor::fromVector({1, B}, inputSizes))
+            .tensor();
+    if (output.ndim() > 3 || (B > 1 && output.dim(2) != B)) {
+      throw std::runtime_error(
+          "InferenceScheduler: emissions expected as N x T x B");
+    }
+
+    // Scatter the emissions, without the frames computed on padding
+    const int nTokens = output.dim(0), outT = output.dim(1);
+    auto emissions = output.toHostVector<float>();
+    for (int b = 0; b < B; ++b) {
+      auto& request = batch[b].request;
+      int nFrames = std::min<int>(
+          outT, std::ceil(static_cast<double>(outT) * inputSizes[b] / maxT));
+      auto begin = emissions.begin() + b * nTokens * outT;
+      emissionQueue_.add(
+          {EmissionUnit(
+               std::vector<float>(begin, begin + nTokens * nFrames),
+               request.sampleId,
+               nFrames,
+               nTokens),
+           std::move(request.target)});
+    }
+
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pending : batch) {
+      latencies_.push_back(
+          std::chrono::duration<double, std::milli>(now - pending.arrival)
+              .count());
+      numFrames_ += pending.request.input.dim(0);
+    }
+    numPaddedFrames_ += B * maxT;
+    ++numBatches_;
+    lastCompletion_ = now;
+  }
+}
+
+InferenceSchedulerStats InferenceScheduler::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  InferenceSchedulerStats stats;
+  stats.numSamples = latencies_.size();
+  stats.numBatches = numBatches_;
+  stats.numFrames = numFrames_;
+  stats.numPaddedFrames = numPaddedFrames_;
+  if (latencies_.empty()) {
+    return stats;
+  }
+  stats.avgBatchSize = static_cast<double>(stats.numSamples) / numBatches_;
+  auto latencies = latencies_;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    return latencies[std::min<size_t>(
+        p * latencies.size(), latencies.size() - 1)];
+  };
+  stats.p50LatencyMsec = percentile(0.5);
+  stats.p99LatencyMsec = percentile(0.99);
+  double elapsedSec =
+      std::chrono::duration<double>(lastCompletion_ - firstArrival_).count();
+  if (elapsedSec > 0) {
+    stats.samplesPerSec = stats.numSamples / elapsedSec;
+    stats.framesPerSec = stats.numFrames / elapsedSec;
+  }
+  return stats;
+}
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
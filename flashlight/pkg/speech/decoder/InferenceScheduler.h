@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "flashlight/fl/flashlight.h"
+#include "flashlight/pkg/speech/common/LockFreeQueue.h"
+#include "flashlight/pkg/speech/decoder/Defines.h"
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+struct InferenceRequest {
+  std::string sampleId;
+  Tensor input; // T x FEAT x C x 1
+  TargetUnit target;
+};
+
+struct InferenceSchedulerOptions {
+  // Maximum number of samples in a batch
+  int maxBatchSize = 16;
+  // Maximum number of (padded) input frames in a batch, -1 for no limit
+  int64_t maxBatchFrames = -1;
+  // Maximum time a sample waits for its batch to fill up before the batch is
+  // run anyway
+  double maxWaitMsec = 50;
+  // Samples are only batched with samples whose number of input frames is in
+  // the same interval of this width, to limit padding
+  int bucketFrames = 100;
+  // Maximum number of samples waiting to be forwarded; `add()` blocks beyond
+  int maxPending = 3000;
+};
+
+struct InferenceSchedulerStats {
+  int64_t numSamples = 0;
+  int64_t numBatches = 0;
+  int64_t numFrames = 0; // input frames, without padding
+  int64_t numPaddedFrames = 0; // input frames, with padding
+  double avgBatchSize = 0;
+  // From `add()` to the emission being pushed to the decoders
+  double p50LatencyMsec = 0;
+  double p99LatencyMsec = 0;
+  double samplesPerSec = 0;
+  double framesPerSec = 0;
+};
+
+/**
+ * Gathers samples into batches for the acoustic model forward pass and
+ * scatters the emissions to the decoders' queue, as `EmissionTargetPair`s.
+ *
+ * Samples are bucketed by their number of input frames. A bucket is forwarded
+ * as soon as it holds `maxBatchSize` samples (or `maxBatchFrames` frames), or
+ * when its oldest sample has waited for `maxWaitMsec`, so batching bounds the
+ * added latency. Expired samples go first, so that a bucket which keeps
+ * filling up doesn't starve the others. The emissions of a sample are trimmed
+ * to its unpadded length.
+ *
+ * If a forward pass throws, the scheduler is cancelled (see `cancel()`) so
+ * that producers and the other forward threads stop rather than wait for
+ * batches which will never be run.
+ *
+ * Sample usage:
+ *
+ *   InferenceScheduler scheduler(emissionQueue, options);
+ *
+ *   // Producer threads
+ *   scheduler.add({sampleId, input, target});
+ *   scheduler.finishAdding(); // when all producer threads joined
+ *
+ *   // Forward threads, with their own copy of the network
+ *   scheduler.run([&](const Variable& input, const Tensor& inputSizes) {
+ *     return forwardSequentialModuleWithPadMask(input, network, inputSizes);
+ *   });
+ *   emissionQueue.finishAdding(); // when all forward threads joined
+ */
+class InferenceScheduler {
+ public:
+  /**
+   * Batched forward pass: takes the input (T x FEAT x C x B) and the number of
+   * unpadded frames (1 x B), returns the emissions (N x T' x B).
+   */
+  using ForwardFunction =
+      std::function<fl::Variable(const fl::Variable&, const Tensor&)>;
+
+  InferenceScheduler(
+      fl::lib::LockFreeQueue<EmissionTargetPair>& emissionQueue,
+      const InferenceSchedulerOptions& options);
+
+  /**
+   * Queues a sample to be forwarded. Thread-safe, blocks if `maxPending`
+   * samples are waiting.
+   *
+   * @throws std::logic_error if called (or still blocked) after
+   * `finishAdding()`
+   * @throws std::runtime_error if called (or still blocked) after `cancel()`
+   */
+  void add(InferenceRequest request);
+
+  /**
+   * Signals that no more samples will be added: the remaining ones are
+   * forwarded without waiting for their batch to fill up.
+   */
+  void finishAdding();
+
+  /**
+   * Aborts the processing, e.g. when a forward thread failed: the pending
+   * samples are dropped, `add()` throws and `run()` returns once its current
+   * batch is done, in all threads.
+   */
+  void cancel();
+
+  /**
+   * Forwards batches until all the samples are processed and adding is
+   * finished, or until cancelled. Can be called from several threads
+   * concurrently. If `forward` throws, the scheduler is cancelled and the
+   * error is rethrown.
+   */
+  void run(const ForwardFunction& forward);
+
+  InferenceSchedulerStats getStats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct PendingRequest {
+    InferenceRequest request;
+    Clock::time_point arrival;
+  };
+
+  fl::lib::LockFreeQueue<EmissionTargetPair>& emissionQueue_;
+  InferenceSchedulerOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable consumerCondition_;
+  std::condition_variable producerCondition_;
+  // bucket index -> samples in arrival order
+  std::map<int64_t, std::deque<PendingRequest>> buckets_;
+  int64_t numPending_{0};
+  bool isAddingFinished_{false};
+  bool isCancelled_{false};
+
+  // stats
+  std::vector<double> latencies_;
+  int64_t numBatches_{0};
+  int64_t numFrames_{0};
+  int64_t numPaddedFrames_{0};
+  bool hasArrivals_{false};
+  Clock::time_point firstArrival_;
+  Clock::time_point lastCompletion_;
+
+  // Blocks until a batch should be run, returns an empty batch when done
+  std::vector<PendingRequest> nextBatch();
+
+  // Runs batches until done, see `run()`
+  void runBatches(const ForwardFunction& forward);
+
+  bool isBucketFull(const std::deque<PendingRequest>& bucket) const;
+
+  // Removes the first samples of a bucket which fit in a batch
+  std::vector<PendingRequest> takeBatch(int64_t bucket);
+};
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
@@ -125,7 +125,13 @@ std::shared_ptr<fl::Dataset> createDataset(
 #endif
     } else {
       curListDs = std::make_shared<ListFileDataset>(
-          rootDir / path, inputTransform, targetTransform, wordTransform);
+          rootDir / path,
+          inputTransform,
+          targetTransform,
+          wordTransform,
+          FLAGS_list_index_cache_dir,
+          0,
+          FLAGS_list_encode_targets && FLAGS_sampletarget <= 0);
     }
 
     allListDs.emplace_back(curListDs);
@@ -58,7 +58,9 @@ std::vector<std::string> readSampleIds(const Tensor& arr);
 
 /*
  * Utility function for creating a w2l dataset.
- * From gflags it uses FLAGS_everstoredb and FLAGS_memcache
+ * From gflags it uses FLAGS_everstoredb, FLAGS_memcache,
+ * FLAGS_list_index_cache_dir, FLAGS_list_encode_targets and
+ * FLAGS_sampletarget
  * @param inputTransform - a function to featurize input
  * @param targetTransform - a function to featurize target
  * @param wordTransform - a function to featurize words
@@ -0,0 +1,590 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/speech/streaming/StreamingEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flashlight/fl/contrib/modules/modules.h"
+#include "flashlight/fl/nn/Utils.h"
+#include "flashlight/fl/tensor/Index.h"
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+namespace detail {
+
+/**
+ * Streaming counterpart of a module: consumes the frames of a chunk and
+ * returns the output frames which can be computed from them and from the
+ * context kept from the previous chunks.
+ */
+class StreamingStage {
+ public:
+  virtual ~StreamingStage() = default;
+
+  /**
+   * @param input the next frames, possibly empty
+   * @param last whether the utterance ends with `input`: all remaining frames
+   * are returned and the state is reset
+   */
+  virtual Variable step(const Variable& input, bool last) = 0;
+
+  virtual void reset() {}
+};
+
+} // namespace detail
+
+namespace {
+
+using detail::StreamingStage;
+
+std::unique_ptr<StreamingStage> makeStage(
+    const std::shared_ptr<Module>& module,
+    int& timeDim,
+    int maxAttentionContext);
+
+template <typename T>
+bool isA(const std::shared_ptr<Module>& module) {
+  return std::dynamic_pointer_cast<T>(module) != nullptr;
+}
+
+Variable detach(const Variable& x) {
+  return x.isEmpty() ? Variable() : fl::noGrad(x.tensor());
+}
+
+int timeSize(const Variable& x, int timeDim) {
+  if (x.isEmpty()) {
+    return 0;
+  }
+  return timeDim < x.ndim() ? x.dim(timeDim) : 1;
+}
+
+Variable sliceTime(const Variable& x, int begin, int end, int timeDim) {
+  if (begin >= end) {
+    return Variable();
+  }
+  if (begin == 0 && end == timeSize(x, timeDim)) {
+    return x;
+  }
+  std::vector<fl::Index> idx(x.ndim(), fl::span);
+  idx[timeDim] = fl::range(begin, end);
+  return x(idx);
+}
+
+Variable concatTime(const Variable& a, const Variable& b, int timeDim) {
+  if (a.isEmpty()) {
+    return b;
+  }
+  if (b.isEmpty()) {
+    return a;
+  }
+  return concatenate({a, b}, timeDim);
+}
+
+// `n` frames filled with `value`, shaped as the frames of `frame`
+Variable makeFrames(
+    const Shape& frame,
+    fl::dtype type,
+    int timeDim,
+    int n,
+    double value) {
+  if (n <= 0) {
+    return Variable();
+  }
+  std::vector<Dim> dims = frame.get();
+  while (static_cast<int>(dims.size()) <= timeDim) {
+    dims.push_back(1);
+  }
+  dims[timeDim] = n;
+  return fl::noGrad(fl::full(Shape(dims), value, type));
+}
+
+std::string unsupported(const Module& module, const std::string& reason) {
+  return "StreamingEncoder: can't stream '" + module.prettyString() +
+      "': " + reason;
+}
+
+// Modules which compute every output frame from the same input frame only
+class FramewiseStage : public StreamingStage {
+ public:
+  FramewiseStage(std::shared_ptr<Module> module, int inTimeDim, int outTimeDim)
+      : module_(std::move(module)),
+        inTimeDim_(inTimeDim),
+        outTimeDim_(outTimeDim) {}
+
+  Variable step(const Variable& input, bool /* last */) override {
+    if (input.isEmpty()) {
+      return Variable();
+    }
+    auto output = module_->forward({input}).front();
+    if (timeSize(output, outTimeDim_) != timeSize(input, inTimeDim_)) {
+      throw std::invalid_argument(
+          unsupported(*module_, "it changes the number of frames"));
+    }
+    return output;
+  }
+
+ private:
+  std::shared_ptr<Module> module_;
+  int inTimeDim_;
+  int outTimeDim_;
+};
+
+class SequentialStage : public StreamingStage {
+ public:
+  SequentialStage(
+      const std::vector<std::shared_ptr<Module>>& modules,
+      int& timeDim,
+      int maxAttentionContext) {
+    for (const auto& module : modules) {
+      stages_.push_back(makeStage(module, timeDim, maxAttentionContext));
+    }
+  }
+
+  Variable step(const Variable& input, bool last) override {
+    auto output = input;
+    for (auto& stage : stages_) {
+      output = stage->step(output, last);
+    }
+    return output;
+  }
+
+  void reset() override {
+    for (auto& stage : stages_) {
+      stage->reset();
+    }
+  }
+
+ private:
+  std::vector<std::unique_ptr<StreamingStage>> stages_;
+};
+
+/**
+ * Convolution over time (first dimension). The input is seen as one stream
+ * [left padding, frames..., right padding] whose frames are kept until all
+ * the outputs reading them have been computed. The module is run on the
+ * frames covering the new outputs and the outputs reading its own padding are
+ * dropped.
+ */
+class ConvStage : public StreamingStage {
+ public:
+  ConvStage(std::shared_ptr<Module> module, const Conv2D& conv)
+      : module_(std::move(module)) {
+    int filter = conv.getXFilter(), dilation = conv.getXDilation();
+    int pad = conv.getXPad();
+    stride_ = conv.getXStride();
+    extent_ = (filter - 1) * dilation + 1;
+    if (pad == static_cast<int>(PaddingMode::SAME) && stride_ != 1) {
+      throw std::invalid_argument(unsupported(
+          conv, "'SAME' padding of a strided convolution depends on the size"));
+    }
+    pad = fl::derivePadding(extent_, filter, stride_, pad, dilation);
+    // output `o` of the module reads its input from `o * stride - offset_`
+    offset_ = pad;
+    leftPad_ = pad;
+    rightPad_ = pad;
+    if (auto asym = dynamic_cast<const AsymmetricConv1D*>(&conv)) {
+      // as in AsymmetricConv1D::forward: pad by `pad + cut` on both sides and
+      // drop `2 * cut` outputs on one of them
+      float futurePart = asym->getFuturePart();
+      int cut = std::abs(2 * (0.5 - futurePart)) * pad;
+      if (cut > 0 && stride_ != 1) {
+        throw std::invalid_argument(
+            unsupported(conv, "strided asymmetric convolution"));
+      }
+      if (futurePart < 0.5) {
+        offset_ = pad + cut;
+        rightPad_ = pad - cut;
+      } else if (futurePart > 0.5) {
+        offset_ = pad - cut;
+        rightPad_ = pad + cut;
+      }
+      leftPad_ = offset_;
+    }
+    // frames before the stream so that the module outputs are aligned with
+    // the stride of the stream
+    lead_ = (stride_ - offset_ % stride_) % stride_;
+  }
+
+  Variable step(const Variable& input, bool last) override {
+    if (!input.isEmpty()) {
+      if (!started_) {
+        frame_ = input.shape();
+        type_ = input.type();
+        buffer_ = makeFrames(frame_, type_, 0, lead_ + leftPad_, 0.0);
+        bufferStart_ = -lead_;
+        streamSize_ = leftPad_;
+        started_ = true;
+      }
+      buffer_ = concatTime(buffer_, detach(input), 0);
+      streamSize_ += input.dim(0);
+    }
+    if (last && started_) {
+      buffer_ =
+          concatTime(buffer_, makeFrames(frame_, type_, 0, rightPad_, 0.0), 0);
+      streamSize_ += rightPad_;
+    }
+
+    Variable output;
+    int numOutputs =
+        streamSize_ >= extent_ ? (streamSize_ - extent_) / stride_ + 1 : 0;
+    if (numOutputs > nextOutput_) {
+      int windowStart = nextOutput_ * stride_ - lead_;
+      int windowEnd = (numOutputs - 1) * stride_ + extent_;
+      auto window = sliceTime(
+          buffer_, windowStart - bufferStart_, windowEnd - bufferStart_, 0);
+      auto result = module_->forward({window}).front();
+      int first = (lead_ + offset_) / stride_;
+      output =
+          sliceTime(result, first, first + numOutputs - nextOutput_, 0);
+
+      nextOutput_ = numOutputs;
+      int newStart = nextOutput_ * stride_ - lead_;
+      buffer_ = sliceTime(
+          buffer_, newStart - bufferStart_, timeSize(buffer_, 0), 0);
+      bufferStart_ = newStart;
+    }
+    if (last) {
+      reset();
+    }
+    return output;
+  }
+
+  void reset() override {
+    buffer_ = Variable();
+    started_ = false;
+    bufferStart_ = 0;
+    streamSize_ = 0;
+    nextOutput_ = 0;
+  }
+
+ private:
+  std::shared_ptr<Module> module_;
+  int stride_, extent_, offset_, leftPad_, rightPad_, lead_;
+
+  bool started_{false};
+  Shape frame_;
+  fl::dtype type_{fl::dtype::f32};
+  // frames of the stream from position `bufferStart_`
+  Variable buffer_;
+  int bufferStart_{0};
+  int streamSize_{0};
+  int nextOutput_{0};
+};
+
+// Padding along time is added at the start and at the end of the utterance
+class PaddingStage : public StreamingStage {
+ public:
+  PaddingStage(const Padding& padding, int timeDim)
+      : pad_(padding.getPadding()),
+        value_(padding.getPaddingValue()),
+        timeDim_(timeDim) {
+    if (timeDim_ < static_cast<int>(pad_.size())) {
+      timePad_ = pad_[timeDim_];
+      pad_[timeDim_] = {0, 0};
+    }
+    for (const auto& p : pad_) {
+      hasOtherPad_ = hasOtherPad_ || p.first != 0 || p.second != 0;
+    }
+  }
+
+  Variable step(const Variable& input, bool last) override {
+    Variable output;
+    if (!input.isEmpty()) {
+      output = hasOtherPad_ ? fl::padding(input, pad_, value_) : input;
+      if (!started_) {
+        frame_ = output.shape();
+        type_ = output.type();
+        started_ = true;
+        output = concatTime(
+            makeFrames(frame_, type_, timeDim_, timePad_.first, value_),
+            output,
+            timeDim_);
+      }
+    }
+    if (last && started_) {
+      output = concatTime(
+          output,
+          makeFrames(frame_, type_, timeDim_, timePad_.second, value_),
+          timeDim_);
+    }
+    if (last) {
+      reset();
+    }
+    return output;
+  }
+
+  void reset() override {
+    started_ = false;
+  }
+
+ private:
+  std::vector<std::pair<int, int>> pad_;
+  std::pair<int, int> timePad_{0, 0};
+  bool hasOtherPad_{false};
+  double value_;
+  int timeDim_;
+
+  bool started_{false};
+  Shape frame_;
+  fl::dtype type_{fl::dtype::f32};
+};
+
+// The residual input of the convolution is delayed by its right context
+class TDSStage : public StreamingStage {
+ public:
+  TDSStage(const TDSBlock& block, int maxAttentionContext) {
+    int timeDim = 0;
+    for (const auto& module : block.modules()) {
+      stages_.push_back(makeStage(module, timeDim, maxAttentionContext));
+    }
+    if (stages_.size() != 4 || timeDim != 0) {
+      throw std::invalid_argument(unsupported(block, "unexpected layout"));
+    }
+  }
+
+  Variable step(const Variable& input, bool last) override {
+    residual_ = concatTime(residual_, detach(input), 0);
+    auto output = stages_[0]->step(input, last);
+    int size = timeSize(output, 0);
+    if (size > 0) {
+      output = output.astype(residual_.type()) +
+          sliceTime(residual_, 0, size, 0);
+      residual_ = sliceTime(residual_, size, timeSize(residual_, 0), 0);
+    }
+    output = stages_[1]->step(output, last);
+    auto fc = stages_[2]->step(output, last);
+    if (!fc.isEmpty()) {
+      output = fc.astype(output.type()) + output;
+    }
+    output = stages_[3]->step(output, last);
+    if (last) {
+      residual_ = Variable();
+    }
+    return output;
+  }
+
+  void reset() override {
+    residual_ = Variable();
+    for (auto& stage : stages_) {
+      stage->reset();
+    }
+  }
+
+ private:
+  std::vector<std::unique_ptr<StreamingStage>> stages_;
+  Variable residual_;
+};
+
+class RnnStage : public StreamingStage {
+ public:
+  explicit RnnStage(std::shared_ptr<RNN> rnn) : rnn_(std::move(rnn)) {}
+
+  Variable step(const Variable& input, bool last) override {
+    Variable output;
+    if (!input.isEmpty()) {
+      auto outputs = rnn_->forward({input, hidden_, cell_});
+      output = outputs[0];
+      hidden_ = detach(outputs[1]);
+      cell_ = detach(outputs[2]);
+    }
+    if (last) {
+      reset();
+    }
+    return output;
+  }
+
+  void reset() override {
+    hidden_ = Variable();
+    cell_ = Variable();
+  }
+
+ private:
+  std::shared_ptr<RNN> rnn_;
+  Variable hidden_, cell_;
+};
+
+// Causal self-attention over the inputs of the previous chunks
+class TransformerStage : public StreamingStage {
+ public:
+  TransformerStage(std::shared_ptr<Transformer> transformer, int maxContext)
+      : transformer_(std::move(transformer)),
+        maxContext_(
+            maxContext < 0 ? std::numeric_limits<int>::max() : maxContext) {
+    if (transformer_->getBptt() > 0) {
+      maxContext_ = std::min(maxContext_, transformer_->getBptt() - 1);
+    }
+  }
+
+  Variable step(const Variable& input, bool last) override {
+    Variable output;
+    if (!input.isEmpty()) {
+      if (cache_.isEmpty()) {
+        output = transformer_->forward({input, Variable()}).front();
+      } else {
+        output = transformer_->forward({cache_, input, Variable()}).front();
+      }
+      auto cache = concatTime(cache_, detach(input), 1);
+      int size = timeSize(cache, 1);
+      cache_ = sliceTime(cache, std::max(size - maxContext_, 0), size, 1);
+    }
+    if (last) {
+      reset();
+    }
+    return output;
+  }
+
+  void reset() override {
+    cache_ = Variable();
+  }
+
+ private:
+  std::shared_ptr<Transformer> transformer_;
+  int maxContext_;
+  Variable cache_;
+};
+
+std::unique_ptr<StreamingStage> makeStage(
+    const std::shared_ptr<Module>& module,
+    int& timeDim,
+    int maxAttentionContext) {
+  if (auto seq = std::dynamic_pointer_cast<Sequential>(module)) {
+    return std::make_unique<SequentialStage>(
+        seq->modules(), timeDim, maxAttentionContext);
+  }
+  if (isA<Conformer>(module)) {
+    throw std::invalid_argument(unsupported(
+        *module, "its convolution and attention over time aren't causal"));
+  }
+  if (auto tds = std::dynamic_pointer_cast<TDSBlock>(module)) {
+    if (timeDim != 0) {
+      throw std::invalid_argument(
+          unsupported(*module, "time should be the first dimension"));
+    }
+    return std::make_unique<TDSStage>(*tds, maxAttentionContext);
+  }
+
+  auto conv = std::dynamic_pointer_cast<Conv2D>(module);
+  if (auto wn = std::dynamic_pointer_cast<WeightNorm>(module)) {
+    conv = std::dynamic_pointer_cast<Conv2D>(wn->module());
+    if (!conv && !isA<Linear>(wn->module())) {
+      throw std::invalid_argument(unsupported(*module, "unsupported module"));
+    }
+  }
+  if (conv) {
+    if (timeDim != 0) {
+      throw std::invalid_argument(
+          unsupported(*module, "time should be the first dimension"));
+    }
+    return std::make_unique<ConvStage>(module, *conv);
+  }
+  if (auto padding = std::dynamic_pointer_cast<Padding>(module)) {
+    return std::make_unique<PaddingStage>(*padding, timeDim);
+  }
+  if (auto rnn = std::dynamic_pointer_cast<RNN>(module)) {
+    if (rnn->isBidirectional()) {
+      throw std::invalid_argument(
+          unsupported(*module, "bidirectional RNN needs the future"));
+    }
+    if (timeDim != 2) {
+      throw std::invalid_argument(
+          unsupported(*module, "time should be the third dimension"));
+    }
+    return std::make_unique<RnnStage>(rnn);
+  }
+  if (auto transformer = std::dynamic_pointer_cast<Transformer>(module)) {
+    if (!transformer->getUseMask()) {
+      throw std::invalid_argument(
+          unsupported(*module, "attention without mask needs the future"));
+    }
+    if (timeDim != 1) {
+      throw std::invalid_argument(
+          unsupported(*module, "time should be the second dimension"));
+    }
+    return std::make_unique<TransformerStage>(
+        transformer, maxAttentionContext);
+  }
+
+  int inTimeDim = timeDim;
+  if (auto ln = std::dynamic_pointer_cast<LayerNorm>(module)) {
+    auto axis = ln->getAxis();
+    if (std::find(axis.begin(), axis.end(), timeDim) != axis.end()) {
+      throw std::invalid_argument(
+          unsupported(*module, "normalization over time needs the future"));
+    }
+  } else if (auto view = std::dynamic_pointer_cast<View>(module)) {
+    // time is the dimension which is kept (0) or inferred (-1)
+    auto dims = view->getDims();
+    if (timeDim >= dims.ndim() || dims[timeDim] != 0) {
+      timeDim = -1;
+      for (int i = 0; i < dims.ndim(); ++i) {
+        if (dims[i] == -1) {
+          timeDim = i;
+        }
+      }
+      if (timeDim < 0) {
+        throw std::invalid_argument(
+            unsupported(*module, "the size of time should be 0 or -1"));
+      }
+    }
+  } else if (auto reorder = std::dynamic_pointer_cast<Reorder>(module)) {
+    auto shape = reorder->getShape();
+    for (int i = 0; i < shape.ndim(); ++i) {
+      if (shape[i] == inTimeDim) {
+        timeDim = i;
+      }
+    }
+  } else if (
+      !isA<Linear>(module) && !isA<WeightNorm>(module) &&
+      !isA<Dropout>(module) && !isA<BatchNorm>(module) &&
+      !isA<Identity>(module) && !isA<PrecisionCast>(module) &&
+      !isA<SpecAugment>(module) && !isA<Sigmoid>(module) &&
+      !isA<Log>(module) && !isA<Tanh>(module) && !isA<HardTanh>(module) &&
+      !isA<ReLU>(module) && !isA<ReLU6>(module) && !isA<LeakyReLU>(module) &&
+      !isA<PReLU>(module) && !isA<ELU>(module) &&
+      !isA<ThresholdReLU>(module) && !isA<GatedLinearUnit>(module) &&
+      !isA<LogSoftmax>(module) && !isA<Swish>(module)) {
+    throw std::invalid_argument(unsupported(*module, "unsupported module"));
+  }
+  return std::make_unique<FramewiseStage>(module, inTimeDim, timeDim);
+}
+
+} // namespace
+
+StreamingEncoder::StreamingEncoder(
+    std::shared_ptr<fl::Module> network,
+    int maxAttentionContext /* = -1 */)
+    : network_(std::move(network)), outputTimeDim_(0) {
+  network_->eval();
+  stage_ = makeStage(network_, outputTimeDim_, maxAttentionContext);
+}
+
+StreamingEncoder::~StreamingEncoder() = default;
+
+Tensor StreamingEncoder::accept(const Tensor& features) {
+  return stage_->step(fl::noGrad(features), false).tensor();
+}
+
+Tensor StreamingEncoder::finish() {
+  return stage_->step(Variable(), true).tensor();
+}
+
+void StreamingEncoder::reset() {
+  stage_->reset();
+}
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
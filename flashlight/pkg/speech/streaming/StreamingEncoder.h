@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "flashlight/fl/flashlight.h"
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+namespace detail {
+class StreamingStage;
+} // namespace detail
+
+/**
+ * Runs an acoustic model on consecutive chunks of input features and returns
+ * the network output (emissions) for the frames whose receptive field has been
+ * fully seen, so the latency of a chunk doesn't grow with the utterance.
+ *
+ * Each module keeps the left context it needs between calls: convolutions
+ * keep their last input frames, `Transformer` layers attend to the inputs of
+ * the previous chunks and RNNs carry their hidden state. The concatenated
+ * outputs are the same as the ones of a forward pass on the whole utterance
+ * (without padding mask, as for a batch of one).
+ *
+ * Supported modules are:
+ * - `Sequential`
+ * - `Conv2D` and `AsymmetricConv1D` (also under `WeightNorm`) convolving over
+ *   time along the first dimension, time `Padding`
+ * - `TDSBlock` created with `lNormIncludeTime = false`
+ * - unidirectional `RNN` and `Transformer` with `useMask`
+ * - modules processing every frame independently: `Linear`, activations,
+ *   `Dropout`, `BatchNorm`, `LayerNorm` not over time, `SpecAugment`,
+ *   `View`, `Reorder`, ...
+ *
+ * Other modules throw `std::invalid_argument` at construction, including
+ * `Conformer` and bidirectional RNNs, whose outputs depend on future frames.
+ */
+class StreamingEncoder {
+ public:
+  /**
+   * @param network the acoustic model; it is put into eval mode. Input
+   * features are expected as T x FEAT x C (x 1), with time along the first
+   * dimension.
+   * @param maxAttentionContext the number of previous frames a `Transformer`
+   * layer attends to, -1 for the whole utterance (up to the size of the
+   * positional embedding)
+   */
+  explicit StreamingEncoder(
+      std::shared_ptr<fl::Module> network,
+      int maxAttentionContext = -1);
+
+  ~StreamingEncoder();
+
+  /**
+   * Feeds the next chunk of features and returns the network output for the
+   * frames completed by it, concatenated along `outputTimeDim()`. The output
+   * is empty if no frame can be computed yet.
+   */
+  Tensor accept(const Tensor& features);
+
+  /**
+   * Signals the end of the utterance: returns the output for the remaining
+   * frames (which need the right padding of the network) and resets the state
+   * for the next utterance.
+   */
+  Tensor finish();
+
+  void reset();
+
+  /**
+   * The dimension of time in the network output.
+   */
+  int outputTimeDim() const {
+    return outputTimeDim_;
+  }
+
+ private:
+  std::shared_ptr<fl::Module> network_;
+  std::unique_ptr<detail::StreamingStage> stage_;
+  int outputTimeDim_;
+};
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/speech/streaming/StreamingFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/pkg/speech/audio/feature/Mfcc.h"
+#include "flashlight/pkg/speech/audio/feature/Mfsc.h"
+
+using namespace fl::lib::audio;
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+StreamingFeatures::StreamingFeatures(
+    const FeatureParams& params,
+    const FeatureType& featureType,
+    const std::pair<int, int>& localNormCtx)
+    : params_(params), featSz_(1), localNormCtx_(localNormCtx) {
+  if (localNormCtx_.first < 0 || localNormCtx_.second < 0 ||
+      (localNormCtx_.first == 0 && localNormCtx_.second == 0)) {
+    throw std::invalid_argument(
+        "StreamingFeatures: utterance level normalization can't be computed "
+        "incrementally, a local normalization context is required");
+  }
+  if ((featureType == FeatureType::MFSC || featureType == FeatureType::MFCC) &&
+      (params_.deltaWindow > 0 || params_.accWindow > 0)) {
+    throw std::invalid_argument(
+        "StreamingFeatures: feature derivatives are not supported");
+  }
+  if (featureType == FeatureType::POW_SPECTRUM) {
+    featurizer_ = std::make_shared<PowerSpectrum>(params_);
+    featSz_ = params_.powSpecFeatSz();
+  } else if (featureType == FeatureType::MFSC) {
+    featurizer_ = std::make_shared<Mfsc>(params_);
+    featSz_ = params_.mfscFeatSz();
+  } else if (featureType == FeatureType::MFCC) {
+    featurizer_ = std::make_shared<Mfcc>(params_);
+    featSz_ = params_.mfccFeatSz();
+  }
+}
+
+Tensor StreamingFeatures::accept(const std::vector<float>& samples) {
+  samples_.insert(samples_.end(), samples.begin(), samples.end());
+  if (!featurizer_) {
+    // raw audio: every sample is a frame
+    for (auto sample : samples_) {
+      frames_.push_back({sample});
+    }
+    numFrames_ += samples_.size();
+    samples_.clear();
+    return normalizeFrames(false);
+  }
+
+  auto nFrames = params_.numFrames(samples_.size());
+  if (nFrames > 0) {
+    auto stride = params_.numFrameStrideSamples();
+    std::vector<float> signal(
+        samples_.begin(),
+        samples_.begin() + (nFrames - 1) * stride +
+            params_.numFrameSizeSamples());
+    auto feat = featurizer_->apply(signal);
+    for (int64_t f = 0; f < nFrames; ++f) {
+      frames_.emplace_back(
+          feat.begin() + f * featSz_, feat.begin() + (f + 1) * featSz_);
+    }
+    numFrames_ += nFrames;
+    samples_.erase(samples_.begin(), samples_.begin() + nFrames * stride);
+  }
+  return normalizeFrames(false);
+}
+
+Tensor StreamingFeatures::finish() {
+  // samples which don't fill a frame are dropped, as in `inputFeatures`
+  auto output = normalizeFrames(true);
+  reset();
+  return output;
+}
+
+void StreamingFeatures::reset() {
+  samples_.clear();
+  frames_.clear();
+  framesStart_ = 0;
+  nextFrame_ = 0;
+  numFrames_ = 0;
+}
+
+Tensor StreamingFeatures::normalizeFrames(bool last) {
+  int64_t leftCtx = localNormCtx_.first, rightCtx = localNormCtx_.second;
+  int64_t end = last ? numFrames_ : numFrames_ - rightCtx;
+  if (nextFrame_ >= end) {
+    return Tensor();
+  }
+
+  // Same computation (and summation order) as `localNormalize`
+  int64_t nOut = end - nextFrame_;
+  std::vector<float> output(nOut * featSz_);
+  for (int64_t j = nextFrame_; j < end; ++j) {
+    auto start = std::max(j - leftCtx, 0L) - framesStart_;
+    auto stop = std::min(j + rightCtx, numFrames_ - 1) - framesStart_;
+    float sum = 0.0, sum2 = 0.0;
+    for (int f = 0; f < featSz_; ++f) {
+      for (auto t = start; t <= stop; ++t) {
+        float x = frames_[t][f];
+        sum += x;
+        sum2 += x * x;
+      }
+    }
+    int64_t N = (stop - start + 1) * featSz_;
+    sum /= N;
+    sum2 /= N;
+    sum2 -= (sum * sum);
+    sum2 = std::sqrt(sum2);
+    const auto& frame = frames_[j - framesStart_];
+    for (int f = 0; f < featSz_; ++f) {
+      // FRAMES X FEAT (Col Major)
+      float& out = output[f * nOut + j - nextFrame_];
+      out = frame[f] - sum;
+      if (sum2 > 0.0) {
+        out /= sum2;
+      }
+    }
+  }
+  nextFrame_ = end;
+
+  // keep the left context of the next frame to normalize
+  while (framesStart_ < nextFrame_ - leftCtx) {
+    frames_.pop_front();
+    ++framesStart_;
+  }
+  return Tensor::fromBuffer(
+      {nOut, featSz_, 1}, output.data(), MemoryLocation::Host);
+}
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
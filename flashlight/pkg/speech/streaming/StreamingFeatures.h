@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "flashlight/fl/tensor/TensorBase.h"
+#include "flashlight/pkg/speech/audio/feature/FeatureParams.h"
+#include "flashlight/pkg/speech/audio/feature/PowerSpectrum.h"
+#include "flashlight/pkg/speech/data/FeatureTransforms.h"
+
+namespace fl {
+namespace pkg {
+namespace speech {
+
+/**
+ * Computes the input features of `inputFeatures()` incrementally from
+ * consecutive chunks of single channel audio.
+ *
+ * Samples which do not fill a frame yet are kept until the next chunk, so the
+ * frames (and features) are the same as the ones computed on the whole
+ * utterance. Features are normalized with `localNormalize()`: a frame is
+ * returned once `localNormCtx.second` frames after it have been seen, or at
+ * `finish()`. Utterance level normalization and feature derivatives need the
+ * future of the signal and are not supported.
+ */
+class StreamingFeatures {
+ public:
+  StreamingFeatures(
+      const lib::audio::FeatureParams& params,
+      const FeatureType& featureType,
+      const std::pair<int, int>& localNormCtx);
+
+  /**
+   * Consumes the next audio samples and returns the features of the frames
+   * completed by them as a FRAMES x FEAT x 1 tensor, or an empty tensor if no
+   * frame is complete yet.
+   */
+  Tensor accept(const std::vector<float>& samples);
+
+  /**
+   * Returns the features of the remaining frames at the end of the utterance
+   * and resets the state for the next one.
+   */
+  Tensor finish();
+
+  void reset();
+
+  int featureSize() const {
+    return featSz_;
+  }
+
+ private:
+  lib::audio::FeatureParams params_;
+  std::shared_ptr<lib::audio::PowerSpectrum> featurizer_;
+  int featSz_;
+  std::pair<int, int> localNormCtx_;
+
+  // samples not consumed by a frame yet
+  std::vector<float> samples_;
+  // featurized frames still needed for normalization, starting at frame
+  // `framesStart_`
+  std::deque<std::vector<float>> frames_;
+  int64_t framesStart_{0};
+  // index of the next frame to normalize and the number of frames seen
+  int64_t nextFrame_{0};
+  int64_t numFrames_{0};
+
+  Tensor normalizeFrames(bool last);
+};
+
+} // namespace speech
+} // namespace pkg
+} // namespace fl
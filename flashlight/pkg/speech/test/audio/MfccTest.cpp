@@ -173,6 +173,32 @@ TEST(MfccTest, BatchingTest2) {
   }
 }
 
+TEST(MfccTest, BlockwiseTest) {
+  // Long enough for the frames to be featurized in several blocks
+  int Tmax = 64000;
+  auto input = randVec<float>(Tmax);
+  FeatureParams featparams;
+  featparams.deltaWindow = 0;
+  featparams.accWindow = 0;
+  Mfsc mfsc(featparams);
+  Mfcc mfcc(featparams);
+
+  for (PowerSpectrum* feature : std::vector<PowerSpectrum*>{&mfsc, &mfcc}) {
+    auto output = feature->apply(input.data(), input.size());
+    ASSERT_EQ(output.size(), feature->outputSize(Tmax));
+    ASSERT_EQ(output, feature->apply(input));
+    // 64, 65 and 128 frames, so that the last frame of the prefix is at the
+    // end or the beginning of a block
+    for (int curSz : {10480, 10640, 20720, 30000}) {
+      auto curOutput = feature->apply(input.data(), curSz);
+      ASSERT_EQ(curOutput.size(), feature->outputSize(curSz));
+      for (int j = 0; j < curOutput.size(); ++j) {
+        ASSERT_NEAR(curOutput[j], output[j], 1E-4);
+      }
+    }
+  }
+}
+
 TEST(MfccTest, EmptyTest) {
   std::vector<float> input;
   FeatureParams featparams;
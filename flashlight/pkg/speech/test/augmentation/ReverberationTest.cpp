@@ -8,6 +8,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <random>
+
+#include "flashlight/pkg/speech/augmentation/Convolution.h"
 #include "flashlight/pkg/speech/augmentation/Reverberation.h"
 #include "flashlight/pkg/speech/augmentation/SoundEffectUtil.h"
 #include "flashlight/fl/tensor/Init.h"
@@ -115,6 +119,94 @@ TEST(ReverbEcho, SinWaveReverb) {
   EXPECT_THAT(noiseMain, Pointwise(FloatNearPointwise(0.1), noiseSrc));
 }
 
+namespace {
+
+// The time domain implementation ReverbEcho used to have, drawing the same
+// random numbers
+void referenceReverb(
+    const ReverbEcho::Config& conf,
+    unsigned int seed,
+    std::vector<float>& source) {
+  RandomNumberGenerator rng(seed);
+  rng.random();
+  float initial = rng.uniform(conf.initialMin_, conf.initialMax_);
+  float firstDelay = rng.uniform(conf.firstDelayMin_, conf.firstDelayMax_);
+  float rt60 = rng.uniform(conf.rt60Min_, conf.rt60Max_);
+
+  size_t length = source.size();
+  std::vector<float> reverb(length, 0);
+  for (int i = 0; i < conf.repeat_; ++i) {
+    float frac = 1;
+    while (frac > 1e-3) {
+      float jitter = 1 + rng.uniform(-conf.jitter_, conf.jitter_);
+      size_t delay = 1 + int(jitter * firstDelay * conf.sampleRate_);
+      if (delay > length - 1) {
+        break;
+      }
+      for (int j = 0; j < length - delay - 1; ++j) {
+        reverb[delay + j] += source[j] * initial * frac;
+      }
+      jitter = 1 + rng.uniform(-conf.jitter_, conf.jitter_);
+      frac *= std::pow(10, -3 * jitter * firstDelay / rt60);
+    }
+  }
+  for (int i = 0; i < length; ++i) {
+    source[i] += reverb[i];
+  }
+}
+
+std::vector<float> randomSignal(size_t size, unsigned int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1, 1);
+  std::vector<float> signal(size);
+  for (auto& x : signal) {
+    x = dist(gen);
+  }
+  return signal;
+}
+
+} // namespace
+
+/**
+ * Test that the time domain and FFT paths give the reverb of the original
+ * implementation: many echoes (default config) and a few echoes (short rt60).
+ */
+TEST(ReverbEcho, MatchesTimeDomainReverb) {
+  const unsigned int seed = 1234;
+  ReverbEcho::Config manyEchoes;
+  ReverbEcho::Config fewEchoes;
+  fewEchoes.rt60Min_ = 0.02;
+  fewEchoes.rt60Max_ = 0.05;
+  for (const auto& conf : {manyEchoes, fewEchoes}) {
+    auto signal = randomSignal(sampleRate, seed);
+    auto expected = signal;
+    referenceReverb(conf, seed, expected);
+
+    ReverbEcho sfx(conf, seed);
+    sfx.apply(signal);
+    EXPECT_THAT(signal, Pointwise(FloatNearPointwise(1e-4), expected));
+  }
+}
+
+TEST(ReverbEcho, FftConvolve) {
+  auto signal = randomSignal(1000, 1);
+  for (size_t kernelSize : {1, 7, 300, 1500}) {
+    auto kernel = randomSignal(kernelSize, 2);
+    std::vector<float> expected(signal.size(), 0);
+    for (size_t i = 0; i < signal.size(); ++i) {
+      for (size_t k = 0; k < kernelSize && k <= i; ++k) {
+        expected[i] += signal[i - k] * kernel[k];
+      }
+    }
+    for (size_t blockSize : {0, 1, 64, 5000}) {
+      auto output = fftConvolve(signal, kernel, blockSize);
+      EXPECT_THAT(output, Pointwise(FloatNearPointwise(1e-3), expected));
+    }
+  }
+  EXPECT_TRUE(fftConvolve({}, {1, 2}).empty());
+  EXPECT_EQ(fftConvolve({1, 2}, {}), (std::vector<float>{0, 0}));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/fl/tensor/Init.h"
+#include "flashlight/pkg/speech/augmentation/SoundBank.h"
+#include "flashlight/pkg/speech/data/Sound.h"
+
+using namespace ::fl::pkg::speech::sfx;
+using ::fl::pkg::speech::saveSound;
+
+namespace {
+
+const size_t sampleRate = 16000;
+
+const fs::path tmpDir = fs::temp_directory_path() / "SoundBank";
+
+// Writes a flac file of `size` samples of value `amplitude`
+std::string writeFlac(const std::string& name, size_t size, float amplitude) {
+  fs::create_directory(tmpDir);
+  const fs::path path = tmpDir / name;
+  saveSound(
+      path,
+      std::vector<float>(size, amplitude),
+      sampleRate,
+      1,
+      fl::pkg::speech::SoundFormat::FLAC,
+      fl::pkg::speech::SoundSubFormat::PCM_16);
+  return path;
+}
+
+std::string writeRaw(const std::string& name, const std::vector<float>& data) {
+  fs::create_directory(tmpDir);
+  const fs::path path = tmpDir / name;
+  std::ofstream file(path, std::ios::binary);
+  file.write(
+      reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+  return path;
+}
+
+} // namespace
+
+TEST(SoundBank, CacheHits) {
+  const auto path = writeFlac("hits.flac", 100, 0.5);
+  SoundBank bank(1 << 20);
+
+  auto sound = bank.get(path);
+  ASSERT_EQ(sound->size(), 100);
+  EXPECT_NEAR((*sound)[10], 0.5, 1e-3);
+  EXPECT_FALSE(sound->isMapped());
+  EXPECT_EQ(bank.cachedBytes(), 100 * sizeof(float));
+
+  EXPECT_EQ(bank.get(path), sound);
+  EXPECT_EQ(bank.numMisses(), 1);
+  EXPECT_EQ(bank.numHits(), 1);
+  EXPECT_THROW(bank.get((tmpDir / "missing.flac").string()), std::exception);
+}
+
+TEST(SoundBank, Eviction) {
+  const auto first = writeFlac("first.flac", 100, 0.1);
+  const auto second = writeFlac("second.flac", 100, 0.2);
+  const auto third = writeFlac("third.flac", 100, 0.3);
+  const auto large = writeFlac("large.flac", 1000, 0.4);
+  // room for two sounds of 100 samples
+  SoundBank bank(250 * sizeof(float));
+
+  auto firstSound = bank.get(first);
+  bank.get(second);
+  bank.get(first);
+  bank.get(third); // evicts second, the least recently used
+  EXPECT_EQ(bank.cachedBytes(), 200 * sizeof(float));
+  EXPECT_EQ(bank.numMisses(), 3);
+  bank.get(first);
+  EXPECT_EQ(bank.numMisses(), 3);
+  bank.get(second);
+  EXPECT_EQ(bank.numMisses(), 4);
+
+  // too large to be cached, but still returned
+  EXPECT_EQ(bank.get(large)->size(), 1000);
+  EXPECT_EQ(bank.cachedBytes(), 200 * sizeof(float));
+  // evicted sounds stay valid
+  EXPECT_NEAR((*firstSound)[0], 0.1, 1e-3);
+}
+
+TEST(SoundBank, MappedRawFile) {
+  const std::vector<float> data = {0.5, -1, 2, 0.25};
+  const auto path = writeRaw("raw.f32", data);
+  SoundBank bank(0);
+
+  auto sound = bank.get(path);
+  EXPECT_TRUE(sound->isMapped());
+  EXPECT_EQ(
+      std::vector<float>(sound->data(), sound->data() + sound->size()), data);
+  EXPECT_EQ(bank.cachedBytes(), 0);
+  EXPECT_EQ(bank.get(path), sound);
+
+  EXPECT_THROW(bank.get((tmpDir / "missing.f32").string()), std::exception);
+}
+
+TEST(SoundBank, ReloadModified) {
+  const auto path = writeRaw("modified.f32", {1, 2});
+  SoundBank bank(1 << 20);
+  auto sound = bank.get(path);
+  ASSERT_EQ(sound->size(), 2);
+
+  writeRaw("modified.f32", {3, 4, 5});
+  fs::last_write_time(
+      path, fs::last_write_time(path) + std::chrono::seconds(1));
+  auto modified = bank.get(path);
+  ASSERT_EQ(modified->size(), 3);
+  EXPECT_EQ((*modified)[0], 3);
+  EXPECT_EQ(bank.numMisses(), 2);
+}
+
+TEST(SoundBank, ConcurrentGet) {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 8; ++i) {
+    paths.push_back(writeFlac(std::to_string(i) + ".flac", 1000, 0.1 * i));
+  }
+  SoundBank bank(1 << 20);
+  bank.preload({paths[0], paths[1]}, 2);
+  EXPECT_EQ(bank.numMisses(), 2);
+
+  std::vector<std::future<void>> futs;
+  for (int t = 0; t < 4; ++t) {
+    futs.push_back(std::async(std::launch::async, [&, t]() {
+      for (int i = 0; i < 100; ++i) {
+        const int idx = (i + t) % paths.size();
+        auto sound = bank.get(paths[idx]);
+        ASSERT_EQ(sound->size(), 1000);
+        ASSERT_NEAR((*sound)[0], 0.1 * idx, 1e-3);
+      }
+    }));
+  }
+  for (auto& fut : futs) {
+    fut.get();
+  }
+  // every file is loaded once
+  EXPECT_EQ(bank.numMisses(), paths.size());
+  EXPECT_EQ(bank.numHits() + bank.numMisses(), 400 + 2);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "flashlight/pkg/speech/common/LockFreeQueue.h"
+
+using namespace fl::lib;
+
+TEST(LockFreeQueueTest, SingleThread) {
+  LockFreeQueue<int> queue(10);
+  ASSERT_EQ(queue.capacity(), 16);
+
+  // Producing
+  for (int i = 1; i <= 5; i++) {
+    queue.add(i);
+  }
+  ASSERT_EQ(queue.size(), 5);
+  queue.finishAdding();
+  // ignored once adding is finished
+  queue.add(6);
+
+  // Consuming
+  std::vector<int> output;
+  int element;
+  while (queue.get(element)) {
+    output.emplace_back(element);
+  }
+
+  // Check
+  ASSERT_THAT(output, testing::ElementsAre(1, 2, 3, 4, 5));
+}
+
+TEST(LockFreeQueueTest, BatchedGet) {
+  LockFreeQueue<std::string> queue(4);
+  for (int i = 0; i < 7; i++) {
+    // wraps around the ring buffer
+    if (i == 4) {
+      std::vector<std::string> output;
+      ASSERT_EQ(queue.get(output, 3), 3);
+      ASSERT_THAT(output, testing::ElementsAre("0", "1", "2"));
+    }
+    queue.add(std::to_string(i));
+  }
+  queue.finishAdding();
+
+  std::vector<std::string> output;
+  ASSERT_EQ(queue.get(output, 3), 3);
+  ASSERT_EQ(queue.get(output, 3), 1);
+  ASSERT_EQ(queue.get(output, 3), 0);
+  ASSERT_THAT(output, testing::ElementsAre("3", "4", "5", "6"));
+}
+
+TEST(LockFreeQueueTest, MultiThreads) {
+  // small queue so that producers and consumers have to wait
+  const int nElements = 100000, queueSize = 8;
+  const int64_t targetSum = int64_t(nElements) * (nElements - 1) / 2;
+  const int nProducer = std::max(2u, std::thread::hardware_concurrency() / 2),
+            nConsumer = std::max(2u, std::thread::hardware_concurrency() / 2);
+  std::vector<int64_t> consumerResults(nConsumer, 0);
+
+  LockFreeQueue<int> queue(queueSize);
+
+  // Define producer and consumers
+  auto produce = [nProducer, &queue](int tid) {
+    for (int i = tid; i < nElements; i += nProducer) {
+      queue.add(i);
+    }
+  };
+
+  // half of the consumers pop several elements at once
+  auto consume = [&consumerResults, &queue](int tid) {
+    if (tid % 2 == 0) {
+      int element;
+      while (queue.get(element)) {
+        consumerResults[tid] += element;
+      }
+    } else {
+      std::vector<int> elements;
+      while (queue.get(elements, 3) > 0) {
+        for (auto element : elements) {
+          consumerResults[tid] += element;
+        }
+        elements.clear();
+      }
+    }
+  };
+
+  // Run Test
+  std::vector<std::future<void>> producerFutures(nProducer);
+  for (int i = 0; i < nProducer; i++) {
+    producerFutures[i] = std::async(std::launch::async, produce, i);
+  }
+
+  std::vector<std::future<void>> consumerFutures(nConsumer);
+  for (int i = 0; i < nConsumer; i++) {
+    consumerFutures[i] = std::async(std::launch::async, consume, i);
+  }
+
+  for (int i = 0; i < nProducer; i++) {
+    producerFutures[i].wait();
+  }
+  queue.finishAdding();
+
+  for (int i = 0; i < nConsumer; i++) {
+    consumerFutures[i].wait();
+  }
+
+  // Check
+  int64_t predictSum = 0;
+  for (const auto& element : consumerResults) {
+    predictSum += element;
+  }
+  ASSERT_EQ(predictSum, targetSum);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
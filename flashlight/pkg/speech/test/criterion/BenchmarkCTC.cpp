@@ -18,14 +18,12 @@
 using namespace fl;
 using namespace fl::pkg::speech;
 
-int main() {
-  fl::setDevice(0);
-  fl::init();
+namespace {
 
+// Returns the time of a forward and backward pass in msec
+double benchmark(int N, int T, int L, int B) {
   auto ctc = ConnectionistTemporalClassificationCriterion();
 
-  int N = 30, T = 487, L = 34, B = 10;
-
   auto input = Variable(fl::log(fl::rand({N, T, B})), true);
 
   auto t = fl::abs(fl::rand({L, B}, fl::dtype::s32)).astype(fl::dtype::s32) %
@@ -37,10 +35,10 @@ int main() {
   }
 
   Variable target(t, false);
-  int ntimes = 50;
+  int ntimes = 20;
   Variable b = ctc.forward({input, target}).front();
   Variable gradoutput = Variable(fl::rand(b.shape()) * 2 - 2, false);
-  for (int i = 0; i < 5; ++i) {
+  for (int i = 0; i < 3; ++i) {
     b = ctc.forward({input, target}).front();
     b.backward();
   }
@@ -51,8 +49,43 @@ int main() {
     b.backward(gradoutput);
   }
   fl::sync();
-  auto e = fl::Timer::stop(s);
-  std::cout << "Total time (fwd+bwd pass) " << std::setprecision(5)
-            << e * 1000.0 / ntimes << " msec" << std::endl;
+  return fl::Timer::stop(s) * 1000.0 / ntimes;
+}
+
+} // namespace
+
+int main() {
+  fl::setDevice(0);
+  fl::init();
+
+  const int N = 30;
+  // {B, T, L}: large batches of short utterances down to single long ones
+  const std::array<std::array<int, 3>, 6> configs = {{
+      {{32, 487, 34}},
+      {{10, 487, 34}},
+      {{4, 1000, 200}},
+      {{1, 1000, 200}},
+      {{1, 2000, 800}},
+      {{1, 4000, 1500}},
+  }};
+
+  std::cout << std::setw(4) << "B" << std::setw(6) << "T" << std::setw(6)
+            << "L" << std::setw(14) << "exact (msec)" << std::setw(14)
+            << "fast (msec)" << std::setw(16) << "exact (frame/s)"
+            << std::setw(16) << "fast (frame/s)" << std::endl;
+  const bool fastMath = getCtcFastMath();
+  for (const auto& config : configs) {
+    const int B = config[0], T = config[1], L = config[2];
+    setCtcFastMath(false);
+    const double exact = benchmark(N, T, L, B);
+    setCtcFastMath(true);
+    const double fast = benchmark(N, T, L, B);
+    std::cout << std::setw(4) << B << std::setw(6) << T << std::setw(6) << L
+              << std::fixed << std::setprecision(3) << std::setw(14) << exact
+              << std::setw(14) << fast << std::setprecision(0)
+              << std::setw(16) << B * T * 1000.0 / exact << std::setw(16)
+              << B * T * 1000.0 / fast << std::endl;
+  }
+  setCtcFastMath(fastMath);
   return 0;
 }
@@ -129,6 +129,61 @@ TEST(CriterionTest, CTCJacobian) {
   jacobianTest(funcConvIn, in);
 }
 
+TEST(CriterionTest, CTCFastMath) {
+  // Long enough for the states of a frame to be split across threads
+  int N = 30, T = 700, L = 300, B = 2;
+  auto in = fl::log(fl::rand({N, T, B}));
+  auto t = fl::abs(fl::rand({L, B}, fl::dtype::s32)) % (N - 2);
+  t(fl::range(L / 2, fl::end), 1) = -1;
+  auto tgt = Variable(t.astype(fl::dtype::s32), false);
+  auto ctc = ConnectionistTemporalClassificationCriterion();
+
+  auto lossAndGrad = [&](bool fastMath) {
+    setCtcFastMath(fastMath);
+    auto inVar = Variable(in, true);
+    auto loss = ctc.forward({inVar, tgt}).front();
+    loss.backward();
+    return std::make_pair(loss.tensor(), inVar.grad().tensor());
+  };
+  const bool fastMath = getCtcFastMath();
+  auto exact = lossAndGrad(false);
+  auto fast = lossAndGrad(true);
+  setCtcFastMath(fastMath);
+
+  checkZero((exact.first - fast.first) / exact.first, 1E-5);
+  checkZero(exact.second - fast.second, 1E-3);
+}
+
+TEST(CriterionTest, CTCSplitStates) {
+  // The exact kernel splitting the states of each frame across threads is
+  // the same as the scalar one, which runs when threads aren't split
+  int N = 30, T = 700, L = 300, B = 2;
+  auto in = fl::log(fl::rand({N, T, B}));
+  auto t = fl::abs(fl::rand({L, B}, fl::dtype::s32)) % (N - 2);
+  t(fl::range(L / 3, fl::end), 1) = -1;
+  auto tgt = Variable(t.astype(fl::dtype::s32), false);
+  auto ctc = ConnectionistTemporalClassificationCriterion();
+
+  auto lossAndGrad = [&](int maxThreads) {
+    setCtcMaxThreads(maxThreads);
+    auto inVar = Variable(in, true);
+    auto loss = ctc.forward({inVar, tgt}).front();
+    loss.backward();
+    return std::make_pair(loss.tensor(), inVar.grad().tensor());
+  };
+  const bool fastMath = getCtcFastMath();
+  const int maxThreads = getCtcMaxThreads();
+  setCtcFastMath(false);
+  auto scalar = lossAndGrad(1);
+  // more threads than sequences: the 601 states of the first are split
+  auto split = lossAndGrad(4);
+  setCtcFastMath(fastMath);
+  setCtcMaxThreads(maxThreads);
+
+  checkZero((scalar.first - split.first) / scalar.first, 1E-5);
+  checkZero(scalar.second - split.second, 1E-4);
+}
+
 TEST(CriterionTest, Batching) {
   {
     int N = 10, T = 25, L = 15, B = 5;
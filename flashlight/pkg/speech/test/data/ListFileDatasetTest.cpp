@@ -5,9 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
 #include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <set>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -15,7 +17,10 @@
 #include "flashlight/fl/common/Filesystem.h"
 #include "flashlight/fl/tensor/Init.h"
 #include "flashlight/lib/text/String.h"
+#include "flashlight/pkg/speech/common/Defines.h"
+#include "flashlight/pkg/speech/data/FeatureTransforms.h"
 #include "flashlight/pkg/speech/data/ListFileDataset.h"
+#include "flashlight/pkg/speech/data/ListFileIndex.h"
 
 using namespace fl::lib;
 using namespace fl::pkg::speech;
@@ -34,6 +39,27 @@ auto letterToTarget = [](void* data, Shape dims, fl::dtype /* unused */) {
   }
   return Tensor::fromVector(tgt);
 };
+
+fs::path writeList(
+    const std::string& name,
+    const std::vector<std::string>& rows) {
+  const fs::path path = fs::temp_directory_path() / name;
+  std::ofstream out(path);
+  for (const auto& row : rows) {
+    out << row << "\n";
+  }
+  return path;
+}
+
+void expectSameIndex(const ListFileIndex& a, const ListFileIndex& b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (int64_t i = 0; i < a.size(); ++i) {
+    ASSERT_EQ(a.id(i), b.id(i));
+    ASSERT_EQ(a.input(i), b.input(i));
+    ASSERT_EQ(a.target(i), b.target(i));
+    ASSERT_EQ(a.inputSize(i), b.inputSize(i));
+  }
+}
 } // namespace
 
 TEST(ListFileDatasetTest, LoadData) {
@@ -77,6 +103,175 @@ TEST(ListFileDatasetTest, LoadData) {
   }
 }
 
+TEST(ListFileDatasetTest, ListFileIndex) {
+  auto list = writeList(
+      "index.lst",
+      {"a /tmp/a.flac 1.5 hello   world",
+       "",
+       "b\t/tmp/b.flac 2 ",
+       "c /tmp/c.flac 0.25 quick brown\t fox\r"});
+  auto index = ListFileIndex::parse(list, 1);
+  ASSERT_EQ(index->size(), 3);
+  ASSERT_EQ(index->id(0), "a");
+  ASSERT_EQ(index->input(0), "/tmp/a.flac");
+  ASSERT_EQ(index->inputSize(0), 1.5);
+  // words are joined by single spaces
+  ASSERT_EQ(index->target(0), "hello world");
+  ASSERT_EQ(index->id(1), "b");
+  ASSERT_EQ(index->target(1), "");
+  ASSERT_EQ(index->inputSize(1), 2);
+  ASSERT_EQ(index->target(2), "quick brown fox");
+  ASSERT_FALSE(index->isMapped());
+
+  // chunks parsed by several threads
+  std::vector<std::string> rows;
+  for (int i = 0; i < 1000; ++i) {
+    rows.push_back(
+        "id" + std::to_string(i) + " /tmp/" + std::to_string(i) + ".flac " +
+        std::to_string(i) + std::string(i % 7, 'x') + " w" +
+        std::to_string(i % 13));
+  }
+  auto bigList = writeList("bigindex.lst", rows);
+  auto bigIndex = ListFileIndex::parse(bigList, 1);
+  ASSERT_EQ(bigIndex->size(), 1000);
+  for (int nThreads : {2, 7, 64}) {
+    expectSameIndex(*bigIndex, *ListFileIndex::parse(bigList, nThreads));
+  }
+
+  auto badList = writeList("badindex.lst", {"a /tmp/a.flac 1", "b 2"});
+  ASSERT_THROW(ListFileIndex::parse(badList, 2), std::runtime_error);
+}
+
+TEST(ListFileDatasetTest, ListFileIndexCache) {
+  const fs::path cacheDir = fs::temp_directory_path() / "lstidx_cache";
+  fs::remove_all(cacheDir);
+  fs::create_directories(cacheDir);
+  auto list = writeList(
+      "cached.lst", {"a /tmp/a.flac 1 one two", "b /tmp/b.flac 2 three"});
+  const auto cacheFile = ListFileIndex::cachePath(list, cacheDir);
+  ASSERT_EQ(fs::path(cacheFile).parent_path(), cacheDir);
+
+  auto parsed = ListFileIndex::load(list, cacheFile, 2);
+  ASSERT_FALSE(parsed->isMapped());
+  ASSERT_TRUE(fs::exists(cacheFile));
+  auto mapped = ListFileIndex::load(list, cacheFile, 2);
+  ASSERT_TRUE(mapped->isMapped());
+  expectSameIndex(*parsed, *mapped);
+
+  // the cache is ignored once the list changes
+  writeList(
+      "cached.lst",
+      {"a /tmp/a.flac 1 one two", "b /tmp/b.flac 2 three", "c /tmp/c 3 x"});
+  auto reparsed = ListFileIndex::load(list, cacheFile, 2);
+  ASSERT_FALSE(reparsed->isMapped());
+  ASSERT_EQ(reparsed->size(), 3);
+  ASSERT_EQ(reparsed->target(2), "x");
+  auto remapped = ListFileIndex::load(list, cacheFile, 2);
+  ASSERT_TRUE(remapped->isMapped());
+  expectSameIndex(*reparsed, *remapped);
+
+  // a corrupt cache is parsed again
+  {
+    std::ofstream out(cacheFile, std::ios::binary | std::ios::trunc);
+    out << "garbage";
+  }
+  ASSERT_FALSE(ListFileIndex::load(list, cacheFile, 2)->isMapped());
+  fs::remove_all(cacheDir);
+}
+
+TEST(ListFileDatasetTest, EncodedTargets) {
+  auto list = writeList(
+      "targets.lst",
+      {"a /tmp/a.flac 1 ab c", "b /tmp/b.flac 2", "c /tmp/c.flac 3 xyz"});
+  std::atomic<int> numCalls{0};
+  auto countingTarget = [&numCalls](void* data, Shape dims, fl::dtype type) {
+    ++numCalls;
+    return letterToTarget(data, dims, type);
+  };
+  ListFileDataset lazyDs(list, nullptr, countingTarget);
+  ASSERT_EQ(numCalls, 0);
+  ASSERT_EQ(lazyDs.getTargetSize(0), 4);
+  ASSERT_EQ(numCalls, 1);
+
+  numCalls = 0;
+  ListFileDataset ds(list, nullptr, countingTarget, nullptr, "", 2, true);
+  ASSERT_EQ(numCalls, 4); // the first target is encoded twice
+  ASSERT_EQ(ds.getTargetSize(0), 4);
+  ASSERT_EQ(ds.getTargetSize(1), 0);
+  ASSERT_EQ(ds.getTargetSize(2), 3);
+  ASSERT_EQ(ds.getInputSize(2), 3);
+  ASSERT_EQ(numCalls, 4);
+
+  // other targets are encoded on demand
+  auto floatTarget = [](void* /* data */, Shape dims, fl::dtype /* type */) {
+    return fl::full({dims.elements()}, 1.0);
+  };
+  ListFileDataset floatDs(list, nullptr, floatTarget, nullptr, "", 2, true);
+  ASSERT_EQ(floatDs.getTargetSize(0), 4);
+  ASSERT_EQ(floatDs.getTargetSize(1), 0);
+}
+
+TEST(ListFileDatasetTest, SampledTargets) {
+  auto list = writeList(
+      "sampled.lst", {"a " + (loadPath / "test_mono.wav").string() + " 1 ab"});
+  fl::lib::text::Dictionary tokenDict;
+  for (const auto* token : {"a", "b", "x", "y"}) {
+    tokenDict.addEntry(token);
+  }
+  fl::lib::text::LexiconMap lexicon;
+  lexicon["ab"] = {{"a", "b"}, {"x", "y"}, {"x"}};
+  TargetGenerationConfig config(
+      "", 1.0, kCtcCriterion, "", false, 0, false, false, false);
+  ListFileDataset ds(list, nullptr, targetFeatures(tokenDict, lexicon, config));
+
+  // targets are sampled again on every get()
+  std::set<std::vector<int>> targets;
+  for (int i = 0; i < 100 && targets.size() < 2; ++i) {
+    targets.insert(ds.get(0)[1].toHostVector<int>());
+  }
+  ASSERT_GE(targets.size(), 2);
+}
+
+TEST(ListFileDatasetTest, RawSoundShards) {
+  std::vector<float> sound = {0.5, -0.25, 0.125, 0.0, 1.0};
+  std::vector<int16_t> shortSound = {16384, -8192, 4096, 0};
+  const fs::path f32Path = fs::temp_directory_path() / "list_shard.f32";
+  const fs::path s16Path = fs::temp_directory_path() / "list_shard.s16";
+  {
+    std::ofstream f32(f32Path, std::ios::binary);
+    f32.write(
+        reinterpret_cast<const char*>(sound.data()),
+        sound.size() * sizeof(float));
+    std::ofstream s16(s16Path, std::ios::binary);
+    s16.write(
+        reinterpret_cast<const char*>(shortSound.data()),
+        shortSound.size() * sizeof(int16_t));
+  }
+  auto list = writeList(
+      "shards.lst",
+      {"a " + f32Path.string() + ":4:12 3 one",
+       "b " + s16Path.string() + ":0:8 4 two"});
+  std::atomic<int> numCalls{0};
+  auto identity = [&numCalls](void* data, Shape dims, fl::dtype type) {
+    ++numCalls;
+    EXPECT_EQ(type, fl::dtype::f32);
+    EXPECT_EQ(dims[0], 1);
+    return Tensor::fromBuffer(
+        {dims[1]}, static_cast<const float*>(data), MemoryLocation::Host);
+  };
+  ListFileDataset ds(list, identity);
+
+  auto input = ds.get(0)[0].toHostVector<float>();
+  ASSERT_EQ(input, std::vector<float>(sound.begin() + 1, sound.end() - 1));
+  input = ds.get(1)[0].toHostVector<float>();
+  ASSERT_EQ(input, std::vector<float>({0.5, -0.25, 0.125, 0.0}));
+  ASSERT_EQ(numCalls, 2);
+
+  auto audio = ds.loadAudio(f32Path.string() + ":0:8");
+  ASSERT_EQ(audio.first, std::vector<float>({0.5, -0.25}));
+  ASSERT_EQ(audio.second, Shape({1, 2}));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
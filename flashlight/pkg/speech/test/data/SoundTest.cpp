@@ -13,6 +13,7 @@
 
 #include "flashlight/fl/common/Filesystem.h"
 #include "flashlight/fl/tensor/Init.h"
+#include "flashlight/pkg/speech/data/RawSound.h"
 #include "flashlight/pkg/speech/data/Sound.h"
 
 using namespace fl::pkg::speech;
@@ -158,6 +159,87 @@ TEST(SoundTest, StreamReadWrite) {
   }
 }
 
+TEST(SoundTest, LoadWithInfo) {
+  auto audiopath = loadPath / "test_stereo.wav";
+  auto info = loadSoundInfo(audiopath);
+  SoundInfo loadedInfo;
+  auto vecFloat = loadSound<float>(audiopath, loadedInfo);
+  ASSERT_EQ(loadedInfo.samplerate, info.samplerate);
+  ASSERT_EQ(loadedInfo.channels, info.channels);
+  ASSERT_EQ(loadedInfo.frames, info.frames);
+  ASSERT_EQ(vecFloat, loadSound<float>(audiopath));
+}
+
+TEST(SoundTest, RawShard) {
+  auto audiopath = loadPath / "test_mono.wav";
+  auto vecShort = loadSound<short>(audiopath);
+  auto vecFloat = loadSound<float>(audiopath);
+  const int64_t shortBytes = vecShort.size() * sizeof(short);
+  const int64_t floatBytes = vecFloat.size() * sizeof(float);
+
+  // Shards holding the sound twice, at an aligned and an unaligned offset
+  const fs::path s16Path = fs::temp_directory_path() / "shard.s16";
+  const fs::path f32Path = fs::temp_directory_path() / "shard.f32";
+  {
+    std::ofstream s16(s16Path, std::ios::binary);
+    std::ofstream f32(f32Path, std::ios::binary);
+    for (int64_t offset : {0, 2}) {
+      s16.write("\0\0\0\0", offset);
+      s16.write(reinterpret_cast<const char*>(vecShort.data()), shortBytes);
+      f32.write("\0\0\0\0", offset);
+      f32.write(reinterpret_cast<const char*>(vecFloat.data()), floatBytes);
+    }
+  }
+  RawSoundShard s16Shard(s16Path);
+  RawSoundShard f32Shard(f32Path);
+  ASSERT_EQ(s16Shard.size(), 2 * shortBytes + 2);
+  ASSERT_EQ(f32Shard.size(), 2 * floatBytes + 2);
+
+  auto check = [&](const std::string& handle,
+                   const RawSoundShard& shard,
+                   bool zeroCopy) {
+    auto raw = RawSoundHandle::parse(handle);
+    ASSERT_TRUE(raw.has_value());
+    ASSERT_EQ(raw->frames(), vecFloat.size());
+    auto samples = shard.load(*raw);
+    ASSERT_EQ(samples.size(), vecFloat.size());
+    for (int64_t i = 0; i < samples.size(); ++i) {
+      ASSERT_NEAR(samples[i], vecFloat[i], 1E-6);
+    }
+    const float* data = shard.floatData(*raw);
+    ASSERT_EQ(data != nullptr, zeroCopy);
+    if (zeroCopy) {
+      ASSERT_TRUE(std::equal(samples.begin(), samples.end(), data));
+    }
+  };
+  const auto s16 = s16Path.string();
+  const auto f32 = f32Path.string();
+  const auto shortLen = std::to_string(shortBytes);
+  const auto floatLen = std::to_string(floatBytes);
+  check(s16 + ":0:" + shortLen, s16Shard, false);
+  check(s16 + ":" + std::to_string(shortBytes + 2) + ":" + shortLen,
+        s16Shard,
+        false);
+  check(f32 + ":0:" + floatLen, f32Shard, true);
+  check(f32 + ":" + std::to_string(floatBytes + 2) + ":" + floatLen,
+        f32Shard,
+        false);
+
+  auto outOfRange = RawSoundHandle::parse(
+      f32 + ":" + std::to_string(floatBytes + 4) + ":" + floatLen);
+  ASSERT_TRUE(outOfRange.has_value());
+  ASSERT_THROW(f32Shard.load(*outOfRange), std::out_of_range);
+
+  for (const std::string& handle :
+       {std::string(audiopath),
+        s16 + ":0",
+        s16 + ":x:2",
+        s16 + ":-1:2",
+        std::string("/tmp/a.wav:0:2")}) {
+    ASSERT_FALSE(RawSoundHandle::parse(handle).has_value()) << handle;
+  }
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
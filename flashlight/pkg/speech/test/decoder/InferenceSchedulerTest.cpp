@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flashlight/fl/flashlight.h"
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/pkg/speech/decoder/InferenceScheduler.h"
+
+using namespace fl;
+using namespace fl::pkg::speech;
+
+namespace {
+
+using EmissionQueue = fl::lib::LockFreeQueue<EmissionTargetPair>;
+
+// T x FEAT x 1 x B -> FEAT x T x B: the emissions of a sample are its input
+Variable transposeForward(const Variable& input, const Tensor& /* sizes */) {
+  return moddims(
+      reorder(input, {1, 0, 2, 3}),
+      {input.dim(1), input.dim(0), input.dim(3)});
+}
+
+InferenceRequest makeRequest(int id, int T, int nFeat) {
+  InferenceRequest request;
+  request.sampleId = std::to_string(id);
+  request.input = fl::rand({T, nFeat, 1, 1});
+  request.target.tokenTarget = {id};
+  return request;
+}
+
+std::vector<EmissionTargetPair> getResults(EmissionQueue& queue) {
+  queue.finishAdding();
+  std::vector<EmissionTargetPair> results;
+  EmissionTargetPair result;
+  while (queue.get(result)) {
+    results.push_back(result);
+  }
+  return results;
+}
+
+} // namespace
+
+TEST(InferenceSchedulerTest, Batching) {
+  const int nFeat = 3;
+  InferenceSchedulerOptions options;
+  options.maxBatchSize = 4;
+  options.bucketFrames = 10;
+  options.maxWaitMsec = 1e5;
+  EmissionQueue queue;
+  InferenceScheduler scheduler(queue, options);
+
+  std::unordered_map<std::string, Tensor> inputs;
+  for (int i = 0; i < 10; ++i) {
+    // two buckets: 3 to 7 frames and 13 to 17 frames
+    auto request = makeRequest(i, 3 + i / 2 + (i % 2) * 10, nFeat);
+    inputs[request.sampleId] = request.input;
+    scheduler.add(request);
+  }
+  scheduler.finishAdding();
+
+  std::vector<int> batchSizes;
+  scheduler.run([&](const Variable& input, const Tensor& sizes) {
+    batchSizes.push_back(input.dim(3));
+    auto sizesV = sizes.toHostVector<float>();
+    for (auto size : sizesV) {
+      EXPECT_EQ(
+          static_cast<int>(size) / options.bucketFrames,
+          static_cast<int>(sizesV[0]) / options.bucketFrames);
+    }
+    return transposeForward(input, sizes);
+  });
+  ASSERT_EQ(batchSizes, (std::vector<int>{4, 4, 1, 1}));
+
+  auto results = getResults(queue);
+  ASSERT_EQ(results.size(), 10);
+  for (const auto& result : results) {
+    const auto& emission = result.first;
+    const auto& input = inputs.at(emission.sampleId);
+    ASSERT_EQ(emission.nFrames, input.dim(0));
+    ASSERT_EQ(emission.nTokens, nFeat);
+    ASSERT_EQ(result.second.tokenTarget.front(), std::stoi(emission.sampleId));
+    auto expected = fl::transpose(input(fl::span, fl::span, 0, 0));
+    ASSERT_EQ(emission.emission, expected.toHostVector<float>());
+  }
+
+  auto stats = scheduler.getStats();
+  ASSERT_EQ(stats.numSamples, 10);
+  ASSERT_EQ(stats.numBatches, 4);
+  ASSERT_EQ(stats.avgBatchSize, 2.5);
+  ASSERT_LE(stats.p50LatencyMsec, stats.p99LatencyMsec);
+}
+
+TEST(InferenceSchedulerTest, MaxBatchFrames) {
+  InferenceSchedulerOptions options;
+  options.maxBatchSize = 8;
+  options.maxBatchFrames = 40;
+  options.bucketFrames = 100;
+  options.maxWaitMsec = 1e5;
+  EmissionQueue queue;
+  InferenceScheduler scheduler(queue, options);
+  for (int i = 0; i < 6; ++i) {
+    scheduler.add(makeRequest(i, 10 + i, 2));
+  }
+  scheduler.finishAdding();
+
+  std::vector<int> batchSizes;
+  scheduler.run([&](const Variable& input, const Tensor& sizes) {
+    EXPECT_LE(input.dim(0) * input.dim(3), options.maxBatchFrames);
+    batchSizes.push_back(input.dim(3));
+    return transposeForward(input, sizes);
+  });
+  // 10 + 11 + 12 frames padded to 36; 13 + 14 padded to 28; 15
+  ASSERT_EQ(batchSizes, (std::vector<int>{3, 2, 1}));
+  ASSERT_EQ(getResults(queue).size(), 6);
+  ASSERT_EQ(scheduler.getStats().numPaddedFrames, 36 + 28 + 15);
+}
+
+TEST(InferenceSchedulerTest, Deadline) {
+  InferenceSchedulerOptions options;
+  options.maxBatchSize = 8;
+  options.maxWaitMsec = 20;
+  EmissionQueue queue;
+  InferenceScheduler scheduler(queue, options);
+  auto fut = std::async(std::launch::async, [&]() {
+    scheduler.run(transposeForward);
+  });
+
+  // The batch isn't full but is run once the sample waited long enough
+  scheduler.add(makeRequest(0, 5, 2));
+  EmissionTargetPair result;
+  ASSERT_TRUE(queue.get(result));
+  ASSERT_EQ(result.first.sampleId, "0");
+  scheduler.finishAdding();
+  fut.get();
+
+  auto stats = scheduler.getStats();
+  ASSERT_EQ(stats.numBatches, 1);
+  ASSERT_GE(stats.p50LatencyMsec, options.maxWaitMsec);
+}
+
+TEST(InferenceSchedulerTest, DeadlineWhileOtherBucketFull) {
+  InferenceSchedulerOptions options;
+  options.maxBatchSize = 2;
+  options.bucketFrames = 10;
+  options.maxWaitMsec = 20;
+  EmissionQueue queue;
+  InferenceScheduler scheduler(queue, options);
+  // a lone long sample, then enough short ones to keep their bucket full for
+  // 20 batches
+  scheduler.add(makeRequest(0, 25, 2));
+  for (int i = 1; i <= 40; ++i) {
+    scheduler.add(makeRequest(i, 5, 2));
+  }
+  scheduler.finishAdding();
+
+  std::vector<Dim> batchFrames;
+  scheduler.run([&](const Variable& input, const Tensor& sizes) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    batchFrames.push_back(input.dim(0));
+    return transposeForward(input, sizes);
+  });
+  ASSERT_EQ(batchFrames.size(), 21);
+  // the long sample isn't left waiting for the short ones to run out
+  const auto longBatch =
+      std::find(batchFrames.begin(), batchFrames.end(), 25);
+  ASSERT_NE(longBatch, batchFrames.end());
+  ASSERT_LT(longBatch - batchFrames.begin(), 20);
+}
+
+TEST(InferenceSchedulerTest, AddAfterFinish) {
+  EmissionQueue queue;
+  InferenceScheduler scheduler(queue, InferenceSchedulerOptions());
+  scheduler.finishAdding();
+  ASSERT_THROW(scheduler.add(makeRequest(0, 5, 2)), std::logic_error);
+}
+
+TEST(InferenceSchedulerTest, ForwardFailure) {
+  InferenceSchedulerOptions options;
+  options.maxBatchSize = 1;
+  options.maxPending = 2;
+  EmissionQueue queue;
+  InferenceScheduler scheduler(queue, options);
+
+  // a producer blocked on a full scheduler, and a forward thread which is
+  // running a batch, both stop once the other forward thread fails
+  std::promise<void> failed;
+  std::shared_future<void> hasFailed = failed.get_future().share();
+  auto producer = std::async(std::launch::async, [&]() {
+    for (int i = 0; i < 100; ++i) {
+      scheduler.add(makeRequest(i, 5, 2));
+    }
+    scheduler.finishAdding();
+  });
+  auto forward = std::async(std::launch::async, [&]() {
+    scheduler.run([&](const Variable& input, const Tensor& sizes) {
+      hasFailed.wait();
+      return transposeForward(input, sizes);
+    });
+  });
+  auto failing = std::async(std::launch::async, [&]() {
+    scheduler.run([&](const Variable&, const Tensor&) -> Variable {
+      failed.set_value();
+      throw std::runtime_error("forward failed");
+    });
+  });
+
+  const auto timeout = std::chrono::seconds(30);
+  ASSERT_EQ(failing.wait_for(timeout), std::future_status::ready);
+  ASSERT_EQ(producer.wait_for(timeout), std::future_status::ready);
+  ASSERT_EQ(forward.wait_for(timeout), std::future_status::ready);
+  ASSERT_THROW(failing.get(), std::runtime_error);
+  ASSERT_THROW(producer.get(), std::runtime_error);
+  forward.get();
+  ASSERT_THROW(scheduler.add(makeRequest(0, 5, 2)), std::runtime_error);
+}
+
+TEST(InferenceSchedulerTest, MultiThread) {
+  const int nProducers = 4, nForward = 3, nSamples = 25;
+  InferenceSchedulerOptions options;
+  options.maxBatchSize = 5;
+  options.bucketFrames = 4;
+  options.maxWaitMsec = 5;
+  options.maxPending = 10;
+  EmissionQueue queue;
+  InferenceScheduler scheduler(queue, options);
+
+  std::vector<std::future<void>> forwardFuts;
+  for (int i = 0; i < nForward; ++i) {
+    forwardFuts.push_back(std::async(std::launch::async, [&]() {
+      scheduler.run(transposeForward);
+    }));
+  }
+  std::vector<std::future<void>> producerFuts;
+  for (int p = 0; p < nProducers; ++p) {
+    producerFuts.push_back(std::async(std::launch::async, [&, p]() {
+      for (int i = 0; i < nSamples; ++i) {
+        int id = p * nSamples + i;
+        scheduler.add(makeRequest(id, 1 + id % 13, 2));
+      }
+    }));
+  }
+  for (auto& fut : producerFuts) {
+    fut.get();
+  }
+  scheduler.finishAdding();
+  for (auto& fut : forwardFuts) {
+    fut.get();
+  }
+
+  std::set<std::string> ids;
+  for (const auto& result : getResults(queue)) {
+    ASSERT_EQ(result.first.nFrames, 1 + std::stoi(result.first.sampleId) % 13);
+    ids.insert(result.first.sampleId);
+  }
+  ASSERT_EQ(ids.size(), nProducers * nSamples);
+  ASSERT_EQ(scheduler.getStats().numSamples, nProducers * nSamples);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flashlight/fl/contrib/modules/modules.h"
+#include "flashlight/fl/flashlight.h"
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/pkg/speech/common/Defines.h"
+#include "flashlight/pkg/speech/data/FeatureTransforms.h"
+#include "flashlight/pkg/speech/streaming/StreamingEncoder.h"
+#include "flashlight/pkg/speech/streaming/StreamingFeatures.h"
+
+using namespace fl;
+using namespace fl::lib::audio;
+using namespace fl::pkg::speech;
+
+namespace {
+
+Tensor concatChunks(const std::vector<Tensor>& chunks, int dim) {
+  std::vector<Tensor> nonEmpty;
+  for (const auto& chunk : chunks) {
+    if (!chunk.isEmpty()) {
+      nonEmpty.push_back(chunk);
+    }
+  }
+  return fl::concatenate(nonEmpty, dim);
+}
+
+// Feeds `input` by chunks of 1, 2, ..., `maxChunk` frames
+Tensor
+streamNetwork(StreamingEncoder& encoder, const Tensor& input, int maxChunk) {
+  std::vector<Tensor> outputs;
+  int T = input.dim(0);
+  for (int start = 0, size = 1; start < T; start += size) {
+    size = std::min(size % maxChunk + 1, T - start);
+    outputs.push_back(encoder.accept(input(fl::range(start, start + size))));
+  }
+  outputs.push_back(encoder.finish());
+  return concatChunks(outputs, encoder.outputTimeDim());
+}
+
+// Forward on the whole utterance, transformers without pad mask
+Tensor forwardNetwork(Sequential& network, const Tensor& input) {
+  auto output = fl::noGrad(input);
+  for (auto& module : network.modules()) {
+    if (std::dynamic_pointer_cast<Transformer>(module)) {
+      output = module->forward({output, Variable()}).front();
+    } else {
+      output = module->forward({output}).front();
+    }
+  }
+  return output.tensor();
+}
+
+} // namespace
+
+TEST(StreamingTest, Features) {
+  auto samplerate = 16000;
+  FeatureParams featParams(
+      samplerate,
+      25, // framesize
+      10, // framestride
+      40, // filterbanks
+      0, // lowfreqfilterbank,
+      samplerate / 2, // highfreqfilterbank
+      -1, // mfcccoeffs
+      kLifterParam, // lifterparam
+      0, // delta window
+      0 // delta-delta window
+  );
+  featParams.useEnergy = false;
+  featParams.usePower = false;
+  featParams.zeroMeanFrame = false;
+
+  std::vector<float> audio(1.3 * samplerate);
+  for (int j = 0; j < audio.size(); ++j) {
+    audio[j] = std::sin(2 * M_PI * 440 * j / samplerate) +
+        0.1 * std::sin(2 * M_PI * 3 * j / samplerate);
+  }
+  for (auto featType : {FeatureType::MFSC, FeatureType::POW_SPECTRUM}) {
+    for (auto ctx : {std::pair<int, int>{50, 0}, std::pair<int, int>{20, 7}}) {
+      auto expected = inputFeatures(featParams, featType, ctx)(
+          audio.data(), {1, static_cast<Dim>(audio.size())}, fl::dtype::f32);
+
+      StreamingFeatures streaming(featParams, featType, ctx);
+      std::vector<Tensor> chunks;
+      // 0.1 sec chunks don't end on frame boundaries
+      for (int start = 0; start < audio.size(); start += 1600) {
+        std::vector<float> chunk(
+            audio.begin() + start,
+            audio.begin() + std::min<int>(start + 1600, audio.size()));
+        chunks.push_back(streaming.accept(chunk));
+      }
+      chunks.push_back(streaming.finish());
+      auto features = concatChunks(chunks, 0);
+      ASSERT_EQ(features.shape(), expected.shape());
+      ASSERT_TRUE(allClose(features, expected, 1E-5));
+    }
+  }
+
+  EXPECT_THROW(
+      StreamingFeatures(featParams, FeatureType::MFSC, {-1, -1}),
+      std::invalid_argument);
+  featParams.deltaWindow = 2;
+  EXPECT_THROW(
+      StreamingFeatures(featParams, FeatureType::MFSC, {50, 0}),
+      std::invalid_argument);
+}
+
+TEST(StreamingTest, Convolutions) {
+  const int T = 101, nFeat = 10, C = 4;
+  auto network = std::make_shared<Sequential>();
+  network->add(Conv2D(1, C, 5, 1, 1, 1, fl::PaddingMode::SAME, 0));
+  network->add(ReLU());
+  // strided, with padding not multiple of the stride
+  network->add(Conv2D(C, C, 4, 1, 2, 1, 1, 0));
+  network->add(TDSBlock(C, 3, nFeat, 0, 0, 1, false));
+  network->add(TDSBlock(C, 5, nFeat, 0, 0, -1, false));
+  network->add(AsymmetricConv1D(C, C, 5, 1, fl::PaddingMode::SAME, 0.25));
+  network->add(Reorder({2, 1, 0, 3}));
+  network->add(View({C * nFeat, -1, 1, 0}));
+  network->add(Linear(C * nFeat, 12));
+
+  StreamingEncoder encoder(network);
+  EXPECT_EQ(encoder.outputTimeDim(), 1);
+  auto input = fl::rand({T, nFeat, 1, 1});
+  auto expected = forwardNetwork(*network, input);
+  for (int maxChunk : {1, 3, 16, T}) {
+    auto output = streamNetwork(encoder, input, maxChunk);
+    ASSERT_EQ(output.shape(), expected.shape());
+    ASSERT_TRUE(allClose(output, expected, 1E-5));
+  }
+}
+
+TEST(StreamingTest, Transformer) {
+  const int T = 50, C = 16;
+  auto network = std::make_shared<Sequential>();
+  // T x C x 1 -> C x T x 1
+  network->add(Reorder({1, 0, 2}));
+  network->add(Transformer(C, 4, 32, 4, 64, 0, 0, true));
+  network->add(Transformer(C, 4, 32, 4, 0, 0, 0, true, true));
+  network->add(Linear(C, 8));
+
+  StreamingEncoder encoder(network);
+  EXPECT_EQ(encoder.outputTimeDim(), 1);
+  auto input = fl::rand({T, C, 1});
+  auto expected = forwardNetwork(*network, input);
+  for (int maxChunk : {1, 7, T}) {
+    auto output = streamNetwork(encoder, input, maxChunk);
+    ASSERT_EQ(output.shape(), expected.shape());
+    ASSERT_TRUE(allClose(output, expected, 1E-4));
+  }
+}
+
+TEST(StreamingTest, Rnn) {
+  const int T = 40, C = 6;
+  auto network = std::make_shared<Sequential>();
+  // T x C x 1 -> C x 1 x T
+  network->add(Reorder({1, 2, 0}));
+  network->add(RNN(C, 8, 2, RnnMode::LSTM));
+  network->add(RNN(8, 8, 1, RnnMode::GRU));
+  network->add(Linear(8, 5));
+
+  StreamingEncoder encoder(network);
+  EXPECT_EQ(encoder.outputTimeDim(), 2);
+  auto input = fl::rand({T, C, 1});
+  auto expected = forwardNetwork(*network, input);
+  for (int maxChunk : {1, 5, T}) {
+    auto output = streamNetwork(encoder, input, maxChunk);
+    ASSERT_EQ(output.shape(), expected.shape());
+    ASSERT_TRUE(allClose(output, expected, 1E-5));
+  }
+}
+
+TEST(StreamingTest, Unsupported) {
+  auto network = std::make_shared<Sequential>();
+  network->add(Transformer(16, 4, 32, 4, 0, 0, 0, false));
+  EXPECT_THROW(StreamingEncoder{network}, std::invalid_argument);
+
+  network = std::make_shared<Sequential>();
+  network->add(TDSBlock(4, 3, 10));
+  EXPECT_THROW(StreamingEncoder{network}, std::invalid_argument);
+
+  network = std::make_shared<Sequential>();
+  network->add(Pool2D(2, 1, 2, 1));
+  EXPECT_THROW(StreamingEncoder{network}, std::invalid_argument);
+
+  network = std::make_shared<Sequential>();
+  network->add(Reorder({1, 0, 2}));
+  network->add(Conformer(16, 4, 32, 4, 0, 3, 0));
+  EXPECT_THROW(StreamingEncoder{network}, std::invalid_argument);
+
+  network = std::make_shared<Sequential>();
+  network->add(Reorder({1, 2, 0}));
+  network->add(RNN(16, 8, 1, RnnMode::LSTM, true));
+  EXPECT_THROW(StreamingEncoder{network}, std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}
@@ -74,6 +74,79 @@ TextDataset::TextDataset(
   const int64_t nTokens = data_.size();
 
   /* 2. Batchify */
+  batchify(
+      sentenceRanges,
+      0,
+      nTokens,
+      tokensPerSample,
+      batchSize,
+      sampleBreakMode,
+      useDynamicBatching);
+
+  FL_LOG(LogLevel::INFO) << "[TextDataset] (" << reader.getRank() << "/"
+                         << reader.getTotalReaders() << ") Loaded " << nTokens
+                         << " tokens, " << sentenceRanges.size()
+                         << " sentences and " << size() << " batches";
+}
+
+TextDataset::TextDataset(
+    const fs::path& corpusPath,
+    const Dictionary& dictionary,
+    int64_t tokensPerSample /* = 1024 */,
+    int64_t batchSize /* = 1 */,
+    const std::string& sampleBreakMode /* = "none" */,
+    const bool useDynamicBatching /* = false */,
+    int64_t rank /* = 0 */,
+    int64_t totalReaders /* = 1 */)
+    : pad_(dictionary.getIndex(fl::lib::text::kPadToken)),
+      corpus_(std::make_shared<TokenizedCorpus>(corpusPath)) {
+  if (totalReaders <= 0 || rank < 0 || rank >= totalReaders) {
+    throw std::invalid_argument(
+        "[TextDataset] invalid rank " + std::to_string(rank) + " for " +
+        std::to_string(totalReaders) + " readers");
+  }
+  corpus_->checkDictionary(dictionary);
+  /* 1. Select this reader's sentences */
+  const int64_t nCorpusSentences = corpus_->numSentences();
+  const int64_t firstSentence = nCorpusSentences * rank / totalReaders;
+  const int64_t lastSentence = nCorpusSentences * (rank + 1) / totalReaders;
+
+  std::vector<std::pair<int64_t, int64_t>> sentenceRanges;
+  if (sampleBreakMode == "eos") {
+    sentenceRanges.reserve(lastSentence - firstSentence);
+    for (int64_t i = firstSentence; i < lastSentence; ++i) {
+      sentenceRanges.emplace_back(
+          corpus_->eosPosition(i), corpus_->eosPosition(i + 1));
+    }
+  }
+  const int64_t firstToken = corpus_->eosPosition(firstSentence);
+  const int64_t lastToken = corpus_->eosPosition(lastSentence) + 1;
+
+  /* 2. Batchify */
+  batchify(
+      sentenceRanges,
+      firstToken,
+      lastToken,
+      tokensPerSample,
+      batchSize,
+      sampleBreakMode,
+      useDynamicBatching);
+
+  FL_LOG(LogLevel::INFO) << "[TextDataset] (" << rank << "/" << totalReaders
+                         << ") Mapped " << lastToken - firstToken
+                         << " tokens, " << lastSentence - firstSentence
+                         << " sentences and " << size() << " batches from "
+                         << corpusPath;
+}
+
+void TextDataset::batchify(
+    std::vector<std::pair<int64_t, int64_t>>& sentenceRanges,
+    int64_t firstToken,
+    int64_t lastToken,
+    int64_t tokensPerSample,
+    int64_t batchSize,
+    const std::string& sampleBreakMode,
+    bool useDynamicBatching) {
   if (batchSize <= 0) {
     throw std::invalid_argument(
         "[TextDataset] BatchSize needs to be positive.");
@@ -83,6 +156,7 @@ TextDataset::TextDataset(
     // Sentences are split into equal size (=`tokensPerSample`)
     // Total tokens per batch is `batchSize` * `tokensPerSample`
 
+    const int64_t nTokens = lastToken - firstToken;
     const int64_t nSamples = (nTokens + tokensPerSample - 1) / tokensPerSample;
     const int64_t nBatches = (nSamples + batchSize - 1) / batchSize;
     for (int64_t b = 0; b < nBatches; ++b) {
@@ -90,9 +164,10 @@ TextDataset::TextDataset(
       const int64_t lastSample = std::min((b + 1) * batchSize, nSamples);
       std::vector<SamplePosition> batch;
       for (int64_t s = firstSample; s < lastSample; ++s) {
-        const int64_t firstToken = s * tokensPerSample;
-        const int64_t lastToken = std::min((s + 1) * tokensPerSample, nTokens);
-        batch.emplace_back(SamplePosition{firstToken, lastToken - 1});
+        const int64_t first = firstToken + s * tokensPerSample;
+        const int64_t last =
+            firstToken + std::min((s + 1) * tokensPerSample, nTokens);
+        batch.emplace_back(SamplePosition{first, last - 1});
       }
       batches_.push_back(std::move(batch));
     }
@@ -138,11 +213,6 @@ TextDataset::TextDataset(
         "Invalid sampleBreakMode: should be none or eos, but it is given " +
         sampleBreakMode);
   }
-
-  FL_LOG(LogLevel::INFO) << "[TextDataset] (" << reader.getRank() << "/"
-                         << reader.getTotalReaders() << ") Loaded " << nTokens
-                         << " tokens, " << sentenceRanges.size()
-                         << " sentences and " << size() << " batches";
 }
 
 int64_t TextDataset::size() const {
@@ -158,10 +228,15 @@ std::vector<Tensor> TextDataset::get(const int64_t idx) const {
   std::vector<int> buffer(batch.size() * maxLength, pad_);
   for (int64_t i = 0; i < batch.size(); ++i) {
     const auto& pos = batch[i];
-    std::memcpy(
-        buffer.data() + i * maxLength,
-        data_.data() + pos.first,
-        sizeof(int) * (pos.last - pos.first + 1));
+    if (corpus_) {
+      corpus_->copyTokens(
+          pos.first, pos.last - pos.first + 1, buffer.data() + i * maxLength);
+    } else {
+      std::memcpy(
+          buffer.data() + i * maxLength,
+          data_.data() + pos.first,
+          sizeof(int) * (pos.last - pos.first + 1));
+    }
   }
   return {Tensor::fromVector(
       {maxLength, static_cast<long long>(batch.size())}, buffer)};
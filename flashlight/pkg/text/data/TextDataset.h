@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "flashlight/fl/common/Filesystem.h"
@@ -15,6 +17,7 @@
 #include "flashlight/lib/text/dictionary/Dictionary.h"
 #include "flashlight/lib/text/tokenizer/PartialFileReader.h"
 #include "flashlight/lib/text/tokenizer/Tokenizer.h"
+#include "flashlight/pkg/text/data/TokenizedCorpus.h"
 
 namespace fl {
 namespace pkg {
@@ -56,6 +59,12 @@ constexpr size_t kMaxTokenInBuffer = 10000000000;
  * included in each batch. All samples are padded with token <pad> to the length
  * of the longest one in a certain batch. To better fit more samples in each
  * batch, samples are sorted by length.
+ *
+ * Alternatively, a TextDataset can be backed by a pre-tokenized corpus built
+ * with `buildTokenizedCorpus` (see `TokenizedCorpus`). The corpus is
+ * memory-mapped rather than loaded, and tokens are only read when a batch is
+ * requested, so construction is fast and memory usage does not grow with the
+ * corpus size.
  */
 
 class TextDataset : public fl::Dataset {
@@ -72,6 +81,26 @@ class TextDataset : public fl::Dataset {
       const bool useDynamicBatching = false,
       const size_t reserveSpaceSize = kMaxTokenInBuffer);
 
+  /**
+   * Construct from a pre-tokenized corpus.
+   *
+   * @param corpusPath Path to a corpus written by `buildTokenizedCorpus`
+   * @param dictionary The dictionary the corpus was built with
+   * @param rank, totalReaders Sentences are split evenly across
+   * `totalReaders` readers, of which this dataset holds the `rank`-th part
+   *
+   * Other parameters are the same as for the text file constructor.
+   */
+  TextDataset(
+      const fs::path& corpusPath,
+      const fl::lib::text::Dictionary& dictionary,
+      int64_t tokensPerSample = 1024,
+      int64_t batchSize = 1,
+      const std::string& sampleBreakMode = "none",
+      const bool useDynamicBatching = false,
+      int64_t rank = 0,
+      int64_t totalReaders = 1);
+
   int64_t size() const override;
 
   std::vector<Tensor> get(const int64_t idx) const override;
@@ -86,7 +115,21 @@ class TextDataset : public fl::Dataset {
     int64_t last;
   };
 
+  // Each pair of indices in sentenceRanges is the position of the 2 <eos>
+  // tokens around a given sentence. Tokens in [firstToken, lastToken) are
+  // split into samples in "none" mode.
+  void batchify(
+      std::vector<std::pair<int64_t, int64_t>>& sentenceRanges,
+      int64_t firstToken,
+      int64_t lastToken,
+      int64_t tokensPerSample,
+      int64_t batchSize,
+      const std::string& sampleBreakMode,
+      bool useDynamicBatching);
+
   std::vector<int> data_; // eos prepended, so all indices shifted by 1
+  // If set, tokens are read from the corpus instead of data_
+  std::shared_ptr<TokenizedCorpus> corpus_;
   std::vector<std::vector<SamplePosition>> batches_;
 };
 
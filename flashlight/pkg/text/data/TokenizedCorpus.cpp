@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/text/data/TokenizedCorpus.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "flashlight/fl/common/Logging.h"
+#include "flashlight/fl/common/threadpool/ThreadPool.h"
+#include "flashlight/lib/text/String.h"
+#include "flashlight/lib/text/dictionary/Defines.h"
+#include "flashlight/lib/text/tokenizer/PartialFileReader.h"
+
+using fl::lib::text::Dictionary;
+using fl::lib::text::PartialFileReader;
+using fl::lib::text::Tokenizer;
+
+namespace fl {
+namespace pkg {
+namespace text {
+
+namespace {
+
+constexpr char kCorpusMagic[8] = {'F', 'L', 'T', 'X', 'T', 'C', 'R', 'P'};
+constexpr uint32_t kCorpusVersion = 2;
+
+struct CorpusHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t tokenBytes;
+  uint64_t numTokens;
+  uint64_t numSentences;
+  uint64_t dictionarySize;
+  uint64_t dictionaryFingerprint;
+};
+static_assert(sizeof(CorpusHeader) == 48, "unexpected CorpusHeader padding");
+
+size_t alignTo8(size_t n) {
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+// Tokens of the sentences read by one worker, each followed by <eos>.
+struct TokenizedPart {
+  std::vector<int> tokens;
+  // Offsets of the <eos> ending each sentence in `tokens`
+  std::vector<int64_t> eosOffsets;
+};
+
+TokenizedPart tokenizePart(
+    const fs::path& path,
+    int rank,
+    int nWorkers,
+    const Tokenizer& tokenizer,
+    const Dictionary& dictionary,
+    int eos) {
+  TokenizedPart part;
+  PartialFileReader reader(rank, nWorkers);
+  reader.loadFile(path);
+  while (reader.hasNextLine()) {
+    const auto tokens = tokenizer.tokenize(reader.getLine());
+    const auto indices = dictionary.mapEntriesToIndices(tokens);
+    part.tokens.insert(part.tokens.end(), indices.begin(), indices.end());
+    part.tokens.push_back(eos);
+    part.eosOffsets.push_back(part.tokens.size() - 1);
+  }
+  return part;
+}
+
+void writeTokens(
+    std::ofstream& stream,
+    const std::vector<int>& tokens,
+    uint32_t tokenBytes) {
+  if (tokenBytes == sizeof(int32_t)) {
+    stream.write(
+        reinterpret_cast<const char*>(tokens.data()),
+        tokens.size() * sizeof(int32_t));
+    return;
+  }
+  std::vector<uint16_t> narrow(tokens.begin(), tokens.end());
+  stream.write(
+      reinterpret_cast<const char*>(narrow.data()),
+      narrow.size() * sizeof(uint16_t));
+}
+
+} // namespace
+
+TokenizedCorpus::TokenizedCorpus(const fs::path& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(
+        "TokenizedCorpus - cannot open " + path.string() + ": " +
+        std::strerror(errno));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 ||
+      st.st_size < static_cast<off_t>(sizeof(CorpusHeader))) {
+    ::close(fd);
+    throw std::runtime_error(
+        "TokenizedCorpus - invalid corpus file " + path.string());
+  }
+  mappedSize_ = st.st_size;
+  mapped_ = ::mmap(nullptr, mappedSize_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped_ == MAP_FAILED) {
+    mapped_ = nullptr;
+    throw std::runtime_error(
+        "TokenizedCorpus - cannot mmap " + path.string() + ": " +
+        std::strerror(errno));
+  }
+
+  CorpusHeader header;
+  std::memcpy(&header, mapped_, sizeof(header));
+  if (std::memcmp(header.magic, kCorpusMagic, sizeof(kCorpusMagic)) != 0 ||
+      header.version != kCorpusVersion ||
+      (header.tokenBytes != sizeof(uint16_t) &&
+       header.tokenBytes != sizeof(int32_t))) {
+    ::munmap(mapped_, mappedSize_);
+    throw std::runtime_error(
+        "TokenizedCorpus - unrecognized header in " + path.string());
+  }
+  tokenBytes_ = header.tokenBytes;
+  numTokens_ = header.numTokens;
+  numSentences_ = header.numSentences;
+  dictionarySize_ = header.dictionarySize;
+  dictionaryFingerprint_ = header.dictionaryFingerprint;
+
+  const size_t tokensBytes = alignTo8(numTokens_ * tokenBytes_);
+  const size_t expectedSize = sizeof(CorpusHeader) + tokensBytes +
+      (numSentences_ + 1) * sizeof(uint64_t);
+  if (mappedSize_ != expectedSize) {
+    ::munmap(mapped_, mappedSize_);
+    throw std::runtime_error(
+        "TokenizedCorpus - truncated or corrupt corpus " + path.string());
+  }
+  tokens_ = static_cast<const char*>(mapped_) + sizeof(CorpusHeader);
+  eosPositions_ = reinterpret_cast<const uint64_t*>(tokens_ + tokensBytes);
+  // Batches are read in shuffled order
+  ::madvise(mapped_, mappedSize_, MADV_RANDOM);
+}
+
+TokenizedCorpus::~TokenizedCorpus() {
+  if (mapped_) {
+    ::munmap(mapped_, mappedSize_);
+  }
+}
+
+int64_t TokenizedCorpus::numTokens() const {
+  return numTokens_;
+}
+
+int64_t TokenizedCorpus::numSentences() const {
+  return numSentences_;
+}
+
+void TokenizedCorpus::checkDictionary(const Dictionary& dictionary) const {
+  const uint64_t size = dictionary.indexSize();
+  const uint64_t fingerprint = dictionaryFingerprint(dictionary);
+  if (size != dictionarySize_ || fingerprint != dictionaryFingerprint_) {
+    throw std::invalid_argument(
+        "TokenizedCorpus - the corpus was built with a different dictionary "
+        "(" + std::to_string(dictionarySize_) + " entries, fingerprint " +
+        std::to_string(dictionaryFingerprint_) + ") than the given one (" +
+        std::to_string(size) + " entries, fingerprint " +
+        std::to_string(fingerprint) + ")");
+  }
+}
+
+int64_t TokenizedCorpus::eosPosition(int64_t idx) const {
+  if (idx < 0 || idx > numSentences_) {
+    throw std::out_of_range(
+        "TokenizedCorpus::eosPosition - invalid sentence index " +
+        std::to_string(idx));
+  }
+  return eosPositions_[idx];
+}
+
+void TokenizedCorpus::copyTokens(int64_t first, int64_t count, int* out)
+    const {
+  if (first < 0 || count < 0 || first + count > numTokens_) {
+    throw std::out_of_range("TokenizedCorpus::copyTokens - invalid range");
+  }
+  if (tokenBytes_ == sizeof(int32_t)) {
+    std::memcpy(out, tokens_ + first * sizeof(int32_t), count * sizeof(int));
+    return;
+  }
+  const auto* src = reinterpret_cast<const uint16_t*>(tokens_) + first;
+  for (int64_t i = 0; i < count; ++i) {
+    out[i] = src[i];
+  }
+}
+
+uint64_t dictionaryFingerprint(const Dictionary& dictionary) {
+  // 64-bit FNV-1a over the NUL-terminated entries
+  uint64_t hash = 14695981039346656037ULL;
+  const auto update = [&hash](unsigned char byte) {
+    hash ^= byte;
+    hash *= 1099511628211ULL;
+  };
+  for (int i = 0; i < dictionary.indexSize(); ++i) {
+    for (const char c : dictionary.getEntry(i)) {
+      update(c);
+    }
+    update('\0');
+  }
+  return hash;
+}
+
+int64_t buildTokenizedCorpus(
+    const fs::path& dataDirectory,
+    const std::string& filenames,
+    const Tokenizer& tokenizer,
+    const Dictionary& dictionary,
+    const fs::path& outputPath,
+    int nWorkers /* = 1 */) {
+  if (nWorkers <= 0) {
+    throw std::invalid_argument(
+        "buildTokenizedCorpus - nWorkers needs to be positive.");
+  }
+  const int eos = dictionary.getIndex(fl::lib::text::kEosToken);
+  const uint32_t tokenBytes =
+      dictionary.indexSize() <= std::numeric_limits<uint16_t>::max() + 1
+      ? sizeof(uint16_t)
+      : sizeof(int32_t);
+
+  std::ofstream stream(outputPath, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error(
+        "buildTokenizedCorpus - cannot open " + outputPath.string());
+  }
+  CorpusHeader header;
+  std::memcpy(header.magic, kCorpusMagic, sizeof(kCorpusMagic));
+  header.version = kCorpusVersion;
+  header.tokenBytes = tokenBytes;
+  header.numTokens = 0;
+  header.numSentences = 0;
+  header.dictionarySize = dictionary.indexSize();
+  header.dictionaryFingerprint = dictionaryFingerprint(dictionary);
+  // Placeholder, rewritten with the final counts at the end
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::vector<uint64_t> eosPositions = {0};
+  writeTokens(stream, {eos}, tokenBytes);
+  uint64_t numTokens = 1;
+
+  fl::ThreadPool threadPool(nWorkers);
+  for (const auto& file : lib::split(',', filenames)) {
+    const fs::path path = dataDirectory / file;
+    std::vector<std::future<TokenizedPart>> futures;
+    for (int w = 0; w < nWorkers; ++w) {
+      futures.push_back(threadPool.enqueue(
+          tokenizePart,
+          path,
+          w,
+          nWorkers,
+          std::cref(tokenizer),
+          std::cref(dictionary),
+          eos));
+    }
+    // Parts are consumed in reader order to preserve the corpus order
+    for (auto& future : futures) {
+      const auto part = future.get();
+      for (const auto offset : part.eosOffsets) {
+        eosPositions.push_back(numTokens + offset);
+      }
+      writeTokens(stream, part.tokens, tokenBytes);
+      numTokens += part.tokens.size();
+    }
+    FL_LOG(fl::LogLevel::INFO)
+        << "[buildTokenizedCorpus] tokenized " << path << " (" << numTokens
+        << " tokens so far)";
+  }
+
+  const size_t tokensBytes = numTokens * tokenBytes;
+  const std::vector<char> padding(alignTo8(tokensBytes) - tokensBytes, 0);
+  stream.write(padding.data(), padding.size());
+  stream.write(
+      reinterpret_cast<const char*>(eosPositions.data()),
+      eosPositions.size() * sizeof(uint64_t));
+
+  header.numTokens = numTokens;
+  header.numSentences = eosPositions.size() - 1;
+  stream.seekp(0);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.close();
+  if (!stream) {
+    throw std::runtime_error(
+        "buildTokenizedCorpus - failed writing " + outputPath.string());
+  }
+  return header.numSentences;
+}
+
+} // namespace text
+} // namespace pkg
+} // namespace fl
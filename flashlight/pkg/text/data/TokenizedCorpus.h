@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "flashlight/fl/common/Filesystem.h"
+#include "flashlight/lib/text/dictionary/Dictionary.h"
+#include "flashlight/lib/text/tokenizer/Tokenizer.h"
+
+namespace fl {
+namespace pkg {
+namespace text {
+
+/**
+ * A read-only, memory-mapped view of a pre-tokenized text corpus.
+ *
+ * The binary format is laid out as follows (all integers little-endian):
+ * - a 48-byte header: magic "FLTXTCRP", uint32 format version, uint32 token
+ *   width in bytes (2 or 4), uint64 number of tokens, uint64 number of
+ *   sentences, uint64 dictionary size and uint64 dictionary fingerprint (see
+ *   `dictionaryFingerprint`)
+ * - the token stream `<eos> sentence <eos> sentence ... <eos>` where each token
+ *   is a dictionary index of the given width, padded to a multiple of 8 bytes
+ * - `numSentences + 1` uint64 positions of the `<eos>` tokens in the stream;
+ *   sentence `i` lies between the `<eos>` at positions `i` and `i + 1`
+ *
+ * Nothing but the header is read at construction; pages are brought in by the
+ * OS as tokens are accessed, so opening a corpus is constant time and resident
+ * memory is bounded by what is actually touched.
+ */
+class TokenizedCorpus {
+ public:
+  explicit TokenizedCorpus(const fs::path& path);
+  ~TokenizedCorpus();
+
+  TokenizedCorpus(const TokenizedCorpus&) = delete;
+  TokenizedCorpus& operator=(const TokenizedCorpus&) = delete;
+
+  int64_t numTokens() const;
+  int64_t numSentences() const;
+
+  /**
+   * Throws if the corpus wasn't built with a dictionary with the same entries
+   * as `dictionary`, whose token indices would then be wrong.
+   */
+  void checkDictionary(const fl::lib::text::Dictionary& dictionary) const;
+
+  /**
+   * @return the position in the token stream of the `<eos>` preceding the
+   * `idx`-th sentence. `idx == numSentences()` gives the final `<eos>`.
+   */
+  int64_t eosPosition(int64_t idx) const;
+
+  /**
+   * Copy `count` tokens starting at position `first` into `out`, widening them
+   * to int.
+   */
+  void copyTokens(int64_t first, int64_t count, int* out) const;
+
+ private:
+  void* mapped_{nullptr};
+  size_t mappedSize_{0};
+  uint32_t tokenBytes_{0};
+  int64_t numTokens_{0};
+  int64_t numSentences_{0};
+  uint64_t dictionarySize_{0};
+  uint64_t dictionaryFingerprint_{0};
+  const char* tokens_{nullptr};
+  const uint64_t* eosPositions_{nullptr};
+};
+
+/**
+ * A hash of the entries of a dictionary in index order, which changes if
+ * entries are added, removed or reordered.
+ */
+uint64_t dictionaryFingerprint(const fl::lib::text::Dictionary& dictionary);
+
+/**
+ * Tokenize text files and write them out in the `TokenizedCorpus` format.
+ *
+ * Each file is split into `nWorkers` parts that are read with
+ * `PartialFileReader` and tokenized in parallel; the results are written in
+ * their original order, so the output matches what `TextDataset` would load
+ * from the same files in memory.
+ *
+ * @param dataDirectory A prefix for the files to read
+ * @param filenames A comma separated list of files with text data
+ * @param tokenizer A tokenizer to tokenize lines of sentences to tokens
+ * @param dictionary A dictionary to map tokens to their indices
+ * @param outputPath Path of the binary corpus to write
+ * @param nWorkers Number of threads used for tokenization
+ *
+ * @return the number of sentences written
+ */
+int64_t buildTokenizedCorpus(
+    const fs::path& dataDirectory,
+    const std::string& filenames,
+    const fl::lib::text::Tokenizer& tokenizer,
+    const fl::lib::text::Dictionary& dictionary,
+    const fs::path& outputPath,
+    int nWorkers = 1);
+
+} // namespace text
+} // namespace pkg
+} // namespace fl
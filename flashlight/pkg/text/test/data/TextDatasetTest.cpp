@@ -19,6 +19,7 @@
 #include "flashlight/lib/text/tokenizer/PartialFileReader.h"
 #include "flashlight/lib/text/tokenizer/Tokenizer.h"
 #include "flashlight/pkg/text/data/TextDataset.h"
+#include "flashlight/pkg/text/data/TokenizedCorpus.h"
 
 using namespace fl::lib;
 using namespace fl::lib::text;
@@ -140,6 +141,62 @@ TEST(TextDatasetTest, EosModeWithDynamicBatching) {
   }
 }
 
+TEST(TextDatasetTest, TokenizedCorpus) {
+  fl::lib::text::Tokenizer tokenizer;
+  Dictionary dictionary = createDictionary(dataDir / "dictionary.txt");
+  const fs::path corpusPath = fs::temp_directory_path() / "train.tokbin";
+  buildTokenizedCorpus(
+      dataDir,
+      "train.txt",
+      tokenizer,
+      dictionary,
+      corpusPath,
+      /* nWorkers = */ 3);
+
+  for (const std::string mode : {"none", "eos"}) {
+    fl::lib::text::PartialFileReader partialFileReader(0, 1);
+    TextDataset expected(
+        dataDir,
+        "train.txt",
+        partialFileReader,
+        tokenizer,
+        dictionary,
+        5,
+        2,
+        mode,
+        /* useDynamicBatching = */ false,
+        /* reserveSpaceSize = */ 0);
+    TextDataset dataset(corpusPath, dictionary, 5, 2, mode);
+
+    ASSERT_EQ(dataset.size(), expected.size());
+    for (int i = 0; i < dataset.size(); i++) {
+      ASSERT_TRUE(fl::allClose(dataset.get(i)[0], expected.get(i)[0]));
+    }
+  }
+
+  // Sentences are split across readers
+  TextDataset first(corpusPath, dictionary, 5, 1, "eos", false, 0, 2);
+  TextDataset second(corpusPath, dictionary, 5, 1, "eos", false, 1, 2);
+  ASSERT_EQ(first.size() + second.size(), 8);
+  ASSERT_THROW(
+      TextDataset(corpusPath, dictionary, 5, 1, "eos", false, 2, 2),
+      std::invalid_argument);
+
+  // A dictionary other than the one the corpus was built with is rejected
+  Dictionary extended = dictionary;
+  extended.addEntry("not-in-the-corpus-dictionary");
+  ASSERT_THROW(
+      TextDataset(corpusPath, extended, 5, 2), std::invalid_argument);
+  Dictionary reordered;
+  for (int i = dictionary.indexSize() - 1; i >= 0; --i) {
+    reordered.addEntry(dictionary.getEntry(i));
+  }
+  ASSERT_EQ(reordered.indexSize(), dictionary.indexSize());
+  ASSERT_THROW(
+      TextDataset(corpusPath, reordered, 5, 2), std::invalid_argument);
+  fs::remove(corpusPath);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   fl::init();
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/vision/dataset/FusedImageTransforms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#include "flashlight/pkg/vision/dataset/LoaderDataset.h"
+
+#include "stb_image.h"
+
+namespace {
+
+constexpr int kNumChannels = 3;
+
+float randomFloat(float a, float b) {
+  float r = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
+  return a + (b - a) * r;
+}
+
+// Size of an image of size (w, h) after resizing its smallest side to resize,
+// following `resizeSmallest`
+std::pair<int, int> resizedSmallest(int w, int h, int resize) {
+  if (h > w) {
+    return {resize, (resize * h) / w};
+  }
+  return {(resize * w) / h, resize};
+}
+
+// Maps a crop taken in an image resized from (w, h) to (tw, th) back to
+// source coordinates
+fl::pkg::vision::ImageCrop
+toSourceCrop(int w, int h, int tw, int th, int x, int y, int size) {
+  const float sx = static_cast<float>(w) / tw;
+  const float sy = static_cast<float>(h) / th;
+  fl::pkg::vision::ImageCrop crop;
+  crop.x = std::round(x * sx);
+  crop.y = std::round(y * sy);
+  crop.w = std::max(1, std::min<int>(std::round(size * sx), w - crop.x));
+  crop.h = std::max(1, std::min<int>(std::round(size * sy), h - crop.y));
+  return crop;
+}
+
+// For each output coordinate, the two source coordinates to interpolate
+// between and the weight of the second one
+struct InterpolationTable {
+  std::vector<int> lo;
+  std::vector<int> hi;
+  std::vector<float> weight;
+};
+
+void buildInterpolationTable(
+    int cropStart,
+    int cropSize,
+    int sourceSize,
+    int outputSize,
+    bool flip,
+    int stride,
+    InterpolationTable& table) {
+  table.lo.resize(outputSize);
+  table.hi.resize(outputSize);
+  table.weight.resize(outputSize);
+  const float step = static_cast<float>(cropSize) / outputSize;
+  for (int i = 0; i < outputSize; ++i) {
+    // Sample at pixel centers
+    float pos = cropStart + (i + 0.5f) * step - 0.5f;
+    pos = std::min(std::max(pos, 0.f), static_cast<float>(sourceSize - 1));
+    const int lo = static_cast<int>(pos);
+    const int hi = std::min(lo + 1, sourceSize - 1);
+    const int o = flip ? outputSize - 1 - i : i;
+    table.lo[o] = lo * stride;
+    table.hi[o] = hi * stride;
+    table.weight[o] = pos - lo;
+  }
+}
+
+} // namespace
+
+namespace fl {
+namespace pkg {
+namespace vision {
+
+CropSampler centerCropSampler(const int resize, const int size) {
+  return [resize, size](int w, int h) {
+    const auto [tw, th] = resizedSmallest(w, h, resize);
+    const int x = std::round((static_cast<float>(tw) - size) / 2.);
+    const int y = std::round((static_cast<float>(th) - size) / 2.);
+    return toSourceCrop(w, h, tw, th, x, y, size);
+  };
+}
+
+CropSampler
+randomResizeCropSampler(const int low, const int high, const int size) {
+  return [low, high, size](int w, int h) {
+    const int resize = low + (high - low) * randomFloat(0, 1);
+    const auto [tw, th] = resizedSmallest(w, h, resize);
+    if (size > tw || size > th) {
+      throw std::runtime_error(
+          "Target th and target width are great the image size");
+    }
+    const int x = std::rand() % (tw - size + 1);
+    const int y = std::rand() % (th - size + 1);
+    return toSourceCrop(w, h, tw, th, x, y, size);
+  };
+}
+
+CropSampler randomResizedCropSampler(
+    const float scaleLow,
+    const float scaleHigh,
+    const float ratioLow,
+    const float ratioHigh) {
+  return [=](int w, int h) {
+    const float area = w * h;
+    for (int i = 0; i < 10; i++) {
+      const float scale = randomFloat(scaleLow, scaleHigh);
+      const float logRatio =
+          randomFloat(std::log(ratioLow), std::log(ratioHigh));
+      const float targetArea = scale * area;
+      const float targetRatio = std::exp(logRatio);
+      const int tw = std::round(std::sqrt(targetArea * targetRatio));
+      const int th = std::round(std::sqrt(targetArea / targetRatio));
+      if (0 < tw && tw <= w && 0 < th && th <= h) {
+        const int x = std::rand() % (w - tw + 1);
+        const int y = std::rand() % (h - th + 1);
+        return ImageCrop{x, y, tw, th};
+      }
+    }
+    // Fall back to a center crop of the smallest side
+    const int size = std::min(w, h);
+    return ImageCrop{(w - size) / 2, (h - size) / 2, size, size};
+  };
+}
+
+void cropResizeNormalize(
+    const uint8_t* src,
+    const int width,
+    const int height,
+    const int channels,
+    const ImageCrop& crop,
+    const int outputSize,
+    const bool flip,
+    const float* scale,
+    const float* bias,
+    float* out) {
+  if (crop.x < 0 || crop.y < 0 || crop.w <= 0 || crop.h <= 0 ||
+      crop.x + crop.w > width || crop.y + crop.h > height) {
+    throw std::invalid_argument("cropResizeNormalize: crop out of bounds");
+  }
+  // Tables are computed once per image, so the inner loop below is a
+  // branch-free gather + lerp that the compiler can vectorize
+  thread_local InterpolationTable xTable, yTable;
+  buildInterpolationTable(
+      crop.x, crop.w, width, outputSize, flip, channels, xTable);
+  buildInterpolationTable(
+      crop.y, crop.h, height, outputSize, false, width * channels, yTable);
+
+  const int* __restrict xLo = xTable.lo.data();
+  const int* __restrict xHi = xTable.hi.data();
+  const float* __restrict wx = xTable.weight.data();
+  for (int c = 0; c < channels; ++c) {
+    const float s = scale[c];
+    const float b = bias[c];
+    for (int y = 0; y < outputSize; ++y) {
+      const uint8_t* __restrict top = src + yTable.lo[y] + c;
+      const uint8_t* __restrict bottom = src + yTable.hi[y] + c;
+      const float wy = yTable.weight[y];
+      float* __restrict dst =
+          out + static_cast<size_t>(outputSize) * (y + outputSize * c);
+      for (int x = 0; x < outputSize; ++x) {
+        const float tl = top[xLo[x]];
+        const float tr = top[xHi[x]];
+        const float bl = bottom[xLo[x]];
+        const float br = bottom[xHi[x]];
+        const float t = tl + (tr - tl) * wx[x];
+        const float bo = bl + (br - bl) * wx[x];
+        dst[x] = (t + (bo - t) * wy) * s + b;
+      }
+    }
+  }
+}
+
+namespace {
+
+// Decode the image at `fp` and apply `transform`, writing the result to `out`
+void loadJpegFusedInto(
+    const std::string& fp,
+    const FusedImageTransform& transform,
+    float* out) {
+  if (transform.mean.size() != kNumChannels ||
+      transform.std.size() != kNumChannels) {
+    throw std::invalid_argument(
+        "loadJpegFused: mean and std must have one value per channel");
+  }
+  // Reused across images decoded on the same thread
+  thread_local std::vector<unsigned char> fileBuffer;
+  {
+    std::ifstream file(fp, std::ios::binary | std::ios::ate);
+    if (!file) {
+      throw std::invalid_argument("Could not load from filepath" + fp);
+    }
+    const std::streamsize fileSize = file.tellg();
+    file.seekg(0);
+    fileBuffer.resize(fileSize);
+    if (!file.read(reinterpret_cast<char*>(fileBuffer.data()), fileSize)) {
+      throw std::invalid_argument("Could not read from filepath" + fp);
+    }
+  }
+
+  int w, h, c;
+  unsigned char* img = stbi_load_from_memory(
+      fileBuffer.data(), fileBuffer.size(), &w, &h, &c, kNumChannels);
+  if (!img) {
+    throw std::invalid_argument("Could not decode image " + fp);
+  }
+
+  float scale[kNumChannels], bias[kNumChannels];
+  for (int i = 0; i < kNumChannels; ++i) {
+    // (in / 255 - mean) / std
+    scale[i] = 1.f / (255.f * transform.std[i]);
+    bias[i] = -transform.mean[i] / transform.std[i];
+  }
+  const bool flip = randomFloat(0, 1) < transform.flipProbability;
+  try {
+    cropResizeNormalize(
+        img,
+        w,
+        h,
+        kNumChannels,
+        transform.crop(w, h),
+        transform.outputSize,
+        flip,
+        scale,
+        bias,
+        out);
+  } catch (...) {
+    stbi_image_free(img);
+    throw;
+  }
+  stbi_image_free(img);
+}
+
+} // namespace
+
+Tensor loadJpegFused(
+    const std::string& fp,
+    const FusedImageTransform& transform) {
+  const int size = transform.outputSize;
+  std::vector<float> buffer(size * size * kNumChannels);
+  loadJpegFusedInto(fp, transform, buffer.data());
+  return Tensor::fromVector({size, size, kNumChannels}, buffer);
+}
+
+std::shared_ptr<Dataset> fusedJpegLoader(
+    std::vector<std::string> fps,
+    FusedImageTransform transform) {
+  return std::make_shared<LoaderDataset<std::string>>(
+      fps, [transform](const std::string& fp) {
+        std::vector<Tensor> result = {loadJpegFused(fp, transform)};
+        return result;
+      });
+}
+
+} // namespace vision
+} // namespace pkg
+} // namespace fl
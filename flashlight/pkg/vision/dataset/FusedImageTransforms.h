@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flashlight/fl/dataset/datasets.h"
+
+namespace fl {
+namespace pkg {
+namespace vision {
+
+/*
+ * A rectangle in source image coordinates: top-left corner (@param x,
+ * @param y), width @param w and height @param h
+ */
+struct ImageCrop {
+  int x;
+  int y;
+  int w;
+  int h;
+};
+
+/*
+ * Picks the region of a @param width x @param height source image which is
+ * resized to the output of a `FusedImageTransform`
+ */
+using CropSampler = std::function<ImageCrop(int width, int height)>;
+
+/*
+ * Equivalent to `resizeTransform(resize)` followed by
+ * `centerCropTransform(size)`
+ */
+CropSampler centerCropSampler(const int resize, const int size);
+
+/*
+ * Equivalent to `randomResizeTransform(low, high)` followed by
+ * `randomCropTransform(size, size)`
+ */
+CropSampler
+randomResizeCropSampler(const int low, const int high, const int size);
+
+/*
+ * Equivalent to the crop sampled by `randomResizeCropTransform` with the same
+ * parameters
+ */
+CropSampler randomResizedCropSampler(
+    const float scaleLow,
+    const float scaleHigh,
+    const float ratioLow,
+    const float ratioHigh);
+
+/*
+ * Crop, resize, flip and normalize an image in a single pass over the pixels,
+ * instead of one Tensor op (and allocation) per step.
+ *
+ * @param outputSize both sides of the output image
+ * @param crop picks the region of the source image to resize
+ * @param flipProbability probability of flipping the output horizontally
+ * @param mean, std per channel normalization, as in `normalizeImage`
+ */
+struct FusedImageTransform {
+  int outputSize;
+  CropSampler crop;
+  float flipProbability = 0.;
+  std::vector<float> mean = {0., 0., 0.};
+  std::vector<float> std = {1., 1., 1.};
+};
+
+/*
+ * The fused kernel: bilinearly resample @param crop of the 8-bit interleaved
+ * (stb) image @param src of size @param width x @param height with
+ * @param channels channels into a @param outputSize x @param outputSize
+ * image, optionally mirrored, applying `out = in * scale[c] + bias[c]`.
+ *
+ * @param out receives outputSize x outputSize x channels floats in Flashlight
+ * (W x H x C, column-major) layout.
+ */
+void cropResizeNormalize(
+    const uint8_t* src,
+    const int width,
+    const int height,
+    const int channels,
+    const ImageCrop& crop,
+    const int outputSize,
+    const bool flip,
+    const float* scale,
+    const float* bias,
+    float* out);
+
+/*
+ * Decode the image at @param fp and apply @param transform. The compressed
+ * file is read into a per-thread buffer which is reused across calls.
+ * @return a f32 tensor of shape outputSize x outputSize x 3
+ */
+Tensor loadJpegFused(
+    const std::string& fp,
+    const FusedImageTransform& transform);
+
+/*
+ * Same as `jpegLoader` followed by the transforms `transform` fuses.
+ */
+std::shared_ptr<Dataset> fusedJpegLoader(
+    std::vector<std::string> fps,
+    FusedImageTransform transform);
+
+} // namespace vision
+} // namespace pkg
+} // namespace fl
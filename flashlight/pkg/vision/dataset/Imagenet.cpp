@@ -68,22 +68,22 @@ std::unordered_map<std::string, uint64_t> getImagenetLabels(
   return labels;
 }
 
-std::shared_ptr<Dataset> imagenetDataset(
-    const fs::path& imgDir,
-    const std::unordered_map<std::string, uint64_t>& labelMap,
-    std::vector<Dataset::TransformFunction> transformfns) {
+namespace {
+
+std::vector<std::string> imagenetFilepaths(const fs::path& imgDir) {
   std::vector<std::string> filepaths = fileGlob(imgDir.string() + "/**/*.JPEG");
 
   if (filepaths.empty()) {
     throw std::runtime_error(
         "No images were found in imagenet directory: " + imgDir.string());
   }
+  return filepaths;
+}
 
-  // Create image dataset
-  std::shared_ptr<Dataset> imageDataset =
-      fl::pkg::vision::jpegLoader(filepaths);
-  imageDataset = std::make_shared<TransformDataset>(imageDataset, transformfns);
-
+std::shared_ptr<Dataset> withImagenetLabels(
+    std::shared_ptr<Dataset> imageDataset,
+    const std::vector<std::string>& filepaths,
+    const std::unordered_map<std::string, uint64_t>& labelMap) {
   // Create labels from filepaths
   auto getLabelIdxs = [&labelMap](const std::string& s) -> uint64_t {
     std::string parentPath = s.substr(0, s.rfind("/"));
@@ -108,6 +108,32 @@ std::shared_ptr<Dataset> imagenetDataset(
       MergeDataset({imageDataset, labelDataset}));
 }
 
+} // namespace
+
+std::shared_ptr<Dataset> imagenetDataset(
+    const fs::path& imgDir,
+    const std::unordered_map<std::string, uint64_t>& labelMap,
+    std::vector<Dataset::TransformFunction> transformfns) {
+  std::vector<std::string> filepaths = imagenetFilepaths(imgDir);
+
+  // Create image dataset
+  std::shared_ptr<Dataset> imageDataset =
+      fl::pkg::vision::jpegLoader(filepaths);
+  imageDataset = std::make_shared<TransformDataset>(imageDataset, transformfns);
+  return withImagenetLabels(imageDataset, filepaths, labelMap);
+}
+
+std::shared_ptr<Dataset> imagenetDataset(
+    const fs::path& imgDir,
+    const std::unordered_map<std::string, uint64_t>& labelMap,
+    const FusedImageTransform& transform) {
+  std::vector<std::string> filepaths = imagenetFilepaths(imgDir);
+  return withImagenetLabels(
+      fl::pkg::vision::fusedJpegLoader(filepaths, transform),
+      filepaths,
+      labelMap);
+}
+
 } // namespace vision
 } // namespace pkg
 } // namespace fl
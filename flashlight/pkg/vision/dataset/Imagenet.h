@@ -12,6 +12,7 @@
 
 #include "flashlight/fl/common/Filesystem.h"
 #include "flashlight/fl/dataset/datasets.h"
+#include "flashlight/pkg/vision/dataset/FusedImageTransforms.h"
 
 /**
  * Utilities for creating an ImageDataset with imagenet data
@@ -70,6 +71,15 @@ std::shared_ptr<Dataset> imagenetDataset(
     const std::unordered_map<std::string, uint64_t>& labelMap,
     std::vector<Dataset::TransformFunction> transformfns);
 
+/*
+ * Same as above, but images are decoded and transformed in a single fused
+ * pass (see `FusedImageTransform`) instead of by a chain of Tensor ops.
+ */
+std::shared_ptr<Dataset> imagenetDataset(
+    const fs::path& imgDir,
+    const std::unordered_map<std::string, uint64_t>& labelMap,
+    const FusedImageTransform& transform);
+
 constexpr uint64_t kImagenetInputIdx = 0;
 constexpr uint64_t kImagenetTargetIdx = 1;
 
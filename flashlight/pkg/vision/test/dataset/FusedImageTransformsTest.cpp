@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "flashlight/pkg/vision/dataset/FusedImageTransforms.h"
+#include "flashlight/fl/tensor/Index.h"
+#include "flashlight/fl/tensor/Init.h"
+
+#include <gtest/gtest.h>
+
+using namespace fl::pkg::vision;
+
+namespace {
+
+// An image with interleaved channels, as decoded by stb
+std::vector<uint8_t> makeImage(int w, int h, int c) {
+  std::vector<uint8_t> img(w * h * c);
+  for (int i = 0; i < img.size(); ++i) {
+    img[i] = (i * 7) % 256;
+  }
+  return img;
+}
+
+// The same image as a W x H x C Tensor, as returned by loadJpeg
+fl::Tensor toTensor(const std::vector<uint8_t>& img, int w, int h, int c) {
+  auto t = fl::Tensor::fromVector({c, w, h}, img).astype(fl::dtype::f32);
+  return fl::transpose(t, {1, 2, 0});
+}
+
+} // namespace
+
+TEST(FusedImageTransforms, Identity) {
+  const int size = 8, c = 3;
+  auto img = makeImage(size, size, c);
+  const float scale[] = {1, 1, 1};
+  const float bias[] = {0, 0, 0};
+  std::vector<float> out(size * size * c);
+  cropResizeNormalize(
+      img.data(),
+      size,
+      size,
+      c,
+      {0, 0, size, size},
+      size,
+      /* flip = */ false,
+      scale,
+      bias,
+      out.data());
+  auto expected = toTensor(img, size, size, c);
+  ASSERT_TRUE(
+      allClose(fl::Tensor::fromVector({size, size, c}, out), expected));
+
+  cropResizeNormalize(
+      img.data(),
+      size,
+      size,
+      c,
+      {0, 0, size, size},
+      size,
+      /* flip = */ true,
+      scale,
+      bias,
+      out.data());
+  ASSERT_TRUE(allClose(
+      fl::Tensor::fromVector({size, size, c}, out), fl::flip(expected, 0)));
+}
+
+TEST(FusedImageTransforms, CropNormalize) {
+  const int w = 10, h = 6, c = 3;
+  auto img = makeImage(w, h, c);
+  const std::vector<float> mean = {0.5, 0.4, 0.3};
+  const std::vector<float> std = {0.2, 0.3, 0.4};
+  float scale[3], bias[3];
+  for (int i = 0; i < c; ++i) {
+    scale[i] = 1.f / (255.f * std[i]);
+    bias[i] = -mean[i] / std[i];
+  }
+  std::vector<float> out(4 * 4 * c);
+  cropResizeNormalize(
+      img.data(), w, h, c, {3, 1, 4, 4}, 4, false, scale, bias, out.data());
+
+  auto expected = toTensor(img, w, h, c)(fl::range(3, 7), fl::range(1, 5));
+  expected = expected / 255.f;
+  expected = expected - fl::Tensor::fromVector({1, 1, 3}, mean);
+  expected = expected / fl::Tensor::fromVector({1, 1, 3}, std);
+  ASSERT_TRUE(
+      allClose(fl::Tensor::fromVector({4, 4, c}, out), expected, 1e-5));
+}
+
+TEST(FusedImageTransforms, Downscale) {
+  // 2 x 2 blocks of constant color are downscaled to single pixels
+  const int size = 4;
+  std::vector<uint8_t> img(size * size);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      img[y * size + x] = 10 * (x / 2) + 100 * (y / 2);
+    }
+  }
+  const float scale[] = {1};
+  const float bias[] = {0};
+  std::vector<float> out(2 * 2);
+  cropResizeNormalize(
+      img.data(),
+      size,
+      size,
+      1,
+      {0, 0, size, size},
+      2,
+      false,
+      scale,
+      bias,
+      out.data());
+  ASSERT_EQ(out, std::vector<float>({0, 10, 100, 110}));
+}
+
+TEST(FusedImageTransforms, CenterCropSampler) {
+  auto crop = centerCropSampler(256, 224)(512, 256);
+  ASSERT_EQ(crop.x, 144);
+  ASSERT_EQ(crop.y, 16);
+  ASSERT_EQ(crop.w, 224);
+  ASSERT_EQ(crop.h, 224);
+
+  // Smallest side is scaled down by 2
+  crop = centerCropSampler(256, 224)(512, 1024);
+  ASSERT_EQ(crop.x, 32);
+  ASSERT_EQ(crop.y, 288);
+  ASSERT_EQ(crop.w, 448);
+  ASSERT_EQ(crop.h, 448);
+}
+
+TEST(FusedImageTransforms, OutOfBounds) {
+  auto img = makeImage(4, 4, 1);
+  const float scale[] = {1};
+  const float bias[] = {0};
+  std::vector<float> out(4);
+  ASSERT_THROW(
+      cropResizeNormalize(
+          img.data(), 4, 4, 1, {2, 2, 4, 4}, 2, false, scale, bias, out.data()),
+      std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  fl::init();
+  return RUN_ALL_TESTS();
+}